@@ -0,0 +1,130 @@
+// Peak memory of one PIPELINE execution with large step outputs.
+//
+// Replays the data movement of a pipeline whose steps each return a large
+// research-style document, once the way the orchestrator used to (a copy of
+// every output in step_outputs, another in the context, the pipeline input
+// merged into a copied step definition and re-resolved) and once with shared
+// immutable outputs (one copy per output, referenced by step_outputs, the
+// context view and the next step's input). API responses serialise the
+// context on demand and are left out. Each mode runs in a child process so
+// that its peak RSS is measured in isolation.
+
+#include "workflow_expressions.hpp"
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+// What an agent returns: the previous output's findings plus new sources
+json make_step_output(int step, size_t sources) {
+    json output = json::object();
+    output["summary"] = "Findings of step " + std::to_string(step);
+    json items = json::array();
+    for (size_t i = 0; i < sources; ++i) {
+        items.push_back({{"url", "https://example.com/" + std::to_string(step) + "/" + std::to_string(i)},
+                         {"title", "Source " + std::to_string(i)},
+                         {"content", std::string(900, static_cast<char>('a' + step % 26))}});
+    }
+    output["sources"] = std::move(items);
+    return output;
+}
+
+long peak_rss_kb() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+size_t run_copying(int steps, size_t sources) {
+    json step_parameters = {{"prompt", "Summarise {{input.query}}"}, {"max_tokens", 2048}};
+    json context = {{"input", {{"query", "quantum computing"}}}};
+    std::vector<json> request_results;      // WorkflowManager keeps each request's result
+    std::map<std::string, json> step_outputs;
+    json pipeline_data = context["input"];
+
+    for (int step = 0; step < steps; ++step) {
+        std::string id = "step" + std::to_string(step);
+        json parameters = step_parameters;  // auto step = workflow->steps[i]
+        parameters["pipeline_input"] = pipeline_data;
+        json resolved = ParameterTemplate(parameters).resolve(context);
+
+        request_results.push_back(make_step_output(step, sources));
+        step_outputs[id] = request_results.back();
+        context[id + "_output"] = request_results.back();
+        pipeline_data = step_outputs[id];
+    }
+
+    json output_data = pipeline_data;
+    return output_data.size() + context.size() + step_outputs.size();
+}
+
+size_t run_shared(int steps, size_t sources) {
+    ParameterTemplate step_parameters(json{{"prompt", "Summarise {{input.query}}"}, {"max_tokens", 2048}});
+    json context = {{"input", {{"query", "quantum computing"}}}};
+    std::vector<json> request_results;
+    StepOutputMap step_outputs;
+    SharedJson pipeline_input = std::make_shared<const json>(context["input"]);
+
+    for (int step = 0; step < steps; ++step) {
+        std::string id = "step" + std::to_string(step);
+        json resolved = step_parameters.resolve(ContextView(context, &step_outputs));
+        resolved["pipeline_input"] = *pipeline_input;
+
+        request_results.push_back(make_step_output(step, sources));
+        auto output = std::make_shared<const json>(request_results.back());
+        step_outputs[id] = output;
+        pipeline_input = output;
+    }
+
+    json output_data = *pipeline_input;
+    return output_data.size() + context.size() + step_outputs.size();
+}
+
+long measure(const char* mode, int steps, size_t sources) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return -1;
+    }
+    pid_t child = fork();
+    if (child == 0) {
+        close(fds[0]);
+        long baseline = peak_rss_kb();
+        volatile size_t sink = std::strcmp(mode, "copy") == 0 ? run_copying(steps, sources) : run_shared(steps, sources);
+        (void)sink;
+        long peak = peak_rss_kb() - baseline;
+        ssize_t written = write(fds[1], &peak, sizeof(peak));
+        _exit(written == sizeof(peak) ? 0 : 1);
+    }
+    close(fds[1]);
+    long peak = -1;
+    if (read(fds[0], &peak, sizeof(peak)) != sizeof(peak)) {
+        peak = -1;
+    }
+    close(fds[0]);
+    waitpid(child, nullptr, 0);
+    return peak;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int steps = argc > 1 ? std::atoi(argv[1]) : 6;
+    size_t sources = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 2000;
+
+    std::cout << "Pipeline of " << steps << " steps, " << sources << " sources per output ("
+              << make_step_output(0, sources).dump().size() / 1024 << " KB serialised)\n";
+    long copying = measure("copy", steps, sources);
+    long shared = measure("shared", steps, sources);
+    std::cout << "Peak RSS growth, copied outputs: " << copying / 1024 << " MB\n";
+    std::cout << "Peak RSS growth, shared outputs: " << shared / 1024 << " MB\n";
+    return 0;
+}
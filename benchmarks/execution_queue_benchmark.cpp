@@ -0,0 +1,134 @@
+// Workflow execution dispatch benchmark.
+//
+// Queues N executions (default 10000) spread over a handful of tenants, one
+// of which submits most of them, and dispatches them all two ways:
+//
+//   scan   replica of the former orchestrator loop: a linear search of the
+//          active executions map for the first PENDING entry; dispatched
+//          executions stay in the map while they run
+//   queue  ExecutionQueue::pop (FIFO and priority ordering)
+//
+// and reports the mean cost per dispatch plus how far into the dispatch
+// order each tenant's first execution lands.
+
+#include "execution_queue.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+enum class State { PENDING, RUNNING };
+
+struct Execution {
+    std::string tenant_id;
+    State state = State::PENDING;
+};
+
+struct Submission {
+    std::string execution_id;
+    std::string tenant_id;
+    int priority;
+};
+
+// One "bulk" tenant submits 90% of the executions up front, the others
+// trickle in behind it
+std::vector<Submission> make_submissions(size_t count, size_t tenants) {
+    std::vector<Submission> submissions;
+    submissions.reserve(count);
+    size_t bulk = count * 9 / 10;
+    for (size_t i = 0; i < count; ++i) {
+        std::string tenant = i < bulk ? "bulk" : "tenant-" + std::to_string(i % tenants);
+        submissions.push_back({"exec-" + std::to_string(1000000 + i), tenant, static_cast<int>(i % 3)});
+    }
+    return submissions;
+}
+
+struct Result {
+    double ns_per_dispatch = 0.0;
+    std::map<std::string, size_t> first_dispatch;  // Tenant -> dispatch position
+};
+
+Result run_scan(const std::vector<Submission>& submissions) {
+    std::map<std::string, std::shared_ptr<Execution>> active;
+    for (const auto& submission : submissions) {
+        auto execution = std::make_shared<Execution>();
+        execution->tenant_id = submission.tenant_id;
+        active[submission.execution_id] = execution;
+    }
+
+    Result result;
+    auto started = std::chrono::steady_clock::now();
+    for (size_t position = 0; position < submissions.size(); ++position) {
+        for (auto& pair : active) {
+            if (pair.second->state == State::PENDING) {
+                pair.second->state = State::RUNNING;
+                result.first_dispatch.emplace(pair.second->tenant_id, position);
+                break;
+            }
+        }
+    }
+    auto elapsed = std::chrono::steady_clock::now() - started;
+    result.ns_per_dispatch = std::chrono::duration<double, std::nano>(elapsed).count() / submissions.size();
+    return result;
+}
+
+Result run_queue(const std::vector<Submission>& submissions, ExecutionQueue::Ordering ordering) {
+    ExecutionQueue::Config config;
+    config.ordering = ordering;
+    ExecutionQueue queue(config);
+    std::map<std::string, std::string> tenants;
+    for (const auto& submission : submissions) {
+        queue.push(submission.execution_id, submission.tenant_id, submission.priority);
+        tenants[submission.execution_id] = submission.tenant_id;
+    }
+
+    Result result;
+    std::vector<std::string> order;
+    order.reserve(submissions.size());
+    std::string execution_id;
+    auto started = std::chrono::steady_clock::now();
+    while (queue.pop(execution_id)) {
+        order.push_back(execution_id);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - started;
+    result.ns_per_dispatch = std::chrono::duration<double, std::nano>(elapsed).count() / submissions.size();
+
+    for (size_t position = 0; position < order.size(); ++position) {
+        result.first_dispatch.emplace(tenants[order[position]], position);
+    }
+    return result;
+}
+
+void report(const char* name, const Result& result) {
+    size_t latest = 0;
+    for (const auto& pair : result.first_dispatch) {
+        latest = std::max(latest, pair.second);
+    }
+    std::cout << name << ": " << result.ns_per_dispatch << " ns/dispatch, "
+              << "latest first dispatch of a tenant at position " << latest << "\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000;
+    size_t tenants = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 8;
+    if (count == 0 || tenants == 0) {
+        std::cout << "Usage: " << argv[0] << " [executions] [tenants]\n";
+        return 1;
+    }
+
+    auto submissions = make_submissions(count, tenants);
+    std::cout << count << " queued executions, " << tenants << " tenants plus one bulk tenant\n";
+
+    report("scan          ", run_scan(submissions));
+    report("queue fifo    ", run_queue(submissions, ExecutionQueue::Ordering::FIFO));
+    report("queue priority", run_queue(submissions, ExecutionQueue::Ordering::PRIORITY));
+    return 0;
+}
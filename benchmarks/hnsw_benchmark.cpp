@@ -0,0 +1,105 @@
+// HNSW recall@k vs queries per second, against exact flat search.
+//
+// Builds a FlatVectorIndex and an HnswIndex over the same synthetic corpus
+// (vectors scattered around random cluster centres, which is closer to real
+// embeddings than uniform noise), takes the flat index's top-k as ground
+// truth, and reports recall@k and single-thread QPS of the HNSW index for a
+// range of ef_search values.
+
+#include "hnsw_index.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+using namespace kolosal;
+
+namespace {
+
+std::vector<std::vector<float>> make_corpus(size_t count, size_t dimension, size_t clusters, std::mt19937& gen) {
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    std::vector<std::vector<float>> centres(clusters, std::vector<float>(dimension));
+    for (auto& centre : centres) {
+        for (auto& value : centre) {
+            value = dist(gen);
+        }
+    }
+    std::uniform_int_distribution<size_t> pick(0, clusters - 1);
+    std::vector<std::vector<float>> vectors(count, std::vector<float>(dimension));
+    for (auto& vector : vectors) {
+        const auto& centre = centres[pick(gen)];
+        for (size_t i = 0; i < dimension; ++i) {
+            vector[i] = centre[i] + 0.6f * dist(gen);
+        }
+    }
+    return vectors;
+}
+
+double seconds_since(std::chrono::steady_clock::time_point started) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+    size_t dimension = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 128;
+    size_t queries = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 200;
+    size_t threads = argc > 4 ? std::strtoull(argv[4], nullptr, 10) : std::thread::hardware_concurrency();
+    const size_t k = 10;
+
+    std::mt19937 gen(7);
+    auto corpus = make_corpus(count + queries, dimension, 256, gen);
+    std::vector<std::vector<float>> query_vectors(corpus.end() - queries, corpus.end());
+    corpus.resize(count);
+    std::vector<std::string> ids(count);
+    for (size_t i = 0; i < count; ++i) {
+        ids[i] = "doc-" + std::to_string(i);
+    }
+
+    FlatVectorIndex flat(dimension);
+    flat.add_batch(ids, corpus, 1);
+
+    HnswIndex::Config config;
+    HnswIndex hnsw(dimension, config);
+    auto build_started = std::chrono::steady_clock::now();
+    hnsw.add_batch(ids, corpus, threads);
+    double build_seconds = seconds_since(build_started);
+
+    std::vector<std::unordered_set<std::string>> truth;
+    auto flat_started = std::chrono::steady_clock::now();
+    for (const auto& query : query_vectors) {
+        std::unordered_set<std::string> top;
+        for (const auto& hit : flat.search(query, k, -1.0f)) {
+            top.insert(hit.id);
+        }
+        truth.push_back(std::move(top));
+    }
+    double flat_qps = queries / seconds_since(flat_started);
+
+    std::cout << count << " vectors of dimension " << dimension << ", " << queries << " queries, recall@" << k
+              << ", kernel: " << vector_kernels::active_kernel() << "\n";
+    std::cout << "HNSW M=" << config.M << " efConstruction=" << config.ef_construction << " built in "
+              << build_seconds << " s on " << threads << " threads\n";
+    std::cout << "flat (exact)      recall 1.000  " << flat_qps << " QPS\n";
+
+    for (size_t ef : {16, 32, 64, 128, 256}) {
+        hnsw.set_ef_search(ef);
+        size_t found = 0;
+        auto started = std::chrono::steady_clock::now();
+        for (size_t q = 0; q < queries; ++q) {
+            for (const auto& hit : hnsw.search(query_vectors[q], k, -1.0f)) {
+                found += truth[q].count(hit.id);
+            }
+        }
+        double qps = queries / seconds_since(started);
+        std::cout << "HNSW efSearch=" << ef << (ef < 100 ? "  " : " ") << " recall "
+                  << static_cast<double>(found) / static_cast<double>(queries * k) << "  " << qps << " QPS\n";
+    }
+    return 0;
+}
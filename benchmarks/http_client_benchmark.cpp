@@ -0,0 +1,261 @@
+// HttpClient per-request overhead benchmark.
+//
+// Starts a local keep-alive stub server that answers every request with a
+// small JSON body, then issues the same number of requests three ways:
+//
+//   fresh-handle  a new CURL easy handle per request (the former behaviour)
+//   pooled        HttpClient::request, which reuses pooled handles
+//   async         HttpClient::request_async with --concurrency in flight
+//
+// and reports the mean cost per request plus how many TCP connections the
+// stub server accepted. --delay-ms makes the stub wait before answering, to
+// show the async engine overlapping slow responses on one thread.
+
+#include "http_client.hpp"
+
+#include <arpa/inet.h>
+#include <curl/curl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Options {
+    int requests = 2000;
+    int concurrency = 32;
+    int delay_ms = 0;
+};
+
+class StubServer {
+public:
+    explicit StubServer(int delay_ms) : delay_ms_(delay_ms) {
+        listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = 0;
+        if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+            listen(listen_fd_, 512) < 0) {
+            throw std::runtime_error("stub server: bind/listen failed");
+        }
+        socklen_t length = sizeof(address);
+        getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&address), &length);
+        port_ = ntohs(address.sin_port);
+        accept_thread_ = std::thread([this] { accept_loop(); });
+    }
+
+    ~StubServer() {
+        running_ = false;
+        shutdown(listen_fd_, SHUT_RDWR);
+        close(listen_fd_);
+        accept_thread_.join();
+    }
+
+    int port() const { return port_; }
+    size_t connections() const { return connections_.load(); }
+    void reset_connections() { connections_ = 0; }
+
+private:
+    int listen_fd_ = -1;
+    int port_ = 0;
+    int delay_ms_;
+    std::atomic<bool> running_{true};
+    std::atomic<size_t> connections_{0};
+    std::thread accept_thread_;
+
+    void accept_loop() {
+        while (running_) {
+            int fd = accept(listen_fd_, nullptr, nullptr);
+            if (fd < 0) {
+                continue;
+            }
+            connections_++;
+            std::thread([this, fd] { serve(fd); }).detach();
+        }
+    }
+
+    void serve(int fd) {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        static const char response[] =
+            "HTTP/1.1 200 OK\r\n"
+            "Content-Type: application/json\r\n"
+            "Content-Length: 15\r\n"
+            "\r\n"
+            "{\"status\":\"ok\"}";
+
+        std::string buffer;
+        char chunk[8192];
+        while (running_) {
+            size_t header_end = buffer.find("\r\n\r\n");
+            if (header_end == std::string::npos) {
+                ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+                if (received <= 0) {
+                    break;
+                }
+                buffer.append(chunk, static_cast<size_t>(received));
+                continue;
+            }
+
+            size_t content_length = 0;
+            std::string headers = buffer.substr(0, header_end);
+            std::transform(headers.begin(), headers.end(), headers.begin(), ::tolower);
+            size_t pos = headers.find("content-length:");
+            if (pos != std::string::npos) {
+                content_length = std::strtoull(headers.c_str() + pos + 15, nullptr, 10);
+            }
+            size_t request_size = header_end + 4 + content_length;
+            if (buffer.size() < request_size) {
+                ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+                if (received <= 0) {
+                    break;
+                }
+                buffer.append(chunk, static_cast<size_t>(received));
+                continue;
+            }
+            buffer.erase(0, request_size);
+
+            if (delay_ms_ > 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms_));
+            }
+            if (send(fd, response, sizeof(response) - 1, MSG_NOSIGNAL) < 0) {
+                break;
+            }
+        }
+        close(fd);
+    }
+};
+
+size_t discard_body(void*, size_t size, size_t nmemb, void*) {
+    return size * nmemb;
+}
+
+// Replica of the former HttpClient::perform_curl_request handle lifecycle
+bool fresh_handle_request(const std::string& url) {
+    CURL* curl = curl_easy_init();
+    if (!curl) {
+        return false;
+    }
+    curl_slist* headers = curl_slist_append(nullptr, "Content-Type: application/json");
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, discard_body);
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
+    CURLcode res = curl_easy_perform(curl);
+    long code = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &code);
+    curl_slist_free_all(headers);
+    curl_easy_cleanup(curl);
+    return res == CURLE_OK && code == 200;
+}
+
+struct Measurement {
+    double seconds = 0.0;
+    size_t failures = 0;
+    size_t connections = 0;
+};
+
+template <typename Fn>
+Measurement measure(StubServer& server, Fn&& run) {
+    server.reset_connections();
+    auto started = std::chrono::steady_clock::now();
+    size_t failures = run();
+    Measurement measurement;
+    measurement.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    measurement.failures = failures;
+    measurement.connections = server.connections();
+    return measurement;
+}
+
+void report(const char* name, const Measurement& measurement, int requests) {
+    std::cout << name << ": "
+              << measurement.seconds * 1e6 / requests << " us/request, "
+              << requests / measurement.seconds << " req/s, "
+              << measurement.connections << " connections, "
+              << measurement.failures << " failures\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> int { return i + 1 < argc ? std::atoi(argv[++i]) : 0; };
+        if (arg == "--requests") options.requests = std::max(1, next());
+        else if (arg == "--concurrency") options.concurrency = std::max(1, next());
+        else if (arg == "--delay-ms") options.delay_ms = std::max(0, next());
+        else {
+            std::cout << "Usage: " << argv[0] << " [--requests N] [--concurrency N] [--delay-ms N]\n";
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    StubServer server(options.delay_ms);
+    std::string base_url = "http://127.0.0.1:" + std::to_string(server.port());
+    std::cout << "Stub server on " << base_url << ", " << options.requests << " requests, "
+              << "response delay " << options.delay_ms << "ms\n";
+
+    Measurement fresh = measure(server, [&] {
+        size_t failures = 0;
+        for (int i = 0; i < options.requests; ++i) {
+            failures += fresh_handle_request(base_url + "/health") ? 0 : 1;
+        }
+        return failures;
+    });
+
+    HttpClient::Config config;
+    config.base_url = base_url;
+    config.max_retries = 0;
+    config.max_async_in_flight = static_cast<size_t>(options.concurrency);
+    config.max_pooled_handles = static_cast<size_t>(options.concurrency);
+    HttpClient client(config);
+
+    Measurement pooled = measure(server, [&] {
+        size_t failures = 0;
+        for (int i = 0; i < options.requests; ++i) {
+            failures += client.request("GET", "/health").is_success() ? 0 : 1;
+        }
+        return failures;
+    });
+
+    Measurement async = measure(server, [&] {
+        std::vector<std::future<HttpClient::Result>> futures;
+        futures.reserve(options.requests);
+        for (int i = 0; i < options.requests; ++i) {
+            futures.push_back(client.request_async("GET", "/health"));
+        }
+        size_t failures = 0;
+        for (auto& future : futures) {
+            failures += future.get().is_success() ? 0 : 1;
+        }
+        return failures;
+    });
+
+    report("fresh-handle", fresh, options.requests);
+    report("pooled      ", pooled, options.requests);
+    report("async       ", async, options.requests);
+
+    auto stats = client.get_stats();
+    std::cout << "HttpClient handles: " << stats.handles_created << " created, "
+              << stats.handles_reused << " reused, " << stats.idle_handles << " idle\n";
+
+    curl_global_cleanup();
+    return fresh.failures + pooled.failures + async.failures == 0 ? 0 : 2;
+}
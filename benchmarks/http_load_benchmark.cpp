@@ -0,0 +1,255 @@
+// HTTP load generator for the kolosal-agent front end.
+//
+// Opens N concurrent client connections against a running server and issues
+// requests for a fixed duration, then reports throughput and latency
+// percentiles. Use it to compare io_model settings, e.g.
+//
+//   http_load_benchmark --port 8080 --path /status --connections 256 --duration 10
+//
+// --keep-alive reuses each connection and --pipeline N sends N requests
+// back-to-back before reading the responses, to measure connection reuse.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Options {
+    std::string host = "127.0.0.1";
+    int port = 8080;
+    std::string method = "GET";
+    std::string path = "/status";
+    std::string body;
+    int connections = 64;
+    int duration_seconds = 10;
+    bool keep_alive = false;
+    int pipeline = 1;
+};
+
+constexpr std::chrono::milliseconds MIN_CONNECT_BACKOFF{10};
+constexpr std::chrono::milliseconds MAX_CONNECT_BACKOFF{500};
+
+struct WorkerResult {
+    std::vector<double> latencies_ms;
+    size_t errors = 0;
+};
+
+int connect_to(const Options& options) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(options.port));
+    inet_pton(AF_INET, options.host.c_str(), &address.sin_addr);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Consumes one response from the connection buffer, reading more as needed.
+// Sets status to the response's status code, and server_closes when the
+// response carries "Connection: close".
+bool read_response(int fd, std::string& buffer, int& status, bool& server_closes) {
+    char chunk[8192];
+    size_t header_end = std::string::npos;
+    size_t content_length = 0;
+
+    while (true) {
+        if (header_end == std::string::npos) {
+            header_end = buffer.find("\r\n\r\n");
+            if (header_end != std::string::npos) {
+                std::string headers = buffer.substr(0, header_end);
+                std::transform(headers.begin(), headers.end(), headers.begin(), ::tolower);
+                // "HTTP/1.1 NNN Reason"; anything unparsable counts as a failure
+                size_t space = headers.find(' ');
+                status = space == std::string::npos ? 0 : std::atoi(headers.c_str() + space + 1);
+                size_t pos = headers.find("content-length:");
+                if (pos != std::string::npos) {
+                    content_length = std::strtoull(headers.c_str() + pos + 15, nullptr, 10);
+                }
+                server_closes = headers.find("connection: close") != std::string::npos;
+            }
+        }
+        if (header_end != std::string::npos && buffer.size() >= header_end + 4 + content_length) {
+            buffer.erase(0, header_end + 4 + content_length);
+            return true;
+        }
+
+        ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+        if (received <= 0) {
+            return false;
+        }
+        buffer.append(chunk, static_cast<size_t>(received));
+    }
+}
+
+void run_worker(const Options& options, const std::string& request,
+                std::chrono::steady_clock::time_point deadline, WorkerResult& result) {
+    const int depth = options.keep_alive ? options.pipeline : 1;
+    std::string batch;
+    for (int i = 0; i < depth; ++i) {
+        batch += request;
+    }
+
+    int fd = -1;
+    std::string buffer;
+    // Backoff between failed connects, so a stopped or saturated server is
+    // not hammered in a tight loop that also floods the error count
+    auto connect_backoff = MIN_CONNECT_BACKOFF;
+    while (std::chrono::steady_clock::now() < deadline) {
+        auto started = std::chrono::steady_clock::now();
+        if (fd < 0) {
+            fd = connect_to(options);
+            buffer.clear();
+            if (fd < 0) {
+                ++result.errors;
+                std::this_thread::sleep_for(std::min(connect_backoff,
+                    std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now())));
+                connect_backoff = std::min(connect_backoff * 2, MAX_CONNECT_BACKOFF);
+                continue;
+            }
+            connect_backoff = MIN_CONNECT_BACKOFF;
+        }
+
+        bool ok = send(fd, batch.data(), batch.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(batch.size());
+        bool server_closes = !options.keep_alive;
+        int answered = 0;
+        int succeeded = 0;
+        while (ok && answered < depth) {
+            int status = 0;
+            ok = read_response(fd, buffer, status, server_closes);
+            if (ok) {
+                ++answered;
+                if (status >= 200 && status < 300) {
+                    ++succeeded;
+                }
+            }
+        }
+        auto elapsed = std::chrono::steady_clock::now() - started;
+
+        // Only successful responses count towards throughput and latency;
+        // 4xx/5xx (including the 503 sent when shedding load) are errors
+        for (int i = 0; i < succeeded; ++i) {
+            result.latencies_ms.push_back(std::chrono::duration<double, std::milli>(elapsed).count());
+        }
+        result.errors += static_cast<size_t>(answered - succeeded);
+        // The server may end a persistent connection at its request limit;
+        // requests pipelined past that point are simply not answered.
+        if (!server_closes) {
+            result.errors += static_cast<size_t>(depth - answered);
+        }
+        if (!ok || server_closes || !options.keep_alive) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t index = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1));
+    return sorted[index];
+}
+
+void print_usage(const char* program) {
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  --host <addr>         Server address (default 127.0.0.1)\n"
+              << "  --port <port>         Server port (default 8080)\n"
+              << "  --method <method>     HTTP method (default GET)\n"
+              << "  --path <path>         Request path (default /status)\n"
+              << "  --body <json>         Request body\n"
+              << "  --connections <n>     Concurrent connections (default 64)\n"
+              << "  --duration <seconds>  Test duration (default 10)\n"
+              << "  --keep-alive          Reuse connections between requests\n"
+              << "  --pipeline <depth>    Pipelined requests per round trip (with --keep-alive)\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string { return i + 1 < argc ? argv[++i] : ""; };
+        if (arg == "--host") options.host = next();
+        else if (arg == "--port") options.port = std::atoi(next().c_str());
+        else if (arg == "--method") options.method = next();
+        else if (arg == "--path") options.path = next();
+        else if (arg == "--body") options.body = next();
+        else if (arg == "--connections") options.connections = std::max(1, std::atoi(next().c_str()));
+        else if (arg == "--duration") options.duration_seconds = std::max(1, std::atoi(next().c_str()));
+        else if (arg == "--keep-alive") options.keep_alive = true;
+        else if (arg == "--pipeline") options.pipeline = std::max(1, std::atoi(next().c_str()));
+        else {
+            print_usage(argv[0]);
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    std::string request = options.method + " " + options.path + " HTTP/1.1\r\n"
+                          "Host: " + options.host + "\r\n"
+                          "Content-Type: application/json\r\n"
+                          "Content-Length: " + std::to_string(options.body.size()) + "\r\n"
+                          "Connection: " + std::string(options.keep_alive ? "keep-alive" : "close") + "\r\n"
+                          "\r\n" + options.body;
+
+    std::cout << "Running " << options.method << " " << options.path << " against "
+              << options.host << ":" << options.port << " with " << options.connections
+              << " connections for " << options.duration_seconds << "s"
+              << (options.keep_alive ? " (keep-alive, pipeline " + std::to_string(options.pipeline) + ")" : "")
+              << "\n";
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(options.duration_seconds);
+    std::vector<WorkerResult> results(options.connections);
+    std::vector<std::thread> workers;
+    auto started = std::chrono::steady_clock::now();
+    for (int i = 0; i < options.connections; ++i) {
+        workers.emplace_back(run_worker, std::cref(options), std::cref(request), deadline, std::ref(results[i]));
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    double elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    std::vector<double> latencies;
+    size_t errors = 0;
+    for (const auto& result : results) {
+        latencies.insert(latencies.end(), result.latencies_ms.begin(), result.latencies_ms.end());
+        errors += result.errors;
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    std::cout << "Requests:   " << latencies.size() << " ok, " << errors << " errors\n";
+    std::cout << "Throughput: " << static_cast<double>(latencies.size()) / elapsed_s << " req/s\n";
+    std::cout << "Latency ms: p50=" << percentile(latencies, 0.50)
+              << " p90=" << percentile(latencies, 0.90)
+              << " p99=" << percentile(latencies, 0.99)
+              << " max=" << (latencies.empty() ? 0.0 : latencies.back()) << "\n";
+    return errors == 0 ? 0 : 2;
+}
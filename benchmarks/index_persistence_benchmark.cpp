@@ -0,0 +1,107 @@
+// Local vector store restart cost: rebuilding from embeddings vs loading a saved index file.
+//
+// Fills a FAISSVectorStore with synthetic documents and unit vectors. It
+// times building the index from those embeddings, which is what every
+// restart paid before, not counting the embedding calls themselves. Then it
+// times save_index(), load_index() (memory-mapped) and the first search
+// after loading, plus an incremental save of 1% new documents as an append
+// segment.
+
+#include "functions/retrieval.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace kolosal;
+
+namespace {
+
+std::vector<float> random_vector(std::mt19937& gen, size_t dimension) {
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    std::vector<float> vector(dimension);
+    for (auto& value : vector) {
+        value = dist(gen);
+    }
+    return vector;
+}
+
+double ms_since(std::chrono::steady_clock::time_point started) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 50000;
+    size_t dimension = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 384;
+    std::string index_type = argc > 3 ? argv[3] : "HNSW";
+    std::string path = (std::filesystem::temp_directory_path() / "kolosal_index_benchmark.kv").string();
+    std::filesystem::remove(path);
+
+    std::mt19937 gen(42);
+    std::vector<Document> documents;
+    std::vector<std::vector<float>> embeddings;
+    for (size_t i = 0; i < count; ++i) {
+        documents.emplace_back("doc-" + std::to_string(i),
+                               "Synthetic document " + std::to_string(i) + " with a paragraph of body text that "
+                               "stands in for a chunk of a real file; chunks are a few hundred bytes long.",
+                               "benchmark");
+        embeddings.push_back(random_vector(gen, dimension));
+    }
+
+    FAISSVectorStore store(dimension, index_type);
+    store.initialize();
+    auto started = std::chrono::steady_clock::now();
+    store.add_documents(documents, embeddings);
+    double build_ms = ms_since(started);
+
+    started = std::chrono::steady_clock::now();
+    if (!store.save_index(path)) {
+        std::cerr << "save_index failed\n";
+        return 1;
+    }
+    double save_ms = ms_since(started);
+    size_t base_bytes = std::filesystem::file_size(path);
+
+    std::vector<Document> more;
+    std::vector<std::vector<float>> more_embeddings;
+    for (size_t i = 0; i < count / 100; ++i) {
+        more.emplace_back("new-" + std::to_string(i), "Document added after the first save", "benchmark");
+        more_embeddings.push_back(random_vector(gen, dimension));
+    }
+    store.add_documents(more, more_embeddings);
+    started = std::chrono::steady_clock::now();
+    store.save_index(path);
+    double append_ms = ms_since(started);
+    size_t append_bytes = std::filesystem::file_size(path) - base_bytes;
+
+    FAISSVectorStore restored(dimension, index_type);
+    started = std::chrono::steady_clock::now();
+    if (!restored.load_index(path)) {
+        std::cerr << "load_index failed\n";
+        return 1;
+    }
+    double load_ms = ms_since(started);
+    started = std::chrono::steady_clock::now();
+    auto results = restored.search(embeddings[count / 2], 10);
+    double first_search_ms = ms_since(started);
+    if (results.empty() || results.front().id != documents[count / 2].id) {
+        std::cerr << "Restored store did not find a stored vector\n";
+        return 1;
+    }
+
+    std::cout << count << " documents, dimension " << dimension << ", " << index_type << " index\n";
+    std::cout << "build from embeddings:  " << build_ms << " ms\n";
+    std::cout << "save (base segment):    " << save_ms << " ms, " << base_bytes / (1024.0 * 1024.0) << " MiB\n";
+    std::cout << "save (" << more.size() << " added):      " << append_ms << " ms, " << append_bytes / 1024.0
+              << " KiB appended\n";
+    std::cout << "load_index:             " << load_ms << " ms\n";
+    std::cout << "first search:           " << first_search_ms << " ms\n";
+    std::filesystem::remove(path);
+    return 0;
+}
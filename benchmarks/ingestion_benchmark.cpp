@@ -0,0 +1,155 @@
+// Document ingestion throughput: per-document adds vs the batched ingestion pipeline.
+//
+// Ingests a synthetic corpus into a RetrievalManager twice. The first run
+// uses the old batch_add_documents() scheme: one std::async per 100
+// documents, each calling add_document() per document. The second run uses
+// the pipeline. Every tenth document is long enough to be split into chunks.
+//
+// Two embedders are measured:
+// - "placeholder" is the built-in hash embedding. It shows the cost of the
+//   pipeline itself.
+// - "model" simulates an embedding server. It serves one call at a time,
+//   with a fixed cost per call plus a cost per text, so batching pays off
+//   the way it does with a real model.
+
+#include "functions/retrieval.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace kolosal;
+
+namespace {
+
+std::vector<float> hash_embedding(const std::string& text, size_t dimension) {
+    std::mt19937 gen(std::hash<std::string>()(text));
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    std::vector<float> vector(dimension);
+    for (auto& value : vector) {
+        value = dist(gen);
+    }
+    return normalize_vector(vector);
+}
+
+// One call at a time, like a single inference engine
+class SimulatedModel {
+public:
+    SimulatedModel(size_t dimension, std::chrono::microseconds per_call, std::chrono::microseconds per_text)
+        : dimension_(dimension), per_call_(per_call), per_text_(per_text) {}
+
+    std::vector<std::vector<float>> embed(const std::vector<std::string>& texts) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto deadline = std::chrono::steady_clock::now() + per_call_ + per_text_ * texts.size();
+        std::vector<std::vector<float>> embeddings;
+        embeddings.reserve(texts.size());
+        for (const auto& text : texts) {
+            embeddings.push_back(hash_embedding(text, dimension_));
+        }
+        std::this_thread::sleep_until(deadline);
+        calls_++;
+        return embeddings;
+    }
+
+    size_t calls() const { return calls_; }
+
+private:
+    size_t dimension_;
+    std::chrono::microseconds per_call_;
+    std::chrono::microseconds per_text_;
+    std::mutex mutex_;
+    size_t calls_ = 0;
+};
+
+std::vector<Document> make_corpus(size_t count) {
+    const std::string sentence = "Synthetic document body text that stands in for a paragraph of a real file. ";
+    std::vector<Document> documents;
+    documents.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        std::string content = "Document " + std::to_string(i) + ". ";
+        size_t sentences = i % 10 == 0 ? 20 : 3;  // ~1.6 KB (4 chunks) or ~250 bytes
+        for (size_t s = 0; s < sentences; ++s) {
+            content += sentence;
+        }
+        documents.emplace_back("doc-" + std::to_string(i), content, "benchmark");
+    }
+    return documents;
+}
+
+// The scheme batch_add_documents() used before the pipeline
+std::vector<std::string> add_per_document(RetrievalManager& manager, const std::vector<Document>& documents) {
+    const size_t batch_size = 100;
+    std::vector<std::future<std::vector<std::string>>> futures;
+    for (size_t i = 0; i < documents.size(); i += batch_size) {
+        size_t end = std::min(i + batch_size, documents.size());
+        futures.push_back(std::async(std::launch::async, [&manager, &documents, i, end]() {
+            std::vector<std::string> ids;
+            for (size_t j = i; j < end; ++j) {
+                ids.push_back(manager.add_document(documents[j]));
+            }
+            return ids;
+        }));
+    }
+    std::vector<std::string> ids;
+    for (auto& future : futures) {
+        auto batch_ids = future.get();
+        ids.insert(ids.end(), batch_ids.begin(), batch_ids.end());
+    }
+    return ids;
+}
+
+void run(const std::string& embedder, const std::vector<Document>& documents, size_t dimension,
+         std::chrono::microseconds per_call, std::chrono::microseconds per_text) {
+    RetrievalConfig config;
+    config.embedding_dimension = dimension;
+
+    for (bool pipeline : {false, true}) {
+        RetrievalManager manager;
+        manager.initialize(config);
+        SimulatedModel model(dimension, per_call, per_text);
+        if (embedder == "model") {
+            manager.set_embedding_function([&model](const std::vector<std::string>& texts) {
+                return model.embed(texts);
+            });
+        }
+
+        auto started = std::chrono::steady_clock::now();
+        auto ids = pipeline ? manager.batch_add_documents(documents) : add_per_document(manager, documents);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+        size_t stored = 0;
+        for (const auto& id : ids) {
+            stored += !id.empty();
+        }
+        std::cout << embedder << "\t" << (pipeline ? "pipeline" : "per-document") << "\t" << stored << "\t"
+                  << seconds << "\t" << static_cast<size_t>(documents.size() / seconds);
+        if (embedder == "model") {
+            std::cout << "\t" << model.calls();
+        }
+        std::cout << std::endl;
+    }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+    size_t dimension = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 384;
+    std::chrono::microseconds per_call(argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 200);
+    std::chrono::microseconds per_text(argc > 4 ? std::strtoull(argv[4], nullptr, 10) : 10);
+
+    auto documents = make_corpus(count);
+    std::cout << count << " documents, dimension " << dimension << ", model cost " << per_call.count()
+              << " us per call + " << per_text.count() << " us per text, "
+              << std::thread::hardware_concurrency() << " hardware threads\n";
+    std::cout << "embedder\tpath\tstored\tseconds\tdocs/sec\tmodel calls\n";
+    run("placeholder", documents, dimension, per_call, per_text);
+    run("model", documents, dimension, per_call, per_text);
+    return 0;
+}
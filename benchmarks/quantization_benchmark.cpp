@@ -0,0 +1,130 @@
+// Memory and recall of quantized vector storage against the exact flat index.
+//
+// Builds a FlatVectorIndex and QuantizedVectorIndex variants (int8 scalar and
+// product quantization, each with and without exact re-ranking) over the
+// same synthetic corpus of vectors scattered around random cluster centres.
+// The flat index's top-k is the ground truth. For each variant the benchmark
+// reports vector memory per million vectors, recall@k and single-thread QPS.
+
+#include "quantized_index.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+using namespace kolosal;
+
+namespace {
+
+std::vector<std::vector<float>> make_corpus(size_t count, size_t dimension, size_t clusters, std::mt19937& gen) {
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    std::vector<std::vector<float>> centres(clusters, std::vector<float>(dimension));
+    for (auto& centre : centres) {
+        for (auto& value : centre) {
+            value = dist(gen);
+        }
+    }
+    std::uniform_int_distribution<size_t> pick(0, clusters - 1);
+    std::vector<std::vector<float>> vectors(count, std::vector<float>(dimension));
+    for (auto& vector : vectors) {
+        const auto& centre = centres[pick(gen)];
+        for (size_t i = 0; i < dimension; ++i) {
+            vector[i] = centre[i] + 0.6f * dist(gen);
+        }
+    }
+    return vectors;
+}
+
+double seconds_since(std::chrono::steady_clock::time_point started) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+}
+
+void report(const std::string& name, size_t bytes, size_t count, double recall, double qps) {
+    std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(8) << static_cast<double>(bytes) / count * 1e6 / (1024.0 * 1024.0) << " MiB/M"
+              << std::setprecision(3) << std::setw(10) << recall << std::setprecision(0) << std::setw(10) << qps
+              << " QPS\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+    size_t dimension = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 384;
+    size_t queries = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 200;
+    const size_t k = 10;
+
+    std::mt19937 gen(7);
+    auto corpus = make_corpus(count + queries, dimension, 256, gen);
+    std::vector<std::vector<float>> query_vectors(corpus.end() - queries, corpus.end());
+    corpus.resize(count);
+    std::vector<std::string> ids(count);
+    for (size_t i = 0; i < count; ++i) {
+        ids[i] = "doc-" + std::to_string(i);
+    }
+
+    FlatVectorIndex flat(dimension);
+    flat.add_batch(ids, corpus, 1);
+    std::vector<std::unordered_set<std::string>> truth;
+    auto flat_started = std::chrono::steady_clock::now();
+    for (const auto& query : query_vectors) {
+        std::unordered_set<std::string> top;
+        for (const auto& hit : flat.search(query, k, -1.0f)) {
+            top.insert(hit.id);
+        }
+        truth.push_back(std::move(top));
+    }
+    double flat_qps = queries / seconds_since(flat_started);
+
+    std::cout << count << " vectors of dimension " << dimension << ", " << queries << " queries, recall@" << k
+              << ", kernel: " << vector_kernels::active_kernel() << "\n";
+    report("flat (float32)", count * vector_kernels::padded_dimension(dimension) * sizeof(float), count, 1.0,
+           flat_qps);
+
+    struct Variant {
+        std::string name;
+        QuantizedVectorIndex::Config config;
+    };
+    std::vector<Variant> variants;
+    auto add_variant = [&](const std::string& name, QuantizedVectorIndex::Encoding encoding, size_t subvectors,
+                           size_t rerank) {
+        QuantizedVectorIndex::Config config;
+        config.encoding = encoding;
+        config.pq_subvectors = subvectors;
+        config.rerank_candidates = rerank;
+        variants.push_back({name, config});
+    };
+    add_variant("SQ8", QuantizedVectorIndex::Encoding::Scalar8, 0, 0);
+    add_variant("SQ8 + rerank 40", QuantizedVectorIndex::Encoding::Scalar8, 0, 40);
+    add_variant("PQ d/4", QuantizedVectorIndex::Encoding::Product, dimension / 4, 0);
+    add_variant("PQ d/4 + rerank 100", QuantizedVectorIndex::Encoding::Product, dimension / 4, 100);
+    add_variant("PQ d/8", QuantizedVectorIndex::Encoding::Product, dimension / 8, 0);
+    add_variant("PQ d/8 + rerank 100", QuantizedVectorIndex::Encoding::Product, dimension / 8, 100);
+    add_variant("PQ d/16", QuantizedVectorIndex::Encoding::Product, dimension / 16, 0);
+    add_variant("PQ d/16 + rerank 200", QuantizedVectorIndex::Encoding::Product, dimension / 16, 200);
+
+    for (const auto& variant : variants) {
+        QuantizedVectorIndex index(dimension, variant.config);
+        auto build_started = std::chrono::steady_clock::now();
+        index.add_batch(ids, corpus, 1);
+        double build_seconds = seconds_since(build_started);
+
+        size_t found = 0;
+        auto started = std::chrono::steady_clock::now();
+        for (size_t q = 0; q < queries; ++q) {
+            for (const auto& hit : index.search(query_vectors[q], k, -1.0f)) {
+                found += truth[q].count(hit.id);
+            }
+        }
+        double qps = queries / seconds_since(started);
+        report(variant.name + (index.trained() ? "" : " (untrained)"), index.memory_usage(), count,
+               static_cast<double>(found) / static_cast<double>(queries * k), qps);
+        std::cout << std::setprecision(2) << "    built in " << build_seconds << " s\n";
+    }
+    return 0;
+}
@@ -0,0 +1,133 @@
+// Route resolution micro-benchmark.
+//
+// Registers every endpoint HTTPServer serves in an HttpRouter and measures the
+// average cost of resolving a mix of request paths, next to a replica of the
+// previous if/else prefix chain for comparison.
+
+#include "http_router.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Route {
+    const char* method;
+    const char* pattern;
+};
+
+const std::vector<Route> ROUTES = {
+    {"GET", "/agents"},
+    {"POST", "/agents"},
+    {"GET", "/agents/{id}"},
+    {"DELETE", "/agents/{id}"},
+    {"PUT", "/agents/{id}/start"},
+    {"PUT", "/agents/{id}/stop"},
+    {"POST", "/agents/{id}/execute"},
+    {"POST", "/agent/execute"},
+    {"GET", "/status"},
+    {"GET", "/workflows"},
+    {"POST", "/workflows"},
+    {"GET", "/workflows/{id}"},
+    {"PUT", "/workflows/{id}"},
+    {"DELETE", "/workflows/{id}"},
+    {"POST", "/workflows/{id}/execute"},
+    {"GET", "/workflows/executions"},
+    {"GET", "/workflows/executions/{id}"},
+    {"PUT", "/workflows/executions/{id}/{action}"},
+    {"GET", "/workflows/executions/{id}/{action}"},
+    {"GET", "/workflow_templates"},
+    {"POST", "/workflow_templates/{id}/execute"},
+    {"GET", "/workflow_executions/{id}/progress"},
+    {"GET", "/workflow_executions/{id}/logs"},
+    {"GET", "/workflow_executions/{id}/events"},
+};
+
+struct Request {
+    std::string method;
+    std::string path;
+};
+
+const std::vector<Request> REQUESTS = {
+    {"GET", "/agents"},
+    {"GET", "/agents/research-assistant"},
+    {"POST", "/agents/3f2b7c1e-5d8a-4b6e-9c0f-1a2b3c4d5e6f/execute"},
+    {"PUT", "/agents/research-assistant/stop"},
+    {"GET", "/status"},
+    {"GET", "/workflows/executions"},
+    {"GET", "/workflows/executions/exec-12345"},
+    {"PUT", "/workflows/executions/exec-12345/pause"},
+    {"POST", "/workflow_templates/research_analysis/execute"},
+    {"GET", "/workflow_executions/exec-12345/progress"},
+    {"GET", "/workflow_executions/exec-12345/logs"},
+    {"GET", "/does/not/exist"},
+};
+
+// Replica of the matching logic of the former HTTPServer::handle_client chain.
+int legacy_resolve(const std::string& method, const std::string& path) {
+    if (path == "/agents" && method == "GET") return 1;
+    if (path == "/agents" && method == "POST") return 2;
+    if (path.find("/agents/") == 0 && method == "GET") {
+        std::string id = path.substr(8);
+        if (!id.empty() && path == "/agents/" + id) return 3;
+        return 0;
+    }
+    if (path.find("/agents/") == 0 && path.find("/start") != std::string::npos && method == "PUT") return 4;
+    if (path.find("/agents/") == 0 && path.find("/stop") != std::string::npos && method == "PUT") return 5;
+    if (path.find("/agents/") == 0 && path.find("/execute") != std::string::npos && method == "POST") return 6;
+    if (path == "/agent/execute" && method == "POST") return 7;
+    if (path.find("/agents/") == 0 && method == "DELETE") return 8;
+    if (path == "/status" && method == "GET") return 9;
+    if (path == "/workflows" && method == "GET") return 10;
+    if (path == "/workflows" && method == "POST") return 11;
+    if (path.find("/workflows/") == 0 && path.find("/execute") != std::string::npos && method == "POST") return 12;
+    if (path.find("/workflows/executions/") == 0 && method == "GET") return 13;
+    if (path.find("/workflows/executions/") == 0 && method == "PUT") return 14;
+    if (path == "/workflows/executions" && method == "GET") return 15;
+    if (path.find("/workflows/") == 0 && method == "GET" && path.find("/execute") == std::string::npos) return 16;
+    if (path.find("/workflows/") == 0 && method == "PUT") return 17;
+    if (path.find("/workflows/") == 0 && method == "DELETE") return 18;
+    if (path == "/workflow_templates" && method == "GET") return 19;
+    if (path.find("/workflow_templates/") == 0 && path.find("/execute") != std::string::npos && method == "POST") return 20;
+    if (path.find("/workflow_executions/") == 0 && path.find("/progress") != std::string::npos && method == "GET") return 21;
+    if (path.find("/workflow_executions/") == 0 && path.find("/logs") != std::string::npos && method == "GET") return 22;
+    return 0;
+}
+
+template <typename Fn>
+double measure_ns(size_t iterations, Fn&& fn) {
+    auto started = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        fn(REQUESTS[i % REQUESTS.size()]);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - started;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    size_t iterations = argc > 1 ? std::stoull(argv[1]) : 5000000;
+
+    HttpRouter<int> router;
+    for (size_t i = 0; i < ROUTES.size(); ++i) {
+        router.add(ROUTES[i].method, ROUTES[i].pattern, ROUTES[i].pattern, static_cast<int>(i));
+    }
+
+    volatile size_t sink = 0;
+    double router_ns = measure_ns(iterations, [&](const Request& request) {
+        auto match = router.resolve(request.method, request.path);
+        sink = sink + (match.handler ? static_cast<size_t>(*match.handler) : 0) + match.params.size();
+    });
+    double legacy_ns = measure_ns(iterations, [&](const Request& request) {
+        sink = sink + static_cast<size_t>(legacy_resolve(request.method, request.path));
+    });
+
+    std::cout << "Routes registered: " << router.size() << ", request mix: " << REQUESTS.size()
+              << ", iterations: " << iterations << "\n";
+    std::cout << "Route table:   " << router_ns << " ns/lookup\n";
+    std::cout << "If/else chain: " << legacy_ns << " ns/lookup\n";
+    return 0;
+}
@@ -0,0 +1,113 @@
+// Local vector store search benchmark.
+//
+// Fills a FAISSVectorStore with random unit vectors and short documents,
+// then measures top-k search through the flat index (normalised aligned
+// rows, dispatched SIMD kernel, bounded heap, payloads for the winners
+// only) next to a replica of the former brute-force search (a map of
+// per-document vectors, cosine_similarity per candidate, a payload for every
+// candidate above the threshold, full sort).
+
+#include "functions/retrieval.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace kolosal;
+
+namespace {
+
+std::vector<float> random_vector(std::mt19937& gen, size_t dimension) {
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    std::vector<float> vector(dimension);
+    for (auto& value : vector) {
+        value = dist(gen);
+    }
+    return normalize_vector(vector);
+}
+
+// Replica of the former FAISSVectorStore::search
+std::vector<VectorSearchResult> legacy_search(const std::unordered_map<std::string, std::vector<float>>& embeddings,
+                                              std::unordered_map<std::string, Document>& documents,
+                                              const std::vector<float>& query, size_t k, float threshold) {
+    std::vector<VectorSearchResult> results;
+    for (const auto& [doc_id, embedding] : embeddings) {
+        float similarity = cosine_similarity(query, embedding);
+        if (similarity >= threshold) {
+            VectorSearchResult result;
+            result.id = doc_id;
+            result.score = similarity;
+            result.payload = documents[doc_id].to_json();
+            results.push_back(result);
+        }
+    }
+    std::sort(results.begin(), results.end(),
+              [](const VectorSearchResult& a, const VectorSearchResult& b) { return a.score > b.score; });
+    if (results.size() > k) {
+        results.resize(k);
+    }
+    return results;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 50000;
+    size_t dimension = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 384;
+    size_t queries = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 20;
+    const size_t k = 10;
+    const float threshold = 0.0f;
+
+    std::mt19937 gen(42);
+    FAISSVectorStore store(dimension);
+    store.initialize();
+    std::unordered_map<std::string, std::vector<float>> legacy_embeddings;
+    std::unordered_map<std::string, Document> legacy_documents;
+    for (size_t i = 0; i < count; ++i) {
+        Document doc("doc-" + std::to_string(i), "Synthetic document " + std::to_string(i), "benchmark");
+        auto vector = random_vector(gen, dimension);
+        store.add_document(doc, vector);
+        legacy_embeddings[doc.id] = vector;
+        legacy_documents[doc.id] = doc;
+    }
+
+    std::vector<std::vector<float>> query_vectors;
+    for (size_t i = 0; i < queries; ++i) {
+        query_vectors.push_back(random_vector(gen, dimension));
+    }
+
+    for (const auto& query : query_vectors) {
+        auto expected = legacy_search(legacy_embeddings, legacy_documents, query, k, threshold);
+        auto actual = store.search(query, k, threshold);
+        if (expected.size() != actual.size() || (!expected.empty() && expected.front().id != actual.front().id)) {
+            std::cerr << "Flat index and brute-force results differ\n";
+            return 1;
+        }
+    }
+
+    auto measure_ms = [&](auto&& search) {
+        auto started = std::chrono::steady_clock::now();
+        size_t sink = 0;
+        for (const auto& query : query_vectors) {
+            sink += search(query).size();
+        }
+        auto elapsed = std::chrono::steady_clock::now() - started;
+        return sink > 0 ? std::chrono::duration<double, std::milli>(elapsed).count() / queries : 0.0;
+    };
+    double legacy_ms = measure_ms([&](const std::vector<float>& query) {
+        return legacy_search(legacy_embeddings, legacy_documents, query, k, threshold);
+    });
+    double flat_ms = measure_ms([&](const std::vector<float>& query) {
+        return store.search(query, k, threshold);
+    });
+
+    std::cout << count << " vectors of dimension " << dimension << ", top-" << k << ", kernel: "
+              << vector_kernels::active_kernel() << "\n";
+    std::cout << "brute force: " << legacy_ms << " ms/query, flat index: " << flat_ms << " ms/query\n";
+    return 0;
+}
@@ -0,0 +1,182 @@
+// Step parameter resolution and condition evaluation benchmark.
+//
+// Builds an execution context holding a few step outputs, then measures
+// resolving a parameter template and evaluating a condition tree with the
+// compiled ParameterTemplate / ConditionExpression, next to replicas of the
+// former WorkflowOrchestrator::resolve_parameters and evaluate_condition
+// that re-interpret the JSON on every call.
+
+#include "workflow_expressions.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace {
+
+// Replica of the former WorkflowOrchestrator::resolve_parameters (object format)
+json legacy_resolve(const json& parameters, const json& context) {
+    json resolved = parameters;
+    std::function<void(json&)> resolve_recursive = [&](json& obj) {
+        if (obj.is_string()) {
+            std::string str = obj;
+            size_t start = str.find("{{");
+            while (start != std::string::npos) {
+                size_t end = str.find("}}", start);
+                if (end != std::string::npos) {
+                    std::string field = str.substr(start + 2, end - start - 2);
+                    if (context.contains(field)) {
+                        std::string replacement = context[field].is_string() ?
+                                                context[field].get<std::string>() :
+                                                context[field].dump();
+                        str.replace(start, end - start + 2, replacement);
+                    }
+                }
+                start = str.find("{{", start + 1);
+            }
+            obj = str;
+        } else if (obj.is_object()) {
+            for (auto& [key, value] : obj.items()) {
+                resolve_recursive(value);
+            }
+        } else if (obj.is_array()) {
+            for (auto& item : obj) {
+                resolve_recursive(item);
+            }
+        }
+    };
+    resolve_recursive(resolved);
+    return resolved;
+}
+
+// Replica of the former WorkflowOrchestrator::evaluate_condition
+bool legacy_evaluate(const json& condition, const json& context) {
+    if (condition.is_null() || condition.empty()) {
+        return true;
+    }
+    if (condition.contains("and") || condition.contains("or")) {
+        if (condition.contains("and") && condition["and"].is_array()) {
+            for (const auto& sub_condition : condition["and"]) {
+                if (!legacy_evaluate(sub_condition, context)) return false;
+            }
+            return true;
+        }
+        if (condition.contains("or") && condition["or"].is_array()) {
+            for (const auto& sub_condition : condition["or"]) {
+                if (legacy_evaluate(sub_condition, context)) return true;
+            }
+            return false;
+        }
+        if (condition.contains("not")) {
+            return !legacy_evaluate(condition["not"], context);
+        }
+        return true;
+    }
+    if (condition.contains("field") && condition.contains("operator") && condition.contains("value")) {
+        std::string field = condition["field"];
+        std::string op = condition["operator"];
+        json expected_value = condition["value"];
+
+        std::istringstream field_stream(field);
+        std::string field_part;
+        json current_context = context;
+        while (std::getline(field_stream, field_part, '.')) {
+            if (current_context.contains(field_part)) {
+                current_context = current_context[field_part];
+            } else {
+                return false;
+            }
+        }
+        json actual_value = current_context;
+
+        if (op == "equals") return actual_value == expected_value;
+        if (op == "not_equals") return actual_value != expected_value;
+        if (op == "exists") return true;
+        if (op == "contains" && actual_value.is_string() && expected_value.is_string()) {
+            return actual_value.get<std::string>().find(expected_value.get<std::string>()) != std::string::npos;
+        }
+        if (op == "greater_than" && actual_value.is_number() && expected_value.is_number()) {
+            return actual_value.get<double>() > expected_value.get<double>();
+        }
+        if (op == "less_than" && actual_value.is_number() && expected_value.is_number()) {
+            return actual_value.get<double>() < expected_value.get<double>();
+        }
+    }
+    return true;
+}
+
+json make_context() {
+    json context = json::object();
+    context["input"] = {{"query", "What is quantum computing?"}, {"depth", "detailed"}};
+    context["query"] = "What is quantum computing?";
+    context["language"] = "en";
+    for (int step = 1; step <= 6; ++step) {
+        json sources = json::array();
+        for (int i = 0; i < 20; ++i) {
+            sources.push_back({{"url", "https://example.com/" + std::to_string(i)},
+                               {"title", "Source " + std::to_string(i)},
+                               {"snippet", std::string(200, 'x')}});
+        }
+        context["step" + std::to_string(step) + "_output"] = {
+            {"result", {{"text", "Findings of step " + std::to_string(step)}, {"confidence", 0.5 + step * 0.05}}},
+            {"sources", sources}
+        };
+    }
+    return context;
+}
+
+template <typename Fn>
+double measure_ns(size_t iterations, Fn&& fn) {
+    auto started = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        fn();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - started;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    size_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    json context = make_context();
+
+    // Top-level references only, so both paths produce the same result
+    json parameters = {
+        {"query", "{{query}}"},
+        {"prompt", "Answer in {{language}}: {{query}}"},
+        {"options", {{"max_tokens", 512}, {"temperature", 0.2}, {"stop", json::array({"\n\n"})}}},
+        {"history", json::array({"{{language}}", "static"})}
+    };
+    json condition = {
+        {"and", json::array({
+            {{"field", "step3_output.result.confidence"}, {"operator", "greater_than"}, {"value", 0.6}},
+            {{"or", json::array({
+                {{"field", "language"}, {"operator", "equals"}, {"value", "de"}},
+                {{"field", "step6_output.result.text"}, {"operator", "contains"}, {"value", "step 6"}}
+            })}}
+        })}
+    };
+
+    ParameterTemplate compiled_parameters(parameters);
+    ConditionExpression compiled_condition(condition);
+    if (compiled_parameters.resolve(context) != legacy_resolve(parameters, context) ||
+        compiled_condition.evaluate(context) != legacy_evaluate(condition, context)) {
+        std::cerr << "Compiled and interpreted results differ\n";
+        return 1;
+    }
+
+    volatile size_t sink = 0;
+    double legacy_resolve_ns = measure_ns(iterations, [&] { sink = sink + legacy_resolve(parameters, context).size(); });
+    double compiled_resolve_ns = measure_ns(iterations, [&] { sink = sink + compiled_parameters.resolve(context).size(); });
+    double legacy_condition_ns = measure_ns(iterations, [&] { sink = sink + legacy_evaluate(condition, context); });
+    double compiled_condition_ns = measure_ns(iterations, [&] { sink = sink + compiled_condition.evaluate(context); });
+
+    std::cout << "Context: " << context.dump().size() << " bytes, iterations: " << iterations << "\n";
+    std::cout << "resolve   interpreted: " << legacy_resolve_ns << " ns, compiled: " << compiled_resolve_ns << " ns\n";
+    std::cout << "condition interpreted: " << legacy_condition_ns << " ns, compiled: " << compiled_condition_ns << " ns\n";
+    return 0;
+}
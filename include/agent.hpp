@@ -8,6 +8,7 @@
 #include <atomic>
 #include <json.hpp>
 #include "model_interface.hpp"
+#include "cancellation_token.hpp"
 
 using json = nlohmann::json;
 
@@ -58,8 +59,18 @@ public:
     
     // Function execution
     json execute_function(const std::string& function_name, const json& params);
+    
+    // Runs the function with cancel_token as the thread's current token, so its
+    // model and retrieval calls abort once the token is cancelled or expires
+    json execute_function(const std::string& function_name, const json& params,
+                          std::shared_ptr<CancellationToken> cancel_token);
     void register_function(const std::string& name, std::function<json(const json&)> func);
     
+    // Streaming execution: generated text is passed to on_delta as it arrives
+    json execute_function_streaming(const std::string& function_name, const json& params,
+                                    const KolosalClient::TokenCallback& on_delta);
+    bool supports_streaming(const std::string& function_name) const;
+    
     // Capability management
     void add_capability(const std::string& capability);
     const std::vector<std::string>& get_capabilities() const { return capabilities_; }
@@ -75,6 +86,9 @@ public:
     // Model configuration
     void configure_models(const json& model_configs);
     
+    // Shared body of the "chat" function; on_delta may be empty
+    json run_chat(const json& params, const KolosalClient::TokenCallback& on_delta);
+    
     // Helper functions
     json create_research_function_response(const std::string& function_name, const json& params, const std::string& task_description);
     
@@ -91,6 +91,19 @@ struct AgentSystemConfig {
         int port;
         std::string log_level;
         int max_concurrent_requests;
+        
+        // HTTP front end
+        struct {
+            std::string io_model = "thread_per_connection";  // or "epoll"
+            int backlog = 128;
+            int max_connections = 1024;
+            int io_threads = 2;
+            int worker_threads = 0;  // 0 = hardware concurrency
+            bool keep_alive = true;
+            int keep_alive_timeout_ms = 5000;
+            int max_requests_per_connection = 100;
+            int max_event_streams = 256;
+        } http_server;
     } system;
     
     // System instruction for all agents
@@ -61,7 +61,13 @@ public:
     // Function execution
     json execute_agent_function(const std::string& agent_id, 
                                 const std::string& function_name, 
-                                const json& params);
+                                const json& params,
+                                std::shared_ptr<CancellationToken> cancel_token = nullptr);
+    json execute_agent_function_streaming(const std::string& agent_id,
+                                          const std::string& function_name,
+                                          const json& params,
+                                          const KolosalClient::TokenCallback& on_delta);
+    bool agent_supports_streaming(const std::string& agent_id, const std::string& function_name);
                                 
 private:
     // Internal methods
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+/**
+ * @brief Cooperative cancellation flag with an optional deadline
+ *
+ * Whoever owns a piece of work cancels the token (or lets its deadline pass)
+ * and the code doing the work checks it at convenient points. A token is
+ * usually installed as the calling thread's current token with Scope;
+ * HttpClient picks it up from there, bounds its transfers by the deadline and
+ * aborts them from libcurl's progress callback once the token is cancelled,
+ * so the thread and the connection are released without waiting for the
+ * server to answer.
+ */
+class CancellationToken {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Makes a token the calling thread's current token until destroyed
+     */
+    class Scope {
+    public:
+        explicit Scope(std::shared_ptr<CancellationToken> token)
+            : previous_(std::move(current_slot())) {
+            current_slot() = std::move(token);
+        }
+        ~Scope() { current_slot() = std::move(previous_); }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        std::shared_ptr<CancellationToken> previous_;
+    };
+
+    CancellationToken() = default;
+    explicit CancellationToken(Clock::time_point deadline) { set_deadline(deadline); }
+
+    /**
+     * @brief Token of the innermost active Scope on this thread, or null
+     */
+    static std::shared_ptr<CancellationToken> current() { return current_slot(); }
+
+    void cancel() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            cancelled_.store(true, std::memory_order_release);
+        }
+        condition_.notify_all();
+    }
+
+    void set_deadline(Clock::time_point deadline) {
+        deadline_.store(deadline.time_since_epoch().count(), std::memory_order_release);
+        condition_.notify_all();
+    }
+
+    Clock::time_point deadline() const {
+        return Clock::time_point(Clock::duration(deadline_.load(std::memory_order_acquire)));
+    }
+
+    bool has_deadline() const { return deadline() != Clock::time_point::max(); }
+
+    bool deadline_exceeded() const { return has_deadline() && Clock::now() >= deadline(); }
+
+    /**
+     * @brief True once cancel() was called or the deadline has passed
+     */
+    bool is_cancelled() const {
+        return cancelled_.load(std::memory_order_acquire) || deadline_exceeded();
+    }
+
+    /**
+     * @brief Record that work was actually aborted because of this token
+     *
+     * Set by HttpClient whenever it drops a transfer. Lets callers tell a
+     * call that was cut off apart from one that merely finished late.
+     */
+    void mark_interrupted() { interrupted_.store(true, std::memory_order_release); }
+
+    bool interrupted() const { return interrupted_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Time left until the deadline (Clock::duration::max() if none)
+     */
+    Clock::duration remaining() const {
+        if (!has_deadline()) {
+            return Clock::duration::max();
+        }
+        auto left = deadline() - Clock::now();
+        return left > Clock::duration::zero() ? left : Clock::duration::zero();
+    }
+
+    /**
+     * @brief Sleep for duration, waking early if the token is cancelled
+     * @return false if the token was cancelled before the time elapsed
+     */
+    template <typename Rep, typename Period>
+    bool sleep_for(std::chrono::duration<Rep, Period> duration) const {
+        auto until = Clock::now() + std::chrono::duration_cast<Clock::duration>(duration);
+        if (has_deadline() && deadline() < until) {
+            until = deadline();
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        condition_.wait_until(lock, until, [this] { return cancelled_.load(std::memory_order_acquire); });
+        return !is_cancelled();
+    }
+
+    /**
+     * @brief Throw std::runtime_error if the token is cancelled
+     */
+    void throw_if_cancelled() const {
+        if (deadline_exceeded()) {
+            throw std::runtime_error("Operation deadline exceeded");
+        }
+        if (cancelled_.load(std::memory_order_acquire)) {
+            throw std::runtime_error("Operation cancelled");
+        }
+    }
+
+private:
+    std::atomic<bool> cancelled_{false};
+    std::atomic<bool> interrupted_{false};
+    std::atomic<Clock::rep> deadline_{Clock::time_point::max().time_since_epoch().count()};
+    mutable std::mutex mutex_;
+    mutable std::condition_variable condition_;
+
+    static std::shared_ptr<CancellationToken>& current_slot() {
+        thread_local std::shared_ptr<CancellationToken> token;
+        return token;
+    }
+};
@@ -2,6 +2,13 @@
 
 #include <string>
 #include <memory>
+#include <functional>
+#include <future>
+#include <exception>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <unordered_map>
 #include <json.hpp>
 #include "logger.hpp"
 
@@ -16,6 +23,11 @@ class HttpClient;
  * This class provides a clean interface for making requests to the Kolosal Server
  * running in the background. It handles HTTP requests for model inference,
  * retrieval operations, and server status checks.
+ *
+ * The *_async variants do not block: requests are handed to the HttpClient's
+ * shared curl-multi event loop, so one thread can keep many model calls in
+ * flight. Completion callbacks run on that event-loop thread and must not
+ * block; hand long-running follow-up work to another executor.
  */
 class KolosalClient {
 public:
@@ -28,13 +40,16 @@ public:
         int max_retries = 3;
         int retry_delay_ms = 1000;
         bool verify_ssl = true;
+        int model_cache_ttl_seconds = 60;  // 0 disables the model catalogue cache
     };
 
+    KolosalClient();
+
     /**
      * @brief Constructor
      * @param config Client configuration
      */
-    explicit KolosalClient(const Config& config = Config{});
+    explicit KolosalClient(const Config& config);
 
     /**
      * @brief Destructor
@@ -44,6 +59,10 @@ public:
     // Model Interface Methods
     /**
      * @brief Check if a model is available on the server
+     *
+     * Answered from the cached model catalogue with a hashed lookup on the
+     * model's id, model_id, name and aliases.
+     *
      * @param model_name Name of the model to check
      * @return true if model is available, false otherwise
      */
@@ -51,10 +70,22 @@ public:
 
     /**
      * @brief Get list of available models
+     *
+     * The /models response is cached for Config::model_cache_ttl_seconds. Once
+     * it expires the previous catalogue keeps being served while a single
+     * background request refreshes it.
+     *
      * @return JSON array of available models
      */
     json get_available_models();
 
+    /**
+     * @brief Drop the cached model catalogue so the next lookup refetches it
+     *
+     * Called automatically when the chat endpoint answers 404 for a model.
+     */
+    void invalidate_model_cache();
+
     /**
      * @brief Chat with a model
      * @param model_name Name of the model to use
@@ -66,6 +97,30 @@ public:
                                 const std::string& message, 
                                 const std::string& system_prompt = "");
 
+    /**
+     * @brief Receives generated text as it is produced
+     * @return false to stop generation early
+     */
+    using TokenCallback = std::function<bool(const std::string& delta)>;
+
+    /**
+     * @brief Chat with a model, receiving the reply incrementally
+     *
+     * Requests an OpenAI-style event stream ("stream": true) and passes each
+     * content delta to on_delta. Servers that ignore the flag and answer with
+     * a single JSON body are handled by delivering the whole reply at once.
+     *
+     * @param model_name Name of the model to use
+     * @param message Message to send
+     * @param system_prompt Optional system prompt
+     * @param on_delta Called for each piece of generated text
+     * @return The complete response text
+     */
+    std::string chat_with_model_stream(const std::string& model_name,
+                                       const std::string& message,
+                                       const std::string& system_prompt,
+                                       const TokenCallback& on_delta);
+
     /**
      * @brief Make a completion request to a model
      * @param model_name Name of the model to use
@@ -77,6 +132,81 @@ public:
                            const std::string& prompt, 
                            const json& params = json::object());
 
+    // Asynchronous Methods
+    /**
+     * @brief Completion callback for asynchronous text results
+     *
+     * Exactly one of the arguments is meaningful: error is null on success,
+     * otherwise it holds the exception the blocking variant would have thrown.
+     */
+    using TextCallback = std::function<void(std::string result, std::exception_ptr error)>;
+
+    /**
+     * @brief Completion callback for asynchronous JSON results
+     */
+    using JsonCallback = std::function<void(json result, std::exception_ptr error)>;
+
+    /**
+     * @brief Non-blocking chat_with_model()
+     * @param on_complete Invoked on the event-loop thread with the reply or error
+     */
+    void chat_with_model_async(const std::string& model_name,
+                               const std::string& message,
+                               const std::string& system_prompt,
+                               TextCallback on_complete);
+
+    /**
+     * @brief Future-returning form of chat_with_model_async()
+     */
+    std::future<std::string> chat_with_model_async(const std::string& model_name,
+                                                   const std::string& message,
+                                                   const std::string& system_prompt = "");
+
+    /**
+     * @brief Non-blocking completion_request()
+     * @param on_complete Invoked on the event-loop thread with the response or error
+     */
+    void completion_request_async(const std::string& model_name,
+                                  const std::string& prompt,
+                                  const json& params,
+                                  JsonCallback on_complete);
+
+    /**
+     * @brief Future-returning form of completion_request_async()
+     */
+    std::future<json> completion_request_async(const std::string& model_name,
+                                               const std::string& prompt,
+                                               const json& params = json::object());
+
+    /**
+     * @brief Non-blocking search_documents()
+     * @param on_complete Invoked on the event-loop thread with the results or error
+     */
+    void search_documents_async(const std::string& query,
+                                int limit,
+                                const json& filters,
+                                JsonCallback on_complete);
+
+    /**
+     * @brief Future-returning form of search_documents_async()
+     */
+    std::future<json> search_documents_async(const std::string& query,
+                                             int limit = 10,
+                                             const json& filters = json::object());
+
+    /**
+     * @brief Non-blocking internet_search()
+     * @param on_complete Invoked on the event-loop thread with the results or error
+     */
+    void internet_search_async(const std::string& query,
+                               int num_results,
+                               JsonCallback on_complete);
+
+    /**
+     * @brief Future-returning form of internet_search_async()
+     */
+    std::future<json> internet_search_async(const std::string& query, int num_results = 10);
+
     // Retrieval Interface Methods
     /**
      * @brief Add a document to the retrieval system
@@ -154,6 +284,25 @@ private:
     Config config_;
     std::unique_ptr<HttpClient> http_client_;
     
+    // Model catalogue cache
+    std::mutex model_cache_mutex_;
+    std::mutex model_fetch_mutex_;          // Serializes cold-cache fetches
+    json cached_models_;
+    std::unordered_map<std::string, size_t> model_lookup_;  // id/name/alias -> index
+    std::chrono::steady_clock::time_point models_fetched_at_;
+    bool models_cached_ = false;
+    std::atomic<bool> models_refreshing_{false};
+    
+    /**
+     * @brief Make sure a model catalogue is cached, refreshing it if expired
+     */
+    void refresh_model_catalogue();
+    
+    /**
+     * @brief Replace the cached catalogue and rebuild the lookup index
+     */
+    void store_model_catalogue(json models);
+    
     /**
      * @brief Make HTTP request to the server (deprecated - use HttpClient directly)
      */
@@ -170,6 +319,17 @@ private:
                                 const json& data = json::object(),
                                 const json& headers = json::object());
 
+    /**
+     * @brief Issue a request on the shared event loop and parse the JSON reply
+     *
+     * on_complete receives the parsed body, or the same exception make_request()
+     * would have thrown.
+     */
+    void make_request_async(const std::string& method,
+                            const std::string& endpoint,
+                            const json& data,
+                            JsonCallback on_complete);
+
     /**
      * @brief Parse response and check for errors (deprecated)
      */
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <json.hpp>
+
+using json = nlohmann::json;
+
+/**
+ * @brief Append-only write-ahead journal of workflow executions
+ *
+ * WorkflowOrchestrator records when an execution is queued, every step that
+ * completes (with its output), each iteration a LOOP execution starts and
+ * when the execution finishes. Records are
+ * JSON lines appended to one file; a background thread writes whatever has
+ * accumulated every flush_interval_ms and fsyncs once per batch, so a crash
+ * loses at most the last interval of step completions.
+ *
+ * open() replays the file and returns the executions that never finished,
+ * with the outputs of the steps they had completed, then compacts the file
+ * down to those executions. A torn record at the end of the file (a crash in
+ * the middle of a write) is ignored.
+ */
+class ExecutionJournal {
+public:
+    struct Config {
+        std::string path = "workflows/journal/executions.jsonl";
+        int flush_interval_ms = 50;
+    };
+
+    /**
+     * @brief An execution found unfinished in the journal
+     */
+    struct RecoveredExecution {
+        std::string execution_id;
+        std::string workflow_id;
+        json input_data;
+        std::string tenant_id;
+        int priority = 0;
+        int64_t start_time_ms = 0;
+        std::map<std::string, json> step_outputs;  // Completed steps, by step id
+        std::vector<std::string> step_order;       // Completion order
+        int loop_iteration = 0;                    // Iteration a LOOP execution had started last
+        std::vector<std::string> iteration_steps;  // Completed in that iteration; all steps outside loops
+    };
+
+    explicit ExecutionJournal(const Config& config);
+    ~ExecutionJournal();
+
+    ExecutionJournal(const ExecutionJournal&) = delete;
+    ExecutionJournal& operator=(const ExecutionJournal&) = delete;
+
+    /**
+     * @brief Replay and compact the journal, then start appending to it
+     * @throws std::runtime_error if the journal file cannot be written
+     */
+    std::vector<RecoveredExecution> open();
+
+    /**
+     * @brief Flush pending records and stop the writer thread
+     */
+    void close();
+
+    bool is_open() const;
+
+    void record_execution_started(const std::string& execution_id, const std::string& workflow_id,
+                                  const json& input_data, const std::string& tenant_id, int priority,
+                                  int64_t start_time_ms);
+    void record_step_completed(const std::string& execution_id, const std::string& step_id, const json& output);
+    void record_loop_iteration(const std::string& execution_id, int iteration);
+    void record_execution_finished(const std::string& execution_id, int state);
+
+    /**
+     * @brief Block until every record appended so far is on disk
+     */
+    void flush();
+
+    const Config& get_config() const { return config_; }
+
+private:
+    Config config_;
+    std::FILE* file_ = nullptr;
+
+    mutable std::mutex mutex_;
+    std::condition_variable pending_condition_;   // Records appended or closing
+    std::condition_variable durable_condition_;   // A batch reached the disk
+    std::string pending_;                         // Serialised records not yet written
+    uint64_t filling_batch_ = 1;                  // Batch that pending_ belongs to
+    uint64_t durable_batch_ = 0;                  // Last batch written and synced
+    bool flush_requested_ = false;
+    bool closing_ = false;
+    std::thread writer_thread_;
+
+    void append(const json& record);
+    void append_line(std::string line);
+    void writer_loop();
+    void write_and_sync(const std::string& data);
+    std::vector<RecoveredExecution> replay(std::vector<json>& live_records);
+    void compact(const std::vector<json>& live_records);
+};
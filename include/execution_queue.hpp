@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Ready queue of workflow executions waiting for an orchestrator slot
+ *
+ * Executions are grouped by priority level and, within a level, by tenant.
+ * pop() serves the highest non-empty level and rotates between its tenants,
+ * taking the oldest execution of each tenant in turn, so one tenant queueing
+ * thousands of executions delays another tenant's next execution by at most
+ * one execution per competing tenant. push(), pop() and erase() are O(1) apart
+ * from the level lookup, which is logarithmic in the number of distinct
+ * priorities in use.
+ *
+ * Not synchronised; WorkflowOrchestrator guards it with its own mutex.
+ */
+class ExecutionQueue {
+public:
+    enum class Ordering {
+        FIFO,       // Ignore priorities: one level in submission order
+        PRIORITY    // Higher priority first, submission order within a priority
+    };
+
+    struct Config {
+        Ordering ordering = Ordering::FIFO;
+        bool tenant_fairness = true;  // Round-robin between tenants; false = one shared FIFO
+    };
+
+    struct Stats {
+        size_t queued = 0;
+        size_t tenants = 0;            // Tenants with queued executions
+        size_t priority_levels = 0;    // Distinct priorities with queued executions
+        uint64_t enqueued = 0;
+        uint64_t dispatched = 0;
+        uint64_t removed = 0;
+    };
+
+    ExecutionQueue();
+    explicit ExecutionQueue(const Config& config);
+
+    /**
+     * @brief Queue an execution behind the executions of the same tenant and priority
+     * @return false if the execution is already queued
+     */
+    bool push(const std::string& execution_id, const std::string& tenant_id = "", int priority = 0);
+
+    /**
+     * @brief Take the next execution to dispatch
+     * @return false if the queue is empty
+     */
+    bool pop(std::string& execution_id);
+
+    /**
+     * @brief Remove a queued execution (e.g. when it is cancelled before it starts)
+     * @return false if the execution is not queued
+     */
+    bool erase(const std::string& execution_id);
+
+    bool contains(const std::string& execution_id) const;
+    size_t size() const { return index_.size(); }
+    bool empty() const { return index_.empty(); }
+
+    /**
+     * @brief Change ordering or fairness; queued executions keep their submission order
+     */
+    void set_config(const Config& config);
+    const Config& get_config() const { return config_; }
+
+    Stats get_stats() const;
+
+    static Ordering parse_ordering(const std::string& name);
+    static std::string ordering_to_string(Ordering ordering);
+
+private:
+    struct Entry {
+        std::string execution_id;
+        std::string tenant_id;   // As submitted, kept for set_config()
+        int priority;
+        uint64_t sequence;
+    };
+
+    struct TenantQueue {
+        std::list<Entry> entries;
+        std::list<std::string>::iterator turn;  // Position in Level::rotation
+    };
+
+    struct Level {
+        std::unordered_map<std::string, TenantQueue> tenants;
+        std::list<std::string> rotation;  // Tenants with entries, next to serve first
+    };
+
+    struct Location {
+        int level;
+        std::string tenant_key;
+        std::list<Entry>::iterator entry;
+    };
+
+    Config config_;
+    std::map<int, Level, std::greater<int>> levels_;
+    std::unordered_map<std::string, Location> index_;
+    uint64_t next_sequence_ = 0;
+    uint64_t enqueued_ = 0;
+    uint64_t dispatched_ = 0;
+    uint64_t removed_ = 0;
+
+    void insert(Entry entry);
+    void remove(const Location& location);
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdio>
+#include <filesystem>
+#include <string>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Forcing written data to stable storage
+ *
+ * A file that replaces another by rename must be synced before the rename,
+ * and its directory after it: otherwise a power loss can persist the rename
+ * but not the data, leaving an empty or torn file in place of the old one.
+ */
+namespace file_sync {
+
+    /**
+     * @brief Flush stdio buffers and the OS cache of file to disk
+     * @return false if either step failed
+     */
+    inline bool sync_file(std::FILE* file) {
+        if (std::fflush(file) != 0) {
+            return false;
+        }
+#ifdef _WIN32
+        return _commit(_fileno(file)) == 0;
+#else
+        return fsync(fileno(file)) == 0;
+#endif
+    }
+
+    /**
+     * @brief Persist the directory entry of path, after it was created or renamed
+     *
+     * A no-op on Windows, where NTFS journals renames and directories cannot
+     * be opened for syncing.
+     * @return false if the directory could not be synced
+     */
+    inline bool sync_parent_directory(const std::string& path) {
+#ifdef _WIN32
+        (void)path;
+        return true;
+#else
+        std::filesystem::path parent = std::filesystem::path(path).parent_path();
+        int fd = ::open(parent.empty() ? "." : parent.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        bool synced = fsync(fd) == 0;
+        ::close(fd);
+        return synced;
+#endif
+    }
+
+}  // namespace file_sync
@@ -6,10 +6,16 @@
 #include <unordered_map>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <optional>
 #include <chrono>
 #include <future>
+#include <functional>
 #include <unordered_set>
+#include "../vector_index.hpp"
+#include "../hnsw_index.hpp"
+#include "../quantized_index.hpp"
+#include "../index_io.hpp"
 
 using json = nlohmann::json;
 
@@ -82,7 +88,22 @@ struct RetrievalConfig {
     std::string collection_name = "documents";
     
     // FAISS settings
-    std::string faiss_index_type = "Flat";
+    std::string faiss_index_type = "Flat";  // "Flat" (exact), "HNSW" (approximate), "SQ8" or "PQ" (compressed)
+    size_t hnsw_m = 16;                     // HNSW links per node and layer
+    size_t hnsw_ef_construction = 200;      // HNSW candidates considered per insert
+    size_t hnsw_ef_search = 64;             // HNSW candidates kept per query (recall vs speed)
+    size_t index_build_threads = 0;         // Threads for batch inserts and training; 0 = hardware threads
+    size_t pq_subvectors = 0;               // PQ bytes per vector; 0 = embedding_dimension / 8
+    size_t quantizer_training_size = 10000; // SQ8/PQ vectors kept exact before the codebook is trained
+    size_t rerank_candidates = 0;           // SQ8/PQ candidates re-scored exactly; 0 = codes only
+    std::string faiss_index_path;           // Loaded at startup and written by save_index(); empty = memory only
+    
+    // Ingestion settings (batch_add_documents)
+    int chunk_size = 512;                   // Characters per chunk; longer documents are split
+    int chunk_overlap = 50;                 // Characters shared by neighbouring chunks
+    size_t embedding_batch_size = 32;       // Chunks per embedding call and per store insert
+    size_t ingest_threads = 0;              // Concurrent embedding calls; 0 = hardware threads
+    size_t max_inflight_batches = 4;        // Batches queued per stage before chunking waits
     
     // General settings
     size_t embedding_dimension = 768;
@@ -107,15 +128,16 @@ private:
     std::string collection_name_;
     bool connected_;
     
-    // Local storage for demo purposes (replace with actual Qdrant client)
+    // Local storage for demo purposes (replace with actual Qdrant client);
+    // vectors live in index_, payloads here
     struct VectorPoint {
         std::string id;
-        std::vector<float> vector;
         json payload;
     };
     
     std::unordered_map<std::string, VectorPoint> points_;
-    std::mutex data_mutex_;
+    FlatVectorIndex index_;
+    std::shared_mutex data_mutex_;  // Searches share it, writes take it exclusively
     
     std::string generate_uuid();
 
@@ -141,37 +163,105 @@ class FAISSVectorStore : public IVectorStore {
 private:
     size_t dimension_;
     std::string index_type_;
-    void* index_; // FAISS index pointer
     bool initialized_;
     
-    // Document storage
+    // Documents by id; their embeddings are held by index_
     std::unordered_map<std::string, Document> documents_;
-    std::unordered_map<std::string, std::vector<float>> embeddings_;
-    std::mutex data_mutex_;
+    std::unique_ptr<IVectorIndex> index_;  // Created by initialize() from index_type_
+    HnswIndex::Config hnsw_config_;
+    QuantizedVectorIndex::Config quantized_config_;
+    std::shared_mutex data_mutex_;  // Searches share it, writes take it exclusively
+    
+    // Persistence: documents loaded from an index file stay in its mapping as
+    // JSON until they are returned by a search
+    std::unique_ptr<index_io::MappedFile> mapping_;
+    std::unordered_map<std::string, std::string_view> mapped_documents_;
+    std::string persisted_path_;        // File save_index() appends to; empty until saved or loaded
+    size_t persisted_segments_ = 0;     // Append segments in that file
+    size_t persisted_base_bytes_ = 0;
+    size_t persisted_append_bytes_ = 0;
+    std::unordered_map<std::string, std::vector<float>> pending_additions_;  // Since the last save
+    std::unordered_set<std::string> pending_removals_;                       // Since the last save
     
     std::string generate_uuid();
+    std::unique_ptr<IVectorIndex> create_index() const;
+    void track_addition(const std::string& id, const std::vector<float>& embedding);
+    json document_payload(const std::string& id) const;
+    bool write_base(const std::string& filepath);
+    bool write_append_segment();
 
 public:
-    FAISSVectorStore(size_t dimension, const std::string& index_type = "Flat");
+    /**
+     * @param index_type "Flat" for exact search, "HNSW" for the approximate graph index,
+     *                   "SQ8" or "PQ" for int8 scalar or product-quantized storage
+     * @param hnsw_config HNSW parameters; build_threads also applies to add_documents()
+     * @param quantized_config SQ8/PQ parameters; the encoding follows index_type
+     */
+    FAISSVectorStore(size_t dimension, const std::string& index_type = "Flat",
+                     const HnswIndex::Config& hnsw_config = HnswIndex::Config(),
+                     const QuantizedVectorIndex::Config& quantized_config = QuantizedVectorIndex::Config());
     ~FAISSVectorStore();
     
     bool initialize();
     
     std::string add_document(const Document& document, const std::vector<float>& embedding) override;
+    
+    /**
+     * @brief Add documents with their embeddings under one lock
+     * @return Per document, its id, or "" if its embedding was rejected
+     */
+    std::vector<std::string> add_documents(const std::vector<Document>& documents,
+                                           const std::vector<std::vector<float>>& embeddings);
     std::vector<VectorSearchResult> search(const std::vector<float>& query_vector, 
                                           size_t k = 10, float threshold = 0.0f) override;
     bool delete_document(const std::string& document_id) override;
     
     // Index management
-    void save_index(const std::string& filepath);
+    
+    /**
+     * @brief Persist the store to filepath
+     *
+     * The first save to a path writes a base segment holding the documents
+     * and the serialised index (vectors, ids and any HNSW graph or codebook).
+     * Later saves to the same path append a segment with only the documents
+     * added and removed since then. Once MAX_APPEND_SEGMENTS segments have
+     * been appended, or they outgrow the base, the file is compacted into a
+     * new base segment and swapped in.
+     */
+    bool save_index(const std::string& filepath);
+    
+    /**
+     * @brief Replace the store's contents with a file written by save_index()
+     *
+     * The file is memory-mapped. The index is restored from its serialised
+     * form without re-embedding or rebuilding. Document payloads are parsed
+     * only when a search returns them, so their pages are read lazily.
+     * Append segments are replayed. A damaged trailing segment (for example,
+     * from a crash during a save) is skipped, and the next save compacts it
+     * away.
+     * @return false if the file is missing, damaged, or was written for a
+     *         different index type or dimension
+     */
     bool load_index(const std::string& filepath);
+    
+    static constexpr size_t MAX_APPEND_SEGMENTS = 8;
 };
 
 // Retrieval manager with advanced features
 class RetrievalManager {
+public:
+    /**
+     * @brief Embeds a batch of texts, one embedding per text in the same order
+     *
+     * Typically bound to EmbeddingModelInterface::create_embeddings_batch.
+     * May be called from several threads at once.
+     */
+    using BatchEmbeddingFunction = std::function<std::vector<std::vector<float>>(const std::vector<std::string>&)>;
+    
 private:
     RetrievalConfig config_;
     bool initialized_;
+    BatchEmbeddingFunction embedding_function_;  // Empty = hash placeholder
     
     // Vector stores
     std::unique_ptr<QdrantVectorStore> qdrant_store_;
@@ -183,7 +273,9 @@ private:
     
     // Helper methods
     std::vector<float> generate_embedding(const std::string& text);
+    std::vector<std::vector<float>> generate_embeddings(const std::vector<std::string>& texts);
     std::string to_lowercase(const std::string& str);
+    bool remove_from_stores(const std::string& id);  // Whether any store held id
 
 public:
     RetrievalManager();
@@ -191,9 +283,36 @@ public:
     // Initialization
     bool initialize(const RetrievalConfig& config);
     
+    /**
+     * @brief Use an embedding model for documents and queries; set before adding documents
+     */
+    void set_embedding_function(BatchEmbeddingFunction function);
+    
     // Document management
     std::string add_document(const Document& document);
+    
+    /**
+     * @brief Chunk, embed and store documents through a pipelined ingest
+     *
+     * The calling thread chunks documents into batches of up to
+     * embedding_batch_size chunks. Up to ingest_threads batches are embedded
+     * at once. A single writer then inserts each batch into the stores under
+     * one lock, in input order. Each stage queues at most
+     * max_inflight_batches batches, so chunking waits when embedding or
+     * storage falls behind, and memory stays bounded for any input size.
+     *
+     * A document longer than chunk_size is stored as chunks with ids
+     * "<id>#<n>" and the metadata keys parent_id and chunk_index. Documents
+     * without an id get a generated one.
+     * A document that fails has the chunks it did store removed again.
+     * @return Per document, its id, or "" if it could not be embedded or stored
+     */
     std::vector<std::string> batch_add_documents(const std::vector<Document>& documents);
+    
+    /**
+     * @brief Remove a document, and its "<id>#<n>" chunks if it was chunked
+     * @return false if no store held the document or any chunk of it
+     */
     bool delete_document(const std::string& document_id);
     std::optional<Document> get_document(const std::string& document_id);
     
@@ -203,6 +322,7 @@ public:
     std::vector<SearchResult> hybrid_search(const std::string& query, const SearchOptions& options = {});
     
     // System management
+    bool save_index();  // Local store to config faiss_index_path
     RetrievalStats get_stats() const;
     void clear_cache();
 };
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include "vector_index.hpp"
+
+namespace kolosal {
+
+/**
+ * @brief Approximate cosine-similarity index: hierarchical navigable small world graph
+ *
+ * Each vector is a node on layers 0..L, with L drawn from an exponential
+ * distribution. On every layer it links to up to M neighbours (2*M on
+ * layer 0), which are chosen with the diversity heuristic of the HNSW
+ * paper. A search descends greedily from the top layer. On layer 0 it runs
+ * a best-first search that keeps ef_search candidates, so it visits a
+ * small part of the graph instead of every vector. Vectors are normalised
+ * and stored in one aligned block, and are scored with the same kernels
+ * as FlatVectorIndex.
+ *
+ * remove() only tombstones a node. It stays in the graph for navigation
+ * but is never returned. Re-adding an id tombstones the old node. Once
+ * tombstones outnumber live nodes, the graph is rebuilt from the live
+ * vectors. add_batch() inserts on several threads; a striped lock guards
+ * each node's links while that happens.
+ *
+ * Otherwise not thread-safe; the vector stores guard it with their own locks.
+ */
+class HnswIndex : public IVectorIndex {
+public:
+    struct Config {
+        size_t M = 16;                  // Links per node and layer (2*M on layer 0)
+        size_t ef_construction = 200;   // Candidates considered when linking a new node
+        size_t ef_search = 64;          // Candidates kept by a query; raised to k if smaller
+        size_t build_threads = 0;       // add_batch() and rebuilds; 0 = hardware threads
+        uint32_t seed = 42;             // Level generator seed
+    };
+
+    explicit HnswIndex(size_t dimension = 0);
+    HnswIndex(size_t dimension, const Config& config);
+
+    bool add(const std::string& id, const std::vector<float>& vector) override;
+    std::vector<bool> add_batch(const std::vector<std::string>& ids,
+                                const std::vector<std::vector<float>>& vectors, size_t threads) override;
+    bool remove(const std::string& id) override;
+    bool contains(const std::string& id) const override { return nodes_by_id_.count(id) > 0; }
+    void clear() override;
+    void reserve(size_t count) override;
+    std::vector<Hit> search(const std::vector<float>& query, size_t k, float threshold) const override;
+
+    size_t size() const override { return nodes_by_id_.size(); }
+    size_t dimension() const override { return dimension_; }
+
+    void serialize(std::string& out) const override;
+    bool deserialize(const char* data, size_t size) override;
+
+    size_t tombstones() const { return node_count_ - nodes_by_id_.size(); }
+    void set_ef_search(size_t ef_search) { config_.ef_search = ef_search; }
+    const Config& config() const { return config_; }
+
+private:
+    using NodeId = uint32_t;
+    static constexpr NodeId NO_NODE = UINT32_MAX;
+    static constexpr size_t LOCK_STRIPES = 1024;
+
+    struct Candidate {
+        float distance;  // 1 - cosine similarity
+        NodeId node;
+        bool operator<(const Candidate& other) const { return distance < other.distance; }
+        bool operator>(const Candidate& other) const { return distance > other.distance; }
+    };
+
+    size_t dimension_;
+    size_t stride_;
+    Config config_;
+    size_t max_links_;    // M, on layers above 0
+    size_t max_links0_;   // 2*M, on layer 0
+    double level_multiplier_;
+
+    size_t node_count_ = 0;
+    size_t capacity_ = 0;
+    vector_kernels::AlignedFloats data_;          // capacity_ rows of stride_ floats
+    std::vector<NodeId> links0_;                  // Per node: count, then max_links0_ ids
+    std::vector<std::vector<NodeId>> upper_links_;  // Per node: per layer above 0, count then max_links_ ids
+    std::vector<int> levels_;
+    std::vector<uint8_t> deleted_;
+    std::vector<std::string> ids_;                // Node -> id
+    std::unordered_map<std::string, NodeId> nodes_by_id_;  // Live nodes only
+
+    NodeId entry_point_ = NO_NODE;
+    int max_level_ = -1;
+    std::mutex entry_mutex_;                     // entry_point_ and max_level_ during add_batch
+    mutable std::unique_ptr<std::mutex[]> link_locks_;  // Striped by node
+    std::mt19937 level_generator_;
+    std::mutex level_mutex_;
+    bool concurrent_ = false;                    // add_batch() is inserting on several threads
+    vector_kernels::DotProductFn dot_;
+
+    void set_dimension(size_t dimension);
+    const float* row(NodeId node) const { return data_.data() + static_cast<size_t>(node) * stride_; }
+    float distance(const float* query, NodeId node) const { return 1.0f - dot_(query, row(node), stride_); }
+    NodeId* links(NodeId node, int level);
+    const NodeId* links(NodeId node, int level) const;
+    size_t link_capacity(int level) const { return level == 0 ? max_links0_ : max_links_; }
+
+    int random_level();
+    NodeId allocate_node(const std::string& id, const std::vector<float>& vector, int level);
+    void link_node(NodeId node);
+    NodeId greedy_closest(const float* query, NodeId entry, int from_level, int to_level) const;
+    std::vector<Candidate> search_layer(const float* query, NodeId entry, size_t ef, int level,
+                                        bool skip_deleted) const;
+    std::vector<NodeId> select_neighbors(std::vector<Candidate> candidates, size_t limit) const;
+    void connect(NodeId from, NodeId to, int level);
+    void copy_links(NodeId node, int level, std::vector<NodeId>& out) const;
+    void rebuild();
+};
+
+}  // namespace kolosal
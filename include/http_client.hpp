@@ -3,6 +3,9 @@
 #include <string>
 #include <map>
 #include <memory>
+#include <functional>
+#include <future>
+#include <cstdint>
 
 /**
  * @brief Safe HTTP client with buffer overflow protection and structured error handling
@@ -13,6 +16,10 @@
  * - Structured error responses with user-friendly messages
  * - Automatic retry with exponential backoff
  * - Cross-platform implementation (Windows/Unix)
+ * - Pooled libcurl handles sharing one connection, DNS and TLS session cache
+ * - Asynchronous requests multiplexed on a single curl-multi thread
+ * - Cooperative cancellation: requests honour the calling thread's
+ *   CancellationToken (see cancellation_token.hpp), including its deadline
  */
 class HttpClient {
 public:
@@ -25,6 +32,8 @@ public:
         int max_retries = 3;
         int retry_delay_ms = 1000;
         bool verify_ssl = true;
+        size_t max_pooled_handles = 16;     // Idle easy handles kept for reuse
+        size_t max_async_in_flight = 256;   // Concurrent transfers on the async engine; the rest queue
     };
 
     /**
@@ -35,6 +44,7 @@ public:
         std::string body;
         std::string error_message;
         bool retry_recommended;
+        bool cancelled = false;  // Aborted through a CancellationToken (status 499)
         
         bool is_success() const { 
             return status_code >= 200 && status_code < 300; 
@@ -49,11 +59,35 @@ public:
         }
     };
 
+    /**
+     * @brief Receives response body bytes as they arrive
+     * @return false to abort the transfer
+     */
+    using ChunkCallback = std::function<bool(const char* data, size_t size)>;
+
+    /**
+     * @brief Receives the outcome of an asynchronous request
+     */
+    using ResultCallback = std::function<void(Result result)>;
+
+    /**
+     * @brief Handle pool and async engine counters
+     */
+    struct Stats {
+        uint64_t handles_created = 0;
+        uint64_t handles_reused = 0;
+        size_t idle_handles = 0;
+        size_t async_in_flight = 0;
+        size_t async_queued = 0;
+    };
+
+    HttpClient();
+
     /**
      * @brief Constructor with configuration validation
      * @param config HTTP client configuration
      */
-    explicit HttpClient(const Config& config = Config{});
+    explicit HttpClient(const Config& config);
 
     /**
      * @brief Destructor
@@ -73,6 +107,51 @@ public:
                   const std::string& body = "",
                   const std::map<std::string, std::string>& headers = {});
 
+    /**
+     * @brief Make HTTP request and deliver the response body incrementally
+     *
+     * Successful (2xx) response bytes are passed to on_chunk as they arrive
+     * instead of being buffered; error responses are buffered into
+     * Result::body as usual. Streams are not retried, since part of the
+     * response may already have been consumed.
+     *
+     * @param on_chunk Called for each received piece of the body
+     * @return Structured result; body is empty on success
+     */
+    Result stream_request(const std::string& method,
+                         const std::string& endpoint,
+                         const std::string& body,
+                         const ChunkCallback& on_chunk,
+                         const std::map<std::string, std::string>& headers = {});
+
+    /**
+     * @brief Start a request without blocking the caller
+     *
+     * Transfers run concurrently on one shared curl-multi thread, which is
+     * started on first use. Retries follow the same policy as request().
+     * On WinHTTP builds the request runs on the calling thread.
+     *
+     * @param on_complete Invoked exactly once, on the engine thread; keep it short
+     */
+    void request_async(const std::string& method,
+                      const std::string& endpoint,
+                      const std::string& body,
+                      const std::map<std::string, std::string>& headers,
+                      ResultCallback on_complete);
+
+    /**
+     * @brief Future-returning form of request_async()
+     */
+    std::future<Result> request_async(const std::string& method,
+                                     const std::string& endpoint,
+                                     const std::string& body = "",
+                                     const std::map<std::string, std::string>& headers = {});
+
+    /**
+     * @brief Snapshot of handle reuse and async engine load
+     */
+    Stats get_stats() const;
+
     /**
      * @brief Update client configuration
      * @param new_config New configuration (validated)
@@ -88,6 +167,29 @@ public:
 private:
     Config config_;
 
+    // Handle pool, shared caches and async engine; defined in http_client.cpp
+    struct CurlState;
+    std::unique_ptr<CurlState> curl_state_;
+
+    /**
+     * @brief Validate a request and build its URL
+     * @return status_code 0 if the request may proceed, otherwise the error to report
+     */
+    Result prepare_request(const std::string& method,
+                          const std::string& endpoint,
+                          const std::string& body,
+                          std::string& url) const;
+
+    /**
+     * @brief Backoff before retry number attempt (exponential with jitter)
+     */
+    int retry_delay_ms(int attempt) const;
+
+    /**
+     * @brief Body of the async engine thread
+     */
+    void run_async_engine();
+
     /**
      * @brief Make request with retry logic and exponential backoff
      */
@@ -102,7 +204,8 @@ private:
     Result perform_request(const std::string& method,
                           const std::string& url,
                           const std::string& body,
-                          const std::map<std::string, std::string>& headers);
+                          const std::map<std::string, std::string>& headers,
+                          const ChunkCallback& on_chunk = nullptr);
 
 #ifdef _WIN32
     /**
@@ -111,7 +214,8 @@ private:
     Result perform_winhttp_request(const std::string& method,
                                   const std::string& url,
                                   const std::string& body,
-                                  const std::map<std::string, std::string>& headers);
+                                  const std::map<std::string, std::string>& headers,
+                                  const ChunkCallback& on_chunk);
 
     /**
      * @brief Safely parse URL components for WinHTTP
@@ -125,7 +229,8 @@ private:
     Result perform_curl_request(const std::string& method,
                                const std::string& url,
                                const std::string& body,
-                               const std::map<std::string, std::string>& headers);
+                               const std::map<std::string, std::string>& headers,
+                               const ChunkCallback& on_chunk);
 #endif
 
     /**
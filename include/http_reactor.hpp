@@ -0,0 +1,136 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <unordered_map>
+#include <chrono>
+#include "http_request_parser.hpp"
+#include "task_scheduler.hpp"
+
+/**
+ * @brief Event-driven HTTP front end built on epoll (Linux only)
+ *
+ * A fixed set of I/O threads owns all client sockets and performs the
+ * non-blocking reads. Once a complete request has been buffered the
+ * connection is detached from its I/O thread and handed, together with the
+ * raw request, to the shared TaskScheduler's interactive lane, with at most
+ * worker_threads handlers running at once. Slow handlers therefore never
+ * stall socket I/O, and the number of OS threads no longer grows with the
+ * number of connected clients.
+ *
+ * Persistent connections are handed back to their I/O thread after the
+ * worker has answered every complete (possibly pipelined) request in the
+ * buffer. Connections that stay idle longer than idle_timeout_ms are closed.
+ *
+ * Long-lived responses (event streams) would hold one of the worker_threads
+ * handler slots for their whole life; a handler hands them off with
+ * detach_stream() so they run on their own thread instead.
+ */
+class HttpReactor {
+public:
+    struct Config {
+        int io_threads = 2;
+        int worker_threads = 0;          // Concurrent handlers; 0 = hardware concurrency
+        size_t max_connections = 1024;
+        size_t max_request_size = HttpRequestParser::DEFAULT_MAX_REQUEST_SIZE;
+        bool keep_alive = true;          // False closes every connection after one response
+        int idle_timeout_ms = 5000;
+        int max_requests_per_connection = 100;
+    };
+
+    /**
+     * @brief Handler invoked on a worker thread for every complete request
+     * @param fd Client socket (non-blocking)
+     * @param request Parsed request; views into the connection buffer
+     * @param allow_keep_alive False when this is the last request the
+     *        connection may serve; the response must then close it
+     * @return True to keep the connection open for further requests
+     */
+    using RequestHandler = std::function<bool(int fd, const HttpRequest& request, bool allow_keep_alive)>;
+
+    /**
+     * @brief Construct a reactor serving an already bound, listening socket
+     * @param listen_fd Listening socket; ownership stays with the caller
+     */
+    HttpReactor(int listen_fd, const Config& config, RequestHandler handler);
+    ~HttpReactor();
+
+    bool start();
+    void stop();
+    bool is_running() const { return running_.load(); }
+
+    /**
+     * @brief Finish the current response outside the handler pool
+     *
+     * Call from a RequestHandler running on this reactor, then return from
+     * the handler without writing anything else. Once the handler returns,
+     * the stream runs on a thread of its own and owns the connection, which
+     * is closed when the stream returns.
+     */
+    void detach_stream(std::function<void()> stream);
+
+    size_t active_connections() const { return active_connections_.load(); }
+    size_t rejected_connections() const { return rejected_connections_.load(); }
+    size_t active_streams() const;
+
+private:
+    struct IoLoop;
+
+    struct Connection {
+        int fd = -1;
+        IoLoop* owner = nullptr;
+        std::string buffer;      // Reused across requests on this connection
+        HttpRequestParser parser;
+        int requests_served = 0;
+        bool peer_closed = false;
+        std::chrono::steady_clock::time_point last_active;
+
+        explicit Connection(size_t max_request_size) : parser(max_request_size) {}
+    };
+
+    struct IoLoop {
+        int epoll_fd = -1;
+        int wake_fd = -1;
+        std::thread thread;
+        std::unordered_map<int, std::shared_ptr<Connection>> connections;
+
+        // Keep-alive connections handed back by workers
+        std::mutex returned_mutex;
+        std::vector<std::shared_ptr<Connection>> returned;
+    };
+
+    int listen_fd_;
+    Config config_;
+    RequestHandler handler_;
+    std::atomic<bool> running_{false};
+    std::atomic<size_t> active_connections_{0};
+    std::atomic<size_t> rejected_connections_{0};
+
+    std::vector<std::unique_ptr<IoLoop>> io_loops_;
+
+    // Handlers run on the shared scheduler, at most worker_threads at a time
+    TaskGroup handler_tasks_;
+
+    // Detached streams, each on its own thread; stop() waits for them
+    mutable std::mutex streams_mutex_;
+    std::condition_variable streams_idle_;
+    size_t active_streams_ = 0;
+
+    void io_loop(IoLoop* loop);
+    void accept_connections(IoLoop* loop);
+    void read_connection(IoLoop* loop, int fd);
+    void close_connection(IoLoop* loop, int fd);
+    void reject_request(int fd, const HttpRequestParser& parser);
+    void adopt_returned(IoLoop* loop);
+    void close_idle_connections(IoLoop* loop);
+    void dispatch(std::shared_ptr<Connection> connection);
+    void serve_connection(const std::shared_ptr<Connection>& connection);
+    void start_stream(std::shared_ptr<Connection> connection, std::function<void()> stream);
+};
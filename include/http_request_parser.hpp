@@ -0,0 +1,133 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+
+/**
+ * @brief Parsed view of one HTTP request
+ *
+ * All fields are views into the connection buffer the request was parsed
+ * from and stay valid until that buffer is modified (normally until
+ * HttpRequestParser::consume()).
+ */
+struct HttpRequest {
+    std::string_view method;
+    std::string_view target;   // As sent, including any query string
+    std::string_view path;     // Target without the query string
+    std::string_view query;    // Text after '?', empty if absent
+    std::string_view version;
+    std::vector<std::pair<std::string_view, std::string_view>> headers;
+    std::string_view body;     // De-chunked when Transfer-Encoding is chunked
+    bool keep_alive = false;   // Client permits connection reuse
+
+    /**
+     * @brief Case-insensitive header lookup
+     * @return Header value, or an empty view if the header is absent
+     */
+    std::string_view header(std::string_view name) const;
+};
+
+/**
+ * @brief Incremental, size-bounded HTTP/1.x request parser
+ *
+ * Bytes are appended to a caller-owned, per-connection buffer and parse() is
+ * called after each read. The parser resumes where it stopped, so a request
+ * that arrives in many segments is scanned once. Content-Length and chunked
+ * bodies are supported; chunked bodies are decoded in place so that
+ * HttpRequest::body is a single contiguous view without extra copies.
+ *
+ * After a request has been handled, consume() drops its bytes from the buffer
+ * and resets the parser; any pipelined bytes that follow are kept.
+ */
+class HttpRequestParser {
+public:
+    enum class Result {
+        INCOMPLETE,  // Need more bytes
+        COMPLETE,    // request() is ready
+        ERROR        // error_status()/error_message() describe the problem
+    };
+
+    static constexpr size_t DEFAULT_MAX_REQUEST_SIZE = 10 * 1024 * 1024;
+    static constexpr size_t DEFAULT_MAX_HEADER_SIZE = 64 * 1024;
+
+    explicit HttpRequestParser(size_t max_request_size = DEFAULT_MAX_REQUEST_SIZE,
+                               size_t max_header_size = DEFAULT_MAX_HEADER_SIZE);
+
+    /**
+     * @brief Continue parsing the buffer
+     * @param buffer Connection buffer; must only have been appended to since
+     *        the previous call (chunked decoding rewrites bytes in place)
+     */
+    Result parse(std::string& buffer);
+
+    /**
+     * @brief Remove the completed request from the buffer and reset
+     */
+    void consume(std::string& buffer);
+
+    /**
+     * @brief Reset the parser state without touching any buffer
+     */
+    void reset();
+
+    const HttpRequest& request() const { return request_; }
+    int error_status() const { return error_status_; }
+    const std::string& error_message() const { return error_message_; }
+
+    /**
+     * @brief Whether a "100 Continue" interim response is owed to the client
+     *
+     * Returns true once, after the headers of a request carrying
+     * "Expect: 100-continue" have been parsed and its body is still missing.
+     */
+    bool take_continue();
+
+    size_t max_request_size() const { return max_request_size_; }
+
+private:
+    enum class State {
+        HEADERS,
+        BODY,
+        CHUNK_SIZE,
+        CHUNK_DATA,
+        CHUNK_DATA_END,
+        TRAILERS,
+        COMPLETE,
+        ERROR
+    };
+
+    struct Span {
+        size_t offset = 0;
+        size_t length = 0;
+    };
+
+    size_t max_request_size_;
+    size_t max_header_size_;
+
+    State state_ = State::HEADERS;
+    size_t start_ = 0;           // First byte of the request line
+    size_t scan_offset_ = 0;     // Resume point for line/terminator searches
+    size_t body_start_ = 0;
+    size_t read_pos_ = 0;        // Next undecoded byte (chunked) / body end
+    size_t write_pos_ = 0;       // End of the decoded body (chunked)
+    size_t content_length_ = 0;
+    size_t chunk_remaining_ = 0;
+    bool chunked_ = false;
+    bool continue_pending_ = false;
+
+    Span method_, target_, version_;
+    std::vector<std::pair<Span, Span>> header_spans_;
+
+    HttpRequest request_;
+    int error_status_ = 0;
+    std::string error_message_;
+
+    Result fail(int status, const std::string& message);
+    Result parse_headers(std::string& buffer);
+    Result parse_chunked(std::string& buffer);
+    Result finish(const std::string& buffer);
+    std::string_view view(const std::string& buffer, const Span& span) const;
+    std::string_view find_header(const std::string& buffer, std::string_view name) const;
+};
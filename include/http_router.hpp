@@ -0,0 +1,245 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <memory>
+#include <stdexcept>
+#include <functional>
+
+/**
+ * @brief Path parameters captured while resolving a route
+ *
+ * Names and values are views into the registered pattern and the request
+ * path respectively; no allocation happens during matching.
+ */
+class RouteParams {
+public:
+    static constexpr size_t MAX_PARAMS = 4;
+
+    std::string_view get(std::string_view name) const {
+        for (size_t i = 0; i < count_; ++i) {
+            if (entries_[i].first == name) {
+                return entries_[i].second;
+            }
+        }
+        return {};
+    }
+
+    size_t size() const { return count_; }
+
+    void push(std::string_view name, std::string_view value) {
+        entries_[count_++] = {name, value};
+    }
+    void pop() { --count_; }
+
+private:
+    std::array<std::pair<std::string_view, std::string_view>, MAX_PARAMS> entries_{};
+    size_t count_ = 0;
+};
+
+/**
+ * @brief Compiled route table: static segments, {name} captures, per-method handlers
+ *
+ * Routes are stored in a segment trie, so resolving a path costs one child
+ * lookup per path segment regardless of how many routes are registered.
+ * Static segments take precedence over captures at the same position
+ * ("/workflows/executions" wins over "/workflows/{id}").
+ *
+ * @tparam Handler Callable stored per (pattern, method)
+ */
+template <typename Handler>
+class HttpRouter {
+public:
+    enum class MatchStatus {
+        MATCHED,
+        NOT_FOUND,           // No pattern matches the path
+        METHOD_NOT_ALLOWED   // Path matches, but not for this method
+    };
+
+    struct Match {
+        MatchStatus status = MatchStatus::NOT_FOUND;
+        const Handler* handler = nullptr;
+        const std::string* name = nullptr;  // Route description for logging
+        RouteParams params;
+    };
+
+    /**
+     * @brief Register a handler
+     * @param method HTTP method (GET, POST, PUT, DELETE, PATCH, HEAD, OPTIONS)
+     * @param pattern Path pattern such as "/agents/{id}/execute"
+     * @param name Human-readable route description used in debug logs
+     * @throws std::invalid_argument on an unknown method, a malformed pattern
+     *         or a duplicate registration
+     */
+    void add(std::string_view method, std::string_view pattern, std::string name, Handler handler) {
+        int method_index = method_to_index(method);
+        if (method_index < 0) {
+            throw std::invalid_argument("Unsupported HTTP method: " + std::string(method));
+        }
+        if (pattern.empty() || pattern.front() != '/') {
+            throw std::invalid_argument("Route pattern must start with '/': " + std::string(pattern));
+        }
+
+        Node* node = &root_;
+        size_t captures = 0;
+        for_each_segment(pattern, [&](std::string_view segment) {
+            if (segment.size() >= 2 && segment.front() == '{' && segment.back() == '}') {
+                std::string param_name(segment.substr(1, segment.size() - 2));
+                if (param_name.empty() || ++captures > RouteParams::MAX_PARAMS) {
+                    throw std::invalid_argument("Invalid capture in route pattern: " + std::string(pattern));
+                }
+                if (!node->param_child) {
+                    node->param_child = std::make_unique<Node>();
+                    node->param_name = std::move(param_name);
+                } else if (node->param_name != param_name) {
+                    throw std::invalid_argument("Conflicting capture names in route pattern: " + std::string(pattern));
+                }
+                node = node->param_child.get();
+            } else {
+                Node* child = node->find_static(segment);
+                if (!child) {
+                    node->static_children.emplace_back(std::string(segment), std::make_unique<Node>());
+                    child = node->static_children.back().second.get();
+                }
+                node = child;
+            }
+        });
+
+        auto& slot = node->handlers[method_index];
+        if (slot) {
+            throw std::invalid_argument("Duplicate route: " + std::string(method) + " " + std::string(pattern));
+        }
+        slot = std::make_unique<Entry>(Entry{std::move(name), std::move(handler)});
+        route_count_++;
+    }
+
+    /**
+     * @brief Resolve a request path (without query string) and method
+     */
+    Match resolve(std::string_view method, std::string_view path) const {
+        Match match;
+        if (path.empty() || path.front() != '/') {
+            return match;
+        }
+
+        std::array<std::string_view, MAX_SEGMENTS> segments;
+        size_t segment_count = 0;
+        bool too_deep = false;
+        for_each_segment(path, [&](std::string_view segment) {
+            if (segment_count == MAX_SEGMENTS) {
+                too_deep = true;
+                return;
+            }
+            segments[segment_count++] = segment;
+        });
+        if (too_deep) {
+            return match;
+        }
+
+        const Node* node = find(&root_, segments.data(), segment_count, match.params);
+        if (!node) {
+            return match;
+        }
+
+        int method_index = method_to_index(method);
+        const Entry* entry = method_index >= 0 ? node->handlers[method_index].get() : nullptr;
+        if (!entry) {
+            match.status = MatchStatus::METHOD_NOT_ALLOWED;
+            return match;
+        }
+        match.status = MatchStatus::MATCHED;
+        match.handler = &entry->handler;
+        match.name = &entry->name;
+        return match;
+    }
+
+    size_t size() const { return route_count_; }
+
+private:
+    static constexpr size_t METHOD_COUNT = 7;
+    static constexpr size_t MAX_SEGMENTS = 16;
+
+    struct Entry {
+        std::string name;
+        Handler handler;
+    };
+
+    struct Node {
+        // Fan-out per segment is small (a handful of literals), so a flat
+        // scan beats hashing every segment of every request.
+        std::vector<std::pair<std::string, std::unique_ptr<Node>>> static_children;
+        std::unique_ptr<Node> param_child;
+        std::string param_name;
+        std::array<std::unique_ptr<Entry>, METHOD_COUNT> handlers;
+
+        Node* find_static(std::string_view segment) const {
+            for (const auto& [literal, child] : static_children) {
+                if (literal == segment) {
+                    return child.get();
+                }
+            }
+            return nullptr;
+        }
+
+        bool has_handlers() const {
+            for (const auto& handler : handlers) {
+                if (handler) return true;
+            }
+            return false;
+        }
+    };
+
+    Node root_;
+    size_t route_count_ = 0;
+
+    static int method_to_index(std::string_view method) {
+        if (method == "GET") return 0;
+        if (method == "POST") return 1;
+        if (method == "PUT") return 2;
+        if (method == "DELETE") return 3;
+        if (method == "PATCH") return 4;
+        if (method == "HEAD") return 5;
+        if (method == "OPTIONS") return 6;
+        return -1;
+    }
+
+    // Calls fn for every non-empty '/'-separated segment; a trailing slash is ignored.
+    template <typename Fn>
+    static void for_each_segment(std::string_view path, Fn&& fn) {
+        size_t pos = 0;
+        while (pos < path.size()) {
+            size_t next = path.find('/', pos);
+            if (next == std::string_view::npos) {
+                next = path.size();
+            }
+            if (next > pos) {
+                fn(path.substr(pos, next - pos));
+            }
+            pos = next + 1;
+        }
+    }
+
+    // Depth-first walk preferring static segments; backtracks into captures.
+    static const Node* find(const Node* node, const std::string_view* segments, size_t remaining, RouteParams& params) {
+        if (remaining == 0) {
+            return node->has_handlers() ? node : nullptr;
+        }
+
+        if (const Node* child = node->find_static(segments[0])) {
+            if (const Node* found = find(child, segments + 1, remaining - 1, params)) {
+                return found;
+            }
+        }
+
+        if (node->param_child) {
+            params.push(node->param_name, segments[0]);
+            if (const Node* found = find(node->param_child.get(), segments + 1, remaining - 1, params)) {
+                return found;
+            }
+            params.pop();
+        }
+        return nullptr;
+    }
+};
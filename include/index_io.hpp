@@ -0,0 +1,163 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace kolosal {
+
+/**
+ * @brief Binary encoding helpers for the vector index files
+ *
+ * Values are written in host byte order. Every supported target is
+ * little-endian, and the file header records the byte order so that a
+ * mismatched file is rejected rather than misread.
+ */
+namespace index_io {
+
+    /**
+     * @brief Appends fixed-size values, arrays and length-prefixed strings to a buffer
+     */
+    class Writer {
+    public:
+        explicit Writer(std::string& out) : out_(out) {}
+
+        template <typename T>
+        void put(T value) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            put_bytes(&value, sizeof(T));
+        }
+
+        void put_bytes(const void* data, size_t size) {
+            if (size > 0) {
+                out_.append(static_cast<const char*>(data), size);
+            }
+        }
+
+        void put_string(std::string_view value) {
+            put<uint64_t>(value.size());
+            put_bytes(value.data(), value.size());
+        }
+
+        template <typename T, typename Allocator>
+        void put_array(const std::vector<T, Allocator>& values, size_t count) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            put<uint64_t>(count);
+            put_bytes(values.data(), count * sizeof(T));
+        }
+
+        size_t size() const { return out_.size(); }
+
+    private:
+        std::string& out_;
+    };
+
+    /**
+     * @brief Bounds-checked reads of what Writer wrote; every getter returns false past the end
+     */
+    class Reader {
+    public:
+        Reader(const char* data, size_t size) : data_(data), size_(size) {}
+
+        template <typename T>
+        bool get(T& value) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            if (size_ - offset_ < sizeof(T)) {
+                return false;
+            }
+            std::memcpy(&value, data_ + offset_, sizeof(T));
+            offset_ += sizeof(T);
+            return true;
+        }
+
+        /**
+         * @brief A length-prefixed string, as a view into the underlying data
+         */
+        bool get_view(std::string_view& value) {
+            uint64_t length;
+            if (!get(length) || size_ - offset_ < length) {
+                return false;
+            }
+            value = std::string_view(data_ + offset_, static_cast<size_t>(length));
+            offset_ += static_cast<size_t>(length);
+            return true;
+        }
+
+        bool get_string(std::string& value) {
+            std::string_view view;
+            if (!get_view(view)) {
+                return false;
+            }
+            value.assign(view);
+            return true;
+        }
+
+        /**
+         * @brief An array written by put_array(); fails unless it holds expected elements
+         */
+        template <typename T, typename Allocator>
+        bool get_array(std::vector<T, Allocator>& values, size_t expected) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            uint64_t count;
+            if (!get(count) || count != expected || (size_ - offset_) / sizeof(T) < count) {
+                return false;
+            }
+            values.resize(static_cast<size_t>(count));
+            if (count > 0) {
+                std::memcpy(values.data(), data_ + offset_, static_cast<size_t>(count) * sizeof(T));
+            }
+            offset_ += static_cast<size_t>(count) * sizeof(T);
+            return true;
+        }
+
+        size_t offset() const { return offset_; }
+        bool at_end() const { return offset_ == size_; }
+
+    private:
+        const char* data_;
+        size_t size_;
+        size_t offset_ = 0;
+    };
+
+    /**
+     * @brief CRC-32 (IEEE 802.3) of data, continuing from crc
+     */
+    uint32_t crc32(const void* data, size_t size, uint32_t crc = 0);
+
+    /**
+     * @brief Read-only memory map of a whole file
+     *
+     * Pages are read from disk the first time they are touched. The mapping
+     * stays valid after the file is renamed over or unlinked (POSIX).
+     */
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        /**
+         * @return false if the file cannot be opened or mapped
+         */
+        bool open(const std::string& path);
+        void close();
+
+        const char* data() const { return data_; }
+        size_t size() const { return size_; }
+
+    private:
+        const char* data_ = nullptr;
+        size_t size_ = 0;
+#ifdef _WIN32
+        void* file_ = nullptr;
+        void* mapping_ = nullptr;
+#endif
+    };
+
+}  // namespace index_io
+
+}  // namespace kolosal
@@ -348,6 +348,30 @@ public:
                                 const std::string& system_prompt = "",
                                 const json& conversation_history = json::array());
     
+    /**
+     * @brief Send a chat message and receive the reply as it is generated
+     * @param model_name Name of the model to use
+     * @param message User message
+     * @param system_prompt Optional system prompt
+     * @param on_delta Called with each piece of generated text; return false to stop
+     * @return Complete model response
+     */
+    std::string chat_with_model_stream(const std::string& model_name,
+                                       const std::string& message,
+                                       const std::string& system_prompt,
+                                       const KolosalClient::TokenCallback& on_delta);
+    
+    /**
+     * @brief Send a chat message without blocking the calling thread
+     * @param model_name Name of the model to use (resolved like chat_with_model)
+     * @param message User message
+     * @param system_prompt Optional system prompt
+     * @return Future holding the model response
+     */
+    std::future<std::string> chat_with_model_async(const std::string& model_name,
+                                                   const std::string& message,
+                                                   const std::string& system_prompt = "");
+    
     /**
      * @brief Check if a model is available
      * @param model_name Name of the model to check
@@ -369,7 +393,7 @@ public:
     
     /**
      * @brief Resolve model alias to actual server model name
-     * @param model_name Model alias or name to resolve
+     * @param model_name Model id, actual_name, name or one of its aliases
      * @return Actual model name expected by server
      */
     std::string resolve_model_name(const std::string& model_name);
@@ -377,6 +401,16 @@ public:
 private:
     json model_configurations_;
     
+    // id, actual_name, name and aliases of each configured model -> index
+    // into model_configurations_; guarded by models_mutex_
+    std::unordered_map<std::string, size_t> model_index_;
+    mutable std::mutex models_mutex_;
+    
+    /**
+     * @brief Rebuild model_index_ from model_configurations_ (caller holds models_mutex_)
+     */
+    void rebuild_model_index();
+    
     /**
      * @brief Get the underlying Kolosal client
      * @return Reference to the Kolosal client
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include "vector_index.hpp"
+
+namespace kolosal {
+
+/**
+ * @brief Exact-scan cosine-similarity index over compressed vectors
+ *
+ * Two encodings are available:
+ * - Scalar8 stores one byte per dimension. Each dimension has its own
+ *   [min, max] range, learned from the training vectors. A query is scored
+ *   straight on the byte codes with vector_kernels::code_dot_product().
+ * - Product splits each vector into pq_subvectors parts and keeps, per part,
+ *   one byte naming the nearest of 256 k-means centroids. A query builds a
+ *   table of its similarity to every centroid once. After that, each vector
+ *   costs pq_subvectors table lookups.
+ *
+ * Vectors are kept at full precision until training_size of them have been
+ * added. The codebook is then trained on those vectors, and every vector is
+ * encoded from that point on; smaller collections simply stay exact.
+ *
+ * When rerank_candidates is set, the full-precision vectors are kept as
+ * well. A search then takes that many candidates by code score and
+ * re-scores them exactly. This gives back most of the recall, at the cost
+ * of the memory the codes would have saved.
+ *
+ * Not thread-safe; the vector stores guard it with their own locks.
+ */
+class QuantizedVectorIndex : public IVectorIndex {
+public:
+    enum class Encoding {
+        Scalar8,  // One byte per dimension: 4x smaller than float
+        Product   // One byte per sub-vector
+    };
+
+    struct Config {
+        Encoding encoding = Encoding::Scalar8;
+        size_t pq_subvectors = 0;         // Product only; 0 = dimension / 8
+        size_t training_size = 10000;     // Vectors kept exact before the codebook is trained
+        size_t rerank_candidates = 0;     // Candidates re-scored exactly; 0 = codes only, no float copy
+        size_t build_threads = 0;         // Codebook training; 0 = hardware threads
+        uint32_t seed = 42;               // k-means initialisation
+    };
+
+    explicit QuantizedVectorIndex(size_t dimension = 0);
+    QuantizedVectorIndex(size_t dimension, const Config& config);
+
+    bool add(const std::string& id, const std::vector<float>& vector) override;
+    bool remove(const std::string& id) override;
+    bool contains(const std::string& id) const override { return rows_.count(id) > 0; }
+    void clear() override;
+    void reserve(size_t count) override;
+    std::vector<Hit> search(const std::vector<float>& query, size_t k, float threshold) const override;
+
+    size_t size() const override { return ids_.size(); }
+    size_t dimension() const override { return dimension_; }
+
+    void serialize(std::string& out) const override;
+    bool deserialize(const char* data, size_t size) override;
+
+    bool trained() const { return trained_; }
+
+    /**
+     * @brief Bytes held for vector data: codes, full-precision rows and codebook
+     *
+     * Ids and the id map are not counted; they cost the same for every index.
+     */
+    size_t memory_usage() const;
+
+    const Config& config() const { return config_; }
+
+private:
+    static constexpr size_t CENTROIDS = 256;
+    static constexpr size_t KMEANS_ITERATIONS = 16;
+
+    size_t dimension_;
+    size_t stride_;                               // Padded float row length
+    Config config_;
+    bool trained_ = false;
+
+    vector_kernels::AlignedFloats full_;          // Normalised rows; kept until trained, or for re-ranking
+    std::vector<uint8_t, AlignedAllocator<uint8_t, vector_kernels::ALIGNMENT>> codes_;  // code_size_ per row
+    size_t code_size_ = 0;
+
+    // Scalar8: per dimension, value = minimum + step * code
+    vector_kernels::AlignedFloats minimum_;
+    vector_kernels::AlignedFloats step_;
+
+    // Product: sub-vector s covers dimensions [offsets_[s], offsets_[s + 1])
+    std::vector<size_t> offsets_;
+    std::vector<float> centroids_;                // Per sub-vector: width rows of CENTROIDS values (dimension-major)
+    std::vector<float> centroid_norms_;           // Per sub-vector: squared length of each centroid
+
+    std::vector<std::string> ids_;                // Row -> id
+    std::unordered_map<std::string, size_t> rows_;  // id -> row
+    vector_kernels::DotProductFn dot_;
+    vector_kernels::CodeDotProductFn code_dot_;
+
+    void set_dimension(size_t dimension);
+    bool keeps_full() const { return !trained_ || config_.rerank_candidates > 0; }
+    void train();
+    void train_scalar();
+    void train_product();
+    void compute_centroid_norms();
+    void encode(const float* normalized, uint8_t* code) const;
+    std::vector<Hit> search_full(const float* normalized, size_t k, float threshold) const;
+};
+
+}  // namespace kolosal
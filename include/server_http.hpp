@@ -3,10 +3,14 @@
 #include "agent_manager.hpp"
 #include "workflow_manager.hpp"
 #include "workflow_types.hpp"
+#include "http_request_parser.hpp"
+#include "http_router.hpp"
 #include <string>
 #include <memory>
 #include <thread>
 #include <atomic>
+#include <mutex>
+#include <condition_variable>
 #include <json.hpp>
 
 #ifdef _WIN32
@@ -27,10 +31,36 @@ typedef int socket_t;
 
 using json = nlohmann::json;
 
+class HttpReactor;
+
 /**
  * @brief HTTP Server for Agent API
  */
 class HTTPServer {
+public:
+    /**
+     * @brief Connection handling model
+     */
+    enum class IoModel {
+        THREAD_PER_CONNECTION,  // Legacy: one detached thread per accepted socket
+        EPOLL                   // Fixed I/O threads + handler worker pool (Linux only)
+    };
+
+    struct Config {
+        IoModel io_model = IoModel::THREAD_PER_CONNECTION;
+        int backlog = 128;
+        size_t max_connections = 1024;
+        int io_threads = 2;
+        int worker_threads = 0;  // 0 = hardware concurrency
+        bool keep_alive = true;
+        int keep_alive_timeout_ms = 5000;
+        int max_requests_per_connection = 100;
+        size_t max_request_size = HttpRequestParser::DEFAULT_MAX_REQUEST_SIZE;
+        size_t max_event_streams = 256;  // Concurrent SSE responses before new ones get 503
+    };
+
+    static IoModel parse_io_model(const std::string& name);
+
 private:
     std::shared_ptr<AgentManager> agent_manager_;
     std::shared_ptr<WorkflowManager> workflow_manager_;
@@ -40,13 +70,29 @@ private:
     socket_t server_socket_;
     std::atomic<bool> running_{false};
     std::thread server_thread_;
+    Config config_;
+    std::unique_ptr<HttpReactor> reactor_;
+    
+    // Thread-per-connection mode; the reactor keeps its own counters
+    std::atomic<size_t> active_connections_{0};
+    std::atomic<size_t> rejected_connections_{0};
+    std::atomic<size_t> active_streams_{0};
+    std::mutex connections_mutex_;
+    std::condition_variable connections_idle_;  // Last connection thread exited; stop() waits for it
+    
+    // Route table, built once in the constructor
+    using RouteHandler = std::function<void(socket_t client_socket, const RouteParams& params, const std::string& body)>;
+    using RouteStatus = HttpRouter<RouteHandler>::MatchStatus;
+    HttpRouter<RouteHandler> router_;
+    void register_routes();
     
     // HTTP handling
     void server_loop();
     void handle_client(socket_t client_socket);
-    std::string parse_http_request(const std::string& request, std::string& method, std::string& path, std::string& body);
+    bool process_request(socket_t client_socket, const HttpRequest& request, bool allow_keep_alive);
     void send_response(socket_t client_socket, int status_code, const std::string& body, const std::string& content_type = "application/json");
     void send_error(socket_t client_socket, int status_code, const std::string& message);
+    void run_event_stream(socket_t client_socket, std::function<void()> stream);
     
     // Route handlers
     void handle_list_agents(socket_t client_socket);
@@ -56,6 +102,9 @@ private:
     void handle_stop_agent(socket_t client_socket, const std::string& agent_id);
     void handle_delete_agent(socket_t client_socket, const std::string& agent_id);
     void handle_execute_function(socket_t client_socket, const std::string& agent_id, const std::string& body);
+    void handle_execute_function_stream(socket_t client_socket, const std::string& agent_id,
+                                        const std::string& function_name, const json& params,
+                                        const std::string& model);
     void handle_simple_agent_execute(socket_t client_socket, const std::string& body);
     void handle_execute_all_tools(socket_t client_socket, const std::string& agent_id, const json& params);
     void handle_system_status(socket_t client_socket);
@@ -86,6 +135,7 @@ private:
     void handle_execute_workflow_template(socket_t client_socket, const std::string& template_id, const std::string& body);
     void handle_workflow_execution_progress(socket_t client_socket, const std::string& execution_id);
     void handle_workflow_execution_logs(socket_t client_socket, const std::string& execution_id);
+    void handle_workflow_execution_events(socket_t client_socket, const std::string& execution_id);
     
     // Metrics and monitoring handlers
     void handle_get_system_metrics(socket_t client_socket);
@@ -94,7 +144,6 @@ private:
     void handle_get_performance_metrics(socket_t client_socket);
     
     // Utility
-    std::string extract_path_parameter(const std::string& path, const std::string& prefix);
     std::string resolve_agent_identifier(const std::string& agent_identifier);
     
 public:
@@ -106,6 +155,12 @@ public:
                std::shared_ptr<WorkflowOrchestrator> workflow_orchestrator,
                const std::string& host = "127.0.0.1", 
                int port = 8080);
+    HTTPServer(std::shared_ptr<AgentManager> agent_manager,
+               std::shared_ptr<WorkflowManager> workflow_manager,
+               std::shared_ptr<WorkflowOrchestrator> workflow_orchestrator,
+               const std::string& host,
+               int port,
+               const Config& config);
     ~HTTPServer();
     
     bool start();
@@ -114,4 +169,5 @@ public:
     
     const std::string& get_host() const { return host_; }
     int get_port() const { return port_; }
+    const Config& get_config() const { return config_; }
 };
@@ -12,7 +12,9 @@
 #include <atomic>
 #include <unordered_map>
 #include <set>
+#include <exception>
 #include <json.hpp>
+#include "task_scheduler.hpp"
 
 using json = nlohmann::json;
 
@@ -86,6 +88,9 @@ using EventCallback = std::function<void(const AsyncEvent&)>;
 
 /**
  * @brief Thread-safe async service layer
+ *
+ * Queued operations run on the shared TaskScheduler in its interactive lane,
+ * at most worker_count at a time, in priority order.
  */
 class AsyncServiceLayer {
 public:
@@ -103,6 +108,25 @@ public:
                                      Func&& func, 
                                      int priority = 0);
     
+    /**
+     * @brief Completion handle for operations submitted with submit_async_operation()
+     *
+     * error is null on success. Calls after the first are ignored.
+     */
+    using OperationCompletion = std::function<void(json result, std::exception_ptr error)>;
+    
+    /**
+     * @brief Track an operation that completes by callback rather than on a worker
+     *
+     * start runs on the calling thread and should only initiate the work, e.g.
+     * a KolosalClient::*_async call that is handed the completion. The operation
+     * is registered, reported to subscribers and counted like submit_operation(),
+     * but no worker thread waits on it, so network-bound operations do not
+     * limit each other to worker_count in flight.
+     */
+    std::future<json> submit_async_operation(const std::string& operation_type,
+                                             std::function<void(OperationCompletion)> start);
+    
     std::future<json> submit_batch_operation(const std::string& operation_type,
                                            const std::vector<std::function<json()>>& tasks);
     
@@ -125,19 +149,18 @@ public:
     json get_worker_statistics() const;
     
 private:
-    void worker_thread();
+    void run_next_task();
+    void finish_task(const std::shared_ptr<AsyncTask>& task, json result, std::exception_ptr error);
     void cleanup_completed_operations();
     void notify_subscribers(const AsyncEvent& event);
     std::string generate_operation_id();
     
     std::atomic<bool> running_{false};
     size_t worker_count_;
-    std::vector<std::thread> worker_threads_;
     std::thread cleanup_thread_;
     
     // Task queue
     mutable std::mutex queue_mutex_;
-    std::condition_variable queue_condition_;
     std::priority_queue<std::shared_ptr<AsyncTask>, 
                        std::vector<std::shared_ptr<AsyncTask>>,
                        std::function<bool(const std::shared_ptr<AsyncTask>&, 
@@ -156,6 +179,10 @@ private:
     std::atomic<size_t> completed_operations_{0};
     std::atomic<size_t> failed_operations_{0};
     std::atomic<size_t> cancelled_operations_{0};
+    std::atomic<size_t> async_in_flight_{0};
+    
+    // Runs queued operations on the shared scheduler; declared last so it drains first
+    TaskGroup worker_tasks_;
 };
 
 /**
@@ -324,6 +351,8 @@ std::future<json> AsyncServiceLayer::submit_operation(const std::string& operati
         task_queue_.push(task);
     }
     
-    queue_condition_.notify_one();
+    if (running_) {
+        worker_tasks_.submit([this]() { run_next_task(); });
+    }
     return future;
 }
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <json.hpp>
+
+using json = nlohmann::json;
+
+/**
+ * @brief Recent call latencies of hedged workflow steps, and hedging outcomes
+ *
+ * Keeps the latencies of the last window_size successful calls of each step
+ * (keyed "<workflow id>/<step id>") in a ring, from which the delay after
+ * which a duplicate request is launched is read as a percentile. Counts how
+ * many hedges were launched and which request of each race won.
+ *
+ * Thread-safe.
+ */
+class StepLatencyTracker {
+public:
+    struct Stats {
+        uint64_t hedges_launched = 0;
+        uint64_t primary_wins = 0;       // Hedged races the original request won
+        uint64_t hedge_wins = 0;         // Hedged races the duplicate won
+        uint64_t losers_cancelled = 0;   // Losing requests cancelled while still running
+        uint64_t both_failed = 0;
+    };
+
+    explicit StepLatencyTracker(size_t window_size = 256);
+
+    void record_latency(const std::string& key, double latency_ms);
+
+    /**
+     * @brief Latency below which percentile % of the recorded calls completed
+     * @return nullopt while fewer than min_samples calls are recorded
+     */
+    std::optional<double> percentile(const std::string& key, double percentile, size_t min_samples) const;
+
+    void record_hedge_launched();
+
+    /**
+     * @param hedge_won Whether the duplicate request finished first
+     * @param loser_cancelled Whether the other request was still running and got cancelled
+     */
+    void record_hedge_outcome(bool hedge_won, bool loser_cancelled);
+    void record_hedge_failed();
+
+    Stats get_stats() const;
+
+    /**
+     * @brief Counters plus sample count, p50, p95 and p99 per step
+     */
+    json to_json() const;
+
+private:
+    struct Window {
+        std::vector<double> samples;  // Ring of the latest window_size_ latencies
+        size_t next = 0;
+    };
+
+    const size_t window_size_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Window> windows_;
+    Stats stats_;
+
+    static double percentile_of(std::vector<double> samples, double percentile);
+};
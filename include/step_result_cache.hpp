@@ -0,0 +1,86 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "workflow_expressions.hpp"
+
+/**
+ * @brief Content-addressed cache of workflow step results
+ *
+ * A result is keyed by agent, function, LLM model and a 64-bit hash of the
+ * canonical serialisation of the resolved parameters (object keys sorted),
+ * so two steps that would send the agent the same call share one entry no
+ * matter which workflow or execution they belong to. Entries expire after
+ * ttl_seconds; beyond max_entries or max_bytes (approximate serialised size)
+ * the least recently used entries are evicted. Results are held as shared
+ * immutable values, so a hit hands out the cached value without copying it.
+ *
+ * Thread-safe.
+ */
+class StepResultCache {
+public:
+    struct Config {
+        bool enabled = false;
+        int ttl_seconds = 600;
+        size_t max_entries = 1024;
+        size_t max_bytes = 64 * 1024 * 1024;
+    };
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t insertions = 0;
+        uint64_t evictions = 0;     // Dropped to respect max_entries/max_bytes
+        uint64_t expirations = 0;   // Dropped because their TTL passed
+        size_t entries = 0;
+        size_t bytes = 0;
+    };
+
+    StepResultCache();
+    explicit StepResultCache(const Config& config);
+
+    /**
+     * @brief Cache key for a call; parameters are hashed in canonical form
+     */
+    static std::string make_key(const std::string& agent_name, const std::string& function_name,
+                                const std::string& llm_model, const json& parameters);
+
+    /**
+     * @brief Look up a live entry and mark it most recently used
+     * @return false if absent, expired (both count as misses) or the cache is disabled
+     */
+    bool lookup(const std::string& key, SharedJson& result);
+
+    void insert(const std::string& key, SharedJson result);
+
+    void clear();
+
+    void set_config(const Config& config);
+    Config get_config() const;
+    bool enabled() const;
+    Stats get_stats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        std::string key;
+        SharedJson result;
+        size_t bytes;
+        Clock::time_point expires_at;
+    };
+
+    mutable std::mutex mutex_;
+    Config config_;
+    std::list<Entry> lru_;  // Most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+    size_t bytes_ = 0;
+    Stats stats_;
+
+    void erase(std::list<Entry>::iterator it);
+    void enforce_bounds();
+};
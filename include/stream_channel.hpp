@@ -0,0 +1,125 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+#include "task_scheduler.hpp"
+
+/**
+ * @brief Bounded queue connecting two stages of a streaming pipeline
+ *
+ * push() blocks while capacity items are buffered, so a producer that is
+ * faster than its consumer is held to the consumer's pace (backpressure)
+ * instead of buffering without bound. close() ends the stream: consumers
+ * drain what is buffered and then see the end. cancel() drops the buffer
+ * and fails every later push, which tells an upstream producer to stop.
+ *
+ * Waits are marked with TaskScheduler::BlockingScope, so stages may run on
+ * scheduler workers. Thread-safe.
+ */
+template <typename T>
+class StreamChannel {
+public:
+    struct Stats {
+        uint64_t pushed = 0;
+        uint64_t producer_waits = 0;  // Pushes that had to wait for room
+        size_t max_depth = 0;         // Most items buffered at once
+    };
+
+    explicit StreamChannel(size_t capacity) : capacity_(std::max<size_t>(1, capacity)) {}
+
+    /**
+     * @brief Append an item, waiting while the channel is full
+     * @return false if the channel was closed or cancelled
+     */
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!closed_ && items_.size() >= capacity_) {
+            stats_.producer_waits++;
+            TaskScheduler::BlockingScope blocking;
+            not_full_.wait(lock, [this] { return closed_ || items_.size() < capacity_; });
+        }
+        if (closed_) {
+            return false;
+        }
+        items_.push_back(std::move(item));
+        stats_.pushed++;
+        stats_.max_depth = std::max(stats_.max_depth, items_.size());
+        not_empty_.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Move up to max_items buffered items into batch
+     *
+     * Waits for the first item only; whatever else is already buffered is
+     * taken along, so batches grow when the consumer falls behind.
+     *
+     * @return The number of items taken; 0 once the stream has ended
+     */
+    size_t pop_batch(std::vector<T>& batch, size_t max_items) {
+        batch.clear();
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (items_.empty() && !closed_) {
+            TaskScheduler::BlockingScope blocking;
+            not_empty_.wait(lock, [this] { return closed_ || !items_.empty(); });
+        }
+        while (!items_.empty() && batch.size() < std::max<size_t>(1, max_items)) {
+            batch.push_back(std::move(items_.front()));
+            items_.pop_front();
+        }
+        if (!batch.empty()) {
+            not_full_.notify_all();
+        }
+        return batch.size();
+    }
+
+    /**
+     * @brief End of stream; buffered items are still delivered
+     */
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        not_empty_.notify_all();
+        not_full_.notify_all();
+    }
+
+    /**
+     * @brief Abandon the stream, dropping anything buffered
+     */
+    void cancel() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        cancelled_ = true;
+        items_.clear();
+        not_empty_.notify_all();
+        not_full_.notify_all();
+    }
+
+    /**
+     * @brief Whether the stream was abandoned rather than ended by close()
+     */
+    bool is_cancelled() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return cancelled_;
+    }
+
+    Stats get_stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+private:
+    const size_t capacity_;
+    mutable std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::deque<T> items_;
+    bool closed_ = false;
+    bool cancelled_ = false;
+    Stats stats_;
+};
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Process-wide work-stealing task scheduler with priority lanes
+ *
+ * Every worker owns one deque per lane. Tasks submitted from a worker go to
+ * the back of that worker's own deque and are popped from there (LIFO, cache
+ * warm); tasks submitted from any other thread go to a shared injection
+ * queue. An idle worker looks for work lane by lane, INTERACTIVE first: its
+ * own deque, then the injection queue, then the front of other workers'
+ * deques (a steal). Interactive HTTP work therefore always runs ahead of
+ * queued batch workflow work, whichever worker it landed on.
+ *
+ * Workers are sized to the hardware. Code that blocks for a long time on a
+ * worker (network I/O, waiting for another task) should say so with a
+ * BlockingScope; while a worker is blocked the scheduler starts a spare
+ * thread (up to Config::max_blocking_threads) so the other queued tasks keep
+ * their CPUs. Idle spare threads exit after spare_idle_timeout_ms.
+ */
+class TaskScheduler {
+public:
+    enum class Priority {
+        INTERACTIVE = 0,  // Request/response work a client is waiting for
+        NORMAL = 1,
+        BATCH = 2         // Workflow executions and steps
+    };
+    static constexpr size_t PRIORITY_COUNT = 3;
+
+    using Task = std::function<void()>;
+
+    struct Config {
+        size_t worker_threads = 0;          // 0 = hardware concurrency
+        size_t max_blocking_threads = 64;   // Spare threads covering blocked workers
+        int spare_idle_timeout_ms = 2000;
+    };
+
+    struct Stats {
+        size_t workers = 0;                 // Core workers
+        size_t spare_workers = 0;           // Live spare threads
+        size_t blocked_workers = 0;         // Threads inside a BlockingScope
+        size_t idle_workers = 0;
+        uint64_t submitted = 0;
+        uint64_t steals = 0;
+        uint64_t spares_started = 0;
+        std::array<size_t, PRIORITY_COUNT> queued{};      // Per lane, all queues
+        std::array<uint64_t, PRIORITY_COUNT> executed{};  // Per lane
+        size_t injection_depth = 0;
+        std::vector<size_t> worker_depths;  // Own-deque depth per live worker
+    };
+
+    /**
+     * @brief Marks the calling worker as blocked for the scope's lifetime
+     *
+     * A no-op on threads that are not workers of a scheduler, so library code
+     * (HttpClient, waits on other tasks) can use it unconditionally. Nested
+     * scopes count once.
+     */
+    class BlockingScope {
+    public:
+        BlockingScope();
+        ~BlockingScope();
+
+        BlockingScope(const BlockingScope&) = delete;
+        BlockingScope& operator=(const BlockingScope&) = delete;
+
+    private:
+        TaskScheduler* scheduler_ = nullptr;
+    };
+
+    /**
+     * @brief Scheduler shared by the HTTP front end, workflows and async services
+     */
+    static TaskScheduler& shared();
+
+    TaskScheduler();
+    explicit TaskScheduler(const Config& config);
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    /**
+     * @brief Queue a task; exceptions escaping it are logged and swallowed
+     *
+     * After shutdown() the task runs inline on the calling thread.
+     */
+    void submit(Task task, Priority priority = Priority::NORMAL);
+
+    /**
+     * @brief Queue a callable and receive its result (or exception) through a future
+     */
+    template <typename Fn>
+    auto submit_future(Fn&& fn, Priority priority = Priority::NORMAL)
+        -> std::future<std::invoke_result_t<std::decay_t<Fn>>>;
+
+    /**
+     * @brief Run the queued tasks, then stop and join every worker
+     */
+    void shutdown();
+
+    /**
+     * @brief Whether the calling thread is one of this scheduler's workers
+     */
+    bool on_worker_thread() const;
+
+    Stats get_stats() const;
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::array<std::deque<Task>, PRIORITY_COUNT> lanes;
+        std::atomic<size_t> depth{0};
+        std::atomic<bool> alive{false};
+        std::thread thread;
+    };
+
+    Config config_;
+    size_t core_workers_ = 0;
+    std::vector<std::unique_ptr<Worker>> workers_;  // Core slots, then spare slots
+
+    mutable std::mutex injection_mutex_;
+    std::array<std::deque<Task>, PRIORITY_COUNT> injection_;
+    size_t injection_depth_ = 0;  // Guarded by injection_mutex_
+
+    // Idle workers sleep here; pending_ is the number of queued tasks
+    std::mutex sleep_mutex_;
+    std::condition_variable sleep_condition_;
+    std::atomic<size_t> pending_{0};
+    std::atomic<size_t> idle_{0};
+    std::atomic<bool> stopping_{false};
+
+    std::mutex spawn_mutex_;
+    std::atomic<size_t> live_spares_{0};
+    std::atomic<size_t> blocked_{0};
+
+    std::array<std::atomic<size_t>, PRIORITY_COUNT> queued_{};
+    std::array<std::atomic<uint64_t>, PRIORITY_COUNT> executed_{};
+    std::atomic<uint64_t> submitted_{0};
+    std::atomic<uint64_t> steals_{0};
+    std::atomic<uint64_t> spares_started_{0};
+
+    void worker_loop(size_t index);
+    bool take_task(size_t index, Task& task, size_t& lane);
+    void run_task(Task& task, size_t lane);
+    void wake_one();
+    void begin_blocking();
+    void end_blocking();
+    void start_spare();
+};
+
+/**
+ * @brief Bounded-concurrency queue of tasks running on a TaskScheduler
+ *
+ * Subsystems that used to own a fixed pool of N threads submit through a
+ * group with max_concurrency N instead: the group keeps its tasks in FIFO
+ * order and never has more than N of them on the scheduler at once, and
+ * wait() lets the owner drain them before it is destroyed. Each scheduler
+ * task runs one group task, so a long backlog in one group does not keep
+ * higher-priority lanes waiting.
+ */
+class TaskGroup {
+public:
+    /**
+     * @param max_concurrency Tasks of this group running at once; 0 = unbounded
+     */
+    TaskGroup(TaskScheduler& scheduler, TaskScheduler::Priority priority, size_t max_concurrency = 0);
+
+    /**
+     * @brief Waits for every queued and running task
+     */
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    void submit(TaskScheduler::Task task);
+
+    /**
+     * @brief Block until the group has no queued or running tasks
+     *
+     * Must not be called from a task of the same group.
+     */
+    void wait();
+
+    void set_max_concurrency(size_t max_concurrency);
+    size_t max_concurrency() const;
+    size_t queued() const;
+    size_t running() const;
+
+private:
+    TaskScheduler& scheduler_;
+    TaskScheduler::Priority priority_;
+    size_t max_concurrency_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable idle_condition_;
+    std::deque<TaskScheduler::Task> tasks_;
+    size_t running_ = 0;
+
+    void run_next();
+};
+
+// Template implementation
+template <typename Fn>
+auto TaskScheduler::submit_future(Fn&& fn, Priority priority)
+    -> std::future<std::invoke_result_t<std::decay_t<Fn>>> {
+    using Result = std::invoke_result_t<std::decay_t<Fn>>;
+    auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Fn>(fn));
+    auto future = task->get_future();
+    submit([task]() { (*task)(); }, priority);
+    return future;
+}
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace kolosal {
+
+/**
+ * @brief std::allocator replacement returning Alignment-aligned storage
+ */
+template <typename T, size_t Alignment>
+struct AlignedAllocator {
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() noexcept = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+    T* allocate(size_t count) {
+        if (count > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(Alignment)));
+    }
+
+    void deallocate(T* pointer, size_t) noexcept {
+        ::operator delete(pointer, std::align_val_t(Alignment));
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept { return false; }
+};
+
+/**
+ * @brief Dot-product kernels for the vector indexes, picked for the running CPU
+ */
+namespace vector_kernels {
+
+    constexpr size_t ALIGNMENT = 64;  // Bytes; one AVX-512 register, one cache line
+    constexpr size_t LANES = 16;      // Floats per padded block
+
+    using AlignedFloats = std::vector<float, AlignedAllocator<float, ALIGNMENT>>;
+
+    /**
+     * @brief a . b over n floats
+     *
+     * n must be a multiple of LANES and both pointers ALIGNMENT-aligned;
+     * vectors are zero-padded to that length, which leaves the result as is.
+     */
+    using DotProductFn = float (*)(const float* a, const float* b, size_t n);
+
+    /**
+     * @brief Fastest kernel the CPU supports (AVX-512, AVX2+FMA, NEON or scalar)
+     */
+    DotProductFn dot_product();
+
+    /**
+     * @brief weights . codes over n entries, widening each byte code to float
+     *
+     * Scores int8 scalar-quantized rows; same length and alignment rules as
+     * DotProductFn, with the codes zero-padded.
+     */
+    using CodeDotProductFn = float (*)(const float* weights, const uint8_t* codes, size_t n);
+
+    /**
+     * @brief Code kernel of the same instruction set as dot_product()
+     */
+    CodeDotProductFn code_dot_product();
+
+    /**
+     * @brief Name of the kernel dot_product() returns: "avx512", "avx2", "neon" or "scalar"
+     */
+    const char* active_kernel();
+
+    struct Kernel {
+        const char* name;
+        DotProductFn dot;
+        CodeDotProductFn code_dot;
+    };
+
+    /**
+     * @brief Every kernel the CPU can run, fastest first and "scalar" last
+     *
+     * dot_product() and code_dot_product() use the first; the rest let tests
+     * and benchmarks check each instruction set against the others.
+     */
+    std::vector<Kernel> supported_kernels();
+
+    /**
+     * @brief dimension rounded up to a multiple of LANES
+     */
+    inline size_t padded_dimension(size_t dimension) {
+        return (dimension + LANES - 1) / LANES * LANES;
+    }
+
+    /**
+     * @brief Copy vector into out (padded_dimension() floats) scaled to unit length
+     *
+     * A zero vector stays zero, so it scores 0 against everything, as with
+     * cosine_similarity().
+     */
+    void normalize_into(const float* vector, size_t dimension, float* out);
+
+}  // namespace vector_kernels
+
+/**
+ * @brief Cosine-similarity index of id-keyed vectors held by a vector store
+ */
+class IVectorIndex {
+public:
+    struct Hit {
+        std::string id;
+        float score;
+    };
+
+    virtual ~IVectorIndex() = default;
+
+    /**
+     * @brief Add a vector, replacing the vector already stored under id
+     * @return false if the vector's length differs from the index dimension
+     */
+    virtual bool add(const std::string& id, const std::vector<float>& vector) = 0;
+
+    /**
+     * @brief Add many vectors; indexes that can build in parallel use up to threads threads
+     * @return Per vector, whether it was added
+     */
+    virtual std::vector<bool> add_batch(const std::vector<std::string>& ids,
+                                        const std::vector<std::vector<float>>& vectors, size_t threads);
+
+    virtual bool remove(const std::string& id) = 0;
+    virtual bool contains(const std::string& id) const = 0;
+    virtual void clear() = 0;
+    virtual void reserve(size_t count) = 0;
+
+    /**
+     * @brief The k most similar vectors scoring at least threshold, best first
+     *
+     * A query whose length differs from the index dimension matches nothing.
+     */
+    virtual std::vector<Hit> search(const std::vector<float>& query, size_t k, float threshold) const = 0;
+
+    virtual size_t size() const = 0;
+    virtual size_t dimension() const = 0;
+
+    /**
+     * @brief Append the whole index state (ids, vectors and any graph or codebook) to out
+     */
+    virtual void serialize(std::string& out) const = 0;
+
+    /**
+     * @brief Replace the index state with one written by serialize() of the same index type
+     * @return false, leaving the index empty, if data is malformed or of another type
+     */
+    virtual bool deserialize(const char* data, size_t size) = 0;
+};
+
+/**
+ * @brief Exact cosine-similarity index over one contiguous block of vectors
+ *
+ * Vectors are normalised when added and stored row-major in a single
+ * aligned buffer, each row padded to a multiple of vector_kernels::LANES,
+ * next to a parallel array of ids. A query is normalised once and scored
+ * against every row with the dispatched dot-product kernel; the best k are
+ * kept in a bounded heap, and only they are returned with their ids.
+ *
+ * Not thread-safe; the vector stores guard it with their own locks.
+ */
+class FlatVectorIndex : public IVectorIndex {
+public:
+    /**
+     * @param dimension Vector length; 0 adopts the length of the first vector added
+     */
+    explicit FlatVectorIndex(size_t dimension = 0);
+
+    bool add(const std::string& id, const std::vector<float>& vector) override;
+    bool remove(const std::string& id) override;
+    bool contains(const std::string& id) const override { return rows_.count(id) > 0; }
+    void clear() override;
+    void reserve(size_t count) override;
+    std::vector<Hit> search(const std::vector<float>& query, size_t k, float threshold) const override;
+
+    size_t size() const override { return ids_.size(); }
+    size_t dimension() const override { return dimension_; }
+
+    void serialize(std::string& out) const override;
+    bool deserialize(const char* data, size_t size) override;
+
+private:
+    size_t dimension_;
+    size_t stride_;                            // Padded row length
+    vector_kernels::AlignedFloats data_;       // size() rows of stride_ floats
+    std::vector<std::string> ids_;             // Row -> id
+    std::unordered_map<std::string, size_t> rows_;  // id -> row
+    vector_kernels::DotProductFn dot_;
+
+    void set_dimension(size_t dimension);
+};
+
+}  // namespace kolosal
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <json.hpp>
+
+using json = nlohmann::json;
+
+/**
+ * @brief Immutable JSON value shared by reference
+ *
+ * Step outputs are stored once in this form; the execution's outputs map,
+ * its context view, the step result cache and API responses all point at
+ * the same value instead of holding copies.
+ */
+using SharedJson = std::shared_ptr<const json>;
+
+/**
+ * @brief Step ID -> output
+ */
+using StepOutputMap = std::map<std::string, SharedJson>;
+
+/**
+ * @brief Read-only view of an execution context and its step outputs
+ *
+ * Outputs are kept outside the context object and presented as its
+ * "<step id>_output" entries, which they take precedence over; every other
+ * top-level name is looked up in the context object. A plain json converts
+ * implicitly into a view without step outputs. A view may also layer an
+ * object of bindings (such as a map step's current item) over another view.
+ */
+class ContextView {
+public:
+    ContextView(const json& context, const StepOutputMap* step_outputs = nullptr)
+        : context_(context), step_outputs_(step_outputs), parent_(nullptr) {}
+
+    /**
+     * @brief bindings' entries, falling back to parent for every other name
+     */
+    ContextView(const json& bindings, const ContextView& parent)
+        : context_(bindings), step_outputs_(nullptr), parent_(&parent) {}
+
+    /**
+     * @return The top-level entry called name, or nullptr if absent
+     */
+    const json* find(const std::string& name) const;
+
+    /**
+     * @brief Copy of the context with the step outputs merged in
+     */
+    json to_json() const;
+
+private:
+    const json& context_;
+    const StepOutputMap* step_outputs_;
+    const ContextView* parent_;
+};
+
+/**
+ * @brief Pre-split reference to a value in an execution context
+ *
+ * "step1_output.result.text" walks objects by key and arrays by numeric
+ * index. A top-level key that itself contains dots is matched first, so
+ * references that resolved before dotted paths existed keep resolving.
+ */
+class ContextPath {
+public:
+    explicit ContextPath(const std::string& path);
+
+    /**
+     * @return The referenced value inside context, or nullptr if absent
+     */
+    const json* find(const ContextView& context) const;
+
+    const std::string& str() const { return path_; }
+
+private:
+    struct Part {
+        std::string key;
+        long index;  // -1 if the part is not an array index
+    };
+
+    std::string path_;
+    std::vector<Part> parts_;
+};
+
+/**
+ * @brief Step parameters (object format) compiled for repeated resolution
+ *
+ * Every string is split once into literal text and {{path}} references, and
+ * subtrees without references are kept as ready-made values. resolve() then
+ * only looks the references up: strings substitute string values verbatim
+ * and other values as JSON text, and a reference that does not resolve is
+ * left in place as written.
+ */
+class ParameterTemplate {
+public:
+    explicit ParameterTemplate(const json& parameters);
+
+    json resolve(const ContextView& context) const;
+
+    bool has_references() const { return root_.kind != Node::Kind::LITERAL; }
+
+private:
+    struct Segment {
+        std::string text;   // Literal text, or the reference as written if unresolved
+        int reference;      // Index into references_, or -1 for literal text
+    };
+
+    struct Node {
+        enum class Kind { LITERAL, STRING, OBJECT, ARRAY };
+        Kind kind = Kind::LITERAL;
+        json literal;
+        std::vector<Segment> segments;
+        std::vector<std::pair<std::string, Node>> members;
+        std::vector<Node> items;
+    };
+
+    std::vector<ContextPath> references_;
+    Node root_;
+
+    Node compile(const json& value);
+    void compile_string(const std::string& text, Node& node);
+    json evaluate(const Node& node, const ContextView& context) const;
+};
+
+/**
+ * @brief Step or loop condition compiled into an evaluation tree
+ *
+ * Accepts {"field", "operator", "value"} comparisons (equals, not_equals,
+ * exists, contains, greater_than, less_than, greater_equal, less_equal)
+ * combined with {"and": [...]}, {"or": [...]} and {"not": {...}}. A missing
+ * field is false; an empty condition, an unknown operator or mismatched
+ * operand types are true, as before compilation. {"not": {...}} is new: the
+ * uncompiled evaluator did not know it and treated it as true.
+ */
+class ConditionExpression {
+public:
+    explicit ConditionExpression(const json& condition);
+
+    bool evaluate(const ContextView& context) const;
+
+private:
+    enum class Op {
+        ALWAYS, ALL, ANY, NOT,
+        EQUALS, NOT_EQUALS, EXISTS, CONTAINS,
+        GREATER_THAN, LESS_THAN, GREATER_EQUAL, LESS_EQUAL,
+        UNKNOWN
+    };
+
+    struct Node {
+        Op op = Op::ALWAYS;
+        ContextPath field{""};
+        json expected;
+        std::vector<Node> children;
+    };
+
+    Node root_;
+
+    static Node compile(const json& condition);
+    static Op parse_operator(const std::string& name);
+    static bool evaluate(const Node& node, const ContextView& context);
+};
@@ -13,6 +13,7 @@
 #include <chrono>
 #include <json.hpp>
 #include "agent_manager.hpp"
+#include "task_scheduler.hpp"
 
 using json = nlohmann::json;
 
@@ -30,6 +31,11 @@ enum class WorkflowState {
 
 /**
  * @brief Workflow request structure
+ *
+ * WorkflowManager signals the request once it reaches a terminal state
+ * (COMPLETED, FAILED, TIMEOUT or CANCELLED), so callers can block on
+ * wait_for_completion() or attach a continuation instead of polling
+ * get_request_status().
  */
 struct WorkflowRequest {
     std::string id;
@@ -42,6 +48,13 @@ struct WorkflowRequest {
     std::string error;
     int timeout_ms;
     
+    // Cancelled by cancel_request(); carries the execution deadline into the agent call
+    std::shared_ptr<CancellationToken> cancel_token = std::make_shared<CancellationToken>();
+    
+    // If set and the function supports streaming, receives generated text as
+    // it arrives; returning false stops generation
+    KolosalClient::TokenCallback on_delta;
+    
     WorkflowRequest(const std::string& req_id, 
                    const std::string& agent, 
                    const std::string& function,
@@ -50,6 +63,44 @@ struct WorkflowRequest {
         : id(req_id), agent_name(agent), function_name(function), 
           parameters(params), timestamp(std::chrono::system_clock::now()),
           state(WorkflowState::PENDING), timeout_ms(timeout) {}
+    
+    /**
+     * @brief Continuation run once the request has finished
+     */
+    using CompletionCallback = std::function<void(const WorkflowRequest&)>;
+    
+    /**
+     * @brief Whether the request has reached a terminal state
+     */
+    bool is_finished() const;
+    
+    /**
+     * @brief Block until the request finishes
+     * @return false if the timeout elapsed first
+     */
+    bool wait_for_completion(std::chrono::milliseconds timeout) const;
+    
+    /**
+     * @brief Run callback when the request finishes
+     *
+     * Runs immediately on the calling thread if the request has already
+     * finished, otherwise on the thread that finishes it. The callback must
+     * not block.
+     */
+    void on_completion(CompletionCallback callback);
+    
+    /**
+     * @brief Wake waiters and run continuations; later calls are no-ops
+     *
+     * Called by WorkflowManager after the terminal state has been stored.
+     */
+    void notify_completion();
+    
+private:
+    mutable std::mutex completion_mutex_;
+    mutable std::condition_variable completion_condition_;
+    bool finished_ = false;
+    std::vector<CompletionCallback> completion_callbacks_;
 };
 
 /**
@@ -101,11 +152,9 @@ private:
     std::map<std::string, std::shared_ptr<WorkflowRequest>> active_requests_;
     std::map<std::string, std::shared_ptr<WorkflowRequest>> completed_requests_;
     
-    // Threading and synchronization
-    std::vector<std::thread> worker_threads_;
+    // Synchronization
     std::mutex queue_mutex_;
     std::mutex requests_mutex_;
-    std::condition_variable queue_condition_;
     std::atomic<bool> running_{false};
     
     // Configuration
@@ -119,6 +168,10 @@ private:
     // Function configuration from agent.yaml
     std::map<std::string, json> function_configs_;
     
+    // Requests run on the shared scheduler, at most max_workers_ at a time.
+    // Declared last so it drains before the state its tasks use is destroyed.
+    TaskGroup request_tasks_;
+    
 public:
     explicit WorkflowManager(std::shared_ptr<AgentManager> agent_manager, 
                             size_t max_workers = 4, 
@@ -143,7 +196,8 @@ public:
     std::string submit_request_with_timeout(const std::string& agent_name,
                                            const std::string& function_name,
                                            const json& parameters,
-                                           int timeout_ms);
+                                           int timeout_ms,
+                                           KolosalClient::TokenCallback on_delta = nullptr);
     
     // Request status and results
     std::shared_ptr<WorkflowRequest> get_request_status(const std::string& request_id);
@@ -165,8 +219,8 @@ public:
                          const json& parameters);
 
 private:
-    // Worker thread functions
-    void worker_thread();
+    // Runs the oldest queued request; one scheduler task per submitted request
+    void process_next_request();
     void process_request(std::shared_ptr<WorkflowRequest> request);
     
     // Helper functions
@@ -177,6 +231,7 @@ private:
     
     // Request execution
     void execute_request_with_timeout(std::shared_ptr<WorkflowRequest> request);
+    static json run_agent_function(AgentManager& agent_manager, const WorkflowRequest& request);
 };
 
 /**
@@ -4,13 +4,22 @@
 #include <memory>
 #include <vector>
 #include <map>
+#include <set>
 #include <chrono>
 #include <atomic>
 #include <mutex>
 #include <condition_variable>
 #include <thread>
+#include <functional>
+#include <optional>
 #include <json.hpp>
 #include <yaml-cpp/yaml.h>
+#include "task_scheduler.hpp"
+#include "execution_queue.hpp"
+#include "execution_journal.hpp"
+#include "step_result_cache.hpp"
+#include "step_latency_tracker.hpp"
+#include "workflow_expressions.hpp"
 
 // Forward declaration to avoid circular dependency
 class WorkflowManager;
@@ -72,11 +81,37 @@ struct WorkflowStep {
     std::vector<std::string> dependencies; // Dependencies on other steps
     int timeout_ms;
     bool optional;          // Whether step failure should stop workflow
+    bool cacheable;         // Results may be served from the step result cache
     RetryPolicy retry_policy; // Retry configuration for this step
     json context_injection;   // Additional context for this step
     
+    // Map steps call the function once per element (or batch of elements)
+    // of an array in the context and gather the results in input order
+    struct MapConfiguration {
+        std::string items;              // Context path of the array, e.g. "search_output.results"
+        std::string item_key = "item";  // Binds the element as {{item}}, its position as {{item_index}}
+        int parallelism = 4;            // Calls in flight at once
+        int batch_size = 1;             // Elements per call; above 1 {{item}} is an array
+    };
+    std::optional<MapConfiguration> map;
+    
+    // Hedged steps launch a duplicate request when the original outlasts a
+    // latency percentile of the step's recent calls; the first to succeed wins
+    struct HedgeConfiguration {
+        double percentile = 95.0;      // Hedge after this percentile of recent latencies
+        int min_samples = 20;          // Calls recorded before the percentile is used
+        int min_delay_ms = 0;          // Floor of the delay, and the delay until then; 0 = no hedging without history
+        std::string alternate_model;   // Model of the duplicate; "auto" = another model the agent supports
+    };
+    std::optional<HedgeConfiguration> hedge;
+    
+    // Compiled forms of parameters (object format) and conditions, built
+    // when the workflow is registered; null means interpret the JSON
+    std::shared_ptr<const ParameterTemplate> compiled_parameters;
+    std::shared_ptr<const ConditionExpression> compiled_conditions;
+    
     // Default constructor
-    WorkflowStep() : timeout_ms(30000), optional(false) {}
+    WorkflowStep() : timeout_ms(30000), optional(false), cacheable(false) {}
     
     WorkflowStep(const std::string& step_id, 
                 const std::string& agent, 
@@ -84,7 +119,7 @@ struct WorkflowStep {
                 const json& params = json::array(),  // Default to empty array for new format
                 const std::string& model = "")
         : id(step_id), agent_name(agent), llm_model(model), function_name(function), 
-          parameters(params), timeout_ms(30000), optional(false) {}
+          parameters(params), timeout_ms(30000), optional(false), cacheable(false) {}
 };
 
 /**
@@ -104,6 +139,7 @@ struct WorkflowDefinition {
     RetryPolicy default_retry_policy; // Default retry policy for all steps
     std::optional<RetryPolicy> retry_policy; // Optional retry policy override
     bool fail_fast;         // Stop on first error
+    int max_parallel_steps; // PARALLEL: steps of this workflow running at once
     
     // Loop-specific configuration
     struct LoopConfiguration {
@@ -120,25 +156,38 @@ struct WorkflowDefinition {
         bool pass_through_on_error;
         bool merge_outputs;
         std::string output_format; // "last_step", "all_steps", "merged"
+        bool streaming;            // Stages overlap, exchanging chunks through bounded channels
+        size_t channel_capacity;   // Streaming: chunks buffered between two stages
+        size_t batch_size;         // Streaming: most chunks handed to one call of a stage
+        size_t chunk_chars;        // Streaming: generated text is forwarded in chunks of about this size
     } pipeline_config;
     
     // Default constructor
     WorkflowDefinition() 
         : type(WorkflowType::SEQUENTIAL), max_execution_time_ms(300000), 
-          allow_partial_failure(false), fail_fast(true) {
+          allow_partial_failure(false), fail_fast(true), max_parallel_steps(4) {
         pipeline_config.pass_through_on_error = false;
         pipeline_config.merge_outputs = false;
         pipeline_config.output_format = "last_step";
+        pipeline_config.streaming = false;
+        pipeline_config.channel_capacity = 16;
+        pipeline_config.batch_size = 8;
+        pipeline_config.chunk_chars = 256;
     }
     
     WorkflowDefinition(const std::string& workflow_id, 
                       const std::string& workflow_name,
                       WorkflowType workflow_type = WorkflowType::SEQUENTIAL)
         : id(workflow_id), name(workflow_name), type(workflow_type),
-          max_execution_time_ms(300000), allow_partial_failure(false), fail_fast(true) {
+          max_execution_time_ms(300000), allow_partial_failure(false), fail_fast(true),
+          max_parallel_steps(4) {
         pipeline_config.pass_through_on_error = false;
         pipeline_config.merge_outputs = false;
         pipeline_config.output_format = "last_step";
+        pipeline_config.streaming = false;
+        pipeline_config.channel_capacity = 16;
+        pipeline_config.batch_size = 8;
+        pipeline_config.chunk_chars = 256;
     }
 };
 
@@ -161,26 +210,49 @@ enum class WorkflowExecutionState {
 struct WorkflowExecution {
     std::string execution_id;
     std::string workflow_id;
-    WorkflowExecutionState state;
+    std::atomic<WorkflowExecutionState> state;  // Polled by status readers without the mutex
     std::chrono::system_clock::time_point start_time;
     std::chrono::system_clock::time_point end_time;
     json input_data;
     json output_data;
-    json context;           // Runtime context
+    json context;           // Runtime context; step outputs are reached through context_view()
     std::map<std::string, std::string> step_results; // Step ID -> Request ID mapping
-    std::map<std::string, json> step_outputs;        // Step ID -> Output data
+    StepOutputMap step_outputs;                      // Step ID -> Output data, shared and immutable
+    SharedJson pipeline_input;  // Output of the previous PIPELINE step, passed to the next one
+    SharedJson context_pipeline_input;  // Input of the last array-format PIPELINE step, reported in the context
     std::map<std::string, StepExecutionStats> step_stats; // Step ID -> Execution statistics
     std::string error_message;
     double progress_percentage;
     std::string current_step_id; // Currently executing step
     int failed_step_count;      // Number of failed steps
     std::vector<std::string> execution_log; // Execution log messages
+    std::string tenant_id;      // Fair-share group in the ready queue
+    int priority;               // Higher runs first when the queue orders by priority
+    std::set<std::string> recovered_steps; // Completed before a restart; outputs come from the journal
+    int recovered_loop_iteration;          // LOOP iteration that was running before a restart
+    
+    // Guards step_results, step_outputs, context_pipeline_input, step_stats,
+    // current_step_id, failed_step_count, execution_log and error_message,
+    // which the steps of a PARALLEL workflow update concurrently. Never held
+    // across an agent call.
+    mutable std::mutex mutex;
     
     WorkflowExecution(const std::string& exec_id, const std::string& wf_id)
         : execution_id(exec_id), workflow_id(wf_id), 
           state(WorkflowExecutionState::PENDING),
           start_time(std::chrono::system_clock::now()),
-          progress_percentage(0.0), failed_step_count(0) {}
+          progress_percentage(0.0), failed_step_count(0), priority(0), recovered_loop_iteration(0) {}
+    
+    /**
+     * @brief The context as templates and conditions see it, outputs included
+     */
+    ContextView context_view() const { return ContextView(context, &step_outputs); }
+    
+    /**
+     * @brief Serialised context and step outputs, as reported by the API
+     */
+    json context_json() const;
+    json step_outputs_json() const;
 };
 
 /**
@@ -201,8 +273,12 @@ private:
     std::map<std::string, std::map<std::string, std::vector<std::string>>> agent_llm_mappings_;
     
     mutable std::mutex orchestrator_mutex_;
-    std::condition_variable execution_condition_;
-    std::vector<std::thread> orchestrator_threads_;
+    std::condition_variable completion_condition_;  // An execution finished or was cancelled
+    std::multimap<std::string, std::string> in_flight_requests_;  // Execution ID -> step request ID
+    ExecutionQueue ready_executions_;  // PENDING executions in dispatch order
+    std::unique_ptr<ExecutionJournal> journal_;  // Null unless journaling is enabled
+    StepResultCache step_cache_;  // Results of cacheable steps; disabled by default
+    StepLatencyTracker step_latencies_;  // Latencies and race outcomes of hedged steps
     std::atomic<bool> running_{false};
     
 public:
@@ -220,14 +296,26 @@ public:
     json get_workflow_config() const;
     
     // Workflow definition management
+    /**
+     * @brief Register or replace a workflow definition
+     * @throws std::invalid_argument if a step depends on an unknown step or
+     *         the step dependencies form a cycle
+     */
     void register_workflow(const WorkflowDefinition& workflow);
     bool remove_workflow(const std::string& workflow_id);
     std::vector<WorkflowDefinition> list_workflows() const;
     WorkflowDefinition* get_workflow(const std::string& workflow_id);
     
     // Workflow execution
-    std::string execute_workflow(const std::string& workflow_id, const json& input_data = json{});
-    std::string execute_workflow_async(const std::string& workflow_id, const json& input_data = json{});
+    /**
+     * @brief Queue an execution and wait for it to finish
+     * @param tenant_id Executions of different tenants are dispatched round-robin
+     * @param priority Dispatch priority when the ready queue orders by priority
+     */
+    std::string execute_workflow(const std::string& workflow_id, const json& input_data = json{},
+                                 const std::string& tenant_id = "", int priority = 0);
+    std::string execute_workflow_async(const std::string& workflow_id, const json& input_data = json{},
+                                       const std::string& tenant_id = "", int priority = 0);
     
     // Execution control
     bool pause_execution(const std::string& execution_id);
@@ -239,6 +327,76 @@ public:
     json get_execution_progress(const std::string& execution_id);
     std::vector<std::shared_ptr<WorkflowExecution>> list_active_executions();
     
+    /**
+     * @brief Ready queue configuration and depth (queued, tenants, dispatched, ...)
+     */
+    json get_execution_queue_stats() const;
+    void set_execution_queue_config(const ExecutionQueue::Config& config);
+    
+    /**
+     * @brief Journal executions and step completions to disk
+     *
+     * Must be called before start(), which replays the journal and requeues
+     * unfinished executions; their completed steps are not run again. A LOOP
+     * execution resumes in the iteration it was in.
+     */
+    void enable_execution_journal(const ExecutionJournal::Config& config);
+    
+    /**
+     * @brief Configure the cache consulted by steps marked cacheable
+     */
+    void set_step_cache_config(const StepResultCache::Config& config);
+    json get_step_cache_stats() const;
+    void clear_step_cache();
+    
+    /**
+     * @brief Hedges launched, race outcomes and recent latency percentiles of hedged steps
+     */
+    json get_hedging_stats() const;
+    
+    /**
+     * @brief Callback for execution events
+     *
+     * event_type is one of execution_started, execution_paused,
+     * execution_resumed, execution_cancelled, step_started, step_retry,
+     * step_hedged, step_completed, step_failed, progress and execution_finished (always
+     * the last event of an execution). data carries execution_id,
+     * workflow_id, state, progress_percentage and timestamp_ms plus
+     * event-specific fields. Callbacks run on orchestrator threads and must
+     * not block.
+     */
+    using ExecutionEventCallback = std::function<void(const std::string& execution_id,
+                                                      const std::string& event_type,
+                                                      const json& data)>;
+    
+    /**
+     * @brief Subscribe to events of one execution (or of all, if execution_id is empty)
+     * @return Subscription id for unsubscribe_execution_events()
+     */
+    size_t subscribe_execution_events(const std::string& execution_id, ExecutionEventCallback callback);
+    
+    /**
+     * @brief Remove a subscription; an event already being delivered may still arrive
+     */
+    void unsubscribe_execution_events(size_t subscription_id);
+    
+    /**
+     * @brief Read a "pipeline_config" object into workflow; absent fields keep their values
+     */
+    static void parse_pipeline_config(const json& config, WorkflowDefinition& workflow);
+    
+    /**
+     * @brief Read a step's "map" object; a missing or empty "items" makes it an ordinary step
+     */
+    static std::optional<WorkflowStep::MapConfiguration> parse_map_config(const json& config);
+    static json map_config_to_json(const WorkflowStep::MapConfiguration& map);
+    
+    /**
+     * @brief Read a step's "hedge" object; anything but an object leaves the step unhedged
+     */
+    static std::optional<WorkflowStep::HedgeConfiguration> parse_hedge_config(const json& config);
+    static json hedge_config_to_json(const WorkflowStep::HedgeConfiguration& hedge);
+    
     // Built-in workflow templates
     void register_builtin_workflows();
     
@@ -249,17 +407,29 @@ private:
     void execute_conditional_workflow(std::shared_ptr<WorkflowExecution> execution);
     void execute_loop_workflow(std::shared_ptr<WorkflowExecution> execution);
     void execute_pipeline_workflow(std::shared_ptr<WorkflowExecution> execution);
+    void execute_streaming_pipeline_workflow(std::shared_ptr<WorkflowExecution> execution);
     
     // Helper functions
     std::string generate_execution_id();
     void update_execution_progress(std::shared_ptr<WorkflowExecution> execution);
+    void emit_execution_event(const WorkflowExecution& execution, const std::string& event_type,
+                              json data = json::object());
     void move_to_completed(std::shared_ptr<WorkflowExecution> execution);
-    json resolve_parameters(const json& parameters, const json& context);
+    void cancel_step_requests(const std::string& execution_id);  // Cancels the execution's in-flight step requests
+    void recover_journaled_executions();
+    bool restore_recovered_step(const WorkflowStep& step, std::shared_ptr<WorkflowExecution> execution);
+    json resolve_parameters(const json& parameters, const ContextView& context);
     
     // Configuration helpers
     void load_agent_llm_mappings(const json& config);
     bool validate_agent_llm_pairing(const std::string& agent_name, const std::string& llm_model);
     bool validate_workflow_definition(const WorkflowDefinition& workflow);
+    
+    /**
+     * @brief Step indices in dependency order (Kahn's algorithm, stable by declaration order)
+     * @throws std::invalid_argument on duplicate step ids, unknown dependencies or cycles
+     */
+    static std::vector<size_t> topological_step_order(const WorkflowDefinition& workflow);
     WorkflowDefinition parse_workflow_from_config(const json& workflow_config);
     WorkflowDefinition parse_workflow_from_yaml(const YAML::Node& workflow_config);
     
@@ -270,22 +440,68 @@ private:
     std::vector<std::string> list_workflow_definitions();
     void ensure_workflows_directory();
     
-    // Step execution with retry support
+    // Step execution with retry support; default_retry_policy applies to a
+    // step without retries of its own
     bool execute_step_with_retry(const WorkflowStep& step, 
-                                std::shared_ptr<WorkflowExecution> execution);
+                                std::shared_ptr<WorkflowExecution> execution,
+                                const RetryPolicy& default_retry_policy);
     bool execute_step(const WorkflowStep& step, 
                      std::shared_ptr<WorkflowExecution> execution);
-    void wait_for_step_completion(const std::string& request_id,
-                                 std::shared_ptr<WorkflowExecution> execution,
-                                 const WorkflowStep& step);
+    /**
+     * @brief Parameters of one call of step, resolved against the execution
+     * @param pipeline_input Previous PIPELINE stage's output, or nullptr
+     * @param bindings Object of names that take precedence over the context
+     */
+    json build_step_parameters(const WorkflowStep& step, const WorkflowExecution& execution,
+                               const SharedJson& pipeline_input, const json& bindings = json::object());
+    bool execute_map_step(const WorkflowStep& step, std::shared_ptr<WorkflowExecution> execution);
+    /**
+     * @return The step output, or nullptr if the execution was cancelled meanwhile
+     */
+    SharedJson wait_for_step_completion(const std::string& request_id,
+                                        std::shared_ptr<WorkflowExecution> execution,
+                                        const WorkflowStep& step);
+    /**
+     * @brief wait_for_step_completion() for a hedged step
+     *
+     * Launches a duplicate of the request once it outlasts the step's hedge
+     * delay, returns the output of whichever succeeds first and cancels the
+     * other.
+     */
+    SharedJson wait_for_hedged_step_completion(const std::string& request_id, const json& parameters,
+                                               std::shared_ptr<WorkflowExecution> execution,
+                                               const WorkflowStep& step);
+    /**
+     * @brief Model for a step's duplicate request; empty keeps the original's
+     */
+    std::string select_hedge_model(const WorkflowStep& step, const json& parameters) const;
+    void record_step_output(const WorkflowStep& step, std::shared_ptr<WorkflowExecution> execution,
+                            SharedJson output);
     
     // Enhanced condition evaluation
-    bool evaluate_condition(const json& condition, const json& context);
-    bool evaluate_complex_condition(const json& condition, const json& context);
+    bool evaluate_condition(const json& condition, const ContextView& context);
+    
+    /**
+     * @brief Compile step parameter templates and conditions for execution
+     */
+    static void compile_step_expressions(WorkflowDefinition& workflow);
     
-    // Orchestrator thread functions
-    void orchestrator_thread();
+    // Runs the next execution of the ready queue; one scheduler task per queued execution
+    void run_next_execution();
     void process_execution(std::shared_ptr<WorkflowExecution> execution);
+    
+    // Execution event subscribers
+    struct EventSubscription {
+        std::string execution_id;  // Empty = all executions
+        ExecutionEventCallback callback;
+    };
+    std::map<size_t, EventSubscription> event_subscriptions_;
+    size_t next_subscription_id_ = 1;
+    mutable std::mutex event_mutex_;
+    
+    // Executions run on the shared scheduler, two at a time as with the
+    // former orchestrator threads. Declared last so it drains first.
+    TaskGroup execution_tasks_;
 };
 
 /**
@@ -303,6 +519,7 @@ public:
     WorkflowBuilder& set_description(const std::string& description);
     WorkflowBuilder& set_max_execution_time(int timeout_ms);
     WorkflowBuilder& allow_partial_failure(bool allow = true);
+    WorkflowBuilder& set_max_parallel_steps(int max_steps);
     WorkflowBuilder& set_global_context(const json& context);
     
     // Step building
@@ -321,6 +538,11 @@ public:
                                         const std::string& depends_on);
     WorkflowBuilder& set_step_timeout(const std::string& step_id, int timeout_ms);
     WorkflowBuilder& set_step_optional(const std::string& step_id, bool optional = true);
+    WorkflowBuilder& set_step_cacheable(const std::string& step_id, bool cacheable = true);
+    WorkflowBuilder& set_step_hedge(const std::string& step_id, double percentile = 95.0,
+                                    const std::string& alternate_model = "");
+    WorkflowBuilder& set_step_map(const std::string& step_id, const std::string& items,
+                                  int parallelism = 4, int batch_size = 1);
     
     // Build the workflow
     WorkflowDefinition build();
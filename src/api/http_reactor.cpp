@@ -0,0 +1,488 @@
+#include "../../include/http_reactor.hpp"
+#include "../../include/logger.hpp"
+
+#ifdef __linux__
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+
+namespace {
+
+constexpr int MAX_EVENTS = 128;
+constexpr size_t READ_CHUNK_SIZE = 16384;
+
+const char CONTINUE_RESPONSE[] = "HTTP/1.1 100 Continue\r\n\r\n";
+
+// Minimal JSON error in the same shape as HTTPServer::send_error, for
+// failures detected before a request reaches the handler.
+std::string error_response(int status_code, const std::string& message) {
+    const std::string body = "{\"error\":\"" + message + "\",\"status_code\":" + std::to_string(status_code) + "}";
+    return "HTTP/1.1 " + std::to_string(status_code) + " Error\r\n"
+           "Content-Type: application/json\r\n"
+           "Content-Length: " + std::to_string(body.size()) + "\r\n"
+           "Connection: close\r\n"
+           "\r\n" + body;
+}
+
+const std::string& service_unavailable_response() {
+    static const std::string response = error_response(503, "Too many connections");
+    return response;
+}
+
+void send_interim(int fd, const char* data, size_t length) {
+    ssize_t sent = send(fd, data, length, MSG_NOSIGNAL);
+    (void)sent;
+}
+
+// Stream handed off by the handler running on this thread (detach_stream)
+thread_local std::function<void()> t_detached_stream;
+
+}  // namespace
+
+HttpReactor::HttpReactor(int listen_fd, const Config& config, RequestHandler handler)
+    : listen_fd_(listen_fd), config_(config), handler_(std::move(handler)),
+      handler_tasks_(TaskScheduler::shared(), TaskScheduler::Priority::INTERACTIVE) {
+    if (config_.io_threads < 1) {
+        config_.io_threads = 1;
+    }
+    if (config_.worker_threads < 1) {
+        config_.worker_threads = std::max(2u, std::thread::hardware_concurrency());
+    }
+    if (config_.max_connections == 0) {
+        config_.max_connections = 1;
+    }
+    handler_tasks_.set_max_concurrency(static_cast<size_t>(config_.worker_threads));
+}
+
+HttpReactor::~HttpReactor() {
+    stop();
+}
+
+bool HttpReactor::start() {
+    if (running_.load()) {
+        return true;
+    }
+
+    int flags = fcntl(listen_fd_, F_GETFL, 0);
+    if (flags < 0 || fcntl(listen_fd_, F_SETFL, flags | O_NONBLOCK) < 0) {
+        LOG_ERROR_F("Failed to make listening socket non-blocking: %s", std::strerror(errno));
+        return false;
+    }
+
+    for (int i = 0; i < config_.io_threads; ++i) {
+        auto loop = std::make_unique<IoLoop>();
+        loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        loop->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (loop->epoll_fd < 0 || loop->wake_fd < 0) {
+            LOG_ERROR_F("Failed to create epoll instance: %s", std::strerror(errno));
+            if (loop->epoll_fd >= 0) close(loop->epoll_fd);
+            if (loop->wake_fd >= 0) close(loop->wake_fd);
+            for (auto& created : io_loops_) {
+                close(created->epoll_fd);
+                close(created->wake_fd);
+            }
+            io_loops_.clear();
+            return false;
+        }
+
+        epoll_event wake_event{};
+        wake_event.events = EPOLLIN;
+        wake_event.data.fd = loop->wake_fd;
+        epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, loop->wake_fd, &wake_event);
+
+        // Every loop watches the listening socket; EPOLLEXCLUSIVE avoids
+        // waking all I/O threads for each incoming connection.
+        epoll_event listen_event{};
+        listen_event.events = EPOLLIN | EPOLLEXCLUSIVE;
+        listen_event.data.fd = listen_fd_;
+        if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, listen_fd_, &listen_event) < 0) {
+            listen_event.events = EPOLLIN;
+            epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, listen_fd_, &listen_event);
+        }
+
+        io_loops_.push_back(std::move(loop));
+    }
+
+    running_.store(true);
+
+    for (auto& loop : io_loops_) {
+        loop->thread = std::thread(&HttpReactor::io_loop, this, loop.get());
+    }
+
+    LOG_INFO_F("HTTP reactor started with %d I/O threads, %d concurrent handlers, max %zu connections",
+               config_.io_threads, config_.worker_threads, config_.max_connections);
+    return true;
+}
+
+void HttpReactor::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+
+    for (auto& loop : io_loops_) {
+        uint64_t one = 1;
+        ssize_t written = write(loop->wake_fd, &one, sizeof(one));
+        (void)written;
+    }
+    for (auto& loop : io_loops_) {
+        if (loop->thread.joinable()) {
+            loop->thread.join();
+        }
+    }
+
+    // Handlers still queued see running_ == false and close their connection
+    handler_tasks_.wait();
+    {
+        std::unique_lock<std::mutex> lock(streams_mutex_);
+        streams_idle_.wait(lock, [this] { return active_streams_ == 0; });
+    }
+
+    for (auto& loop : io_loops_) {
+        for (auto& [fd, connection] : loop->connections) {
+            close(fd);
+            active_connections_.fetch_sub(1);
+        }
+        loop->connections.clear();
+        for (auto& connection : loop->returned) {
+            close(connection->fd);
+            active_connections_.fetch_sub(1);
+        }
+        loop->returned.clear();
+        close(loop->epoll_fd);
+        close(loop->wake_fd);
+    }
+    io_loops_.clear();
+}
+
+void HttpReactor::io_loop(IoLoop* loop) {
+    epoll_event events[MAX_EVENTS];
+    const int wait_ms = config_.idle_timeout_ms > 0 ? std::min(config_.idle_timeout_ms, 1000) : -1;
+    auto last_sweep = std::chrono::steady_clock::now();
+
+    while (running_.load()) {
+        int ready = epoll_wait(loop->epoll_fd, events, MAX_EVENTS, wait_ms);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR_F("epoll_wait failed: %s", std::strerror(errno));
+            break;
+        }
+
+        for (int i = 0; i < ready; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == loop->wake_fd) {
+                uint64_t value;
+                ssize_t drained = read(loop->wake_fd, &value, sizeof(value));
+                (void)drained;
+                adopt_returned(loop);
+            } else if (fd == listen_fd_) {
+                accept_connections(loop);
+            } else if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                close_connection(loop, fd);
+            } else {
+                read_connection(loop, fd);
+            }
+        }
+
+        if (config_.idle_timeout_ms > 0) {
+            auto now = std::chrono::steady_clock::now();
+            if (now - last_sweep >= std::chrono::milliseconds(wait_ms)) {
+                close_idle_connections(loop);
+                last_sweep = now;
+            }
+        }
+    }
+}
+
+void HttpReactor::accept_connections(IoLoop* loop) {
+    while (running_.load()) {
+        sockaddr_in client_addr{};
+        socklen_t client_len = sizeof(client_addr);
+        int fd = accept4(listen_fd_, reinterpret_cast<sockaddr*>(&client_addr), &client_len,
+                         SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                LOG_WARN_F("Failed to accept client connection: %s", std::strerror(errno));
+            }
+            return;
+        }
+
+        if (active_connections_.load() >= config_.max_connections) {
+            const std::string& response = service_unavailable_response();
+            ssize_t sent = send(fd, response.data(), response.size(), MSG_NOSIGNAL);
+            (void)sent;
+            close(fd);
+            rejected_connections_.fetch_add(1);
+            continue;
+        }
+
+        // Responses are written with several small sends; without
+        // TCP_NODELAY pipelined replies stall on Nagle + delayed ACK.
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.fd = fd;
+        if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+            close(fd);
+            continue;
+        }
+
+        auto connection = std::make_shared<Connection>(config_.max_request_size);
+        connection->fd = fd;
+        connection->owner = loop;
+        connection->last_active = std::chrono::steady_clock::now();
+        loop->connections[fd] = std::move(connection);
+        active_connections_.fetch_add(1);
+    }
+}
+
+void HttpReactor::read_connection(IoLoop* loop, int fd) {
+    auto it = loop->connections.find(fd);
+    if (it == loop->connections.end()) {
+        return;
+    }
+    Connection& connection = *it->second;
+    connection.last_active = std::chrono::steady_clock::now();
+
+    // Read until a full request is buffered (or the socket is drained). The
+    // parser enforces max_request_size, so a single connection can never
+    // buffer much more than one request plus one read chunk.
+    char chunk[READ_CHUNK_SIZE];
+    HttpRequestParser::Result result = HttpRequestParser::Result::INCOMPLETE;
+    while (result == HttpRequestParser::Result::INCOMPLETE) {
+        ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+        if (received > 0) {
+            connection.buffer.append(chunk, static_cast<size_t>(received));
+            result = connection.parser.parse(connection.buffer);
+            if (connection.parser.take_continue()) {
+                send_interim(fd, CONTINUE_RESPONSE, sizeof(CONTINUE_RESPONSE) - 1);
+            }
+            continue;
+        }
+        if (received == 0) {
+            connection.peer_closed = true;
+            break;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            close_connection(loop, fd);
+            return;
+        }
+        break;
+    }
+
+    if (result == HttpRequestParser::Result::ERROR) {
+        reject_request(fd, connection.parser);
+        close_connection(loop, fd);
+        return;
+    }
+    if (result != HttpRequestParser::Result::COMPLETE) {
+        if (connection.peer_closed) {
+            close_connection(loop, fd);
+        }
+        return;
+    }
+
+    // Hand the connection over to a worker; the I/O thread stops watching
+    // it until the worker returns it for the next request.
+    epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    std::shared_ptr<Connection> owned = std::move(it->second);
+    loop->connections.erase(it);
+    dispatch(std::move(owned));
+}
+
+void HttpReactor::reject_request(int fd, const HttpRequestParser& parser) {
+    LOG_DEBUG_F("Rejecting malformed request: %d %s", parser.error_status(), parser.error_message().c_str());
+    std::string response = error_response(parser.error_status(), parser.error_message());
+    send_interim(fd, response.data(), response.size());
+}
+
+void HttpReactor::close_connection(IoLoop* loop, int fd) {
+    auto it = loop->connections.find(fd);
+    if (it == loop->connections.end()) {
+        return;
+    }
+    epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    loop->connections.erase(it);
+    active_connections_.fetch_sub(1);
+}
+
+void HttpReactor::adopt_returned(IoLoop* loop) {
+    std::vector<std::shared_ptr<Connection>> returned;
+    {
+        std::lock_guard<std::mutex> lock(loop->returned_mutex);
+        returned.swap(loop->returned);
+    }
+
+    for (auto& connection : returned) {
+        // Level-triggered: bytes that arrived while a worker owned the
+        // socket are reported on the next epoll_wait.
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.fd = connection->fd;
+        if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, connection->fd, &event) < 0) {
+            close(connection->fd);
+            active_connections_.fetch_sub(1);
+            continue;
+        }
+        connection->last_active = std::chrono::steady_clock::now();
+        loop->connections[connection->fd] = std::move(connection);
+    }
+}
+
+void HttpReactor::close_idle_connections(IoLoop* loop) {
+    auto cutoff = std::chrono::steady_clock::now() - std::chrono::milliseconds(config_.idle_timeout_ms);
+    std::vector<int> idle;
+    for (const auto& [fd, connection] : loop->connections) {
+        if (connection->last_active < cutoff) {
+            idle.push_back(fd);
+        }
+    }
+    for (int fd : idle) {
+        close_connection(loop, fd);
+    }
+}
+
+void HttpReactor::dispatch(std::shared_ptr<Connection> connection) {
+    handler_tasks_.submit([this, connection]() { serve_connection(connection); });
+}
+
+void HttpReactor::serve_connection(const std::shared_ptr<Connection>& connection) {
+    bool keep_alive = true;
+
+    // Answer every complete request already buffered, in order, so that
+    // pipelined requests get their responses in the order they were sent.
+    while (keep_alive) {
+        HttpRequestParser::Result result = connection->parser.parse(connection->buffer);
+        if (result == HttpRequestParser::Result::INCOMPLETE) {
+            if (connection->parser.take_continue()) {
+                send_interim(connection->fd, CONTINUE_RESPONSE, sizeof(CONTINUE_RESPONSE) - 1);
+            }
+            keep_alive = !connection->peer_closed;
+            break;
+        }
+        if (result == HttpRequestParser::Result::ERROR) {
+            reject_request(connection->fd, connection->parser);
+            keep_alive = false;
+            break;
+        }
+
+        connection->requests_served++;
+        bool allow_keep_alive = config_.keep_alive && running_.load() && !connection->peer_closed &&
+            (config_.max_requests_per_connection <= 0 ||
+             connection->requests_served < config_.max_requests_per_connection);
+        std::function<void()> stream;
+        try {
+            keep_alive = handler_(connection->fd, connection->parser.request(), allow_keep_alive) && allow_keep_alive;
+            stream = std::move(t_detached_stream);
+        } catch (const std::exception& e) {
+            LOG_ERROR_F("Unhandled exception in HTTP handler: %s", e.what());
+            keep_alive = false;
+        } catch (...) {
+            LOG_ERROR("Unknown exception in HTTP handler");
+            keep_alive = false;
+        }
+        t_detached_stream = nullptr;
+        if (stream) {
+            // Bytes pipelined behind a stream are never answered
+            start_stream(connection, std::move(stream));
+            return;
+        }
+        connection->parser.consume(connection->buffer);
+    }
+
+    if (!keep_alive || !running_.load()) {
+        close(connection->fd);
+        active_connections_.fetch_sub(1);
+        return;
+    }
+
+    IoLoop* owner = connection->owner;
+    {
+        std::lock_guard<std::mutex> lock(owner->returned_mutex);
+        owner->returned.push_back(connection);
+    }
+    uint64_t one = 1;
+    ssize_t written = write(owner->wake_fd, &one, sizeof(one));
+    (void)written;
+}
+
+void HttpReactor::detach_stream(std::function<void()> stream) {
+    t_detached_stream = std::move(stream);
+}
+
+size_t HttpReactor::active_streams() const {
+    std::lock_guard<std::mutex> lock(streams_mutex_);
+    return active_streams_;
+}
+
+void HttpReactor::start_stream(std::shared_ptr<Connection> connection, std::function<void()> stream) {
+    {
+        std::lock_guard<std::mutex> lock(streams_mutex_);
+        active_streams_++;
+    }
+    std::thread([this, connection, stream = std::move(stream)]() mutable {
+        try {
+            stream();
+        } catch (const std::exception& e) {
+            LOG_ERROR_F("Unhandled exception in HTTP stream: %s", e.what());
+        } catch (...) {
+            LOG_ERROR("Unknown exception in HTTP stream");
+        }
+        // Release what the stream captured while stop() still waits for it
+        stream = nullptr;
+        close(connection->fd);
+        active_connections_.fetch_sub(1);
+
+        std::lock_guard<std::mutex> lock(streams_mutex_);
+        if (--active_streams_ == 0) {
+            streams_idle_.notify_all();
+        }
+    }).detach();
+}
+
+#else  // !__linux__
+
+HttpReactor::HttpReactor(int listen_fd, const Config& config, RequestHandler handler)
+    : listen_fd_(listen_fd), config_(config), handler_(std::move(handler)),
+      handler_tasks_(TaskScheduler::shared(), TaskScheduler::Priority::INTERACTIVE) {}
+
+HttpReactor::~HttpReactor() = default;
+
+bool HttpReactor::start() {
+    LOG_ERROR("HTTP reactor requires epoll and is only available on Linux");
+    return false;
+}
+
+void HttpReactor::stop() {}
+void HttpReactor::io_loop(IoLoop*) {}
+void HttpReactor::accept_connections(IoLoop*) {}
+void HttpReactor::read_connection(IoLoop*, int) {}
+void HttpReactor::close_connection(IoLoop*, int) {}
+void HttpReactor::reject_request(int, const HttpRequestParser&) {}
+void HttpReactor::adopt_returned(IoLoop*) {}
+void HttpReactor::close_idle_connections(IoLoop*) {}
+void HttpReactor::dispatch(std::shared_ptr<Connection>) {}
+void HttpReactor::serve_connection(const std::shared_ptr<Connection>&) {}
+void HttpReactor::detach_stream(std::function<void()>) {}
+size_t HttpReactor::active_streams() const { return 0; }
+void HttpReactor::start_stream(std::shared_ptr<Connection>, std::function<void()>) {}
+
+#endif  // __linux__
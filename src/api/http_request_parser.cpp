@@ -0,0 +1,409 @@
+#include "../../include/http_request_parser.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace {
+
+constexpr size_t MAX_CHUNK_LINE = 1024;
+
+bool iequals(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// True if the comma-separated header value contains the given token.
+bool has_token(std::string_view value, std::string_view token) {
+    while (!value.empty()) {
+        size_t comma = value.find(',');
+        std::string_view item = value.substr(0, comma);
+        while (!item.empty() && (item.front() == ' ' || item.front() == '\t')) item.remove_prefix(1);
+        while (!item.empty() && (item.back() == ' ' || item.back() == '\t')) item.remove_suffix(1);
+        if (iequals(item, token)) {
+            return true;
+        }
+        if (comma == std::string_view::npos) {
+            break;
+        }
+        value.remove_prefix(comma + 1);
+    }
+    return false;
+}
+
+bool parse_decimal(std::string_view text, size_t& value) {
+    if (text.empty() || text.size() > 19) {
+        return false;
+    }
+    value = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        value = value * 10 + static_cast<size_t>(c - '0');
+    }
+    return true;
+}
+
+int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+}  // namespace
+
+std::string_view HttpRequest::header(std::string_view name) const {
+    for (const auto& [key, value] : headers) {
+        if (iequals(key, name)) {
+            return value;
+        }
+    }
+    return {};
+}
+
+HttpRequestParser::HttpRequestParser(size_t max_request_size, size_t max_header_size)
+    : max_request_size_(max_request_size),
+      max_header_size_(std::min(max_header_size, max_request_size)) {}
+
+void HttpRequestParser::reset() {
+    state_ = State::HEADERS;
+    start_ = 0;
+    scan_offset_ = 0;
+    body_start_ = 0;
+    read_pos_ = 0;
+    write_pos_ = 0;
+    content_length_ = 0;
+    chunk_remaining_ = 0;
+    chunked_ = false;
+    continue_pending_ = false;
+    method_ = target_ = version_ = Span{};
+    header_spans_.clear();
+    auto headers = std::move(request_.headers);  // Keep capacity for the next request
+    headers.clear();
+    request_ = HttpRequest{};
+    request_.headers = std::move(headers);
+    error_status_ = 0;
+    error_message_.clear();
+}
+
+void HttpRequestParser::consume(std::string& buffer) {
+    if (state_ == State::COMPLETE) {
+        buffer.erase(0, read_pos_);
+    }
+    reset();
+}
+
+bool HttpRequestParser::take_continue() {
+    bool pending = continue_pending_;
+    continue_pending_ = false;
+    return pending;
+}
+
+HttpRequestParser::Result HttpRequestParser::fail(int status, const std::string& message) {
+    state_ = State::ERROR;
+    error_status_ = status;
+    error_message_ = message;
+    continue_pending_ = false;
+    return Result::ERROR;
+}
+
+std::string_view HttpRequestParser::view(const std::string& buffer, const Span& span) const {
+    return std::string_view(buffer.data() + span.offset, span.length);
+}
+
+std::string_view HttpRequestParser::find_header(const std::string& buffer, std::string_view name) const {
+    for (const auto& [key, value] : header_spans_) {
+        if (iequals(view(buffer, key), name)) {
+            return view(buffer, value);
+        }
+    }
+    return {};
+}
+
+HttpRequestParser::Result HttpRequestParser::parse(std::string& buffer) {
+    while (true) {
+        switch (state_) {
+            case State::HEADERS: {
+                // COMPLETE here only means the header block is done
+                Result result = parse_headers(buffer);
+                if (result != Result::COMPLETE) {
+                    return result;
+                }
+                break;
+            }
+            case State::BODY:
+                if (buffer.size() - body_start_ < content_length_) {
+                    return Result::INCOMPLETE;
+                }
+                read_pos_ = body_start_ + content_length_;
+                return finish(buffer);
+            case State::CHUNK_SIZE:
+            case State::CHUNK_DATA:
+            case State::CHUNK_DATA_END:
+            case State::TRAILERS:
+                return parse_chunked(buffer);
+            case State::COMPLETE:
+                return Result::COMPLETE;
+            case State::ERROR:
+                return Result::ERROR;
+        }
+    }
+}
+
+HttpRequestParser::Result HttpRequestParser::parse_headers(std::string& buffer) {
+    // Tolerate empty lines between pipelined requests (RFC 9112 section 2.2)
+    if (scan_offset_ == start_) {
+        while (buffer.size() - start_ >= 2 && buffer[start_] == '\r' && buffer[start_ + 1] == '\n') {
+            start_ += 2;
+        }
+        scan_offset_ = start_;
+    }
+
+    size_t header_end = buffer.find("\r\n\r\n", scan_offset_);
+    if (header_end == std::string::npos) {
+        if (buffer.size() - start_ > max_header_size_) {
+            return fail(431, "Request header fields too large");
+        }
+        // Resume just before the end so a terminator split across reads is found
+        scan_offset_ = std::max(start_, buffer.size() >= 3 ? buffer.size() - 3 : size_t(0));
+        return Result::INCOMPLETE;
+    }
+    if (header_end - start_ > max_header_size_) {
+        return fail(431, "Request header fields too large");
+    }
+
+    // Request line: METHOD SP TARGET SP VERSION
+    size_t line_end = buffer.find("\r\n", start_);
+    size_t first_space = buffer.find(' ', start_);
+    size_t second_space = first_space == std::string::npos ? std::string::npos : buffer.find(' ', first_space + 1);
+    if (first_space == std::string::npos || second_space == std::string::npos ||
+        second_space >= line_end || first_space == start_ || second_space == first_space + 1) {
+        return fail(400, "Malformed request line");
+    }
+    method_ = Span{start_, first_space - start_};
+    target_ = Span{first_space + 1, second_space - first_space - 1};
+    version_ = Span{second_space + 1, line_end - second_space - 1};
+
+    std::string_view version = view(buffer, version_);
+    if (version.substr(0, 5) != "HTTP/") {
+        return fail(400, "Malformed request line");
+    }
+    if (version != "HTTP/1.1" && version != "HTTP/1.0") {
+        return fail(505, "HTTP version not supported");
+    }
+
+    // Header fields
+    header_spans_.clear();
+    size_t pos = line_end + 2;
+    while (pos < header_end + 2) {
+        size_t end = buffer.find("\r\n", pos);
+        if (buffer[pos] == ' ' || buffer[pos] == '\t') {
+            return fail(400, "Obsolete header line folding is not supported");
+        }
+        size_t colon = buffer.find(':', pos);
+        if (colon == std::string::npos || colon >= end || colon == pos) {
+            return fail(400, "Malformed header field");
+        }
+        for (size_t i = pos; i < colon; ++i) {
+            if (buffer[i] == ' ' || buffer[i] == '\t') {
+                return fail(400, "Malformed header field name");
+            }
+        }
+        size_t value_start = colon + 1;
+        size_t value_end = end;
+        while (value_start < value_end && (buffer[value_start] == ' ' || buffer[value_start] == '\t')) ++value_start;
+        while (value_end > value_start && (buffer[value_end - 1] == ' ' || buffer[value_end - 1] == '\t')) --value_end;
+        header_spans_.push_back({Span{pos, colon - pos}, Span{value_start, value_end - value_start}});
+        pos = end + 2;
+    }
+
+    // Body framing
+    std::string_view transfer_encoding = find_header(buffer, "transfer-encoding");
+    bool has_content_length = false;
+    content_length_ = 0;
+    for (const auto& [key, value] : header_spans_) {
+        if (!iequals(view(buffer, key), "content-length")) {
+            continue;
+        }
+        size_t length = 0;
+        if (!parse_decimal(view(buffer, value), length)) {
+            return fail(400, "Invalid Content-Length");
+        }
+        if (has_content_length && length != content_length_) {
+            return fail(400, "Conflicting Content-Length headers");
+        }
+        has_content_length = true;
+        content_length_ = length;
+    }
+
+    if (!transfer_encoding.empty()) {
+        if (has_content_length) {
+            return fail(400, "Content-Length and Transfer-Encoding are mutually exclusive");
+        }
+        if (!iequals(transfer_encoding, "chunked")) {
+            return fail(501, "Unsupported Transfer-Encoding");
+        }
+        chunked_ = true;
+    }
+
+    body_start_ = header_end + 4;
+    size_t header_size = body_start_ - start_;
+    if (content_length_ > max_request_size_ || header_size + content_length_ > max_request_size_) {
+        return fail(413, "Request body exceeds max_request_size");
+    }
+
+    bool expects_body = chunked_ || content_length_ > 0;
+    if (expects_body && has_token(find_header(buffer, "expect"), "100-continue")) {
+        continue_pending_ = true;
+    }
+
+    if (chunked_) {
+        read_pos_ = write_pos_ = scan_offset_ = body_start_;
+        state_ = State::CHUNK_SIZE;
+    } else {
+        state_ = State::BODY;
+    }
+    return Result::COMPLETE;
+}
+
+HttpRequestParser::Result HttpRequestParser::parse_chunked(std::string& buffer) {
+    const size_t header_size = body_start_ - start_;
+
+    while (true) {
+        switch (state_) {
+            case State::CHUNK_SIZE: {
+                size_t line_end = buffer.find("\r\n", scan_offset_);
+                if (line_end == std::string::npos) {
+                    if (buffer.size() - read_pos_ > MAX_CHUNK_LINE) {
+                        return fail(400, "Chunk size line too long");
+                    }
+                    scan_offset_ = std::max(read_pos_, buffer.size() - 1);
+                    return Result::INCOMPLETE;
+                }
+                if (line_end - read_pos_ > MAX_CHUNK_LINE) {
+                    return fail(400, "Chunk size line too long");
+                }
+
+                size_t size = 0;
+                size_t digits = 0;
+                for (size_t i = read_pos_; i < line_end; ++i, ++digits) {
+                    int digit = hex_value(buffer[i]);
+                    if (digit < 0) {
+                        break;  // Chunk extensions (";name=value") are ignored
+                    }
+                    if (size > (max_request_size_ >> 4)) {
+                        return fail(413, "Request body exceeds max_request_size");
+                    }
+                    size = (size << 4) | static_cast<size_t>(digit);
+                }
+                size_t size_end = read_pos_ + digits;
+                if (digits == 0 || (size_end < line_end && buffer[size_end] != ';' &&
+                                    buffer[size_end] != ' ' && buffer[size_end] != '\t')) {
+                    return fail(400, "Invalid chunk size");
+                }
+
+                read_pos_ = line_end + 2;
+                scan_offset_ = read_pos_;
+                if (size == 0) {
+                    state_ = State::TRAILERS;
+                    break;
+                }
+                if (header_size + (write_pos_ - body_start_) + size > max_request_size_) {
+                    return fail(413, "Request body exceeds max_request_size");
+                }
+                chunk_remaining_ = size;
+                state_ = State::CHUNK_DATA;
+                break;
+            }
+            case State::CHUNK_DATA: {
+                size_t available = std::min(chunk_remaining_, buffer.size() - read_pos_);
+                if (available > 0 && write_pos_ != read_pos_) {
+                    // Compact in place: decoded data never overtakes the read cursor
+                    std::memmove(&buffer[write_pos_], &buffer[read_pos_], available);
+                }
+                write_pos_ += available;
+                read_pos_ += available;
+                chunk_remaining_ -= available;
+                if (chunk_remaining_ > 0) {
+                    return Result::INCOMPLETE;
+                }
+                state_ = State::CHUNK_DATA_END;
+                break;
+            }
+            case State::CHUNK_DATA_END:
+                if (buffer.size() - read_pos_ < 2) {
+                    return Result::INCOMPLETE;
+                }
+                if (buffer[read_pos_] != '\r' || buffer[read_pos_ + 1] != '\n') {
+                    return fail(400, "Malformed chunk terminator");
+                }
+                read_pos_ += 2;
+                scan_offset_ = read_pos_;
+                state_ = State::CHUNK_SIZE;
+                break;
+            case State::TRAILERS: {
+                size_t line_end = buffer.find("\r\n", scan_offset_);
+                if (line_end == std::string::npos) {
+                    if (buffer.size() - read_pos_ > max_header_size_) {
+                        return fail(431, "Request trailer fields too large");
+                    }
+                    scan_offset_ = std::max(read_pos_, buffer.size() - 1);
+                    return Result::INCOMPLETE;
+                }
+                bool last = line_end == read_pos_;
+                read_pos_ = line_end + 2;  // Trailer fields are skipped
+                scan_offset_ = read_pos_;
+                if (last) {
+                    return finish(buffer);
+                }
+                break;
+            }
+            default:
+                return parse(buffer);
+        }
+    }
+}
+
+HttpRequestParser::Result HttpRequestParser::finish(const std::string& buffer) {
+    request_.method = view(buffer, method_);
+    request_.target = view(buffer, target_);
+    request_.version = view(buffer, version_);
+
+    size_t query_pos = request_.target.find('?');
+    request_.path = request_.target.substr(0, query_pos);
+    request_.query = query_pos == std::string_view::npos ? std::string_view{} : request_.target.substr(query_pos + 1);
+
+    request_.headers.clear();
+    request_.headers.reserve(header_spans_.size());
+    for (const auto& [key, value] : header_spans_) {
+        request_.headers.emplace_back(view(buffer, key), view(buffer, value));
+    }
+
+    if (chunked_) {
+        request_.body = std::string_view(buffer.data() + body_start_, write_pos_ - body_start_);
+    } else {
+        request_.body = std::string_view(buffer.data() + body_start_, content_length_);
+    }
+
+    // HTTP/1.1 defaults to persistent connections, HTTP/1.0 to close; an
+    // explicit Connection header overrides either.
+    std::string_view connection = request_.header("connection");
+    request_.keep_alive = request_.version == "HTTP/1.1";
+    if (has_token(connection, "close")) {
+        request_.keep_alive = false;
+    } else if (has_token(connection, "keep-alive")) {
+        request_.keep_alive = true;
+    }
+
+    continue_pending_ = false;
+    state_ = State::COMPLETE;
+    return Result::COMPLETE;
+}
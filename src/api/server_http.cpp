@@ -1,4 +1,7 @@
 #include "../include/server_http.hpp"
+#include "../include/http_reactor.hpp"
+#include "../include/task_scheduler.hpp"
+#include "../include/logger.hpp"
 #include <iostream>
 #include <sstream>
 #include <regex>
@@ -6,6 +9,9 @@
 #include <algorithm>
 #include <ctime>
 #include <mutex>
+#include <deque>
+#include <chrono>
+#include <condition_variable>
 
 #ifdef _WIN32
 static bool winsock_initialized = false;
@@ -30,15 +36,133 @@ void cleanup_winsock() {
     }
 }
 #else
+#include <poll.h>
+#include <netinet/tcp.h>
+#include <cerrno>
+
 void init_winsock() {}
 void cleanup_winsock() {}
 #endif
 
+namespace {
+
+// Whether the response currently being produced on this thread keeps the
+// connection open. A request is always answered on a single thread in both
+// I/O models, so send_response can pick the Connection header from here.
+thread_local bool t_keep_alive = false;
+
+// Whether the current request's Accept header asks for text/event-stream
+thread_local bool t_accepts_event_stream = false;
+
+const char* const SCHEDULER_LANE_NAMES[TaskScheduler::PRIORITY_COUNT] = {"interactive", "normal", "batch"};
+
+json scheduler_metrics(const TaskScheduler::Stats& stats) {
+    json lanes = json::object();
+    for (size_t lane = 0; lane < TaskScheduler::PRIORITY_COUNT; ++lane) {
+        lanes[SCHEDULER_LANE_NAMES[lane]] = {
+            {"queued", stats.queued[lane]},
+            {"executed", stats.executed[lane]}
+        };
+    }
+    return json{
+        {"workers", stats.workers},
+        {"spare_workers", stats.spare_workers},
+        {"blocked_workers", stats.blocked_workers},
+        {"idle_workers", stats.idle_workers},
+        {"submitted", stats.submitted},
+        {"steals", stats.steals},
+        {"spares_started", stats.spares_started},
+        {"injection_queue_depth", stats.injection_depth},
+        {"worker_queue_depths", stats.worker_depths},
+        {"lanes", lanes}
+    };
+}
+
+// Comment line sent on idle event streams so proxies keep them open
+constexpr auto EVENT_STREAM_HEARTBEAT = std::chrono::seconds(15);
+
+// Events buffered per stream subscriber before the oldest are dropped
+constexpr size_t MAX_PENDING_STREAM_EVENTS = 256;
+
+// Thread-per-connection read timeout when keep_alive_timeout_ms is unset
+constexpr int DEFAULT_READ_TIMEOUT_MS = 5000;
+
+// Writes the whole buffer, looping over partial writes. Sockets owned by the
+// epoll reactor are non-blocking, so EAGAIN waits for writability instead of
+// dropping the rest of the response.
+bool send_all(socket_t client_socket, const char* data, size_t length) {
+    size_t sent_total = 0;
+    while (sent_total < length) {
+#ifdef _WIN32
+        int sent = send(client_socket, data + sent_total, static_cast<int>(length - sent_total), 0);
+        if (sent == SOCKET_ERROR) {
+            return false;
+        }
+#else
+        ssize_t sent = send(client_socket, data + sent_total, length - sent_total, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                pollfd pfd{client_socket, POLLOUT, 0};
+                if (poll(&pfd, 1, 30000) <= 0) {
+                    return false;
+                }
+                continue;
+            }
+            return false;
+        }
+#endif
+        sent_total += static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+// Starts a Server-Sent Events response. The body has no length, so the
+// connection is closed when the stream ends.
+bool begin_event_stream(socket_t client_socket) {
+    t_keep_alive = false;
+    static const char headers[] =
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: text/event-stream\r\n"
+        "Cache-Control: no-cache\r\n"
+        "Access-Control-Allow-Origin: *\r\n"
+        "Access-Control-Allow-Methods: GET, POST, PUT, DELETE, OPTIONS\r\n"
+        "Access-Control-Allow-Headers: Content-Type\r\n"
+        "X-Accel-Buffering: no\r\n"
+        "Connection: close\r\n"
+        "\r\n";
+    return send_all(client_socket, headers, sizeof(headers) - 1);
+}
+
+// Writes one event frame; data is serialized on a single line
+bool send_event(socket_t client_socket, const std::string& event_type, const json& data) {
+    std::string frame;
+    frame.reserve(event_type.size() + 32);
+    frame += "event: ";
+    frame += event_type;
+    frame += "\ndata: ";
+    frame += data.dump();
+    frame += "\n\n";
+    return send_all(client_socket, frame.data(), frame.size());
+}
+
+bool is_terminal_state(WorkflowExecutionState state) {
+    return state == WorkflowExecutionState::COMPLETED ||
+           state == WorkflowExecutionState::FAILED ||
+           state == WorkflowExecutionState::CANCELLED ||
+           state == WorkflowExecutionState::TIMEOUT;
+}
+
+}  // namespace
+
 HTTPServer::HTTPServer(std::shared_ptr<AgentManager> agent_manager, 
                        const std::string& host, 
                        int port)
     : agent_manager_(agent_manager), host_(host), port_(port), server_socket_(INVALID_SOCKET) {
     init_winsock();
+    register_routes();
 }
 
 HTTPServer::HTTPServer(std::shared_ptr<AgentManager> agent_manager,
@@ -50,6 +174,20 @@ HTTPServer::HTTPServer(std::shared_ptr<AgentManager> agent_manager,
       workflow_orchestrator_(workflow_orchestrator), host_(host), port_(port), 
       server_socket_(INVALID_SOCKET) {
     init_winsock();
+    register_routes();
+}
+
+HTTPServer::HTTPServer(std::shared_ptr<AgentManager> agent_manager,
+                       std::shared_ptr<WorkflowManager> workflow_manager,
+                       std::shared_ptr<WorkflowOrchestrator> workflow_orchestrator,
+                       const std::string& host,
+                       int port,
+                       const Config& config)
+    : agent_manager_(agent_manager), workflow_manager_(workflow_manager),
+      workflow_orchestrator_(workflow_orchestrator), host_(host), port_(port),
+      server_socket_(INVALID_SOCKET), config_(config) {
+    init_winsock();
+    register_routes();
 }
 
 HTTPServer::~HTTPServer() {
@@ -61,6 +199,18 @@ HTTPServer::~HTTPServer() {
     }
 }
 
+HTTPServer::IoModel HTTPServer::parse_io_model(const std::string& name) {
+    std::string lowered = name;
+    std::transform(lowered.begin(), lowered.end(), lowered.begin(), ::tolower);
+    if (lowered == "epoll" || lowered == "reactor") {
+        return IoModel::EPOLL;
+    }
+    if (lowered == "thread_per_connection" || lowered == "threaded" || lowered.empty()) {
+        return IoModel::THREAD_PER_CONNECTION;
+    }
+    throw std::invalid_argument("Unknown HTTP server io_model: " + name);
+}
+
 bool HTTPServer::start() {
     if (running_.load()) {
         return true;
@@ -105,16 +255,48 @@ bool HTTPServer::start() {
     }
     
     // Listen
-    if (listen(server_socket_, 10) == SOCKET_ERROR) {
+    if (listen(server_socket_, config_.backlog > 0 ? config_.backlog : SOMAXCONN) == SOCKET_ERROR) {
         std::cerr << "Failed to listen on socket\n";
         closesocket(server_socket_);
         return false;
     }
     
+    IoModel io_model = config_.io_model;
+#ifndef __linux__
+    if (io_model == IoModel::EPOLL) {
+        LOG_WARN("epoll I/O model is only available on Linux, falling back to thread-per-connection");
+        io_model = IoModel::THREAD_PER_CONNECTION;
+    }
+#endif
+    
     running_.store(true);
-    server_thread_ = std::thread(&HTTPServer::server_loop, this);
+    if (io_model == IoModel::EPOLL) {
+        HttpReactor::Config reactor_config;
+        reactor_config.io_threads = config_.io_threads;
+        reactor_config.worker_threads = config_.worker_threads;
+        reactor_config.max_connections = config_.max_connections;
+        reactor_config.max_request_size = config_.max_request_size;
+        reactor_config.keep_alive = config_.keep_alive;
+        reactor_config.idle_timeout_ms = config_.keep_alive_timeout_ms;
+        reactor_config.max_requests_per_connection = config_.max_requests_per_connection;
+        reactor_ = std::make_unique<HttpReactor>(
+            static_cast<int>(server_socket_), reactor_config,
+            [this](int fd, const HttpRequest& request, bool allow_keep_alive) {
+                return process_request(static_cast<socket_t>(fd), request, allow_keep_alive);
+            });
+        if (!reactor_->start()) {
+            reactor_.reset();
+            running_.store(false);
+            closesocket(server_socket_);
+            server_socket_ = INVALID_SOCKET;
+            return false;
+        }
+    } else {
+        server_thread_ = std::thread(&HTTPServer::server_loop, this);
+    }
     
-    std::cout << "HTTP Server started on " << host_ << ":" << port_ << "\n";
+    std::cout << "HTTP Server started on " << host_ << ":" << port_
+              << (io_model == IoModel::EPOLL ? " (epoll)" : "") << "\n";
     std::cout << "Available endpoints:\n";
     std::cout << "  GET    /agents                    - List all agents\n";
     std::cout << "  POST   /agents                    - Create new agent\n";
@@ -125,6 +307,9 @@ bool HTTPServer::start() {
     std::cout << "  POST   /agents/{id_or_name}/execute - Execute function (with model parameter)\n";
     std::cout << "  POST   /agent/execute            - Simple agent execute (query + context)\n";
     std::cout << "  GET    /status                    - System status\n";
+    std::cout << "  GET    /health                    - Health check\n";
+    std::cout << "  GET    /metrics                   - Queue, cache, hedging and scheduler metrics (JSON)\n";
+    std::cout << "  GET    /metrics/prometheus        - The same metrics in Prometheus text format\n";
     std::cout << "\n";
     std::cout << "Note: {id_or_name} can be either the agent's UUID or its human-readable name\n";
     
@@ -156,7 +341,16 @@ void HTTPServer::stop() {
     
     running_.store(false);
     
+    if (reactor_) {
+        reactor_->stop();
+        reactor_.reset();
+    }
+    
     if (server_socket_ != INVALID_SOCKET) {
+#ifndef _WIN32
+        // Closing alone does not wake a thread blocked in accept() on Linux
+        shutdown(server_socket_, SHUT_RDWR);
+#endif
         closesocket(server_socket_);
         server_socket_ = INVALID_SOCKET;
     }
@@ -171,6 +365,13 @@ void HTTPServer::stop() {
         }
     }
     
+    // Connection threads notice running_ after their current request or
+    // read timeout at the latest
+    {
+        std::unique_lock<std::mutex> lock(connections_mutex_);
+        connections_idle_.wait(lock, [this] { return active_connections_.load() == 0; });
+    }
+    
     std::cout << "HTTP Server stopped\n";
 }
 
@@ -187,237 +388,204 @@ void HTTPServer::server_loop() {
             continue;
         }
         
-        // Handle client in a separate thread
-        std::thread(&HTTPServer::handle_client, this, client_socket).detach();
+        // Same connection cap as the epoll reactor: refuse with 503 rather
+        // than take on more sockets than the server is configured for
+        if (active_connections_.load() >= config_.max_connections) {
+            t_keep_alive = false;
+            send_error(client_socket, 503, "Too many connections");
+            closesocket(client_socket);
+            rejected_connections_.fetch_add(1);
+            continue;
+        }
+        active_connections_.fetch_add(1);
+        
+        // The connection blocks in recv between requests, so it gets a
+        // thread of its own rather than a shared scheduler worker: idle
+        // clients must not hold back workflow and handler tasks
+        std::thread([this, client_socket]() {
+            handle_client(client_socket);
+            std::lock_guard<std::mutex> lock(connections_mutex_);
+            if (active_connections_.fetch_sub(1) == 1) {
+                connections_idle_.notify_all();
+            }
+        }).detach();
     }
 }
 
 void HTTPServer::handle_client(socket_t client_socket) {
-    char buffer[4096] = {0};
-    int bytes_received = recv(client_socket, buffer, sizeof(buffer) - 1, 0);
+    int nodelay = 1;
+    setsockopt(client_socket, IPPROTO_TCP, TCP_NODELAY, (const char*)&nodelay, sizeof(nodelay));
     
-    if (bytes_received <= 0) {
-        closesocket(client_socket);
-        return;
+    // Bound how long an idle or slow client may hold this thread, whether
+    // it is waiting for its first request or for the next one
+    const int read_timeout_ms = config_.keep_alive_timeout_ms > 0 ? config_.keep_alive_timeout_ms
+                                                                  : DEFAULT_READ_TIMEOUT_MS;
+#ifdef _WIN32
+    DWORD timeout = static_cast<DWORD>(read_timeout_ms);
+    setsockopt(client_socket, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
+#else
+    struct timeval timeout;
+    timeout.tv_sec = read_timeout_ms / 1000;
+    timeout.tv_usec = (read_timeout_ms % 1000) * 1000;
+    setsockopt(client_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+#endif
+    
+    // One buffer per connection, reused for every request on it
+    std::string buffer;
+    HttpRequestParser parser(config_.max_request_size);
+    char chunk[16384];
+    int requests_served = 0;
+    bool keep_alive = true;
+    
+    while (keep_alive && running_.load()) {
+        HttpRequestParser::Result result = parser.parse(buffer);
+        while (result == HttpRequestParser::Result::INCOMPLETE) {
+            if (parser.take_continue()) {
+                static const char continue_response[] = "HTTP/1.1 100 Continue\r\n\r\n";
+                send_all(client_socket, continue_response, sizeof(continue_response) - 1);
+            }
+            int bytes_received = recv(client_socket, chunk, sizeof(chunk), 0);
+            if (bytes_received <= 0) {
+                closesocket(client_socket);
+                return;
+            }
+            buffer.append(chunk, bytes_received);
+            result = parser.parse(buffer);
+        }
+        
+        if (result == HttpRequestParser::Result::ERROR) {
+            t_keep_alive = false;
+            send_error(client_socket, parser.error_status(), parser.error_message());
+            break;
+        }
+        
+        requests_served++;
+        bool allow_keep_alive = config_.keep_alive && running_.load() &&
+            (config_.max_requests_per_connection <= 0 || requests_served < config_.max_requests_per_connection);
+        keep_alive = process_request(client_socket, parser.request(), allow_keep_alive);
+        parser.consume(buffer);
     }
     
-    std::string request(buffer, bytes_received);
-    std::string method, path, body;
+    closesocket(client_socket);
+}
+
+bool HTTPServer::process_request(socket_t client_socket, const HttpRequest& request, bool allow_keep_alive) {
+    t_keep_alive = allow_keep_alive && request.keep_alive;
+    t_accepts_event_stream = request.header("Accept").find("text/event-stream") != std::string_view::npos;
+    const bool debug_enabled = KolosalAgent::Logger::instance().should_log(KolosalAgent::LogLevel::DEBUG);
     
     try {
-        parse_http_request(request, method, path, body);
-        
-        // Log the incoming request
-        std::cout << "[HTTP] " << method << " " << path << "\n";
-        std::cout << "[HTTP-DEBUG] Processing request from client, body size: " << body.size() << " bytes\n";
-        
-        // Route handling with detailed logging
-        bool route_matched = false;
-        
-        if (path == "/agents" && method == "GET") {
-            std::cout << "[HTTP-ROUTE] Matched route: List agents\n";
-            route_matched = true;
-            handle_list_agents(client_socket);
-        } else if (path == "/agents" && method == "POST") {
-            std::cout << "[HTTP-ROUTE] Matched route: Create agent\n";
-            route_matched = true;
-            handle_create_agent(client_socket, body);
-        } else if (path.find("/agents/") == 0 && method == "GET") {
-            std::string agent_identifier = extract_path_parameter(path, "/agents/");
-            if (!agent_identifier.empty() && path == "/agents/" + agent_identifier) {
-                std::string agent_id = resolve_agent_identifier(agent_identifier);
-                if (!agent_id.empty()) {
-                    std::cout << "[HTTP-ROUTE] Matched route: Get agent details for identifier: " << agent_identifier << " (resolved to ID: " << agent_id << ")\n";
-                    route_matched = true;
-                    handle_get_agent(client_socket, agent_id);
+        auto match = router_.resolve(request.method, request.path);
+        
+        if (debug_enabled) {
+            std::string method(request.method);
+            std::string path(request.path);
+            LOG_DEBUG_F("[HTTP] %s %s (body %zu bytes) -> %s", method.c_str(), path.c_str(), request.body.size(),
+                        match.name ? match.name->c_str() : "no route");
+        }
+        
+        switch (match.status) {
+            case RouteStatus::MATCHED: {
+                std::string body(request.body);
+                (*match.handler)(client_socket, match.params, body);
+                break;
+            }
+            case RouteStatus::METHOD_NOT_ALLOWED:
+                if (request.method == "OPTIONS") {
+                    send_response(client_socket, 200, "");  // CORS preflight
                 } else {
-                    std::cout << "[HTTP-ERROR] Agent not found: " << agent_identifier << "\n";
-                    send_error(client_socket, 404, "Agent not found: " + agent_identifier);
-                    route_matched = true;
+                    send_error(client_socket, 405, "Method Not Allowed");
                 }
-            }
-        } else if (path.find("/agents/") == 0 && path.find("/start") != std::string::npos && method == "PUT") {
-            std::string agent_identifier = extract_path_parameter(path, "/agents/");
-            agent_identifier = agent_identifier.substr(0, agent_identifier.length() - 6); // Remove "/start"
-            std::string agent_id = resolve_agent_identifier(agent_identifier);
-            if (!agent_id.empty()) {
-                std::cout << "[HTTP-ROUTE] Matched route: Start agent identifier: " << agent_identifier << " (resolved to ID: " << agent_id << ")\n";
-                route_matched = true;
-                handle_start_agent(client_socket, agent_id);
-            } else {
-                std::cout << "[HTTP-ERROR] Agent not found: " << agent_identifier << "\n";
-                send_error(client_socket, 404, "Agent not found: " + agent_identifier);
-                route_matched = true;
-            }
-        } else if (path.find("/agents/") == 0 && path.find("/stop") != std::string::npos && method == "PUT") {
-            std::string agent_identifier = extract_path_parameter(path, "/agents/");
-            agent_identifier = agent_identifier.substr(0, agent_identifier.length() - 5); // Remove "/stop"
-            std::string agent_id = resolve_agent_identifier(agent_identifier);
-            if (!agent_id.empty()) {
-                std::cout << "[HTTP-ROUTE] Matched route: Stop agent identifier: " << agent_identifier << " (resolved to ID: " << agent_id << ")\n";
-                route_matched = true;
-                handle_stop_agent(client_socket, agent_id);
-            } else {
-                std::cout << "[HTTP-ERROR] Agent not found: " << agent_identifier << "\n";
-                send_error(client_socket, 404, "Agent not found: " + agent_identifier);
-                route_matched = true;
-            }
-        } else if (path.find("/agents/") == 0 && path.find("/execute") != std::string::npos && method == "POST") {
-            std::string agent_identifier = extract_path_parameter(path, "/agents/");
-            agent_identifier = agent_identifier.substr(0, agent_identifier.length() - 8); // Remove "/execute"
-            std::string agent_id = resolve_agent_identifier(agent_identifier);
-            if (!agent_id.empty()) {
-                std::cout << "[HTTP-ROUTE] Matched route: Execute function for agent identifier: " << agent_identifier << " (resolved to ID: " << agent_id << ")\n";
-                route_matched = true;
-                handle_execute_function(client_socket, agent_id, body);
-            } else {
-                std::cout << "[HTTP-ERROR] Agent not found: " << agent_identifier << "\n";
-                send_error(client_socket, 404, "Agent not found: " + agent_identifier);
-                route_matched = true;
-            }
-        } else if (path == "/agent/execute" && method == "POST") {
-            std::cout << "[HTTP-ROUTE] Matched route: Simple agent execute endpoint\n";
-            route_matched = true;
-            handle_simple_agent_execute(client_socket, body);
-        } else if (path.find("/agents/") == 0 && method == "DELETE") {
-            std::string agent_identifier = extract_path_parameter(path, "/agents/");
-            std::string agent_id = resolve_agent_identifier(agent_identifier);
-            if (!agent_id.empty()) {
-                std::cout << "[HTTP-ROUTE] Matched route: Delete agent identifier: " << agent_identifier << " (resolved to ID: " << agent_id << ")\n";
-                route_matched = true;
-                handle_delete_agent(client_socket, agent_id);
-            } else {
-                std::cout << "[HTTP-ERROR] Agent not found: " << agent_identifier << "\n";
-                send_error(client_socket, 404, "Agent not found: " + agent_identifier);
-                route_matched = true;
-            }
-        } else if (path == "/status" && method == "GET") {
-            std::cout << "[HTTP-ROUTE] Matched route: System status\n";
-            route_matched = true;
-            handle_system_status(client_socket);
-        }
-        // Kolosal Server Management routes
-        else if (path == "/kolosal-server/start" && method == "POST") {
-        }
-        // Workflow Orchestration routes
-        else if (workflow_orchestrator_ && path == "/workflows" && method == "GET") {
-            std::cout << "[HTTP-ROUTE] Matched route: List workflows\n";
-            route_matched = true;
-            handle_list_workflows(client_socket);
-        } else if (workflow_orchestrator_ && path == "/workflows" && method == "POST") {
-            std::cout << "[HTTP-ROUTE] Matched route: Register new workflow\n";
-            route_matched = true;
-            handle_register_workflow(client_socket, body);
-        } else if (workflow_orchestrator_ && path.find("/workflows/") == 0 && path.find("/execute") != std::string::npos && method == "POST") {
-            std::string workflow_id = extract_path_parameter(path, "/workflows/");
-            workflow_id = workflow_id.substr(0, workflow_id.length() - 8); // Remove "/execute"
-            std::cout << "[HTTP-ROUTE] Matched route: Execute workflow ID: " << workflow_id << "\n";
-            route_matched = true;
-            handle_execute_workflow(client_socket, body, workflow_id);
-        } else if (workflow_orchestrator_ && path.find("/workflows/executions/") == 0 && method == "GET") {
-            std::string execution_id = extract_path_parameter(path, "/workflows/executions/");
-            if (execution_id.find("/") != std::string::npos) {
-                // This is a control action like /workflows/executions/{id}/pause
-                size_t slash_pos = execution_id.find("/");
-                std::string action = execution_id.substr(slash_pos + 1);
-                execution_id = execution_id.substr(0, slash_pos);
-                std::cout << "[HTTP-ROUTE] Matched route: Control workflow execution ID: " << execution_id << ", action: " << action << "\n";
-                route_matched = true;
-                handle_control_workflow_execution(client_socket, execution_id, action);
-            } else {
-                std::cout << "[HTTP-ROUTE] Matched route: Get workflow execution status for ID: " << execution_id << "\n";
-                route_matched = true;
-                handle_get_workflow_execution(client_socket, execution_id);
-            }
-        } else if (workflow_orchestrator_ && path.find("/workflows/executions/") == 0 && method == "PUT") {
-            std::string path_part = extract_path_parameter(path, "/workflows/executions/");
-            size_t slash_pos = path_part.find("/");
-            if (slash_pos != std::string::npos) {
-                std::string execution_id = path_part.substr(0, slash_pos);
-                std::string action = path_part.substr(slash_pos + 1);
-                std::cout << "[HTTP-ROUTE] Matched route: Control workflow execution ID: " << execution_id << ", action: " << action << "\n";
-                route_matched = true;
-                handle_control_workflow_execution(client_socket, execution_id, action);
-            }
-        } else if (workflow_orchestrator_ && path == "/workflows/executions" && method == "GET") {
-            std::cout << "[HTTP-ROUTE] Matched route: List workflow executions\n";
-            route_matched = true;
-            handle_list_workflow_executions(client_socket);
-        } else if (workflow_orchestrator_ && path.find("/workflows/") == 0 && method == "GET" && path.find("/execute") == std::string::npos) {
-            std::string workflow_id = extract_path_parameter(path, "/workflows/");
-            std::cout << "[HTTP-ROUTE] Matched route: Get workflow definition for ID: " << workflow_id << "\n";
-            route_matched = true;
-            handle_get_workflow(client_socket, workflow_id);
-        } else if (workflow_orchestrator_ && path.find("/workflows/") == 0 && method == "PUT") {
-            std::string workflow_id = extract_path_parameter(path, "/workflows/");
-            std::cout << "[HTTP-ROUTE] Matched route: Update workflow ID: " << workflow_id << "\n";
-            route_matched = true;
-            handle_update_workflow(client_socket, workflow_id, body);
-        } else if (workflow_orchestrator_ && path.find("/workflows/") == 0 && method == "DELETE") {
-            std::string workflow_id = extract_path_parameter(path, "/workflows/");
-            std::cout << "[HTTP-ROUTE] Matched route: Delete workflow ID: " << workflow_id << "\n";
-            route_matched = true;
-            handle_delete_workflow(client_socket, workflow_id);
-        } else if (workflow_orchestrator_ && path == "/workflow_templates" && method == "GET") {
-            std::cout << "[HTTP-ROUTE] Matched route: List workflow templates\n";
-            route_matched = true;
-            handle_get_workflow_templates(client_socket);
-        } else if (workflow_orchestrator_ && path.find("/workflow_templates/") == 0 && path.find("/execute") != std::string::npos && method == "POST") {
-            std::string template_id = extract_path_parameter(path, "/workflow_templates/");
-            template_id = template_id.substr(0, template_id.length() - 8); // Remove "/execute"
-            std::cout << "[HTTP-ROUTE] Matched route: Execute workflow template ID: " << template_id << "\n";
-            route_matched = true;
-            handle_execute_workflow_template(client_socket, template_id, body);
-        } else if (workflow_orchestrator_ && path.find("/workflow_executions/") == 0 && path.find("/progress") != std::string::npos && method == "GET") {
-            std::string execution_id = extract_path_parameter(path, "/workflow_executions/");
-            execution_id = execution_id.substr(0, execution_id.length() - 9); // Remove "/progress"
-            std::cout << "[HTTP-ROUTE] Matched route: Get workflow execution progress for ID: " << execution_id << "\n";
-            route_matched = true;
-            handle_workflow_execution_progress(client_socket, execution_id);
-        } else if (workflow_orchestrator_ && path.find("/workflow_executions/") == 0 && path.find("/logs") != std::string::npos && method == "GET") {
-            std::string execution_id = extract_path_parameter(path, "/workflow_executions/");
-            execution_id = execution_id.substr(0, execution_id.length() - 5); // Remove "/logs"
-            std::cout << "[HTTP-ROUTE] Matched route: Get workflow execution logs for ID: " << execution_id << "\n";
-            route_matched = true;
-            handle_workflow_execution_logs(client_socket, execution_id);
-        }
-        
-        if (!route_matched) {
-            std::cout << "[HTTP-ERROR] No route found for " << method << " " << path << " - responding with 404\n";
-            send_error(client_socket, 404, "Not Found");
-        } else {
-            std::cout << "[HTTP-COMPLETE] Request processing completed for " << method << " " << path << "\n";
+                break;
+            case RouteStatus::NOT_FOUND:
+                send_error(client_socket, 404, "Not Found");
+                break;
         }
     } catch (const std::exception& e) {
         send_error(client_socket, 500, e.what());
     }
     
-    closesocket(client_socket);
+    return t_keep_alive;
 }
 
-std::string HTTPServer::parse_http_request(const std::string& request, std::string& method, std::string& path, std::string& body) {
-    std::istringstream stream(request);
-    std::string line;
+void HTTPServer::register_routes() {
+    // Agent routes accept either the agent's UUID or its name
+    auto with_agent = [this](std::function<void(socket_t, const std::string&, const std::string&)> handler) {
+        return [this, handler](socket_t client_socket, const RouteParams& params, const std::string& body) {
+            std::string agent_identifier(params.get("id"));
+            std::string agent_id = resolve_agent_identifier(agent_identifier);
+            if (agent_id.empty()) {
+                send_error(client_socket, 404, "Agent not found: " + agent_identifier);
+                return;
+            }
+            handler(client_socket, agent_id, body);
+        };
+    };
+    auto param = [](const RouteParams& params, std::string_view name) { return std::string(params.get(name)); };
     
-    // Parse request line
-    if (std::getline(stream, line)) {
-        std::istringstream request_line(line);
-        request_line >> method >> path;
-    }
+    router_.add("GET", "/agents", "List agents",
+        [this](socket_t s, const RouteParams&, const std::string&) { handle_list_agents(s); });
+    router_.add("POST", "/agents", "Create agent",
+        [this](socket_t s, const RouteParams&, const std::string& body) { handle_create_agent(s, body); });
+    router_.add("GET", "/agents/{id}", "Get agent details",
+        with_agent([this](socket_t s, const std::string& id, const std::string&) { handle_get_agent(s, id); }));
+    router_.add("DELETE", "/agents/{id}", "Delete agent",
+        with_agent([this](socket_t s, const std::string& id, const std::string&) { handle_delete_agent(s, id); }));
+    router_.add("PUT", "/agents/{id}/start", "Start agent",
+        with_agent([this](socket_t s, const std::string& id, const std::string&) { handle_start_agent(s, id); }));
+    router_.add("PUT", "/agents/{id}/stop", "Stop agent",
+        with_agent([this](socket_t s, const std::string& id, const std::string&) { handle_stop_agent(s, id); }));
+    router_.add("POST", "/agents/{id}/execute", "Execute agent function",
+        with_agent([this](socket_t s, const std::string& id, const std::string& body) { handle_execute_function(s, id, body); }));
+    router_.add("POST", "/agent/execute", "Simple agent execute",
+        [this](socket_t s, const RouteParams&, const std::string& body) { handle_simple_agent_execute(s, body); });
+    router_.add("GET", "/status", "System status",
+        [this](socket_t s, const RouteParams&, const std::string&) { handle_system_status(s); });
+    router_.add("GET", "/health", "Health check",
+        [this](socket_t s, const RouteParams&, const std::string&) { handle_get_health_status(s); });
+    router_.add("GET", "/metrics", "System metrics",
+        [this](socket_t s, const RouteParams&, const std::string&) { handle_get_system_metrics(s); });
+    router_.add("GET", "/metrics/prometheus", "Prometheus metrics",
+        [this](socket_t s, const RouteParams&, const std::string&) { handle_get_prometheus_metrics(s); });
+    router_.add("GET", "/metrics/performance", "Performance metrics",
+        [this](socket_t s, const RouteParams&, const std::string&) { handle_get_performance_metrics(s); });
     
-    // Skip headers and find body
-    bool in_body = false;
-    while (std::getline(stream, line)) {
-        if (line.empty() || line == "\r") {
-            in_body = true;
-            continue;
-        }
-        if (in_body) {
-            body += line;
-        }
+    if (!workflow_orchestrator_) {
+        return;
     }
     
-    return "";
+    // Workflow orchestration routes
+    router_.add("GET", "/workflows", "List workflows",
+        [this](socket_t s, const RouteParams&, const std::string&) { handle_list_workflows(s); });
+    router_.add("POST", "/workflows", "Register workflow",
+        [this](socket_t s, const RouteParams&, const std::string& body) { handle_register_workflow(s, body); });
+    router_.add("GET", "/workflows/{id}", "Get workflow definition",
+        [this, param](socket_t s, const RouteParams& p, const std::string&) { handle_get_workflow(s, param(p, "id")); });
+    router_.add("PUT", "/workflows/{id}", "Update workflow",
+        [this, param](socket_t s, const RouteParams& p, const std::string& body) { handle_update_workflow(s, param(p, "id"), body); });
+    router_.add("DELETE", "/workflows/{id}", "Delete workflow",
+        [this, param](socket_t s, const RouteParams& p, const std::string&) { handle_delete_workflow(s, param(p, "id")); });
+    router_.add("POST", "/workflows/{id}/execute", "Execute workflow",
+        [this, param](socket_t s, const RouteParams& p, const std::string& body) { handle_execute_workflow(s, body, param(p, "id")); });
+    router_.add("GET", "/workflows/executions", "List workflow executions",
+        [this](socket_t s, const RouteParams&, const std::string&) { handle_list_workflow_executions(s); });
+    router_.add("GET", "/workflows/executions/{id}", "Get workflow execution",
+        [this, param](socket_t s, const RouteParams& p, const std::string&) { handle_get_workflow_execution(s, param(p, "id")); });
+    auto control_execution = [this, param](socket_t s, const RouteParams& p, const std::string&) {
+        handle_control_workflow_execution(s, param(p, "id"), param(p, "action"));
+    };
+    router_.add("PUT", "/workflows/executions/{id}/{action}", "Control workflow execution", control_execution);
+    router_.add("GET", "/workflows/executions/{id}/{action}", "Control workflow execution", control_execution);
+    router_.add("GET", "/workflow_templates", "List workflow templates",
+        [this](socket_t s, const RouteParams&, const std::string&) { handle_get_workflow_templates(s); });
+    router_.add("POST", "/workflow_templates/{id}/execute", "Execute workflow template",
+        [this, param](socket_t s, const RouteParams& p, const std::string& body) { handle_execute_workflow_template(s, param(p, "id"), body); });
+    router_.add("GET", "/workflow_executions/{id}/progress", "Get workflow execution progress",
+        [this, param](socket_t s, const RouteParams& p, const std::string&) { handle_workflow_execution_progress(s, param(p, "id")); });
+    router_.add("GET", "/workflow_executions/{id}/logs", "Get workflow execution logs",
+        [this, param](socket_t s, const RouteParams& p, const std::string&) { handle_workflow_execution_logs(s, param(p, "id")); });
+    router_.add("GET", "/workflow_executions/{id}/events", "Stream workflow execution events",
+        [this, param](socket_t s, const RouteParams& p, const std::string&) { handle_workflow_execution_events(s, param(p, "id")); });
 }
 
 void HTTPServer::send_response(socket_t client_socket, int status_code, const std::string& body, const std::string& content_type) {
@@ -428,11 +596,19 @@ void HTTPServer::send_response(socket_t client_socket, int status_code, const st
     response << "Access-Control-Allow-Origin: *\r\n";
     response << "Access-Control-Allow-Methods: GET, POST, PUT, DELETE, OPTIONS\r\n";
     response << "Access-Control-Allow-Headers: Content-Type\r\n";
+    if (t_keep_alive) {
+        response << "Connection: keep-alive\r\n";
+        response << "Keep-Alive: timeout=" << std::max(1, config_.keep_alive_timeout_ms / 1000) << "\r\n";
+    } else {
+        response << "Connection: close\r\n";
+    }
     response << "\r\n";
     response << body;
     
     std::string response_str = response.str();
-    send(client_socket, response_str.c_str(), response_str.length(), 0);
+    if (!send_all(client_socket, response_str.c_str(), response_str.length())) {
+        t_keep_alive = false;
+    }
 }
 
 void HTTPServer::send_error(socket_t client_socket, int status_code, const std::string& message) {
@@ -443,6 +619,33 @@ void HTTPServer::send_error(socket_t client_socket, int status_code, const std::
     send_response(client_socket, status_code, error_response.dump(2));
 }
 
+// Event streams last as long as the client (or the execution) does. Under
+// the reactor they are detached onto their own thread so they do not occupy
+// one of the worker_threads handler slots; a thread-per-connection handler
+// already has a thread of its own and streams inline.
+void HTTPServer::run_event_stream(socket_t client_socket, std::function<void()> stream) {
+    if (active_streams_.fetch_add(1) >= config_.max_event_streams) {
+        active_streams_.fetch_sub(1);
+        t_keep_alive = false;
+        send_error(client_socket, 503, "Too many event streams");
+        return;
+    }
+    auto counted = [this, stream = std::move(stream)]() {
+        struct StreamCount {
+            std::atomic<size_t>& active;
+            ~StreamCount() { active.fetch_sub(1); }
+        } count{active_streams_};
+        stream();
+    };
+    
+    t_keep_alive = false;
+    if (reactor_) {
+        reactor_->detach_stream(std::move(counted));
+    } else {
+        counted();
+    }
+}
+
 void HTTPServer::handle_list_agents(socket_t client_socket) {
     try {
         json response = agent_manager_->list_agents();
@@ -765,6 +968,13 @@ void HTTPServer::handle_execute_function(socket_t client_socket, const std::stri
             return;
         }
         
+        // Stream generated text as Server-Sent Events when asked to
+        bool stream = request.value("stream", t_accepts_event_stream);
+        if (stream && agent_manager_->agent_supports_streaming(agent_id, function_name)) {
+            handle_execute_function_stream(client_socket, agent_id, function_name, params, model);
+            return;
+        }
+        
         json result = agent_manager_->execute_agent_function(agent_id, function_name, params);
         
         json response;
@@ -781,6 +991,42 @@ void HTTPServer::handle_execute_function(socket_t client_socket, const std::stri
     }
 }
 
+void HTTPServer::handle_execute_function_stream(socket_t client_socket, const std::string& agent_id,
+                                                const std::string& function_name, const json& params,
+                                                const std::string& model) {
+    run_event_stream(client_socket, [this, client_socket, agent_id, function_name, params, model]() {
+        if (!begin_event_stream(client_socket)) {
+            return;
+        }
+        
+        // Once the headers are out, failures are reported as "error" events
+        bool client_connected = true;
+        try {
+            json result = agent_manager_->execute_agent_function_streaming(agent_id, function_name, params,
+                [&](const std::string& delta) {
+                    client_connected = send_event(client_socket, "token", json{{"content", delta}});
+                    return client_connected;  // Stops generation once the client has gone
+                });
+            if (!client_connected) {
+                return;
+            }
+            
+            json response;
+            response["result"] = result;
+            response["agent_id"] = agent_id;
+            response["function"] = function_name;
+            if (!model.empty()) {
+                response["model"] = model;
+            }
+            send_event(client_socket, "done", response);
+        } catch (const std::exception& e) {
+            if (client_connected) {
+                send_event(client_socket, "error", json{{"error", e.what()}});
+            }
+        }
+    });
+}
+
 void HTTPServer::handle_execute_all_tools(socket_t client_socket, const std::string& agent_id, const json& params) {
     try {
         auto agent = agent_manager_->get_agent(agent_id);
@@ -927,13 +1173,6 @@ void HTTPServer::handle_system_status(socket_t client_socket) {
     }
 }
 
-std::string HTTPServer::extract_path_parameter(const std::string& path, const std::string& prefix) {
-    if (path.find(prefix) == 0) {
-        return path.substr(prefix.length());
-    }
-    return "";
-}
-
 std::string HTTPServer::resolve_agent_identifier(const std::string& agent_identifier) {
     // First, try to get agent directly by ID
     if (agent_manager_->agent_exists(agent_identifier)) {
@@ -1089,7 +1328,11 @@ void HTTPServer::handle_register_workflow(socket_t client_socket, const std::str
         workflow.description = workflow_data.value("description", "");
         workflow.max_execution_time_ms = workflow_data.value("max_execution_time_ms", 300000);
         workflow.allow_partial_failure = workflow_data.value("allow_partial_failure", false);
+        workflow.max_parallel_steps = workflow_data.value("max_parallel_steps", 4);
         workflow.global_context = workflow_data.value("global_context", json{});
+        if (workflow_data.contains("pipeline_config")) {
+            WorkflowOrchestrator::parse_pipeline_config(workflow_data["pipeline_config"], workflow);
+        }
         
         // Parse steps
         for (const auto& step_data : workflow_data["steps"]) {
@@ -1102,6 +1345,13 @@ void HTTPServer::handle_register_workflow(socket_t client_socket, const std::str
             
             step.timeout_ms = step_data.value("timeout_ms", 30000);
             step.optional = step_data.value("optional", false);
+            step.cacheable = step_data.value("cacheable", false);
+            if (step_data.contains("map")) {
+                step.map = WorkflowOrchestrator::parse_map_config(step_data["map"]);
+            }
+            if (step_data.contains("hedge")) {
+                step.hedge = WorkflowOrchestrator::parse_hedge_config(step_data["hedge"]);
+            }
             step.conditions = step_data.value("conditions", json{});
             step.dependencies = step_data.value("dependencies", std::vector<std::string>{});
             
@@ -1116,6 +1366,8 @@ void HTTPServer::handle_register_workflow(socket_t client_socket, const std::str
         
         send_response(client_socket, 201, response.dump(2));
         
+    } catch (const std::invalid_argument& e) {
+        send_error(client_socket, 400, e.what());
     } catch (const std::exception& e) {
         send_error(client_socket, 500, e.what());
     }
@@ -1127,12 +1379,14 @@ void HTTPServer::handle_execute_workflow(socket_t client_socket, const std::stri
         
         json input_data = request_data.value("input_data", json{});
         bool async_execution = request_data.value("async", true);
+        std::string tenant_id = request_data.value("tenant_id", std::string());
+        int priority = request_data.value("priority", 0);
         
         std::string execution_id;
         if (async_execution) {
-            execution_id = workflow_orchestrator_->execute_workflow_async(workflow_id, input_data);
+            execution_id = workflow_orchestrator_->execute_workflow_async(workflow_id, input_data, tenant_id, priority);
         } else {
-            execution_id = workflow_orchestrator_->execute_workflow(workflow_id, input_data);
+            execution_id = workflow_orchestrator_->execute_workflow(workflow_id, input_data, tenant_id, priority);
         }
         
         json response;
@@ -1159,7 +1413,7 @@ void HTTPServer::handle_get_workflow_execution(socket_t client_socket, const std
         json response;
         response["execution_id"] = execution->execution_id;
         response["workflow_id"] = execution->workflow_id;
-        response["state"] = static_cast<int>(execution->state);
+        response["state"] = static_cast<int>(execution->state.load());
         response["progress_percentage"] = execution->progress_percentage;
         response["start_time"] = std::chrono::duration_cast<std::chrono::seconds>(
             execution->start_time.time_since_epoch()).count();
@@ -1171,10 +1425,13 @@ void HTTPServer::handle_get_workflow_execution(socket_t client_socket, const std
         
         response["input_data"] = execution->input_data;
         response["output_data"] = execution->output_data;
-        response["context"] = execution->context;
-        response["error_message"] = execution->error_message;
-        response["step_results"] = execution->step_results;
-        response["step_outputs"] = execution->step_outputs;
+        {
+            std::lock_guard<std::mutex> lock(execution->mutex);
+            response["context"] = execution->context_json();
+            response["error_message"] = execution->error_message;
+            response["step_results"] = execution->step_results;
+            response["step_outputs"] = execution->step_outputs_json();
+        }
         
         send_response(client_socket, 200, response.dump(2));
         
@@ -1224,11 +1481,14 @@ void HTTPServer::handle_list_workflow_executions(socket_t client_socket) {
             json execution_info;
             execution_info["execution_id"] = execution->execution_id;
             execution_info["workflow_id"] = execution->workflow_id;
-            execution_info["state"] = static_cast<int>(execution->state);
+            execution_info["state"] = static_cast<int>(execution->state.load());
             execution_info["progress_percentage"] = execution->progress_percentage;
             execution_info["start_time"] = std::chrono::duration_cast<std::chrono::seconds>(
                 execution->start_time.time_since_epoch()).count();
-            execution_info["error_message"] = execution->error_message;
+            {
+                std::lock_guard<std::mutex> lock(execution->mutex);
+                execution_info["error_message"] = execution->error_message;
+            }
             response.push_back(execution_info);
         }
         
@@ -1321,6 +1581,13 @@ void HTTPServer::handle_get_system_metrics(socket_t client_socket) {
             {"active_executions", workflow_orchestrator_ ? workflow_orchestrator_->list_active_executions().size() : 0},
             {"total_executions", 0}
         };
+        if (workflow_orchestrator_) {
+            response["workflows"]["execution_queue"] = workflow_orchestrator_->get_execution_queue_stats();
+            response["workflows"]["step_cache"] = workflow_orchestrator_->get_step_cache_stats();
+            response["workflows"]["hedging"] = workflow_orchestrator_->get_hedging_stats();
+        }
+        
+        response["scheduler"] = scheduler_metrics(TaskScheduler::shared().get_stats());
         
         send_response(client_socket, 200, response.dump(2));
         
@@ -1409,15 +1676,76 @@ void HTTPServer::handle_get_prometheus_metrics(socket_t client_socket) {
         prometheus << "# TYPE kolosal_active_workflows gauge\n";
         prometheus << "kolosal_active_workflows " << (workflow_orchestrator_ ? workflow_orchestrator_->list_active_executions().size() : 0) << "\n\n";
         
-        // Send response with appropriate content type
-        std::string response = prometheus.str();
-        std::string http_response = "HTTP/1.1 200 OK\r\n";
-        http_response += "Content-Type: text/plain; charset=utf-8\r\n";
-        http_response += "Content-Length: " + std::to_string(response.length()) + "\r\n";
-        http_response += "Connection: close\r\n\r\n";
-        http_response += response;
+        if (workflow_orchestrator_) {
+            json queue = workflow_orchestrator_->get_execution_queue_stats();
+            prometheus << "# HELP kolosal_workflow_queued_executions Executions waiting in the ready queue\n";
+            prometheus << "# TYPE kolosal_workflow_queued_executions gauge\n";
+            prometheus << "kolosal_workflow_queued_executions " << queue["queued"].get<size_t>() << "\n";
+            prometheus << "# HELP kolosal_workflow_queued_tenants Tenants with queued executions\n";
+            prometheus << "# TYPE kolosal_workflow_queued_tenants gauge\n";
+            prometheus << "kolosal_workflow_queued_tenants " << queue["tenants"].get<size_t>() << "\n";
+            prometheus << "# HELP kolosal_workflow_queued_priority_levels Distinct priorities among queued executions\n";
+            prometheus << "# TYPE kolosal_workflow_queued_priority_levels gauge\n";
+            prometheus << "kolosal_workflow_queued_priority_levels " << queue["priority_levels"].get<size_t>() << "\n";
+            prometheus << "# HELP kolosal_workflow_queue_admissions_total Executions entering and leaving the ready queue\n";
+            prometheus << "# TYPE kolosal_workflow_queue_admissions_total counter\n";
+            prometheus << "kolosal_workflow_queue_admissions_total{event=\"enqueued\"} " << queue["enqueued"].get<uint64_t>() << "\n";
+            prometheus << "kolosal_workflow_queue_admissions_total{event=\"dispatched\"} " << queue["dispatched"].get<uint64_t>() << "\n";
+            prometheus << "kolosal_workflow_queue_admissions_total{event=\"removed\"} " << queue["removed"].get<uint64_t>() << "\n\n";
+            
+            json cache = workflow_orchestrator_->get_step_cache_stats();
+            prometheus << "# HELP kolosal_step_cache_lookups_total Step result cache lookups\n";
+            prometheus << "# TYPE kolosal_step_cache_lookups_total counter\n";
+            prometheus << "kolosal_step_cache_lookups_total{result=\"hit\"} " << cache["hits"].get<uint64_t>() << "\n";
+            prometheus << "kolosal_step_cache_lookups_total{result=\"miss\"} " << cache["misses"].get<uint64_t>() << "\n";
+            prometheus << "# HELP kolosal_step_cache_evictions_total Cached step results dropped for space or age\n";
+            prometheus << "# TYPE kolosal_step_cache_evictions_total counter\n";
+            prometheus << "kolosal_step_cache_evictions_total{reason=\"capacity\"} " << cache["evictions"].get<uint64_t>() << "\n";
+            prometheus << "kolosal_step_cache_evictions_total{reason=\"ttl\"} " << cache["expirations"].get<uint64_t>() << "\n";
+            prometheus << "# HELP kolosal_step_cache_bytes Approximate size of cached step results\n";
+            prometheus << "# TYPE kolosal_step_cache_bytes gauge\n";
+            prometheus << "kolosal_step_cache_bytes " << cache["bytes"].get<size_t>() << "\n\n";
+            
+            json hedging = workflow_orchestrator_->get_hedging_stats();
+            prometheus << "# HELP kolosal_step_hedges_launched_total Duplicate requests launched for slow hedged steps\n";
+            prometheus << "# TYPE kolosal_step_hedges_launched_total counter\n";
+            prometheus << "kolosal_step_hedges_launched_total " << hedging["hedges_launched"].get<uint64_t>() << "\n";
+            prometheus << "# HELP kolosal_step_hedge_races_total Hedged races by the request that won\n";
+            prometheus << "# TYPE kolosal_step_hedge_races_total counter\n";
+            prometheus << "kolosal_step_hedge_races_total{winner=\"original\"} " << hedging["primary_wins"].get<uint64_t>() << "\n";
+            prometheus << "kolosal_step_hedge_races_total{winner=\"duplicate\"} " << hedging["hedge_wins"].get<uint64_t>() << "\n";
+            prometheus << "kolosal_step_hedge_races_total{winner=\"none\"} " << hedging["both_failed"].get<uint64_t>() << "\n";
+            prometheus << "# HELP kolosal_step_hedge_cancellations_total Losing requests of hedged races cancelled while running\n";
+            prometheus << "# TYPE kolosal_step_hedge_cancellations_total counter\n";
+            prometheus << "kolosal_step_hedge_cancellations_total " << hedging["losers_cancelled"].get<uint64_t>() << "\n\n";
+        }
         
-        send(client_socket, http_response.c_str(), http_response.length(), 0);
+        auto scheduler = TaskScheduler::shared().get_stats();
+        prometheus << "# HELP kolosal_scheduler_queued_tasks Tasks waiting in the shared scheduler\n";
+        prometheus << "# TYPE kolosal_scheduler_queued_tasks gauge\n";
+        for (size_t lane = 0; lane < TaskScheduler::PRIORITY_COUNT; ++lane) {
+            prometheus << "kolosal_scheduler_queued_tasks{lane=\"" << SCHEDULER_LANE_NAMES[lane] << "\"} "
+                       << scheduler.queued[lane] << "\n";
+        }
+        prometheus << "\n# HELP kolosal_scheduler_executed_tasks_total Tasks run by the shared scheduler\n";
+        prometheus << "# TYPE kolosal_scheduler_executed_tasks_total counter\n";
+        for (size_t lane = 0; lane < TaskScheduler::PRIORITY_COUNT; ++lane) {
+            prometheus << "kolosal_scheduler_executed_tasks_total{lane=\"" << SCHEDULER_LANE_NAMES[lane] << "\"} "
+                       << scheduler.executed[lane] << "\n";
+        }
+        prometheus << "\n# HELP kolosal_scheduler_steals_total Tasks taken from another worker's deque\n";
+        prometheus << "# TYPE kolosal_scheduler_steals_total counter\n";
+        prometheus << "kolosal_scheduler_steals_total " << scheduler.steals << "\n\n";
+        
+        prometheus << "# HELP kolosal_scheduler_workers Scheduler threads by state\n";
+        prometheus << "# TYPE kolosal_scheduler_workers gauge\n";
+        prometheus << "kolosal_scheduler_workers{state=\"core\"} " << scheduler.workers << "\n";
+        prometheus << "kolosal_scheduler_workers{state=\"spare\"} " << scheduler.spare_workers << "\n";
+        prometheus << "kolosal_scheduler_workers{state=\"blocked\"} " << scheduler.blocked_workers << "\n";
+        prometheus << "kolosal_scheduler_workers{state=\"idle\"} " << scheduler.idle_workers << "\n\n";
+        
+        // Send response with appropriate content type
+        send_response(client_socket, 200, prometheus.str(), "text/plain; charset=utf-8");
         
     } catch (const std::exception& e) {
         send_error(client_socket, 500, e.what());
@@ -1500,6 +1828,13 @@ void HTTPServer::handle_get_workflow(socket_t client_socket, const std::string&
             step_json["parameters"] = step.parameters;
             step_json["timeout_ms"] = step.timeout_ms;
             step_json["optional"] = step.optional;
+            step_json["cacheable"] = step.cacheable;
+            if (step.map) {
+                step_json["map"] = WorkflowOrchestrator::map_config_to_json(*step.map);
+            }
+            if (step.hedge) {
+                step_json["hedge"] = WorkflowOrchestrator::hedge_config_to_json(*step.hedge);
+            }
             step_json["dependencies"] = step.dependencies;
             step_json["conditions"] = step.conditions;
             steps.push_back(step_json);
@@ -1535,7 +1870,11 @@ void HTTPServer::handle_update_workflow(socket_t client_socket, const std::strin
         workflow.description = workflow_data.value("description", "");
         workflow.max_execution_time_ms = workflow_data.value("max_execution_time_ms", 300000);
         workflow.allow_partial_failure = workflow_data.value("allow_partial_failure", false);
+        workflow.max_parallel_steps = workflow_data.value("max_parallel_steps", 4);
         workflow.global_context = workflow_data.value("global_context", json{});
+        if (workflow_data.contains("pipeline_config")) {
+            WorkflowOrchestrator::parse_pipeline_config(workflow_data["pipeline_config"], workflow);
+        }
         
         // Parse steps
         for (const auto& step_data : workflow_data["steps"]) {
@@ -1549,6 +1888,13 @@ void HTTPServer::handle_update_workflow(socket_t client_socket, const std::strin
             
             step.timeout_ms = step_data.value("timeout_ms", 60000);
             step.optional = step_data.value("optional", false);
+            step.cacheable = step_data.value("cacheable", false);
+            if (step_data.contains("map")) {
+                step.map = WorkflowOrchestrator::parse_map_config(step_data["map"]);
+            }
+            if (step_data.contains("hedge")) {
+                step.hedge = WorkflowOrchestrator::parse_hedge_config(step_data["hedge"]);
+            }
             
             if (step_data.contains("dependencies") && step_data["dependencies"].is_array()) {
                 for (const auto& dep : step_data["dependencies"]) {
@@ -1574,6 +1920,8 @@ void HTTPServer::handle_update_workflow(socket_t client_socket, const std::strin
         
     } catch (const json::parse_error& e) {
         send_error(client_socket, 400, "Invalid JSON: " + std::string(e.what()));
+    } catch (const std::invalid_argument& e) {
+        send_error(client_socket, 400, e.what());
     } catch (const std::exception& e) {
         send_error(client_socket, 500, e.what());
     }
@@ -1646,12 +1994,14 @@ void HTTPServer::handle_execute_workflow_template(socket_t client_socket, const
         json request_data = json::parse(body);
         json input_data = request_data.value("input_data", json{});
         bool async_execution = request_data.value("async", true);
+        std::string tenant_id = request_data.value("tenant_id", std::string());
+        int priority = request_data.value("priority", 0);
         
         std::string execution_id;
         if (async_execution) {
-            execution_id = workflow_orchestrator_->execute_workflow_async(template_id, input_data);
+            execution_id = workflow_orchestrator_->execute_workflow_async(template_id, input_data, tenant_id, priority);
         } else {
-            execution_id = workflow_orchestrator_->execute_workflow(template_id, input_data);
+            execution_id = workflow_orchestrator_->execute_workflow(template_id, input_data, tenant_id, priority);
         }
         
         json response;
@@ -1680,12 +2030,13 @@ void HTTPServer::handle_workflow_execution_progress(socket_t client_socket, cons
         json response;
         response["execution_id"] = execution->execution_id;
         response["workflow_id"] = execution->workflow_id;
-        response["state"] = static_cast<int>(execution->state);
+        response["state"] = static_cast<int>(execution->state.load());
         response["progress_percentage"] = execution->progress_percentage;
         
         // Calculate step progress
         auto workflow = workflow_orchestrator_->get_workflow(execution->workflow_id);
         if (workflow) {
+            std::lock_guard<std::mutex> lock(execution->mutex);
             response["total_steps"] = workflow->steps.size();
             response["completed_steps"] = execution->step_results.size();
             
@@ -1724,7 +2075,10 @@ void HTTPServer::handle_workflow_execution_progress(socket_t client_socket, cons
             response["elapsed_ms"] = std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
         }
         
-        response["error_message"] = execution->error_message;
+        {
+            std::lock_guard<std::mutex> lock(execution->mutex);
+            response["error_message"] = execution->error_message;
+        }
         
         send_response(client_socket, 200, response.dump(2));
         
@@ -1759,6 +2113,7 @@ void HTTPServer::handle_workflow_execution_logs(socket_t client_socket, const st
         // Add step execution logs
         auto workflow = workflow_orchestrator_->get_workflow(execution->workflow_id);
         if (workflow) {
+            std::lock_guard<std::mutex> lock(execution->mutex);
             for (const auto& step : workflow->steps) {
                 if (execution->step_results.find(step.id) != execution->step_results.end()) {
                     json step_log;
@@ -1807,3 +2162,86 @@ void HTTPServer::handle_workflow_execution_logs(socket_t client_socket, const st
         send_error(client_socket, 500, e.what());
     }
 }
+
+void HTTPServer::handle_workflow_execution_events(socket_t client_socket, const std::string& execution_id) {
+    auto execution = workflow_orchestrator_->get_execution_status(execution_id);
+    if (!execution) {
+        send_error(client_socket, 404, "Execution not found");
+        return;
+    }
+    
+    // Orchestrator threads queue events; this thread writes them out, so a
+    // slow client never stalls workflow execution
+    struct EventQueue {
+        std::mutex mutex;
+        std::condition_variable ready;
+        std::deque<std::pair<std::string, json>> events;
+    };
+    auto queue = std::make_shared<EventQueue>();
+    
+    // Subscribe before taking the snapshot so no transition is missed
+    size_t subscription = workflow_orchestrator_->subscribe_execution_events(execution_id,
+        [queue](const std::string&, const std::string& event_type, const json& data) {
+            std::lock_guard<std::mutex> lock(queue->mutex);
+            if (queue->events.size() >= MAX_PENDING_STREAM_EVENTS) {
+                queue->events.pop_front();
+            }
+            queue->events.emplace_back(event_type, data);
+            queue->ready.notify_one();
+        });
+    struct SubscriptionGuard {
+        WorkflowOrchestrator& orchestrator;
+        size_t id;
+        SubscriptionGuard(WorkflowOrchestrator& orchestrator, size_t id) : orchestrator(orchestrator), id(id) {}
+        ~SubscriptionGuard() { orchestrator.unsubscribe_execution_events(id); }
+    };
+    auto guard = std::make_shared<SubscriptionGuard>(*workflow_orchestrator_, subscription);
+    
+    // Read under the execution's lock: an execution that finished before the
+    // subscription sends no terminal event, so the stream must see its state
+    auto finished = [execution]() {
+        std::lock_guard<std::mutex> lock(execution->mutex);
+        return is_terminal_state(execution->state);
+    };
+    
+    run_event_stream(client_socket, [this, client_socket, execution_id, queue, guard, finished]() {
+        if (!begin_event_stream(client_socket) ||
+            !send_event(client_socket, "snapshot", workflow_orchestrator_->get_execution_progress(execution_id))) {
+            return;
+        }
+        if (finished()) {
+            return;
+        }
+        
+        // Long-lived stream: keep the scheduler from counting this worker as busy
+        TaskScheduler::BlockingScope blocking;
+        std::deque<std::pair<std::string, json>> batch;
+        while (running_.load()) {
+            {
+                std::unique_lock<std::mutex> lock(queue->mutex);
+                queue->ready.wait_for(lock, EVENT_STREAM_HEARTBEAT, [&queue] { return !queue->events.empty(); });
+                batch.swap(queue->events);
+            }
+            
+            if (batch.empty()) {
+                // Finished without a terminal event reaching this subscriber
+                if (finished()) {
+                    send_event(client_socket, "snapshot", workflow_orchestrator_->get_execution_progress(execution_id));
+                    return;
+                }
+                static const char heartbeat[] = ": keep-alive\n\n";
+                if (!send_all(client_socket, heartbeat, sizeof(heartbeat) - 1)) {
+                    return;
+                }
+                continue;
+            }
+            
+            for (const auto& [event_type, data] : batch) {
+                if (!send_event(client_socket, event_type, data) || event_type == "execution_finished") {
+                    return;
+                }
+            }
+            batch.clear();
+        }
+    });
+}
@@ -14,7 +14,8 @@ AsyncServiceLayer::AsyncServiceLayer(size_t worker_threads)
                                                       const std::shared_ptr<AsyncTask>&)>>(
           [](const std::shared_ptr<AsyncTask>& a, const std::shared_ptr<AsyncTask>& b) {
               return a->priority < b->priority; // Higher priority first
-          })) {
+          })),
+      worker_tasks_(TaskScheduler::shared(), TaskScheduler::Priority::INTERACTIVE, worker_threads) {
 }
 
 AsyncServiceLayer::~AsyncServiceLayer() {
@@ -26,10 +27,14 @@ void AsyncServiceLayer::start() {
         return; // Already running
     }
     
-    // Start worker threads
-    worker_threads_.clear();
-    for (size_t i = 0; i < worker_count_; ++i) {
-        worker_threads_.emplace_back(&AsyncServiceLayer::worker_thread, this);
+    // Run operations queued while stopped
+    size_t queued;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        queued = task_queue_.size();
+    }
+    for (size_t i = 0; i < queued; ++i) {
+        worker_tasks_.submit([this]() { run_next_task(); });
     }
     
     // Start cleanup thread
@@ -40,7 +45,7 @@ void AsyncServiceLayer::start() {
         }
     });
     
-    std::cout << "[AsyncServiceLayer] Started with " << worker_count_ << " worker threads" << std::endl;
+    std::cout << "[AsyncServiceLayer] Started with up to " << worker_count_ << " concurrent operations" << std::endl;
 }
 
 void AsyncServiceLayer::stop() {
@@ -48,23 +53,51 @@ void AsyncServiceLayer::stop() {
         return; // Already stopped
     }
     
-    // Notify all workers to stop
-    queue_condition_.notify_all();
-    
-    // Wait for all worker threads to finish
-    for (auto& thread : worker_threads_) {
-        if (thread.joinable()) {
-            thread.join();
-        }
-    }
-    worker_threads_.clear();
+    // Let running operations finish; queued ones wait for the next start()
+    worker_tasks_.wait();
     
     // Wait for cleanup thread
     if (cleanup_thread_.joinable()) {
         cleanup_thread_.join();
     }
     
-    std::cout << "[AsyncServiceLayer] Stopped all worker threads" << std::endl;
+    std::cout << "[AsyncServiceLayer] Stopped" << std::endl;
+}
+
+std::future<json> AsyncServiceLayer::submit_async_operation(const std::string& operation_type,
+                                                           std::function<void(OperationCompletion)> start) {
+    auto task = std::make_shared<AsyncTask>();
+    task->operation_id = generate_operation_id();
+    task->operation_type = operation_type;
+    task->result->status = AsyncOperationStatus::RUNNING;
+    
+    auto future = task->promise.get_future();
+    
+    {
+        std::lock_guard<std::mutex> lock(operations_mutex_);
+        operations_[task->operation_id] = task->result;
+    }
+    
+    async_in_flight_++;
+    notify_subscribers(AsyncEvent(AsyncEvent::OPERATION_STARTED, task->operation_id));
+    
+    // The completion may be invoked from any thread, but only the first call counts
+    auto completed = std::make_shared<std::atomic<bool>>(false);
+    OperationCompletion complete = [this, task, completed](json result, std::exception_ptr error) {
+        if (completed->exchange(true)) {
+            return;
+        }
+        async_in_flight_--;
+        finish_task(task, std::move(result), error);
+    };
+    
+    try {
+        start(complete);
+    } catch (...) {
+        complete(nullptr, std::current_exception());
+    }
+    
+    return future;
 }
 
 std::future<json> AsyncServiceLayer::submit_batch_operation(const std::string& operation_type,
@@ -156,6 +189,7 @@ json AsyncServiceLayer::get_queue_statistics() const {
     stats["completed_operations"] = completed_operations_.load();
     stats["failed_operations"] = failed_operations_.load();
     stats["cancelled_operations"] = cancelled_operations_.load();
+    stats["async_operations_in_flight"] = async_in_flight_.load();
     stats["worker_count"] = worker_count_;
     
     return stats;
@@ -166,19 +200,14 @@ void AsyncServiceLayer::set_max_queue_size(size_t max_size) {
 }
 
 void AsyncServiceLayer::adjust_worker_count(size_t worker_count) {
-    if (!running_) {
-        worker_count_ = worker_count;
-        return;
-    }
-    
-    // For a running system, this would require more complex logic
-    // to safely add/remove worker threads
-    std::cout << "[AsyncServiceLayer] Dynamic worker adjustment not implemented for running system" << std::endl;
+    worker_count_ = worker_count;
+    worker_tasks_.set_max_concurrency(worker_count);
 }
 
 json AsyncServiceLayer::get_worker_statistics() const {
     json stats;
     stats["worker_count"] = worker_count_;
+    stats["active_workers"] = worker_tasks_.running();
     stats["running"] = running_.load();
     stats["total_operations_completed"] = completed_operations_.load();
     stats["total_operations_failed"] = failed_operations_.load();
@@ -187,58 +216,68 @@ json AsyncServiceLayer::get_worker_statistics() const {
     return stats;
 }
 
-void AsyncServiceLayer::worker_thread() {
-    while (running_) {
-        std::shared_ptr<AsyncTask> task;
-        
-        // Get next task from queue
-        {
-            std::unique_lock<std::mutex> lock(queue_mutex_);
-            queue_condition_.wait(lock, [this] { return !running_ || !task_queue_.empty(); });
-            
-            if (!running_) break;
-            
-            if (!task_queue_.empty()) {
-                task = task_queue_.top();
-                task_queue_.pop();
-            }
-        }
-        
-        if (!task) continue;
-        
-        // Check if operation was cancelled
-        if (task->result->status == AsyncOperationStatus::CANCELLED) {
-            continue;
+void AsyncServiceLayer::run_next_task() {
+    if (!running_) {
+        return;
+    }
+    
+    std::shared_ptr<AsyncTask> task;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (task_queue_.empty()) {
+            return;
         }
+        task = task_queue_.top();
+        task_queue_.pop();
+    }
+    
+    // Check if operation was cancelled
+    if (task->result->status == AsyncOperationStatus::CANCELLED) {
+        return;
+    }
+    
+    // Execute the task
+    task->result->status = AsyncOperationStatus::RUNNING;
+    notify_subscribers(AsyncEvent(AsyncEvent::OPERATION_STARTED, task->operation_id));
+    
+    try {
+        finish_task(task, task->task_function(), nullptr);
+    } catch (const std::exception&) {
+        finish_task(task, nullptr, std::current_exception());
+    }
+}
+
+void AsyncServiceLayer::finish_task(const std::shared_ptr<AsyncTask>& task, json result, std::exception_ptr error) {
+    task->result->end_time = std::chrono::system_clock::now();
+    
+    if (!error) {
+        task->result->result_data = result;
+        task->result->status = AsyncOperationStatus::COMPLETED;
         
-        // Execute the task
-        task->result->status = AsyncOperationStatus::RUNNING;
-        notify_subscribers(AsyncEvent(AsyncEvent::OPERATION_STARTED, task->operation_id));
+        task->promise.set_value(result);
+        completed_operations_++;
         
-        try {
-            json result = task->task_function();
-            task->result->result_data = result;
-            task->result->status = AsyncOperationStatus::COMPLETED;
-            task->result->end_time = std::chrono::system_clock::now();
-            
-            task->promise.set_value(result);
-            completed_operations_++;
-            
-            notify_subscribers(AsyncEvent(AsyncEvent::OPERATION_COMPLETED, task->operation_id, result));
-            
-        } catch (const std::exception& e) {
-            task->result->status = AsyncOperationStatus::FAILED;
-            task->result->error_message = e.what();
-            task->result->end_time = std::chrono::system_clock::now();
-            
-            task->promise.set_exception(std::current_exception());
-            failed_operations_++;
-            
-            json error_data;
-            error_data["error"] = e.what();
-            notify_subscribers(AsyncEvent(AsyncEvent::OPERATION_FAILED, task->operation_id, error_data));
-        }
+        notify_subscribers(AsyncEvent(AsyncEvent::OPERATION_COMPLETED, task->operation_id, result));
+        return;
+    }
+    
+    std::string message = "Unknown error";
+    try {
+        std::rethrow_exception(error);
+    } catch (const std::exception& e) {
+        message = e.what();
+    } catch (...) {
     }
+    
+    task->result->status = AsyncOperationStatus::FAILED;
+    task->result->error_message = message;
+    
+    task->promise.set_exception(error);
+    failed_operations_++;
+    
+    json error_data;
+    error_data["error"] = message;
+    notify_subscribers(AsyncEvent(AsyncEvent::OPERATION_FAILED, task->operation_id, error_data));
 }
 
 void AsyncServiceLayer::cleanup_completed_operations() {
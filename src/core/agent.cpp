@@ -140,6 +140,49 @@ json Agent::execute_function(const std::string& function_name, const json& param
     }
 }
 
+json Agent::execute_function(const std::string& function_name, const json& params,
+                             std::shared_ptr<CancellationToken> cancel_token) {
+    if (!cancel_token) {
+        return execute_function(function_name, params);
+    }
+    
+    cancel_token->throw_if_cancelled();
+    json result;
+    {
+        CancellationToken::Scope scope(cancel_token);
+        result = execute_function(function_name, params);
+    }
+    
+    // Functions may turn an aborted call into an error result; report the
+    // cancellation instead. A function that merely finished late keeps its result.
+    if (cancel_token->interrupted()) {
+        cancel_token->throw_if_cancelled();
+    }
+    return result;
+}
+
+json Agent::execute_function_streaming(const std::string& function_name, const json& params,
+                                       const KolosalClient::TokenCallback& on_delta) {
+    TRACE_FUNCTION();
+    SCOPED_TIMER("function_execution_" + function_name);
+    
+    if (!running_.load()) {
+        LOG_ERROR_F("Agent '%s' is not running, cannot execute function '%s'", name_.c_str(), function_name.c_str());
+        throw std::runtime_error("Agent is not running");
+    }
+    
+    if (!supports_streaming(function_name)) {
+        throw std::invalid_argument("Function '" + function_name + "' does not support streaming");
+    }
+    
+    LOG_INFO_F("Agent '%s' executing function with streaming: %s", name_.c_str(), function_name.c_str());
+    return run_chat(params, on_delta);
+}
+
+bool Agent::supports_streaming(const std::string& function_name) const {
+    return function_name == "chat" && functions_.count(function_name) > 0;
+}
+
 void Agent::register_function(const std::string& name, std::function<json(const json&)> func) {
     TRACE_FUNCTION();
     
@@ -256,120 +299,124 @@ json Agent::create_research_function_response(const std::string& function_name,
     return response;
 }
 
-void Agent::setup_builtin_functions() {
-    TRACE_FUNCTION();
+json Agent::run_chat(const json& params, const KolosalClient::TokenCallback& on_delta) {
+    SCOPED_TIMER("chat_function");
     
-    LOG_DEBUG("Setting up builtin functions");
+    std::string message = params.value("message", "");
+    if (message.empty()) {
+        LOG_ERROR("Missing 'message' parameter in chat function");
+        throw std::runtime_error("Missing 'message' parameter");
+    }
     
-    // Basic chat function with model parameter support
-    register_function("chat", [this](const json& params) -> json {
-        SCOPED_TIMER("chat_function");
-        
-        std::string message = params.value("message", "");
-        if (message.empty()) {
-            LOG_ERROR("Missing 'message' parameter in chat function");
-            throw std::runtime_error("Missing 'message' parameter");
-        }
-        
-        std::string model_name = params.value("model", "");
-        if (model_name.empty()) {
-            LOG_ERROR("Missing 'model' parameter in chat function");
-            throw std::runtime_error("Missing 'model' parameter. Please specify which model to use.");
+    std::string model_name = params.value("model", "");
+    if (model_name.empty()) {
+        LOG_ERROR("Missing 'model' parameter in chat function");
+        throw std::runtime_error("Missing 'model' parameter. Please specify which model to use.");
+    }
+    
+    LOG_DEBUG_F("Chat function called with message: %s, model: %s", message.c_str(), model_name.c_str());
+    
+    // Check if context from tool execution is provided
+    std::string context = params.value("context", "");
+    json tool_results = params.value("tool_results", json::object());
+    
+    json response;
+    response["agent"] = name_;
+    response["timestamp"] = get_timestamp();
+    response["model_used"] = model_name;
+    response["system_prompt"] = get_combined_prompt();
+    
+    // Streams the reply through on_delta when the caller asked for it
+    auto ask_model = [&](const std::string& prompt) {
+        if (on_delta) {
+            return model_interface_->chat_with_model_stream(model_name, prompt, get_combined_prompt(), on_delta);
         }
-        
-        LOG_DEBUG_F("Chat function called with message: %s, model: %s", message.c_str(), model_name.c_str());
-        
-        // Check if context from tool execution is provided
-        std::string context = params.value("context", "");
-        json tool_results = params.value("tool_results", json::object());
-        
-        json response;
-        response["agent"] = name_;
-        response["timestamp"] = get_timestamp();
-        response["model_used"] = model_name;
-        response["system_prompt"] = get_combined_prompt();
-        
-        try {
-            // Check if model is available
-            LOG_DEBUG_F("Checking model availability: %s", model_name.c_str());
-            if (!model_interface_->is_model_available(model_name)) {
-                // Get available models for better error message
-                json available_models = model_interface_->get_available_models();
-                std::string error_msg = "Model '" + model_name + "' is not available. ";
-                
-                if (available_models.is_array() && !available_models.empty()) {
-                    error_msg += "Available models: ";
-                    for (const auto& model : available_models) {
-                        if (model.contains("model_id")) {
-                            error_msg += model["model_id"].get<std::string>() + " ";
-                        }
+        return model_interface_->chat_with_model(model_name, prompt, get_combined_prompt());
+    };
+    
+    try {
+        // Check if model is available
+        LOG_DEBUG_F("Checking model availability: %s", model_name.c_str());
+        if (!model_interface_->is_model_available(model_name)) {
+            // Get available models for better error message
+            json available_models = model_interface_->get_available_models();
+            std::string error_msg = "Model '" + model_name + "' is not available. ";
+            
+            if (available_models.is_array() && !available_models.empty()) {
+                error_msg += "Available models: ";
+                for (const auto& model : available_models) {
+                    if (model.contains("model_id")) {
+                        error_msg += model["model_id"].get<std::string>() + " ";
                     }
-                } else {
-                    error_msg += "No models are currently available.";
                 }
-                
-                LOG_WARN_F("Model not available: %s", error_msg.c_str());
-                
-                // Instead of throwing an error, provide a fallback response
-                response["response"] = "I apologize, but the specified model '" + model_name + "' is not currently available. " + error_msg;
-                response["status"] = "fallback";
-                response["error"] = error_msg;
-                return response;
-            }
-            
-            std::string ai_response;
-            
-            if (!context.empty()) {
-                LOG_DEBUG("Using enhanced context for AI response");
-                // Enhanced response with tool context
-                std::string enhanced_prompt = "Based on the following tool execution results, please provide a comprehensive response to the user's message.\n\n";
-                enhanced_prompt += "Tool Results:\n" + context + "\n\n";
-                enhanced_prompt += "User Message: " + message + "\n\n";
-                enhanced_prompt += "Please analyze the tool results and provide a helpful, informative response.";
-                
-                ai_response = model_interface_->chat_with_model(
-                    model_name, 
-                    enhanced_prompt, 
-                    get_combined_prompt()
-                );
-                
-                response["context_used"] = true;
-                response["tool_results_summary"] = tool_results;
             } else {
-                LOG_DEBUG("Direct chat with model");
-                // Direct chat with model
-                ai_response = model_interface_->chat_with_model(
-                    model_name, 
-                    message, 
-                    get_combined_prompt()
-                );
-                
-                response["context_used"] = false;
+                error_msg += "No models are currently available.";
             }
             
-            response["response"] = ai_response;
-            response["status"] = "success";
-            LOG_DEBUG_F("Chat response generated successfully (length: %zu)", ai_response.length());
+            LOG_WARN_F("Model not available: %s", error_msg.c_str());
             
-        } catch (const std::exception& e) {
-            LOG_ERROR_F("Chat function error: %s", e.what());
-            // Improved fallback response if model communication fails
-            std::string fallback_response = "I apologize, but I'm currently unable to connect to the specified model '" + model_name + "'. ";
-            fallback_response += "Error: " + std::string(e.what()) + "\n\n";
+            // Instead of throwing an error, provide a fallback response
+            response["response"] = "I apologize, but the specified model '" + model_name + "' is not currently available. " + error_msg;
+            response["status"] = "fallback";
+            response["error"] = error_msg;
+            return response;
+        }
+        
+        std::string ai_response;
+        
+        if (!context.empty()) {
+            LOG_DEBUG("Using enhanced context for AI response");
+            // Enhanced response with tool context
+            std::string enhanced_prompt = "Based on the following tool execution results, please provide a comprehensive response to the user's message.\n\n";
+            enhanced_prompt += "Tool Results:\n" + context + "\n\n";
+            enhanced_prompt += "User Message: " + message + "\n\n";
+            enhanced_prompt += "Please analyze the tool results and provide a helpful, informative response.";
             
-            if (!context.empty()) {
-                fallback_response += "However, I can provide information based on the tool execution results:\n" + context;
-            } else {
-                fallback_response += "You requested: " + message + "\n";
-                fallback_response += "While I cannot process this with the AI model right now, please check if the model is loaded and available, or try using a different model.";
-            }
+            ai_response = ask_model(enhanced_prompt);
             
-            response["response"] = fallback_response;
-            response["status"] = "fallback_success";  // Changed to indicate this is a fallback but still functional
-            response["error"] = e.what();
+            response["context_used"] = true;
+            response["tool_results_summary"] = tool_results;
+        } else {
+            LOG_DEBUG("Direct chat with model");
+            // Direct chat with model
+            ai_response = ask_model(message);
+            
+            response["context_used"] = false;
         }
         
-        return response;
+        response["response"] = ai_response;
+        response["status"] = "success";
+        LOG_DEBUG_F("Chat response generated successfully (length: %zu)", ai_response.length());
+        
+    } catch (const std::exception& e) {
+        LOG_ERROR_F("Chat function error: %s", e.what());
+        // Improved fallback response if model communication fails
+        std::string fallback_response = "I apologize, but I'm currently unable to connect to the specified model '" + model_name + "'. ";
+        fallback_response += "Error: " + std::string(e.what()) + "\n\n";
+        
+        if (!context.empty()) {
+            fallback_response += "However, I can provide information based on the tool execution results:\n" + context;
+        } else {
+            fallback_response += "You requested: " + message + "\n";
+            fallback_response += "While I cannot process this with the AI model right now, please check if the model is loaded and available, or try using a different model.";
+        }
+        
+        response["response"] = fallback_response;
+        response["status"] = "fallback_success";  // Changed to indicate this is a fallback but still functional
+        response["error"] = e.what();
+    }
+    
+    return response;
+}
+
+void Agent::setup_builtin_functions() {
+    TRACE_FUNCTION();
+    
+    LOG_DEBUG("Setting up builtin functions");
+    
+    // Basic chat function with model parameter support
+    register_function("chat", [this](const json& params) -> json {
+        return run_chat(params, nullptr);
     });
     
     // Analysis function with optional AI assistance
@@ -850,6 +850,19 @@ bool AgentConfigManager::load_from_file(const std::string& file_path) {
             config_.system.port = system_node["port"].as<int>(8080);
             config_.system.log_level = system_node["log_level"].as<std::string>("info");
             config_.system.max_concurrent_requests = system_node["max_concurrent_requests"].as<int>(100);
+            
+            if (system_node["http_server"]) {
+                auto http_node = system_node["http_server"];
+                config_.system.http_server.io_model = http_node["io_model"].as<std::string>("thread_per_connection");
+                config_.system.http_server.backlog = http_node["backlog"].as<int>(128);
+                config_.system.http_server.max_connections = http_node["max_connections"].as<int>(1024);
+                config_.system.http_server.io_threads = http_node["io_threads"].as<int>(2);
+                config_.system.http_server.worker_threads = http_node["worker_threads"].as<int>(0);
+                config_.system.http_server.keep_alive = http_node["keep_alive"].as<bool>(true);
+                config_.system.http_server.keep_alive_timeout_ms = http_node["keep_alive_timeout_ms"].as<int>(5000);
+                config_.system.http_server.max_requests_per_connection = http_node["max_requests_per_connection"].as<int>(100);
+                config_.system.http_server.max_event_streams = http_node["max_event_streams"].as<int>(256);
+            }
         }
         
         // Load system instruction
@@ -1123,6 +1136,17 @@ json AgentConfigManager::to_json() const {
     config_json["system"]["port"] = config_.system.port;
     config_json["system"]["log_level"] = config_.system.log_level;
     config_json["system"]["max_concurrent_requests"] = config_.system.max_concurrent_requests;
+    config_json["system"]["http_server"] = {
+        {"io_model", config_.system.http_server.io_model},
+        {"backlog", config_.system.http_server.backlog},
+        {"max_connections", config_.system.http_server.max_connections},
+        {"io_threads", config_.system.http_server.io_threads},
+        {"worker_threads", config_.system.http_server.worker_threads},
+        {"keep_alive", config_.system.http_server.keep_alive},
+        {"keep_alive_timeout_ms", config_.system.http_server.keep_alive_timeout_ms},
+        {"max_requests_per_connection", config_.system.http_server.max_requests_per_connection},
+        {"max_event_streams", config_.system.http_server.max_event_streams}
+    };
     
     // System instruction
     config_json["system_instruction"] = config_.system_instruction;
@@ -328,7 +328,8 @@ void AgentManager::stop_all_agents() {
 
 json AgentManager::execute_agent_function(const std::string& agent_id, 
                                           const std::string& function_name, 
-                                          const json& params) {
+                                          const json& params,
+                                          std::shared_ptr<CancellationToken> cancel_token) {
     auto agent = get_agent(agent_id);
     if (!agent) {
         throw std::runtime_error("Agent not found: " + agent_id);
@@ -344,7 +345,32 @@ json AgentManager::execute_agent_function(const std::string& agent_id,
         LOG_INFO_F("Agent '%s' started successfully", agent_id.c_str());
     }
     
-    return agent->execute_function(function_name, params);
+    return agent->execute_function(function_name, params, std::move(cancel_token));
+}
+
+json AgentManager::execute_agent_function_streaming(const std::string& agent_id,
+                                                    const std::string& function_name,
+                                                    const json& params,
+                                                    const KolosalClient::TokenCallback& on_delta) {
+    auto agent = get_agent(agent_id);
+    if (!agent) {
+        throw std::runtime_error("Agent not found: " + agent_id);
+    }
+    
+    if (!agent->is_running()) {
+        LOG_INFO_F("Agent '%s' is not running, attempting to start it", agent_id.c_str());
+        if (!agent->start()) {
+            LOG_ERROR_F("Failed to start agent '%s'", agent_id.c_str());
+            throw std::runtime_error("Failed to start agent: " + agent_id);
+        }
+    }
+    
+    return agent->execute_function_streaming(function_name, params, on_delta);
+}
+
+bool AgentManager::agent_supports_streaming(const std::string& agent_id, const std::string& function_name) {
+    auto agent = get_agent(agent_id);
+    return agent && agent->supports_streaming(function_name);
 }
 
 void AgentManager::load_model_configurations() {
@@ -6,6 +6,133 @@
 #include <thread>
 #include <sstream>
 #include <algorithm>
+#include <string_view>
+#include <future>
+
+namespace {
+
+// Builds the OpenAI-compatible message list shared by the chat calls
+json build_chat_messages(const std::string& message, const std::string& system_prompt) {
+    json messages = json::array();
+    if (!system_prompt.empty()) {
+        messages.push_back({{"role", "system"}, {"content", system_prompt}});
+    }
+    messages.push_back({{"role", "user"}, {"content", message}});
+    return messages;
+}
+
+// Extracts the generated text from a complete (non-streamed) chat response
+std::string extract_chat_content(const json& response) {
+    if (response.contains("choices") && response["choices"].is_array() && !response["choices"].empty()) {
+        const auto& first_choice = response["choices"][0];
+        if (first_choice.contains("message") && first_choice["message"].contains("content")) {
+            return first_choice["message"]["content"].get<std::string>();
+        }
+    }
+    if (response.contains("content") && response["content"].is_string()) {
+        return response["content"].get<std::string>();
+    }
+    return "";
+}
+
+// Extracts the text delta from one streamed chat chunk
+std::string extract_chat_delta(const json& chunk) {
+    if (chunk.contains("choices") && chunk["choices"].is_array() && !chunk["choices"].empty()) {
+        const auto& first_choice = chunk["choices"][0];
+        if (first_choice.contains("delta") && first_choice["delta"].contains("content") &&
+            first_choice["delta"]["content"].is_string()) {
+            return first_choice["delta"]["content"].get<std::string>();
+        }
+    }
+    return extract_chat_content(chunk);
+}
+
+// Reply text of a chat response, with the historical placeholder for unknown shapes
+std::string chat_reply_from_response(const json& response) {
+    // Parse OpenAI-compatible response
+    if (response.contains("choices") && response["choices"].is_array() && !response["choices"].empty()) {
+        const auto& first_choice = response["choices"][0];
+        if (first_choice.contains("message") && first_choice["message"].contains("content")) {
+            return first_choice["message"]["content"].get<std::string>();
+        }
+    }
+    
+    // Fallback: check if response has direct content
+    if (response.contains("content")) {
+        return response["content"].get<std::string>();
+    }
+    
+    LOG_WARN("Unexpected response format from chat endpoint");
+    return "Response received but in unexpected format";
+}
+
+json chat_request_body(const std::string& model_name, const std::string& message, const std::string& system_prompt) {
+    json request_data;
+    request_data["model"] = model_name;
+    request_data["messages"] = build_chat_messages(message, system_prompt);
+    return request_data;
+}
+
+json search_request_body(const std::string& query, int limit, const json& filters) {
+    json request_data;
+    request_data["query"] = query;
+    request_data["k"] = limit;  // Server expects 'k', not 'limit'
+    if (!filters.empty()) {
+        request_data["filters"] = filters;
+    }
+    return request_data;
+}
+
+// Recognises a 404 from the messages HttpClient and the server produce
+bool is_not_found_error(const std::string& error_msg) {
+    return error_msg.find("HTTP error 404") != std::string::npos ||
+           error_msg.find("Not found") != std::string::npos ||
+           error_msg.find("Resource not found") != std::string::npos;
+}
+
+json search_unavailable_response(const std::string& query) {
+    json mock_response;
+    mock_response["status"] = "search_not_available";
+    mock_response["message"] = "Internet search functionality is not available on this server";
+    mock_response["query"] = query;
+    mock_response["results"] = json::array();
+    mock_response["suggestion"] = "Please enable the internet search feature on the Kolosal server or use alternative research methods";
+    return mock_response;
+}
+
+std::string error_message(const std::exception_ptr& error) {
+    try {
+        std::rethrow_exception(error);
+    } catch (const std::exception& e) {
+        return e.what();
+    } catch (...) {
+        return "unknown error";
+    }
+}
+
+// Re-labels an asynchronous failure the way the blocking variant would
+std::exception_ptr wrap_error(const std::exception_ptr& error, const char* context, const char* prefix) {
+    std::string message = error_message(error);
+    LOG_ERROR_F("%s: %s", context, message.c_str());
+    return std::make_exception_ptr(std::runtime_error(prefix + message));
+}
+
+// Completion callback that fulfils a shared promise
+template <typename T>
+std::function<void(T, std::exception_ptr)> fulfil(std::shared_ptr<std::promise<T>> promise) {
+    return [promise](T result, std::exception_ptr error) {
+        if (error) {
+            promise->set_exception(error);
+        } else {
+            promise->set_value(std::move(result));
+        }
+    };
+}
+
+}  // namespace
+
+KolosalClient::KolosalClient() : KolosalClient(Config{}) {
+}
 
 KolosalClient::KolosalClient(const Config& config) : config_(config) {
     TRACE_FUNCTION();
@@ -31,47 +158,110 @@ KolosalClient::KolosalClient(const Config& config) : config_(config) {
 
 KolosalClient::~KolosalClient() {
     TRACE_FUNCTION();
+    
+    // Pending async callbacks touch the model cache; finish them first
+    http_client_.reset();
 }
 
 bool KolosalClient::is_model_available(const std::string& model_name) {
     TRACE_FUNCTION();
     
-    try {
-        auto models = get_available_models();
-        
-        if (models.is_array()) {
-            for (const auto& model : models) {
-                if (model.contains("model_id") && model["model_id"] == model_name) {
-                    return true;
-                }
-                if (model.contains("id") && model["id"] == model_name) {
-                    return true;
-                }
-                if (model.contains("name") && model["name"] == model_name) {
-                    return true;
-                }
-            }
-        }
-        
-        return false;
-    } catch (const std::exception& e) {
-        LOG_ERROR_F("Failed to check model availability: %s", e.what());
-        return false;
-    }
+    refresh_model_catalogue();
+    
+    std::lock_guard<std::mutex> lock(model_cache_mutex_);
+    return model_lookup_.find(model_name) != model_lookup_.end();
 }
 
 json KolosalClient::get_available_models() {
     TRACE_FUNCTION();
-    SCOPED_TIMER("get_available_models");
     
+    refresh_model_catalogue();
+    
+    std::lock_guard<std::mutex> lock(model_cache_mutex_);
+    return models_cached_ ? cached_models_ : json::array();
+}
+
+void KolosalClient::invalidate_model_cache() {
+    std::lock_guard<std::mutex> lock(model_cache_mutex_);
+    models_cached_ = false;
+    cached_models_ = json();
+    model_lookup_.clear();
+}
+
+void KolosalClient::refresh_model_catalogue() {
+    auto ttl = std::chrono::seconds(config_.model_cache_ttl_seconds);
+    
+    {
+        std::lock_guard<std::mutex> lock(model_cache_mutex_);
+        if (models_cached_ && ttl.count() > 0) {
+            if (std::chrono::steady_clock::now() - models_fetched_at_ < ttl) {
+                return;
+            }
+            // Keep serving the stale catalogue while one request refreshes it
+            if (!models_refreshing_.exchange(true)) {
+                make_request_async("GET", "/models", json::object(), [this](json models, std::exception_ptr error) {
+                    if (error) {
+                        LOG_WARN_F("Background model catalogue refresh failed: %s", error_message(error).c_str());
+                    } else {
+                        store_model_catalogue(std::move(models));
+                    }
+                    models_refreshing_ = false;
+                });
+            }
+            return;
+        }
+    }
+    
+    // Cold cache: fetch once, other callers wait for the result
+    std::lock_guard<std::mutex> fetch_lock(model_fetch_mutex_);
+    if (ttl.count() > 0) {
+        std::lock_guard<std::mutex> lock(model_cache_mutex_);
+        if (models_cached_) {
+            return;
+        }
+    }
+    
+    SCOPED_TIMER("get_available_models");
     try {
-        return make_request_with_retry("GET", "/models");
+        store_model_catalogue(make_request_with_retry("GET", "/models"));
     } catch (const std::exception& e) {
         LOG_ERROR_F("Failed to get available models: %s", e.what());
-        return json::array();
     }
 }
 
+void KolosalClient::store_model_catalogue(json models) {
+    std::unordered_map<std::string, size_t> lookup;
+    if (models.is_array()) {
+        auto add_key = [&](const json& key, size_t index) {
+            if (key.is_string()) {
+                lookup.emplace(key.get<std::string>(), index);
+            }
+        };
+        for (size_t i = 0; i < models.size(); ++i) {
+            const auto& model = models[i];
+            if (!model.is_object()) {
+                continue;
+            }
+            for (const char* field : {"model_id", "id", "name"}) {
+                if (model.contains(field)) {
+                    add_key(model[field], i);
+                }
+            }
+            if (model.contains("aliases") && model["aliases"].is_array()) {
+                for (const auto& alias : model["aliases"]) {
+                    add_key(alias, i);
+                }
+            }
+        }
+    }
+    
+    std::lock_guard<std::mutex> lock(model_cache_mutex_);
+    cached_models_ = std::move(models);
+    model_lookup_ = std::move(lookup);
+    models_fetched_at_ = std::chrono::steady_clock::now();
+    models_cached_ = true;
+}
+
 std::string KolosalClient::chat_with_model(const std::string& model_name, 
                                           const std::string& message, 
                                           const std::string& system_prompt) {
@@ -79,44 +269,116 @@ std::string KolosalClient::chat_with_model(const std::string& model_name,
     SCOPED_TIMER("chat_with_model");
     
     try {
-        json request_data;
-        request_data["model"] = model_name;
-        request_data["messages"] = json::array();
+        auto response = make_request_with_retry("POST", "/chat/completions",
+                                                chat_request_body(model_name, message, system_prompt));
+        return chat_reply_from_response(response);
         
-        if (!system_prompt.empty()) {
-            json system_msg;
-            system_msg["role"] = "system";
-            system_msg["content"] = system_prompt;
-            request_data["messages"].push_back(system_msg);
+    } catch (const std::exception& e) {
+        LOG_ERROR_F("Chat request failed: %s", e.what());
+        if (is_not_found_error(e.what())) {
+            invalidate_model_cache();  // The model may have been unloaded
         }
+        throw std::runtime_error("Failed to communicate with model: " + std::string(e.what()));
+    }
+}
+
+std::string KolosalClient::chat_with_model_stream(const std::string& model_name,
+                                                 const std::string& message,
+                                                 const std::string& system_prompt,
+                                                 const TokenCallback& on_delta) {
+    TRACE_FUNCTION();
+    SCOPED_TIMER("chat_with_model_stream");
+    
+    if (!http_client_) {
+        throw std::runtime_error("HTTP client not initialized");
+    }
+    
+    json request_data = chat_request_body(model_name, message, system_prompt);
+    request_data["stream"] = true;
+    
+    std::string full_response;
+    std::string pending;    // Bytes of an incomplete line
+    std::string raw_body;   // Whole body, in case the server did not stream
+    bool saw_event = false;
+    bool done = false;
+    
+    auto on_chunk = [&](const char* data, size_t size) -> bool {
+        if (!saw_event) {
+            raw_body.append(data, size);
+        }
+        pending.append(data, size);
         
-        json user_msg;
-        user_msg["role"] = "user";
-        user_msg["content"] = message;
-        request_data["messages"].push_back(user_msg);
-        
-        auto response = make_request_with_retry("POST", "/chat/completions", request_data);
-        
-        // Parse OpenAI-compatible response
-        if (response.contains("choices") && response["choices"].is_array() && !response["choices"].empty()) {
-            const auto& first_choice = response["choices"][0];
-            if (first_choice.contains("message") && first_choice["message"].contains("content")) {
-                return first_choice["message"]["content"].get<std::string>();
+        size_t line_start = 0;
+        size_t line_end;
+        while (!done && (line_end = pending.find('\n', line_start)) != std::string::npos) {
+            std::string_view line(pending.data() + line_start, line_end - line_start);
+            line_start = line_end + 1;
+            if (!line.empty() && line.back() == '\r') {
+                line.remove_suffix(1);
+            }
+            if (line.substr(0, 5) != "data:") {
+                continue;  // Blank separators, comments and other SSE fields
+            }
+            saw_event = true;
+            raw_body.clear();
+            
+            std::string_view payload = line.substr(5);
+            if (!payload.empty() && payload.front() == ' ') {
+                payload.remove_prefix(1);
+            }
+            if (payload == "[DONE]") {
+                done = true;
+                break;
+            }
+            
+            try {
+                std::string delta = extract_chat_delta(json::parse(payload));
+                if (!delta.empty()) {
+                    full_response += delta;
+                    if (!on_delta(delta)) {
+                        return false;
+                    }
+                }
+            } catch (const json::parse_error& e) {
+                LOG_WARN_F("Skipping malformed stream chunk: %s", e.what());
             }
         }
-        
-        // Fallback: check if response has direct content
-        if (response.contains("content")) {
-            return response["content"].get<std::string>();
+        pending.erase(0, line_start);
+        return !done;
+    };
+    
+    auto result = http_client_->stream_request("POST", "/chat/completions", request_data.dump(), on_chunk);
+    
+    if (result.cancelled) {
+        throw std::runtime_error(result.error_message);
+    }
+    
+    // Stopping after [DONE] or at the receiver's request ends the transfer early
+    if (result.status_code == 499) {
+        return full_response;
+    }
+    if (!result.is_success()) {
+        LOG_ERROR_F("Streaming chat request failed: %s", result.error_message.c_str());
+        if (result.status_code == 404) {
+            invalidate_model_cache();
+        }
+        throw std::runtime_error("Failed to communicate with model: " + result.error_message);
+    }
+    
+    if (!saw_event) {
+        // Server ignored "stream": the body is an ordinary chat response
+        try {
+            full_response = extract_chat_content(json::parse(raw_body));
+        } catch (const json::parse_error& e) {
+            LOG_ERROR_F("Failed to parse JSON response: %s", e.what());
+            throw std::runtime_error("Invalid JSON response from server");
+        }
+        if (!full_response.empty()) {
+            on_delta(full_response);
         }
-        
-        LOG_WARN("Unexpected response format from chat endpoint");
-        return "Response received but in unexpected format";
-        
-    } catch (const std::exception& e) {
-        LOG_ERROR_F("Chat request failed: %s", e.what());
-        throw std::runtime_error("Failed to communicate with model: " + std::string(e.what()));
     }
+    
+    return full_response;
 }
 
 json KolosalClient::completion_request(const std::string& model_name, 
@@ -161,14 +423,7 @@ json KolosalClient::search_documents(const std::string& query,
     SCOPED_TIMER("search_documents");
     
     try {
-        json request_data;
-        request_data["query"] = query;
-        request_data["k"] = limit;  // Server expects 'k', not 'limit'
-        if (!filters.empty()) {
-            request_data["filters"] = filters;
-        }
-        
-        return make_request_with_retry("POST", "/retrieve", request_data);
+        return make_request_with_retry("POST", "/retrieve", search_request_body(query, limit, filters));
     } catch (const std::exception& e) {
         LOG_ERROR_F("Failed to search documents: %s", e.what());
         throw std::runtime_error("Failed to search documents: " + std::string(e.what()));
@@ -218,19 +473,9 @@ json KolosalClient::internet_search(const std::string& query, int num_results) {
         std::string error_msg = e.what();
         
         // Check if this is a 404 error indicating search functionality is not available
-        if (error_msg.find("HTTP error 404") != std::string::npos || 
-            error_msg.find("Not found") != std::string::npos) {
+        if (is_not_found_error(error_msg)) {
             LOG_WARN_F("Internet search endpoint not available on server: %s", error_msg.c_str());
-            
-            // Return a mock response indicating search is not available
-            json mock_response;
-            mock_response["status"] = "search_not_available";
-            mock_response["message"] = "Internet search functionality is not available on this server";
-            mock_response["query"] = query;
-            mock_response["results"] = json::array();
-            mock_response["suggestion"] = "Please enable the internet search feature on the Kolosal server or use alternative research methods";
-            
-            return mock_response;
+            return search_unavailable_response(query);
         }
         
         LOG_ERROR_F("Failed to perform internet search: %s", error_msg.c_str());
@@ -238,6 +483,127 @@ json KolosalClient::internet_search(const std::string& query, int num_results) {
     }
 }
 
+void KolosalClient::chat_with_model_async(const std::string& model_name,
+                                          const std::string& message,
+                                          const std::string& system_prompt,
+                                          TextCallback on_complete) {
+    TRACE_FUNCTION();
+    
+    make_request_async("POST", "/chat/completions", chat_request_body(model_name, message, system_prompt),
+        [this, on_complete = std::move(on_complete)](json response, std::exception_ptr error) {
+            if (error) {
+                if (is_not_found_error(error_message(error))) {
+                    invalidate_model_cache();
+                }
+                on_complete("", wrap_error(error, "Chat request failed", "Failed to communicate with model: "));
+                return;
+            }
+            std::string reply;
+            try {
+                reply = chat_reply_from_response(response);
+            } catch (...) {
+                on_complete("", wrap_error(std::current_exception(), "Chat request failed", "Failed to communicate with model: "));
+                return;
+            }
+            on_complete(std::move(reply), nullptr);
+        });
+}
+
+std::future<std::string> KolosalClient::chat_with_model_async(const std::string& model_name,
+                                                             const std::string& message,
+                                                             const std::string& system_prompt) {
+    auto promise = std::make_shared<std::promise<std::string>>();
+    auto future = promise->get_future();
+    chat_with_model_async(model_name, message, system_prompt, fulfil(promise));
+    return future;
+}
+
+void KolosalClient::completion_request_async(const std::string& model_name,
+                                             const std::string& prompt,
+                                             const json& params,
+                                             JsonCallback on_complete) {
+    TRACE_FUNCTION();
+    
+    json request_data = params;
+    request_data["model"] = model_name;
+    request_data["prompt"] = prompt;
+    
+    make_request_async("POST", "/completions", request_data,
+        [on_complete = std::move(on_complete)](json response, std::exception_ptr error) {
+            if (error) {
+                on_complete(nullptr, wrap_error(error, "Completion request failed", "Failed to get completion from model: "));
+                return;
+            }
+            on_complete(std::move(response), nullptr);
+        });
+}
+
+std::future<json> KolosalClient::completion_request_async(const std::string& model_name,
+                                                         const std::string& prompt,
+                                                         const json& params) {
+    auto promise = std::make_shared<std::promise<json>>();
+    auto future = promise->get_future();
+    completion_request_async(model_name, prompt, params, fulfil(promise));
+    return future;
+}
+
+void KolosalClient::search_documents_async(const std::string& query,
+                                           int limit,
+                                           const json& filters,
+                                           JsonCallback on_complete) {
+    TRACE_FUNCTION();
+    
+    make_request_async("POST", "/retrieve", search_request_body(query, limit, filters),
+        [on_complete = std::move(on_complete)](json response, std::exception_ptr error) {
+            if (error) {
+                on_complete(nullptr, wrap_error(error, "Failed to search documents", "Failed to search documents: "));
+                return;
+            }
+            on_complete(std::move(response), nullptr);
+        });
+}
+
+std::future<json> KolosalClient::search_documents_async(const std::string& query,
+                                                       int limit,
+                                                       const json& filters) {
+    auto promise = std::make_shared<std::promise<json>>();
+    auto future = promise->get_future();
+    search_documents_async(query, limit, filters, fulfil(promise));
+    return future;
+}
+
+void KolosalClient::internet_search_async(const std::string& query,
+                                          int num_results,
+                                          JsonCallback on_complete) {
+    TRACE_FUNCTION();
+    
+    json request_data;
+    request_data["query"] = query;
+    request_data["num_results"] = num_results;
+    
+    make_request_async("POST", "/search", request_data,
+        [query, on_complete = std::move(on_complete)](json response, std::exception_ptr error) {
+            if (!error) {
+                on_complete(std::move(response), nullptr);
+                return;
+            }
+            std::string error_msg = error_message(error);
+            if (is_not_found_error(error_msg)) {
+                LOG_WARN_F("Internet search endpoint not available on server: %s", error_msg.c_str());
+                on_complete(search_unavailable_response(query), nullptr);
+                return;
+            }
+            on_complete(nullptr, wrap_error(error, "Failed to perform internet search", "Failed to perform internet search: "));
+        });
+}
+
+std::future<json> KolosalClient::internet_search_async(const std::string& query, int num_results) {
+    auto promise = std::make_shared<std::promise<json>>();
+    auto future = promise->get_future();
+    internet_search_async(query, num_results, fulfil(promise));
+    return future;
+}
+
 bool KolosalClient::is_server_healthy() {
     TRACE_FUNCTION();
     
@@ -290,6 +656,9 @@ void KolosalClient::update_config(const Config& new_config) {
         http_client_->update_config(http_config);
     }
     
+    // A different server has a different catalogue
+    invalidate_model_cache();
+    
     LOG_INFO_F("KolosalClient configuration updated, server URL: %s", config_.server_url.c_str());
 }
 
@@ -339,6 +708,43 @@ json KolosalClient::make_request(const std::string& method,
     }
 }
 
+void KolosalClient::make_request_async(const std::string& method,
+                                       const std::string& endpoint,
+                                       const json& data,
+                                       JsonCallback on_complete) {
+    if (!http_client_) {
+        on_complete(nullptr, std::make_exception_ptr(std::runtime_error("HTTP client not initialized")));
+        return;
+    }
+    
+    std::string body;
+    if (!data.empty()) {
+        body = data.dump();
+    }
+    
+    // Retries, backoff and error mapping happen inside the HttpClient event loop
+    http_client_->request_async(method, endpoint, body, {},
+        [on_complete = std::move(on_complete)](HttpClient::Result result) {
+            if (!result.is_success()) {
+                on_complete(nullptr, std::make_exception_ptr(std::runtime_error(result.error_message)));
+                return;
+            }
+            if (result.body.empty()) {
+                on_complete(json::object(), nullptr);
+                return;
+            }
+            json parsed;
+            try {
+                parsed = json::parse(result.body);
+            } catch (const json::parse_error& e) {
+                LOG_ERROR_F("Failed to parse JSON response: %s", e.what());
+                on_complete(nullptr, std::make_exception_ptr(std::runtime_error("Invalid JSON response from server")));
+                return;
+            }
+            on_complete(std::move(parsed), nullptr);
+        });
+}
+
 json KolosalClient::make_request_with_retry(const std::string& method,
                                            const std::string& endpoint,
                                            const json& data,
@@ -0,0 +1,538 @@
+#include "hnsw_index.hpp"
+#include "index_io.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <thread>
+
+namespace kolosal {
+
+namespace {
+    // Nodes seen by the current search of this thread; bumping the epoch
+    // clears the marks without touching them
+    struct VisitedMarks {
+        std::vector<uint32_t> marks;
+        uint32_t epoch = 0;
+
+        void begin(size_t nodes) {
+            if (marks.size() < nodes) {
+                marks.resize(nodes, 0);
+            }
+            if (++epoch == 0) {
+                std::fill(marks.begin(), marks.end(), 0);
+                epoch = 1;
+            }
+        }
+
+        bool visit(uint32_t node) {
+            if (marks[node] == epoch) {
+                return false;
+            }
+            marks[node] = epoch;
+            return true;
+        }
+    };
+
+    VisitedMarks& visited_marks() {
+        thread_local VisitedMarks marks;
+        return marks;
+    }
+
+    // Rebuild once tombstones outnumber live nodes, but not for tiny indexes
+    constexpr size_t MIN_TOMBSTONES_FOR_REBUILD = 1024;
+
+    constexpr uint32_t HNSW_INDEX_TAG = 0x57534E48;  // "HNSW"
+    constexpr int MAX_LEVEL = 64;
+}
+
+HnswIndex::HnswIndex(size_t dimension) : HnswIndex(dimension, Config{}) {
+}
+
+HnswIndex::HnswIndex(size_t dimension, const Config& config)
+    : dimension_(0), stride_(0), config_(config),
+      link_locks_(new std::mutex[LOCK_STRIPES]),
+      level_generator_(config.seed), dot_(vector_kernels::dot_product()) {
+    config_.M = std::max<size_t>(2, config_.M);
+    config_.ef_construction = std::max(config_.ef_construction, config_.M);
+    max_links_ = config_.M;
+    max_links0_ = 2 * config_.M;
+    level_multiplier_ = 1.0 / std::log(static_cast<double>(config_.M));
+    set_dimension(dimension);
+}
+
+void HnswIndex::set_dimension(size_t dimension) {
+    dimension_ = dimension;
+    stride_ = vector_kernels::padded_dimension(dimension);
+}
+
+HnswIndex::NodeId* HnswIndex::links(NodeId node, int level) {
+    if (level == 0) {
+        return links0_.data() + static_cast<size_t>(node) * (max_links0_ + 1);
+    }
+    return upper_links_[node].data() + static_cast<size_t>(level - 1) * (max_links_ + 1);
+}
+
+const HnswIndex::NodeId* HnswIndex::links(NodeId node, int level) const {
+    return const_cast<HnswIndex*>(this)->links(node, level);
+}
+
+void HnswIndex::copy_links(NodeId node, int level, std::vector<NodeId>& out) const {
+    std::unique_lock<std::mutex> lock;
+    if (concurrent_) {
+        lock = std::unique_lock<std::mutex>(link_locks_[node % LOCK_STRIPES]);
+    }
+    const NodeId* list = links(node, level);
+    out.assign(list + 1, list + 1 + list[0]);
+}
+
+int HnswIndex::random_level() {
+    std::lock_guard<std::mutex> lock(level_mutex_);
+    std::uniform_real_distribution<double> uniform(std::numeric_limits<double>::min(), 1.0);
+    return static_cast<int>(-std::log(uniform(level_generator_)) * level_multiplier_);
+}
+
+void HnswIndex::reserve(size_t count) {
+    if (count <= capacity_) {
+        return;
+    }
+    // At least doubling keeps per-batch reserves amortised
+    capacity_ = std::max(count, capacity_ * 2);
+    data_.resize(capacity_ * stride_);
+    links0_.resize(capacity_ * (max_links0_ + 1), 0);
+    upper_links_.resize(capacity_);
+    levels_.resize(capacity_, 0);
+    deleted_.resize(capacity_, 0);
+    ids_.resize(capacity_);
+    nodes_by_id_.reserve(capacity_);
+}
+
+HnswIndex::NodeId HnswIndex::allocate_node(const std::string& id, const std::vector<float>& vector, int level) {
+    if (node_count_ == capacity_) {
+        reserve(std::max<size_t>(64, capacity_ * 2));
+    }
+    NodeId node = static_cast<NodeId>(node_count_++);
+    vector_kernels::normalize_into(vector.data(), dimension_, data_.data() + static_cast<size_t>(node) * stride_);
+    levels_[node] = level;
+    upper_links_[node].assign(static_cast<size_t>(level) * (max_links_ + 1), 0);
+    ids_[node] = id;
+
+    // A replaced vector leaves a tombstone behind
+    auto [it, inserted] = nodes_by_id_.emplace(id, node);
+    if (!inserted) {
+        deleted_[it->second] = 1;
+        it->second = node;
+    }
+    return node;
+}
+
+bool HnswIndex::add(const std::string& id, const std::vector<float>& vector) {
+    if (vector.empty()) {
+        return false;
+    }
+    if (dimension_ == 0 && node_count_ == 0) {
+        set_dimension(vector.size());
+    }
+    if (vector.size() != dimension_ || node_count_ >= NO_NODE) {
+        return false;
+    }
+    link_node(allocate_node(id, vector, random_level()));
+    return true;
+}
+
+std::vector<bool> HnswIndex::add_batch(const std::vector<std::string>& ids,
+                                       const std::vector<std::vector<float>>& vectors, size_t threads) {
+    std::vector<bool> added(ids.size(), false);
+    if (dimension_ == 0 && node_count_ == 0) {
+        for (size_t i = 0; i < ids.size() && i < vectors.size(); ++i) {
+            if (!vectors[i].empty()) {
+                set_dimension(vectors[i].size());
+                break;
+            }
+        }
+    }
+
+    // Nodes are allocated up front, so the buffers do not move while the
+    // graph is linked on several threads
+    reserve(node_count_ + ids.size());
+    std::vector<NodeId> nodes;
+    nodes.reserve(ids.size());
+    for (size_t i = 0; i < ids.size() && i < vectors.size(); ++i) {
+        if (vectors[i].size() == dimension_ && dimension_ > 0 && node_count_ < NO_NODE) {
+            nodes.push_back(allocate_node(ids[i], vectors[i], random_level()));
+            added[i] = true;
+        }
+    }
+
+    if (threads == 0) {
+        threads = config_.build_threads > 0 ? config_.build_threads : std::thread::hardware_concurrency();
+    }
+    threads = std::max<size_t>(1, std::min(threads, nodes.size() / 64));
+    if (threads == 1) {
+        for (NodeId node : nodes) {
+            link_node(node);
+        }
+        return added;
+    }
+
+    // The first node is linked alone so every worker finds an entry point
+    link_node(nodes.front());
+    concurrent_ = true;
+    std::atomic<size_t> next{1};
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([this, &nodes, &next] {
+            for (size_t i = next++; i < nodes.size(); i = next++) {
+                link_node(nodes[i]);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    concurrent_ = false;
+    return added;
+}
+
+void HnswIndex::link_node(NodeId node) {
+    const int level = levels_[node];
+    std::unique_lock<std::mutex> entry_lock(entry_mutex_);
+    NodeId entry = entry_point_;
+    const int top = max_level_;
+    if (entry == NO_NODE) {
+        entry_point_ = node;
+        max_level_ = level;
+        return;
+    }
+    // A node that becomes the new top keeps the lock until it is the entry point
+    if (level <= top) {
+        entry_lock.unlock();
+    }
+
+    const float* query = row(node);
+    NodeId current = greedy_closest(query, entry, top, level + 1);
+    for (int layer = std::min(level, top); layer >= 0; --layer) {
+        std::vector<Candidate> candidates = search_layer(query, current, config_.ef_construction, layer, false);
+        candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+                                        [node](const Candidate& c) { return c.node == node; }),
+                         candidates.end());
+        if (candidates.empty()) {
+            continue;
+        }
+        current = candidates.front().node;
+        std::vector<NodeId> neighbors = select_neighbors(std::move(candidates), max_links_);
+        {
+            std::unique_lock<std::mutex> lock;
+            if (concurrent_) {
+                lock = std::unique_lock<std::mutex>(link_locks_[node % LOCK_STRIPES]);
+            }
+            NodeId* list = links(node, layer);
+            list[0] = static_cast<NodeId>(neighbors.size());
+            std::copy(neighbors.begin(), neighbors.end(), list + 1);
+        }
+        for (NodeId neighbor : neighbors) {
+            connect(neighbor, node, layer);
+        }
+    }
+
+    if (level > top) {
+        entry_point_ = node;
+        max_level_ = level;
+    }
+}
+
+void HnswIndex::connect(NodeId from, NodeId to, int level) {
+    std::unique_lock<std::mutex> lock;
+    if (concurrent_) {
+        lock = std::unique_lock<std::mutex>(link_locks_[from % LOCK_STRIPES]);
+    }
+    NodeId* list = links(from, level);
+    const size_t capacity = link_capacity(level);
+    if (std::find(list + 1, list + 1 + list[0], to) != list + 1 + list[0]) {
+        return;
+    }
+    if (list[0] < capacity) {
+        list[1 + list[0]++] = to;
+        return;
+    }
+
+    // Full: keep the most diverse of the old links plus the new one
+    std::vector<Candidate> candidates;
+    candidates.reserve(capacity + 1);
+    const float* origin = row(from);
+    for (size_t i = 1; i <= list[0]; ++i) {
+        candidates.push_back(Candidate{distance(origin, list[i]), list[i]});
+    }
+    candidates.push_back(Candidate{distance(origin, to), to});
+    std::sort(candidates.begin(), candidates.end());
+    std::vector<NodeId> kept = select_neighbors(std::move(candidates), capacity);
+    list[0] = static_cast<NodeId>(kept.size());
+    std::copy(kept.begin(), kept.end(), list + 1);
+}
+
+std::vector<HnswIndex::NodeId> HnswIndex::select_neighbors(std::vector<Candidate> candidates, size_t limit) const {
+    // Candidates arrive closest first. One is kept unless it is closer to an
+    // already kept neighbour than to the origin, which spreads links out
+    std::vector<NodeId> selected;
+    selected.reserve(limit);
+    if (candidates.size() <= limit) {
+        for (const auto& candidate : candidates) {
+            selected.push_back(candidate.node);
+        }
+        return selected;
+    }
+    for (const auto& candidate : candidates) {
+        if (selected.size() >= limit) {
+            break;
+        }
+        bool diverse = true;
+        for (NodeId kept : selected) {
+            if (distance(row(candidate.node), kept) < candidate.distance) {
+                diverse = false;
+                break;
+            }
+        }
+        if (diverse) {
+            selected.push_back(candidate.node);
+        }
+    }
+    return selected;
+}
+
+HnswIndex::NodeId HnswIndex::greedy_closest(const float* query, NodeId entry, int from_level, int to_level) const {
+    NodeId current = entry;
+    float current_distance = distance(query, current);
+    std::vector<NodeId> neighbors;
+    for (int level = from_level; level >= to_level; --level) {
+        bool improved = true;
+        while (improved) {
+            improved = false;
+            copy_links(current, level, neighbors);
+            for (NodeId neighbor : neighbors) {
+                float d = distance(query, neighbor);
+                if (d < current_distance) {
+                    current_distance = d;
+                    current = neighbor;
+                    improved = true;
+                }
+            }
+        }
+    }
+    return current;
+}
+
+std::vector<HnswIndex::Candidate> HnswIndex::search_layer(const float* query, NodeId entry, size_t ef, int level,
+                                                          bool skip_deleted) const {
+    VisitedMarks& visited = visited_marks();
+    visited.begin(node_count_);
+
+    // To expand, closest first; and the best ef found, farthest on top
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> frontier;
+    std::priority_queue<Candidate> best;
+
+    Candidate start{distance(query, entry), entry};
+    visited.visit(entry);
+    frontier.push(start);
+    if (!(skip_deleted && deleted_[entry])) {
+        best.push(start);
+    }
+    float bound = best.empty() ? std::numeric_limits<float>::max() : start.distance;
+
+    std::vector<NodeId> neighbors;
+    while (!frontier.empty()) {
+        Candidate current = frontier.top();
+        if (current.distance > bound && best.size() >= ef) {
+            break;
+        }
+        frontier.pop();
+
+        copy_links(current.node, level, neighbors);
+        for (NodeId neighbor : neighbors) {
+            if (!visited.visit(neighbor)) {
+                continue;
+            }
+            float d = distance(query, neighbor);
+            if (best.size() < ef || d < bound) {
+                frontier.push(Candidate{d, neighbor});
+                if (!(skip_deleted && deleted_[neighbor])) {
+                    best.push(Candidate{d, neighbor});
+                    if (best.size() > ef) {
+                        best.pop();
+                    }
+                }
+                if (!best.empty()) {
+                    bound = best.top().distance;
+                }
+            }
+        }
+    }
+
+    std::vector<Candidate> result(best.size());
+    for (size_t i = result.size(); i-- > 0; best.pop()) {
+        result[i] = best.top();
+    }
+    return result;
+}
+
+std::vector<HnswIndex::Hit> HnswIndex::search(const std::vector<float>& query, size_t k, float threshold) const {
+    if (k == 0 || nodes_by_id_.empty() || query.size() != dimension_) {
+        return {};
+    }
+
+    vector_kernels::AlignedFloats normalized(stride_);
+    vector_kernels::normalize_into(query.data(), dimension_, normalized.data());
+
+    NodeId entry = greedy_closest(normalized.data(), entry_point_, max_level_, 1);
+    std::vector<Candidate> candidates = search_layer(normalized.data(), entry,
+                                                     std::max(config_.ef_search, k), 0, true);
+    std::vector<Hit> hits;
+    for (const auto& candidate : candidates) {
+        float score = 1.0f - candidate.distance;
+        if (hits.size() == k || score < threshold) {
+            break;
+        }
+        hits.push_back(Hit{ids_[candidate.node], score});
+    }
+    return hits;
+}
+
+bool HnswIndex::remove(const std::string& id) {
+    auto it = nodes_by_id_.find(id);
+    if (it == nodes_by_id_.end()) {
+        return false;
+    }
+    deleted_[it->second] = 1;
+    nodes_by_id_.erase(it);
+
+    if (tombstones() >= MIN_TOMBSTONES_FOR_REBUILD && tombstones() > nodes_by_id_.size()) {
+        rebuild();
+    }
+    return true;
+}
+
+void HnswIndex::rebuild() {
+    std::vector<std::string> ids;
+    std::vector<std::vector<float>> vectors;
+    ids.reserve(nodes_by_id_.size());
+    vectors.reserve(nodes_by_id_.size());
+    for (NodeId node = 0; node < node_count_; ++node) {
+        if (!deleted_[node]) {
+            ids.push_back(std::move(ids_[node]));
+            vectors.emplace_back(row(node), row(node) + dimension_);
+        }
+    }
+    size_t dimension = dimension_;
+    clear();
+    set_dimension(dimension);
+    add_batch(ids, vectors, 0);
+}
+
+void HnswIndex::clear() {
+    node_count_ = 0;
+    capacity_ = 0;
+    data_.clear();
+    links0_.clear();
+    upper_links_.clear();
+    levels_.clear();
+    deleted_.clear();
+    ids_.clear();
+    nodes_by_id_.clear();
+    entry_point_ = NO_NODE;
+    max_level_ = -1;
+}
+
+void HnswIndex::serialize(std::string& out) const {
+    index_io::Writer writer(out);
+    writer.put<uint32_t>(HNSW_INDEX_TAG);
+    writer.put<uint64_t>(config_.M);
+    writer.put<uint64_t>(dimension_);
+    writer.put<uint64_t>(node_count_);
+    writer.put<uint32_t>(entry_point_);
+    writer.put<int32_t>(max_level_);
+    for (NodeId node = 0; node < node_count_; ++node) {
+        writer.put_string(ids_[node]);
+    }
+    writer.put_array(deleted_, node_count_);
+    writer.put_array(levels_, node_count_);
+    writer.put_array(data_, node_count_ * stride_);
+    writer.put_array(links0_, node_count_ * (max_links0_ + 1));
+    for (NodeId node = 0; node < node_count_; ++node) {
+        writer.put_bytes(upper_links_[node].data(), upper_links_[node].size() * sizeof(NodeId));
+    }
+}
+
+bool HnswIndex::deserialize(const char* data, size_t size) {
+    clear();
+    index_io::Reader reader(data, size);
+    uint32_t tag, entry_point;
+    uint64_t m, dimension, count;
+    int32_t max_level;
+    if (!reader.get(tag) || tag != HNSW_INDEX_TAG || !reader.get(m) || m < 2 || !reader.get(dimension) ||
+        !reader.get(count) || count > size || count >= NO_NODE || !reader.get(entry_point) ||
+        !reader.get(max_level)) {
+        return false;
+    }
+
+    // The link layout follows the M the graph was built with
+    config_.M = static_cast<size_t>(m);
+    max_links_ = config_.M;
+    max_links0_ = 2 * config_.M;
+    level_multiplier_ = 1.0 / std::log(static_cast<double>(config_.M));
+    set_dimension(static_cast<size_t>(dimension));
+
+    auto fail = [this] {
+        clear();
+        return false;
+    };
+    const size_t nodes = static_cast<size_t>(count);
+    reserve(nodes);
+    node_count_ = nodes;
+    for (size_t node = 0; node < nodes; ++node) {
+        if (!reader.get_string(ids_[node])) {
+            return fail();
+        }
+    }
+    if (!reader.get_array(deleted_, nodes) || !reader.get_array(levels_, nodes) ||
+        !reader.get_array(data_, nodes * stride_) || !reader.get_array(links0_, nodes * (max_links0_ + 1))) {
+        return fail();
+    }
+    capacity_ = nodes;
+    for (size_t node = 0; node < nodes; ++node) {
+        if (levels_[node] < 0 || levels_[node] > MAX_LEVEL) {
+            return fail();
+        }
+        auto& upper = upper_links_[node];
+        upper.resize(static_cast<size_t>(levels_[node]) * (max_links_ + 1));
+        for (auto& link : upper) {
+            if (!reader.get(link)) {
+                return fail();
+            }
+        }
+    }
+
+    // A corrupt link would send searches out of bounds
+    for (NodeId node = 0; node < nodes; ++node) {
+        for (int level = 0; level <= levels_[node]; ++level) {
+            const NodeId* list = links(node, level);
+            if (list[0] > link_capacity(level) ||
+                std::any_of(list + 1, list + 1 + list[0], [nodes](NodeId link) { return link >= nodes; })) {
+                return fail();
+            }
+        }
+        if (!deleted_[node]) {
+            nodes_by_id_[ids_[node]] = node;
+        }
+    }
+    if (nodes > 0 && (entry_point >= nodes || max_level != levels_[entry_point])) {
+        return fail();
+    }
+    entry_point_ = nodes > 0 ? entry_point : NO_NODE;
+    max_level_ = nodes > 0 ? max_level : -1;
+    if (!reader.at_end()) {
+        return fail();
+    }
+    return true;
+}
+
+}  // namespace kolosal
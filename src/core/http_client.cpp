@@ -1,11 +1,18 @@
 #include "http_client.hpp"
+#include "cancellation_token.hpp"
 #include "logger.hpp"
+#include "task_scheduler.hpp"
 #include <stdexcept>
 #include <algorithm>
 #include <chrono>
 #include <thread>
 #include <sstream>
 #include <regex>
+#include <mutex>
+#include <deque>
+#include <vector>
+#include <atomic>
+#include <unordered_map>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -49,6 +56,13 @@ namespace {
         
         return sanitized;
     }
+    
+    HttpClient::Result cancelled_result(CancellationToken& token) {
+        token.mark_interrupted();
+        HttpClient::Result result{499, "", token.deadline_exceeded() ? "Request deadline exceeded" : "Request cancelled", false};
+        result.cancelled = true;
+        return result;
+    }
 
     #ifndef _WIN32
     // Safe write callback with bounds checking
@@ -73,6 +87,34 @@ namespace {
         
         return total_size;
     }
+
+    // Destination of a streamed transfer. Bytes of a successful response go
+    // to on_chunk; error responses are still buffered for the error message.
+    struct StreamContext {
+        CURL* curl;
+        std::string* error_body;
+        const HttpClient::ChunkCallback* on_chunk;
+        bool aborted;
+    };
+
+    size_t stream_write_callback(void* contents, size_t size, size_t nmemb, StreamContext* context) {
+        if (size != 0 && nmemb > SIZE_MAX / size) {
+            return 0; // Overflow detected
+        }
+        
+        long status_code = 0;
+        curl_easy_getinfo(context->curl, CURLINFO_RESPONSE_CODE, &status_code);
+        if (status_code < 200 || status_code >= 300) {
+            return safe_write_callback(contents, size, nmemb, context->error_body);
+        }
+        
+        size_t total_size = size * nmemb;
+        if (!(*context->on_chunk)(static_cast<const char*>(contents), total_size)) {
+            context->aborted = true;
+            return 0; // Makes curl abort with CURLE_WRITE_ERROR
+        }
+        return total_size;
+    }
     #endif
 
     // Parse HTTP status code from response
@@ -126,6 +168,224 @@ namespace {
     }
 }
 
+#ifdef _WIN32
+// WinHTTP opens a session per request; there is nothing to pool
+struct HttpClient::CurlState {};
+#else
+namespace {
+    // Builds the request header list; the caller frees it with curl_slist_free_all
+    curl_slist* build_header_list(const std::map<std::string, std::string>& headers) {
+        curl_slist* header_list = curl_slist_append(nullptr, "Content-Type: application/json");
+        
+        for (const auto& [key, value] : headers) {
+            std::string sanitized_key = sanitize_header_value(key);
+            std::string sanitized_value = sanitize_header_value(value);
+            std::string header = sanitized_key + ": " + sanitized_value;
+            
+            if (header.length() <= MAX_HEADER_LENGTH) {
+                header_list = curl_slist_append(header_list, header.c_str());
+            }
+        }
+        return header_list;
+    }
+
+    // Aborts the transfer (CURLE_ABORTED_BY_CALLBACK) once the token is cancelled
+    int cancel_progress_callback(void* clientp, curl_off_t, curl_off_t, curl_off_t, curl_off_t) {
+        return static_cast<const CancellationToken*>(clientp)->is_cancelled() ? 1 : 0;
+    }
+    
+    // Options shared by blocking, streaming and asynchronous transfers. url,
+    // body and header_list must outlive the transfer.
+    void configure_handle(CURL* curl, CURLSH* share, const HttpClient::Config& config,
+                          const std::string& method, const std::string& url,
+                          const std::string& body, curl_slist* header_list,
+                          const CancellationToken* cancel_token) {
+        auto timeout = std::chrono::milliseconds(std::min(config.timeout_seconds, 300) * 1000L);
+        if (cancel_token) {
+            // The deadline bounds the transfer exactly; an explicit cancel is
+            // noticed by the progress callback, which libcurl calls at least once a second.
+            // Rounded up so the transfer never times out before the token's deadline.
+            auto remaining = std::chrono::ceil<std::chrono::milliseconds>(cancel_token->remaining());
+            timeout = std::clamp(remaining, std::chrono::milliseconds(1), timeout);
+            curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+            curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, cancel_progress_callback);
+            curl_easy_setopt(curl, CURLOPT_XFERINFODATA, cancel_token);
+        }
+        
+        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, static_cast<long>(timeout.count()));
+        curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 30L);
+        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+        curl_easy_setopt(curl, CURLOPT_MAXREDIRS, 3L);
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, config.verify_ssl ? 1L : 0L);
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, config.verify_ssl ? 2L : 0L);
+        curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);  // Handles are used from many threads
+        curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+        if (share) {
+            curl_easy_setopt(curl, CURLOPT_SHARE, share);
+        }
+        
+        // Set method and body
+        if (method == "POST") {
+            curl_easy_setopt(curl, CURLOPT_POST, 1L);
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.c_str());
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(body.length()));
+        } else if (method == "PUT") {
+            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "PUT");
+            if (!body.empty()) {
+                curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.c_str());
+                curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(body.length()));
+            }
+        } else if (method == "DELETE") {
+            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
+        } else if (method == "PATCH") {
+            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "PATCH");
+            if (!body.empty()) {
+                curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.c_str());
+                curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(body.length()));
+            }
+        }
+        
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, header_list);
+    }
+
+    // Maps a finished transfer to a Result
+    HttpClient::Result make_curl_result(CURLcode res, long response_code, std::string response_body) {
+        if (res != CURLE_OK) {
+            std::string error_msg = curl_easy_strerror(res);
+            bool should_retry = (res == CURLE_COULDNT_CONNECT ||
+                               res == CURLE_OPERATION_TIMEDOUT ||
+                               res == CURLE_RECV_ERROR ||
+                               res == CURLE_SEND_ERROR);
+            
+            return HttpClient::Result{500, "", "HTTP request failed: " + error_msg, should_retry};
+        }
+        
+        bool should_retry = is_retryable_error(response_code, response_body);
+        std::string error_msg = (response_code >= 400) ? response_body : "";
+        
+        return HttpClient::Result{response_code, std::move(response_body), error_msg, should_retry};
+    }
+}
+
+// libcurl state shared by all requests of one client. Easy handles are reset
+// and pooled instead of destroyed, and every transfer is attached to one
+// share handle, so open connections, DNS results and TLS sessions carry over
+// from one request to the next on any thread.
+struct HttpClient::CurlState {
+    // A queued or running asynchronous request
+    struct Transfer {
+        std::string method;
+        std::string url;
+        std::string body;
+        std::map<std::string, std::string> headers;
+        ResultCallback on_complete;
+        int attempt = 0;
+        CURL* handle = nullptr;
+        curl_slist* header_list = nullptr;
+        std::string response_body;
+        std::chrono::steady_clock::time_point retry_at;
+        std::shared_ptr<CancellationToken> cancel_token;  // Submitting thread's token, if any
+    };
+    
+    CURLSH* share = nullptr;
+    std::mutex share_locks[CURL_LOCK_DATA_LAST];
+    
+    mutable std::mutex pool_mutex;
+    std::vector<CURL*> idle_handles;
+    std::atomic<uint64_t> handles_created{0};
+    std::atomic<uint64_t> handles_reused{0};
+    
+    // Async engine: pending is filled by submitting threads and drained by
+    // the engine thread, which owns everything else about a transfer
+    std::mutex engine_mutex;
+    std::thread engine_thread;
+    CURLM* multi = nullptr;
+    bool stopping = false;
+    std::deque<std::unique_ptr<Transfer>> pending;
+    std::atomic<size_t> in_flight{0};
+    
+    CurlState() {
+        share = curl_share_init();
+        if (share) {
+            curl_share_setopt(share, CURLSHOPT_LOCKFUNC, lock_share);
+            curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, unlock_share);
+            curl_share_setopt(share, CURLSHOPT_USERDATA, this);
+            curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+            curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+            curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+        }
+    }
+    
+    // The engine thread must have been stopped by then
+    ~CurlState() {
+        for (CURL* handle : idle_handles) {
+            curl_easy_cleanup(handle);
+        }
+        if (multi) {
+            curl_multi_cleanup(multi);
+        }
+        if (share) {
+            curl_share_cleanup(share);
+        }
+    }
+    
+    static void lock_share(CURL*, curl_lock_data data, curl_lock_access, void* userptr) {
+        static_cast<CurlState*>(userptr)->share_locks[data].lock();
+    }
+    
+    static void unlock_share(CURL*, curl_lock_data data, void* userptr) {
+        static_cast<CurlState*>(userptr)->share_locks[data].unlock();
+    }
+    
+    CURL* acquire_handle() {
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex);
+            if (!idle_handles.empty()) {
+                CURL* handle = idle_handles.back();
+                idle_handles.pop_back();
+                handles_reused++;
+                return handle;
+            }
+        }
+        CURL* handle = curl_easy_init();
+        if (handle) {
+            handles_created++;
+        }
+        return handle;
+    }
+    
+    // curl_easy_reset drops all options but keeps the handle's caches
+    void release_handle(CURL* handle, size_t max_pooled) {
+        curl_easy_reset(handle);
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex);
+            if (idle_handles.size() < max_pooled) {
+                idle_handles.push_back(handle);
+                return;
+            }
+        }
+        curl_easy_cleanup(handle);
+    }
+    
+    void stop_engine() {
+        {
+            std::lock_guard<std::mutex> lock(engine_mutex);
+            stopping = true;
+            if (multi) {
+                curl_multi_wakeup(multi);
+            }
+        }
+        if (engine_thread.joinable()) {
+            engine_thread.join();
+        }
+    }
+};
+#endif
+
+HttpClient::HttpClient() : HttpClient(Config{}) {
+}
+
 HttpClient::HttpClient(const Config& config) : config_(config) {
     if (!is_valid_url(config_.base_url)) {
         throw std::invalid_argument("Invalid base URL format");
@@ -142,12 +402,15 @@ HttpClient::HttpClient(const Config& config) : config_(config) {
     #ifndef _WIN32
     curl_global_init(CURL_GLOBAL_DEFAULT);
     #endif
+    curl_state_ = std::make_unique<CurlState>();
     
     LOG_INFO_F("HttpClient initialized with base URL: %s", config_.base_url.c_str());
 }
 
 HttpClient::~HttpClient() {
     #ifndef _WIN32
+    curl_state_->stop_engine();
+    curl_state_.reset();
     curl_global_cleanup();
     #endif
 }
@@ -157,6 +420,22 @@ HttpClient::Result HttpClient::request(const std::string& method,
                                      const std::string& body,
                                      const std::map<std::string, std::string>& headers) {
     
+    std::string url;
+    Result invalid = prepare_request(method, endpoint, body, url);
+    if (invalid.status_code != 0) {
+        return invalid;
+    }
+    
+    // A synchronous transfer parks the calling thread; on a scheduler worker
+    // this lets a spare thread take over its queue meanwhile
+    TaskScheduler::BlockingScope blocking;
+    return request_with_retry(method, url, body, headers);
+}
+
+HttpClient::Result HttpClient::prepare_request(const std::string& method,
+                                             const std::string& endpoint,
+                                             const std::string& body,
+                                             std::string& url) const {
     // Input validation
     if (method.empty() || endpoint.empty()) {
         return Result{500, "", "Invalid method or endpoint", false};
@@ -166,12 +445,44 @@ HttpClient::Result HttpClient::request(const std::string& method,
         return Result{400, "", "Request body too large", false};
     }
     
-    std::string url = build_url(endpoint);
-    if (!is_valid_url(url)) {
+    try {
+        url = build_url(endpoint);
+    } catch (const std::invalid_argument&) {
         return Result{400, "", "Invalid URL constructed", false};
     }
     
-    return request_with_retry(method, url, body, headers);
+    return Result{0, "", "", false};
+}
+
+HttpClient::Result HttpClient::stream_request(const std::string& method,
+                                            const std::string& endpoint,
+                                            const std::string& body,
+                                            const ChunkCallback& on_chunk,
+                                            const std::map<std::string, std::string>& headers) {
+    
+    if (!on_chunk) {
+        return Result{500, "", "Missing chunk callback", false};
+    }
+    
+    std::string url;
+    Result invalid = prepare_request(method, endpoint, body, url);
+    if (invalid.status_code != 0) {
+        return invalid;
+    }
+    
+    TaskScheduler::BlockingScope blocking;
+    Result result{500, "", "", false};
+    try {
+        result = perform_request(method, url, body, headers, on_chunk);
+    } catch (const std::exception& e) {
+        result = Result{500, "", e.what(), false};
+    }
+    
+    if (!result.is_success() && result.status_code != 499) {  // Receiver abort or cancellation
+        result.error_message = get_user_friendly_error(result.status_code, result.error_message);
+        LOG_ERROR_F("Streaming request failed: %s", result.error_message.c_str());
+    }
+    return result;
 }
 
 HttpClient::Result HttpClient::request_with_retry(const std::string& method,
@@ -181,8 +492,13 @@ HttpClient::Result HttpClient::request_with_retry(const std::string& method,
     
     int attempts = 0;
     Result last_result{500, "", "No attempts made", false};
+    auto cancel_token = CancellationToken::current();
     
     while (attempts <= config_.max_retries) {
+        if (cancel_token && cancel_token->is_cancelled()) {
+            return cancelled_result(*cancel_token);
+        }
+        
         try {
             last_result = perform_request(method, url, body, headers);
             
@@ -196,16 +512,16 @@ HttpClient::Result HttpClient::request_with_retry(const std::string& method,
                 break;
             }
             
-            // Calculate backoff delay (exponential with jitter)
-            int base_delay = config_.retry_delay_ms;
-            int backoff_delay = base_delay * (1 << std::min(attempts, 5)); // Cap at 32x
-            int jitter = (std::rand() % (backoff_delay / 4)) - (backoff_delay / 8);
-            int total_delay = std::max(backoff_delay + jitter, base_delay);
+            int total_delay = retry_delay_ms(attempts);
             
             LOG_WARN_F("Request failed (attempt %d/%d), retrying in %dms: %s", 
                       attempts + 1, config_.max_retries + 1, total_delay, last_result.error_message.c_str());
             
-            std::this_thread::sleep_for(std::chrono::milliseconds(total_delay));
+            if (cancel_token) {
+                cancel_token->sleep_for(std::chrono::milliseconds(total_delay));
+            } else {
+                std::this_thread::sleep_for(std::chrono::milliseconds(total_delay));
+            }
             
         } catch (const std::exception& e) {
             last_result.status_code = 500;
@@ -221,6 +537,10 @@ HttpClient::Result HttpClient::request_with_retry(const std::string& method,
         attempts++;
     }
     
+    if (last_result.cancelled) {
+        return last_result;
+    }
+    
     // Enhance error message with user-friendly information
     last_result.error_message = get_user_friendly_error(last_result.status_code, last_result.error_message);
     
@@ -228,17 +548,26 @@ HttpClient::Result HttpClient::request_with_retry(const std::string& method,
     return last_result;
 }
 
+int HttpClient::retry_delay_ms(int attempt) const {
+    // Exponential backoff with jitter
+    int base_delay = config_.retry_delay_ms;
+    int backoff_delay = base_delay * (1 << std::min(attempt, 5)); // Cap at 32x
+    int jitter = backoff_delay >= 4 ? (std::rand() % (backoff_delay / 4)) - (backoff_delay / 8) : 0;
+    return std::max(backoff_delay + jitter, base_delay);
+}
+
 HttpClient::Result HttpClient::perform_request(const std::string& method,
                                              const std::string& url,
                                              const std::string& body,
-                                             const std::map<std::string, std::string>& headers) {
+                                             const std::map<std::string, std::string>& headers,
+                                             const ChunkCallback& on_chunk) {
     
     LOG_DEBUG_F("Making %s request to: %s", method.c_str(), url.c_str());
     
 #ifdef _WIN32
-    return perform_winhttp_request(method, url, body, headers);
+    return perform_winhttp_request(method, url, body, headers, on_chunk);
 #else
-    return perform_curl_request(method, url, body, headers);
+    return perform_curl_request(method, url, body, headers, on_chunk);
 #endif
 }
 
@@ -246,7 +575,8 @@ HttpClient::Result HttpClient::perform_request(const std::string& method,
 HttpClient::Result HttpClient::perform_winhttp_request(const std::string& method,
                                                      const std::string& url,
                                                      const std::string& body,
-                                                     const std::map<std::string, std::string>& headers) {
+                                                     const std::map<std::string, std::string>& headers,
+                                                     const ChunkCallback& on_chunk) {
     
     // Parse URL components safely
     std::wstring w_host, w_path;
@@ -346,6 +676,17 @@ HttpClient::Result HttpClient::perform_winhttp_request(const std::string& method
             DWORD bytesToRead = std::min(bytesAvailable, static_cast<DWORD>(buffer.size()));
             if (WinHttpReadData(hRequest, buffer.data(), bytesToRead, &bytesRead) && bytesRead > 0) {
                 
+                // Streamed successful responses bypass the body buffer
+                if (on_chunk && statusCode >= 200 && statusCode < 300) {
+                    if (!on_chunk(buffer.data(), bytesRead)) {
+                        WinHttpCloseHandle(hRequest);
+                        WinHttpCloseHandle(hConnect);
+                        WinHttpCloseHandle(hSession);
+                        return Result{499, "", "Stream aborted by receiver", false};
+                    }
+                    continue;
+                }
+                
                 // Check total size limit
                 if (response_body.size() + bytesRead > MAX_RESPONSE_SIZE) {
                     WinHttpCloseHandle(hRequest);
@@ -429,9 +770,10 @@ bool HttpClient::parse_url_components(const std::string& url, std::wstring& host
 HttpClient::Result HttpClient::perform_curl_request(const std::string& method,
                                                    const std::string& url,
                                                    const std::string& body,
-                                                   const std::map<std::string, std::string>& headers) {
+                                                   const std::map<std::string, std::string>& headers,
+                                                   const ChunkCallback& on_chunk) {
     
-    CURL* curl = curl_easy_init();
+    CURL* curl = curl_state_->acquire_handle();
     if (!curl) {
         return Result{500, "", "Failed to initialize libcurl", true};
     }
@@ -439,82 +781,271 @@ HttpClient::Result HttpClient::perform_curl_request(const std::string& method,
     std::string response_body;
     response_body.reserve(BUFFER_CHUNK_SIZE);
     long response_code = 0;
+    StreamContext stream_context{curl, &response_body, &on_chunk, false};
     
-    // Set basic options with bounds checking
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, safe_write_callback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_body);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, static_cast<long>(std::min(config_.timeout_seconds, 300)));
-    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 30L);
-    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-    curl_easy_setopt(curl, CURLOPT_MAXREDIRS, 3L);
-    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, config_.verify_ssl ? 1L : 0L);
-    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, config_.verify_ssl ? 2L : 0L);
-    
-    // Set method and body
-    if (method == "POST") {
-        curl_easy_setopt(curl, CURLOPT_POST, 1L);
-        if (!body.empty()) {
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.c_str());
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(body.length()));
-        }
-    } else if (method == "PUT") {
-        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "PUT");
-        if (!body.empty()) {
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.c_str());
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(body.length()));
-        }
-    } else if (method == "DELETE") {
-        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
-    } else if (method == "PATCH") {
-        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "PATCH");
-        if (!body.empty()) {
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.c_str());
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(body.length()));
-        }
-    }
-    
-    // Set headers with sanitization
-    struct curl_slist* header_list = NULL;
-    header_list = curl_slist_append(header_list, "Content-Type: application/json");
-    
-    for (const auto& [key, value] : headers) {
-        std::string sanitized_key = sanitize_header_value(key);
-        std::string sanitized_value = sanitize_header_value(value);
-        std::string header = sanitized_key + ": " + sanitized_value;
-        
-        if (header.length() <= MAX_HEADER_LENGTH) {
-            header_list = curl_slist_append(header_list, header.c_str());
-        }
+    auto cancel_token = CancellationToken::current();
+    curl_slist* header_list = build_header_list(headers);
+    configure_handle(curl, curl_state_->share, config_, method, url, body, header_list, cancel_token.get());
+    if (on_chunk) {
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, stream_write_callback);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &stream_context);
+    } else {
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, safe_write_callback);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_body);
     }
     
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, header_list);
-    
     // Perform request
     CURLcode res = curl_easy_perform(curl);
     curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
     
-    // Cleanup
+    // Return the handle to the pool; its connection stays open for reuse
     curl_slist_free_all(header_list);
-    curl_easy_cleanup(curl);
+    curl_state_->release_handle(curl, config_.max_pooled_handles);
+    
+    if (cancel_token && res != CURLE_OK && cancel_token->is_cancelled()) {
+        return cancelled_result(*cancel_token);
+    }
+    if (stream_context.aborted) {
+        return Result{499, "", "Stream aborted by receiver", false};
+    }
+    
+    return make_curl_result(res, response_code, std::move(response_body));
+}
+
+void HttpClient::run_async_engine() {
+    using Transfer = CurlState::Transfer;
+    CurlState& state = *curl_state_;
+    const size_t max_in_flight = std::max<size_t>(1, config_.max_async_in_flight);
+    
+    std::unordered_map<CURL*, std::unique_ptr<Transfer>> active;
+    std::vector<std::unique_ptr<Transfer>> backing_off;  // Waiting to be retried
+    
+    auto deliver = [](Transfer& transfer, Result result) {
+        try {
+            transfer.on_complete(std::move(result));
+        } catch (const std::exception& e) {
+            LOG_WARN_F("Async request callback threw: %s", e.what());
+        }
+    };
+    
+    auto is_cancelled = [](const Transfer& transfer) {
+        return transfer.cancel_token && transfer.cancel_token->is_cancelled();
+    };
     
-    // Handle curl errors
-    if (res != CURLE_OK) {
-        std::string error_msg = curl_easy_strerror(res);
-        bool should_retry = (res == CURLE_COULDNT_CONNECT ||
-                           res == CURLE_OPERATION_TIMEDOUT ||
-                           res == CURLE_RECV_ERROR ||
-                           res == CURLE_SEND_ERROR);
+    auto start_transfer = [&](std::unique_ptr<Transfer> transfer) {
+        if (is_cancelled(*transfer)) {
+            deliver(*transfer, cancelled_result(*transfer->cancel_token));
+            return;
+        }
+        CURL* handle = state.acquire_handle();
+        if (!handle) {
+            deliver(*transfer, Result{500, "", "Failed to initialize libcurl", true});
+            return;
+        }
+        transfer->handle = handle;
+        transfer->response_body.clear();
+        transfer->header_list = build_header_list(transfer->headers);
+        configure_handle(handle, state.share, config_, transfer->method, transfer->url,
+                         transfer->body, transfer->header_list, transfer->cancel_token.get());
+        curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, safe_write_callback);
+        curl_easy_setopt(handle, CURLOPT_WRITEDATA, &transfer->response_body);
+        curl_multi_add_handle(state.multi, handle);
+        active.emplace(handle, std::move(transfer));
+        state.in_flight = active.size();
+    };
+    
+    auto finish_transfer = [&](CURL* handle, CURLcode res) {
+        auto it = active.find(handle);
+        if (it == active.end()) {
+            return;
+        }
+        std::unique_ptr<Transfer> transfer = std::move(it->second);
+        active.erase(it);
+        state.in_flight = active.size();
+        
+        long response_code = 0;
+        curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &response_code);
+        curl_multi_remove_handle(state.multi, handle);
+        curl_slist_free_all(transfer->header_list);
+        transfer->header_list = nullptr;
+        transfer->handle = nullptr;
+        state.release_handle(handle, config_.max_pooled_handles);
+        
+        if (res != CURLE_OK && is_cancelled(*transfer)) {
+            deliver(*transfer, cancelled_result(*transfer->cancel_token));
+            return;
+        }
+        
+        Result result = make_curl_result(res, response_code, std::move(transfer->response_body));
+        if (!result.is_success() && result.retry_recommended && transfer->attempt < config_.max_retries) {
+            int delay_ms = retry_delay_ms(transfer->attempt);
+            LOG_WARN_F("Async request failed (attempt %d/%d), retrying in %dms: %s",
+                      transfer->attempt + 1, config_.max_retries + 1, delay_ms, result.error_message.c_str());
+            transfer->attempt++;
+            transfer->retry_at = std::chrono::steady_clock::now() + std::chrono::milliseconds(delay_ms);
+            backing_off.push_back(std::move(transfer));
+            return;
+        }
+        if (!result.is_success()) {
+            result.error_message = get_user_friendly_error(result.status_code, result.error_message);
+            LOG_ERROR_F("Request failed after %d attempts: %s", transfer->attempt + 1, result.error_message.c_str());
+        }
+        deliver(*transfer, std::move(result));
+    };
+    
+    std::vector<std::unique_ptr<Transfer>> starting;
+    while (true) {
+        // Admit new submissions up to the in-flight limit
+        {
+            std::lock_guard<std::mutex> lock(state.engine_mutex);
+            if (state.stopping) {
+                break;
+            }
+            while (!state.pending.empty() && active.size() + starting.size() < max_in_flight) {
+                starting.push_back(std::move(state.pending.front()));
+                state.pending.pop_front();
+            }
+        }
+        for (auto& transfer : starting) {
+            start_transfer(std::move(transfer));
+        }
+        starting.clear();
+        
+        // Restart retries whose backoff has elapsed
+        auto now = std::chrono::steady_clock::now();
+        int wait_ms = 1000;
+        for (auto it = backing_off.begin(); it != backing_off.end();) {
+            if (((*it)->retry_at <= now || is_cancelled(**it)) && active.size() < max_in_flight) {
+                start_transfer(std::move(*it));
+                it = backing_off.erase(it);
+            } else {
+                auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>((*it)->retry_at - now).count();
+                wait_ms = std::clamp(static_cast<int>(remaining), 1, wait_ms);
+                ++it;
+            }
+        }
+        
+        int running_handles = 0;
+        curl_multi_perform(state.multi, &running_handles);
+        
+        bool finished_any = false;
+        int messages_left = 0;
+        while (CURLMsg* message = curl_multi_info_read(state.multi, &messages_left)) {
+            if (message->msg == CURLMSG_DONE) {
+                finish_transfer(message->easy_handle, message->data.result);
+                finished_any = true;
+            }
+        }
+        
+        // Completions free in-flight slots; admit queued work before sleeping
+        if (finished_any) {
+            continue;
+        }
         
-        return Result{500, "", "HTTP request failed: " + error_msg, should_retry};
+        // Sleeps until socket activity, a timeout, or curl_multi_wakeup()
+        curl_multi_poll(state.multi, nullptr, 0, wait_ms, nullptr);
     }
     
-    bool should_retry = is_retryable_error(response_code, response_body);
-    std::string error_msg = (response_code >= 400) ? response_body : "";
+    // Shutdown: fail everything that has not completed
+    const Result shutdown_result{500, "", "HTTP client shut down", false};
+    for (auto& [handle, transfer] : active) {
+        curl_multi_remove_handle(state.multi, handle);
+        curl_slist_free_all(transfer->header_list);
+        curl_easy_cleanup(handle);
+        deliver(*transfer, shutdown_result);
+    }
+    active.clear();
+    state.in_flight = 0;
+    for (auto& transfer : backing_off) {
+        deliver(*transfer, shutdown_result);
+    }
+    std::deque<std::unique_ptr<Transfer>> abandoned;
+    {
+        std::lock_guard<std::mutex> lock(state.engine_mutex);
+        abandoned.swap(state.pending);
+    }
+    for (auto& transfer : abandoned) {
+        deliver(*transfer, shutdown_result);
+    }
+}
+#endif
+
+void HttpClient::request_async(const std::string& method,
+                               const std::string& endpoint,
+                               const std::string& body,
+                               const std::map<std::string, std::string>& headers,
+                               ResultCallback on_complete) {
+    std::string url;
+    Result invalid = prepare_request(method, endpoint, body, url);
+    if (invalid.status_code != 0) {
+        on_complete(std::move(invalid));
+        return;
+    }
+    
+#ifdef _WIN32
+    on_complete(request_with_retry(method, url, body, headers));
+#else
+    auto transfer = std::make_unique<CurlState::Transfer>();
+    transfer->method = method;
+    transfer->url = std::move(url);
+    transfer->body = body;
+    transfer->headers = headers;
+    transfer->on_complete = std::move(on_complete);
+    transfer->cancel_token = CancellationToken::current();
     
-    return Result{response_code, response_body, error_msg, should_retry};
+    CurlState& state = *curl_state_;
+    bool stopping = false;
+    {
+        std::lock_guard<std::mutex> lock(state.engine_mutex);
+        stopping = state.stopping;
+        if (!stopping) {
+            if (!state.multi) {
+                // First asynchronous request starts the engine
+                state.multi = curl_multi_init();
+                if (state.multi) {
+                    state.engine_thread = std::thread(&HttpClient::run_async_engine, this);
+                }
+            }
+            if (state.multi) {
+                state.pending.push_back(std::move(transfer));
+                curl_multi_wakeup(state.multi);
+                return;
+            }
+        }
+    }
+    transfer->on_complete(Result{500, "", stopping ? "HTTP client shut down" : "Failed to initialize libcurl multi handle", false});
+#endif
 }
+
+std::future<HttpClient::Result> HttpClient::request_async(const std::string& method,
+                                                         const std::string& endpoint,
+                                                         const std::string& body,
+                                                         const std::map<std::string, std::string>& headers) {
+    auto promise = std::make_shared<std::promise<Result>>();
+    std::future<Result> future = promise->get_future();
+    request_async(method, endpoint, body, headers, [promise](Result result) {
+        promise->set_value(std::move(result));
+    });
+    return future;
+}
+
+HttpClient::Stats HttpClient::get_stats() const {
+    Stats stats;
+#ifndef _WIN32
+    stats.handles_created = curl_state_->handles_created.load();
+    stats.handles_reused = curl_state_->handles_reused.load();
+    stats.async_in_flight = curl_state_->in_flight.load();
+    {
+        std::lock_guard<std::mutex> lock(curl_state_->pool_mutex);
+        stats.idle_handles = curl_state_->idle_handles.size();
+    }
+    {
+        std::lock_guard<std::mutex> lock(curl_state_->engine_mutex);
+        stats.async_queued = curl_state_->pending.size();
+    }
 #endif
+    return stats;
+}
 
 std::string HttpClient::build_url(const std::string& endpoint) const {
     std::string url = config_.base_url;
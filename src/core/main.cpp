@@ -12,6 +12,7 @@
 #include <atomic>
 #include <thread>
 #include <chrono>
+#include <algorithm>
 
 std::atomic<bool> system_running{true};
 std::unique_ptr<HTTPServer> http_server;
@@ -297,7 +298,26 @@ int main(int argc, char* argv[]) {
         
         // Create and start HTTP server with workflow support (no kolosal-server endpoints)
         LOG_DEBUG_F("Creating HTTP server on %s:%d", host.c_str(), port);
-        http_server = std::make_unique<HTTPServer>(agent_manager, workflow_manager, workflow_orchestrator, host, port);
+        const auto& http_settings = config_data.system.http_server;
+        HTTPServer::Config http_config;
+        http_config.io_model = HTTPServer::parse_io_model(http_settings.io_model);
+        http_config.backlog = http_settings.backlog;
+        http_config.max_connections = static_cast<size_t>(std::max(1, http_settings.max_connections));
+        http_config.io_threads = http_settings.io_threads;
+        http_config.worker_threads = http_settings.worker_threads;
+        http_config.keep_alive = http_settings.keep_alive;
+        http_config.keep_alive_timeout_ms = http_settings.keep_alive_timeout_ms;
+        http_config.max_requests_per_connection = http_settings.max_requests_per_connection;
+        http_config.max_event_streams = static_cast<size_t>(std::max(1, http_settings.max_event_streams));
+        size_t max_request_size = ConfigValidator::parse_memory_string(config_data.performance.max_request_size);
+        if (max_request_size > 0) {
+            http_config.max_request_size = max_request_size;
+        } else {
+            LOG_WARN_F("Invalid performance.max_request_size '%s', using default",
+                       config_data.performance.max_request_size.c_str());
+        }
+        LOG_DEBUG_F("HTTP server I/O model: %s", http_settings.io_model.c_str());
+        http_server = std::make_unique<HTTPServer>(agent_manager, workflow_manager, workflow_orchestrator, host, port, http_config);
         
         LOG_DEBUG("Starting HTTP server");
         if (!http_server->start()) {
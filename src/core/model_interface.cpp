@@ -22,25 +22,62 @@ ModelInterface::ModelInterface(const std::string& server_url) {
     default_models.push_back(default_model);
     
     model_configurations_ = default_models;
+    rebuild_model_index();
     std::cout << "[ModelInterface] Initialized with default model configurations" << std::endl;
 }
 
 std::string ModelInterface::resolve_model_name(const std::string& model_name) {
-    // Check if we have model configurations with actual_name mapping
-    if (!model_configurations_.empty()) {
-        for (const auto& model_config : model_configurations_) {
-            if (model_config.contains("id") && model_config["id"] == model_name) {
-                if (model_config.contains("actual_name")) {
-                    return model_config["actual_name"].get<std::string>();
-                }
-                // If no actual_name field, return the id as-is
-                return model_name;
+    std::lock_guard<std::mutex> lock(models_mutex_);
+    auto it = model_index_.find(model_name);
+    if (it == model_index_.end()) {
+        // Not configured: pass the name through unchanged
+        return model_name;
+    }
+    
+    const auto& model_config = model_configurations_[it->second];
+    if (model_config.contains("actual_name")) {
+        return model_config["actual_name"].get<std::string>();
+    }
+    // If no actual_name field, the id is the server-side name
+    return model_config.value("id", model_name);
+}
+
+void ModelInterface::rebuild_model_index() {
+    model_index_.clear();
+    if (!model_configurations_.is_array()) {
+        return;
+    }
+    
+    auto add_key = [this](const json& key, size_t index) {
+        if (key.is_string()) {
+            // First definition wins, matching the former front-to-back scan
+            model_index_.emplace(key.get<std::string>(), index);
+        }
+    };
+    
+    // Ids take precedence over the secondary names of other models
+    for (size_t i = 0; i < model_configurations_.size(); ++i) {
+        const auto& model_config = model_configurations_[i];
+        if (model_config.is_object() && model_config.contains("id")) {
+            add_key(model_config["id"], i);
+        }
+    }
+    for (size_t i = 0; i < model_configurations_.size(); ++i) {
+        const auto& model_config = model_configurations_[i];
+        if (!model_config.is_object()) {
+            continue;
+        }
+        for (const char* field : {"actual_name", "name"}) {
+            if (model_config.contains(field)) {
+                add_key(model_config[field], i);
+            }
+        }
+        if (model_config.contains("aliases") && model_config["aliases"].is_array()) {
+            for (const auto& alias : model_config["aliases"]) {
+                add_key(alias, i);
             }
         }
     }
-    
-    // If no configuration found, return the model name as-is
-    return model_name;
 }
 
 std::string ModelInterface::generate_completion(const std::string& model_name, 
@@ -94,19 +131,42 @@ std::string ModelInterface::chat_with_model(const std::string& model_name,
     }
 }
 
+std::string ModelInterface::chat_with_model_stream(const std::string& model_name,
+                                                  const std::string& message,
+                                                  const std::string& system_prompt,
+                                                  const KolosalClient::TokenCallback& on_delta) {
+    try {
+        std::string actual_model_name = resolve_model_name(model_name);
+        std::cout << "[ModelInterface] Resolving model '" << model_name << "' to '" << actual_model_name << "' (streaming)" << std::endl;
+        
+        return kolosal_client_->chat_with_model_stream(actual_model_name, message, system_prompt, on_delta);
+    } catch (const std::exception& e) {
+        std::cerr << "Error in chat_with_model_stream: " << e.what() << std::endl;
+        throw std::runtime_error("Failed to chat with model: " + std::string(e.what()));
+    }
+}
+
+std::future<std::string> ModelInterface::chat_with_model_async(const std::string& model_name,
+                                                              const std::string& message,
+                                                              const std::string& system_prompt) {
+    std::string actual_model_name = resolve_model_name(model_name);
+    std::cout << "[ModelInterface] Resolving model '" << model_name << "' to '" << actual_model_name << "' (async)" << std::endl;
+    
+    return kolosal_client_->chat_with_model_async(actual_model_name, message, system_prompt);
+}
+
 bool ModelInterface::is_model_available(const std::string& model_name) {
     try {
         // First check in our configured models
-        if (!model_configurations_.empty()) {
-            for (const auto& model_config : model_configurations_) {
-                if (model_config.contains("id") && model_config["id"] == model_name) {
-                    return true; // Model is configured, assume it's available
-                }
+        {
+            std::lock_guard<std::mutex> lock(models_mutex_);
+            if (!model_configurations_.empty()) {
+                // Configured models are assumed to be available
+                return model_index_.find(model_name) != model_index_.end();
             }
-            return false; // Model not found in configurations
         }
         
-        // Fallback to checking via KolosalClient
+        // Fallback to the client's cached server catalogue
         return kolosal_client_->is_model_available(model_name);
     } catch (const std::exception& e) {
         std::cerr << "Error checking model availability: " << e.what() << std::endl;
@@ -117,6 +177,7 @@ bool ModelInterface::is_model_available(const std::string& model_name) {
 json ModelInterface::get_available_models() {
     try {
         // If we have configured models, use them instead of making HTTP requests
+        std::unique_lock<std::mutex> lock(models_mutex_);
         if (!model_configurations_.empty()) {
             json available_models = json::array();
             for (const auto& model_config : model_configurations_) {
@@ -131,6 +192,7 @@ json ModelInterface::get_available_models() {
             }
             return available_models;
         }
+        lock.unlock();
         
         return kolosal_client_->get_available_models();
     } catch (const std::exception& e) {
@@ -140,7 +202,11 @@ json ModelInterface::get_available_models() {
 }
 
 void ModelInterface::configure_models(const json& model_configs) {
-    model_configurations_ = model_configs;
+    {
+        std::lock_guard<std::mutex> lock(models_mutex_);
+        model_configurations_ = model_configs;
+        rebuild_model_index();
+    }
     std::cout << "[ModelInterface] Configured with " << model_configs.size() << " models" << std::endl;
     
     for (const auto& model : model_configs) {
@@ -0,0 +1,524 @@
+#include "quantized_index.hpp"
+#include "index_io.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <random>
+#include <thread>
+
+namespace kolosal {
+
+namespace {
+    constexpr uint32_t QUANTIZED_INDEX_TAG = 0x4E415551;  // "QUAN"
+
+    // Rows with the k best scores of at least threshold, best first
+    template <typename ScoreFn>
+    std::vector<std::pair<float, size_t>> top_k(size_t rows, size_t k, float threshold, ScoreFn&& score_of) {
+        using Candidate = std::pair<float, size_t>;
+        std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> best;
+        for (size_t row = 0; row < rows; ++row) {
+            float score = score_of(row);
+            if (score < threshold) {
+                continue;
+            }
+            if (best.size() < k) {
+                best.emplace(score, row);
+            } else if (score > best.top().first) {
+                best.pop();
+                best.emplace(score, row);
+            }
+        }
+
+        std::vector<Candidate> ordered(best.size());
+        for (size_t i = ordered.size(); i-- > 0; best.pop()) {
+            ordered[i] = best.top();
+        }
+        return ordered;
+    }
+
+    // Index of the centroid nearest to x by Euclidean distance. centroids is
+    // dimension-major (width rows of Count values); distances are
+    // accumulated for BLOCK centroids at a time, which stay in registers and
+    // vectorise. norms holds each centroid's squared length, so ||x||^2
+    // drops out.
+    template <size_t Count>
+    size_t nearest_centroid(const float* x, const float* centroids, const float* norms, size_t width) {
+        constexpr size_t BLOCK = 16;
+        size_t best = 0;
+        float best_distance = std::numeric_limits<float>::max();
+        for (size_t first = 0; first < Count; first += BLOCK) {
+            float distances[BLOCK];
+            std::copy_n(norms + first, BLOCK, distances);
+            for (size_t i = 0; i < width; ++i) {
+                const float weight = -2.0f * x[i];
+                const float* column = centroids + i * Count + first;
+                for (size_t c = 0; c < BLOCK; ++c) {
+                    distances[c] += weight * column[c];
+                }
+            }
+            for (size_t c = 0; c < BLOCK; ++c) {
+                if (distances[c] < best_distance) {
+                    best_distance = distances[c];
+                    best = first + c;
+                }
+            }
+        }
+        return best;
+    }
+
+    template <size_t Count>
+    void centroid_norms(const float* centroids, size_t width, float* norms) {
+        std::fill(norms, norms + Count, 0.0f);
+        for (size_t i = 0; i < width; ++i) {
+            const float* column = centroids + i * Count;
+            for (size_t c = 0; c < Count; ++c) {
+                norms[c] += column[c] * column[c];
+            }
+        }
+    }
+}  // namespace
+
+QuantizedVectorIndex::QuantizedVectorIndex(size_t dimension) : QuantizedVectorIndex(dimension, Config()) {}
+
+QuantizedVectorIndex::QuantizedVectorIndex(size_t dimension, const Config& config)
+    : dimension_(0), stride_(0), config_(config),
+      dot_(vector_kernels::dot_product()), code_dot_(vector_kernels::code_dot_product()) {
+    set_dimension(dimension);
+}
+
+void QuantizedVectorIndex::set_dimension(size_t dimension) {
+    dimension_ = dimension;
+    stride_ = vector_kernels::padded_dimension(dimension);
+    offsets_.clear();
+    if (config_.encoding == Encoding::Scalar8) {
+        code_size_ = stride_;
+        return;
+    }
+
+    // Sub-vectors split the dimension as evenly as possible
+    size_t parts = config_.pq_subvectors > 0 ? config_.pq_subvectors : std::max<size_t>(1, dimension / 8);
+    parts = std::max<size_t>(1, std::min(parts, dimension));
+    for (size_t s = 0; s <= parts; ++s) {
+        offsets_.push_back(s * dimension / parts);
+    }
+    code_size_ = parts;
+}
+
+bool QuantizedVectorIndex::add(const std::string& id, const std::vector<float>& vector) {
+    if (vector.empty()) {
+        return false;
+    }
+    if (dimension_ == 0 && ids_.empty()) {
+        set_dimension(vector.size());
+    }
+    if (vector.size() != dimension_) {
+        return false;
+    }
+
+    vector_kernels::AlignedFloats normalized(stride_);
+    vector_kernels::normalize_into(vector.data(), dimension_, normalized.data());
+
+    size_t row;
+    auto existing = rows_.find(id);
+    if (existing != rows_.end()) {
+        row = existing->second;
+    } else {
+        row = ids_.size();
+        if (keeps_full()) {
+            full_.resize(full_.size() + stride_);
+        }
+        if (trained_) {
+            codes_.resize(codes_.size() + code_size_);
+        }
+        ids_.push_back(id);
+        rows_.emplace(id, row);
+    }
+    if (keeps_full()) {
+        std::copy_n(normalized.data(), stride_, full_.data() + row * stride_);
+    }
+    if (trained_) {
+        encode(normalized.data(), codes_.data() + row * code_size_);
+    } else if (ids_.size() >= std::max(config_.training_size, CENTROIDS)) {
+        train();
+    }
+    return true;
+}
+
+bool QuantizedVectorIndex::remove(const std::string& id) {
+    auto it = rows_.find(id);
+    if (it == rows_.end()) {
+        return false;
+    }
+
+    // Move the last row into the gap so the blocks stay dense
+    size_t row = it->second;
+    size_t last = ids_.size() - 1;
+    if (row != last) {
+        if (keeps_full()) {
+            std::copy_n(full_.data() + last * stride_, stride_, full_.data() + row * stride_);
+        }
+        if (trained_) {
+            std::copy_n(codes_.data() + last * code_size_, code_size_, codes_.data() + row * code_size_);
+        }
+        ids_[row] = std::move(ids_[last]);
+        rows_[ids_[row]] = row;
+    }
+    rows_.erase(it);
+    ids_.pop_back();
+    if (keeps_full()) {
+        full_.resize(last * stride_);
+    }
+    if (trained_) {
+        codes_.resize(last * code_size_);
+    }
+    return true;
+}
+
+void QuantizedVectorIndex::clear() {
+    full_.clear();
+    codes_.clear();
+    minimum_.clear();
+    step_.clear();
+    centroids_.clear();
+    centroid_norms_.clear();
+    ids_.clear();
+    rows_.clear();
+    trained_ = false;
+}
+
+void QuantizedVectorIndex::reserve(size_t count) {
+    // At least doubling keeps per-batch reserves amortised
+    if (count <= ids_.capacity()) {
+        return;
+    }
+    count = std::max(count, ids_.capacity() * 2);
+    if (keeps_full()) {
+        full_.reserve(count * stride_);
+    }
+    if (trained_) {
+        codes_.reserve(count * code_size_);
+    }
+    ids_.reserve(count);
+    rows_.reserve(count);
+}
+
+size_t QuantizedVectorIndex::memory_usage() const {
+    size_t floats = full_.size() + minimum_.size() + step_.size() + centroids_.size() + centroid_norms_.size();
+    return codes_.size() + floats * sizeof(float);
+}
+
+void QuantizedVectorIndex::train() {
+    if (config_.encoding == Encoding::Scalar8) {
+        train_scalar();
+    } else {
+        train_product();
+    }
+
+    codes_.assign(ids_.size() * code_size_, 0);
+    for (size_t row = 0; row < ids_.size(); ++row) {
+        encode(full_.data() + row * stride_, codes_.data() + row * code_size_);
+    }
+    trained_ = true;
+    if (config_.rerank_candidates == 0) {
+        vector_kernels::AlignedFloats().swap(full_);
+    }
+}
+
+void QuantizedVectorIndex::train_scalar() {
+    minimum_.assign(stride_, 0.0f);
+    step_.assign(stride_, 0.0f);
+    for (size_t i = 0; i < dimension_; ++i) {
+        float low = std::numeric_limits<float>::max();
+        float high = std::numeric_limits<float>::lowest();
+        for (size_t row = 0; row < ids_.size(); ++row) {
+            float value = full_[row * stride_ + i];
+            low = std::min(low, value);
+            high = std::max(high, value);
+        }
+        minimum_[i] = low;
+        step_[i] = (high - low) / 255.0f;
+    }
+}
+
+void QuantizedVectorIndex::train_product() {
+    const size_t parts = code_size_;
+    const size_t points = ids_.size();
+    centroids_.assign(CENTROIDS * dimension_, 0.0f);
+
+    // Sub-vectors are independent k-means problems, so they train in parallel
+    auto train_part = [this, points](size_t part) {
+        const size_t begin = offsets_[part];
+        const size_t width = offsets_[part + 1] - begin;
+        float* centroids = centroids_.data() + CENTROIDS * begin;
+
+        std::vector<float> data(points * width);
+        for (size_t row = 0; row < points; ++row) {
+            std::copy_n(full_.data() + row * stride_ + begin, width, data.data() + row * width);
+        }
+
+        // Start from distinct random training vectors
+        std::mt19937 gen(config_.seed + static_cast<uint32_t>(part));
+        std::vector<size_t> order(points);
+        std::iota(order.begin(), order.end(), 0);
+        std::shuffle(order.begin(), order.end(), gen);
+        auto seed_centroid = [&](size_t c, size_t row) {
+            for (size_t i = 0; i < width; ++i) {
+                centroids[i * CENTROIDS + c] = data[row * width + i];
+            }
+        };
+        for (size_t c = 0; c < CENTROIDS; ++c) {
+            seed_centroid(c, order[c]);
+        }
+
+        std::vector<float> norms(CENTROIDS);
+        std::vector<float> sums(CENTROIDS * width);
+        std::vector<size_t> counts(CENTROIDS);
+        std::uniform_int_distribution<size_t> pick(0, points - 1);
+        for (size_t iteration = 0; iteration < KMEANS_ITERATIONS; ++iteration) {
+            centroid_norms<CENTROIDS>(centroids, width, norms.data());
+            std::fill(sums.begin(), sums.end(), 0.0f);
+            std::fill(counts.begin(), counts.end(), 0);
+            for (size_t row = 0; row < points; ++row) {
+                const float* x = data.data() + row * width;
+                size_t c = nearest_centroid<CENTROIDS>(x, centroids, norms.data(), width);
+                ++counts[c];
+                for (size_t i = 0; i < width; ++i) {
+                    sums[i * CENTROIDS + c] += x[i];
+                }
+            }
+            for (size_t c = 0; c < CENTROIDS; ++c) {
+                if (counts[c] == 0) {
+                    // An empty cluster restarts from a random training vector
+                    seed_centroid(c, pick(gen));
+                    continue;
+                }
+                for (size_t i = 0; i < width; ++i) {
+                    centroids[i * CENTROIDS + c] = sums[i * CENTROIDS + c] / static_cast<float>(counts[c]);
+                }
+            }
+        }
+    };
+
+    size_t threads = config_.build_threads > 0 ? config_.build_threads : std::thread::hardware_concurrency();
+    threads = std::max<size_t>(1, std::min(threads, parts));
+    if (threads == 1) {
+        for (size_t part = 0; part < parts; ++part) {
+            train_part(part);
+        }
+        compute_centroid_norms();
+        return;
+    }
+
+    std::atomic<size_t> next{0};
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&train_part, &next, parts] {
+            for (size_t part = next++; part < parts; part = next++) {
+                train_part(part);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    compute_centroid_norms();
+}
+
+void QuantizedVectorIndex::compute_centroid_norms() {
+    centroid_norms_.assign(code_size_ * CENTROIDS, 0.0f);
+    for (size_t part = 0; part < code_size_; ++part) {
+        centroid_norms<CENTROIDS>(centroids_.data() + CENTROIDS * offsets_[part], offsets_[part + 1] - offsets_[part],
+                                  centroid_norms_.data() + part * CENTROIDS);
+    }
+}
+
+void QuantizedVectorIndex::encode(const float* normalized, uint8_t* code) const {
+    if (config_.encoding == Encoding::Scalar8) {
+        for (size_t i = 0; i < dimension_; ++i) {
+            float level = step_[i] > 0.0f ? std::round((normalized[i] - minimum_[i]) / step_[i]) : 0.0f;
+            code[i] = static_cast<uint8_t>(std::clamp(level, 0.0f, 255.0f));
+        }
+        std::fill(code + dimension_, code + code_size_, 0);
+        return;
+    }
+
+    for (size_t part = 0; part < code_size_; ++part) {
+        const size_t begin = offsets_[part];
+        const size_t width = offsets_[part + 1] - begin;
+        code[part] = static_cast<uint8_t>(nearest_centroid<CENTROIDS>(
+            normalized + begin, centroids_.data() + CENTROIDS * begin, centroid_norms_.data() + part * CENTROIDS,
+            width));
+    }
+}
+
+std::vector<QuantizedVectorIndex::Hit> QuantizedVectorIndex::search_full(const float* normalized, size_t k,
+                                                                          float threshold) const {
+    auto best = top_k(ids_.size(), k, threshold, [&](size_t row) {
+        return dot_(normalized, full_.data() + row * stride_, stride_);
+    });
+    std::vector<Hit> hits;
+    hits.reserve(best.size());
+    for (const auto& [score, row] : best) {
+        hits.push_back(Hit{ids_[row], score});
+    }
+    return hits;
+}
+
+std::vector<QuantizedVectorIndex::Hit> QuantizedVectorIndex::search(const std::vector<float>& query, size_t k,
+                                                                     float threshold) const {
+    if (k == 0 || ids_.empty() || query.size() != dimension_) {
+        return {};
+    }
+
+    vector_kernels::AlignedFloats normalized(stride_);
+    vector_kernels::normalize_into(query.data(), dimension_, normalized.data());
+    if (!trained_) {
+        return search_full(normalized.data(), k, threshold);
+    }
+
+    // With re-ranking, the threshold applies to exact scores only
+    const bool rerank = config_.rerank_candidates > 0;
+    const size_t shortlist = rerank ? std::max(k, config_.rerank_candidates) : k;
+    const float code_threshold = rerank ? std::numeric_limits<float>::lowest() : threshold;
+
+    std::vector<std::pair<float, size_t>> best;
+    if (config_.encoding == Encoding::Scalar8) {
+        // q . x = sum q[i] * minimum[i] + sum (q[i] * step[i]) * code[i]
+        vector_kernels::AlignedFloats weights(stride_, 0.0f);
+        float bias = 0.0f;
+        for (size_t i = 0; i < dimension_; ++i) {
+            weights[i] = normalized[i] * step_[i];
+            bias += normalized[i] * minimum_[i];
+        }
+        best = top_k(ids_.size(), shortlist, code_threshold, [&](size_t row) {
+            return bias + code_dot_(weights.data(), codes_.data() + row * code_size_, code_size_);
+        });
+    } else {
+        // Similarity of each query sub-vector to each of its centroids
+        std::vector<float> table(code_size_ * CENTROIDS, 0.0f);
+        for (size_t part = 0; part < code_size_; ++part) {
+            const size_t begin = offsets_[part];
+            const size_t width = offsets_[part + 1] - begin;
+            const float* centroids = centroids_.data() + CENTROIDS * begin;
+            float* entry = table.data() + part * CENTROIDS;
+            for (size_t i = 0; i < width; ++i) {
+                const float weight = normalized[begin + i];
+                const float* column = centroids + i * CENTROIDS;
+                for (size_t c = 0; c < CENTROIDS; ++c) {
+                    entry[c] += weight * column[c];
+                }
+            }
+        }
+        best = top_k(ids_.size(), shortlist, code_threshold, [&](size_t row) {
+            const uint8_t* code = codes_.data() + row * code_size_;
+            const float* entry = table.data();
+            float sum = 0.0f;
+            for (size_t part = 0; part < code_size_; ++part, entry += CENTROIDS) {
+                sum += entry[code[part]];
+            }
+            return sum;
+        });
+    }
+
+    if (rerank) {
+        for (auto& [score, row] : best) {
+            score = dot_(normalized.data(), full_.data() + row * stride_, stride_);
+        }
+        best.erase(std::remove_if(best.begin(), best.end(),
+                                  [threshold](const auto& candidate) { return candidate.first < threshold; }),
+                   best.end());
+        std::sort(best.begin(), best.end(), std::greater<>());
+        if (best.size() > k) {
+            best.resize(k);
+        }
+    }
+
+    std::vector<Hit> hits;
+    hits.reserve(best.size());
+    for (const auto& [score, row] : best) {
+        hits.push_back(Hit{ids_[row], score});
+    }
+    return hits;
+}
+
+void QuantizedVectorIndex::serialize(std::string& out) const {
+    index_io::Writer writer(out);
+    writer.put<uint32_t>(QUANTIZED_INDEX_TAG);
+    writer.put<uint32_t>(static_cast<uint32_t>(config_.encoding));
+    writer.put<uint64_t>(dimension_);
+    writer.put<uint64_t>(config_.encoding == Encoding::Product ? code_size_ : 0);
+    writer.put<uint64_t>(ids_.size());
+    writer.put<uint8_t>(trained_ ? 1 : 0);
+    writer.put<uint8_t>(full_.empty() ? 0 : 1);
+    for (const auto& id : ids_) {
+        writer.put_string(id);
+    }
+    writer.put_array(full_, full_.size());
+    writer.put_array(codes_, codes_.size());
+    writer.put_array(minimum_, minimum_.size());
+    writer.put_array(step_, step_.size());
+    writer.put_array(centroids_, centroids_.size());
+}
+
+bool QuantizedVectorIndex::deserialize(const char* data, size_t size) {
+    clear();
+    index_io::Reader reader(data, size);
+    uint32_t tag, encoding;
+    uint64_t dimension, subvectors, count;
+    uint8_t trained, has_full;
+    if (!reader.get(tag) || tag != QUANTIZED_INDEX_TAG || !reader.get(encoding) ||
+        encoding > static_cast<uint32_t>(Encoding::Product) || !reader.get(dimension) || !reader.get(subvectors) ||
+        !reader.get(count) || count > size || !reader.get(trained) || !reader.get(has_full)) {
+        return false;
+    }
+
+    // The code layout follows the encoding the index was written with
+    config_.encoding = static_cast<Encoding>(encoding);
+    if (config_.encoding == Encoding::Product) {
+        config_.pq_subvectors = static_cast<size_t>(subvectors);
+    }
+    set_dimension(static_cast<size_t>(dimension));
+    trained_ = trained != 0;
+
+    auto fail = [this] {
+        clear();
+        return false;
+    };
+    const size_t rows = static_cast<size_t>(count);
+    const bool scalar = config_.encoding == Encoding::Scalar8;
+    ids_.reserve(rows);
+    rows_.reserve(rows);
+    std::string id;
+    for (size_t row = 0; row < rows; ++row) {
+        if (!reader.get_string(id)) {
+            return fail();
+        }
+        rows_.emplace(id, ids_.size());
+        ids_.push_back(std::move(id));
+    }
+    if (rows_.size() != rows || (!trained_ && !has_full) ||
+        !reader.get_array(full_, has_full ? rows * stride_ : 0) ||
+        !reader.get_array(codes_, trained_ ? rows * code_size_ : 0) ||
+        !reader.get_array(minimum_, trained_ && scalar ? stride_ : 0) ||
+        !reader.get_array(step_, trained_ && scalar ? stride_ : 0) ||
+        !reader.get_array(centroids_, trained_ && !scalar ? CENTROIDS * dimension_ : 0) || !reader.at_end()) {
+        return fail();
+    }
+    if (trained_ && !scalar) {
+        compute_centroid_norms();
+    }
+
+    // Re-ranking needs the full-precision rows
+    if (trained_ && full_.empty()) {
+        config_.rerank_candidates = 0;
+    } else if (!keeps_full()) {
+        vector_kernels::AlignedFloats().swap(full_);
+    }
+    return true;
+}
+
+}  // namespace kolosal
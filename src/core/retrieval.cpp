@@ -1,10 +1,17 @@
 #include "../include/functions/retrieval.hpp"
+#include "../include/stream_channel.hpp"
+#include "../include/file_sync.hpp"
 #include <algorithm>
+#include <atomic>
 #include <random>
 #include <future>
 #include <sstream>
 #include <cmath>
+#include <filesystem>
 #include <fstream>
+#include <iostream>
+#include <map>
+#include <thread>
 
 namespace kolosal {
 
@@ -110,6 +117,11 @@ bool QdrantVectorStore::create_collection(const std::string& collection_name, si
     // - Configure indexing parameters
     
     collection_name_ = collection_name;
+    
+    std::unique_lock<std::shared_mutex> lock(data_mutex_);
+    if (index_.size() == 0) {
+        index_ = FlatVectorIndex(vector_size);
+    }
     return true;
 }
 
@@ -128,11 +140,15 @@ std::string QdrantVectorStore::add_document(const Document& document, const std:
     // Store locally for this demo
     VectorPoint point;
     point.id = point_id;
-    point.vector = embedding;
     point.payload = document.to_json();
     
-    std::lock_guard<std::mutex> lock(data_mutex_);
-    points_[point_id] = point;
+    std::unique_lock<std::shared_mutex> lock(data_mutex_);
+    if (!index_.add(point_id, embedding)) {
+        std::cerr << "[QdrantVectorStore] Rejected embedding of size " << embedding.size()
+                  << " for a collection of dimension " << index_.dimension() << std::endl;
+        return "";
+    }
+    points_[point_id] = std::move(point);
     
     return point_id;
 }
@@ -141,32 +157,17 @@ std::vector<VectorSearchResult> QdrantVectorStore::search(const std::vector<floa
                                                          size_t limit, float threshold) {
     if (!connected_) return {};
     
-    std::vector<VectorSearchResult> results;
-    
     // Placeholder search implementation using local storage
-    std::lock_guard<std::mutex> lock(data_mutex_);
-    
-    for (const auto& [id, point] : points_) {
-        float similarity = cosine_similarity(query_vector, point.vector);
-        
-        if (similarity >= threshold) {
-            VectorSearchResult result;
-            result.id = id;
-            result.score = similarity;
-            result.payload = point.payload;
-            results.push_back(result);
-        }
-    }
-    
-    // Sort by similarity score (descending)
-    std::sort(results.begin(), results.end(), 
-              [](const VectorSearchResult& a, const VectorSearchResult& b) {
-                  return a.score > b.score;
-              });
+    std::shared_lock<std::shared_mutex> lock(data_mutex_);
     
-    // Limit results
-    if (results.size() > limit) {
-        results.resize(limit);
+    // Payloads are copied for the winners only
+    std::vector<VectorSearchResult> results;
+    for (auto& hit : index_.search(query_vector, limit, threshold)) {
+        VectorSearchResult result;
+        result.score = hit.score;
+        result.payload = points_.at(hit.id).payload;
+        result.id = std::move(hit.id);
+        results.push_back(std::move(result));
     }
     
     return results;
@@ -175,7 +176,8 @@ std::vector<VectorSearchResult> QdrantVectorStore::search(const std::vector<floa
 bool QdrantVectorStore::delete_document(const std::string& document_id) {
     if (!connected_) return false;
     
-    std::lock_guard<std::mutex> lock(data_mutex_);
+    std::unique_lock<std::shared_mutex> lock(data_mutex_);
+    index_.remove(document_id);
     return points_.erase(document_id) > 0;
 }
 
@@ -240,109 +242,491 @@ std::string QdrantVectorStore::generate_uuid() {
 }
 
 // FAISSVectorStore Implementation
-FAISSVectorStore::FAISSVectorStore(size_t dimension, const std::string& index_type)
-    : dimension_(dimension), index_type_(index_type), index_(nullptr) {}
+FAISSVectorStore::FAISSVectorStore(size_t dimension, const std::string& index_type,
+                                   const HnswIndex::Config& hnsw_config,
+                                   const QuantizedVectorIndex::Config& quantized_config)
+    : dimension_(dimension), index_type_(index_type), initialized_(false), hnsw_config_(hnsw_config),
+      quantized_config_(quantized_config) {}
 
 FAISSVectorStore::~FAISSVectorStore() {
     // Placeholder for FAISS index cleanup
     // In real implementation, delete index_ if it exists
 }
 
+std::unique_ptr<IVectorIndex> FAISSVectorStore::create_index() const {
+    if (index_type_ == "HNSW") {
+        return std::make_unique<HnswIndex>(dimension_, hnsw_config_);
+    }
+    if (index_type_ == "SQ8" || index_type_ == "PQ") {
+        QuantizedVectorIndex::Config config = quantized_config_;
+        config.encoding = index_type_ == "PQ" ? QuantizedVectorIndex::Encoding::Product
+                                              : QuantizedVectorIndex::Encoding::Scalar8;
+        return std::make_unique<QuantizedVectorIndex>(dimension_, config);
+    }
+    if (index_type_ != "Flat") {
+        std::cerr << "[FAISSVectorStore] Index type '" << index_type_
+                  << "' is not available; using Flat" << std::endl;
+    }
+    return std::make_unique<FlatVectorIndex>(dimension_);
+}
+
 bool FAISSVectorStore::initialize() {
-    // Placeholder for FAISS index initialization
-    // In real implementation:
-    // - Create appropriate FAISS index type (Flat, IVF, HNSW, etc.)
-    // - Set search parameters
-    // - Initialize with dimension
+    std::unique_lock<std::shared_mutex> lock(data_mutex_);
+    index_ = create_index();
+    documents_.clear();
+    mapped_documents_.clear();
+    mapping_.reset();
+    
+    // The next save starts a new file rather than appending to the old one
+    persisted_path_.clear();
+    pending_additions_.clear();
+    pending_removals_.clear();
     
     initialized_ = true;
     return true;
 }
 
+void FAISSVectorStore::track_addition(const std::string& id, const std::vector<float>& embedding) {
+    // Only changes since the last save are kept; removals are replayed first
+    mapped_documents_.erase(id);
+    if (!persisted_path_.empty()) {
+        pending_additions_[id] = embedding;
+    }
+}
+
+json FAISSVectorStore::document_payload(const std::string& id) const {
+    auto document = documents_.find(id);
+    if (document != documents_.end()) {
+        return document->second.to_json();
+    }
+    auto mapped = mapped_documents_.find(id);
+    if (mapped != mapped_documents_.end()) {
+        return json::parse(mapped->second);
+    }
+    return json::object();
+}
+
 std::string FAISSVectorStore::add_document(const Document& document, const std::vector<float>& embedding) {
     if (!initialized_) return "";
     
     std::string doc_id = document.id.empty() ? generate_uuid() : document.id;
     
     // Store document and embedding
-    std::lock_guard<std::mutex> lock(data_mutex_);
+    std::unique_lock<std::shared_mutex> lock(data_mutex_);
+    if (!index_->add(doc_id, embedding)) {
+        std::cerr << "[FAISSVectorStore] Rejected embedding of size " << embedding.size()
+                  << " for an index of dimension " << index_->dimension() << std::endl;
+        return "";
+    }
     documents_[doc_id] = document;
-    embeddings_[doc_id] = embedding;
-    
-    // In real FAISS implementation:
-    // - Add vector to index
-    // - Map index ID to document ID
+    track_addition(doc_id, embedding);
     
     return doc_id;
 }
 
+std::vector<std::string> FAISSVectorStore::add_documents(const std::vector<Document>& documents,
+                                                         const std::vector<std::vector<float>>& embeddings) {
+    std::vector<std::string> ids(documents.size());
+    if (!initialized_) return ids;
+    
+    for (size_t i = 0; i < documents.size(); ++i) {
+        ids[i] = documents[i].id.empty() ? generate_uuid() : documents[i].id;
+    }
+    
+    std::unique_lock<std::shared_mutex> lock(data_mutex_);
+    std::vector<bool> added = index_->add_batch(ids, embeddings, hnsw_config_.build_threads);
+    if (documents_.size() + documents.size() > documents_.bucket_count() * documents_.max_load_factor()) {
+        documents_.reserve(std::max(documents_.size() + documents.size(), documents_.size() * 2));
+    }
+    for (size_t i = 0; i < documents.size(); ++i) {
+        if (added[i]) {
+            documents_[ids[i]] = documents[i];
+            track_addition(ids[i], embeddings[i]);
+        } else {
+            ids[i].clear();
+        }
+    }
+    
+    return ids;
+}
+
 std::vector<VectorSearchResult> FAISSVectorStore::search(const std::vector<float>& query_vector, 
                                                         size_t k, float threshold) {
     if (!initialized_) return {};
     
+    std::shared_lock<std::shared_mutex> lock(data_mutex_);
+    
+    // Payloads are built for the winners only
     std::vector<VectorSearchResult> results;
+    for (auto& hit : index_->search(query_vector, k, threshold)) {
+        VectorSearchResult result;
+        result.score = hit.score;
+        result.payload = document_payload(hit.id);
+        result.id = std::move(hit.id);
+        results.push_back(std::move(result));
+    }
+    
+    return results;
+}
+
+bool FAISSVectorStore::delete_document(const std::string& document_id) {
+    std::unique_lock<std::shared_mutex> lock(data_mutex_);
+    bool found = documents_.erase(document_id) > 0;
+    found = mapped_documents_.erase(document_id) > 0 || found;
+    if (index_) {
+        found = index_->remove(document_id) || found;
+    }
+    if (found && !persisted_path_.empty()) {
+        pending_additions_.erase(document_id);
+        pending_removals_.insert(document_id);
+    }
+    return found;
+}
+
+// Index file layout, in host byte order:
+//   file header:     magic "KVSTORE\0", u32 version, u32 byte-order mark
+//   segment header:  u32 magic "KSEG", u32 kind, u64 payload size, u32 CRC-32 of the payload, u32 reserved
+//   base payload:    index type, u64 dimension, u64 document count,
+//                    per document: id and document JSON, then the serialised index
+//   append payload:  u64 removal count, removed ids,
+//                    u64 addition count, per addition: id, document JSON, embedding
+// Strings are u64 length-prefixed. The first segment is always the base.
+namespace {
+    constexpr char INDEX_FILE_MAGIC[8] = {'K', 'V', 'S', 'T', 'O', 'R', 'E', '\0'};
+    constexpr uint32_t INDEX_FILE_VERSION = 1;
+    constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+    constexpr uint32_t SEGMENT_MAGIC = 0x4745534B;  // "KSEG"
+    constexpr uint32_t BASE_SEGMENT = 1;
+    constexpr uint32_t APPEND_SEGMENT = 2;
+    constexpr size_t FILE_HEADER_SIZE = 16;
+    constexpr size_t SEGMENT_HEADER_SIZE = 24;
+    
+    std::string file_header() {
+        std::string header;
+        index_io::Writer writer(header);
+        writer.put_bytes(INDEX_FILE_MAGIC, sizeof(INDEX_FILE_MAGIC));
+        writer.put<uint32_t>(INDEX_FILE_VERSION);
+        writer.put<uint32_t>(BYTE_ORDER_MARK);
+        return header;
+    }
     
-    // Placeholder search using brute force
-    std::lock_guard<std::mutex> lock(data_mutex_);
+    std::string segment_header(uint32_t kind, uint64_t size, uint32_t crc) {
+        std::string header;
+        index_io::Writer writer(header);
+        writer.put<uint32_t>(SEGMENT_MAGIC);
+        writer.put<uint32_t>(kind);
+        writer.put<uint64_t>(size);
+        writer.put<uint32_t>(crc);
+        writer.put<uint32_t>(0);
+        return header;
+    }
     
-    for (const auto& [doc_id, embedding] : embeddings_) {
-        float similarity = cosine_similarity(query_vector, embedding);
-        
-        if (similarity >= threshold) {
-            VectorSearchResult result;
-            result.id = doc_id;
-            result.score = similarity;
-            result.payload = documents_[doc_id].to_json();
-            results.push_back(result);
-        }
+    bool write_all(std::FILE* file, const std::string& data) {
+        return std::fwrite(data.data(), 1, data.size(), file) == data.size();
     }
     
-    // Sort and limit
-    std::sort(results.begin(), results.end(),
-              [](const VectorSearchResult& a, const VectorSearchResult& b) {
-                  return a.score > b.score;
-              });
+    struct AppendSegment {
+        std::vector<std::string> removals;
+        std::vector<std::string> ids;
+        std::vector<std::string_view> documents;
+        std::vector<std::vector<float>> embeddings;
+    };
     
-    if (results.size() > k) {
-        results.resize(k);
+    bool parse_append_segment(index_io::Reader& reader, size_t dimension, AppendSegment& segment) {
+        uint64_t count;
+        if (!reader.get(count)) {
+            return false;
+        }
+        for (uint64_t i = 0; i < count; ++i) {
+            std::string id;
+            if (!reader.get_string(id)) {
+                return false;
+            }
+            segment.removals.push_back(std::move(id));
+        }
+        if (!reader.get(count)) {
+            return false;
+        }
+        for (uint64_t i = 0; i < count; ++i) {
+            std::string id;
+            std::string_view document;
+            std::vector<float> embedding;
+            if (!reader.get_string(id) || !reader.get_view(document) || !reader.get_array(embedding, dimension)) {
+                return false;
+            }
+            segment.ids.push_back(std::move(id));
+            segment.documents.push_back(document);
+            segment.embeddings.push_back(std::move(embedding));
+        }
+        return reader.at_end();
     }
+}
+
+bool FAISSVectorStore::save_index(const std::string& filepath) {
+    std::unique_lock<std::shared_mutex> lock(data_mutex_);
+    if (!initialized_) return false;
     
-    return results;
+    // Small changes are appended; the file is compacted once appends pile up
+    bool can_append = filepath == persisted_path_ && persisted_segments_ < MAX_APPEND_SEGMENTS &&
+                      persisted_append_bytes_ <= persisted_base_bytes_ && std::filesystem::exists(filepath);
+    return can_append ? write_append_segment() : write_base(filepath);
 }
 
-bool FAISSVectorStore::delete_document(const std::string& document_id) {
-    std::lock_guard<std::mutex> lock(data_mutex_);
-    documents_.erase(document_id);
-    embeddings_.erase(document_id);
+bool FAISSVectorStore::write_append_segment() {
+    if (pending_additions_.empty() && pending_removals_.empty()) {
+        return true;
+    }
+    
+    std::string payload;
+    index_io::Writer writer(payload);
+    writer.put<uint64_t>(pending_removals_.size());
+    for (const auto& id : pending_removals_) {
+        writer.put_string(id);
+    }
+    writer.put<uint64_t>(pending_additions_.size());
+    for (const auto& [id, embedding] : pending_additions_) {
+        writer.put_string(id);
+        writer.put_string(documents_.at(id).to_json().dump());
+        writer.put_array(embedding, embedding.size());
+    }
+    
+    std::FILE* file = std::fopen(persisted_path_.c_str(), "ab");
+    if (!file) {
+        std::cerr << "[FAISSVectorStore] Cannot append to index file " << persisted_path_ << std::endl;
+        return false;
+    }
+    // Synced before the save reports success, so a saved segment survives a power cut
+    bool written = write_all(file, segment_header(APPEND_SEGMENT, payload.size(),
+                                                  index_io::crc32(payload.data(), payload.size()))) &&
+                   write_all(file, payload) && file_sync::sync_file(file);
+    written = std::fclose(file) == 0 && written;
+    if (!written) {
+        // The torn segment fails its checksum on load; rewrite the file next time
+        std::cerr << "[FAISSVectorStore] Failed to append to index file " << persisted_path_ << std::endl;
+        persisted_segments_ = MAX_APPEND_SEGMENTS;
+        return false;
+    }
+    
+    ++persisted_segments_;
+    persisted_append_bytes_ += SEGMENT_HEADER_SIZE + payload.size();
+    pending_additions_.clear();
+    pending_removals_.clear();
     return true;
 }
 
-void FAISSVectorStore::save_index(const std::string& filepath) {
-    // Placeholder for FAISS index serialization
-    std::ofstream file(filepath, std::ios::binary);
-    if (file.is_open()) {
-        // In real implementation, serialize FAISS index and metadata
-        nlohmann::json metadata;
-        metadata["dimension"] = dimension_;
-        metadata["index_type"] = index_type_;
-        metadata["document_count"] = documents_.size();
-        
-        std::string meta_str = metadata.dump();
-        file.write(meta_str.c_str(), meta_str.size());
-        file.close();
+bool FAISSVectorStore::write_base(const std::string& filepath) {
+    // Documents first, remembering where each one's JSON lands so it can be
+    // served from the new file once it is mapped
+    std::string payload;
+    index_io::Writer writer(payload);
+    writer.put_string(index_type_);
+    writer.put<uint64_t>(index_->dimension());
+    writer.put<uint64_t>(documents_.size() + mapped_documents_.size());
+    std::vector<std::pair<std::string, std::pair<size_t, size_t>>> locations;
+    locations.reserve(documents_.size() + mapped_documents_.size());
+    auto put_document = [&](const std::string& id, std::string_view document) {
+        writer.put_string(id);
+        writer.put<uint64_t>(document.size());
+        locations.emplace_back(id, std::make_pair(writer.size(), document.size()));
+        writer.put_bytes(document.data(), document.size());
+    };
+    for (const auto& [id, document] : documents_) {
+        put_document(id, document.to_json().dump());
     }
+    for (const auto& [id, document] : mapped_documents_) {
+        put_document(id, document);
+    }
+    
+    std::string index;
+    index_->serialize(index);
+    writer.put<uint64_t>(index.size());
+    uint32_t crc = index_io::crc32(index.data(), index.size(), index_io::crc32(payload.data(), payload.size()));
+    
+    // Written beside the target and swapped in, so a crash leaves the old file intact
+    std::string temp_path = filepath + ".tmp";
+    std::FILE* file = std::fopen(temp_path.c_str(), "wb");
+    if (!file) {
+        std::cerr << "[FAISSVectorStore] Cannot write index file " << temp_path << std::endl;
+        return false;
+    }
+    // Synced before the rename, so the rename cannot reach disk ahead of the data
+    bool written = write_all(file, file_header()) &&
+                   write_all(file, segment_header(BASE_SEGMENT, payload.size() + index.size(), crc)) &&
+                   write_all(file, payload) && write_all(file, index) && file_sync::sync_file(file);
+    written = std::fclose(file) == 0 && written;
+    if (!written) {
+        std::cerr << "[FAISSVectorStore] Failed to write index file " << temp_path << std::endl;
+        std::remove(temp_path.c_str());
+        return false;
+    }
+    
+    // Documents move into the new mapping; the old one must be released
+    // before the rename on platforms that lock mapped files
+    std::vector<std::pair<std::string, std::string>> copies;
+    if (mapping_) {
+        for (const auto& [id, document] : mapped_documents_) {
+            copies.emplace_back(id, std::string(document));
+        }
+        mapped_documents_.clear();
+        mapping_.reset();
+    }
+    std::error_code error;
+    std::filesystem::rename(temp_path, filepath, error);
+    if (!error && !file_sync::sync_parent_directory(filepath)) {
+        std::cerr << "[FAISSVectorStore] Cannot sync the directory of index file " << filepath << std::endl;
+    }
+    auto mapping = std::make_unique<index_io::MappedFile>();
+    if (error || !mapping->open(filepath)) {
+        std::cerr << "[FAISSVectorStore] Cannot replace index file " << filepath << std::endl;
+        for (const auto& [id, document] : copies) {
+            documents_[id] = Document::from_json(json::parse(document));
+        }
+        persisted_path_.clear();
+        return false;
+    }
+    
+    const size_t payload_offset = FILE_HEADER_SIZE + SEGMENT_HEADER_SIZE;
+    documents_.clear();
+    mapped_documents_.reserve(locations.size());
+    for (const auto& [id, location] : locations) {
+        mapped_documents_[id] = std::string_view(mapping->data() + payload_offset + location.first, location.second);
+    }
+    mapping_ = std::move(mapping);
+    persisted_path_ = filepath;
+    persisted_segments_ = 0;
+    persisted_base_bytes_ = payload.size() + index.size();
+    persisted_append_bytes_ = 0;
+    pending_additions_.clear();
+    pending_removals_.clear();
+    return true;
 }
 
 bool FAISSVectorStore::load_index(const std::string& filepath) {
-    // Placeholder for FAISS index deserialization
-    std::ifstream file(filepath, std::ios::binary);
-    if (file.is_open()) {
-        // In real implementation, deserialize FAISS index and metadata
-        file.close();
-        initialized_ = true;
+    auto mapping = std::make_unique<index_io::MappedFile>();
+    if (!mapping->open(filepath)) {
+        std::cerr << "[FAISSVectorStore] Cannot open index file " << filepath << std::endl;
+        return false;
+    }
+    
+    index_io::Reader header(mapping->data(), mapping->size());
+    char magic[sizeof(INDEX_FILE_MAGIC)];
+    uint32_t version, byte_order;
+    for (char& c : magic) {
+        header.get(c);
+    }
+    if (!header.get(version) || !header.get(byte_order) ||
+        !std::equal(magic, magic + sizeof(magic), INDEX_FILE_MAGIC)) {
+        std::cerr << "[FAISSVectorStore] " << filepath << " is not an index file" << std::endl;
+        return false;
+    }
+    if (version != INDEX_FILE_VERSION || byte_order != BYTE_ORDER_MARK) {
+        std::cerr << "[FAISSVectorStore] Index file " << filepath << " has version " << version
+                  << " or byte order it cannot read" << std::endl;
+        return false;
+    }
+    
+    // Segment headers are checked before their payloads are touched
+    size_t offset = FILE_HEADER_SIZE;
+    auto next_segment = [&](uint32_t& kind, index_io::Reader& payload) {
+        if (mapping->size() - offset < SEGMENT_HEADER_SIZE) {
+            return false;
+        }
+        index_io::Reader reader(mapping->data() + offset, SEGMENT_HEADER_SIZE);
+        uint32_t magic_value, crc, reserved;
+        uint64_t size;
+        reader.get(magic_value);
+        reader.get(kind);
+        reader.get(size);
+        reader.get(crc);
+        reader.get(reserved);
+        const char* data = mapping->data() + offset + SEGMENT_HEADER_SIZE;
+        if (magic_value != SEGMENT_MAGIC || size > mapping->size() - offset - SEGMENT_HEADER_SIZE ||
+            index_io::crc32(data, static_cast<size_t>(size)) != crc) {
+            return false;
+        }
+        payload = index_io::Reader(data, static_cast<size_t>(size));
+        offset += SEGMENT_HEADER_SIZE + static_cast<size_t>(size);
         return true;
+    };
+    
+    uint32_t kind;
+    index_io::Reader base(nullptr, 0);
+    if (!next_segment(kind, base) || kind != BASE_SEGMENT) {
+        std::cerr << "[FAISSVectorStore] Index file " << filepath << " has a damaged base segment" << std::endl;
+        return false;
+    }
+    const size_t base_bytes = offset - FILE_HEADER_SIZE - SEGMENT_HEADER_SIZE;
+    
+    std::string index_type;
+    uint64_t dimension, count;
+    if (!base.get_string(index_type) || !base.get(dimension) || !base.get(count)) {
+        std::cerr << "[FAISSVectorStore] Index file " << filepath << " has a damaged base segment" << std::endl;
+        return false;
+    }
+    if (index_type != index_type_ || (dimension_ != 0 && dimension != dimension_)) {
+        std::cerr << "[FAISSVectorStore] Index file " << filepath << " holds a " << index_type
+                  << " index of dimension " << dimension << ", not " << index_type_ << " of dimension "
+                  << dimension_ << std::endl;
+        return false;
     }
-    return false;
+    
+    std::unordered_map<std::string, std::string_view> documents;
+    documents.reserve(static_cast<size_t>(std::min<uint64_t>(count, mapping->size())));
+    std::string_view index_data;
+    for (uint64_t i = 0; i < count; ++i) {
+        std::string id;
+        std::string_view document;
+        if (!base.get_string(id) || !base.get_view(document)) {
+            std::cerr << "[FAISSVectorStore] Index file " << filepath << " has a damaged document table" << std::endl;
+            return false;
+        }
+        documents.emplace(std::move(id), document);
+    }
+    auto index = create_index();
+    if (!base.get_view(index_data) || !base.at_end() || !index->deserialize(index_data.data(), index_data.size())) {
+        std::cerr << "[FAISSVectorStore] Index file " << filepath << " has a damaged index" << std::endl;
+        return false;
+    }
+    
+    // Append segments in order; a damaged one ends the replay
+    size_t segments = 0;
+    bool damaged = false;
+    while (offset < mapping->size()) {
+        AppendSegment segment;
+        index_io::Reader payload(nullptr, 0);
+        if (!next_segment(kind, payload) || kind != APPEND_SEGMENT ||
+            !parse_append_segment(payload, static_cast<size_t>(dimension), segment)) {
+            std::cerr << "[FAISSVectorStore] Index file " << filepath << " has a damaged segment at byte "
+                      << offset << "; ignoring the rest" << std::endl;
+            damaged = true;
+            break;
+        }
+        for (const auto& id : segment.removals) {
+            documents.erase(id);
+            index->remove(id);
+        }
+        std::vector<bool> added = index->add_batch(segment.ids, segment.embeddings, hnsw_config_.build_threads);
+        for (size_t i = 0; i < segment.ids.size(); ++i) {
+            if (added[i]) {
+                documents[segment.ids[i]] = segment.documents[i];
+            }
+        }
+        ++segments;
+    }
+    
+    std::unique_lock<std::shared_mutex> lock(data_mutex_);
+    index_ = std::move(index);
+    documents_.clear();
+    mapped_documents_ = std::move(documents);
+    mapping_ = std::move(mapping);
+    persisted_path_ = filepath;
+    persisted_segments_ = damaged ? MAX_APPEND_SEGMENTS : segments;
+    persisted_base_bytes_ = base_bytes;
+    persisted_append_bytes_ = offset - FILE_HEADER_SIZE - SEGMENT_HEADER_SIZE - base_bytes;
+    pending_additions_.clear();
+    pending_removals_.clear();
+    initialized_ = true;
+    return true;
 }
 
 std::string FAISSVectorStore::generate_uuid() {
@@ -379,19 +763,45 @@ bool RetrievalManager::initialize(const RetrievalConfig& config) {
     }
     
     if (config_.use_faiss) {
+        HnswIndex::Config hnsw;
+        hnsw.M = config_.hnsw_m;
+        hnsw.ef_construction = config_.hnsw_ef_construction;
+        hnsw.ef_search = config_.hnsw_ef_search;
+        hnsw.build_threads = config_.index_build_threads;
+        QuantizedVectorIndex::Config quantized;
+        quantized.pq_subvectors = config_.pq_subvectors;
+        quantized.training_size = config_.quantizer_training_size;
+        quantized.rerank_candidates = config_.rerank_candidates;
+        quantized.build_threads = config_.index_build_threads;
         faiss_store_ = std::make_unique<FAISSVectorStore>(
-            config_.embedding_dimension, config_.faiss_index_type
+            config_.embedding_dimension, config_.faiss_index_type, hnsw, quantized
         );
         
         if (!faiss_store_->initialize()) {
             return false;
         }
+        
+        // A saved store comes back without re-embedding its documents
+        if (!config_.faiss_index_path.empty() && std::filesystem::exists(config_.faiss_index_path)) {
+            faiss_store_->load_index(config_.faiss_index_path);
+        }
     }
     
     initialized_ = true;
     return true;
 }
 
+void RetrievalManager::set_embedding_function(BatchEmbeddingFunction function) {
+    embedding_function_ = std::move(function);
+}
+
+bool RetrievalManager::save_index() {
+    if (!faiss_store_ || config_.faiss_index_path.empty()) {
+        return false;
+    }
+    return faiss_store_->save_index(config_.faiss_index_path);
+}
+
 std::string RetrievalManager::add_document(const Document& document) {
     if (!initialized_) return "";
     
@@ -421,35 +831,203 @@ std::string RetrievalManager::add_document(const Document& document) {
     return doc_id;
 }
 
+namespace {
+    // Chunks travelling through the ingestion pipeline together
+    struct IngestBatch {
+        size_t sequence = 0;              // Position in the input; the writer stores in this order
+        std::vector<Document> chunks;
+        std::vector<size_t> owners;       // Input document of each chunk
+        std::vector<bool> last_chunk;     // Whether the chunk completes its document
+        std::vector<std::vector<float>> embeddings;
+    };
+    
+    std::string generate_document_id() {
+        static thread_local std::mt19937 gen(std::random_device{}());
+        std::uniform_int_distribution<> dis(0, 15);
+        std::stringstream ss;
+        ss << std::hex;
+        for (int i = 0; i < 32; i++) {
+            ss << dis(gen);
+        }
+        return ss.str();
+    }
+}
+
 std::vector<std::string> RetrievalManager::batch_add_documents(const std::vector<Document>& documents) {
-    std::vector<std::string> ids;
-    ids.reserve(documents.size());
-    
-    // Process in parallel batches
-    const size_t batch_size = 100;
-    std::vector<std::future<std::vector<std::string>>> futures;
+    std::vector<std::string> ids(documents.size());
+    if (!initialized_ || documents.empty()) return ids;
+    
+    const size_t batch_size = std::max<size_t>(1, config_.embedding_batch_size);
+    size_t embed_threads = config_.ingest_threads > 0 ? config_.ingest_threads
+                                                      : std::max(1u, std::thread::hardware_concurrency());
+    embed_threads = std::min(embed_threads, (documents.size() + batch_size - 1) / batch_size);
+    
+    StreamChannel<IngestBatch> to_embed(config_.max_inflight_batches);
+    StreamChannel<IngestBatch> to_store(config_.max_inflight_batches);
+    std::vector<bool> failed(documents.size(), false);  // Written by the writer thread only
+    std::vector<std::string> assigned(documents.size());
+    for (size_t d = 0; d < documents.size(); ++d) {
+        assigned[d] = documents[d].id.empty() ? generate_document_id() : documents[d].id;
+    }
     
-    for (size_t i = 0; i < documents.size(); i += batch_size) {
-        size_t end = std::min(i + batch_size, documents.size());
-        
-        auto batch_future = std::async(std::launch::async, [this, &documents, i, end]() {
-            std::vector<std::string> batch_ids;
-            for (size_t j = i; j < end; ++j) {
-                std::string id = add_document(documents[j]);
-                batch_ids.push_back(id);
+    // Stages run on the shared scheduler; their channel waits are marked
+    // blocking, so the group's tasks never starve other scheduler work
+    TaskGroup tasks(TaskScheduler::shared(), TaskScheduler::Priority::NORMAL, embed_threads + 1);
+    std::atomic<size_t> embedders{embed_threads};  // The last one to finish ends the writer's stream
+    for (size_t t = 0; t < embed_threads; ++t) {
+        tasks.submit([this, &to_embed, &to_store, &embedders]() {
+            std::vector<IngestBatch> taken;
+            while (to_embed.pop_batch(taken, 1) > 0) {
+                IngestBatch& batch = taken.front();
+                std::vector<std::string> texts;
+                texts.reserve(batch.chunks.size());
+                for (const auto& chunk : batch.chunks) {
+                    texts.push_back(chunk.content);
+                }
+                try {
+                    batch.embeddings = generate_embeddings(texts);
+                } catch (const std::exception& e) {
+                    // The writer fails the batch's documents
+                    std::cerr << "[RetrievalManager] Embedding a batch of " << texts.size()
+                              << " chunks failed: " << e.what() << std::endl;
+                    batch.embeddings.clear();
+                }
+                if (!to_store.push(std::move(batch))) {
+                    break;
+                }
+            }
+            if (--embedders == 0) {
+                to_store.close();
             }
-            return batch_ids;
         });
-        
-        futures.push_back(std::move(batch_future));
     }
     
-    // Collect results
-    for (auto& future : futures) {
-        auto batch_ids = future.get();
-        ids.insert(ids.end(), batch_ids.begin(), batch_ids.end());
+    // Batches finish embedding out of order; the writer holds early arrivals
+    // back so a repeated id ends up the way sequential adds would leave it.
+    // A document that fails has the chunks it already stored removed again.
+    tasks.submit([this, &to_embed, &to_store, &documents, &assigned, &ids, &failed]() {
+        std::map<size_t, std::vector<std::string>> partial;  // Stored chunk ids of unfinished documents
+        try {
+            std::map<size_t, IngestBatch> early;
+            size_t next_sequence = 0;
+            std::vector<IngestBatch> taken;
+            while (to_store.pop_batch(taken, 1) > 0) {
+                early.emplace(taken.front().sequence, std::move(taken.front()));
+                for (auto it = early.begin(); it != early.end() && it->first == next_sequence;
+                     it = early.erase(it), ++next_sequence) {
+                    IngestBatch& batch = it->second;
+                    const size_t count = batch.chunks.size();
+                    std::vector<bool> stored(count, false);
+                    
+                    if (batch.embeddings.size() == count) {
+                        stored.assign(count, true);
+                        if (config_.use_qdrant && qdrant_store_) {
+                            for (size_t i = 0; i < count; ++i) {
+                                stored[i] = stored[i] && !qdrant_store_->add_document(batch.chunks[i], batch.embeddings[i]).empty();
+                            }
+                        }
+                        if (config_.use_faiss && faiss_store_) {
+                            auto faiss_ids = faiss_store_->add_documents(batch.chunks, batch.embeddings);
+                            for (size_t i = 0; i < count; ++i) {
+                                stored[i] = stored[i] && !faiss_ids[i].empty();
+                            }
+                        }
+                    }
+                    
+                    std::vector<std::string> rollback;
+                    {
+                        std::lock_guard<std::mutex> lock(cache_mutex_);
+                        for (size_t i = 0; i < count; ++i) {
+                            size_t owner = batch.owners[i];
+                            // Kept even when only one store took it, so the rollback reaches it
+                            partial[owner].push_back(batch.chunks[i].id);
+                            if (!stored[i]) {
+                                failed[owner] = true;
+                            }
+                            if (!batch.last_chunk[i]) {
+                                continue;
+                            }
+                            if (failed[owner]) {
+                                auto& chunk_ids = partial[owner];
+                                rollback.insert(rollback.end(), chunk_ids.begin(), chunk_ids.end());
+                            } else {
+                                ids[owner] = assigned[owner];
+                                Document& cached = document_cache_[ids[owner]];
+                                cached = documents[owner];
+                                cached.id = ids[owner];
+                            }
+                            partial.erase(owner);
+                        }
+                    }
+                    for (const auto& chunk_id : rollback) {
+                        remove_from_stores(chunk_id);
+                    }
+                }
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "[RetrievalManager] Storing ingested documents failed: " << e.what() << std::endl;
+            to_store.cancel();
+            to_embed.cancel();
+        }
+        
+        // Documents whose last chunk never arrived because ingestion was abandoned
+        for (const auto& [owner, chunk_ids] : partial) {
+            for (const auto& chunk_id : chunk_ids) {
+                remove_from_stores(chunk_id);
+            }
+        }
+    });
+    
+    // Chunk on this thread; push() waits while the embedders are behind
+    try {
+        IngestBatch batch;
+        size_t sequence = 0;
+        auto flush = [&]() {
+            batch.sequence = sequence++;
+            to_embed.push(std::move(batch));
+            batch = IngestBatch();
+        };
+        for (size_t d = 0; d < documents.size(); ++d) {
+            const Document& document = documents[d];
+            const std::string& parent_id = assigned[d];
+            std::vector<std::string> pieces;
+            if (config_.chunk_size > 0 && document.content.length() > static_cast<size_t>(config_.chunk_size)) {
+                pieces = RetrievalFunctions::chunk_text(document.content, config_.chunk_size, config_.chunk_overlap);
+            }
+            
+            if (pieces.size() <= 1) {
+                batch.chunks.push_back(document);
+                batch.chunks.back().id = parent_id;
+                batch.owners.push_back(d);
+                batch.last_chunk.push_back(true);
+                if (batch.chunks.size() == batch_size) flush();
+                continue;
+            }
+            
+            for (size_t c = 0; c < pieces.size(); ++c) {
+                Document chunk(parent_id + "#" + std::to_string(c), pieces[c], document.source);
+                chunk.metadata = document.metadata;
+                chunk.metadata["parent_id"] = parent_id;
+                chunk.metadata["chunk_index"] = std::to_string(c);
+                chunk.created_at = document.created_at;
+                batch.chunks.push_back(std::move(chunk));
+                batch.owners.push_back(d);
+                batch.last_chunk.push_back(c + 1 == pieces.size());
+                if (batch.chunks.size() == batch_size) flush();
+            }
+        }
+        if (!batch.chunks.empty()) flush();
+    } catch (...) {
+        // The stages reference this frame; stop them before unwinding it
+        to_embed.cancel();
+        to_store.cancel();
+        tasks.wait();
+        throw;
     }
     
+    to_embed.close();
+    tasks.wait();
+    
     return ids;
 }
 
@@ -545,16 +1123,11 @@ std::vector<SearchResult> RetrievalManager::hybrid_search(const std::string& que
 bool RetrievalManager::delete_document(const std::string& document_id) {
     if (!initialized_) return false;
     
-    bool success = true;
+    bool success = remove_from_stores(document_id);
     
-    // Delete from Qdrant
-    if (config_.use_qdrant && qdrant_store_) {
-        success &= qdrant_store_->delete_document(document_id);
-    }
-    
-    // Delete from FAISS
-    if (config_.use_faiss && faiss_store_) {
-        success &= faiss_store_->delete_document(document_id);
+    // Chunks are numbered from 0 without gaps
+    for (size_t n = 0; remove_from_stores(document_id + "#" + std::to_string(n)); ++n) {
+        success = true;
     }
     
     // Remove from cache
@@ -566,6 +1139,22 @@ bool RetrievalManager::delete_document(const std::string& document_id) {
     return success;
 }
 
+bool RetrievalManager::remove_from_stores(const std::string& id) {
+    bool removed = false;
+    
+    // Delete from Qdrant
+    if (config_.use_qdrant && qdrant_store_) {
+        removed = qdrant_store_->delete_document(id) || removed;
+    }
+    
+    // Delete from FAISS
+    if (config_.use_faiss && faiss_store_) {
+        removed = faiss_store_->delete_document(id) || removed;
+    }
+    
+    return removed;
+}
+
 std::optional<Document> RetrievalManager::get_document(const std::string& document_id) {
     // Check cache first
     {
@@ -606,7 +1195,24 @@ void RetrievalManager::clear_cache() {
     document_cache_.clear();
 }
 
+std::vector<std::vector<float>> RetrievalManager::generate_embeddings(const std::vector<std::string>& texts) {
+    if (embedding_function_) {
+        return embedding_function_(texts);
+    }
+    std::vector<std::vector<float>> embeddings;
+    embeddings.reserve(texts.size());
+    for (const auto& text : texts) {
+        embeddings.push_back(generate_embedding(text));
+    }
+    return embeddings;
+}
+
 std::vector<float> RetrievalManager::generate_embedding(const std::string& text) {
+    if (embedding_function_) {
+        auto embeddings = embedding_function_({text});
+        return embeddings.empty() ? std::vector<float>() : std::move(embeddings.front());
+    }
+    
     // Placeholder embedding generation
     // In a real implementation, this would use a model like Sentence-BERT, OpenAI embeddings, etc.
     
@@ -0,0 +1,392 @@
+#include "task_scheduler.hpp"
+#include "logger.hpp"
+#include <algorithm>
+#include <chrono>
+#include <exception>
+
+namespace {
+    // Scheduler and slot of the worker running on this thread
+    thread_local TaskScheduler* current_scheduler = nullptr;
+    thread_local size_t current_worker = 0;
+    thread_local int blocking_depth = 0;
+}
+
+TaskScheduler& TaskScheduler::shared() {
+    // Never destroyed: a worker still blocked in a socket read at exit must
+    // not hold up process shutdown in a static destructor
+    static TaskScheduler* scheduler = new TaskScheduler();
+    return *scheduler;
+}
+
+TaskScheduler::TaskScheduler() : TaskScheduler(Config{}) {
+}
+
+TaskScheduler::TaskScheduler(const Config& config) : config_(config) {
+    core_workers_ = config_.worker_threads > 0
+        ? config_.worker_threads
+        : std::max<size_t>(2, std::thread::hardware_concurrency());
+
+    // Slots are allocated up front so thieves can walk them without locking
+    workers_.reserve(core_workers_ + config_.max_blocking_threads);
+    for (size_t i = 0; i < core_workers_ + config_.max_blocking_threads; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    for (size_t i = 0; i < core_workers_; ++i) {
+        workers_[i]->alive = true;
+        workers_[i]->thread = std::thread(&TaskScheduler::worker_loop, this, i);
+    }
+}
+
+TaskScheduler::~TaskScheduler() {
+    shutdown();
+}
+
+void TaskScheduler::submit(Task task, Priority priority) {
+    if (!task) {
+        return;
+    }
+    size_t lane = static_cast<size_t>(priority);
+
+    if (stopping_.load()) {
+        run_task(task, lane);
+        return;
+    }
+
+    submitted_++;
+    queued_[lane]++;
+    if (current_scheduler == this) {
+        Worker& worker = *workers_[current_worker];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.lanes[lane].push_back(std::move(task));
+        worker.depth++;
+    } else {
+        std::lock_guard<std::mutex> lock(injection_mutex_);
+        injection_[lane].push_back(std::move(task));
+        injection_depth_++;
+    }
+    pending_++;
+    wake_one();
+}
+
+void TaskScheduler::shutdown() {
+    {
+        std::lock_guard<std::mutex> spawn_lock(spawn_mutex_);
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        if (stopping_.exchange(true)) {
+            return;
+        }
+    }
+    sleep_condition_.notify_all();
+
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+bool TaskScheduler::on_worker_thread() const {
+    return current_scheduler == this;
+}
+
+TaskScheduler::Stats TaskScheduler::get_stats() const {
+    Stats stats;
+    stats.workers = core_workers_;
+    stats.spare_workers = live_spares_.load();
+    stats.blocked_workers = blocked_.load();
+    stats.idle_workers = idle_.load();
+    stats.submitted = submitted_.load();
+    stats.steals = steals_.load();
+    stats.spares_started = spares_started_.load();
+    for (size_t lane = 0; lane < PRIORITY_COUNT; ++lane) {
+        stats.queued[lane] = queued_[lane].load();
+        stats.executed[lane] = executed_[lane].load();
+    }
+    {
+        std::lock_guard<std::mutex> lock(injection_mutex_);
+        stats.injection_depth = injection_depth_;
+    }
+    for (const auto& worker : workers_) {
+        if (worker->alive.load()) {
+            stats.worker_depths.push_back(worker->depth.load());
+        }
+    }
+    return stats;
+}
+
+void TaskScheduler::worker_loop(size_t index) {
+    current_scheduler = this;
+    current_worker = index;
+    const bool spare = index >= core_workers_;
+
+    Task task;
+    size_t lane = 0;
+    while (true) {
+        if (take_task(index, task, lane)) {
+            run_task(task, lane);
+            task = nullptr;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        if (pending_.load() > 0) {
+            continue;  // Work appeared while we were searching
+        }
+        if (stopping_.load()) {
+            break;
+        }
+        idle_++;
+        auto has_work = [this] { return pending_.load() > 0 || stopping_.load(); };
+        bool woken = true;
+        if (spare) {
+            woken = sleep_condition_.wait_for(lock, std::chrono::milliseconds(config_.spare_idle_timeout_ms), has_work);
+        } else {
+            sleep_condition_.wait(lock, has_work);
+        }
+        idle_--;
+        if (!woken) {
+            break;  // Spare thread no longer needed
+        }
+    }
+
+    if (spare) {
+        std::lock_guard<std::mutex> lock(spawn_mutex_);
+        workers_[index]->alive = false;
+        live_spares_--;
+    }
+    current_scheduler = nullptr;
+}
+
+bool TaskScheduler::take_task(size_t index, Task& task, size_t& lane) {
+    Worker& self = *workers_[index];
+    const size_t slot_count = workers_.size();
+
+    for (lane = 0; lane < PRIORITY_COUNT; ++lane) {
+        if (queued_[lane].load() == 0) {
+            continue;
+        }
+
+        // Own deque: newest first
+        if (self.depth.load() > 0) {
+            std::lock_guard<std::mutex> lock(self.mutex);
+            auto& own = self.lanes[lane];
+            if (!own.empty()) {
+                task = std::move(own.back());
+                own.pop_back();
+                self.depth--;
+                break;
+            }
+        }
+
+        // Tasks submitted from outside the pool
+        {
+            std::lock_guard<std::mutex> lock(injection_mutex_);
+            auto& injected = injection_[lane];
+            if (!injected.empty()) {
+                task = std::move(injected.front());
+                injected.pop_front();
+                injection_depth_--;
+                break;
+            }
+        }
+
+        // Steal the oldest task of another worker
+        bool stolen = false;
+        for (size_t offset = 1; offset < slot_count && !stolen; ++offset) {
+            Worker& victim = *workers_[(index + offset) % slot_count];
+            if (victim.depth.load() == 0) {
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+            if (!lock.owns_lock()) {
+                continue;
+            }
+            auto& lanes = victim.lanes[lane];
+            if (!lanes.empty()) {
+                task = std::move(lanes.front());
+                lanes.pop_front();
+                victim.depth--;
+                steals_++;
+                stolen = true;
+            }
+        }
+        if (stolen) {
+            break;
+        }
+    }
+
+    if (lane == PRIORITY_COUNT) {
+        return false;
+    }
+    queued_[lane]--;
+    pending_--;
+    return true;
+}
+
+void TaskScheduler::run_task(Task& task, size_t lane) {
+    try {
+        task();
+    } catch (const std::exception& e) {
+        LOG_ERROR_F("Unhandled exception in scheduled task: %s", e.what());
+    } catch (...) {
+        LOG_ERROR("Unknown exception in scheduled task");
+    }
+    executed_[lane]++;
+}
+
+void TaskScheduler::wake_one() {
+    if (idle_.load() > 0) {
+        // Taking the lock orders this wake-up after a worker's final
+        // pending_ check, so it cannot be lost
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+    }
+    sleep_condition_.notify_one();
+}
+
+void TaskScheduler::begin_blocking() {
+    size_t blocked = ++blocked_;
+    size_t runnable = core_workers_ + live_spares_.load() - blocked;
+    if (runnable < core_workers_) {
+        start_spare();
+    }
+}
+
+void TaskScheduler::end_blocking() {
+    blocked_--;
+}
+
+void TaskScheduler::start_spare() {
+    std::lock_guard<std::mutex> lock(spawn_mutex_);
+    if (stopping_.load() || live_spares_.load() >= config_.max_blocking_threads) {
+        return;
+    }
+    for (size_t i = core_workers_; i < workers_.size(); ++i) {
+        Worker& slot = *workers_[i];
+        if (slot.alive.load()) {
+            continue;
+        }
+        if (slot.thread.joinable()) {
+            slot.thread.join();  // A spare that retired earlier
+        }
+        slot.alive = true;
+        live_spares_++;
+        spares_started_++;
+        slot.thread = std::thread(&TaskScheduler::worker_loop, this, i);
+        return;
+    }
+}
+
+TaskScheduler::BlockingScope::BlockingScope() {
+    if (current_scheduler && blocking_depth++ == 0) {
+        scheduler_ = current_scheduler;
+        scheduler_->begin_blocking();
+    }
+}
+
+TaskScheduler::BlockingScope::~BlockingScope() {
+    if (current_scheduler) {
+        blocking_depth--;
+    }
+    if (scheduler_) {
+        scheduler_->end_blocking();
+    }
+}
+
+TaskGroup::TaskGroup(TaskScheduler& scheduler, TaskScheduler::Priority priority, size_t max_concurrency)
+    : scheduler_(scheduler), priority_(priority), max_concurrency_(max_concurrency) {
+}
+
+TaskGroup::~TaskGroup() {
+    wait();
+}
+
+void TaskGroup::submit(TaskScheduler::Task task) {
+    bool launch = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+        if (max_concurrency_ == 0 || running_ < max_concurrency_) {
+            running_++;
+            launch = true;
+        }
+    }
+    if (launch) {
+        scheduler_.submit([this]() { run_next(); }, priority_);
+    }
+}
+
+void TaskGroup::wait() {
+    TaskScheduler::BlockingScope blocking;
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_condition_.wait(lock, [this] { return tasks_.empty() && running_ == 0; });
+}
+
+void TaskGroup::set_max_concurrency(size_t max_concurrency) {
+    size_t launches = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        max_concurrency_ = max_concurrency;
+        while (launches < tasks_.size() &&
+               (max_concurrency_ == 0 || running_ + launches < max_concurrency_)) {
+            launches++;
+        }
+        running_ += launches;
+    }
+    for (size_t i = 0; i < launches; ++i) {
+        scheduler_.submit([this]() { run_next(); }, priority_);
+    }
+}
+
+size_t TaskGroup::max_concurrency() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return max_concurrency_;
+}
+
+size_t TaskGroup::queued() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return tasks_.size();
+}
+
+size_t TaskGroup::running() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return running_;
+}
+
+void TaskGroup::run_next() {
+    TaskScheduler::Task task;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!tasks_.empty()) {
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+    }
+
+    if (task) {
+        try {
+            task();
+        } catch (const std::exception& e) {
+            LOG_ERROR_F("Unhandled exception in task group: %s", e.what());
+        } catch (...) {
+            LOG_ERROR("Unknown exception in task group");
+        }
+    }
+
+    // Hand the slot to the next queued task through the scheduler rather than
+    // looping here, so other lanes get a turn between tasks
+    bool resubmit = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!tasks_.empty() && (max_concurrency_ == 0 || running_ <= max_concurrency_)) {
+            resubmit = true;
+        } else {
+            running_--;
+            if (tasks_.empty() && running_ == 0) {
+                idle_condition_.notify_all();
+            }
+        }
+    }
+    if (resubmit) {
+        scheduler_.submit([this]() { run_next(); }, priority_);
+    }
+}
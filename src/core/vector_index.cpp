@@ -0,0 +1,386 @@
+#include "vector_index.hpp"
+#include "index_io.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define KOLOSAL_VECTOR_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define KOLOSAL_VECTOR_NEON 1
+#include <arm_neon.h>
+#endif
+
+// GCC and Clang compile each x86 kernel for its own instruction set and pick
+// one at runtime; MSVC has no per-function targets, so there only the
+// instruction sets enabled for the whole build (/arch) are used.
+#if defined(KOLOSAL_VECTOR_X86) && (defined(__GNUC__) || defined(__clang__))
+#define KOLOSAL_TARGET(isa) __attribute__((target(isa)))
+#define KOLOSAL_HAVE_AVX2 1
+#define KOLOSAL_HAVE_AVX512 1
+#elif defined(KOLOSAL_VECTOR_X86)
+#define KOLOSAL_TARGET(isa)
+#if defined(__AVX2__)
+#define KOLOSAL_HAVE_AVX2 1
+#endif
+#if defined(__AVX512F__)
+#define KOLOSAL_HAVE_AVX512 1
+#endif
+#endif
+
+namespace kolosal {
+namespace vector_kernels {
+
+namespace {
+
+    float dot_scalar(const float* a, const float* b, size_t n) {
+        float sum0 = 0.0f, sum1 = 0.0f, sum2 = 0.0f, sum3 = 0.0f;
+        for (size_t i = 0; i < n; i += 4) {
+            sum0 += a[i] * b[i];
+            sum1 += a[i + 1] * b[i + 1];
+            sum2 += a[i + 2] * b[i + 2];
+            sum3 += a[i + 3] * b[i + 3];
+        }
+        return (sum0 + sum1) + (sum2 + sum3);
+    }
+
+    float code_dot_scalar(const float* weights, const uint8_t* codes, size_t n) {
+        float sum0 = 0.0f, sum1 = 0.0f, sum2 = 0.0f, sum3 = 0.0f;
+        for (size_t i = 0; i < n; i += 4) {
+            sum0 += weights[i] * codes[i];
+            sum1 += weights[i + 1] * codes[i + 1];
+            sum2 += weights[i + 2] * codes[i + 2];
+            sum3 += weights[i + 3] * codes[i + 3];
+        }
+        return (sum0 + sum1) + (sum2 + sum3);
+    }
+
+#if defined(KOLOSAL_HAVE_AVX2)
+    KOLOSAL_TARGET("avx2,fma")
+    float dot_avx2(const float* a, const float* b, size_t n) {
+        __m256 sum0 = _mm256_setzero_ps();
+        __m256 sum1 = _mm256_setzero_ps();
+        for (size_t i = 0; i < n; i += 16) {
+            sum0 = _mm256_fmadd_ps(_mm256_load_ps(a + i), _mm256_load_ps(b + i), sum0);
+            sum1 = _mm256_fmadd_ps(_mm256_load_ps(a + i + 8), _mm256_load_ps(b + i + 8), sum1);
+        }
+        __m256 sum = _mm256_add_ps(sum0, sum1);
+        __m128 half = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+        half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+        half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 0x55));
+        return _mm_cvtss_f32(half);
+    }
+
+    KOLOSAL_TARGET("avx2,fma")
+    float code_dot_avx2(const float* weights, const uint8_t* codes, size_t n) {
+        __m256 sum0 = _mm256_setzero_ps();
+        __m256 sum1 = _mm256_setzero_ps();
+        for (size_t i = 0; i < n; i += 16) {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(codes + i));
+            __m256 low = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(bytes));
+            __m256 high = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_srli_si128(bytes, 8)));
+            sum0 = _mm256_fmadd_ps(_mm256_load_ps(weights + i), low, sum0);
+            sum1 = _mm256_fmadd_ps(_mm256_load_ps(weights + i + 8), high, sum1);
+        }
+        __m256 sum = _mm256_add_ps(sum0, sum1);
+        __m128 half = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+        half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+        half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 0x55));
+        return _mm_cvtss_f32(half);
+    }
+#endif
+
+#if defined(KOLOSAL_HAVE_AVX512)
+    // _mm512_reduce_add_ps and the unmasked widening conversions start from
+    // _mm512_undefined_*(), which GCC 12 reports as used uninitialized; the
+    // zero-masked forms give the same lanes from a zeroed register
+    KOLOSAL_TARGET("avx512f")
+    float horizontal_sum_avx512(__m512 sum) {
+        __m512d halves = _mm512_castps_pd(sum);
+        __m256 low = _mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(0xFF, halves, 0));
+        __m256 high = _mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(0xFF, halves, 1));
+        __m256 quarter = _mm256_add_ps(low, high);
+        __m128 half = _mm_add_ps(_mm256_castps256_ps128(quarter), _mm256_extractf128_ps(quarter, 1));
+        half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+        half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 0x55));
+        return _mm_cvtss_f32(half);
+    }
+
+    KOLOSAL_TARGET("avx512f")
+    float dot_avx512(const float* a, const float* b, size_t n) {
+        __m512 sum = _mm512_setzero_ps();
+        for (size_t i = 0; i < n; i += 16) {
+            sum = _mm512_fmadd_ps(_mm512_load_ps(a + i), _mm512_load_ps(b + i), sum);
+        }
+        return horizontal_sum_avx512(sum);
+    }
+
+    KOLOSAL_TARGET("avx512f")
+    float code_dot_avx512(const float* weights, const uint8_t* codes, size_t n) {
+        const __mmask16 all = 0xFFFF;
+        __m512 sum = _mm512_setzero_ps();
+        for (size_t i = 0; i < n; i += 16) {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(codes + i));
+            __m512 values = _mm512_maskz_cvtepi32_ps(all, _mm512_maskz_cvtepu8_epi32(all, bytes));
+            sum = _mm512_fmadd_ps(_mm512_load_ps(weights + i), values, sum);
+        }
+        return horizontal_sum_avx512(sum);
+    }
+#endif
+
+#if defined(KOLOSAL_VECTOR_NEON)
+    float dot_neon(const float* a, const float* b, size_t n) {
+        float32x4_t sum0 = vdupq_n_f32(0.0f);
+        float32x4_t sum1 = vdupq_n_f32(0.0f);
+        float32x4_t sum2 = vdupq_n_f32(0.0f);
+        float32x4_t sum3 = vdupq_n_f32(0.0f);
+        for (size_t i = 0; i < n; i += 16) {
+            sum0 = vfmaq_f32(sum0, vld1q_f32(a + i), vld1q_f32(b + i));
+            sum1 = vfmaq_f32(sum1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+            sum2 = vfmaq_f32(sum2, vld1q_f32(a + i + 8), vld1q_f32(b + i + 8));
+            sum3 = vfmaq_f32(sum3, vld1q_f32(a + i + 12), vld1q_f32(b + i + 12));
+        }
+        return vaddvq_f32(vaddq_f32(vaddq_f32(sum0, sum1), vaddq_f32(sum2, sum3)));
+    }
+
+    float code_dot_neon(const float* weights, const uint8_t* codes, size_t n) {
+        float32x4_t sum0 = vdupq_n_f32(0.0f);
+        float32x4_t sum1 = vdupq_n_f32(0.0f);
+        float32x4_t sum2 = vdupq_n_f32(0.0f);
+        float32x4_t sum3 = vdupq_n_f32(0.0f);
+        for (size_t i = 0; i < n; i += 16) {
+            uint8x16_t bytes = vld1q_u8(codes + i);
+            uint16x8_t low = vmovl_u8(vget_low_u8(bytes));
+            uint16x8_t high = vmovl_u8(vget_high_u8(bytes));
+            sum0 = vfmaq_f32(sum0, vld1q_f32(weights + i), vcvtq_f32_u32(vmovl_u16(vget_low_u16(low))));
+            sum1 = vfmaq_f32(sum1, vld1q_f32(weights + i + 4), vcvtq_f32_u32(vmovl_u16(vget_high_u16(low))));
+            sum2 = vfmaq_f32(sum2, vld1q_f32(weights + i + 8), vcvtq_f32_u32(vmovl_u16(vget_low_u16(high))));
+            sum3 = vfmaq_f32(sum3, vld1q_f32(weights + i + 12), vcvtq_f32_u32(vmovl_u16(vget_high_u16(high))));
+        }
+        return vaddvq_f32(vaddq_f32(vaddq_f32(sum0, sum1), vaddq_f32(sum2, sum3)));
+    }
+#endif
+
+    std::vector<Kernel> detect_kernels() {
+        std::vector<Kernel> kernels;
+#if defined(KOLOSAL_VECTOR_X86) && (defined(__GNUC__) || defined(__clang__))
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) {
+            kernels.push_back({"avx512", dot_avx512, code_dot_avx512});
+        }
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+            kernels.push_back({"avx2", dot_avx2, code_dot_avx2});
+        }
+#else
+#if defined(KOLOSAL_HAVE_AVX512)
+        kernels.push_back({"avx512", dot_avx512, code_dot_avx512});
+#endif
+#if defined(KOLOSAL_HAVE_AVX2)
+        kernels.push_back({"avx2", dot_avx2, code_dot_avx2});
+#endif
+#if defined(KOLOSAL_VECTOR_NEON)
+        kernels.push_back({"neon", dot_neon, code_dot_neon});
+#endif
+#endif
+        kernels.push_back({"scalar", dot_scalar, code_dot_scalar});
+        return kernels;
+    }
+
+    const std::vector<Kernel>& kernels() {
+        static const std::vector<Kernel> detected = detect_kernels();
+        return detected;
+    }
+
+}  // namespace
+
+std::vector<Kernel> supported_kernels() {
+    return kernels();
+}
+
+DotProductFn dot_product() {
+    return kernels().front().dot;
+}
+
+CodeDotProductFn code_dot_product() {
+    return kernels().front().code_dot;
+}
+
+const char* active_kernel() {
+    return kernels().front().name;
+}
+
+void normalize_into(const float* vector, size_t dimension, float* out) {
+    double magnitude = 0.0;
+    for (size_t i = 0; i < dimension; ++i) {
+        magnitude += static_cast<double>(vector[i]) * vector[i];
+    }
+    float scale = magnitude > 0.0 ? static_cast<float>(1.0 / std::sqrt(magnitude)) : 0.0f;
+    for (size_t i = 0; i < dimension; ++i) {
+        out[i] = vector[i] * scale;
+    }
+    std::fill(out + dimension, out + padded_dimension(dimension), 0.0f);
+}
+
+}  // namespace vector_kernels
+
+std::vector<bool> IVectorIndex::add_batch(const std::vector<std::string>& ids,
+                                          const std::vector<std::vector<float>>& vectors, size_t) {
+    std::vector<bool> added(ids.size());
+    reserve(size() + ids.size());
+    for (size_t i = 0; i < ids.size() && i < vectors.size(); ++i) {
+        added[i] = add(ids[i], vectors[i]);
+    }
+    return added;
+}
+
+namespace {
+    constexpr uint32_t FLAT_INDEX_TAG = 0x54414C46;  // "FLAT"
+}
+
+FlatVectorIndex::FlatVectorIndex(size_t dimension)
+    : dimension_(0), stride_(0), dot_(vector_kernels::dot_product()) {
+    set_dimension(dimension);
+}
+
+void FlatVectorIndex::set_dimension(size_t dimension) {
+    dimension_ = dimension;
+    stride_ = vector_kernels::padded_dimension(dimension);
+}
+
+bool FlatVectorIndex::add(const std::string& id, const std::vector<float>& vector) {
+    if (vector.empty()) {
+        return false;
+    }
+    if (dimension_ == 0 && ids_.empty()) {
+        set_dimension(vector.size());
+    }
+    if (vector.size() != dimension_) {
+        return false;
+    }
+
+    size_t row;
+    auto existing = rows_.find(id);
+    if (existing != rows_.end()) {
+        row = existing->second;
+    } else {
+        row = ids_.size();
+        data_.resize(data_.size() + stride_);
+        ids_.push_back(id);
+        rows_.emplace(id, row);
+    }
+    vector_kernels::normalize_into(vector.data(), dimension_, data_.data() + row * stride_);
+    return true;
+}
+
+bool FlatVectorIndex::remove(const std::string& id) {
+    auto it = rows_.find(id);
+    if (it == rows_.end()) {
+        return false;
+    }
+
+    // Move the last row into the gap so the block stays dense
+    size_t row = it->second;
+    size_t last = ids_.size() - 1;
+    if (row != last) {
+        std::copy_n(data_.data() + last * stride_, stride_, data_.data() + row * stride_);
+        ids_[row] = std::move(ids_[last]);
+        rows_[ids_[row]] = row;
+    }
+    rows_.erase(it);
+    ids_.pop_back();
+    data_.resize(last * stride_);
+    return true;
+}
+
+void FlatVectorIndex::clear() {
+    data_.clear();
+    ids_.clear();
+    rows_.clear();
+}
+
+void FlatVectorIndex::reserve(size_t count) {
+    // Grow at least geometrically, so reserving ahead of every small batch
+    // does not copy the whole index each time
+    if (count <= ids_.capacity()) {
+        return;
+    }
+    count = std::max(count, ids_.capacity() * 2);
+    data_.reserve(count * stride_);
+    ids_.reserve(count);
+    rows_.reserve(count);
+}
+
+std::vector<FlatVectorIndex::Hit> FlatVectorIndex::search(const std::vector<float>& query, size_t k,
+                                                          float threshold) const {
+    if (k == 0 || ids_.empty() || query.size() != dimension_) {
+        return {};
+    }
+
+    vector_kernels::AlignedFloats normalized(stride_);
+    vector_kernels::normalize_into(query.data(), dimension_, normalized.data());
+
+    // Min-heap of the best k so far; its top is the score to beat
+    using Candidate = std::pair<float, size_t>;
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> best;
+    const float* row = data_.data();
+    for (size_t i = 0; i < ids_.size(); ++i, row += stride_) {
+        float score = dot_(normalized.data(), row, stride_);
+        if (score < threshold) {
+            continue;
+        }
+        if (best.size() < k) {
+            best.emplace(score, i);
+        } else if (score > best.top().first) {
+            best.pop();
+            best.emplace(score, i);
+        }
+    }
+
+    std::vector<Hit> hits(best.size());
+    for (size_t i = hits.size(); i-- > 0; best.pop()) {
+        hits[i] = Hit{ids_[best.top().second], best.top().first};
+    }
+    return hits;
+}
+
+void FlatVectorIndex::serialize(std::string& out) const {
+    index_io::Writer writer(out);
+    writer.put<uint32_t>(FLAT_INDEX_TAG);
+    writer.put<uint64_t>(dimension_);
+    writer.put<uint64_t>(ids_.size());
+    for (const auto& id : ids_) {
+        writer.put_string(id);
+    }
+    writer.put_array(data_, data_.size());
+}
+
+bool FlatVectorIndex::deserialize(const char* data, size_t size) {
+    clear();
+    index_io::Reader reader(data, size);
+    uint32_t tag;
+    uint64_t dimension, count;
+    if (!reader.get(tag) || tag != FLAT_INDEX_TAG || !reader.get(dimension) || !reader.get(count) ||
+        count > size) {
+        return false;
+    }
+    set_dimension(static_cast<size_t>(dimension));
+    reserve(static_cast<size_t>(count));
+    std::string id;
+    for (uint64_t row = 0; row < count; ++row) {
+        if (!reader.get_string(id)) {
+            clear();
+            return false;
+        }
+        rows_.emplace(id, ids_.size());
+        ids_.push_back(std::move(id));
+    }
+    if (!reader.get_array(data_, ids_.size() * stride_) || rows_.size() != ids_.size()) {
+        clear();
+        return false;
+    }
+    return true;
+}
+
+}  // namespace kolosal
@@ -213,7 +213,7 @@ json ResearchBriefProcessor::analyze_source_credibility(const json& sources) {
         double avg_credibility = 0.0;
         int count = 0;
         for (const auto& scored : source_scores) {
-            avg_credibility += scored["credibility_score"];
+            avg_credibility += scored["credibility_score"].get<double>();
             count++;
         }
         if (count > 0) avg_credibility /= count;
@@ -404,7 +404,7 @@ json ResearchBriefProcessor::calculate_confidence_scores(const json& claims_data
         double overall_confidence = 0.0;
         if (scored_claims.size() > 0) {
             for (const auto& claim : scored_claims) {
-                overall_confidence += claim["confidence"];
+                overall_confidence += claim["confidence"].get<double>();
             }
             overall_confidence /= scored_claims.size();
         }
@@ -25,8 +25,8 @@ std::vector<std::string> chunk_text(const std::string& text, int chunk_size, int
         
         // Try to break at sentence or word boundaries
         if (end < text.length()) {
-            // Look for sentence ending
-            size_t sentence_end = text.find_last_of(".!?", end);
+            // Look for sentence ending, keeping it inside the chunk
+            size_t sentence_end = text.find_last_of(".!?", end - 1);
             if (sentence_end != std::string::npos && sentence_end > start + chunk_size/2) {
                 end = sentence_end + 1;
             } else {
@@ -43,8 +43,11 @@ std::vector<std::string> chunk_text(const std::string& text, int chunk_size, int
             chunks.push_back(chunk);
         }
         
-        start = end - overlap;
-        if (start >= end) break;
+        // Stop at the end of the text, and always move forward even when
+        // the overlap reaches back past the chunk's start
+        if (end >= text.length()) break;
+        size_t next = end > static_cast<size_t>(std::max(overlap, 0)) ? end - std::max(overlap, 0) : end;
+        start = next > start ? next : end;
     }
     
     return chunks;
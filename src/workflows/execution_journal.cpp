@@ -0,0 +1,281 @@
+#include "execution_journal.hpp"
+#include "file_sync.hpp"
+#include "logger.hpp"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+ExecutionJournal::ExecutionJournal(const Config& config) : config_(config) {
+}
+
+ExecutionJournal::~ExecutionJournal() {
+    close();
+}
+
+std::vector<ExecutionJournal::RecoveredExecution> ExecutionJournal::open() {
+    if (is_open()) {
+        throw std::runtime_error("Execution journal is already open: " + config_.path);
+    }
+
+    std::filesystem::path path(config_.path);
+    if (path.has_parent_path()) {
+        std::filesystem::create_directories(path.parent_path());
+    }
+
+    std::vector<json> live_records;
+    auto recovered = replay(live_records);
+    compact(live_records);
+
+    std::FILE* file = std::fopen(config_.path.c_str(), "ab");
+    if (!file) {
+        throw std::runtime_error("Cannot open execution journal: " + config_.path);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        file_ = file;
+        closing_ = false;
+    }
+    writer_thread_ = std::thread(&ExecutionJournal::writer_loop, this);
+
+    LOG_INFO_F("Execution journal %s: %zu unfinished executions recovered",
+               config_.path.c_str(), recovered.size());
+    return recovered;
+}
+
+void ExecutionJournal::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!file_ || closing_) {
+            return;
+        }
+        closing_ = true;
+    }
+    pending_condition_.notify_all();
+    if (writer_thread_.joinable()) {
+        writer_thread_.join();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::fclose(file_);
+    file_ = nullptr;
+}
+
+bool ExecutionJournal::is_open() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return file_ != nullptr && !closing_;
+}
+
+void ExecutionJournal::record_execution_started(const std::string& execution_id, const std::string& workflow_id,
+                                                const json& input_data, const std::string& tenant_id, int priority,
+                                                int64_t start_time_ms) {
+    append(json{
+        {"record", "execution_started"},
+        {"execution_id", execution_id},
+        {"workflow_id", workflow_id},
+        {"input_data", input_data},
+        {"tenant_id", tenant_id},
+        {"priority", priority},
+        {"start_time_ms", start_time_ms}
+    });
+}
+
+void ExecutionJournal::record_step_completed(const std::string& execution_id, const std::string& step_id,
+                                             const json& output) {
+    // Serialised around the output instead of copying it into the record
+    std::string line = json{
+        {"record", "step_completed"},
+        {"execution_id", execution_id},
+        {"step_id", step_id}
+    }.dump();
+    line.pop_back();
+    line += ",\"output\":";
+    line += output.dump();
+    line += '}';
+    append_line(std::move(line));
+}
+
+void ExecutionJournal::record_loop_iteration(const std::string& execution_id, int iteration) {
+    append(json{
+        {"record", "loop_iteration"},
+        {"execution_id", execution_id},
+        {"iteration", iteration}
+    });
+}
+
+void ExecutionJournal::record_execution_finished(const std::string& execution_id, int state) {
+    append(json{
+        {"record", "execution_finished"},
+        {"execution_id", execution_id},
+        {"state", state}
+    });
+}
+
+void ExecutionJournal::flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!file_ || pending_.empty()) {
+        return;
+    }
+    uint64_t target = filling_batch_;
+    flush_requested_ = true;
+    pending_condition_.notify_all();
+    durable_condition_.wait(lock, [this, target] { return durable_batch_ >= target || !file_; });
+}
+
+void ExecutionJournal::append(const json& record) {
+    // Serialise outside the lock; step outputs can be large
+    append_line(record.dump());
+}
+
+void ExecutionJournal::append_line(std::string line) {
+    line += '\n';
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_ || closing_) {
+        return;
+    }
+    bool was_empty = pending_.empty();
+    pending_ += line;
+    if (was_empty) {
+        pending_condition_.notify_all();
+    }
+}
+
+void ExecutionJournal::writer_loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        pending_condition_.wait(lock, [this] { return !pending_.empty() || closing_; });
+        if (pending_.empty() && closing_) {
+            break;
+        }
+
+        // Let the batch fill for one interval unless someone is waiting on it
+        if (!flush_requested_ && !closing_) {
+            pending_condition_.wait_for(lock, std::chrono::milliseconds(config_.flush_interval_ms),
+                                        [this] { return flush_requested_ || closing_; });
+        }
+
+        std::string batch;
+        batch.swap(pending_);
+        uint64_t sequence = filling_batch_++;
+        flush_requested_ = false;
+
+        lock.unlock();
+        write_and_sync(batch);
+        lock.lock();
+
+        durable_batch_ = sequence;
+        durable_condition_.notify_all();
+    }
+    durable_condition_.notify_all();
+}
+
+void ExecutionJournal::write_and_sync(const std::string& data) {
+    if (std::fwrite(data.data(), 1, data.size(), file_) != data.size()) {
+        LOG_ERROR_F("Failed to write execution journal %s", config_.path.c_str());
+    }
+    file_sync::sync_file(file_);
+}
+
+std::vector<ExecutionJournal::RecoveredExecution> ExecutionJournal::replay(std::vector<json>& live_records) {
+    std::vector<RecoveredExecution> recovered;
+    std::ifstream input(config_.path, std::ios::binary);
+    if (!input.good()) {
+        return recovered;
+    }
+
+    std::map<std::string, RecoveredExecution> executions;
+    std::vector<std::string> start_order;
+    std::vector<json> records;
+    std::string line;
+    size_t skipped = 0;
+    while (std::getline(input, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        json record = json::parse(line, nullptr, false);
+        if (record.is_discarded() || !record.is_object() || !record.contains("execution_id")) {
+            skipped++;  // Torn write at the tail, or a damaged line
+            continue;
+        }
+
+        std::string type = record.value("record", "");
+        std::string execution_id = record.value("execution_id", "");
+        if (type == "execution_started") {
+            RecoveredExecution execution;
+            execution.execution_id = execution_id;
+            execution.workflow_id = record.value("workflow_id", "");
+            execution.input_data = record.value("input_data", json::object());
+            execution.tenant_id = record.value("tenant_id", "");
+            execution.priority = record.value("priority", 0);
+            execution.start_time_ms = record.value("start_time_ms", int64_t{0});
+            if (executions.emplace(execution_id, std::move(execution)).second) {
+                start_order.push_back(execution_id);
+            }
+        } else if (type == "step_completed") {
+            auto it = executions.find(execution_id);
+            if (it == executions.end()) {
+                continue;
+            }
+            std::string step_id = record.value("step_id", "");
+            if (it->second.step_outputs.count(step_id) == 0) {
+                it->second.step_order.push_back(step_id);
+            }
+            auto& iteration_steps = it->second.iteration_steps;
+            if (std::find(iteration_steps.begin(), iteration_steps.end(), step_id) == iteration_steps.end()) {
+                iteration_steps.push_back(step_id);
+            }
+            it->second.step_outputs[step_id] = record.value("output", json());
+        } else if (type == "loop_iteration") {
+            auto it = executions.find(execution_id);
+            if (it == executions.end()) {
+                continue;
+            }
+            // Earlier outputs stay in the context; only this iteration's steps are done
+            it->second.loop_iteration = record.value("iteration", 0);
+            it->second.iteration_steps.clear();
+        } else if (type == "execution_finished") {
+            executions.erase(execution_id);
+            continue;
+        } else {
+            skipped++;
+            continue;
+        }
+        records.push_back(std::move(record));
+    }
+    if (skipped > 0) {
+        LOG_WARN_F("Execution journal %s: skipped %zu unreadable records", config_.path.c_str(), skipped);
+    }
+
+    for (auto& record : records) {
+        if (executions.count(record["execution_id"].get<std::string>()) > 0) {
+            live_records.push_back(std::move(record));
+        }
+    }
+    for (const auto& execution_id : start_order) {
+        auto it = executions.find(execution_id);
+        if (it != executions.end()) {
+            recovered.push_back(std::move(it->second));
+        }
+    }
+    return recovered;
+}
+
+void ExecutionJournal::compact(const std::vector<json>& live_records) {
+    // Rewrite the journal with the unfinished executions only, then swap it in
+    std::string temp_path = config_.path + ".tmp";
+    std::FILE* file = std::fopen(temp_path.c_str(), "wb");
+    if (!file) {
+        throw std::runtime_error("Cannot write execution journal: " + temp_path);
+    }
+    for (const auto& record : live_records) {
+        std::string line = record.dump();
+        line += '\n';
+        std::fwrite(line.data(), 1, line.size(), file);
+    }
+    file_sync::sync_file(file);
+    std::fclose(file);
+    std::filesystem::rename(temp_path, config_.path);
+    file_sync::sync_parent_directory(config_.path);
+}
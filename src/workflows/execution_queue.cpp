@@ -0,0 +1,139 @@
+#include "execution_queue.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+ExecutionQueue::ExecutionQueue() : ExecutionQueue(Config{}) {
+}
+
+ExecutionQueue::ExecutionQueue(const Config& config) : config_(config) {
+}
+
+bool ExecutionQueue::push(const std::string& execution_id, const std::string& tenant_id, int priority) {
+    if (index_.count(execution_id) > 0) {
+        return false;
+    }
+    insert(Entry{execution_id, tenant_id, priority, next_sequence_++});
+    enqueued_++;
+    return true;
+}
+
+bool ExecutionQueue::pop(std::string& execution_id) {
+    if (levels_.empty()) {
+        return false;
+    }
+
+    auto level_it = levels_.begin();
+    Level& level = level_it->second;
+    auto tenant_it = level.tenants.find(level.rotation.front());
+    TenantQueue& tenant = tenant_it->second;
+
+    execution_id = std::move(tenant.entries.front().execution_id);
+    tenant.entries.pop_front();
+    index_.erase(execution_id);
+    dispatched_++;
+
+    if (tenant.entries.empty()) {
+        level.rotation.erase(tenant.turn);
+        level.tenants.erase(tenant_it);
+        if (level.tenants.empty()) {
+            levels_.erase(level_it);
+        }
+    } else {
+        // This tenant goes to the back of the rotation
+        level.rotation.splice(level.rotation.end(), level.rotation, tenant.turn);
+    }
+    return true;
+}
+
+bool ExecutionQueue::erase(const std::string& execution_id) {
+    auto it = index_.find(execution_id);
+    if (it == index_.end()) {
+        return false;
+    }
+    remove(it->second);
+    index_.erase(it);
+    removed_++;
+    return true;
+}
+
+bool ExecutionQueue::contains(const std::string& execution_id) const {
+    return index_.count(execution_id) > 0;
+}
+
+void ExecutionQueue::set_config(const Config& config) {
+    std::vector<Entry> entries;
+    entries.reserve(index_.size());
+    for (auto& level : levels_) {
+        for (auto& tenant : level.second.tenants) {
+            for (auto& entry : tenant.second.entries) {
+                entries.push_back(std::move(entry));
+            }
+        }
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.sequence < b.sequence;
+    });
+
+    config_ = config;
+    levels_.clear();
+    index_.clear();
+    for (auto& entry : entries) {
+        insert(std::move(entry));
+    }
+}
+
+ExecutionQueue::Stats ExecutionQueue::get_stats() const {
+    Stats stats;
+    stats.queued = index_.size();
+    stats.priority_levels = levels_.size();
+    for (const auto& level : levels_) {
+        stats.tenants += level.second.tenants.size();
+    }
+    stats.enqueued = enqueued_;
+    stats.dispatched = dispatched_;
+    stats.removed = removed_;
+    return stats;
+}
+
+ExecutionQueue::Ordering ExecutionQueue::parse_ordering(const std::string& name) {
+    if (name == "fifo") return Ordering::FIFO;
+    if (name == "priority") return Ordering::PRIORITY;
+    throw std::invalid_argument("Unknown execution queue ordering: " + name);
+}
+
+std::string ExecutionQueue::ordering_to_string(Ordering ordering) {
+    return ordering == Ordering::PRIORITY ? "priority" : "fifo";
+}
+
+void ExecutionQueue::insert(Entry entry) {
+    int level_key = config_.ordering == Ordering::PRIORITY ? entry.priority : 0;
+    std::string tenant_key = config_.tenant_fairness ? entry.tenant_id : std::string();
+    std::string execution_id = entry.execution_id;
+
+    Level& level = levels_[level_key];
+    auto tenant_it = level.tenants.find(tenant_key);
+    if (tenant_it == level.tenants.end()) {
+        tenant_it = level.tenants.emplace(tenant_key, TenantQueue{}).first;
+        tenant_it->second.turn = level.rotation.insert(level.rotation.end(), tenant_key);
+    }
+
+    auto& entries = tenant_it->second.entries;
+    entries.push_back(std::move(entry));
+    index_.emplace(std::move(execution_id), Location{level_key, std::move(tenant_key), std::prev(entries.end())});
+}
+
+void ExecutionQueue::remove(const Location& location) {
+    auto level_it = levels_.find(location.level);
+    Level& level = level_it->second;
+    auto tenant_it = level.tenants.find(location.tenant_key);
+    TenantQueue& tenant = tenant_it->second;
+
+    tenant.entries.erase(location.entry);
+    if (tenant.entries.empty()) {
+        level.rotation.erase(tenant.turn);
+        level.tenants.erase(tenant_it);
+        if (level.tenants.empty()) {
+            levels_.erase(level_it);
+        }
+    }
+}
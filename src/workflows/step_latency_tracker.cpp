@@ -0,0 +1,91 @@
+#include "step_latency_tracker.hpp"
+#include <algorithm>
+#include <cmath>
+
+StepLatencyTracker::StepLatencyTracker(size_t window_size) : window_size_(std::max<size_t>(1, window_size)) {
+}
+
+void StepLatencyTracker::record_latency(const std::string& key, double latency_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Window& window = windows_[key];
+    if (window.samples.size() < window_size_) {
+        window.samples.push_back(latency_ms);
+    } else {
+        window.samples[window.next] = latency_ms;
+    }
+    window.next = (window.next + 1) % window_size_;
+}
+
+std::optional<double> StepLatencyTracker::percentile(const std::string& key, double percentile,
+                                                     size_t min_samples) const {
+    std::vector<double> samples;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = windows_.find(key);
+        if (it == windows_.end() || it->second.samples.size() < std::max<size_t>(1, min_samples)) {
+            return std::nullopt;
+        }
+        samples = it->second.samples;
+    }
+    return percentile_of(std::move(samples), percentile);
+}
+
+double StepLatencyTracker::percentile_of(std::vector<double> samples, double percentile) {
+    // Nearest rank; the window is small, so selecting on a copy is cheap
+    double fraction = std::clamp(percentile, 0.0, 100.0) / 100.0;
+    size_t rank = static_cast<size_t>(std::ceil(fraction * static_cast<double>(samples.size())));
+    size_t index = rank == 0 ? 0 : std::min(rank - 1, samples.size() - 1);
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+void StepLatencyTracker::record_hedge_launched() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.hedges_launched++;
+}
+
+void StepLatencyTracker::record_hedge_outcome(bool hedge_won, bool loser_cancelled) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (hedge_won) {
+        stats_.hedge_wins++;
+    } else {
+        stats_.primary_wins++;
+    }
+    if (loser_cancelled) {
+        stats_.losers_cancelled++;
+    }
+}
+
+void StepLatencyTracker::record_hedge_failed() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.both_failed++;
+}
+
+StepLatencyTracker::Stats StepLatencyTracker::get_stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+json StepLatencyTracker::to_json() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    json steps = json::object();
+    for (const auto& [key, window] : windows_) {
+        if (window.samples.empty()) {
+            continue;
+        }
+        steps[key] = {
+            {"samples", window.samples.size()},
+            {"p50_ms", percentile_of(window.samples, 50)},
+            {"p95_ms", percentile_of(window.samples, 95)},
+            {"p99_ms", percentile_of(window.samples, 99)}
+        };
+    }
+    return json{
+        {"hedges_launched", stats_.hedges_launched},
+        {"primary_wins", stats_.primary_wins},
+        {"hedge_wins", stats_.hedge_wins},
+        {"losers_cancelled", stats_.losers_cancelled},
+        {"both_failed", stats_.both_failed},
+        {"steps", steps}
+    };
+}
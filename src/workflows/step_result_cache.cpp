@@ -0,0 +1,132 @@
+#include "step_result_cache.hpp"
+#include <cstdio>
+
+namespace {
+    // FNV-1a; stable across runs and platforms, unlike std::hash
+    uint64_t fnv1a_64(const std::string& data) {
+        uint64_t hash = 1469598103934665603ULL;
+        for (unsigned char c : data) {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+}
+
+StepResultCache::StepResultCache() : StepResultCache(Config{}) {
+}
+
+StepResultCache::StepResultCache(const Config& config) : config_(config) {
+}
+
+std::string StepResultCache::make_key(const std::string& agent_name, const std::string& function_name,
+                                      const std::string& llm_model, const json& parameters) {
+    // json objects keep their keys sorted, so dump() is already canonical
+    char hash[17];
+    std::snprintf(hash, sizeof(hash), "%016llx",
+                  static_cast<unsigned long long>(fnv1a_64(parameters.dump())));
+
+    std::string key;
+    key.reserve(agent_name.size() + function_name.size() + llm_model.size() + 19);
+    key += agent_name;
+    key += '\x1f';
+    key += function_name;
+    key += '\x1f';
+    key += llm_model;
+    key += '\x1f';
+    key += hash;
+    return key;
+}
+
+bool StepResultCache::lookup(const std::string& key, SharedJson& result) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!config_.enabled) {
+        return false;
+    }
+
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+        stats_.misses++;
+        return false;
+    }
+    if (Clock::now() >= it->second->expires_at) {
+        erase(it->second);
+        stats_.expirations++;
+        stats_.misses++;
+        return false;
+    }
+
+    lru_.splice(lru_.begin(), lru_, it->second);
+    result = it->second->result;
+    stats_.hits++;
+    return true;
+}
+
+void StepResultCache::insert(const std::string& key, SharedJson result) {
+    size_t bytes = key.size() + result->dump().size();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!config_.enabled || bytes > config_.max_bytes) {
+        return;
+    }
+
+    auto existing = index_.find(key);
+    if (existing != index_.end()) {
+        erase(existing->second);
+    }
+
+    lru_.push_front(Entry{key, std::move(result), bytes, Clock::now() + std::chrono::seconds(config_.ttl_seconds)});
+    index_[key] = lru_.begin();
+    bytes_ += bytes;
+    stats_.insertions++;
+    enforce_bounds();
+}
+
+void StepResultCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    lru_.clear();
+    index_.clear();
+    bytes_ = 0;
+}
+
+void StepResultCache::set_config(const Config& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    config_ = config;
+    if (!config_.enabled) {
+        lru_.clear();
+        index_.clear();
+        bytes_ = 0;
+    }
+    enforce_bounds();
+}
+
+StepResultCache::Config StepResultCache::get_config() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return config_;
+}
+
+bool StepResultCache::enabled() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return config_.enabled;
+}
+
+StepResultCache::Stats StepResultCache::get_stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats = stats_;
+    stats.entries = index_.size();
+    stats.bytes = bytes_;
+    return stats;
+}
+
+void StepResultCache::erase(std::list<Entry>::iterator it) {
+    bytes_ -= it->bytes;
+    index_.erase(it->key);
+    lru_.erase(it);
+}
+
+void StepResultCache::enforce_bounds() {
+    while (!lru_.empty() && (index_.size() > config_.max_entries || bytes_ > config_.max_bytes)) {
+        erase(std::prev(lru_.end()));
+        stats_.evictions++;
+    }
+}
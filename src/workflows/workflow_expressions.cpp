@@ -0,0 +1,313 @@
+#include "workflow_expressions.hpp"
+#include <cstdlib>
+
+namespace {
+    const std::string OUTPUT_SUFFIX = "_output";
+
+    std::string trim(const std::string& text) {
+        size_t start = text.find_first_not_of(" \t");
+        if (start == std::string::npos) {
+            return "";
+        }
+        size_t end = text.find_last_not_of(" \t");
+        return text.substr(start, end - start + 1);
+    }
+}
+
+const json* ContextView::find(const std::string& name) const {
+    if (step_outputs_ && name.size() > OUTPUT_SUFFIX.size() &&
+        name.compare(name.size() - OUTPUT_SUFFIX.size(), OUTPUT_SUFFIX.size(), OUTPUT_SUFFIX) == 0) {
+        auto it = step_outputs_->find(name.substr(0, name.size() - OUTPUT_SUFFIX.size()));
+        if (it != step_outputs_->end() && it->second) {
+            return it->second.get();
+        }
+    }
+    if (context_.is_object()) {
+        auto it = context_.find(name);
+        if (it != context_.end()) {
+            return &*it;
+        }
+    }
+    return parent_ ? parent_->find(name) : nullptr;
+}
+
+json ContextView::to_json() const {
+    json result;
+    if (!parent_) {
+        result = context_;
+    } else {
+        result = parent_->to_json();
+        if (context_.is_object()) {
+            for (auto it = context_.begin(); it != context_.end(); ++it) {
+                result[it.key()] = it.value();
+            }
+        }
+    }
+    if (step_outputs_) {
+        for (const auto& [step_id, output] : *step_outputs_) {
+            result[step_id + OUTPUT_SUFFIX] = output ? *output : json();
+        }
+    }
+    return result;
+}
+
+ContextPath::ContextPath(const std::string& path) : path_(path) {
+    size_t start = 0;
+    while (start <= path_.size()) {
+        size_t dot = path_.find('.', start);
+        std::string key = path_.substr(start, dot == std::string::npos ? std::string::npos : dot - start);
+
+        long index = -1;
+        if (!key.empty() && key.find_first_not_of("0123456789") == std::string::npos) {
+            index = std::strtol(key.c_str(), nullptr, 10);
+        }
+        parts_.push_back(Part{std::move(key), index});
+
+        if (dot == std::string::npos) {
+            break;
+        }
+        start = dot + 1;
+    }
+}
+
+const json* ContextPath::find(const ContextView& context) const {
+    if (const json* value = context.find(path_)) {
+        return value;
+    }
+    if (parts_.size() < 2) {
+        return nullptr;
+    }
+
+    const json* current = context.find(parts_.front().key);
+    for (size_t i = 1; current && i < parts_.size(); ++i) {
+        const Part& part = parts_[i];
+        if (current->is_object()) {
+            auto it = current->find(part.key);
+            if (it == current->end()) {
+                return nullptr;
+            }
+            current = &*it;
+        } else if (current->is_array() && part.index >= 0 &&
+                   static_cast<size_t>(part.index) < current->size()) {
+            current = &(*current)[static_cast<size_t>(part.index)];
+        } else {
+            return nullptr;
+        }
+    }
+    return current;
+}
+
+ParameterTemplate::ParameterTemplate(const json& parameters) {
+    root_ = compile(parameters);
+}
+
+json ParameterTemplate::resolve(const ContextView& context) const {
+    return evaluate(root_, context);
+}
+
+ParameterTemplate::Node ParameterTemplate::compile(const json& value) {
+    Node node;
+    if (value.is_string()) {
+        compile_string(value.get_ref<const std::string&>(), node);
+    } else if (value.is_object()) {
+        bool dynamic = false;
+        for (auto it = value.begin(); it != value.end(); ++it) {
+            node.members.emplace_back(it.key(), compile(it.value()));
+            dynamic = dynamic || node.members.back().second.kind != Node::Kind::LITERAL;
+        }
+        node.kind = dynamic ? Node::Kind::OBJECT : Node::Kind::LITERAL;
+    } else if (value.is_array()) {
+        bool dynamic = false;
+        for (const auto& item : value) {
+            node.items.push_back(compile(item));
+            dynamic = dynamic || node.items.back().kind != Node::Kind::LITERAL;
+        }
+        node.kind = dynamic ? Node::Kind::ARRAY : Node::Kind::LITERAL;
+    }
+
+    // Subtrees without references are resolved once, here
+    if (node.kind == Node::Kind::LITERAL) {
+        node = Node{};
+        node.literal = value;
+    }
+    return node;
+}
+
+void ParameterTemplate::compile_string(const std::string& text, Node& node) {
+    size_t position = 0;
+    while (position < text.size()) {
+        size_t start = text.find("{{", position);
+        size_t end = start == std::string::npos ? std::string::npos : text.find("}}", start + 2);
+        if (end == std::string::npos) {
+            node.segments.push_back(Segment{text.substr(position), -1});
+            break;
+        }
+        if (start > position) {
+            node.segments.push_back(Segment{text.substr(position, start - position), -1});
+        }
+        references_.emplace_back(trim(text.substr(start + 2, end - start - 2)));
+        node.segments.push_back(Segment{text.substr(start, end - start + 2),
+                                         static_cast<int>(references_.size() - 1)});
+        position = end + 2;
+    }
+
+    bool dynamic = false;
+    for (const auto& segment : node.segments) {
+        dynamic = dynamic || segment.reference >= 0;
+    }
+    node.kind = dynamic ? Node::Kind::STRING : Node::Kind::LITERAL;
+}
+
+json ParameterTemplate::evaluate(const Node& node, const ContextView& context) const {
+    switch (node.kind) {
+        case Node::Kind::LITERAL:
+            return node.literal;
+
+        case Node::Kind::STRING: {
+            std::string result;
+            for (const auto& segment : node.segments) {
+                const json* value = segment.reference >= 0 ? references_[segment.reference].find(context) : nullptr;
+                if (!value) {
+                    result += segment.text;
+                } else if (value->is_string()) {
+                    result += value->get_ref<const std::string&>();
+                } else {
+                    result += value->dump();
+                }
+            }
+            return result;
+        }
+
+        case Node::Kind::OBJECT: {
+            json result = json::object();
+            for (const auto& member : node.members) {
+                result[member.first] = evaluate(member.second, context);
+            }
+            return result;
+        }
+
+        case Node::Kind::ARRAY: {
+            json result = json::array();
+            for (const auto& item : node.items) {
+                result.push_back(evaluate(item, context));
+            }
+            return result;
+        }
+    }
+    return json();
+}
+
+ConditionExpression::ConditionExpression(const json& condition) : root_(compile(condition)) {
+}
+
+bool ConditionExpression::evaluate(const ContextView& context) const {
+    return evaluate(root_, context);
+}
+
+ConditionExpression::Node ConditionExpression::compile(const json& condition) {
+    Node node;
+    if (!condition.is_object() || condition.empty()) {
+        return node;  // ALWAYS
+    }
+
+    auto compile_children = [&node](const json& children) {
+        for (const auto& child : children) {
+            node.children.push_back(compile(child));
+        }
+    };
+
+    if (condition.contains("and") || condition.contains("or")) {
+        if (condition.contains("and") && condition["and"].is_array()) {
+            node.op = Op::ALL;
+            compile_children(condition["and"]);
+        } else if (condition.contains("or") && condition["or"].is_array()) {
+            node.op = Op::ANY;
+            compile_children(condition["or"]);
+        } else if (condition.contains("not")) {
+            node.op = Op::NOT;
+            node.children.push_back(compile(condition["not"]));
+        }
+        return node;
+    }
+
+    if (condition.contains("field") && condition["field"].is_string() &&
+        condition.contains("operator") && condition["operator"].is_string()) {
+        Op op = parse_operator(condition["operator"].get<std::string>());
+        if (op == Op::EXISTS || condition.contains("value")) {
+            node.op = op;
+            node.field = ContextPath(condition["field"].get<std::string>());
+            node.expected = condition.value("value", json());
+            return node;
+        }
+    }
+
+    if (condition.contains("not")) {
+        node.op = Op::NOT;
+        node.children.push_back(compile(condition["not"]));
+    }
+    return node;
+}
+
+ConditionExpression::Op ConditionExpression::parse_operator(const std::string& name) {
+    if (name == "equals") return Op::EQUALS;
+    if (name == "not_equals") return Op::NOT_EQUALS;
+    if (name == "exists") return Op::EXISTS;
+    if (name == "contains") return Op::CONTAINS;
+    if (name == "greater_than") return Op::GREATER_THAN;
+    if (name == "less_than") return Op::LESS_THAN;
+    if (name == "greater_equal") return Op::GREATER_EQUAL;
+    if (name == "less_equal") return Op::LESS_EQUAL;
+    return Op::UNKNOWN;
+}
+
+bool ConditionExpression::evaluate(const Node& node, const ContextView& context) {
+    switch (node.op) {
+        case Op::ALWAYS:
+            return true;
+        case Op::ALL:
+            for (const auto& child : node.children) {
+                if (!evaluate(child, context)) return false;
+            }
+            return true;
+        case Op::ANY:
+            for (const auto& child : node.children) {
+                if (evaluate(child, context)) return true;
+            }
+            return false;
+        case Op::NOT:
+            return !evaluate(node.children.front(), context);
+        default:
+            break;
+    }
+
+    const json* actual = node.field.find(context);
+    if (!actual) {
+        return false;
+    }
+
+    const json& expected = node.expected;
+    bool numbers = actual->is_number() && expected.is_number();
+    switch (node.op) {
+        case Op::EQUALS:
+            return *actual == expected;
+        case Op::NOT_EQUALS:
+            return *actual != expected;
+        case Op::EXISTS:
+            return true;
+        case Op::CONTAINS:
+            if (actual->is_string() && expected.is_string()) {
+                return actual->get_ref<const std::string&>().find(expected.get_ref<const std::string&>()) != std::string::npos;
+            }
+            return true;
+        case Op::GREATER_THAN:
+            return !numbers || actual->get<double>() > expected.get<double>();
+        case Op::LESS_THAN:
+            return !numbers || actual->get<double>() < expected.get<double>();
+        case Op::GREATER_EQUAL:
+            return !numbers || actual->get<double>() >= expected.get<double>();
+        case Op::LESS_EQUAL:
+            return !numbers || actual->get<double>() <= expected.get<double>();
+        default:
+            return true;  // Unknown operator
+    }
+}
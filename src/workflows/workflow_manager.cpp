@@ -3,7 +3,49 @@
 #include <random>
 #include <sstream>
 #include <iomanip>
-#include <future>
+
+bool WorkflowRequest::is_finished() const {
+    std::lock_guard<std::mutex> lock(completion_mutex_);
+    return finished_;
+}
+
+bool WorkflowRequest::wait_for_completion(std::chrono::milliseconds timeout) const {
+    TaskScheduler::BlockingScope blocking;
+    std::unique_lock<std::mutex> lock(completion_mutex_);
+    return completion_condition_.wait_for(lock, timeout, [this] { return finished_; });
+}
+
+void WorkflowRequest::on_completion(CompletionCallback callback) {
+    {
+        std::lock_guard<std::mutex> lock(completion_mutex_);
+        if (!finished_) {
+            completion_callbacks_.push_back(std::move(callback));
+            return;
+        }
+    }
+    callback(*this);
+}
+
+void WorkflowRequest::notify_completion() {
+    std::vector<CompletionCallback> callbacks;
+    {
+        std::lock_guard<std::mutex> lock(completion_mutex_);
+        if (finished_) {
+            return;
+        }
+        finished_ = true;
+        callbacks.swap(completion_callbacks_);
+    }
+    completion_condition_.notify_all();
+    
+    for (const auto& callback : callbacks) {
+        try {
+            callback(*this);
+        } catch (const std::exception& e) {
+            std::cerr << "[WorkflowManager] Completion callback for request " << id << " threw: " << e.what() << std::endl;
+        }
+    }
+}
 
 WorkflowManager::WorkflowManager(std::shared_ptr<AgentManager> agent_manager, 
                                 size_t max_workers, 
@@ -12,7 +54,8 @@ WorkflowManager::WorkflowManager(std::shared_ptr<AgentManager> agent_manager,
     : agent_manager_(agent_manager), 
       max_workers_(max_workers), 
       max_queue_size_(max_queue_size),
-      max_completed_history_(max_completed_history) {
+      max_completed_history_(max_completed_history),
+      request_tasks_(TaskScheduler::shared(), TaskScheduler::Priority::BATCH, max_workers) {
 }
 
 WorkflowManager::~WorkflowManager() {
@@ -26,9 +69,14 @@ bool WorkflowManager::start() {
     
     running_ = true;
     
-    // Start worker threads
-    for (size_t i = 0; i < max_workers_; ++i) {
-        worker_threads_.emplace_back(&WorkflowManager::worker_thread, this);
+    // Pick up requests submitted while stopped
+    size_t queued;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        queued = request_queue_.size();
+    }
+    for (size_t i = 0; i < queued; ++i) {
+        request_tasks_.submit([this]() { process_next_request(); });
     }
     
     return true;
@@ -41,17 +89,8 @@ void WorkflowManager::stop() {
     
     running_ = false;
     
-    // Notify all workers to wake up and exit
-    queue_condition_.notify_all();
-    
-    // Wait for all worker threads to finish
-    for (auto& thread : worker_threads_) {
-        if (thread.joinable()) {
-            thread.join();
-        }
-    }
-    
-    worker_threads_.clear();
+    // Requests already running finish; queued ones stay queued until start()
+    request_tasks_.wait();
 }
 
 void WorkflowManager::load_function_configs(const json& config) {
@@ -62,6 +101,7 @@ void WorkflowManager::load_function_configs(const json& config) {
 
 void WorkflowManager::set_max_workers(size_t workers) {
     max_workers_ = workers;
+    request_tasks_.set_max_concurrency(workers);
 }
 
 void WorkflowManager::set_max_queue_size(size_t size) {
@@ -84,7 +124,8 @@ std::string WorkflowManager::submit_request(const std::string& agent_name,
 std::string WorkflowManager::submit_request_with_timeout(const std::string& agent_name,
                                                         const std::string& function_name,
                                                         const json& parameters,
-                                                        int timeout_ms) {
+                                                        int timeout_ms,
+                                                        KolosalClient::TokenCallback on_delta) {
     // Validate request
     if (!validate_request(agent_name, function_name, parameters)) {
         std::string error_msg = "Invalid request parameters for agent: " + agent_name + ", function: " + function_name;
@@ -111,6 +152,7 @@ std::string WorkflowManager::submit_request_with_timeout(const std::string& agen
     auto request = std::make_shared<WorkflowRequest>(
         request_id, actual_agent_name, function_name, parameters, timeout_ms
     );
+    request->on_delta = std::move(on_delta);
     
     // Add to queue
     {
@@ -129,8 +171,9 @@ std::string WorkflowManager::submit_request_with_timeout(const std::string& agen
     stats_.total_requests++;
     stats_.active_requests++;
     
-    // Notify workers
-    queue_condition_.notify_one();
+    if (running_.load()) {
+        request_tasks_.submit([this]() { process_next_request(); });
+    }
     
     std::cout << "[WorkflowManager] Request submitted with ID: " << request_id << std::endl;
     return request_id;
@@ -187,6 +230,8 @@ bool WorkflowManager::cancel_request(const std::string& request_id) {
     
     // Move to completed outside of the lock to avoid deadlock
     if (request_to_move) {
+        // Aborts the agent call if a worker is already running it
+        request_to_move->cancel_token->cancel();
         move_to_completed(request_to_move);
         return true;
     }
@@ -267,7 +312,7 @@ json WorkflowManager::get_system_status() {
     
     return json{
         {"running", running_.load()},
-        {"worker_threads", worker_threads_.size()},
+        {"worker_threads", request_tasks_.running()},
         {"max_workers", max_workers_},
         {"max_queue_size", max_queue_size_},
         {"statistics", {
@@ -315,41 +360,35 @@ bool WorkflowManager::validate_request(const std::string& agent_name,
     }
 }
 
-void WorkflowManager::worker_thread() {
-    while (running_.load()) {
-        std::shared_ptr<WorkflowRequest> request;
-        
-        // Get next request from queue
-        {
-            std::unique_lock<std::mutex> lock(queue_mutex_);
-            queue_condition_.wait(lock, [this] { 
-                return !request_queue_.empty() || !running_.load(); 
-            });
-            
-            if (!running_.load()) {
-                break;
-            }
-            
-            if (!request_queue_.empty()) {
-                request = request_queue_.front();
-                request_queue_.pop();
-                stats_.queue_size = request_queue_.size();
-            }
-        }
-        
-        if (request) {
-            process_request(request);
+void WorkflowManager::process_next_request() {
+    if (!running_.load()) {
+        return;
+    }
+    
+    std::shared_ptr<WorkflowRequest> request;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (request_queue_.empty()) {
+            return;
         }
+        request = request_queue_.front();
+        request_queue_.pop();
+        stats_.queue_size = request_queue_.size();
     }
+    
+    process_request(request);
 }
 
 void WorkflowManager::process_request(std::shared_ptr<WorkflowRequest> request) {
-    // Only set to PROCESSING if not already cancelled (protected by mutex)
+    // A request cancelled while it was queued was already moved to the
+    // completed requests by cancel_request(); nothing is dispatched for it
     {
         std::lock_guard<std::mutex> lock(requests_mutex_);
-        if (request->state != WorkflowState::CANCELLED) {
-            request->state = WorkflowState::PROCESSING;
+        if (request->state == WorkflowState::CANCELLED) {
+            stats_.active_requests--;
+            return;
         }
+        request->state = WorkflowState::PROCESSING;
     }
     
     try {
@@ -372,82 +411,96 @@ void WorkflowManager::process_request(std::shared_ptr<WorkflowRequest> request)
 }
 
 void WorkflowManager::execute_request_with_timeout(std::shared_ptr<WorkflowRequest> request) {
-    // Create a future for the execution
-    auto future = std::async(std::launch::async, [this, request]() -> json {
-        // Resolve agent name to agent ID if needed
-        std::string agent_identifier = request->agent_name;
-        
-        // First try to use the agent name as-is (it might be the actual agent name)
-        if (!agent_manager_->agent_exists(agent_identifier)) {
-            // If not found by ID, try to resolve by name
-            std::string resolved_id = agent_manager_->get_agent_id_by_name(agent_identifier);
-            if (!resolved_id.empty()) {
-                agent_identifier = resolved_id;
-            } else {
-                // If still not found, list available agents for better error message
-                json agent_list = agent_manager_->list_agents();
-                std::string error_msg = "Agent not found: " + agent_identifier;
-                if (agent_list.contains("agents") && agent_list["agents"].is_array()) {
-                    error_msg += ". Available agents: ";
-                    for (const auto& agent : agent_list["agents"]) {
-                        if (agent.contains("name")) {
-                            error_msg += agent["name"].get<std::string>() + " ";
-                        }
+    // The function runs on this worker. Its deadline travels in the request's
+    // cancellation token into every HTTP call it makes, so a slow model call
+    // is aborted at the deadline (or on cancel_request) and the worker and
+    // its connection are released instead of staying pinned to it.
+    auto cancel_token = request->cancel_token;
+    cancel_token->set_deadline(CancellationToken::Clock::now() + std::chrono::milliseconds(request->timeout_ms));
+    
+    json result;
+    std::string error;
+    try {
+        result = run_agent_function(*agent_manager_, *request);
+    } catch (const std::exception& e) {
+        error = e.what();
+    } catch (...) {
+        error = "Unknown error";
+    }
+    
+    // Only record the outcome if not already cancelled (protected by mutex)
+    std::lock_guard<std::mutex> lock(requests_mutex_);
+    if (request->state == WorkflowState::CANCELLED) {
+        return;
+    }
+    
+    if (!error.empty() && cancel_token->deadline_exceeded()) {
+        // Failed because the deadline cut it off. A call that succeeded
+        // despite overrunning its deadline keeps its result.
+        request->state = WorkflowState::TIMEOUT;
+        request->error = "Request execution timed out";
+        stats_.timeout_requests++;
+    } else if (!error.empty()) {
+        request->state = WorkflowState::FAILED;
+        request->error = error;
+        stats_.failed_requests++;
+    } else {
+        request->result = std::move(result);
+        request->state = WorkflowState::COMPLETED;
+        stats_.completed_requests++;
+        std::cout << "[WorkflowManager] Request completed successfully: " << request->id << std::endl;
+    }
+}
+
+json WorkflowManager::run_agent_function(AgentManager& agent_manager, const WorkflowRequest& request) {
+    const auto& cancel_token = request.cancel_token;
+    
+    // Resolve agent name to agent ID if needed
+    std::string agent_identifier = request.agent_name;
+    
+    // First try to use the agent name as-is (it might be the actual agent name)
+    if (!agent_manager.agent_exists(agent_identifier)) {
+        // If not found by ID, try to resolve by name
+        std::string resolved_id = agent_manager.get_agent_id_by_name(agent_identifier);
+        if (!resolved_id.empty()) {
+            agent_identifier = resolved_id;
+        } else {
+            // If still not found, list available agents for better error message
+            json agent_list = agent_manager.list_agents();
+            std::string error_msg = "Agent not found: " + agent_identifier;
+            if (agent_list.contains("agents") && agent_list["agents"].is_array()) {
+                error_msg += ". Available agents: ";
+                for (const auto& agent : agent_list["agents"]) {
+                    if (agent.contains("name")) {
+                        error_msg += agent["name"].get<std::string>() + " ";
                     }
                 }
-                throw std::runtime_error(error_msg);
             }
+            throw std::runtime_error(error_msg);
         }
-        
-        std::cout << "[WorkflowManager] Executing function '" << request->function_name 
-                  << "' on agent '" << agent_identifier << "' (" << request->agent_name << ")" << std::endl;
-        std::cout << "[WorkflowManager] Parameters: " << request->parameters.dump() << std::endl;
-        
-        return agent_manager_->execute_agent_function(
-            agent_identifier, 
-            request->function_name, 
-            request->parameters
-        );
-    });
+    }
     
-    // Wait for completion or timeout
-    auto status = future.wait_for(std::chrono::milliseconds(request->timeout_ms));
+    std::cout << "[WorkflowManager] Executing function '" << request.function_name 
+              << "' on agent '" << agent_identifier << "' (" << request.agent_name << ")" << std::endl;
+    std::cout << "[WorkflowManager] Parameters: " << request.parameters.dump() << std::endl;
     
-    if (status == std::future_status::ready) {
-        try {
-            json result = future.get();
-            request->result = result;
-            // Only set to COMPLETED if not already cancelled (protected by mutex)
-            {
-                std::lock_guard<std::mutex> lock(requests_mutex_);
-                if (request->state != WorkflowState::CANCELLED) {
-                    request->state = WorkflowState::COMPLETED;
-                    stats_.completed_requests++;
-                    std::cout << "[WorkflowManager] Request completed successfully: " << request->id << std::endl;
-                }
-            }
-        } catch (const std::exception& e) {
-            // Only set to FAILED if not already cancelled (protected by mutex)
-            {
-                std::lock_guard<std::mutex> lock(requests_mutex_);
-                if (request->state != WorkflowState::CANCELLED) {
-                    request->state = WorkflowState::FAILED;
-                    request->error = e.what();
-                    stats_.failed_requests++;
-                }
-            }
-        }
-    } else {
-        // Only set to TIMEOUT if not already cancelled (protected by mutex)
-        {
-            std::lock_guard<std::mutex> lock(requests_mutex_);
-            if (request->state != WorkflowState::CANCELLED) {
-                request->state = WorkflowState::TIMEOUT;
-                request->error = "Request execution timed out";
-                stats_.timeout_requests++;
-            }
-        }
+    if (request.on_delta && agent_manager.agent_supports_streaming(agent_identifier, request.function_name)) {
+        // Generation also stops once the request is cancelled or times out
+        CancellationToken::Scope scope(cancel_token);
+        const auto& on_delta = request.on_delta;
+        return agent_manager.execute_agent_function_streaming(
+            agent_identifier,
+            request.function_name,
+            request.parameters,
+            [&](const std::string& delta) { return !cancel_token->is_cancelled() && on_delta(delta); }
+        );
     }
+    return agent_manager.execute_agent_function(
+        agent_identifier, 
+        request.function_name, 
+        request.parameters,
+        cancel_token
+    );
 }
 
 std::string WorkflowManager::generate_request_id() {
@@ -489,18 +542,23 @@ void WorkflowManager::validate_function_parameters(const std::string& function_n
 }
 
 void WorkflowManager::move_to_completed(std::shared_ptr<WorkflowRequest> request) {
-    std::lock_guard<std::mutex> lock(requests_mutex_);
-    
-    // Remove from active requests
-    active_requests_.erase(request->id);
-    
-    // Add to completed requests
-    completed_requests_[request->id] = request;
-    
-    // Cleanup if needed
-    if (completed_requests_.size() > max_completed_history_) {
-        cleanup_old_requests();
+    {
+        std::lock_guard<std::mutex> lock(requests_mutex_);
+        
+        // Remove from active requests
+        active_requests_.erase(request->id);
+        
+        // Add to completed requests
+        completed_requests_[request->id] = request;
+        
+        // Cleanup if needed
+        if (completed_requests_.size() > max_completed_history_) {
+            cleanup_old_requests();
+        }
     }
+    
+    // Outside the lock: continuations may call back into the manager
+    request->notify_completion();
 }
 
 void WorkflowManager::cleanup_old_requests() {
@@ -1,18 +1,29 @@
 #include "workflow_types.hpp"
 #include "workflow_manager.hpp"
 #include "logger.hpp"
+#include "stream_channel.hpp"
 #include <random>
-#include <future>
+#include <deque>
+#include <queue>
+#include <functional>
+#include <stdexcept>
 #include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <filesystem>
+#include <cmath>
 #include <yaml-cpp/yaml.h>
 
+namespace {
+    // Extra wait for a step request beyond its own timeout, which WorkflowManager enforces
+    constexpr std::chrono::milliseconds STEP_WAIT_GRACE{5000};
+}
+
 WorkflowOrchestrator::WorkflowOrchestrator(std::shared_ptr<WorkflowManager> workflow_manager)
     : workflow_manager_(workflow_manager),
       workflows_dir_("workflows"),
-      templates_dir_("workflows/templates") {
+      templates_dir_("workflows/templates"),
+      execution_tasks_(TaskScheduler::shared(), TaskScheduler::Priority::BATCH, 2) {
 }
 
 WorkflowOrchestrator::~WorkflowOrchestrator() {
@@ -26,13 +37,22 @@ bool WorkflowOrchestrator::start() {
     
     running_ = true;
     
-    // Start orchestrator threads (2 threads for handling executions)
-    for (int i = 0; i < 2; ++i) {
-        orchestrator_threads_.emplace_back(&WorkflowOrchestrator::orchestrator_thread, this);
+    // Register built-in workflows (before recovery, which needs their definitions)
+    register_builtin_workflows();
+    
+    if (journal_ && !journal_->is_open()) {
+        recover_journaled_executions();
     }
     
-    // Register built-in workflows
-    register_builtin_workflows();
+    // Pick up executions queued while stopped or recovered from the journal
+    size_t pending = 0;
+    {
+        std::lock_guard<std::mutex> lock(orchestrator_mutex_);
+        pending = ready_executions_.size();
+    }
+    for (size_t i = 0; i < pending; ++i) {
+        execution_tasks_.submit([this]() { run_next_execution(); });
+    }
     
     return true;
 }
@@ -43,15 +63,13 @@ void WorkflowOrchestrator::stop() {
     }
     
     running_ = false;
-    execution_condition_.notify_all();
     
-    for (auto& thread : orchestrator_threads_) {
-        if (thread.joinable()) {
-            thread.join();
-        }
-    }
+    // Running executions finish; pending ones wait for the next start()
+    execution_tasks_.wait();
     
-    orchestrator_threads_.clear();
+    if (journal_) {
+        journal_->flush();
+    }
 }
 
 bool WorkflowOrchestrator::load_workflow_config(const std::string& config_file_path) {
@@ -110,7 +128,58 @@ bool WorkflowOrchestrator::load_workflow_config(const std::string& config_file_p
             json agent_mappings = yaml_to_json_simple(yaml_config["agent_llm_mappings"]);
             load_agent_llm_mappings(agent_mappings);
         }
+
+        // Execution journal (crash recovery)
+        if (yaml_config["execution"] && yaml_config["execution"]["journal"]) {
+            const YAML::Node& journal_config = yaml_config["execution"]["journal"];
+            try {
+                if (journal_config["enabled"] && journal_config["enabled"].as<bool>()) {
+                    ExecutionJournal::Config config;
+                    if (journal_config["path"]) {
+                        config.path = journal_config["path"].as<std::string>();
+                    }
+                    if (journal_config["flush_interval_ms"]) {
+                        config.flush_interval_ms = journal_config["flush_interval_ms"].as<int>();
+                    }
+                    enable_execution_journal(config);
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "Invalid execution journal settings: " << e.what() << std::endl;
+            }
+        }
         
+        // Step result cache
+        if (yaml_config["execution"] && yaml_config["execution"]["step_cache"]) {
+            const YAML::Node& cache_config = yaml_config["execution"]["step_cache"];
+            try {
+                StepResultCache::Config config;
+                config.enabled = cache_config["enabled"].as<bool>(config.enabled);
+                config.ttl_seconds = cache_config["ttl_seconds"].as<int>(config.ttl_seconds);
+                config.max_entries = cache_config["max_entries"].as<size_t>(config.max_entries);
+                config.max_bytes = cache_config["max_bytes"].as<size_t>(config.max_bytes);
+                set_step_cache_config(config);
+            } catch (const std::exception& e) {
+                std::cerr << "Invalid step cache settings: " << e.what() << std::endl;
+            }
+        }
+        
+        // Ready queue ordering
+        if (yaml_config["execution"] && yaml_config["execution"]["queue"]) {
+            const YAML::Node& queue_config = yaml_config["execution"]["queue"];
+            ExecutionQueue::Config config;
+            try {
+                if (queue_config["ordering"]) {
+                    config.ordering = ExecutionQueue::parse_ordering(queue_config["ordering"].as<std::string>());
+                }
+                if (queue_config["tenant_fairness"]) {
+                    config.tenant_fairness = queue_config["tenant_fairness"].as<bool>();
+                }
+                set_execution_queue_config(config);
+            } catch (const std::exception& e) {
+                std::cerr << "Invalid execution queue settings: " << e.what() << std::endl;
+            }
+        }
+
         // Load workflow definitions directly from YAML
         if (yaml_config["workflows"] && yaml_config["workflows"].IsSequence()) {
             std::lock_guard<std::mutex> lock(orchestrator_mutex_);
@@ -120,6 +189,7 @@ bool WorkflowOrchestrator::load_workflow_config(const std::string& config_file_p
                     std::cout << "DEBUG: Processing workflow YAML node" << std::endl;
                     WorkflowDefinition workflow = parse_workflow_from_yaml(workflow_node);
                     if (validate_workflow_definition(workflow)) {
+                        compile_step_expressions(workflow);
                         workflow_definitions_[workflow.id] = workflow;
                         std::cout << "DEBUG: Successfully registered workflow: " << workflow.id << std::endl;
                     }
@@ -149,8 +219,11 @@ json WorkflowOrchestrator::get_workflow_config() const {
 }
 
 void WorkflowOrchestrator::register_workflow(const WorkflowDefinition& workflow) {
+    topological_step_order(workflow);  // Throws on unknown dependencies and cycles
+    WorkflowDefinition compiled = workflow;
+    compile_step_expressions(compiled);
     std::lock_guard<std::mutex> lock(orchestrator_mutex_);
-    workflow_definitions_.insert_or_assign(workflow.id, workflow);
+    workflow_definitions_.insert_or_assign(compiled.id, std::move(compiled));
 }
 
 bool WorkflowOrchestrator::remove_workflow(const std::string& workflow_id) {
@@ -173,29 +246,25 @@ WorkflowDefinition* WorkflowOrchestrator::get_workflow(const std::string& workfl
     return (it != workflow_definitions_.end()) ? &it->second : nullptr;
 }
 
-std::string WorkflowOrchestrator::execute_workflow(const std::string& workflow_id, const json& input_data) {
-    auto execution_id = execute_workflow_async(workflow_id, input_data);
+std::string WorkflowOrchestrator::execute_workflow(const std::string& workflow_id, const json& input_data,
+                                                   const std::string& tenant_id, int priority) {
+    auto execution_id = execute_workflow_async(workflow_id, input_data, tenant_id, priority);
+    auto execution = get_execution_status(execution_id);
     
     // Wait for completion with timeout to prevent infinite loops
-    auto start_time = std::chrono::steady_clock::now();
     auto timeout_duration = std::chrono::minutes(2); // 2 minute timeout for tests
-    
-    while (std::chrono::steady_clock::now() - start_time < timeout_duration) {
-        auto execution = get_execution_status(execution_id);
-        if (!execution) break;
-        
-        if (execution->state == WorkflowExecutionState::COMPLETED ||
-            execution->state == WorkflowExecutionState::FAILED ||
-            execution->state == WorkflowExecutionState::CANCELLED ||
-            execution->state == WorkflowExecutionState::TIMEOUT) {
-            break;
-        }
-        
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    if (execution) {
+        TaskScheduler::BlockingScope blocking;
+        std::unique_lock<std::mutex> lock(orchestrator_mutex_);
+        completion_condition_.wait_for(lock, timeout_duration, [&execution] {
+            return execution->state == WorkflowExecutionState::COMPLETED ||
+                   execution->state == WorkflowExecutionState::FAILED ||
+                   execution->state == WorkflowExecutionState::CANCELLED ||
+                   execution->state == WorkflowExecutionState::TIMEOUT;
+        });
     }
     
     // Check if we timed out
-    auto execution = get_execution_status(execution_id);
     if (execution && execution->state == WorkflowExecutionState::RUNNING) {
         execution->state = WorkflowExecutionState::TIMEOUT;
         execution->error_message = "Workflow execution timed out";
@@ -204,62 +273,115 @@ std::string WorkflowOrchestrator::execute_workflow(const std::string& workflow_i
     return execution_id;
 }
 
-std::string WorkflowOrchestrator::execute_workflow_async(const std::string& workflow_id, const json& input_data) {
-    std::lock_guard<std::mutex> lock(orchestrator_mutex_);
-    
-    // Check if workflow exists
-    auto it = workflow_definitions_.find(workflow_id);
-    if (it == workflow_definitions_.end()) {
-        throw std::invalid_argument("Workflow not found: " + workflow_id);
+std::string WorkflowOrchestrator::execute_workflow_async(const std::string& workflow_id, const json& input_data,
+                                                         const std::string& tenant_id, int priority) {
+    std::string execution_id;
+    {
+        std::lock_guard<std::mutex> lock(orchestrator_mutex_);
+        
+        // Check if workflow exists
+        auto it = workflow_definitions_.find(workflow_id);
+        if (it == workflow_definitions_.end()) {
+            throw std::invalid_argument("Workflow not found: " + workflow_id);
+        }
+        
+        // Create execution
+        execution_id = generate_execution_id();
+        auto execution = std::make_shared<WorkflowExecution>(execution_id, workflow_id);
+        execution->input_data = input_data;
+        execution->context = it->second.global_context;
+        execution->context["input"] = input_data;
+        execution->tenant_id = tenant_id;
+        execution->priority = priority;
+        
+        // Add to active executions
+        active_executions_[execution_id] = execution;
+        ready_executions_.push(execution_id, tenant_id, priority);
+        
+        if (journal_) {
+            journal_->record_execution_started(execution_id, workflow_id, input_data, tenant_id, priority,
+                std::chrono::duration_cast<std::chrono::milliseconds>(
+                    execution->start_time.time_since_epoch()).count());
+        }
     }
     
-    // Create execution
-    std::string execution_id = generate_execution_id();
-    auto execution = std::make_shared<WorkflowExecution>(execution_id, workflow_id);
-    execution->input_data = input_data;
-    execution->context = it->second.global_context;
-    execution->context["input"] = input_data;
-    
-    // Add to active executions
-    active_executions_[execution_id] = execution;
-    
-    // Notify orchestrator threads
-    execution_condition_.notify_one();
+    if (running_.load()) {
+        execution_tasks_.submit([this]() { run_next_execution(); });
+    }
     
     return execution_id;
 }
 
 bool WorkflowOrchestrator::pause_execution(const std::string& execution_id) {
-    std::lock_guard<std::mutex> lock(orchestrator_mutex_);
-    auto it = active_executions_.find(execution_id);
-    if (it != active_executions_.end() && it->second->state == WorkflowExecutionState::RUNNING) {
+    std::shared_ptr<WorkflowExecution> execution;
+    {
+        std::lock_guard<std::mutex> lock(orchestrator_mutex_);
+        auto it = active_executions_.find(execution_id);
+        if (it == active_executions_.end() || it->second->state != WorkflowExecutionState::RUNNING) {
+            return false;
+        }
         it->second->state = WorkflowExecutionState::PAUSED;
-        return true;
+        execution = it->second;
     }
-    return false;
+    emit_execution_event(*execution, "execution_paused");
+    return true;
 }
 
 bool WorkflowOrchestrator::resume_execution(const std::string& execution_id) {
-    std::lock_guard<std::mutex> lock(orchestrator_mutex_);
-    auto it = active_executions_.find(execution_id);
-    if (it != active_executions_.end() && it->second->state == WorkflowExecutionState::PAUSED) {
+    std::shared_ptr<WorkflowExecution> execution;
+    {
+        std::lock_guard<std::mutex> lock(orchestrator_mutex_);
+        auto it = active_executions_.find(execution_id);
+        if (it == active_executions_.end() || it->second->state != WorkflowExecutionState::PAUSED) {
+            return false;
+        }
         it->second->state = WorkflowExecutionState::RUNNING;
-        execution_condition_.notify_one();
-        return true;
+        execution = it->second;
     }
-    return false;
+    emit_execution_event(*execution, "execution_resumed");
+    return true;
 }
 
 bool WorkflowOrchestrator::cancel_execution(const std::string& execution_id) {
-    std::lock_guard<std::mutex> lock(orchestrator_mutex_);
-    auto it = active_executions_.find(execution_id);
-    if (it != active_executions_.end()) {
+    std::shared_ptr<WorkflowExecution> execution;
+    bool never_started = false;
+    {
+        std::lock_guard<std::mutex> lock(orchestrator_mutex_);
+        auto it = active_executions_.find(execution_id);
+        if (it == active_executions_.end()) {
+            return false;
+        }
         it->second->state = WorkflowExecutionState::CANCELLED;
         it->second->error_message = "Execution cancelled by user";
-        execution_condition_.notify_one();
-        return true;
+        execution = it->second;
+        never_started = ready_executions_.erase(execution_id);
+        completion_condition_.notify_all();
+    }
+    
+    // Cancelling the step requests wakes the steps waiting on them
+    cancel_step_requests(execution_id);
+    emit_execution_event(*execution, "execution_cancelled");
+    
+    // No orchestrator task will pick a queued execution up any more
+    if (never_started) {
+        execution->end_time = std::chrono::system_clock::now();
+        move_to_completed(execution);
+    }
+    return true;
+}
+
+void WorkflowOrchestrator::cancel_step_requests(const std::string& execution_id) {
+    std::vector<std::string> request_ids;
+    {
+        std::lock_guard<std::mutex> lock(orchestrator_mutex_);
+        auto range = in_flight_requests_.equal_range(execution_id);
+        for (auto it = range.first; it != range.second; ++it) {
+            request_ids.push_back(it->second);
+        }
+    }
+    for (const auto& request_id : request_ids) {
+        workflow_manager_->cancel_request(request_id);
     }
-    return false;
 }
 
 std::shared_ptr<WorkflowExecution> WorkflowOrchestrator::get_execution_status(const std::string& execution_id) {
@@ -284,16 +406,17 @@ json WorkflowOrchestrator::get_execution_progress(const std::string& execution_i
         return json{{"error", "Execution not found"}};
     }
     
+    std::lock_guard<std::mutex> lock(execution->mutex);
     return json{
         {"execution_id", execution->execution_id},
         {"workflow_id", execution->workflow_id},
-        {"state", static_cast<int>(execution->state)},
+        {"state", static_cast<int>(execution->state.load())},
         {"progress_percentage", execution->progress_percentage},
         {"start_time", std::chrono::duration_cast<std::chrono::seconds>(
             execution->start_time.time_since_epoch()).count()},
         {"error_message", execution->error_message},
         {"step_count", execution->step_results.size()},
-        {"context", execution->context}
+        {"context", execution->context_json()}
     };
 }
 
@@ -306,6 +429,176 @@ std::vector<std::shared_ptr<WorkflowExecution>> WorkflowOrchestrator::list_activ
     return executions;
 }
 
+json WorkflowOrchestrator::get_execution_queue_stats() const {
+    std::lock_guard<std::mutex> lock(orchestrator_mutex_);
+    auto stats = ready_executions_.get_stats();
+    const auto& config = ready_executions_.get_config();
+    return json{
+        {"ordering", ExecutionQueue::ordering_to_string(config.ordering)},
+        {"tenant_fairness", config.tenant_fairness},
+        {"queued", stats.queued},
+        {"tenants", stats.tenants},
+        {"priority_levels", stats.priority_levels},
+        {"enqueued", stats.enqueued},
+        {"dispatched", stats.dispatched},
+        {"removed", stats.removed}
+    };
+}
+
+void WorkflowOrchestrator::set_execution_queue_config(const ExecutionQueue::Config& config) {
+    std::lock_guard<std::mutex> lock(orchestrator_mutex_);
+    ready_executions_.set_config(config);
+}
+
+void WorkflowOrchestrator::enable_execution_journal(const ExecutionJournal::Config& config) {
+    if (running_.load()) {
+        throw std::logic_error("The execution journal must be enabled before the orchestrator starts");
+    }
+    journal_ = std::make_unique<ExecutionJournal>(config);
+}
+
+void WorkflowOrchestrator::set_step_cache_config(const StepResultCache::Config& config) {
+    step_cache_.set_config(config);
+}
+
+json WorkflowOrchestrator::get_step_cache_stats() const {
+    auto config = step_cache_.get_config();
+    auto stats = step_cache_.get_stats();
+    uint64_t lookups = stats.hits + stats.misses;
+    return json{
+        {"enabled", config.enabled},
+        {"ttl_seconds", config.ttl_seconds},
+        {"max_entries", config.max_entries},
+        {"max_bytes", config.max_bytes},
+        {"entries", stats.entries},
+        {"bytes", stats.bytes},
+        {"hits", stats.hits},
+        {"misses", stats.misses},
+        {"hit_rate", lookups > 0 ? static_cast<double>(stats.hits) / lookups : 0.0},
+        {"insertions", stats.insertions},
+        {"evictions", stats.evictions},
+        {"expirations", stats.expirations}
+    };
+}
+
+void WorkflowOrchestrator::clear_step_cache() {
+    step_cache_.clear();
+}
+
+json WorkflowOrchestrator::get_hedging_stats() const {
+    return step_latencies_.to_json();
+}
+
+void WorkflowOrchestrator::recover_journaled_executions() {
+    std::vector<ExecutionJournal::RecoveredExecution> recovered;
+    try {
+        recovered = journal_->open();
+    } catch (const std::exception& e) {
+        LOG_ERROR_F("Execution journal unavailable, continuing without it: %s", e.what());
+        journal_.reset();
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(orchestrator_mutex_);
+    for (auto& entry : recovered) {
+        auto workflow = workflow_definitions_.find(entry.workflow_id);
+        if (workflow == workflow_definitions_.end()) {
+            LOG_WARN_F("Dropping journaled execution %s: workflow '%s' is not registered",
+                       entry.execution_id.c_str(), entry.workflow_id.c_str());
+            journal_->record_execution_finished(entry.execution_id, static_cast<int>(WorkflowExecutionState::FAILED));
+            continue;
+        }
+        
+        auto execution = std::make_shared<WorkflowExecution>(entry.execution_id, entry.workflow_id);
+        execution->start_time = std::chrono::system_clock::time_point(std::chrono::milliseconds(entry.start_time_ms));
+        execution->input_data = entry.input_data;
+        execution->context = workflow->second.global_context;
+        execution->context["input"] = entry.input_data;
+        execution->tenant_id = entry.tenant_id;
+        execution->priority = entry.priority;
+        for (const auto& step_id : entry.step_order) {
+            execution->step_outputs[step_id] = std::make_shared<const json>(std::move(entry.step_outputs[step_id]));
+            execution->step_results[step_id] = std::string();  // Satisfies dependents; no request was made
+        }
+        // A LOOP execution reruns the steps its interrupted iteration had not finished
+        execution->recovered_steps.insert(entry.iteration_steps.begin(), entry.iteration_steps.end());
+        execution->recovered_loop_iteration = entry.loop_iteration;
+        execution->execution_log.push_back("Recovered from journal with " +
+                                           std::to_string(entry.step_order.size()) + " completed steps");
+        
+        active_executions_[execution->execution_id] = execution;
+        ready_executions_.push(execution->execution_id, execution->tenant_id, execution->priority);
+        LOG_INFO_F("Resuming execution %s of workflow '%s' after %zu completed steps",
+                   entry.execution_id.c_str(), entry.workflow_id.c_str(), entry.step_order.size());
+    }
+}
+
+bool WorkflowOrchestrator::restore_recovered_step(const WorkflowStep& step, std::shared_ptr<WorkflowExecution> execution) {
+    if (execution->recovered_steps.count(step.id) == 0) {
+        return false;
+    }
+    
+    // The output was restored from the journal; don't call the agent again
+    {
+        std::lock_guard<std::mutex> lock(execution->mutex);
+        auto& stats = execution->step_stats[step.id];
+        stats = StepExecutionStats();
+        stats.start_time = std::chrono::system_clock::now();
+        stats.end_time = stats.start_time;
+        stats.completed_successfully = true;
+    }
+    emit_execution_event(*execution, "step_completed", json{{"step_id", step.id}, {"recovered", true}});
+    return true;
+}
+
+size_t WorkflowOrchestrator::subscribe_execution_events(const std::string& execution_id, ExecutionEventCallback callback) {
+    std::lock_guard<std::mutex> lock(event_mutex_);
+    size_t subscription_id = next_subscription_id_++;
+    event_subscriptions_[subscription_id] = EventSubscription{execution_id, std::move(callback)};
+    return subscription_id;
+}
+
+void WorkflowOrchestrator::unsubscribe_execution_events(size_t subscription_id) {
+    std::lock_guard<std::mutex> lock(event_mutex_);
+    event_subscriptions_.erase(subscription_id);
+}
+
+void WorkflowOrchestrator::emit_execution_event(const WorkflowExecution& execution, const std::string& event_type, json data) {
+    // Collect matching callbacks under the lock, invoke them outside it so a
+    // subscriber may unsubscribe from within its callback
+    std::vector<ExecutionEventCallback> callbacks;
+    {
+        std::lock_guard<std::mutex> lock(event_mutex_);
+        for (const auto& [id, subscription] : event_subscriptions_) {
+            if (subscription.execution_id.empty() || subscription.execution_id == execution.execution_id) {
+                callbacks.push_back(subscription.callback);
+            }
+        }
+    }
+    if (callbacks.empty()) {
+        return;
+    }
+    
+    data["execution_id"] = execution.execution_id;
+    data["workflow_id"] = execution.workflow_id;
+    data["state"] = static_cast<int>(execution.state.load());
+    data["progress_percentage"] = execution.progress_percentage;
+    data["timestamp_ms"] = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    
+    for (const auto& callback : callbacks) {
+        try {
+            callback(execution.execution_id, event_type, data);
+        } catch (const std::exception& e) {
+            LOG_WARN_F("Execution event subscriber failed: %s", e.what());
+        }
+    }
+}
+
+void WorkflowOrchestrator::update_execution_progress(std::shared_ptr<WorkflowExecution> execution) {
+    emit_execution_event(*execution, "progress");
+}
+
 void WorkflowOrchestrator::register_builtin_workflows() {
     register_workflow(WorkflowTemplates::create_research_workflow());
     register_workflow(WorkflowTemplates::create_analysis_workflow());
@@ -313,46 +606,39 @@ void WorkflowOrchestrator::register_builtin_workflows() {
     register_workflow(WorkflowTemplates::create_decision_workflow());
 }
 
-void WorkflowOrchestrator::orchestrator_thread() {
-    while (running_.load()) {
-        std::shared_ptr<WorkflowExecution> execution;
-        
-        // Get next execution to process
-        {
-            std::unique_lock<std::mutex> lock(orchestrator_mutex_);
-            // Add timeout to wait to prevent infinite blocking
-            execution_condition_.wait_for(lock, std::chrono::seconds(5), [this] {
-                return !running_.load() || 
-                       std::any_of(active_executions_.begin(), active_executions_.end(),
-                                  [](const auto& pair) {
-                                      return pair.second->state == WorkflowExecutionState::PENDING ||
-                                             pair.second->state == WorkflowExecutionState::RUNNING;
-                                  });
-            });
-            
-            if (!running_.load()) break;
-            
-            // Find an execution to process
-            for (auto& pair : active_executions_) {
-                if (pair.second->state == WorkflowExecutionState::PENDING) {
-                    execution = pair.second;
-                    execution->state = WorkflowExecutionState::RUNNING;
-                    break;
-                }
-            }
+void WorkflowOrchestrator::run_next_execution() {
+    std::shared_ptr<WorkflowExecution> execution;
+    {
+        std::lock_guard<std::mutex> lock(orchestrator_mutex_);
+        if (!running_.load()) {
+            return;
         }
         
-        if (execution) {
-            try {
-                process_execution(execution);
-            } catch (const std::exception& e) {
-                std::cerr << "[WorkflowOrchestrator] Error processing execution " << execution->execution_id 
-                          << ": " << e.what() << std::endl;
-                execution->state = WorkflowExecutionState::FAILED;
-                execution->error_message = e.what();
-                move_to_completed(execution);
-            }
+        std::string execution_id;
+        if (!ready_executions_.pop(execution_id)) {
+            return;
         }
+        auto it = active_executions_.find(execution_id);
+        if (it == active_executions_.end() || it->second->state != WorkflowExecutionState::PENDING) {
+            return;
+        }
+        execution = it->second;
+        execution->state = WorkflowExecutionState::RUNNING;
+    }
+    
+    if (!execution) {
+        return;
+    }
+    
+    emit_execution_event(*execution, "execution_started");
+    try {
+        process_execution(execution);
+    } catch (const std::exception& e) {
+        std::cerr << "[WorkflowOrchestrator] Error processing execution " << execution->execution_id 
+                  << ": " << e.what() << std::endl;
+        execution->state = WorkflowExecutionState::FAILED;
+        execution->error_message = e.what();
+        move_to_completed(execution);
     }
 }
 
@@ -424,7 +710,7 @@ void WorkflowOrchestrator::execute_sequential_workflow(std::shared_ptr<WorkflowE
         }
         
         // Execute step with retry support
-        if (!execute_step_with_retry(step, execution)) {
+        if (!execute_step_with_retry(step, execution, workflow->default_retry_policy)) {
             if (!step.optional && !workflow->allow_partial_failure) {
                 execution->state = WorkflowExecutionState::FAILED;
                 return;
@@ -433,6 +719,7 @@ void WorkflowOrchestrator::execute_sequential_workflow(std::shared_ptr<WorkflowE
         
         // Update progress
         execution->progress_percentage = ((double)(i + 1) / workflow->steps.size()) * 100.0;
+        update_execution_progress(execution);
     }
     
     if (execution->state == WorkflowExecutionState::RUNNING) {
@@ -441,42 +728,161 @@ void WorkflowOrchestrator::execute_sequential_workflow(std::shared_ptr<WorkflowE
 }
 
 void WorkflowOrchestrator::execute_parallel_workflow(std::shared_ptr<WorkflowExecution> execution) {
-    auto workflow = get_workflow(execution->workflow_id);
-    if (!workflow) return;
+    // Work on a copy: the definition may be replaced or removed while we run
+    WorkflowDefinition workflow;
+    {
+        std::lock_guard<std::mutex> lock(orchestrator_mutex_);
+        auto it = workflow_definitions_.find(execution->workflow_id);
+        if (it == workflow_definitions_.end()) return;
+        workflow = it->second;
+    }
     
-    // Submit all steps in parallel
-    std::vector<std::future<bool>> futures;
+    std::vector<size_t> order;
+    try {
+        order = topological_step_order(workflow);
+    } catch (const std::exception& e) {
+        execution->error_message = e.what();
+        execution->state = WorkflowExecutionState::FAILED;
+        return;
+    }
     
-    for (const auto& step : workflow->steps) {
-        if (execution->state != WorkflowExecutionState::RUNNING) {
-            break;
+    const size_t step_count = workflow.steps.size();
+    std::map<std::string, size_t> step_index;
+    for (size_t i = 0; i < step_count; ++i) {
+        step_index[workflow.steps[i].id] = i;
+    }
+    std::vector<size_t> pending_inputs(step_count, 0);
+    std::vector<bool> skipped(step_count, false);
+    std::vector<std::vector<size_t>> dependents(step_count);
+    for (size_t i = 0; i < step_count; ++i) {
+        for (const auto& dep : workflow.steps[i].dependencies) {
+            dependents[step_index.at(dep)].push_back(i);
+            pending_inputs[i]++;
         }
-        
-        // Skip steps with unmet dependencies for now (simplified)
-        auto future = std::async(std::launch::async, [this, &step, execution]() {
-            return execute_step_with_retry(step, execution);
-        });
-        
-        futures.push_back(std::move(future));
     }
     
-    // Wait for all steps to complete
+    // Ready steps are dispatched in topological order so that, under the
+    // concurrency limit, earlier-declared branches start first.
+    std::vector<size_t> rank(step_count);
+    for (size_t position = 0; position < order.size(); ++position) {
+        rank[order[position]] = position;
+    }
+    auto by_rank = [&rank](size_t a, size_t b) { return rank[a] > rank[b]; };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(by_rank)> ready(by_rank);
+    for (size_t i = 0; i < step_count; ++i) {
+        if (pending_inputs[i] == 0) {
+            ready.push(i);
+        }
+    }
+    
+    // Shared with the step tasks, which may still be unwinding after the
+    // last completion has been consumed
+    struct StepCompletions {
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::deque<std::pair<size_t, bool>> done;  // Step index, succeeded
+    };
+    auto completions = std::make_shared<StepCompletions>();
+    
+    const size_t max_running = static_cast<size_t>(std::max(1, workflow.max_parallel_steps));
+    size_t running = 0;
+    size_t finished = 0;
     bool all_succeeded = true;
-    for (auto& future : futures) {
-        try {
-            if (!future.get()) {
-                all_succeeded = false;
+    bool stop_dispatch = false;
+    
+    // Steps that can never run because an input failed
+    std::function<void(size_t)> skip_dependents = [&](size_t index) {
+        for (size_t dependent : dependents[index]) {
+            if (skipped[dependent]) continue;
+            skipped[dependent] = true;
+            finished++;
+            LOG_WARN_F("Skipping step '%s': dependency '%s' failed",
+                       workflow.steps[dependent].id.c_str(), workflow.steps[index].id.c_str());
+            skip_dependents(dependent);
+        }
+    };
+    
+    while (true) {
+        while (!stop_dispatch && !ready.empty() && running < max_running) {
+            if (execution->state != WorkflowExecutionState::RUNNING) {
+                stop_dispatch = true;
+                break;
             }
-        } catch (const std::exception&) {
+            size_t index = ready.top();
+            ready.pop();
+            running++;
+            const WorkflowStep* step = &workflow.steps[index];
+            const RetryPolicy* retry_policy = &workflow.default_retry_policy;
+            TaskScheduler::shared().submit([this, step, retry_policy, index, execution, completions]() {
+                bool succeeded = false;
+                try {
+                    succeeded = execute_step_with_retry(*step, execution, *retry_policy);
+                } catch (const std::exception& e) {
+                    LOG_ERROR_F("Step '%s' threw: %s", step->id.c_str(), e.what());
+                }
+                {
+                    std::lock_guard<std::mutex> lock(completions->mutex);
+                    completions->done.emplace_back(index, succeeded);
+                }
+                completions->condition.notify_one();
+            }, TaskScheduler::Priority::BATCH);
+        }
+        
+        if (running == 0) {
+            break;  // Nothing in flight and nothing more can be dispatched
+        }
+        
+        std::deque<std::pair<size_t, bool>> done;
+        {
+            TaskScheduler::BlockingScope blocking;
+            std::unique_lock<std::mutex> lock(completions->mutex);
+            while (!completions->condition.wait_for(lock, std::chrono::milliseconds(100),
+                                                    [&] { return !completions->done.empty(); })) {
+                // A step that submitted its request after cancel_execution()
+                // collected them would otherwise run on until its timeout
+                if (execution->state == WorkflowExecutionState::CANCELLED) {
+                    stop_dispatch = true;
+                    lock.unlock();
+                    cancel_step_requests(execution->execution_id);
+                    lock.lock();
+                }
+            }
+            done.swap(completions->done);
+        }
+        
+        for (const auto& [index, succeeded] : done) {
+            running--;
+            finished++;
+            const auto& step = workflow.steps[index];
+            if (succeeded) {
+                for (size_t dependent : dependents[index]) {
+                    if (--pending_inputs[dependent] == 0 && !skipped[dependent]) {
+                        ready.push(dependent);
+                    }
+                }
+                continue;
+            }
+            
             all_succeeded = false;
+            if (!step.optional && !workflow.allow_partial_failure) {
+                stop_dispatch = true;  // Let running steps finish, start nothing new
+                std::lock_guard<std::mutex> lock(execution->mutex);
+                if (execution->error_message.empty()) {
+                    execution->error_message = "Step " + step.id + " failed";
+                }
+            }
+            skip_dependents(index);
         }
+        
+        execution->progress_percentage = (static_cast<double>(finished) / step_count) * 100.0;
+        update_execution_progress(execution);
     }
     
-    execution->progress_percentage = 100.0;
-    
     if (execution->state == WorkflowExecutionState::RUNNING) {
+        execution->progress_percentage = 100.0;
+        update_execution_progress(execution);
         execution->state = all_succeeded ? WorkflowExecutionState::COMPLETED : 
-                          (workflow->allow_partial_failure ? WorkflowExecutionState::COMPLETED : WorkflowExecutionState::FAILED);
+                          (workflow.allow_partial_failure ? WorkflowExecutionState::COMPLETED : WorkflowExecutionState::FAILED);
     }
 }
 
@@ -492,12 +898,12 @@ void WorkflowOrchestrator::execute_conditional_workflow(std::shared_ptr<Workflow
         const auto& step = workflow->steps[i];
         
         // Check condition
-        if (!step.conditions.empty() && !evaluate_condition(step.conditions, execution->context)) {
+        if (step.compiled_conditions && !step.compiled_conditions->evaluate(execution->context_view())) {
             continue; // Skip this step
         }
         
         // Execute step with retry support
-        if (!execute_step_with_retry(step, execution)) {
+        if (!execute_step_with_retry(step, execution, workflow->default_retry_policy)) {
             if (!step.optional && !workflow->allow_partial_failure) {
                 execution->state = WorkflowExecutionState::FAILED;
                 return;
@@ -505,6 +911,7 @@ void WorkflowOrchestrator::execute_conditional_workflow(std::shared_ptr<Workflow
         }
         
         execution->progress_percentage = ((double)(i + 1) / workflow->steps.size()) * 100.0;
+        update_execution_progress(execution);
     }
     
     if (execution->state == WorkflowExecutionState::RUNNING) {
@@ -518,16 +925,24 @@ void WorkflowOrchestrator::execute_loop_workflow(std::shared_ptr<WorkflowExecuti
     if (!workflow) return;
     
     int max_iterations = execution->context.value("max_iterations", 10);
-    json loop_condition = execution->context.value("loop_condition", json{});
+    json loop_condition_json = execution->context.value("loop_condition", json{});
+    ConditionExpression loop_condition(loop_condition_json);
     
-    for (int iteration = 0; iteration < max_iterations; ++iteration) {
+    // After a restart the loop carries on in the iteration it was in
+    const int first_iteration = execution->recovered_loop_iteration;
+    for (int iteration = first_iteration; iteration < max_iterations; ++iteration) {
         if (execution->state != WorkflowExecutionState::RUNNING) {
             break;
         }
         
+        // Journaling the resumed iteration again would drop the steps it had finished
+        if (journal_ && (iteration != first_iteration || execution->recovered_steps.empty())) {
+            journal_->record_loop_iteration(execution->execution_id, iteration);
+        }
+        
         // Execute all steps in this iteration
         for (const auto& step : workflow->steps) {
-            if (!execute_step_with_retry(step, execution)) {
+            if (!execute_step_with_retry(step, execution, workflow->default_retry_policy)) {
                 if (!workflow->allow_partial_failure) {
                     execution->state = WorkflowExecutionState::FAILED;
                     return;
@@ -535,12 +950,16 @@ void WorkflowOrchestrator::execute_loop_workflow(std::shared_ptr<WorkflowExecuti
             }
         }
         
+        // Recovered outputs only stand in for the interrupted iteration
+        execution->recovered_steps.clear();
+        
         // Check loop condition
-        if (!loop_condition.empty() && !evaluate_condition(loop_condition, execution->context)) {
+        if (!loop_condition_json.empty() && !loop_condition.evaluate(execution->context_view())) {
             break; // Exit loop
         }
         
         execution->progress_percentage = ((double)(iteration + 1) / max_iterations) * 100.0;
+        update_execution_progress(execution);
     }
     
     if (execution->state == WorkflowExecutionState::RUNNING) {
@@ -553,29 +972,34 @@ void WorkflowOrchestrator::execute_pipeline_workflow(std::shared_ptr<WorkflowExe
     auto workflow = get_workflow(execution->workflow_id);
     if (!workflow) return;
     
-    json pipeline_data = execution->input_data;
+    if (workflow->pipeline_config.streaming && workflow->steps.size() > 1) {
+        execute_streaming_pipeline_workflow(execution);
+        return;
+    }
+    
+    // Steps receive the previous output through execution->pipeline_input
+    // (see execute_step), which shares it rather than copying it
+    execution->pipeline_input = std::make_shared<const json>(execution->input_data);
     
     for (size_t i = 0; i < workflow->steps.size(); ++i) {
         if (execution->state != WorkflowExecutionState::RUNNING) {
             break;
         }
         
-        auto step = workflow->steps[i];
+        const auto& step = workflow->steps[i];
         
-        // For new array format, we don't merge pipeline data directly
-        // Instead, we update the execution context with pipeline data
+        // The API has always shown array-format steps' input in the context
         if (step.parameters.is_array()) {
-            execution->context["pipeline_input"] = pipeline_data;
-        } else {
-            // Legacy format: Merge pipeline data into step parameters
-            step.parameters["pipeline_input"] = pipeline_data;
+            std::lock_guard<std::mutex> lock(execution->mutex);
+            execution->context_pipeline_input = execution->pipeline_input;
         }
         
         // Execute step with retry support
-        if (execute_step_with_retry(step, execution)) {
+        if (execute_step_with_retry(step, execution, workflow->default_retry_policy)) {
             // Get output and use as input for next step
-            if (execution->step_outputs.find(step.id) != execution->step_outputs.end()) {
-                pipeline_data = execution->step_outputs[step.id];
+            auto output = execution->step_outputs.find(step.id);
+            if (output != execution->step_outputs.end()) {
+                execution->pipeline_input = output->second;
             }
         } else if (!workflow->allow_partial_failure) {
             execution->state = WorkflowExecutionState::FAILED;
@@ -583,54 +1007,374 @@ void WorkflowOrchestrator::execute_pipeline_workflow(std::shared_ptr<WorkflowExe
         }
         
         execution->progress_percentage = ((double)(i + 1) / workflow->steps.size()) * 100.0;
+        update_execution_progress(execution);
     }
     
-    execution->output_data = pipeline_data;
+    execution->output_data = *execution->pipeline_input;
     
     if (execution->state == WorkflowExecutionState::RUNNING) {
         execution->state = WorkflowExecutionState::COMPLETED;
     }
 }
 
-bool WorkflowOrchestrator::execute_step_with_retry(const WorkflowStep& step, std::shared_ptr<WorkflowExecution> execution) {
-    // Initialize step statistics
-    execution->step_stats[step.id] = StepExecutionStats();
-    execution->step_stats[step.id].start_time = std::chrono::system_clock::now();
-    execution->current_step_id = step.id;
+namespace {
+    // Chunks a finished stage output is split into for the next stage: the
+    // elements of an array or of a "results" array, otherwise the output itself
+    std::vector<json> split_into_chunks(const json& output) {
+        const json* items = &output;
+        if (output.is_object() && output.contains("results") && output["results"].is_array()) {
+            items = &output["results"];
+        }
+        if (!items->is_array()) {
+            return {output};
+        }
+        return std::vector<json>(items->begin(), items->end());
+    }
+    
+    // What one call of a stage receives as pipeline_input: a batch of text
+    // chunks as one string, anything else as an array of the chunks
+    json join_chunks(std::vector<json>& chunks) {
+        bool all_text = std::all_of(chunks.begin(), chunks.end(), [](const json& chunk) { return chunk.is_string(); });
+        if (all_text) {
+            std::string text;
+            for (const auto& chunk : chunks) {
+                text += chunk.get_ref<const std::string&>();
+            }
+            return text;
+        }
+        json batch = json::array();
+        for (auto& chunk : chunks) {
+            batch.push_back(std::move(chunk));
+        }
+        return batch;
+    }
+}
+
+void WorkflowOrchestrator::execute_streaming_pipeline_workflow(std::shared_ptr<WorkflowExecution> execution) {
+    using Channel = StreamChannel<json>;
+    
+    struct Stage {
+        std::vector<SharedJson> outputs;  // One per call, in order
+        std::string last_request_id;
+        std::string error;                // Set if the stage failed
+        bool stopped = false;             // Ended early without failing
+        std::chrono::system_clock::time_point start_time;
+        std::chrono::system_clock::time_point end_time;
+    };
     
-    // Determine retry policy (step-specific or workflow default)
-    RetryPolicy retry_policy = step.retry_policy;
-    if (retry_policy.max_retries == 0) {
-        auto workflow = get_workflow(execution->workflow_id);
-        if (workflow) {
-            retry_policy = workflow->default_retry_policy;
+    // Shared with the stage tasks, which may still be unwinding after the
+    // last of them has reported
+    struct Pipeline {
+        WorkflowDefinition workflow;
+        std::vector<std::shared_ptr<Channel>> channels;  // channels[i] feeds stage i + 1
+        std::vector<Stage> stages;
+        std::mutex mutex;
+        std::condition_variable condition;
+        size_t finished = 0;
+    };
+    auto pipeline = std::make_shared<Pipeline>();
+    {
+        std::lock_guard<std::mutex> lock(orchestrator_mutex_);
+        auto it = workflow_definitions_.find(execution->workflow_id);
+        if (it == workflow_definitions_.end()) return;
+        pipeline->workflow = it->second;
+    }
+    const auto& steps = pipeline->workflow.steps;
+    const auto& config = pipeline->workflow.pipeline_config;
+    const size_t stage_count = steps.size();
+    
+    // A stream cannot be resumed midway: after a restart it runs again from
+    // the start unless every stage had already finished
+    bool all_recovered = std::all_of(steps.begin(), steps.end(), [&](const WorkflowStep& step) {
+        return execution->recovered_steps.count(step.id) > 0;
+    });
+    if (all_recovered) {
+        for (const auto& step : steps) {
+            restore_recovered_step(step, execution);
         }
+        {
+            std::lock_guard<std::mutex> lock(execution->mutex);
+            execution->output_data = *execution->step_outputs[steps.back().id];
+        }
+        if (execution->state == WorkflowExecutionState::RUNNING) {
+            execution->state = WorkflowExecutionState::COMPLETED;
+        }
+        return;
     }
+    execution->recovered_steps.clear();
+    
+    pipeline->stages.resize(stage_count);
+    for (size_t i = 0; i + 1 < stage_count; ++i) {
+        pipeline->channels.push_back(std::make_shared<Channel>(config.channel_capacity));
+    }
+    
+    for (size_t index = 0; index < stage_count; ++index) {
+        emit_execution_event(*execution, "step_started", json{{"step_id", steps[index].id},
+                                                               {"agent_name", steps[index].agent_name},
+                                                               {"function_name", steps[index].function_name}});
+        TaskScheduler::shared().submit([this, pipeline, execution, index, stage_count]() {
+            const WorkflowStep& step = pipeline->workflow.steps[index];
+            const auto& config = pipeline->workflow.pipeline_config;
+            Stage& stage = pipeline->stages[index];
+            std::shared_ptr<Channel> input = index > 0 ? pipeline->channels[index - 1] : nullptr;
+            std::shared_ptr<Channel> output = index + 1 < stage_count ? pipeline->channels[index] : nullptr;
+            stage.start_time = std::chrono::system_clock::now();
+            
+            // One call of the step; false if the stream should stop because
+            // the execution was cancelled or the next stage has gone
+            auto call = [&](SharedJson pipeline_input) {
+                json parameters = build_step_parameters(step, *execution, pipeline_input);
+                
+                // Generated text goes downstream while it is being generated,
+                // cut at whitespace once chunk_chars have accumulated
+                struct StreamedText {
+                    std::string pending;
+                    bool streamed = false;
+                };
+                auto text = std::make_shared<StreamedText>();
+                KolosalClient::TokenCallback on_delta;
+                if (output) {
+                    size_t chunk_chars = std::max<size_t>(1, config.chunk_chars);
+                    on_delta = [text, output, chunk_chars](const std::string& delta) {
+                        text->streamed = true;
+                        text->pending += delta;
+                        if (text->pending.size() < chunk_chars) {
+                            return true;
+                        }
+                        size_t cut = text->pending.find_last_of(" \t\n");
+                        cut = (cut == std::string::npos || cut == 0) ? text->pending.size() : cut + 1;
+                        json chunk = text->pending.substr(0, cut);
+                        text->pending.erase(0, cut);
+                        return output->push(std::move(chunk));
+                    };
+                }
+                
+                std::string request_id = workflow_manager_->submit_request_with_timeout(
+                    step.agent_name, step.function_name, parameters, step.timeout_ms, on_delta);
+                stage.last_request_id = request_id;
+                
+                // Registered so that cancel_execution() can cancel the request
+                std::multimap<std::string, std::string>::iterator in_flight;
+                {
+                    std::lock_guard<std::mutex> lock(orchestrator_mutex_);
+                    in_flight = in_flight_requests_.emplace(execution->execution_id, request_id);
+                }
+                auto unregister = [&] {
+                    std::lock_guard<std::mutex> lock(orchestrator_mutex_);
+                    in_flight_requests_.erase(in_flight);
+                };
+                SharedJson result;
+                try {
+                    result = wait_for_step_completion(request_id, execution, step);
+                } catch (...) {
+                    unregister();
+                    throw;
+                }
+                unregister();
+                if (!result) {
+                    return false;
+                }
+                stage.outputs.push_back(result);
+                
+                if (!output) {
+                    return true;
+                }
+                if (text->streamed) {
+                    return text->pending.empty() || output->push(json(std::move(text->pending)));
+                }
+                for (auto& chunk : split_into_chunks(*result)) {
+                    if (!output->push(std::move(chunk))) {
+                        return false;
+                    }
+                }
+                return true;
+            };
+            
+            bool keep_going = true;
+            try {
+                if (!input) {
+                    keep_going = call(std::make_shared<const json>(execution->input_data));
+                } else {
+                    std::vector<json> chunks;
+                    while (keep_going && execution->state == WorkflowExecutionState::RUNNING &&
+                           input->pop_batch(chunks, config.batch_size) > 0) {
+                        keep_going = call(std::make_shared<const json>(join_chunks(chunks)));
+                    }
+                }
+            } catch (const std::exception& e) {
+                // A delta push refused by an abandoned stream aborts the
+                // request; the stage was stopped by its consumer, not failed
+                if (!output || !output->is_cancelled()) {
+                    stage.error = e.what();
+                }
+                keep_going = false;
+            }
+            stage.stopped = !keep_going && stage.error.empty();
+            
+            // Downstream sees the end of the stream, or that it was abandoned;
+            // a stage that stops early also stops its producer
+            if (output) {
+                keep_going ? output->close() : output->cancel();
+            }
+            if (!keep_going && input) {
+                input->cancel();
+            }
+            stage.end_time = std::chrono::system_clock::now();
+            
+            {
+                std::lock_guard<std::mutex> lock(pipeline->mutex);
+                pipeline->finished++;
+            }
+            pipeline->condition.notify_one();
+        }, TaskScheduler::Priority::BATCH);
+    }
+    
+    {
+        TaskScheduler::BlockingScope blocking;
+        std::unique_lock<std::mutex> lock(pipeline->mutex);
+        while (!pipeline->condition.wait_for(lock, std::chrono::milliseconds(100),
+                                             [&] { return pipeline->finished == stage_count; })) {
+            // Stages blocked on a channel don't see a cancellation by themselves
+            if (execution->state != WorkflowExecutionState::RUNNING) {
+                for (const auto& channel : pipeline->channels) {
+                    channel->cancel();
+                }
+            }
+        }
+    }
+    
+    // Status readers may be looking at the execution meanwhile; the mutex is
+    // released before record_step_output and emit_execution_event
+    bool all_succeeded = true;
+    for (size_t index = 0; index < stage_count; ++index) {
+        const WorkflowStep& step = steps[index];
+        Stage& stage = pipeline->stages[index];
+        
+        {
+            std::lock_guard<std::mutex> lock(execution->mutex);
+            auto& stats = execution->step_stats[step.id];
+            stats = StepExecutionStats();
+            stats.start_time = stage.start_time;
+            stats.end_time = stage.end_time;
+            if (!stage.last_request_id.empty()) {
+                execution->step_results[step.id] = stage.last_request_id;
+            }
+            if (!stage.error.empty()) {
+                stats.error_message = stage.error;
+                execution->failed_step_count++;
+                execution->error_message += "Step " + step.id + " failed: " + stage.error + "; ";
+            }
+        }
+        
+        if (!stage.error.empty()) {
+            all_succeeded = false;
+            emit_execution_event(*execution, "step_failed", json{{"step_id", step.id}, {"error", stage.error}});
+            continue;
+        }
+        
+        // A stage called once keeps that output; otherwise its outputs in order
+        if (stage.outputs.size() == 1) {
+            record_step_output(step, execution, stage.outputs.front());
+        } else if (!stage.outputs.empty()) {
+            json outputs = json::array();
+            for (const auto& output : stage.outputs) {
+                outputs.push_back(*output);
+            }
+            record_step_output(step, execution, std::make_shared<const json>(std::move(outputs)));
+        }
+        {
+            std::lock_guard<std::mutex> lock(execution->mutex);
+            execution->step_stats[step.id].completed_successfully =
+                !stage.stopped && execution->state == WorkflowExecutionState::RUNNING;
+        }
+        emit_execution_event(*execution, "step_completed", json{{"step_id", step.id},
+                                                                {"calls", stage.outputs.size()},
+                                                                {"stopped", stage.stopped}});
+    }
+    
+    for (size_t i = 0; i < pipeline->channels.size(); ++i) {
+        auto channel_stats = pipeline->channels[i]->get_stats();
+        std::string log_msg = "Stream " + steps[i].id + " -> " + steps[i + 1].id + ": " +
+                              std::to_string(channel_stats.pushed) + " chunks, " +
+                              std::to_string(channel_stats.producer_waits) + " backpressure waits, max depth " +
+                              std::to_string(channel_stats.max_depth);
+        LOG_DEBUG_F("%s", log_msg.c_str());
+        std::lock_guard<std::mutex> lock(execution->mutex);
+        execution->execution_log.push_back(std::move(log_msg));
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(execution->mutex);
+        auto last_output = execution->step_outputs.find(steps.back().id);
+        if (last_output != execution->step_outputs.end()) {
+            execution->output_data = *last_output->second;
+        }
+        execution->progress_percentage = 100.0;
+    }
+    update_execution_progress(execution);
+    
+    if (execution->state == WorkflowExecutionState::RUNNING) {
+        execution->state = all_succeeded || pipeline->workflow.allow_partial_failure
+            ? WorkflowExecutionState::COMPLETED : WorkflowExecutionState::FAILED;
+    }
+}
+
+bool WorkflowOrchestrator::execute_step_with_retry(const WorkflowStep& step, std::shared_ptr<WorkflowExecution> execution,
+                                                   const RetryPolicy& default_retry_policy) {
+    if (restore_recovered_step(step, execution)) {
+        return true;
+    }
+    
+    // Initialize step statistics
+    {
+        std::lock_guard<std::mutex> lock(execution->mutex);
+        execution->step_stats[step.id] = StepExecutionStats();
+        execution->step_stats[step.id].start_time = std::chrono::system_clock::now();
+        execution->current_step_id = step.id;
+    }
+    emit_execution_event(*execution, "step_started", json{{"step_id", step.id},
+                                                          {"agent_name", step.agent_name},
+                                                          {"function_name", step.function_name}});
+    
+    // Determine retry policy (step-specific or workflow default)
+    const RetryPolicy& retry_policy = step.retry_policy.max_retries == 0 ? default_retry_policy : step.retry_policy;
     
     int attempt = 0;
     int delay_ms = retry_policy.initial_delay_ms;
     
     while (attempt <= retry_policy.max_retries) {
         try {
-            execution->step_stats[step.id].retry_count = attempt;
+            {
+                std::lock_guard<std::mutex> lock(execution->mutex);
+                execution->step_stats[step.id].retry_count = attempt;
+            }
             
             // Log retry attempt
             if (attempt > 0) {
                 std::string log_msg = "Retrying step '" + step.id + "', attempt " + std::to_string(attempt + 1) + 
                                      " of " + std::to_string(retry_policy.max_retries + 1);
-                execution->execution_log.push_back(log_msg);
+                {
+                    std::lock_guard<std::mutex> lock(execution->mutex);
+                    execution->execution_log.push_back(log_msg);
+                }
                 LOG_INFO_F("Retrying step '%s', attempt %d", step.id.c_str(), attempt + 1);
+                emit_execution_event(*execution, "step_retry", json{{"step_id", step.id}, {"attempt", attempt + 1}});
             }
             
             bool success = execute_step(step, execution);
             
             if (success) {
-                execution->step_stats[step.id].completed_successfully = true;
-                execution->step_stats[step.id].end_time = std::chrono::system_clock::now();
+                {
+                    std::lock_guard<std::mutex> lock(execution->mutex);
+                    execution->step_stats[step.id].completed_successfully = true;
+                    execution->step_stats[step.id].end_time = std::chrono::system_clock::now();
+                }
+                emit_execution_event(*execution, "step_completed", json{{"step_id", step.id}});
                 return true;
             }
             
         } catch (const std::exception& e) {
+            std::unique_lock<std::mutex> lock(execution->mutex);
             execution->step_stats[step.id].error_message = e.what();
             
             if (attempt == retry_policy.max_retries) {
@@ -641,6 +1385,8 @@ bool WorkflowOrchestrator::execute_step_with_retry(const WorkflowStep& step, std
                 std::string log_msg = "Step '" + step.id + "' failed after " + std::to_string(attempt + 1) + 
                                      " attempts: " + e.what();
                 execution->execution_log.push_back(log_msg);
+                lock.unlock();
+                emit_execution_event(*execution, "step_failed", json{{"step_id", step.id}, {"error", e.what()}});
                 
                 throw; // Re-throw the exception
             }
@@ -650,6 +1396,7 @@ bool WorkflowOrchestrator::execute_step_with_retry(const WorkflowStep& step, std
         
         // Wait before retry (with exponential backoff)
         if (attempt <= retry_policy.max_retries) {
+            TaskScheduler::BlockingScope blocking;
             std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
             delay_ms = static_cast<int>(delay_ms * retry_policy.backoff_multiplier);
             delay_ms = std::min(delay_ms, retry_policy.max_delay_ms);
@@ -657,95 +1404,140 @@ bool WorkflowOrchestrator::execute_step_with_retry(const WorkflowStep& step, std
     }
     
     // If we get here, all retries failed
+    std::string error;
+    {
+        std::lock_guard<std::mutex> lock(execution->mutex);
+        error = execution->step_stats[step.id].error_message;
+    }
+    emit_execution_event(*execution, "step_failed", json{{"step_id", step.id}, {"error", error}});
     return false;
 }
 
-bool WorkflowOrchestrator::execute_step(const WorkflowStep& step, std::shared_ptr<WorkflowExecution> execution) {
-    try {
-        // Build proper parameters from step definition and execution context
-        json resolved_params = json::object();
-        
-        // Handle array format (new format) - convert to parameter object
-        if (step.parameters.is_array()) {
-            for (const auto& param : step.parameters) {
-                if (param.is_string()) {
-                    std::string param_name = param.get<std::string>();
-                    
-                    // Map parameter names to values from input_data and context
-                    if (param_name == "query") {
-                        resolved_params[param_name] = execution->input_data.value("query", "What is artificial intelligence?");
-                    } else if (param_name == "text") {
-                        // For pipeline workflows, use output from previous step
-                        if (execution->context.contains("pipeline_input")) {
-                            auto pipeline_input = execution->context["pipeline_input"];
-                            if (pipeline_input.is_string()) {
-                                resolved_params[param_name] = pipeline_input.get<std::string>();
-                            } else {
-                                resolved_params[param_name] = execution->input_data.value("text", "Sample text for analysis");
-                            }
+json WorkflowOrchestrator::build_step_parameters(const WorkflowStep& step, const WorkflowExecution& execution,
+                                                const SharedJson& pipeline_input, const json& bindings) {
+    // Sibling steps may record their outputs meanwhile
+    std::lock_guard<std::mutex> lock(execution.mutex);
+    
+    // Build proper parameters from step definition and execution context
+    json resolved_params = json::object();
+    
+    // Handle array format (new format) - convert to parameter object
+    if (step.parameters.is_array()) {
+        for (const auto& param : step.parameters) {
+            if (param.is_string()) {
+                std::string param_name = param.get<std::string>();
+                
+                // Map parameter names to values from input_data and context
+                if (bindings.contains(param_name)) {
+                    resolved_params[param_name] = bindings[param_name];
+                } else if (param_name == "query") {
+                    resolved_params[param_name] = execution.input_data.value("query", "What is artificial intelligence?");
+                } else if (param_name == "text") {
+                    // For pipeline workflows, use output from previous step
+                    if (pipeline_input) {
+                        const json& previous_output = *pipeline_input;
+                        if (previous_output.is_string()) {
+                            resolved_params[param_name] = previous_output.get<std::string>();
                         } else {
-                            resolved_params[param_name] = execution->input_data.value("text", "Sample text for analysis");
+                            resolved_params[param_name] = execution.input_data.value("text", "Sample text for analysis");
                         }
-                    } else if (param_name == "message") {
-                        // For chat functions, use message or query from input
-                        resolved_params[param_name] = execution->input_data.value("message", 
-                            execution->input_data.value("query", "Hello, how can I help you?"));
-                    } else if (param_name == "model") {
-                        // Always use the step's specified LLM model
-                        resolved_params[param_name] = step.llm_model.empty() ? "gemma3-1b" : step.llm_model;
-                    } else if (param_name == "depth") {
-                        resolved_params[param_name] = execution->input_data.value("depth", "basic");
-                    } else if (param_name == "analysis_type") {
-                        resolved_params[param_name] = execution->input_data.value("analysis_type", "general");
-                    } else if (param_name == "context") {
-                        // Provide context from previous step outputs
-                        std::string context_str = "";
-                        for (const auto& [step_id, output] : execution->step_outputs) {
-                            if (output.is_string()) {
-                                context_str += step_id + ": " + output.get<std::string>() + "\n";
-                            } else {
-                                context_str += step_id + ": " + output.dump() + "\n";
-                            }
-                        }
-                        resolved_params[param_name] = context_str.empty() ? execution->context.dump() : context_str;
-                    } else if (param_name == "results") {
-                        resolved_params[param_name] = execution->input_data.value("results", 10);
-                    } else if (param_name == "language") {
-                        resolved_params[param_name] = execution->input_data.value("language", "en");
-                    } else if (param_name == "limit") {
-                        resolved_params[param_name] = execution->input_data.value("limit", 10);
-                    } else if (param_name == "threshold") {
-                        resolved_params[param_name] = execution->input_data.value("threshold", 0.7);
                     } else {
-                        // Try to get from input_data, context, or use empty string
-                        if (execution->input_data.contains(param_name)) {
-                            resolved_params[param_name] = execution->input_data[param_name];
-                        } else if (execution->context.contains(param_name)) {
-                            resolved_params[param_name] = execution->context[param_name];
+                        resolved_params[param_name] = execution.input_data.value("text", "Sample text for analysis");
+                    }
+                } else if (param_name == "message") {
+                    // For chat functions, use message or query from input
+                    resolved_params[param_name] = execution.input_data.value("message", 
+                        execution.input_data.value("query", "Hello, how can I help you?"));
+                } else if (param_name == "model") {
+                    // Always use the step's specified LLM model
+                    resolved_params[param_name] = step.llm_model.empty() ? "gemma3-1b" : step.llm_model;
+                } else if (param_name == "depth") {
+                    resolved_params[param_name] = execution.input_data.value("depth", "basic");
+                } else if (param_name == "analysis_type") {
+                    resolved_params[param_name] = execution.input_data.value("analysis_type", "general");
+                } else if (param_name == "context") {
+                    // Provide context from previous step outputs
+                    std::string context_str = "";
+                    for (const auto& [step_id, output] : execution.step_outputs) {
+                        if (output->is_string()) {
+                            context_str += step_id + ": " + output->get<std::string>() + "\n";
                         } else {
-                            resolved_params[param_name] = "";
+                            context_str += step_id + ": " + output->dump() + "\n";
                         }
                     }
+                    resolved_params[param_name] = context_str.empty() ? execution.context.dump() : context_str;
+                } else if (param_name == "results") {
+                    resolved_params[param_name] = execution.input_data.value("results", 10);
+                } else if (param_name == "language") {
+                    resolved_params[param_name] = execution.input_data.value("language", "en");
+                } else if (param_name == "limit") {
+                    resolved_params[param_name] = execution.input_data.value("limit", 10);
+                } else if (param_name == "threshold") {
+                    resolved_params[param_name] = execution.input_data.value("threshold", 0.7);
+                } else {
+                    // Try to get from input_data, context, or use empty string
+                    if (execution.input_data.contains(param_name)) {
+                        resolved_params[param_name] = execution.input_data[param_name];
+                    } else if (execution.context.contains(param_name)) {
+                        resolved_params[param_name] = execution.context[param_name];
+                    } else {
+                        resolved_params[param_name] = "";
+                    }
+                }
+            }
+        }
+    } else {
+        // Handle legacy object format
+        resolved_params = step.compiled_parameters
+            ? step.compiled_parameters->resolve(ContextView(bindings, execution.context_view()))
+            : resolve_parameters(step.parameters, ContextView(bindings, execution.context_view()));
+        
+        // Pipeline steps also get the previous step's output verbatim
+        if (pipeline_input) {
+            resolved_params["pipeline_input"] = *pipeline_input;
+        }
+    }
+    
+    // Ensure model parameter is always set for functions that need it
+    if (!resolved_params.contains("model") && !step.llm_model.empty()) {
+        resolved_params["model"] = step.llm_model;
+    }
+    
+    // For chat functions, ensure model is specified
+    if (step.function_name == "chat" && !resolved_params.contains("model")) {
+        resolved_params["model"] = step.llm_model.empty() ? "gemma3-1b" : step.llm_model;
+    }
+    
+    // For analyze functions with model support
+    if (step.function_name == "analyze" && !resolved_params.contains("model") && !step.llm_model.empty()) {
+        resolved_params["model"] = step.llm_model;
+    }
+    
+    return resolved_params;
+}
+
+bool WorkflowOrchestrator::execute_step(const WorkflowStep& step, std::shared_ptr<WorkflowExecution> execution) {
+    try {
+        if (step.map) {
+            return execute_map_step(step, execution);
+        }
+        
+        json resolved_params = build_step_parameters(step, *execution, execution->pipeline_input);
+        
+        // Identical calls of cacheable steps are answered without the agent
+        std::string cache_key;
+        if (step.cacheable && step_cache_.enabled()) {
+            cache_key = StepResultCache::make_key(step.agent_name, step.function_name, step.llm_model, resolved_params);
+            SharedJson cached;
+            if (step_cache_.lookup(cache_key, cached)) {
+                LOG_INFO_F("Step '%s' served from the step result cache", step.id.c_str());
+                {
+                    std::lock_guard<std::mutex> lock(execution->mutex);
+                    execution->step_results[step.id] = std::string();  // No request was made
                 }
+                record_step_output(step, execution, cached);
+                return true;
             }
-        } else {
-            // Handle legacy object format
-            resolved_params = resolve_parameters(step.parameters, execution->context);
-        }
-        
-        // Ensure model parameter is always set for functions that need it
-        if (!resolved_params.contains("model") && !step.llm_model.empty()) {
-            resolved_params["model"] = step.llm_model;
-        }
-        
-        // For chat functions, ensure model is specified
-        if (step.function_name == "chat" && !resolved_params.contains("model")) {
-            resolved_params["model"] = step.llm_model.empty() ? "gemma3-1b" : step.llm_model;
-        }
-        
-        // For analyze functions with model support
-        if (step.function_name == "analyze" && !resolved_params.contains("model") && !step.llm_model.empty()) {
-            resolved_params["model"] = step.llm_model;
         }
         
         LOG_INFO_F("Executing step '%s' with agent '%s', function '%s'", 
@@ -757,224 +1549,560 @@ bool WorkflowOrchestrator::execute_step(const WorkflowStep& step, std::shared_pt
             step.agent_name, step.function_name, resolved_params, step.timeout_ms
         );
         
-        execution->step_results[step.id] = request_id;
+        {
+            std::lock_guard<std::mutex> lock(execution->mutex);
+            execution->step_results[step.id] = request_id;
+        }
+        
+        // Registered so that cancel_execution() can cancel the request
+        std::multimap<std::string, std::string>::iterator in_flight;
+        {
+            std::lock_guard<std::mutex> lock(orchestrator_mutex_);
+            in_flight = in_flight_requests_.emplace(execution->execution_id, request_id);
+        }
+        auto unregister = [&] {
+            std::lock_guard<std::mutex> lock(orchestrator_mutex_);
+            in_flight_requests_.erase(in_flight);
+        };
         
         // Wait for completion
-        wait_for_step_completion(request_id, execution, step);
+        SharedJson output;
+        try {
+            output = step.hedge ? wait_for_hedged_step_completion(request_id, resolved_params, execution, step)
+                                : wait_for_step_completion(request_id, execution, step);
+        } catch (...) {
+            unregister();
+            throw;
+        }
+        unregister();
+        
+        if (output) {
+            record_step_output(step, execution, output);
+        }
+        if (!cache_key.empty() && output) {
+            step_cache_.insert(cache_key, output);
+        }
         
         return true;
         
     } catch (const std::exception& e) {
         LOG_ERROR_F("Step '%s' failed: %s", step.id.c_str(), e.what());
+        std::lock_guard<std::mutex> lock(execution->mutex);
         execution->error_message += "Step " + step.id + " failed: " + e.what() + "; ";
         return false;
     }
 }
 
-void WorkflowOrchestrator::wait_for_step_completion(const std::string& request_id,
-                                                   std::shared_ptr<WorkflowExecution> execution,
-                                                   const WorkflowStep& step) {
-    auto start_time = std::chrono::steady_clock::now();
-    auto timeout_duration = std::chrono::seconds(30); // Reduced to 30 second timeout for individual steps
+bool WorkflowOrchestrator::execute_map_step(const WorkflowStep& step, std::shared_ptr<WorkflowExecution> execution) {
+    const auto& map = *step.map;
+    
+    // "search_output.results" or "{{search_output.results}}"
+    std::string items_path = map.items;
+    if (items_path.size() > 4 && items_path.compare(0, 2, "{{") == 0 &&
+        items_path.compare(items_path.size() - 2, 2, "}}") == 0) {
+        items_path = items_path.substr(2, items_path.size() - 4);
+    }
+    // Copied, since sibling steps may record their outputs meanwhile
+    json items;
+    {
+        std::lock_guard<std::mutex> lock(execution->mutex);
+        const json* found = ContextPath(items_path).find(execution->context_view());
+        if (found) {
+            items = *found;
+        }
+    }
+    if (!items.is_array()) {
+        throw std::runtime_error("Map step " + step.id + ": '" + map.items + "' is not an array in the context");
+    }
+    
+    const size_t item_count = items.size();
+    const size_t batch_size = static_cast<size_t>(std::max(1, map.batch_size));
+    const size_t parallelism = static_cast<size_t>(std::max(1, map.parallelism));
+    const size_t call_count = (item_count + batch_size - 1) / batch_size;
+    const std::string index_key = map.item_key + "_index";
+    
+    // Shared with the completion callbacks, which run on request workers
+    struct Completions {
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::deque<size_t> done;  // Call indices
+    };
+    auto completions = std::make_shared<Completions>();
+    
+    std::vector<SharedJson> results(call_count);
+    std::vector<std::string> cache_keys(call_count);
+    std::vector<std::multimap<std::string, std::string>::iterator> in_flight(call_count);
+    std::vector<std::shared_ptr<WorkflowRequest>> requests(call_count);
+    size_t next_call = 0;
+    size_t running = 0;
+    size_t completed = 0;
+    std::string error;
+    bool siblings_cancelled = false;
+    
+    // A pause takes effect between steps, as for any other step: the map
+    // keeps dispatching until every item is processed
+    auto dispatching = [&] {
+        WorkflowExecutionState state = execution->state;
+        return state == WorkflowExecutionState::RUNNING || state == WorkflowExecutionState::PAUSED;
+    };
     
-    LOG_DEBUG_F("Waiting for step completion: %s (request: %s)", step.id.c_str(), request_id.c_str());
+    auto finish_call = [&] {
+        completed++;
+        if (completed % parallelism == 0 || completed == call_count) {
+            emit_execution_event(*execution, "step_progress", json{{"step_id", step.id},
+                                                                   {"completed_calls", completed},
+                                                                   {"total_calls", call_count}});
+        }
+    };
     
-    while (execution->state == WorkflowExecutionState::RUNNING && 
-           std::chrono::steady_clock::now() - start_time < timeout_duration) {
-        auto request_status = workflow_manager_->get_request_status(request_id);
-        if (!request_status) {
-            // If request status is null, the request might not exist or be completed
-            LOG_WARN_F("Request status is null for request: %s", request_id.c_str());
-            break;
+    while (true) {
+        while (error.empty() && next_call < call_count && running < parallelism && dispatching()) {
+            size_t call = next_call++;
+            size_t first = call * batch_size;
+            json bindings = json::object();
+            if (batch_size == 1) {
+                bindings[map.item_key] = items[first];
+            } else {
+                size_t last = std::min(first + batch_size, item_count);
+                bindings[map.item_key] = json(items.begin() + first, items.begin() + last);
+            }
+            bindings[index_key] = first;
+            json parameters = build_step_parameters(step, *execution, execution->pipeline_input, bindings);
+            
+            // Each call of a cacheable map step is cached on its own, so a
+            // retried map only repeats the calls that did not complete
+            if (step.cacheable && step_cache_.enabled()) {
+                cache_keys[call] = StepResultCache::make_key(step.agent_name, step.function_name,
+                                                             step.llm_model, parameters);
+                if (step_cache_.lookup(cache_keys[call], results[call])) {
+                    finish_call();
+                    continue;
+                }
+            }
+            
+            std::string request_id = workflow_manager_->submit_request_with_timeout(
+                step.agent_name, step.function_name, parameters, step.timeout_ms);
+            requests[call] = workflow_manager_->get_request_status(request_id);
+            if (!requests[call]) {
+                error = "request " + request_id + " was lost";
+                break;
+            }
+            {
+                std::lock_guard<std::mutex> lock(orchestrator_mutex_);
+                in_flight[call] = in_flight_requests_.emplace(execution->execution_id, request_id);
+            }
+            running++;
+            requests[call]->on_completion([completions, call](const WorkflowRequest&) {
+                {
+                    std::lock_guard<std::mutex> lock(completions->mutex);
+                    completions->done.push_back(call);
+                }
+                completions->condition.notify_one();
+            });
         }
         
-        LOG_DEBUG_F("Step %s state: %d", step.id.c_str(), static_cast<int>(request_status->state));
+        if (running == 0) {
+            break;  // Nothing in flight and nothing more to start
+        }
         
-        if (request_status->state == WorkflowState::COMPLETED) {
-            execution->step_outputs[step.id] = request_status->result;
-            execution->context[step.id + "_output"] = request_status->result;
-            LOG_INFO_F("Step %s completed successfully", step.id.c_str());
-            LOG_DEBUG_F("Step %s result: %s", step.id.c_str(), request_status->result.dump().c_str());
-            break;
-        } else if (request_status->state == WorkflowState::FAILED ||
-                  request_status->state == WorkflowState::TIMEOUT ||
-                  request_status->state == WorkflowState::CANCELLED) {
-            std::string error_msg = "Step execution failed: " + request_status->error;
-            LOG_ERROR_F("Step %s failed: %s", step.id.c_str(), error_msg.c_str());
-            throw std::runtime_error(error_msg);
+        std::deque<size_t> done;
+        {
+            TaskScheduler::BlockingScope blocking;
+            std::unique_lock<std::mutex> lock(completions->mutex);
+            completions->condition.wait(lock, [&] { return !completions->done.empty(); });
+            done.swap(completions->done);
         }
         
-        // Add more verbose logging for debugging
-        auto elapsed = std::chrono::steady_clock::now() - start_time;
-        if (elapsed > std::chrono::seconds(5)) {
-            LOG_WARN_F("Step %s taking longer than 5 seconds, state: %d", 
-                      step.id.c_str(), static_cast<int>(request_status->state));
+        for (size_t call : done) {
+            running--;
+            {
+                std::lock_guard<std::mutex> lock(orchestrator_mutex_);
+                in_flight_requests_.erase(in_flight[call]);
+            }
+            const auto& request = *requests[call];
+            if (request.state == WorkflowState::COMPLETED) {
+                results[call] = std::make_shared<const json>(request.result);
+                if (!cache_keys[call].empty()) {
+                    step_cache_.insert(cache_keys[call], results[call]);
+                }
+            } else if (error.empty()) {
+                error = request.error.empty() ? "call " + std::to_string(call) + " did not complete" : request.error;
+            }
+            requests[call].reset();
+            finish_call();
         }
         
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        // The step has failed: the calls still running are wasted work, so
+        // cancel them as cancel_execution() would; they report back as usual
+        if (!error.empty() && !siblings_cancelled) {
+            siblings_cancelled = true;
+            for (const auto& request : requests) {
+                if (request) {
+                    workflow_manager_->cancel_request(request->id);
+                }
+            }
+        }
     }
     
-    // Check if we timed out
-    if (std::chrono::steady_clock::now() - start_time >= timeout_duration) {
-        std::string timeout_msg = "Step execution timed out: " + step.id;
-        LOG_ERROR_F("Step execution timed out after 30 seconds: %s", step.id.c_str());
-        throw std::runtime_error(timeout_msg);
+    if (execution->state == WorkflowExecutionState::CANCELLED) {
+        return true;  // Stop quietly, as for an ordinary step
+    }
+    if (error.empty() && next_call < call_count) {
+        error = "execution stopped before every item was processed";
+    }
+    if (!error.empty()) {
+        throw std::runtime_error("Map step " + step.id + " failed: " + error);
     }
-}
-
-std::string WorkflowOrchestrator::generate_execution_id() {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(0, 15);
     
-    std::stringstream ss;
-    ss << "wf-" << std::hex;
-    for (int i = 0; i < 16; ++i) {
-        ss << dis(gen);
+    // In input order. A batch call that returns one result per element is
+    // flattened; any other result stands for its whole batch.
+    json output = json::array();
+    for (size_t call = 0; call < call_count; ++call) {
+        const json& result = *results[call];
+        size_t batch_items = std::min(batch_size, item_count - call * batch_size);
+        if (batch_size > 1 && result.is_array() && result.size() == batch_items) {
+            for (const auto& element : result) {
+                output.push_back(element);
+            }
+        } else {
+            output.push_back(result);
+        }
     }
     
-    return ss.str();
+    {
+        std::lock_guard<std::mutex> lock(execution->mutex);
+        execution->step_results[step.id] = std::string();  // Many requests; none stands for the step
+    }
+    record_step_output(step, execution, std::make_shared<const json>(std::move(output)));
+    LOG_INFO_F("Map step '%s' completed %zu calls over %zu items", step.id.c_str(), call_count, item_count);
+    return true;
 }
 
-bool WorkflowOrchestrator::evaluate_condition(const json& condition, const json& context) {
-    // Handle empty or null conditions
-    if (condition.is_null() || condition.empty()) {
-        return true;
+SharedJson WorkflowOrchestrator::wait_for_step_completion(const std::string& request_id,
+                                                         std::shared_ptr<WorkflowExecution> execution,
+                                                         const WorkflowStep& step) {
+    // WorkflowManager times the request out after step.timeout_ms; the grace
+    // period only covers a request that never got that far
+    auto timeout_duration = std::chrono::milliseconds(std::max(step.timeout_ms, 0)) + STEP_WAIT_GRACE;
+    
+    LOG_DEBUG_F("Waiting for step completion: %s (request: %s)", step.id.c_str(), request_id.c_str());
+    
+    auto request_status = workflow_manager_->get_request_status(request_id);
+    if (!request_status) {
+        // If request status is null, the request might not exist or be completed
+        LOG_WARN_F("Request status is null for request: %s", request_id.c_str());
+        return nullptr;
     }
     
-    // Handle complex conditions with AND/OR logic
-    if (condition.contains("and") || condition.contains("or")) {
-        return evaluate_complex_condition(condition, context);
+    // WorkflowManager signals the request as soon as it reaches a terminal state
+    if (!request_status->wait_for_completion(timeout_duration)) {
+        std::string timeout_msg = "Step execution timed out: " + step.id;
+        LOG_ERROR_F("Step execution timed out after %d ms: %s", step.timeout_ms, step.id.c_str());
+        throw std::runtime_error(timeout_msg);
     }
     
-    // Simple condition evaluation
-    if (condition.contains("field") && condition.contains("operator") && condition.contains("value")) {
-        std::string field = condition["field"];
-        std::string op = condition["operator"];
-        json expected_value = condition["value"];
-        
-        // Navigate nested field paths (e.g., "step_output.result")
-        json actual_value;
-        std::istringstream field_stream(field);
-        std::string field_part;
-        json current_context = context;
-        
-        while (std::getline(field_stream, field_part, '.')) {
-            if (current_context.contains(field_part)) {
-                current_context = current_context[field_part];
-            } else {
-                // Field not found
-                if (op == "exists") return false;
-                return false;
-            }
-        }
-        actual_value = current_context;
-        
-        // Evaluate based on operator
-        if (op == "equals") return actual_value == expected_value;
-        if (op == "not_equals") return actual_value != expected_value;
-        if (op == "exists") return true; // We found the field
-        if (op == "contains" && actual_value.is_string() && expected_value.is_string()) {
-            return actual_value.get<std::string>().find(expected_value.get<std::string>()) != std::string::npos;
-        }
-        if (op == "greater_than" && actual_value.is_number() && expected_value.is_number()) {
-            return actual_value.get<double>() > expected_value.get<double>();
-        }
-        if (op == "less_than" && actual_value.is_number() && expected_value.is_number()) {
-            return actual_value.get<double>() < expected_value.get<double>();
-        }
-        if (op == "greater_equal" && actual_value.is_number() && expected_value.is_number()) {
-            return actual_value.get<double>() >= expected_value.get<double>();
-        }
-        if (op == "less_equal" && actual_value.is_number() && expected_value.is_number()) {
-            return actual_value.get<double>() <= expected_value.get<double>();
+    // Cancelling the execution cancels its step requests; stop quietly
+    if (execution->state == WorkflowExecutionState::CANCELLED) {
+        LOG_DEBUG_F("Execution cancelled while waiting for step %s", step.id.c_str());
+        return nullptr;
+    }
+    
+    LOG_DEBUG_F("Step %s state: %d", step.id.c_str(), static_cast<int>(request_status->state));
+    
+    if (request_status->state == WorkflowState::COMPLETED) {
+        // The one copy of the result; everything downstream shares it
+        auto output = std::make_shared<const json>(request_status->result);
+        LOG_INFO_F("Step %s completed successfully", step.id.c_str());
+        if (KolosalAgent::Logger::instance().should_log(KolosalAgent::LogLevel::DEBUG)) {
+            LOG_DEBUG_F("Step %s result: %s", step.id.c_str(), output->dump().c_str());
         }
+        return output;
     }
     
-    return true; // Default to true for invalid conditions
+    std::string error_msg = "Step execution failed: " + request_status->error;
+    LOG_ERROR_F("Step %s failed: %s", step.id.c_str(), error_msg.c_str());
+    throw std::runtime_error(error_msg);
 }
 
-bool WorkflowOrchestrator::evaluate_complex_condition(const json& condition, const json& context) {
-    // Handle AND conditions
-    if (condition.contains("and") && condition["and"].is_array()) {
-        for (const auto& sub_condition : condition["and"]) {
-            if (!evaluate_condition(sub_condition, context)) {
-                return false; // All must be true for AND
-            }
-        }
-        return true;
+SharedJson WorkflowOrchestrator::wait_for_hedged_step_completion(const std::string& request_id, const json& parameters,
+                                                                std::shared_ptr<WorkflowExecution> execution,
+                                                                const WorkflowStep& step) {
+    const auto& hedge = *step.hedge;
+    const std::string latency_key = execution->workflow_id + "/" + step.id;
+    const auto primary_started = std::chrono::steady_clock::now();
+    auto elapsed_ms = [](std::chrono::steady_clock::time_point since) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+    };
+    
+    auto primary = workflow_manager_->get_request_status(request_id);
+    std::optional<double> delay_ms = step_latencies_.percentile(latency_key, hedge.percentile,
+                                                                static_cast<size_t>(std::max(hedge.min_samples, 1)));
+    // The floor keeps a step with uniform latencies from hedging half its calls
+    if (delay_ms) {
+        delay_ms = std::max<double>(*delay_ms, hedge.min_delay_ms);
+    } else if (hedge.min_delay_ms > 0) {
+        delay_ms = hedge.min_delay_ms;
+    }
+    
+    bool finished_in_time = true;
+    if (primary && delay_ms) {
+        TaskScheduler::BlockingScope blocking;
+        finished_in_time = primary->wait_for_completion(
+            std::chrono::milliseconds(std::max<long long>(1, std::llround(*delay_ms))));
+    }
+    if (!primary || finished_in_time || execution->state != WorkflowExecutionState::RUNNING) {
+        SharedJson output = wait_for_step_completion(request_id, execution, step);
+        if (output) {
+            step_latencies_.record_latency(latency_key, elapsed_ms(primary_started));
+        }
+        return output;
+    }
+    
+    // The original is slower than usual: race a duplicate against it
+    std::string model = select_hedge_model(step, parameters);
+    json hedge_parameters = parameters;
+    if (!model.empty()) {
+        hedge_parameters["model"] = model;
+    }
+    std::string hedge_id = workflow_manager_->submit_request_with_timeout(
+        step.agent_name, step.function_name, hedge_parameters, step.timeout_ms);
+    auto duplicate = workflow_manager_->get_request_status(hedge_id);
+    if (!duplicate) {
+        return wait_for_step_completion(request_id, execution, step);
+    }
+    std::multimap<std::string, std::string>::iterator in_flight;
+    {
+        std::lock_guard<std::mutex> lock(orchestrator_mutex_);
+        in_flight = in_flight_requests_.emplace(execution->execution_id, hedge_id);
+    }
+    step_latencies_.record_hedge_launched();
+    LOG_INFO_F("Step '%s' outlasted its hedge delay of %.0f ms; launched duplicate request %s%s%s",
+               step.id.c_str(), *delay_ms, hedge_id.c_str(),
+               model.empty() ? "" : " on model ", model.c_str());
+    emit_execution_event(*execution, "step_hedged", json{{"step_id", step.id},
+                                                         {"hedge_delay_ms", *delay_ms},
+                                                         {"model", model}});
+    
+    // Wait for the first success, or for both to fail
+    struct Race {
+        std::mutex mutex;
+        std::condition_variable condition;
+    };
+    auto race = std::make_shared<Race>();
+    auto wake = [race](const WorkflowRequest&) {
+        { std::lock_guard<std::mutex> lock(race->mutex); }
+        race->condition.notify_all();
+    };
+    primary->on_completion(wake);
+    duplicate->on_completion(wake);
+    auto succeeded = [](const WorkflowRequest& request) {
+        return request.is_finished() && request.state == WorkflowState::COMPLETED;
+    };
+    
+    // The step as a whole gets the same bound as an unhedged one
+    bool decided;
+    {
+        TaskScheduler::BlockingScope blocking;
+        std::unique_lock<std::mutex> lock(race->mutex);
+        decided = race->condition.wait_until(
+            lock, primary_started + std::chrono::milliseconds(std::max(step.timeout_ms, 0)) + STEP_WAIT_GRACE, [&] {
+                return succeeded(*primary) || succeeded(*duplicate) ||
+                       (primary->is_finished() && duplicate->is_finished());
+            });
     }
     
-    // Handle OR conditions
-    if (condition.contains("or") && condition["or"].is_array()) {
-        for (const auto& sub_condition : condition["or"]) {
-            if (evaluate_condition(sub_condition, context)) {
-                return true; // Any can be true for OR
-            }
+    if (!decided) {
+        workflow_manager_->cancel_request(request_id);
+        workflow_manager_->cancel_request(hedge_id);
+        {
+            std::lock_guard<std::mutex> lock(orchestrator_mutex_);
+            in_flight_requests_.erase(in_flight);
         }
-        return false;
+        LOG_ERROR_F("Hedged step execution timed out after %d ms: %s", step.timeout_ms, step.id.c_str());
+        throw std::runtime_error("Step execution timed out: " + step.id);
     }
     
-    // Handle NOT conditions
-    if (condition.contains("not")) {
-        return !evaluate_condition(condition["not"], context);
+    bool hedge_won = !succeeded(*primary) && succeeded(*duplicate);
+    const std::string& winner_id = hedge_won ? hedge_id : request_id;
+    const std::string& loser_id = hedge_won ? request_id : hedge_id;
+    bool loser_running = !(hedge_won ? primary : duplicate)->is_finished();
+    if (loser_running) {
+        workflow_manager_->cancel_request(loser_id);
+    }
+    {
+        std::lock_guard<std::mutex> lock(orchestrator_mutex_);
+        in_flight_requests_.erase(in_flight);
     }
     
-    return true;
+    if (succeeded(*primary) || succeeded(*duplicate)) {
+        step_latencies_.record_hedge_outcome(hedge_won, loser_running);
+        // The step's latency as its caller saw it, whichever request won; the
+        // duplicate's own time would pull the percentile, and the delay, down
+        step_latencies_.record_latency(latency_key, elapsed_ms(primary_started));
+        LOG_INFO_F("Step '%s': %s request %s won the hedged race", step.id.c_str(),
+                   hedge_won ? "duplicate" : "original", winner_id.c_str());
+    } else {
+        step_latencies_.record_hedge_failed();
+    }
+    {
+        std::lock_guard<std::mutex> lock(execution->mutex);
+        execution->step_results[step.id] = winner_id;
+    }
+    
+    // Returns at once with the winner's output, or throws the original's error
+    return wait_for_step_completion(winner_id, execution, step);
+}
+
+std::string WorkflowOrchestrator::select_hedge_model(const WorkflowStep& step, const json& parameters) const {
+    const std::string& alternate = step.hedge->alternate_model;
+    if (alternate != "auto") {
+        return alternate;
+    }
+    
+    // The first model the agent supports other than the one the original used
+    std::string current = parameters.contains("model") && parameters["model"].is_string()
+        ? parameters["model"].get<std::string>() : step.llm_model;
+    auto agent_it = agent_llm_mappings_.find(step.agent_name);
+    if (agent_it == agent_llm_mappings_.end()) {
+        return "";
+    }
+    auto supported_it = agent_it->second.find("supported_models");
+    if (supported_it == agent_it->second.end()) {
+        return "";
+    }
+    for (const auto& model : supported_it->second) {
+        if (model != current) {
+            return model;
+        }
+    }
+    return "";
+}
+
+void WorkflowOrchestrator::record_step_output(const WorkflowStep& step, std::shared_ptr<WorkflowExecution> execution,
+                                              SharedJson output) {
+    if (journal_) {
+        journal_->record_step_completed(execution->execution_id, step.id, *output);
+    }
+    std::lock_guard<std::mutex> lock(execution->mutex);
+    execution->step_outputs[step.id] = std::move(output);
+}
+
+json WorkflowExecution::context_json() const {
+    json result = context_view().to_json();
+    if (context_pipeline_input) {
+        result["pipeline_input"] = *context_pipeline_input;
+    }
+    return result;
 }
 
-json WorkflowOrchestrator::resolve_parameters(const json& parameters, const json& context) {
-    json resolved;
+json WorkflowExecution::step_outputs_json() const {
+    json outputs = json::object();
+    for (const auto& [step_id, output] : step_outputs) {
+        outputs[step_id] = output ? *output : json();
+    }
+    return outputs;
+}
+
+std::string WorkflowOrchestrator::generate_execution_id() {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<> dis(0, 15);
+    
+    std::stringstream ss;
+    ss << "wf-" << std::hex;
+    for (int i = 0; i < 16; ++i) {
+        ss << dis(gen);
+    }
     
+    return ss.str();
+}
+
+bool WorkflowOrchestrator::evaluate_condition(const json& condition, const ContextView& context) {
+    // One-off evaluation; registered steps use their compiled conditions
+    return ConditionExpression(condition).evaluate(context);
+}
+
+json WorkflowOrchestrator::resolve_parameters(const json& parameters, const ContextView& context) {
     // Handle new format: parameters as array of strings
     if (parameters.is_array()) {
-        resolved = json::object();
+        json resolved = json::object();
         for (const auto& param : parameters) {
             if (param.is_string()) {
-                std::string param_name = param.get<std::string>();
                 // For array format, we just list the parameter names
                 // The actual values will be provided during execution
-                resolved[param_name] = nullptr;  // Placeholder
+                resolved[param.get<std::string>()] = nullptr;  // Placeholder
             }
         }
-    } else {
-        // Legacy format: parameters as object with template resolution
-        resolved = parameters;
-        
-        // Simple template resolution - replace {{field}} with context values
-        std::function<void(json&)> resolve_recursive = [&](json& obj) {
-            if (obj.is_string()) {
-                std::string str = obj;
-                size_t start = str.find("{{");
-                while (start != std::string::npos) {
-                    size_t end = str.find("}}", start);
-                    if (end != std::string::npos) {
-                        std::string field = str.substr(start + 2, end - start - 2);
-                        if (context.contains(field)) {
-                            std::string replacement = context[field].is_string() ? 
-                                                    context[field].get<std::string>() : 
-                                                    context[field].dump();
-                            str.replace(start, end - start + 2, replacement);
-                        }
-                    }
-                    start = str.find("{{", start + 1);
-                }
-                obj = str;
-            } else if (obj.is_object()) {
-                for (auto& [key, value] : obj.items()) {
-                    resolve_recursive(value);
-                }
-            } else if (obj.is_array()) {
-                for (auto& item : obj) {
-                    resolve_recursive(item);
-                }
-            }
-        };
-        
-        resolve_recursive(resolved);
+        return resolved;
     }
     
-    return resolved;
+    // Legacy format: replace {{path}} with context values
+    return ParameterTemplate(parameters).resolve(context);
+}
+
+void WorkflowOrchestrator::parse_pipeline_config(const json& config, WorkflowDefinition& workflow) {
+    if (!config.is_object()) {
+        return;
+    }
+    auto& pipeline = workflow.pipeline_config;
+    pipeline.pass_through_on_error = config.value("pass_through_on_error", pipeline.pass_through_on_error);
+    pipeline.merge_outputs = config.value("merge_outputs", pipeline.merge_outputs);
+    pipeline.output_format = config.value("output_format", pipeline.output_format);
+    pipeline.streaming = config.value("streaming", pipeline.streaming);
+    pipeline.channel_capacity = config.value("channel_capacity", pipeline.channel_capacity);
+    pipeline.batch_size = config.value("batch_size", pipeline.batch_size);
+    pipeline.chunk_chars = config.value("chunk_chars", pipeline.chunk_chars);
+}
+
+std::optional<WorkflowStep::MapConfiguration> WorkflowOrchestrator::parse_map_config(const json& config) {
+    if (!config.is_object() || config.value("items", "").empty()) {
+        return std::nullopt;
+    }
+    WorkflowStep::MapConfiguration map;
+    map.items = config.value("items", "");
+    map.item_key = config.value("item_key", map.item_key);
+    map.parallelism = config.value("parallelism", map.parallelism);
+    map.batch_size = config.value("batch_size", map.batch_size);
+    return map;
+}
+
+std::optional<WorkflowStep::HedgeConfiguration> WorkflowOrchestrator::parse_hedge_config(const json& config) {
+    if (!config.is_object()) {
+        return std::nullopt;
+    }
+    WorkflowStep::HedgeConfiguration hedge;
+    hedge.percentile = config.value("percentile", hedge.percentile);
+    hedge.min_samples = config.value("min_samples", hedge.min_samples);
+    hedge.min_delay_ms = config.value("min_delay_ms", hedge.min_delay_ms);
+    hedge.alternate_model = config.value("alternate_model", hedge.alternate_model);
+    return hedge;
+}
+
+json WorkflowOrchestrator::hedge_config_to_json(const WorkflowStep::HedgeConfiguration& hedge) {
+    return json{
+        {"percentile", hedge.percentile},
+        {"min_samples", hedge.min_samples},
+        {"min_delay_ms", hedge.min_delay_ms},
+        {"alternate_model", hedge.alternate_model}
+    };
+}
+
+json WorkflowOrchestrator::map_config_to_json(const WorkflowStep::MapConfiguration& map) {
+    return json{
+        {"items", map.items},
+        {"item_key", map.item_key},
+        {"parallelism", map.parallelism},
+        {"batch_size", map.batch_size}
+    };
+}
+
+void WorkflowOrchestrator::compile_step_expressions(WorkflowDefinition& workflow) {
+    for (auto& step : workflow.steps) {
+        step.compiled_parameters = step.parameters.is_object()
+            ? std::make_shared<const ParameterTemplate>(step.parameters) : nullptr;
+        step.compiled_conditions = step.conditions.is_null() || step.conditions.empty()
+            ? nullptr : std::make_shared<const ConditionExpression>(step.conditions);
+    }
 }
 
 void WorkflowOrchestrator::load_agent_llm_mappings(const json& config) {
@@ -1037,23 +2165,79 @@ bool WorkflowOrchestrator::validate_workflow_definition(const WorkflowDefinition
             return false;
         }
         
-        // Validate dependencies exist
-        for (const auto& dep : step.dependencies) {
-            bool found = false;
-            for (const auto& other_step : workflow.steps) {
-                if (other_step.id == dep) {
-                    found = true;
-                    break;
-                }
+        // A named hedge model must be one the agent supports
+        if (step.hedge && step.hedge->alternate_model != "auto" &&
+            !validate_agent_llm_pairing(step.agent_name, step.hedge->alternate_model)) {
+            std::cerr << "Invalid hedge model for step " << step.id << ": " << step.hedge->alternate_model << std::endl;
+            return false;
+        }
+        
+    }
+    
+    // Dependencies must name existing steps and form a DAG
+    try {
+        topological_step_order(workflow);
+    } catch (const std::invalid_argument& e) {
+        std::cerr << "Invalid workflow " << workflow.id << ": " << e.what() << std::endl;
+        return false;
+    }
+    
+    return true;
+}
+
+std::vector<size_t> WorkflowOrchestrator::topological_step_order(const WorkflowDefinition& workflow) {
+    const size_t step_count = workflow.steps.size();
+    std::map<std::string, size_t> step_index;
+    for (size_t i = 0; i < step_count; ++i) {
+        if (!step_index.emplace(workflow.steps[i].id, i).second) {
+            throw std::invalid_argument("Duplicate step id: " + workflow.steps[i].id);
+        }
+    }
+    
+    std::vector<size_t> in_degree(step_count, 0);
+    std::vector<std::vector<size_t>> dependents(step_count);
+    for (size_t i = 0; i < step_count; ++i) {
+        for (const auto& dep : workflow.steps[i].dependencies) {
+            auto it = step_index.find(dep);
+            if (it == step_index.end()) {
+                throw std::invalid_argument("Invalid dependency: " + dep + " for step " + workflow.steps[i].id);
             }
-            if (!found) {
-                std::cerr << "Invalid dependency: " << dep << " for step " << step.id << std::endl;
-                return false;
+            dependents[it->second].push_back(i);
+            in_degree[i]++;
+        }
+    }
+    
+    // Min-heap on the declaration index keeps the order stable
+    std::priority_queue<size_t, std::vector<size_t>, std::greater<size_t>> ready;
+    for (size_t i = 0; i < step_count; ++i) {
+        if (in_degree[i] == 0) {
+            ready.push(i);
+        }
+    }
+    
+    std::vector<size_t> order;
+    order.reserve(step_count);
+    while (!ready.empty()) {
+        size_t index = ready.top();
+        ready.pop();
+        order.push_back(index);
+        for (size_t dependent : dependents[index]) {
+            if (--in_degree[dependent] == 0) {
+                ready.push(dependent);
             }
         }
     }
     
-    return true;
+    if (order.size() != step_count) {
+        std::string cycle_steps;
+        for (size_t i = 0; i < step_count; ++i) {
+            if (in_degree[i] > 0) {
+                cycle_steps += (cycle_steps.empty() ? "" : ", ") + workflow.steps[i].id;
+            }
+        }
+        throw std::invalid_argument("Step dependencies form a cycle involving: " + cycle_steps);
+    }
+    return order;
 }
 
 WorkflowDefinition WorkflowOrchestrator::parse_workflow_from_config(const json& workflow_config) {
@@ -1093,6 +2277,14 @@ WorkflowDefinition WorkflowOrchestrator::parse_workflow_from_config(const json&
         workflow.allow_partial_failure = workflow_config.value("allow_partial_failure", false);
     }
     
+    if (workflow_config.contains("max_parallel_steps") && !workflow_config["max_parallel_steps"].is_null()) {
+        workflow.max_parallel_steps = workflow_config.value("max_parallel_steps", 4);
+    }
+    
+    if (workflow_config.contains("pipeline_config") && workflow_config["pipeline_config"].is_object()) {
+        parse_pipeline_config(workflow_config["pipeline_config"], workflow);
+    }
+    
     // Parse steps
     if (workflow_config.contains("steps") && workflow_config["steps"].is_array()) {
         for (const auto& step_config : workflow_config["steps"]) {
@@ -1140,6 +2332,18 @@ WorkflowDefinition WorkflowOrchestrator::parse_workflow_from_config(const json&
                 step.optional = step_config.value("optional", false);
             }
             
+            if (step_config.contains("cacheable") && !step_config["cacheable"].is_null()) {
+                step.cacheable = step_config.value("cacheable", false);
+            }
+            
+            if (step_config.contains("map")) {
+                step.map = parse_map_config(step_config["map"]);
+            }
+            
+            if (step_config.contains("hedge")) {
+                step.hedge = parse_hedge_config(step_config["hedge"]);
+            }
+            
             if (step_config.contains("dependencies") && step_config["dependencies"].is_array()) {
                 for (const auto& dep : step_config["dependencies"]) {
                     if (!dep.is_null() && dep.is_string()) {
@@ -1206,6 +2410,22 @@ WorkflowDefinition WorkflowOrchestrator::parse_workflow_from_yaml(const YAML::No
         workflow.allow_partial_failure = workflow_config["allow_partial_failure"].as<bool>(false);
     }
     
+    if (workflow_config["max_parallel_steps"] && !workflow_config["max_parallel_steps"].IsNull()) {
+        workflow.max_parallel_steps = workflow_config["max_parallel_steps"].as<int>(4);
+    }
+    
+    if (workflow_config["pipeline_config"] && workflow_config["pipeline_config"].IsMap()) {
+        const YAML::Node& pipeline_yaml = workflow_config["pipeline_config"];
+        auto& pipeline = workflow.pipeline_config;
+        pipeline.pass_through_on_error = pipeline_yaml["pass_through_on_error"].as<bool>(pipeline.pass_through_on_error);
+        pipeline.merge_outputs = pipeline_yaml["merge_outputs"].as<bool>(pipeline.merge_outputs);
+        pipeline.output_format = pipeline_yaml["output_format"].as<std::string>(pipeline.output_format);
+        pipeline.streaming = pipeline_yaml["streaming"].as<bool>(pipeline.streaming);
+        pipeline.channel_capacity = pipeline_yaml["channel_capacity"].as<size_t>(pipeline.channel_capacity);
+        pipeline.batch_size = pipeline_yaml["batch_size"].as<size_t>(pipeline.batch_size);
+        pipeline.chunk_chars = pipeline_yaml["chunk_chars"].as<size_t>(pipeline.chunk_chars);
+    }
+    
     // Parse steps
     if (workflow_config["steps"] && workflow_config["steps"].IsSequence()) {
         for (const auto& step_config : workflow_config["steps"]) {
@@ -1289,6 +2509,32 @@ WorkflowDefinition WorkflowOrchestrator::parse_workflow_from_yaml(const YAML::No
                 step.optional = step_config["optional"].as<bool>(false);
             }
             
+            if (step_config["cacheable"] && !step_config["cacheable"].IsNull()) {
+                step.cacheable = step_config["cacheable"].as<bool>(false);
+            }
+            
+            if (step_config["map"] && step_config["map"].IsMap()) {
+                const YAML::Node& map_yaml = step_config["map"];
+                WorkflowStep::MapConfiguration map;
+                map.items = map_yaml["items"].as<std::string>("");
+                map.item_key = map_yaml["item_key"].as<std::string>(map.item_key);
+                map.parallelism = map_yaml["parallelism"].as<int>(map.parallelism);
+                map.batch_size = map_yaml["batch_size"].as<int>(map.batch_size);
+                if (!map.items.empty()) {
+                    step.map = map;
+                }
+            }
+            
+            if (step_config["hedge"] && step_config["hedge"].IsMap()) {
+                const YAML::Node& hedge_yaml = step_config["hedge"];
+                WorkflowStep::HedgeConfiguration hedge;
+                hedge.percentile = hedge_yaml["percentile"].as<double>(hedge.percentile);
+                hedge.min_samples = hedge_yaml["min_samples"].as<int>(hedge.min_samples);
+                hedge.min_delay_ms = hedge_yaml["min_delay_ms"].as<int>(hedge.min_delay_ms);
+                hedge.alternate_model = hedge_yaml["alternate_model"].as<std::string>(hedge.alternate_model);
+                step.hedge = hedge;
+            }
+            
             if (step_config["dependencies"] && step_config["dependencies"].IsSequence()) {
                 for (const auto& dep : step_config["dependencies"]) {
                     if (dep && !dep.IsNull()) {
@@ -1316,9 +2562,16 @@ WorkflowDefinition WorkflowOrchestrator::parse_workflow_from_yaml(const YAML::No
 }
 
 void WorkflowOrchestrator::move_to_completed(std::shared_ptr<WorkflowExecution> execution) {
-    std::lock_guard<std::mutex> lock(orchestrator_mutex_);
-    active_executions_.erase(execution->execution_id);
-    completed_executions_[execution->execution_id] = execution;
+    {
+        std::lock_guard<std::mutex> lock(orchestrator_mutex_);
+        active_executions_.erase(execution->execution_id);
+        completed_executions_[execution->execution_id] = execution;
+    }
+    if (journal_) {
+        journal_->record_execution_finished(execution->execution_id, static_cast<int>(execution->state.load()));
+    }
+    completion_condition_.notify_all();
+    emit_execution_event(*execution, "execution_finished", json{{"error_message", execution->error_message}});
 }
 
 // Workflow Builder Implementation
@@ -1346,6 +2599,11 @@ WorkflowBuilder& WorkflowBuilder::allow_partial_failure(bool allow) {
     return *this;
 }
 
+WorkflowBuilder& WorkflowBuilder::set_max_parallel_steps(int max_steps) {
+    workflow_.max_parallel_steps = max_steps;
+    return *this;
+}
+
 WorkflowBuilder& WorkflowBuilder::set_global_context(const json& context) {
     workflow_.global_context = context;
     return *this;
@@ -1403,6 +2661,45 @@ WorkflowBuilder& WorkflowBuilder::set_step_optional(const std::string& step_id,
     return *this;
 }
 
+WorkflowBuilder& WorkflowBuilder::set_step_cacheable(const std::string& step_id, bool cacheable) {
+    for (auto& step : workflow_.steps) {
+        if (step.id == step_id) {
+            step.cacheable = cacheable;
+            break;
+        }
+    }
+    return *this;
+}
+
+WorkflowBuilder& WorkflowBuilder::set_step_hedge(const std::string& step_id, double percentile,
+                                                 const std::string& alternate_model) {
+    for (auto& step : workflow_.steps) {
+        if (step.id == step_id) {
+            WorkflowStep::HedgeConfiguration hedge;
+            hedge.percentile = percentile;
+            hedge.alternate_model = alternate_model;
+            step.hedge = hedge;
+            break;
+        }
+    }
+    return *this;
+}
+
+WorkflowBuilder& WorkflowBuilder::set_step_map(const std::string& step_id, const std::string& items,
+                                               int parallelism, int batch_size) {
+    for (auto& step : workflow_.steps) {
+        if (step.id == step_id) {
+            WorkflowStep::MapConfiguration map;
+            map.items = items;
+            map.parallelism = parallelism;
+            map.batch_size = batch_size;
+            step.map = map;
+            break;
+        }
+    }
+    return *this;
+}
+
 WorkflowDefinition WorkflowBuilder::build() {
     return workflow_;
 }
@@ -1416,6 +2713,7 @@ namespace WorkflowTemplates {
             .add_step("research", "Researcher", "research", json::array({"query", "depth"}))
             .add_step("analyze", "Analyzer", "analyze", json::array({"text", "analysis_type"}))
             .add_step("summarize", "Assistant", "chat", json::array({"message", "model"}))
+            .set_step_cacheable("research")
             .add_step_dependency("analyze", "research")
             .add_step_dependency("summarize", "analyze")
             .build();
@@ -1493,7 +2791,17 @@ bool WorkflowOrchestrator::save_workflow_definition(const WorkflowDefinition& wo
         workflow_json["created_at"] = workflow.created_at;
         workflow_json["max_execution_time_ms"] = workflow.max_execution_time_ms;
         workflow_json["allow_partial_failure"] = workflow.allow_partial_failure;
+        workflow_json["max_parallel_steps"] = workflow.max_parallel_steps;
         workflow_json["global_context"] = workflow.global_context;
+        workflow_json["pipeline_config"] = {
+            {"pass_through_on_error", workflow.pipeline_config.pass_through_on_error},
+            {"merge_outputs", workflow.pipeline_config.merge_outputs},
+            {"output_format", workflow.pipeline_config.output_format},
+            {"streaming", workflow.pipeline_config.streaming},
+            {"channel_capacity", workflow.pipeline_config.channel_capacity},
+            {"batch_size", workflow.pipeline_config.batch_size},
+            {"chunk_chars", workflow.pipeline_config.chunk_chars}
+        };
         
         if (workflow.retry_policy.has_value()) {
             workflow_json["retry_policy"] = {
@@ -1524,6 +2832,13 @@ bool WorkflowOrchestrator::save_workflow_definition(const WorkflowDefinition& wo
             step_json["llm_model"] = step.llm_model;
             step_json["timeout_ms"] = step.timeout_ms;
             step_json["optional"] = step.optional;
+            step_json["cacheable"] = step.cacheable;
+            if (step.map) {
+                step_json["map"] = map_config_to_json(*step.map);
+            }
+            if (step.hedge) {
+                step_json["hedge"] = hedge_config_to_json(*step.hedge);
+            }
             
             if (step.retry_policy.max_retries > 0) {
                 step_json["retry_policy"] = {
@@ -1558,7 +2873,8 @@ bool WorkflowOrchestrator::save_workflow_definition(const WorkflowDefinition& wo
         file.close();
         
         // Update in-memory cache
-        workflow_definitions_[workflow.name] = workflow;
+        WorkflowDefinition& cached = workflow_definitions_[workflow.name] = workflow;
+        compile_step_expressions(cached);
         
         return true;
     } catch (const std::exception& e) {
@@ -1596,7 +2912,11 @@ bool WorkflowOrchestrator::load_workflow_definition(const std::string& name, Wor
         workflow.created_at = workflow_json.value("created_at", "");
         workflow.max_execution_time_ms = workflow_json.value("max_execution_time_ms", 300000);
         workflow.allow_partial_failure = workflow_json.value("allow_partial_failure", false);
+        workflow.max_parallel_steps = workflow_json.value("max_parallel_steps", 4);
         workflow.global_context = workflow_json.value("global_context", json{});
+        if (workflow_json.contains("pipeline_config")) {
+            parse_pipeline_config(workflow_json["pipeline_config"], workflow);
+        }
         
         // Parse retry policy
         if (workflow_json.contains("retry_policy")) {
@@ -1623,6 +2943,13 @@ bool WorkflowOrchestrator::load_workflow_definition(const std::string& name, Wor
                 step.llm_model = step_json.value("llm_model", "");
                 step.timeout_ms = step_json.value("timeout_ms", 30000);
                 step.optional = step_json.value("optional", false);
+                step.cacheable = step_json.value("cacheable", false);
+                if (step_json.contains("map")) {
+                    step.map = parse_map_config(step_json["map"]);
+                }
+                if (step_json.contains("hedge")) {
+                    step.hedge = parse_hedge_config(step_json["hedge"]);
+                }
                 
                 // Parse step retry policy if present
                 if (step_json.contains("retry_policy")) {
@@ -1650,6 +2977,7 @@ bool WorkflowOrchestrator::load_workflow_definition(const std::string& name, Wor
         }
         
         // Cache in memory
+        compile_step_expressions(workflow);
         workflow_definitions_[name] = workflow;
         
         return true;
@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+#include "cancellation_token.hpp"
+#include "http_client.hpp"
+#include "loopback_server.hpp"
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace {
+
+using Clock = CancellationToken::Clock;
+
+long elapsed_ms(Clock::time_point since) {
+    return static_cast<long>(std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - since).count());
+}
+
+std::string thrown_message(const CancellationToken& token) {
+    try {
+        token.throw_if_cancelled();
+    } catch (const std::runtime_error& e) {
+        return e.what();
+    }
+    return "";
+}
+
+HttpClient::Config client_config(const LoopbackServer& server) {
+    HttpClient::Config config;
+    config.base_url = server.url();
+    config.timeout_seconds = 30;
+    config.max_retries = 0;
+    return config;
+}
+
+}  // namespace
+
+TEST(CancellationTokenTest, NewTokenIsLiveAndHasNoDeadline) {
+    CancellationToken token;
+    EXPECT_FALSE(token.is_cancelled());
+    EXPECT_FALSE(token.has_deadline());
+    EXPECT_FALSE(token.deadline_exceeded());
+    EXPECT_FALSE(token.interrupted());
+    EXPECT_EQ(token.remaining(), Clock::duration::max());
+    EXPECT_NO_THROW(token.throw_if_cancelled());
+}
+
+TEST(CancellationTokenTest, CancelIsSticky) {
+    CancellationToken token;
+    token.cancel();
+    EXPECT_TRUE(token.is_cancelled());
+    EXPECT_FALSE(token.deadline_exceeded());
+    EXPECT_EQ(thrown_message(token), "Operation cancelled");
+    token.cancel();
+    EXPECT_TRUE(token.is_cancelled());
+}
+
+TEST(CancellationTokenTest, DeadlineCancelsOnceItPasses) {
+    CancellationToken token(Clock::now() + std::chrono::milliseconds(50));
+    EXPECT_TRUE(token.has_deadline());
+    EXPECT_FALSE(token.is_cancelled());
+    EXPECT_GT(token.remaining(), Clock::duration::zero());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    EXPECT_TRUE(token.deadline_exceeded());
+    EXPECT_TRUE(token.is_cancelled());
+    EXPECT_EQ(token.remaining(), Clock::duration::zero());
+    EXPECT_EQ(thrown_message(token), "Operation deadline exceeded");
+}
+
+TEST(CancellationTokenTest, SleepStopsAtTheDeadline) {
+    CancellationToken token(Clock::now() + std::chrono::milliseconds(50));
+    auto start = Clock::now();
+    EXPECT_FALSE(token.sleep_for(std::chrono::seconds(10)));
+    EXPECT_GE(elapsed_ms(start), 45);
+    EXPECT_LT(elapsed_ms(start), 2000);
+}
+
+TEST(CancellationTokenTest, SleepWakesOnCancel) {
+    CancellationToken token;
+    std::thread canceller([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        token.cancel();
+    });
+    auto start = Clock::now();
+    EXPECT_FALSE(token.sleep_for(std::chrono::seconds(10)));
+    EXPECT_LT(elapsed_ms(start), 2000);
+    canceller.join();
+
+    // A live token sleeps the full time
+    CancellationToken live;
+    EXPECT_TRUE(live.sleep_for(std::chrono::milliseconds(10)));
+}
+
+TEST(CancellationTokenTest, ScopesNestAndRestoreThePreviousToken) {
+    EXPECT_EQ(CancellationToken::current(), nullptr);
+    auto outer = std::make_shared<CancellationToken>();
+    auto inner = std::make_shared<CancellationToken>();
+    {
+        CancellationToken::Scope outer_scope(outer);
+        EXPECT_EQ(CancellationToken::current(), outer);
+        {
+            CancellationToken::Scope inner_scope(inner);
+            EXPECT_EQ(CancellationToken::current(), inner);
+
+            // The current token is per thread
+            std::shared_ptr<CancellationToken> seen_elsewhere = inner;
+            std::thread([&] { seen_elsewhere = CancellationToken::current(); }).join();
+            EXPECT_EQ(seen_elsewhere, nullptr);
+        }
+        EXPECT_EQ(CancellationToken::current(), outer);
+        {
+            CancellationToken::Scope cleared(nullptr);
+            EXPECT_EQ(CancellationToken::current(), nullptr);
+        }
+        EXPECT_EQ(CancellationToken::current(), outer);
+    }
+    EXPECT_EQ(CancellationToken::current(), nullptr);
+}
+
+TEST(CancellationTokenTest, HttpRequestIsCutOffAtTheDeadline) {
+    LoopbackServer server([](const LoopbackServer::Request&) {
+        LoopbackServer::Response response;
+        response.delay_ms = 10000;
+        return response;
+    });
+    HttpClient client(client_config(server));
+
+    auto token = std::make_shared<CancellationToken>(Clock::now() + std::chrono::milliseconds(300));
+    CancellationToken::Scope scope(token);
+    auto start = Clock::now();
+    HttpClient::Result result = client.request("GET", "/slow");
+
+    EXPECT_LT(elapsed_ms(start), 1500);
+    EXPECT_FALSE(result.is_success());
+    EXPECT_TRUE(result.cancelled);
+    EXPECT_EQ(result.status_code, 499);
+    EXPECT_TRUE(token->interrupted());
+    EXPECT_EQ(server.hits("/slow"), 1u);
+}
+
+TEST(CancellationTokenTest, HttpRequestIsAbortedWhenTheTokenIsCancelled) {
+    LoopbackServer server([](const LoopbackServer::Request&) {
+        LoopbackServer::Response response;
+        response.delay_ms = 10000;
+        return response;
+    });
+    HttpClient client(client_config(server));
+
+    // No deadline: only the progress callback can notice the cancel
+    auto token = std::make_shared<CancellationToken>();
+    CancellationToken::Scope scope(token);
+    std::thread canceller([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        token->cancel();
+    });
+    auto start = Clock::now();
+    HttpClient::Result result = client.request("GET", "/slow");
+    canceller.join();
+
+    EXPECT_LT(elapsed_ms(start), 2500);
+    EXPECT_TRUE(result.cancelled);
+    EXPECT_EQ(result.status_code, 499);
+    EXPECT_TRUE(token->interrupted());
+}
+
+TEST(CancellationTokenTest, HttpRequestWithinTheDeadlineIsUntouched) {
+    LoopbackServer server([](const LoopbackServer::Request&) {
+        LoopbackServer::Response response;
+        response.body = "{\"ok\":true}";
+        return response;
+    });
+    HttpClient client(client_config(server));
+
+    auto token = std::make_shared<CancellationToken>(Clock::now() + std::chrono::seconds(10));
+    CancellationToken::Scope scope(token);
+    HttpClient::Result result = client.request("GET", "/fast");
+
+    EXPECT_TRUE(result.is_success());
+    EXPECT_EQ(result.body, "{\"ok\":true}");
+    EXPECT_FALSE(result.cancelled);
+    EXPECT_FALSE(token->interrupted());
+}
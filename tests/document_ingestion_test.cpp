@@ -0,0 +1,374 @@
+#include <gtest/gtest.h>
+#include "functions/retrieval.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace kolosal;
+
+namespace {
+
+constexpr size_t DIMENSION = 16;
+
+std::string sentences(size_t count) {
+    std::string text;
+    for (size_t i = 0; i < count; ++i) {
+        text += "Sentence number " + std::to_string(i) + " says something short. ";
+    }
+    return text;
+}
+
+// Checks that chunks are in-order substrings of text, each starting overlap
+// characters before the previous one ended, and together covering the text
+void expect_chunks_cover(const std::string& text, const std::vector<std::string>& chunks, int chunk_size,
+                         int overlap) {
+    ASSERT_FALSE(chunks.empty());
+    size_t start = 0;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        EXPECT_LE(chunks[i].size(), static_cast<size_t>(chunk_size)) << "chunk " << i;
+        ASSERT_EQ(text.compare(start, chunks[i].size(), chunks[i]), 0) << "chunk " << i << " at " << start;
+        size_t end = start + chunks[i].size();
+        if (i + 1 < chunks.size()) {
+            ASSERT_GT(end, static_cast<size_t>(overlap));
+            start = end - overlap;
+        } else {
+            EXPECT_EQ(end, text.size());
+        }
+    }
+}
+
+// Deterministic unit vector per text, so a search for a chunk's text finds it
+std::vector<float> embed(const std::string& text) {
+    std::mt19937 gen(static_cast<uint32_t>(std::hash<std::string>{}(text)));
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    std::vector<float> embedding(DIMENSION);
+    for (auto& value : embedding) {
+        value = dist(gen);
+    }
+    return normalize_vector(embedding);
+}
+
+class DocumentIngestionTest : public ::testing::Test {
+protected:
+    RetrievalConfig config_;
+    RetrievalManager manager_;
+    std::mutex mutex_;
+    std::vector<std::vector<std::string>> calls_;  // Texts of each embedding call
+    std::function<void(const std::vector<std::string>&)> before_embedding_;
+
+    void SetUp() override {
+        config_.embedding_dimension = DIMENSION;
+        config_.chunk_size = 200;
+        config_.chunk_overlap = 20;
+        config_.embedding_batch_size = 8;
+        config_.ingest_threads = 2;
+        config_.max_inflight_batches = 2;
+    }
+
+    void start() {
+        ASSERT_TRUE(manager_.initialize(config_));
+        manager_.set_embedding_function([this](const std::vector<std::string>& texts) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                calls_.push_back(texts);
+            }
+            if (before_embedding_) {
+                before_embedding_(texts);
+            }
+            std::vector<std::vector<float>> embeddings;
+            for (const auto& text : texts) {
+                embeddings.push_back(embed(text));
+            }
+            return embeddings;
+        });
+    }
+
+    static std::vector<Document> short_documents(const std::string& prefix, size_t count) {
+        std::vector<Document> documents;
+        for (size_t i = 0; i < count; ++i) {
+            documents.emplace_back(prefix + std::to_string(i), "Short document " + prefix + std::to_string(i), "test");
+        }
+        return documents;
+    }
+
+    std::vector<SearchResult> search_for(const std::string& text) {
+        SearchOptions options;
+        options.limit = 1;
+        options.threshold = 0.99f;
+        return manager_.search(text, options);
+    }
+};
+
+}  // namespace
+
+TEST(ChunkTextTest, ShortAndEmptyTextAreNotSplit) {
+    EXPECT_TRUE(RetrievalFunctions::chunk_text("", 100, 10).empty());
+    EXPECT_TRUE(RetrievalFunctions::chunk_text("text", 0, 10).empty());
+    EXPECT_EQ(RetrievalFunctions::chunk_text("short text", 100, 10), std::vector<std::string>{"short text"});
+    std::string exact(100, 'x');
+    EXPECT_EQ(RetrievalFunctions::chunk_text(exact, 100, 10), std::vector<std::string>{exact});
+}
+
+TEST(ChunkTextTest, SplitsUnbrokenTextAtTheChunkSize) {
+    std::string text(1000, 'x');
+    auto chunks = RetrievalFunctions::chunk_text(text, 100, 10);
+    // Each chunk after the first advances by 100 - 10 characters
+    EXPECT_EQ(chunks.size(), 11u);
+    for (size_t i = 0; i + 1 < chunks.size(); ++i) {
+        EXPECT_EQ(chunks[i].size(), 100u);
+    }
+    expect_chunks_cover(text, chunks, 100, 10);
+}
+
+TEST(ChunkTextTest, PrefersSentenceThenWordBoundaries) {
+    std::string text = sentences(40);
+    auto chunks = RetrievalFunctions::chunk_text(text, 200, 20);
+    ASSERT_GT(chunks.size(), 1u);
+    for (size_t i = 0; i + 1 < chunks.size(); ++i) {
+        EXPECT_EQ(chunks[i].back(), '.') << chunks[i];
+    }
+    expect_chunks_cover(text, chunks, 200, 20);
+
+    std::string words;
+    for (int i = 0; i < 200; ++i) {
+        words += "word" + std::to_string(i) + " ";
+    }
+    chunks = RetrievalFunctions::chunk_text(words, 100, 15);
+    for (size_t i = 0; i + 1 < chunks.size(); ++i) {
+        // The chunk stops just before a space, so no word is cut in two
+        size_t start = words.find(chunks[i]);
+        ASSERT_NE(start, std::string::npos);
+        EXPECT_EQ(words[start + chunks[i].size()], ' ') << chunks[i];
+    }
+    expect_chunks_cover(words, chunks, 100, 15);
+}
+
+TEST(ChunkTextTest, SentenceEndJustPastTheChunkSizeIsNotIncluded) {
+    // The full stop is character chunk_size + 1, so the chunk breaks at a word
+    std::string text = std::string(60, 'a') + " " + std::string(39, 'b') + ". " + std::string(100, 'c');
+    auto chunks = RetrievalFunctions::chunk_text(text, 100, 0);
+    ASSERT_GT(chunks.size(), 1u);
+    EXPECT_EQ(chunks[0], std::string(60, 'a'));
+    expect_chunks_cover(text, chunks, 100, 0);
+}
+
+TEST(ChunkTextTest, OverlapAsLargeAsTheChunkStillAdvances) {
+    std::string text(500, 'x');
+    auto chunks = RetrievalFunctions::chunk_text(text, 100, 100);
+    EXPECT_EQ(chunks.size(), 5u);
+    chunks = RetrievalFunctions::chunk_text(text, 100, 250);
+    EXPECT_EQ(chunks.size(), 5u);
+    chunks = RetrievalFunctions::chunk_text(text, 100, -5);
+    expect_chunks_cover(text, chunks, 100, 0);
+}
+
+TEST_F(DocumentIngestionTest, EmbeddingCallsAreFilledUpToTheBatchSize) {
+    start();
+    auto documents = short_documents("doc-", 45);
+    auto ids = manager_.batch_add_documents(documents);
+
+    ASSERT_EQ(ids.size(), documents.size());
+    for (size_t i = 0; i < ids.size(); ++i) {
+        EXPECT_EQ(ids[i], documents[i].id);
+    }
+    // Five full batches of 8 and one of the remaining 5
+    std::vector<size_t> sizes;
+    for (const auto& call : calls_) {
+        sizes.push_back(call.size());
+    }
+    std::sort(sizes.begin(), sizes.end());
+    EXPECT_EQ(sizes, (std::vector<size_t>{5, 8, 8, 8, 8, 8}));
+    EXPECT_EQ(manager_.get_stats().total_documents, documents.size());
+    auto hits = search_for(documents[17].content);
+    ASSERT_EQ(hits.size(), 1u);
+    EXPECT_EQ(hits[0].document.id, "doc-17");
+}
+
+TEST_F(DocumentIngestionTest, LongDocumentsAreStoredAsChunksOfTheirParent) {
+    start();
+    Document long_document("long", sentences(40), "test");
+    long_document.metadata["author"] = "tester";
+    std::vector<Document> documents = {Document("before", "A short one", "test"), long_document,
+                                       Document("", "No id given", "test")};
+    auto ids = manager_.batch_add_documents(documents);
+
+    ASSERT_EQ(ids.size(), 3u);
+    EXPECT_EQ(ids[0], "before");
+    EXPECT_EQ(ids[1], "long");
+    EXPECT_FALSE(ids[2].empty());
+    ASSERT_TRUE(manager_.get_document(ids[2]).has_value());
+    EXPECT_EQ(manager_.get_document(ids[2])->content, "No id given");
+
+    // Every chunk was embedded, spread over batches of at most 8
+    auto pieces = RetrievalFunctions::chunk_text(long_document.content, config_.chunk_size, config_.chunk_overlap);
+    ASSERT_GT(pieces.size(), config_.embedding_batch_size);
+    std::vector<std::string> embedded;
+    for (const auto& call : calls_) {
+        EXPECT_LE(call.size(), config_.embedding_batch_size);
+        embedded.insert(embedded.end(), call.begin(), call.end());
+    }
+    EXPECT_EQ(embedded.size(), pieces.size() + 2);
+    for (const auto& piece : pieces) {
+        EXPECT_EQ(std::count(embedded.begin(), embedded.end(), piece), 1) << piece;
+    }
+
+    // The parent is cached whole; its chunks are searchable under their own ids
+    EXPECT_EQ(manager_.get_document("long")->content, long_document.content);
+    for (size_t c = 0; c < pieces.size(); ++c) {
+        auto hits = search_for(pieces[c]);
+        ASSERT_EQ(hits.size(), 1u) << c;
+        EXPECT_EQ(hits[0].document.id, "long#" + std::to_string(c));
+        EXPECT_EQ(hits[0].document.metadata["parent_id"], "long");
+        EXPECT_EQ(hits[0].document.metadata["chunk_index"], std::to_string(c));
+        EXPECT_EQ(hits[0].document.metadata["author"], "tester");
+    }
+}
+
+TEST_F(DocumentIngestionTest, AFailedBatchFailsOnlyItsDocuments) {
+    before_embedding_ = [](const std::vector<std::string>& texts) {
+        for (const auto& text : texts) {
+            if (text.find("poison") != std::string::npos) {
+                throw std::runtime_error("embedding service unavailable");
+            }
+        }
+    };
+    start();
+    // Batches of 8: documents 8-15 share a batch with the poisoned one
+    auto documents = short_documents("doc-", 24);
+    documents[10].content = "poison";
+    auto ids = manager_.batch_add_documents(documents);
+
+    for (size_t i = 0; i < documents.size(); ++i) {
+        bool in_failed_batch = i >= 8 && i < 16;
+        EXPECT_EQ(ids[i].empty(), in_failed_batch) << i;
+        EXPECT_EQ(manager_.get_document(documents[i].id).has_value(), !in_failed_batch) << i;
+    }
+    EXPECT_EQ(manager_.get_stats().total_documents, 16u);
+}
+
+TEST_F(DocumentIngestionTest, ADocumentFailsIfAnyOfItsChunksFails) {
+    std::string poisoned_chunk;
+    before_embedding_ = [&poisoned_chunk](const std::vector<std::string>& texts) {
+        if (std::find(texts.begin(), texts.end(), poisoned_chunk) != texts.end()) {
+            throw std::runtime_error("embedding service unavailable");
+        }
+    };
+    start();
+    Document long_document("long", sentences(40), "test");
+    auto pieces = RetrievalFunctions::chunk_text(long_document.content, config_.chunk_size, config_.chunk_overlap);
+    ASSERT_GT(pieces.size(), config_.embedding_batch_size);
+    poisoned_chunk = pieces.back();  // Lands in a later batch than the first chunks
+
+    std::vector<Document> documents = {long_document};
+    auto after = short_documents("after-", config_.embedding_batch_size);
+    documents.insert(documents.end(), after.begin(), after.end());
+    auto ids = manager_.batch_add_documents(documents);
+
+    EXPECT_TRUE(ids[0].empty());
+    EXPECT_FALSE(manager_.get_document("long").has_value());
+    // The chunks stored before the failure were removed again
+    for (size_t c = 0; c + 1 < pieces.size(); ++c) {
+        EXPECT_TRUE(search_for(pieces[c]).empty()) << c;
+    }
+    EXPECT_FALSE(manager_.delete_document("long"));
+    // Documents sharing the last chunk's batch fail with it; the rest are stored
+    const size_t batch_size = config_.embedding_batch_size;
+    const size_t failed_batch = (pieces.size() - 1) / batch_size;
+    for (size_t i = 0; i < after.size(); ++i) {
+        bool shares_batch = (pieces.size() + i) / batch_size == failed_batch;
+        EXPECT_EQ(ids[i + 1].empty(), shares_batch) << after[i].id;
+    }
+    EXPECT_FALSE(ids.back().empty());
+}
+
+TEST_F(DocumentIngestionTest, DeletingAChunkedDocumentRemovesItsChunks) {
+    start();
+    Document long_document("long", sentences(40), "test");
+    auto pieces = RetrievalFunctions::chunk_text(long_document.content, config_.chunk_size, config_.chunk_overlap);
+    ASSERT_GT(pieces.size(), 1u);
+    auto ids = manager_.batch_add_documents({long_document, Document("short", "A short one", "test")});
+    ASSERT_EQ(ids, (std::vector<std::string>{"long", "short"}));
+    ASSERT_EQ(search_for(pieces.front()).size(), 1u);
+
+    EXPECT_TRUE(manager_.delete_document("long"));
+    EXPECT_FALSE(manager_.get_document("long").has_value());
+    for (size_t c = 0; c < pieces.size(); ++c) {
+        EXPECT_TRUE(search_for(pieces[c]).empty()) << c;
+    }
+    EXPECT_FALSE(manager_.delete_document("long"));
+
+    // Unchunked documents are deleted as before
+    EXPECT_TRUE(manager_.delete_document("short"));
+    EXPECT_TRUE(search_for("A short one").empty());
+}
+
+TEST_F(DocumentIngestionTest, RejectedEmbeddingsFailTheirDocuments) {
+    start();
+    manager_.set_embedding_function([](const std::vector<std::string>& texts) {
+        std::vector<std::vector<float>> embeddings;
+        for (const auto& text : texts) {
+            // A wrong dimension is rejected by the store, one chunk at a time
+            embeddings.push_back(text.find("doc-3") != std::string::npos ? std::vector<float>(DIMENSION + 1, 1.0f)
+                                                                          : embed(text));
+        }
+        if (texts.front().find("doc-8") != std::string::npos) {
+            embeddings.pop_back();  // Too few embeddings fail the whole batch
+        }
+        return embeddings;
+    });
+    auto ids = manager_.batch_add_documents(short_documents("doc-", 12));
+
+    for (size_t i = 0; i < ids.size(); ++i) {
+        bool failed = i == 3 || i >= 8;
+        EXPECT_EQ(ids[i].empty(), failed) << i;
+    }
+}
+
+TEST_F(DocumentIngestionTest, EmbeddingCallsAreBoundedByIngestThreads) {
+    std::atomic<int> running{0}, most{0};
+    before_embedding_ = [&](const std::vector<std::string>&) {
+        int now = ++running;
+        int seen = most.load();
+        while (now > seen && !most.compare_exchange_weak(seen, now)) {
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        --running;
+    };
+    start();
+    auto ids = manager_.batch_add_documents(short_documents("doc-", 200));
+
+    EXPECT_EQ(std::count(ids.begin(), ids.end(), ""), 0);
+    EXPECT_EQ(calls_.size(), 25u);
+    EXPECT_LE(most.load(), static_cast<int>(config_.ingest_threads));
+    EXPECT_GE(most.load(), 1);
+}
+
+TEST_F(DocumentIngestionTest, ARepeatedIdKeepsTheLaterDocument) {
+    start();
+    auto documents = short_documents("doc-", 20);
+    documents[2].id = "same";
+    documents[2].content = "Earlier version";
+    documents[17].id = "same";
+    documents[17].content = "Later version";
+    auto ids = manager_.batch_add_documents(documents);
+
+    EXPECT_EQ(ids[2], "same");
+    EXPECT_EQ(ids[17], "same");
+    EXPECT_EQ(manager_.get_document("same")->content, "Later version");
+    EXPECT_EQ(manager_.get_stats().total_documents, 19u);
+}
+
+TEST_F(DocumentIngestionTest, NothingIsStoredBeforeInitialize) {
+    RetrievalManager uninitialized;
+    auto ids = uninitialized.batch_add_documents(short_documents("doc-", 3));
+    EXPECT_EQ(ids, std::vector<std::string>(3));
+    EXPECT_TRUE(RetrievalManager().batch_add_documents({}).empty());
+}
@@ -0,0 +1,235 @@
+#include <gtest/gtest.h>
+#include "execution_journal.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+class ExecutionJournalTest : public ::testing::Test {
+protected:
+    std::filesystem::path directory_;
+
+    void SetUp() override {
+        directory_ = std::filesystem::temp_directory_path() /
+                     ("execution_journal_test_" + std::to_string(std::random_device{}()));
+        std::filesystem::create_directories(directory_);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(directory_);
+    }
+
+    ExecutionJournal::Config config() const {
+        ExecutionJournal::Config config;
+        config.path = (directory_ / "journal" / "executions.jsonl").string();
+        config.flush_interval_ms = 5;
+        return config;
+    }
+
+    std::vector<json> read_records() const {
+        std::vector<json> records;
+        std::ifstream input(config().path);
+        std::string line;
+        while (std::getline(input, line)) {
+            if (!line.empty()) {
+                records.push_back(json::parse(line));
+            }
+        }
+        return records;
+    }
+
+    void append_raw(const std::string& text) const {
+        std::filesystem::create_directories(std::filesystem::path(config().path).parent_path());
+        std::ofstream output(config().path, std::ios::binary | std::ios::app);
+        output << text;
+    }
+};
+
+}  // namespace
+
+TEST_F(ExecutionJournalTest, EmptyJournalRecoversNothing) {
+    ExecutionJournal journal(config());
+    EXPECT_TRUE(journal.open().empty());
+    EXPECT_TRUE(journal.is_open());
+    EXPECT_TRUE(std::filesystem::exists(config().path));
+    EXPECT_THROW(journal.open(), std::runtime_error);
+}
+
+TEST_F(ExecutionJournalTest, RecoversUnfinishedExecutionsWithCompletedSteps) {
+    {
+        ExecutionJournal journal(config());
+        journal.open();
+        journal.record_execution_started("e1", "research", json{{"query", "q"}}, "tenant-a", 3, 1700000000000);
+        journal.record_step_completed("e1", "search", json{{"results", json::array({1, 2, 3})}});
+        journal.record_execution_started("e2", "summary", json::object(), "", 0, 1700000000500);
+        journal.record_step_completed("e2", "summarize", "done");
+        journal.record_execution_finished("e2", 2);
+        journal.record_step_completed("e1", "analyze", "text output");
+        journal.record_execution_started("e3", "summary", json::object(), "", 0, 1700000001000);
+        journal.close();  // Flushes what is pending
+    }
+
+    // A restart: a new journal over the same file
+    ExecutionJournal journal(config());
+    auto recovered = journal.open();
+    ASSERT_EQ(recovered.size(), 2u);
+
+    const auto& first = recovered[0];
+    EXPECT_EQ(first.execution_id, "e1");
+    EXPECT_EQ(first.workflow_id, "research");
+    EXPECT_EQ(first.input_data, (json{{"query", "q"}}));
+    EXPECT_EQ(first.tenant_id, "tenant-a");
+    EXPECT_EQ(first.priority, 3);
+    EXPECT_EQ(first.start_time_ms, 1700000000000);
+    EXPECT_EQ(first.step_order, (std::vector<std::string>{"search", "analyze"}));
+    EXPECT_EQ(first.step_outputs.at("search"), (json{{"results", json::array({1, 2, 3})}}));
+    EXPECT_EQ(first.step_outputs.at("analyze"), "text output");
+
+    // Started but no step completed yet
+    EXPECT_EQ(recovered[1].execution_id, "e3");
+    EXPECT_TRUE(recovered[1].step_outputs.empty());
+}
+
+TEST_F(ExecutionJournalTest, CompactsTheFileToUnfinishedExecutions) {
+    {
+        ExecutionJournal journal(config());
+        journal.open();
+        for (int i = 0; i < 10; ++i) {
+            std::string id = "done-" + std::to_string(i);
+            journal.record_execution_started(id, "wf", json::object(), "", 0, 0);
+            journal.record_step_completed(id, "step", i);
+            journal.record_execution_finished(id, 2);
+        }
+        journal.record_execution_started("live", "wf", json::object(), "", 0, 0);
+        journal.record_step_completed("live", "step", "kept");
+    }
+    EXPECT_EQ(read_records().size(), 32u);
+
+    {
+        ExecutionJournal journal(config());
+        EXPECT_EQ(journal.open().size(), 1u);
+    }
+    auto records = read_records();
+    ASSERT_EQ(records.size(), 2u);
+    for (const auto& record : records) {
+        EXPECT_EQ(record["execution_id"], "live");
+    }
+
+    // Compaction keeps everything a later recovery needs
+    ExecutionJournal journal(config());
+    auto recovered = journal.open();
+    ASSERT_EQ(recovered.size(), 1u);
+    EXPECT_EQ(recovered[0].step_outputs.at("step"), "kept");
+}
+
+TEST_F(ExecutionJournalTest, IgnoresATornRecordAtTheEnd) {
+    {
+        ExecutionJournal journal(config());
+        journal.open();
+        journal.record_execution_started("e1", "wf", json::object(), "", 0, 0);
+        journal.record_step_completed("e1", "first", 1);
+    }
+    // The process died in the middle of writing the next record
+    append_raw("{\"record\":\"step_completed\",\"execution_id\":\"e1\",\"step_id\":\"sec");
+
+    ExecutionJournal journal(config());
+    auto recovered = journal.open();
+    ASSERT_EQ(recovered.size(), 1u);
+    EXPECT_EQ(recovered[0].step_order, (std::vector<std::string>{"first"}));
+
+    // New records are appended after the compacted, intact ones
+    journal.record_step_completed("e1", "second", 2);
+    journal.flush();
+    auto records = read_records();
+    ASSERT_EQ(records.size(), 3u);
+    EXPECT_EQ(records.back()["step_id"], "second");
+}
+
+TEST_F(ExecutionJournalTest, SkipsDamagedAndUnknownRecords) {
+    append_raw("not json\n");
+    append_raw("{\"record\":\"execution_started\",\"execution_id\":\"e1\",\"workflow_id\":\"wf\"}\n");
+    append_raw("{\"record\":\"mystery\",\"execution_id\":\"e1\"}\n");
+    append_raw("[1,2,3]\n");
+    append_raw("{\"record\":\"step_completed\",\"execution_id\":\"unknown\",\"step_id\":\"s\",\"output\":1}\n");
+    append_raw("{\"record\":\"step_completed\",\"execution_id\":\"e1\",\"step_id\":\"s\",\"output\":1}\n");
+
+    ExecutionJournal journal(config());
+    auto recovered = journal.open();
+    ASSERT_EQ(recovered.size(), 1u);
+    EXPECT_EQ(recovered[0].workflow_id, "wf");
+    EXPECT_EQ(recovered[0].step_outputs.at("s"), 1);
+    EXPECT_EQ(read_records().size(), 2u);
+}
+
+TEST_F(ExecutionJournalTest, RepeatedStepKeepsItsPositionAndLatestOutput) {
+    {
+        ExecutionJournal journal(config());
+        journal.open();
+        journal.record_execution_started("e1", "wf", json::object(), "", 0, 0);
+        journal.record_step_completed("e1", "a", "first");
+        journal.record_step_completed("e1", "b", "b");
+        journal.record_step_completed("e1", "a", "retried");
+    }
+
+    ExecutionJournal journal(config());
+    auto recovered = journal.open();
+    ASSERT_EQ(recovered.size(), 1u);
+    EXPECT_EQ(recovered[0].step_order, (std::vector<std::string>{"a", "b"}));
+    EXPECT_EQ(recovered[0].step_outputs.at("a"), "retried");
+}
+
+TEST_F(ExecutionJournalTest, LoopIterationStartsAFreshSetOfFinishedSteps) {
+    {
+        ExecutionJournal journal(config());
+        journal.open();
+        journal.record_execution_started("e1", "loop", json::object(), "", 0, 0);
+        journal.record_loop_iteration("e1", 0);
+        journal.record_step_completed("e1", "a", "a0");
+        journal.record_step_completed("e1", "b", "b0");
+        journal.record_loop_iteration("e1", 1);
+        journal.record_step_completed("e1", "a", "a1");
+        journal.record_execution_started("e2", "plain", json::object(), "", 0, 0);
+        journal.record_step_completed("e2", "s", 1);
+    }
+
+    ExecutionJournal journal(config());
+    auto recovered = journal.open();
+    ASSERT_EQ(recovered.size(), 2u);
+    EXPECT_EQ(recovered[0].loop_iteration, 1);
+    EXPECT_EQ(recovered[0].iteration_steps, (std::vector<std::string>{"a"}));
+    // Outputs of earlier iterations are kept for the context
+    EXPECT_EQ(recovered[0].step_order, (std::vector<std::string>{"a", "b"}));
+    EXPECT_EQ(recovered[0].step_outputs.at("a"), "a1");
+    EXPECT_EQ(recovered[0].step_outputs.at("b"), "b0");
+
+    // Without loop records every completed step counts
+    EXPECT_EQ(recovered[1].loop_iteration, 0);
+    EXPECT_EQ(recovered[1].iteration_steps, (std::vector<std::string>{"s"}));
+
+    // Compaction keeps the loop records
+    journal.close();
+    ExecutionJournal reopened(config());
+    EXPECT_EQ(reopened.open()[0].loop_iteration, 1);
+}
+
+TEST_F(ExecutionJournalTest, FlushMakesRecordsDurableWithoutClosing) {
+    ExecutionJournal journal(config());
+    journal.open();
+    journal.record_execution_started("e1", "wf", json{{"n", 1}}, "", 0, 0);
+    journal.flush();
+
+    auto records = read_records();
+    ASSERT_EQ(records.size(), 1u);
+    EXPECT_EQ(records[0]["record"], "execution_started");
+    EXPECT_EQ(records[0]["input_data"], (json{{"n", 1}}));
+
+    // Records after close() are dropped, not written
+    journal.close();
+    EXPECT_FALSE(journal.is_open());
+    journal.record_execution_finished("e1", 2);
+    EXPECT_EQ(read_records().size(), 1u);
+}
@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+#include "execution_queue.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+ExecutionQueue::Config config(ExecutionQueue::Ordering ordering, bool tenant_fairness) {
+    ExecutionQueue::Config config;
+    config.ordering = ordering;
+    config.tenant_fairness = tenant_fairness;
+    return config;
+}
+
+std::vector<std::string> drain(ExecutionQueue& queue) {
+    std::vector<std::string> order;
+    std::string id;
+    while (queue.pop(id)) {
+        order.push_back(id);
+    }
+    return order;
+}
+
+}  // namespace
+
+TEST(ExecutionQueueTest, FifoIgnoresPriorities) {
+    ExecutionQueue queue(config(ExecutionQueue::Ordering::FIFO, false));
+    EXPECT_TRUE(queue.push("low", "", -5));
+    EXPECT_TRUE(queue.push("high", "", 10));
+    EXPECT_TRUE(queue.push("normal", "", 0));
+
+    EXPECT_EQ(drain(queue), (std::vector<std::string>{"low", "high", "normal"}));
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(ExecutionQueueTest, HigherPrioritiesGoFirstInSubmissionOrder) {
+    ExecutionQueue queue(config(ExecutionQueue::Ordering::PRIORITY, false));
+    queue.push("normal-1", "", 0);
+    queue.push("low", "", -1);
+    queue.push("high-1", "", 5);
+    queue.push("normal-2", "", 0);
+    queue.push("high-2", "", 5);
+
+    EXPECT_EQ(queue.get_stats().priority_levels, 3u);
+    EXPECT_EQ(drain(queue), (std::vector<std::string>{"high-1", "high-2", "normal-1", "normal-2", "low"}));
+
+    // A higher priority arriving later still goes ahead of what is queued
+    queue.push("normal", "", 0);
+    queue.push("urgent", "", 1);
+    std::string id;
+    ASSERT_TRUE(queue.pop(id));
+    EXPECT_EQ(id, "urgent");
+}
+
+TEST(ExecutionQueueTest, TenantsTakeTurnsWithinAPriority) {
+    ExecutionQueue queue(config(ExecutionQueue::Ordering::PRIORITY, true));
+    for (int i = 0; i < 4; ++i) {
+        queue.push("busy-" + std::to_string(i), "busy");
+    }
+    queue.push("quiet-0", "quiet");
+    queue.push("other-0", "other");
+    queue.push("quiet-1", "quiet");
+
+    EXPECT_EQ(queue.get_stats().tenants, 3u);
+    // Each tenant's oldest execution in turn, in the order tenants first queued
+    EXPECT_EQ(drain(queue), (std::vector<std::string>{"busy-0", "quiet-0", "other-0", "busy-1", "quiet-1",
+                                                      "busy-2", "busy-3"}));
+
+    // Priority still comes before fairness
+    queue.push("busy-low", "busy", 0);
+    queue.push("quiet-high", "quiet", 1);
+    std::string id;
+    ASSERT_TRUE(queue.pop(id));
+    EXPECT_EQ(id, "quiet-high");
+}
+
+TEST(ExecutionQueueTest, WithoutFairnessTenantsShareOneQueue) {
+    ExecutionQueue queue(config(ExecutionQueue::Ordering::FIFO, false));
+    queue.push("a-0", "a");
+    queue.push("a-1", "a");
+    queue.push("b-0", "b");
+
+    EXPECT_EQ(drain(queue), (std::vector<std::string>{"a-0", "a-1", "b-0"}));
+}
+
+TEST(ExecutionQueueTest, ErasedExecutionsAreNotDispatched) {
+    ExecutionQueue queue(config(ExecutionQueue::Ordering::PRIORITY, true));
+    queue.push("a-0", "a");
+    queue.push("a-1", "a");
+    queue.push("b-0", "b");
+    queue.push("high", "c", 3);
+
+    EXPECT_FALSE(queue.push("a-1", "a"));
+    EXPECT_TRUE(queue.erase("a-1"));
+    EXPECT_FALSE(queue.erase("a-1"));
+    EXPECT_FALSE(queue.contains("a-1"));
+    // Erasing a tenant's or a level's last execution drops it
+    EXPECT_TRUE(queue.erase("b-0"));
+    EXPECT_TRUE(queue.erase("high"));
+
+    auto stats = queue.get_stats();
+    EXPECT_EQ(stats.queued, 1u);
+    EXPECT_EQ(stats.tenants, 1u);
+    EXPECT_EQ(stats.priority_levels, 1u);
+    EXPECT_EQ(stats.removed, 3u);
+    EXPECT_EQ(drain(queue), std::vector<std::string>{"a-0"});
+
+    // An erased id can be queued again
+    EXPECT_TRUE(queue.push("a-1", "a"));
+    EXPECT_TRUE(queue.contains("a-1"));
+    EXPECT_EQ(queue.get_stats().enqueued, 5u);
+}
+
+TEST(ExecutionQueueTest, SetConfigKeepsSubmissionOrder) {
+    ExecutionQueue queue(config(ExecutionQueue::Ordering::FIFO, false));
+    queue.push("a-low", "a", 0);
+    queue.push("a-high", "a", 2);
+    queue.push("b-low", "b", 0);
+    queue.push("a-low-2", "a", 0);
+    queue.push("b-high", "b", 2);
+
+    // Re-bucketed by priority and tenant, submission order within each
+    queue.set_config(config(ExecutionQueue::Ordering::PRIORITY, true));
+    EXPECT_EQ(queue.get_config().ordering, ExecutionQueue::Ordering::PRIORITY);
+    EXPECT_EQ(queue.size(), 5u);
+    std::string id;
+    ASSERT_TRUE(queue.pop(id));
+    EXPECT_EQ(id, "a-high");
+
+    // And back to one FIFO: the rest in the order they were submitted
+    queue.set_config(config(ExecutionQueue::Ordering::FIFO, false));
+    EXPECT_EQ(queue.get_stats().priority_levels, 1u);
+    EXPECT_EQ(drain(queue), (std::vector<std::string>{"a-low", "b-low", "a-low-2", "b-high"}));
+
+    auto stats = queue.get_stats();
+    EXPECT_EQ(stats.enqueued, 5u);
+    EXPECT_EQ(stats.dispatched, 5u);
+}
+
+TEST(ExecutionQueueTest, ParsesOrderingNames) {
+    EXPECT_EQ(ExecutionQueue::parse_ordering("fifo"), ExecutionQueue::Ordering::FIFO);
+    EXPECT_EQ(ExecutionQueue::parse_ordering("priority"), ExecutionQueue::Ordering::PRIORITY);
+    EXPECT_THROW(ExecutionQueue::parse_ordering("lifo"), std::invalid_argument);
+    EXPECT_EQ(ExecutionQueue::ordering_to_string(ExecutionQueue::Ordering::PRIORITY), "priority");
+}
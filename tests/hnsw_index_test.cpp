@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+#include "hnsw_index.hpp"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+using namespace kolosal;
+
+namespace {
+
+// Wide, overlapping clusters, so a narrow search does miss neighbours: with
+// seed 7, recall@10 measures 0.86 at ef_search 10, 0.99 at the default 64
+// and 1.0 at 200. The thresholds leave room for other compilers' rounding.
+constexpr size_t COUNT = 5000;
+constexpr size_t DIMENSION = 96;
+constexpr size_t CLUSTERS = 32;
+constexpr float SPREAD = 1.5f;
+constexpr size_t QUERIES = 100;
+constexpr size_t K = 10;
+constexpr double MIN_RECALL = 0.97;
+
+// Vectors scattered around cluster centres, as in benchmarks/hnsw_benchmark
+std::vector<std::vector<float>> make_corpus(size_t count, size_t dimension, size_t clusters, float spread,
+                                            std::mt19937& gen) {
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    std::vector<std::vector<float>> centres(clusters, std::vector<float>(dimension));
+    for (auto& centre : centres) {
+        for (auto& value : centre) {
+            value = dist(gen);
+        }
+    }
+    std::uniform_int_distribution<size_t> pick(0, clusters - 1);
+    std::vector<std::vector<float>> vectors(count, std::vector<float>(dimension));
+    for (auto& vector : vectors) {
+        const auto& centre = centres[pick(gen)];
+        for (size_t i = 0; i < dimension; ++i) {
+            vector[i] = centre[i] + spread * dist(gen);
+        }
+    }
+    return vectors;
+}
+
+class HnswIndexTest : public ::testing::Test {
+protected:
+    std::vector<std::string> ids_;
+    std::vector<std::vector<float>> corpus_;
+    std::vector<std::vector<float>> queries_;
+    FlatVectorIndex flat_{DIMENSION};
+
+    void SetUp() override {
+        std::mt19937 gen(7);
+        corpus_ = make_corpus(COUNT + QUERIES, DIMENSION, CLUSTERS, SPREAD, gen);
+        queries_.assign(corpus_.end() - QUERIES, corpus_.end());
+        corpus_.resize(COUNT);
+        for (size_t i = 0; i < COUNT; ++i) {
+            ids_.push_back("doc-" + std::to_string(i));
+        }
+        flat_.add_batch(ids_, corpus_, 1);
+    }
+
+    // Fraction of the exact top-k the index returns, over all queries
+    double recall(const IVectorIndex& index) const {
+        size_t found = 0;
+        for (const auto& query : queries_) {
+            std::unordered_set<std::string> truth;
+            for (const auto& hit : flat_.search(query, K, -1.0f)) {
+                truth.insert(hit.id);
+            }
+            for (const auto& hit : index.search(query, K, -1.0f)) {
+                found += truth.count(hit.id);
+            }
+        }
+        return static_cast<double>(found) / (QUERIES * K);
+    }
+};
+
+}  // namespace
+
+TEST_F(HnswIndexTest, RecallAgainstExactSearch) {
+    HnswIndex index(DIMENSION);
+    for (size_t i = 0; i < COUNT; ++i) {
+        ASSERT_TRUE(index.add(ids_[i], corpus_[i]));
+    }
+    EXPECT_EQ(index.size(), COUNT);
+
+    double default_recall = recall(index);
+    EXPECT_GE(default_recall, MIN_RECALL);
+
+    // A wider search finds more of the exact neighbours, a narrower one fewer
+    index.set_ef_search(200);
+    double wide_recall = recall(index);
+    EXPECT_GE(wide_recall, 0.99);
+    EXPECT_GE(wide_recall, default_recall);
+
+    index.set_ef_search(K);
+    EXPECT_LT(recall(index), default_recall);
+}
+
+TEST_F(HnswIndexTest, ParallelBuildKeepsRecall) {
+    HnswIndex index(DIMENSION);
+    auto added = index.add_batch(ids_, corpus_, 4);
+    EXPECT_EQ(std::count(added.begin(), added.end(), true), static_cast<long>(COUNT));
+    EXPECT_EQ(index.size(), COUNT);
+    EXPECT_GE(recall(index), MIN_RECALL);
+}
+
+TEST_F(HnswIndexTest, ScoresMatchExactSearch) {
+    HnswIndex index(DIMENSION);
+    index.add_batch(ids_, corpus_, 1);
+    for (const auto& query : queries_) {
+        auto hits = index.search(query, K, -1.0f);
+        ASSERT_EQ(hits.size(), K);
+        for (size_t i = 1; i < hits.size(); ++i) {
+            EXPECT_GE(hits[i - 1].score, hits[i].score);
+        }
+        // Same vectors, same kernel: a shared hit has the exact score
+        auto exact = flat_.search(query, 1, -1.0f).front();
+        if (hits.front().id == exact.id) {
+            EXPECT_FLOAT_EQ(hits.front().score, exact.score);
+        }
+    }
+}
+
+TEST_F(HnswIndexTest, RemovedVectorsAreNeverReturned) {
+    HnswIndex index(DIMENSION);
+    index.add_batch(ids_, corpus_, 1);
+
+    // Remove the exact nearest neighbour of every query
+    std::unordered_set<std::string> removed;
+    for (const auto& query : queries_) {
+        std::string nearest = flat_.search(query, 1, -1.0f).front().id;
+        if (removed.insert(nearest).second) {
+            EXPECT_TRUE(index.remove(nearest));
+            flat_.remove(nearest);
+        }
+    }
+    EXPECT_FALSE(index.remove(*removed.begin()));
+    EXPECT_EQ(index.size(), COUNT - removed.size());
+    EXPECT_EQ(index.tombstones(), removed.size());
+
+    for (const auto& query : queries_) {
+        for (const auto& hit : index.search(query, K, -1.0f)) {
+            EXPECT_EQ(removed.count(hit.id), 0u) << hit.id;
+        }
+    }
+    EXPECT_GE(recall(index), MIN_RECALL);
+}
+
+TEST_F(HnswIndexTest, RebuildsOnceTombstonesOutnumberLiveNodes) {
+    HnswIndex index(DIMENSION);
+    index.add_batch(ids_, corpus_, 1);
+    for (size_t i = 0; i < COUNT * 3 / 4; ++i) {
+        index.remove(ids_[i]);
+        flat_.remove(ids_[i]);
+    }
+    EXPECT_EQ(index.size(), COUNT / 4);
+    EXPECT_LT(index.tombstones(), index.size());
+    EXPECT_GE(recall(index), MIN_RECALL);
+}
+
+TEST_F(HnswIndexTest, ReAddingAnIdReplacesItsVector) {
+    HnswIndex index(DIMENSION);
+    index.add_batch(ids_, corpus_, 1);
+
+    // doc-0 takes the place of the first query's exact match
+    ASSERT_TRUE(index.add("doc-0", queries_[0]));
+    EXPECT_EQ(index.size(), COUNT);
+    EXPECT_EQ(index.tombstones(), 1u);
+    auto hits = index.search(queries_[0], 1, -1.0f);
+    ASSERT_EQ(hits.size(), 1u);
+    EXPECT_EQ(hits[0].id, "doc-0");
+    EXPECT_NEAR(hits[0].score, 1.0f, 1e-5);
+}
+
+TEST_F(HnswIndexTest, RejectsWrongDimensionsAndHonoursThreshold) {
+    HnswIndex index(DIMENSION);
+    EXPECT_TRUE(index.search(queries_[0], K, -1.0f).empty());  // Empty index
+    index.add_batch(ids_, corpus_, 1);
+
+    EXPECT_FALSE(index.add("short", std::vector<float>(DIMENSION - 1, 1.0f)));
+    EXPECT_TRUE(index.search(std::vector<float>(DIMENSION + 1, 1.0f), K, -1.0f).empty());
+    EXPECT_TRUE(index.search(queries_[0], 0, -1.0f).empty());
+
+    float threshold = flat_.search(queries_[0], 3, -1.0f).back().score;
+    for (const auto& hit : index.search(queries_[0], K, threshold)) {
+        EXPECT_GE(hit.score, threshold);
+    }
+}
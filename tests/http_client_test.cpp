@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+#include "cancellation_token.hpp"
+#include "http_client.hpp"
+#include "loopback_server.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+long elapsed_ms(Clock::time_point since) {
+    return static_cast<long>(std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - since).count());
+}
+
+// HttpClient against a stub server that answers every request with its path.
+// Paths under /slow/ are answered after 200 ms, /hang after 10 s.
+class HttpClientTest : public ::testing::Test {
+protected:
+    std::unique_ptr<LoopbackServer> server_;
+
+    void SetUp() override {
+        server_ = std::make_unique<LoopbackServer>([](const LoopbackServer::Request& request) {
+            LoopbackServer::Response response;
+            response.body = request.path;
+            response.content_type = "text/plain";
+            if (request.path.rfind("/slow/", 0) == 0) {
+                response.delay_ms = 200;
+            } else if (request.path == "/hang") {
+                response.delay_ms = 10000;
+            }
+            return response;
+        });
+    }
+
+    HttpClient::Config client_config() const {
+        HttpClient::Config config;
+        config.base_url = server_->url();
+        config.timeout_seconds = 30;
+        config.max_retries = 0;
+        return config;
+    }
+};
+
+}  // namespace
+
+TEST_F(HttpClientTest, SequentialRequestsReuseOneHandleAndConnection) {
+    HttpClient client(client_config());
+    for (int i = 0; i < 5; ++i) {
+        std::string path = "/fast/" + std::to_string(i);
+        HttpClient::Result result = client.request("GET", path);
+        EXPECT_EQ(result.status_code, 200);
+        EXPECT_EQ(result.body, path);
+    }
+
+    HttpClient::Stats stats = client.get_stats();
+    EXPECT_EQ(stats.handles_created, 1u);
+    EXPECT_EQ(stats.handles_reused, 4u);
+    EXPECT_EQ(stats.idle_handles, 1u);
+    // The pooled handle kept its connection open between requests
+    EXPECT_EQ(server_->connections(), 1u);
+}
+
+TEST_F(HttpClientTest, ConcurrentCallersGetTheirOwnHandles) {
+    HttpClient::Config config = client_config();
+    config.max_pooled_handles = 2;
+    HttpClient client(config);
+
+    std::vector<std::string> bodies(4);
+    std::vector<std::thread> callers;
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        callers.emplace_back([&, i] {
+            bodies[i] = client.request("GET", "/slow/" + std::to_string(i)).body;
+        });
+    }
+    for (auto& caller : callers) {
+        caller.join();
+    }
+
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        EXPECT_EQ(bodies[i], "/slow/" + std::to_string(i));
+    }
+    HttpClient::Stats stats = client.get_stats();
+    EXPECT_EQ(stats.handles_created + stats.handles_reused, 4u);
+    // Handles beyond the pool limit are destroyed on release
+    EXPECT_EQ(stats.idle_handles, 2u);
+}
+
+TEST_F(HttpClientTest, AsyncRequestsCompleteConcurrently) {
+    HttpClient client(client_config());
+
+    auto start = Clock::now();
+    std::vector<std::future<HttpClient::Result>> futures;
+    for (int i = 0; i < 4; ++i) {
+        futures.push_back(client.request_async("GET", "/slow/" + std::to_string(i)));
+    }
+    for (size_t i = 0; i < futures.size(); ++i) {
+        ASSERT_EQ(futures[i].wait_for(std::chrono::seconds(10)), std::future_status::ready);
+        HttpClient::Result result = futures[i].get();
+        EXPECT_EQ(result.status_code, 200);
+        // Each caller gets the response to its own request
+        EXPECT_EQ(result.body, "/slow/" + std::to_string(i));
+    }
+    // Multiplexed on the engine thread rather than one after another
+    EXPECT_LT(elapsed_ms(start), 700);
+
+    HttpClient::Stats stats = client.get_stats();
+    EXPECT_EQ(stats.async_in_flight, 0u);
+    EXPECT_EQ(stats.async_queued, 0u);
+}
+
+TEST_F(HttpClientTest, AsyncRequestsBeyondTheInFlightLimitQueue) {
+    HttpClient::Config config = client_config();
+    config.max_async_in_flight = 1;
+    HttpClient client(config);
+
+    auto start = Clock::now();
+    std::vector<std::future<HttpClient::Result>> futures;
+    for (int i = 0; i < 3; ++i) {
+        futures.push_back(client.request_async("GET", "/slow/" + std::to_string(i)));
+    }
+    for (auto& future : futures) {
+        EXPECT_EQ(future.get().status_code, 200);
+    }
+    EXPECT_GE(elapsed_ms(start), 550);
+    // One transfer at a time, each on the handle the previous one released
+    EXPECT_EQ(client.get_stats().handles_created, 1u);
+}
+
+TEST_F(HttpClientTest, AsyncCallbackFiresOnce) {
+    HttpClient client(client_config());
+
+    std::atomic<int> calls{0};
+    std::promise<long> status;
+    client.request_async("GET", "/fast/callback", "", {}, [&](HttpClient::Result result) {
+        if (calls++ == 0) {
+            status.set_value(result.status_code);
+        }
+    });
+    std::future<long> delivered = status.get_future();
+    ASSERT_EQ(delivered.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+    EXPECT_EQ(delivered.get(), 200);
+
+    // Another transfer through the engine; the first callback is not repeated
+    EXPECT_EQ(client.request_async("GET", "/fast/after").get().status_code, 200);
+    EXPECT_EQ(calls.load(), 1);
+}
+
+TEST_F(HttpClientTest, CancelledAsyncTransferLeavesOthersRunning) {
+    HttpClient client(client_config());
+
+    auto token = std::make_shared<CancellationToken>();
+    std::future<HttpClient::Result> cancelled;
+    {
+        // The transfer keeps the submitting thread's token
+        CancellationToken::Scope scope(token);
+        cancelled = client.request_async("GET", "/hang");
+    }
+    std::future<HttpClient::Result> untouched = client.request_async("GET", "/slow/untouched");
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    auto start = Clock::now();
+    token->cancel();
+    ASSERT_EQ(cancelled.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    EXPECT_LT(elapsed_ms(start), 2500);
+
+    HttpClient::Result result = cancelled.get();
+    EXPECT_TRUE(result.cancelled);
+    EXPECT_EQ(result.status_code, 499);
+    EXPECT_TRUE(token->interrupted());
+
+    HttpClient::Result other = untouched.get();
+    EXPECT_EQ(other.status_code, 200);
+    EXPECT_EQ(other.body, "/slow/untouched");
+    EXPECT_FALSE(other.cancelled);
+}
@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+#include "http_reactor.hpp"
+#include "loopback_client.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+long elapsed_ms(Clock::time_point since) {
+    return static_cast<long>(std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - since).count());
+}
+
+// A reactor on a loopback socket whose handler answers every request with
+// its path. "/slow" waits before answering. The handler records whether it
+// was allowed to keep each connection alive.
+class HttpReactorTest : public ::testing::Test {
+protected:
+    int listen_fd_ = -1;
+    int port_ = 0;
+    std::unique_ptr<HttpReactor> reactor_;
+    std::atomic<int> handled_{0};
+    std::atomic<int> last_requests_{0};  // Requests handled with allow_keep_alive false
+
+    void SetUp() override {
+        listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(address);
+        ASSERT_EQ(bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+        ASSERT_EQ(listen(listen_fd_, 64), 0);
+        getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&address), &length);
+        port_ = ntohs(address.sin_port);
+    }
+
+    void TearDown() override {
+        if (reactor_) {
+            reactor_->stop();
+        }
+        close(listen_fd_);
+    }
+
+    void start(const HttpReactor::Config& config) {
+        reactor_ = std::make_unique<HttpReactor>(listen_fd_, config,
+            [this](int fd, const HttpRequest& request, bool allow_keep_alive) {
+                if (request.path == "/slow") {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                }
+                handled_++;
+                if (!allow_keep_alive) {
+                    last_requests_++;
+                }
+                std::string body(request.path);
+                std::string response = "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\n"
+                                       "Content-Length: " + std::to_string(body.size()) + "\r\n" +
+                                       (allow_keep_alive ? "Connection: keep-alive\r\n" : "Connection: close\r\n") +
+                                       "\r\n" + body;
+                send(fd, response.data(), response.size(), MSG_NOSIGNAL);
+                return allow_keep_alive;
+            });
+        ASSERT_TRUE(reactor_->start());
+    }
+
+    // Polls until the reactor has done its bookkeeping for what the client saw
+    template <typename Predicate>
+    static bool eventually(Predicate done) {
+        auto deadline = Clock::now() + std::chrono::seconds(5);
+        while (Clock::now() < deadline) {
+            if (done()) {
+                return true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return false;
+    }
+
+    bool wait_for_connections(size_t connections) {
+        return eventually([&] { return reactor_->active_connections() == connections; });
+    }
+};
+
+}  // namespace
+
+TEST_F(HttpReactorTest, PipelinedRequestsAreAnsweredInOrder) {
+    start(HttpReactor::Config{});
+
+    LoopbackClient client(port_);
+    ASSERT_TRUE(client.send(LoopbackClient::get("/slow") + LoopbackClient::get("/a") + LoopbackClient::get("/b")));
+
+    for (const char* path : {"/slow", "/a", "/b"}) {
+        LoopbackClient::Response response = client.read_response();
+        EXPECT_EQ(response.status, 200);
+        EXPECT_EQ(response.body, path);
+        EXPECT_TRUE(response.has_header("Connection: keep-alive")) << path;
+    }
+
+    // The connection went back to its I/O thread and serves the next request
+    ASSERT_TRUE(client.send(LoopbackClient::get("/c")));
+    EXPECT_EQ(client.read_response().body, "/c");
+    EXPECT_EQ(handled_.load(), 4);
+}
+
+TEST_F(HttpReactorTest, LastAllowedRequestClosesTheConnection) {
+    HttpReactor::Config config;
+    config.max_requests_per_connection = 3;
+    start(config);
+
+    LoopbackClient client(port_);
+    for (const char* path : {"/1", "/2"}) {
+        ASSERT_TRUE(client.send(LoopbackClient::get(path)));
+        LoopbackClient::Response response = client.read_response();
+        EXPECT_EQ(response.body, path);
+        EXPECT_TRUE(response.has_header("Connection: keep-alive")) << path;
+    }
+    EXPECT_EQ(last_requests_.load(), 0);
+
+    // A request pipelined behind the last allowed one is never answered
+    ASSERT_TRUE(client.send(LoopbackClient::get("/3") + LoopbackClient::get("/4")));
+    LoopbackClient::Response last = client.read_response();
+    EXPECT_EQ(last.body, "/3");
+    EXPECT_TRUE(last.has_header("Connection: close"));
+    EXPECT_TRUE(client.read_until_closed());
+    EXPECT_TRUE(client.received().empty());
+    EXPECT_EQ(last_requests_.load(), 1);
+    EXPECT_EQ(handled_.load(), 3);
+    EXPECT_TRUE(wait_for_connections(0));
+}
+
+TEST_F(HttpReactorTest, IdleConnectionsAreClosed) {
+    HttpReactor::Config config;
+    config.idle_timeout_ms = 200;
+    start(config);
+
+    LoopbackClient used(port_);
+    ASSERT_TRUE(used.send(LoopbackClient::get("/a")));
+    EXPECT_EQ(used.read_response().body, "/a");
+    LoopbackClient unused(port_);
+    EXPECT_TRUE(wait_for_connections(2));
+
+    auto start = Clock::now();
+    EXPECT_TRUE(used.read_until_closed());
+    EXPECT_TRUE(unused.read_until_closed());
+    EXPECT_GE(elapsed_ms(start), 100);
+    EXPECT_LT(elapsed_ms(start), 2000);
+    EXPECT_TRUE(wait_for_connections(0));
+}
+
+TEST_F(HttpReactorTest, ConnectionsBeyondTheCapGet503) {
+    HttpReactor::Config config;
+    config.max_connections = 2;
+    start(config);
+
+    std::vector<std::unique_ptr<LoopbackClient>> accepted;
+    for (int i = 0; i < 2; ++i) {
+        accepted.push_back(std::make_unique<LoopbackClient>(port_));
+        ASSERT_TRUE(accepted.back()->send(LoopbackClient::get("/a")));
+        EXPECT_EQ(accepted.back()->read_response().status, 200);
+    }
+
+    LoopbackClient rejected(port_);
+    LoopbackClient::Response response = rejected.read_response();
+    EXPECT_EQ(response.status, 503);
+    EXPECT_TRUE(response.has_header("Connection: close"));
+    EXPECT_TRUE(rejected.read_until_closed());
+    EXPECT_TRUE(eventually([&] { return reactor_->rejected_connections() == 1; }));
+
+    // Room frees up once an accepted client leaves
+    accepted.pop_back();
+    EXPECT_TRUE(wait_for_connections(1));
+    LoopbackClient admitted(port_);
+    ASSERT_TRUE(admitted.send(LoopbackClient::get("/b")));
+    EXPECT_EQ(admitted.read_response().body, "/b");
+    EXPECT_EQ(reactor_->rejected_connections(), 1u);
+}
@@ -0,0 +1,270 @@
+#include <gtest/gtest.h>
+#include "http_request_parser.hpp"
+
+#include <string>
+#include <vector>
+
+namespace {
+
+using Result = HttpRequestParser::Result;
+
+// Feeds the segments one after another, parsing after each append, the way
+// a connection does after every recv(). Returns the result of the last parse.
+Result feed(HttpRequestParser& parser, std::string& buffer, const std::vector<std::string>& segments) {
+    Result result = Result::INCOMPLETE;
+    for (const auto& segment : segments) {
+        buffer += segment;
+        result = parser.parse(buffer);
+    }
+    return result;
+}
+
+const std::string CHUNKED_REQUEST =
+    "POST /upload HTTP/1.1\r\n"
+    "Host: localhost\r\n"
+    "Transfer-Encoding: chunked\r\n"
+    "\r\n"
+    "4\r\nWiki\r\n"
+    "5;ext=1\r\npedia\r\n"
+    "E\r\n in\r\n\r\nchunks.\r\n"
+    "0\r\n"
+    "\r\n";
+const std::string CHUNKED_BODY = "Wikipedia in\r\n\r\nchunks.";
+
+}  // namespace
+
+TEST(HttpRequestParserTest, ParsesRequestLineHeadersAndQuery) {
+    HttpRequestParser parser;
+    std::string buffer =
+        "GET /agents/abc?verbose=1 HTTP/1.1\r\n"
+        "Host: localhost\r\n"
+        "X-Padded:   value \t\r\n"
+        "\r\n";
+
+    ASSERT_EQ(parser.parse(buffer), Result::COMPLETE);
+    const HttpRequest& request = parser.request();
+    EXPECT_EQ(request.method, "GET");
+    EXPECT_EQ(request.target, "/agents/abc?verbose=1");
+    EXPECT_EQ(request.path, "/agents/abc");
+    EXPECT_EQ(request.query, "verbose=1");
+    EXPECT_EQ(request.version, "HTTP/1.1");
+    EXPECT_EQ(request.header("host"), "localhost");
+    EXPECT_EQ(request.header("X-PADDED"), "value");
+    EXPECT_EQ(request.header("missing"), "");
+    EXPECT_TRUE(request.body.empty());
+    EXPECT_TRUE(request.keep_alive);
+}
+
+TEST(HttpRequestParserTest, KeepAliveFollowsVersionAndConnectionHeader) {
+    struct Case {
+        const char* name;
+        std::string request;
+        bool keep_alive;
+    };
+    const std::vector<Case> cases = {
+        {"http11 default", "GET / HTTP/1.1\r\n\r\n", true},
+        {"http10 default", "GET / HTTP/1.0\r\n\r\n", false},
+        {"http11 close", "GET / HTTP/1.1\r\nConnection: close\r\n\r\n", false},
+        {"http10 keep-alive", "GET / HTTP/1.0\r\nConnection: Keep-Alive\r\n\r\n", true},
+        {"token list", "GET / HTTP/1.1\r\nConnection: upgrade, close\r\n\r\n", false},
+    };
+
+    for (const auto& test : cases) {
+        SCOPED_TRACE(test.name);
+        HttpRequestParser parser;
+        std::string buffer = test.request;
+        ASSERT_EQ(parser.parse(buffer), Result::COMPLETE);
+        EXPECT_EQ(parser.request().keep_alive, test.keep_alive);
+    }
+}
+
+TEST(HttpRequestParserTest, PipelinedRequestsAreServedInOrder) {
+    HttpRequestParser parser;
+    std::string buffer =
+        "GET /status HTTP/1.1\r\n\r\n"
+        "POST /agents HTTP/1.1\r\nContent-Length: 11\r\n\r\n{\"a\":\"xyz\"}"
+        "\r\n"  // Stray CRLF between requests is tolerated
+        "DELETE /agents/1 HTTP/1.1\r\nConnection: close\r\n\r\n"
+        "GET /partial HT";
+
+    struct Expected {
+        const char* method;
+        const char* path;
+        const char* body;
+        bool keep_alive;
+    };
+    const std::vector<Expected> expected = {
+        {"GET", "/status", "", true},
+        {"POST", "/agents", "{\"a\":\"xyz\"}", true},
+        {"DELETE", "/agents/1", "", false},
+    };
+
+    for (const auto& next : expected) {
+        SCOPED_TRACE(next.path);
+        ASSERT_EQ(parser.parse(buffer), Result::COMPLETE);
+        EXPECT_EQ(parser.request().method, next.method);
+        EXPECT_EQ(parser.request().path, next.path);
+        EXPECT_EQ(parser.request().body, next.body);
+        EXPECT_EQ(parser.request().keep_alive, next.keep_alive);
+        parser.consume(buffer);
+    }
+
+    // The trailing partial request stays buffered until the rest arrives
+    EXPECT_EQ(parser.parse(buffer), Result::INCOMPLETE);
+    EXPECT_EQ(buffer, "GET /partial HT");
+    buffer += "TP/1.1\r\n\r\n";
+    ASSERT_EQ(parser.parse(buffer), Result::COMPLETE);
+    EXPECT_EQ(parser.request().path, "/partial");
+    parser.consume(buffer);
+    EXPECT_TRUE(buffer.empty());
+}
+
+TEST(HttpRequestParserTest, ContentLengthBodySplitAcrossReads) {
+    HttpRequestParser parser;
+    std::string buffer;
+    EXPECT_EQ(feed(parser, buffer, {"POST /agent/execute HTTP/1.1\r\nContent-Len", "gth: 10\r\n\r", "\n01234"}),
+              Result::INCOMPLETE);
+    EXPECT_EQ(feed(parser, buffer, {"56789"}), Result::COMPLETE);
+    EXPECT_EQ(parser.request().body, "0123456789");
+}
+
+TEST(HttpRequestParserTest, ChunkedBodyDecodesAtEverySplitPoint) {
+    // Splitting the message at every byte covers splits inside the size
+    // line, the chunk extension, the data, the CRLF after the data and the
+    // terminating empty line.
+    for (size_t split = 1; split < CHUNKED_REQUEST.size(); ++split) {
+        SCOPED_TRACE("split at " + std::to_string(split));
+        HttpRequestParser parser;
+        std::string buffer;
+        EXPECT_EQ(feed(parser, buffer, {CHUNKED_REQUEST.substr(0, split)}), Result::INCOMPLETE);
+        ASSERT_EQ(feed(parser, buffer, {CHUNKED_REQUEST.substr(split)}), Result::COMPLETE);
+        EXPECT_EQ(parser.request().body, CHUNKED_BODY);
+    }
+}
+
+TEST(HttpRequestParserTest, ChunkedBodyDecodesByteByByte) {
+    HttpRequestParser parser;
+    std::string buffer;
+    Result result = Result::INCOMPLETE;
+    for (size_t i = 0; i < CHUNKED_REQUEST.size(); ++i) {
+        ASSERT_EQ(result, Result::INCOMPLETE) << "completed early at byte " << i;
+        result = feed(parser, buffer, {CHUNKED_REQUEST.substr(i, 1)});
+    }
+    ASSERT_EQ(result, Result::COMPLETE);
+    EXPECT_EQ(parser.request().body, CHUNKED_BODY);
+    EXPECT_EQ(parser.request().header("transfer-encoding"), "chunked");
+}
+
+TEST(HttpRequestParserTest, ChunkedTrailersAreSkippedAndPipelinedRequestKept) {
+    HttpRequestParser parser;
+    std::string buffer;
+    EXPECT_EQ(feed(parser, buffer, {
+                  "POST /upload HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+                  "3\r\nabc\r\n0\r\n",
+                  "X-Checksum: 900150983cd24fb0\r\n",
+                  "X-Other: 1\r",
+              }),
+              Result::INCOMPLETE);
+    ASSERT_EQ(feed(parser, buffer, {"\n\r\nGET /next HTTP/1.1\r\n\r\n"}), Result::COMPLETE);
+    EXPECT_EQ(parser.request().body, "abc");
+    EXPECT_EQ(parser.request().header("x-checksum"), "");  // Trailers are not merged into headers
+
+    parser.consume(buffer);
+    ASSERT_EQ(parser.parse(buffer), Result::COMPLETE);
+    EXPECT_EQ(parser.request().path, "/next");
+}
+
+TEST(HttpRequestParserTest, ExpectContinueIsOwedOnceUntilTheBodyArrives) {
+    HttpRequestParser parser;
+    std::string buffer;
+    EXPECT_EQ(feed(parser, buffer, {"PUT /workflows/w1 HTTP/1.1\r\nExpect: 100-continue\r\nContent-Length: 4\r\n\r\n"}),
+              Result::INCOMPLETE);
+    EXPECT_TRUE(parser.take_continue());
+    EXPECT_FALSE(parser.take_continue());
+
+    EXPECT_EQ(feed(parser, buffer, {"da"}), Result::INCOMPLETE);
+    EXPECT_FALSE(parser.take_continue());
+    ASSERT_EQ(feed(parser, buffer, {"ta"}), Result::COMPLETE);
+    EXPECT_EQ(parser.request().body, "data");
+}
+
+TEST(HttpRequestParserTest, ExpectContinueIsNotOwedWhenNothingIsMissing) {
+    struct Case {
+        const char* name;
+        std::string request;
+    };
+    const std::vector<Case> cases = {
+        {"no body", "POST /a HTTP/1.1\r\nExpect: 100-continue\r\nContent-Length: 0\r\n\r\n"},
+        {"body already sent", "POST /a HTTP/1.1\r\nExpect: 100-continue\r\nContent-Length: 2\r\n\r\nok"},
+        {"other expectation", "POST /a HTTP/1.1\r\nExpect: something-else\r\nContent-Length: 2\r\n\r\n"},
+    };
+
+    for (const auto& test : cases) {
+        SCOPED_TRACE(test.name);
+        HttpRequestParser parser;
+        std::string buffer = test.request;
+        parser.parse(buffer);
+        EXPECT_FALSE(parser.take_continue());
+    }
+}
+
+TEST(HttpRequestParserTest, RejectsInvalidAndOversizedRequests) {
+    struct Case {
+        const char* name;
+        std::string request;
+        size_t max_request_size;
+        size_t max_header_size;
+        int status;
+    };
+    const size_t DEFAULT_REQUEST = HttpRequestParser::DEFAULT_MAX_REQUEST_SIZE;
+    const size_t DEFAULT_HEADER = HttpRequestParser::DEFAULT_MAX_HEADER_SIZE;
+    const std::vector<Case> cases = {
+        {"malformed request line", "GET/ HTTP/1.1\r\n\r\n", DEFAULT_REQUEST, DEFAULT_HEADER, 400},
+        {"not http", "GET / FTP/1.1\r\n\r\n", DEFAULT_REQUEST, DEFAULT_HEADER, 400},
+        {"unsupported version", "GET / HTTP/2.0\r\n\r\n", DEFAULT_REQUEST, DEFAULT_HEADER, 505},
+        {"header without colon", "GET / HTTP/1.1\r\nBroken\r\n\r\n", DEFAULT_REQUEST, DEFAULT_HEADER, 400},
+        {"space in header name", "GET / HTTP/1.1\r\nBad Name: x\r\n\r\n", DEFAULT_REQUEST, DEFAULT_HEADER, 400},
+        {"obsolete folding", "GET / HTTP/1.1\r\nA: b\r\n c\r\n\r\n", DEFAULT_REQUEST, DEFAULT_HEADER, 400},
+        {"invalid content-length", "POST / HTTP/1.1\r\nContent-Length: 1x\r\n\r\n", DEFAULT_REQUEST, DEFAULT_HEADER, 400},
+        {"conflicting content-length", "POST / HTTP/1.1\r\nContent-Length: 1\r\nContent-Length: 2\r\n\r\n",
+         DEFAULT_REQUEST, DEFAULT_HEADER, 400},
+        {"content-length with chunked", "POST / HTTP/1.1\r\nContent-Length: 1\r\nTransfer-Encoding: chunked\r\n\r\n",
+         DEFAULT_REQUEST, DEFAULT_HEADER, 400},
+        {"unsupported transfer-encoding", "POST / HTTP/1.1\r\nTransfer-Encoding: gzip\r\n\r\n",
+         DEFAULT_REQUEST, DEFAULT_HEADER, 501},
+        {"invalid chunk size", "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n",
+         DEFAULT_REQUEST, DEFAULT_HEADER, 400},
+        {"missing chunk terminator", "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n2\r\nabXY",
+         DEFAULT_REQUEST, DEFAULT_HEADER, 400},
+        {"content-length over limit", "POST / HTTP/1.1\r\nContent-Length: 100\r\n\r\n", 64, 64, 413},
+        {"chunked body over limit", "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n20\r\n", 64, 64, 413},
+        {"unterminated headers over limit", "GET / HTTP/1.1\r\nX-Long: " + std::string(40, 'a'), 1024, 32, 431},
+        {"complete headers over limit", "GET / HTTP/1.1\r\nX-Long: " + std::string(40, 'a') + "\r\n\r\n", 1024, 32, 431},
+        {"trailers over limit", "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n0\r\nX-Trailer: " +
+         std::string(80, 'a'), 1024, 64, 431},
+    };
+
+    for (const auto& test : cases) {
+        SCOPED_TRACE(test.name);
+        HttpRequestParser parser(test.max_request_size, test.max_header_size);
+        std::string buffer = test.request;
+        ASSERT_EQ(parser.parse(buffer), Result::ERROR);
+        EXPECT_EQ(parser.error_status(), test.status);
+        EXPECT_FALSE(parser.error_message().empty());
+        // The error is sticky until the parser is reset
+        EXPECT_EQ(parser.parse(buffer), Result::ERROR);
+    }
+}
+
+TEST(HttpRequestParserTest, RequestAtTheSizeLimitIsAccepted) {
+    const std::string head = "POST / HTTP/1.1\r\nContent-Length: 10\r\n\r\n";
+    HttpRequestParser parser(head.size() + 10);
+    std::string buffer = head + "0123456789";
+    ASSERT_EQ(parser.parse(buffer), Result::COMPLETE);
+    EXPECT_EQ(parser.request().body, "0123456789");
+
+    HttpRequestParser too_small(head.size() + 9);
+    buffer = head + "0123456789";
+    ASSERT_EQ(too_small.parse(buffer), Result::ERROR);
+    EXPECT_EQ(too_small.error_status(), 413);
+}
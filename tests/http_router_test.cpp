@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include "http_router.hpp"
+
+#include <string>
+#include <vector>
+
+namespace {
+
+using Router = HttpRouter<int>;
+using Status = Router::MatchStatus;
+
+// A subset of the HTTPServer route table, with overlapping literal and
+// capture segments at the same depth.
+Router make_router() {
+    Router router;
+    router.add("GET", "/agents", "List agents", 1);
+    router.add("POST", "/agents", "Create agent", 2);
+    router.add("GET", "/agents/{id}", "Get agent", 3);
+    router.add("DELETE", "/agents/{id}", "Delete agent", 4);
+    router.add("POST", "/agents/{id}/execute", "Execute agent function", 5);
+    router.add("POST", "/agent/execute", "Simple agent execute", 6);
+    router.add("GET", "/workflows", "List workflows", 7);
+    router.add("GET", "/workflows/{id}", "Get workflow", 8);
+    router.add("GET", "/workflows/executions", "List executions", 9);
+    router.add("GET", "/workflows/executions/{id}", "Get execution", 10);
+    router.add("PUT", "/workflows/executions/{id}/{action}", "Control execution", 11);
+    router.add("GET", "/workflow_executions/{id}/logs", "Execution logs", 12);
+    router.add("GET", "/catalog/featured/items", "Featured items", 13);
+    router.add("GET", "/catalog/{section}/summary", "Section summary", 14);
+    return router;
+}
+
+}  // namespace
+
+TEST(HttpRouterTest, ResolvesRoutesAndCapturesParameters) {
+    struct Case {
+        const char* method;
+        const char* path;
+        int handler;
+        std::vector<std::pair<std::string, std::string>> params;
+    };
+    const std::vector<Case> cases = {
+        {"GET", "/agents", 1, {}},
+        {"POST", "/agents", 2, {}},
+        {"GET", "/agents/a1b2", 3, {{"id", "a1b2"}}},
+        {"DELETE", "/agents/Assistant", 4, {{"id", "Assistant"}}},
+        {"POST", "/agents/a1b2/execute", 5, {{"id", "a1b2"}}},
+        {"POST", "/agent/execute", 6, {}},
+        {"GET", "/workflows/wf-7", 8, {{"id", "wf-7"}}},
+        {"GET", "/workflows/executions/e9", 10, {{"id", "e9"}}},
+        {"PUT", "/workflows/executions/e9/pause", 11, {{"id", "e9"}, {"action", "pause"}}},
+        {"GET", "/workflow_executions/e9/logs", 12, {{"id", "e9"}}},
+        // Empty segments and a trailing slash are ignored
+        {"GET", "/agents/", 1, {}},
+        {"GET", "//agents//a1b2/", 3, {{"id", "a1b2"}}},
+    };
+
+    Router router = make_router();
+    for (const auto& test : cases) {
+        SCOPED_TRACE(std::string(test.method) + " " + test.path);
+        auto match = router.resolve(test.method, test.path);
+        ASSERT_EQ(match.status, Status::MATCHED);
+        ASSERT_NE(match.handler, nullptr);
+        EXPECT_EQ(*match.handler, test.handler);
+        ASSERT_NE(match.name, nullptr);
+        EXPECT_EQ(match.params.size(), test.params.size());
+        for (const auto& [name, value] : test.params) {
+            EXPECT_EQ(match.params.get(name), value);
+        }
+    }
+}
+
+TEST(HttpRouterTest, LiteralSegmentsTakePrecedenceOverCaptures) {
+    Router router = make_router();
+
+    auto literal = router.resolve("GET", "/workflows/executions");
+    ASSERT_EQ(literal.status, Status::MATCHED);
+    EXPECT_EQ(*literal.handler, 9);
+    EXPECT_EQ(*literal.name, "List executions");
+    EXPECT_EQ(literal.params.size(), 0u);
+
+    auto capture = router.resolve("GET", "/workflows/execution");
+    ASSERT_EQ(capture.status, Status::MATCHED);
+    EXPECT_EQ(*capture.handler, 8);
+    EXPECT_EQ(capture.params.get("id"), "execution");
+
+    // Registration order does not matter
+    Router reversed;
+    reversed.add("GET", "/workflows/{id}", "Get workflow", 8);
+    reversed.add("GET", "/workflows/executions", "List executions", 9);
+    EXPECT_EQ(*reversed.resolve("GET", "/workflows/executions").handler, 9);
+}
+
+TEST(HttpRouterTest, BacktracksIntoCaptureWhenLiteralBranchDeadEnds) {
+    Router router = make_router();
+
+    auto literal = router.resolve("GET", "/catalog/featured/items");
+    ASSERT_EQ(literal.status, Status::MATCHED);
+    EXPECT_EQ(*literal.handler, 13);
+
+    // "featured" matches the literal first, which has no "summary" child
+    auto backtracked = router.resolve("GET", "/catalog/featured/summary");
+    ASSERT_EQ(backtracked.status, Status::MATCHED);
+    EXPECT_EQ(*backtracked.handler, 14);
+    EXPECT_EQ(backtracked.params.size(), 1u);
+    EXPECT_EQ(backtracked.params.get("section"), "featured");
+}
+
+TEST(HttpRouterTest, DistinguishesNotFoundFromMethodNotAllowed) {
+    struct Case {
+        const char* method;
+        const char* path;
+        Status status;
+    };
+    const std::vector<Case> cases = {
+        {"GET", "/unknown", Status::NOT_FOUND},
+        {"GET", "/agents/a1b2/unknown", Status::NOT_FOUND},
+        {"GET", "/agents/a1b2/execute/extra", Status::NOT_FOUND},
+        {"GET", "/agent", Status::NOT_FOUND},                       // Interior node without handlers
+        {"PUT", "/workflows/executions/e9/pause/now", Status::NOT_FOUND},
+        {"GET", "/", Status::NOT_FOUND},
+        {"GET", "", Status::NOT_FOUND},
+        {"GET", "agents", Status::NOT_FOUND},                       // Not an absolute path
+        {"PUT", "/agents", Status::METHOD_NOT_ALLOWED},
+        {"GET", "/agents/a1b2/execute", Status::METHOD_NOT_ALLOWED},
+        {"DELETE", "/workflows/executions", Status::METHOD_NOT_ALLOWED},
+        {"OPTIONS", "/agents", Status::METHOD_NOT_ALLOWED},          // CORS preflight path
+        {"BREW", "/agents", Status::METHOD_NOT_ALLOWED},
+    };
+
+    Router router = make_router();
+    for (const auto& test : cases) {
+        SCOPED_TRACE(std::string(test.method) + " " + test.path);
+        auto match = router.resolve(test.method, test.path);
+        EXPECT_EQ(match.status, test.status);
+        EXPECT_EQ(match.handler, nullptr);
+    }
+}
+
+TEST(HttpRouterTest, RejectsPathsDeeperThanTheSegmentLimit) {
+    Router router;
+    router.add("GET", "/{a}/{b}/{c}/{d}", "Deep", 1);
+    std::string path;
+    for (int i = 0; i < 17; ++i) {
+        path += "/s";
+    }
+    EXPECT_EQ(router.resolve("GET", path).status, Status::NOT_FOUND);
+    EXPECT_EQ(router.resolve("GET", "/1/2/3/4").status, Status::MATCHED);
+}
+
+TEST(HttpRouterTest, RejectsInvalidRegistrations) {
+    Router router = make_router();
+    const size_t registered = router.size();
+    EXPECT_EQ(registered, 14u);
+
+    EXPECT_THROW(router.add("BREW", "/coffee", "Unknown method", 0), std::invalid_argument);
+    EXPECT_THROW(router.add("GET", "agents", "No leading slash", 0), std::invalid_argument);
+    EXPECT_THROW(router.add("GET", "", "Empty pattern", 0), std::invalid_argument);
+    EXPECT_THROW(router.add("GET", "/agents/{id}", "Duplicate", 0), std::invalid_argument);
+    EXPECT_THROW(router.add("GET", "/agents/{name}/start", "Conflicting capture", 0), std::invalid_argument);
+    EXPECT_THROW(router.add("GET", "/agents/{}", "Empty capture", 0), std::invalid_argument);
+    EXPECT_THROW(router.add("GET", "/{a}/{b}/{c}/{d}/{e}", "Too many captures", 0), std::invalid_argument);
+    EXPECT_EQ(router.size(), registered);
+
+    // Same pattern, different method is not a duplicate
+    router.add("PUT", "/agents/{id}", "Update agent", 15);
+    EXPECT_EQ(router.size(), registered + 1);
+    EXPECT_EQ(*router.resolve("PUT", "/agents/x").handler, 15);
+}
@@ -0,0 +1,331 @@
+#include <gtest/gtest.h>
+#include "functions/retrieval.hpp"
+#include "index_io.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace kolosal;
+
+namespace {
+
+constexpr size_t DIMENSION = 16;
+constexpr size_t COUNT = 400;  // Enough to train SQ8 and PQ codes
+
+// Offsets into the index file layout described in src/core/retrieval.cpp
+constexpr size_t FILE_HEADER_SIZE = 16;
+constexpr size_t SEGMENT_HEADER_SIZE = 24;
+constexpr size_t SEGMENT_CRC_OFFSET = 16;
+
+std::vector<float> random_vector(std::mt19937& gen) {
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    std::vector<float> vector(DIMENSION);
+    for (auto& value : vector) {
+        value = dist(gen);
+    }
+    return vector;
+}
+
+std::string read_file(const std::filesystem::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+void write_file(const std::filesystem::path& path, const std::string& data) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+QuantizedVectorIndex::Config trained_quickly() {
+    QuantizedVectorIndex::Config config;
+    config.training_size = 256;
+    return config;
+}
+
+class IndexPersistenceTest : public ::testing::Test {
+protected:
+    std::filesystem::path directory_;
+    std::filesystem::path path_;
+    std::mt19937 gen_{7};
+
+    void SetUp() override {
+        directory_ = std::filesystem::temp_directory_path() /
+                     ("kolosal_index_persistence_" +
+                      std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()));
+        std::filesystem::remove_all(directory_);
+        std::filesystem::create_directories(directory_);
+        path_ = directory_ / "store.kv";
+    }
+
+    void TearDown() override { std::filesystem::remove_all(directory_); }
+
+    std::unique_ptr<FAISSVectorStore> make_store(const std::string& index_type) {
+        auto store = std::make_unique<FAISSVectorStore>(DIMENSION, index_type, HnswIndex::Config(), trained_quickly());
+        store->initialize();
+        return store;
+    }
+
+    void add(FAISSVectorStore& store, const std::string& prefix, size_t count) {
+        std::vector<Document> documents;
+        std::vector<std::vector<float>> embeddings;
+        for (size_t i = 0; i < count; ++i) {
+            documents.emplace_back(prefix + std::to_string(i), "Content of " + prefix + std::to_string(i), "test");
+            embeddings.push_back(random_vector(gen_));
+        }
+        auto ids = store.add_documents(documents, embeddings);
+        for (const auto& id : ids) {
+            ASSERT_FALSE(id.empty());
+        }
+    }
+
+    // Every id in a Flat store, by searching with no threshold
+    static std::set<std::string> ids_in(FAISSVectorStore& store) {
+        std::set<std::string> ids;
+        for (const auto& result : store.search(std::vector<float>(DIMENSION, 1.0f), COUNT * 4, -1.0f)) {
+            ids.insert(result.id);
+        }
+        return ids;
+    }
+
+    static void expect_same_results(FAISSVectorStore& expected, FAISSVectorStore& actual,
+                                    const std::vector<std::vector<float>>& queries) {
+        for (const auto& query : queries) {
+            auto want = expected.search(query, 10, -1.0f);
+            auto got = actual.search(query, 10, -1.0f);
+            ASSERT_EQ(got.size(), want.size());
+            for (size_t i = 0; i < want.size(); ++i) {
+                EXPECT_EQ(got[i].id, want[i].id);
+                EXPECT_FLOAT_EQ(got[i].score, want[i].score);
+                EXPECT_EQ(got[i].payload["content"], want[i].payload["content"]);
+                EXPECT_EQ(got[i].payload["source"], "test");
+            }
+        }
+    }
+};
+
+}  // namespace
+
+TEST(IndexIoTest, ReaderReturnsWhatWriterWrote) {
+    std::string buffer;
+    index_io::Writer writer(buffer);
+    writer.put<uint32_t>(0xDEADBEEF);
+    writer.put_string("hello");
+    writer.put_string("");
+    std::vector<float> floats = {1.5f, -2.0f, 3.25f};
+    writer.put_array(floats, floats.size());
+    EXPECT_EQ(writer.size(), 4 + 8 + 5 + 8 + 8 + 3 * sizeof(float));
+
+    index_io::Reader reader(buffer.data(), buffer.size());
+    uint32_t number;
+    std::string text, empty;
+    std::vector<float> read_floats;
+    ASSERT_TRUE(reader.get(number));
+    ASSERT_TRUE(reader.get_string(text));
+    ASSERT_TRUE(reader.get_string(empty));
+    ASSERT_TRUE(reader.get_array(read_floats, floats.size()));
+    EXPECT_EQ(number, 0xDEADBEEF);
+    EXPECT_EQ(text, "hello");
+    EXPECT_TRUE(empty.empty());
+    EXPECT_EQ(read_floats, floats);
+    EXPECT_TRUE(reader.at_end());
+    EXPECT_FALSE(reader.get(number));
+}
+
+TEST(IndexIoTest, ReaderRejectsShortAndMismatchedData) {
+    std::string buffer;
+    index_io::Writer writer(buffer);
+    writer.put_string("hello");
+    std::vector<float> floats(4, 1.0f);
+    writer.put_array(floats, floats.size());
+
+    // A length prefix that runs past the end
+    for (size_t size = 0; size < 8 + 5; ++size) {
+        index_io::Reader reader(buffer.data(), size);
+        std::string text;
+        EXPECT_FALSE(reader.get_string(text)) << size;
+    }
+
+    index_io::Reader reader(buffer.data(), buffer.size() - 1);
+    std::string text;
+    std::vector<float> read_floats;
+    ASSERT_TRUE(reader.get_string(text));
+    EXPECT_FALSE(reader.get_array(read_floats, floats.size()));  // One byte short
+
+    index_io::Reader other(buffer.data(), buffer.size());
+    ASSERT_TRUE(other.get_string(text));
+    EXPECT_FALSE(other.get_array(read_floats, floats.size() + 1));  // Wrong element count
+}
+
+TEST(IndexIoTest, Crc32MatchesTheStandardCheckValue) {
+    const std::string check = "123456789";
+    EXPECT_EQ(index_io::crc32(check.data(), check.size()), 0xCBF43926u);
+    EXPECT_EQ(index_io::crc32(nullptr, 0), 0u);
+    // Continuing from a previous CRC equals one pass over both parts
+    uint32_t first = index_io::crc32(check.data(), 4);
+    EXPECT_EQ(index_io::crc32(check.data() + 4, check.size() - 4, first), 0xCBF43926u);
+}
+
+TEST_F(IndexPersistenceTest, EveryIndexTypeRoundTrips) {
+    std::vector<std::vector<float>> queries;
+    for (int i = 0; i < 20; ++i) {
+        queries.push_back(random_vector(gen_));
+    }
+    for (const std::string index_type : {"Flat", "HNSW", "SQ8", "PQ"}) {
+        SCOPED_TRACE(index_type);
+        std::filesystem::remove(path_);
+        auto original = make_store(index_type);
+        add(*original, "doc-", COUNT);
+        ASSERT_TRUE(original->save_index(path_.string()));
+
+        auto loaded = make_store(index_type);
+        ASSERT_TRUE(loaded->load_index(path_.string()));
+        expect_same_results(*original, *loaded, queries);
+    }
+}
+
+TEST_F(IndexPersistenceTest, AppendSegmentsReplayAdditionsAndRemovals) {
+    auto store = make_store("Flat");
+    add(*store, "doc-", COUNT);
+    ASSERT_TRUE(store->save_index(path_.string()));
+    const std::string base = read_file(path_);
+
+    // The base segment is left in place and the changes follow it
+    add(*store, "new-", 10);
+    ASSERT_TRUE(store->delete_document("doc-0"));
+    ASSERT_TRUE(store->save_index(path_.string()));
+    const std::string appended = read_file(path_);
+    ASSERT_GT(appended.size(), base.size());
+    EXPECT_EQ(appended.compare(0, base.size(), base), 0);
+
+    auto loaded = make_store("Flat");
+    ASSERT_TRUE(loaded->load_index(path_.string()));
+    auto ids = ids_in(*loaded);
+    EXPECT_EQ(ids, ids_in(*store));
+    EXPECT_EQ(ids.size(), COUNT + 9);
+    EXPECT_EQ(ids.count("doc-0"), 0u);
+    EXPECT_EQ(ids.count("new-9"), 1u);
+}
+
+TEST_F(IndexPersistenceTest, CompactsAfterTooManyAppendSegments) {
+    auto store = make_store("Flat");
+    add(*store, "doc-", COUNT);
+    ASSERT_TRUE(store->save_index(path_.string()));
+    size_t base_size = std::filesystem::file_size(path_);
+
+    for (size_t i = 0; i <= FAISSVectorStore::MAX_APPEND_SEGMENTS; ++i) {
+        ASSERT_TRUE(store->delete_document("doc-" + std::to_string(i)));
+        ASSERT_TRUE(store->save_index(path_.string()));
+    }
+    // The last save rewrote the file as one smaller base segment
+    EXPECT_LT(std::filesystem::file_size(path_), base_size);
+
+    auto loaded = make_store("Flat");
+    ASSERT_TRUE(loaded->load_index(path_.string()));
+    EXPECT_EQ(ids_in(*loaded).size(), COUNT - FAISSVectorStore::MAX_APPEND_SEGMENTS - 1);
+}
+
+TEST_F(IndexPersistenceTest, RejectsACorruptedBaseSegment) {
+    auto store = make_store("Flat");
+    add(*store, "doc-", COUNT);
+    ASSERT_TRUE(store->save_index(path_.string()));
+    const std::string file = read_file(path_);
+
+    auto loaded = make_store("Flat");
+    add(*loaded, "kept-", 3);
+
+    // A flipped bit in the payload, and in the stored checksum itself
+    for (size_t offset : {FILE_HEADER_SIZE + SEGMENT_HEADER_SIZE + 100, file.size() / 2, file.size() - 1,
+                          FILE_HEADER_SIZE + SEGMENT_CRC_OFFSET}) {
+        std::string damaged = file;
+        damaged[offset] ^= 0x01;
+        write_file(path_, damaged);
+        EXPECT_FALSE(loaded->load_index(path_.string())) << "byte " << offset;
+    }
+
+    // A failed load leaves the store as it was
+    EXPECT_EQ(ids_in(*loaded), (std::set<std::string>{"kept-0", "kept-1", "kept-2"}));
+}
+
+TEST_F(IndexPersistenceTest, RejectsForeignAndMismatchedFiles) {
+    auto store = make_store("Flat");
+    add(*store, "doc-", 10);
+    ASSERT_TRUE(store->save_index(path_.string()));
+    const std::string file = read_file(path_);
+
+    auto loaded = make_store("Flat");
+    EXPECT_FALSE(loaded->load_index((directory_ / "missing.kv").string()));
+
+    std::string bad_magic = file;
+    bad_magic[0] = 'X';
+    write_file(path_, bad_magic);
+    EXPECT_FALSE(loaded->load_index(path_.string()));
+
+    std::string bad_version = file;
+    bad_version[8] = 2;
+    write_file(path_, bad_version);
+    EXPECT_FALSE(loaded->load_index(path_.string()));
+
+    write_file(path_, file);
+    EXPECT_FALSE(make_store("HNSW")->load_index(path_.string()));
+    FAISSVectorStore wider(DIMENSION * 2, "Flat");
+    wider.initialize();
+    EXPECT_FALSE(wider.load_index(path_.string()));
+    EXPECT_TRUE(loaded->load_index(path_.string()));
+}
+
+TEST_F(IndexPersistenceTest, RejectsATruncatedBaseSegment) {
+    auto store = make_store("Flat");
+    add(*store, "doc-", 50);
+    ASSERT_TRUE(store->save_index(path_.string()));
+    const std::string file = read_file(path_);
+
+    auto loaded = make_store("Flat");
+    for (size_t size = 0; size < file.size(); size += (size < 64 ? 1 : 37)) {
+        write_file(path_, file.substr(0, size));
+        EXPECT_FALSE(loaded->load_index(path_.string())) << size << " of " << file.size() << " bytes";
+    }
+    write_file(path_, file.substr(0, file.size() - 1));
+    EXPECT_FALSE(loaded->load_index(path_.string()));
+}
+
+TEST_F(IndexPersistenceTest, TornAppendSegmentKeepsEarlierSegmentsAndIsCompactedAway) {
+    auto store = make_store("Flat");
+    add(*store, "doc-", 50);
+    ASSERT_TRUE(store->save_index(path_.string()));
+    add(*store, "first-", 5);
+    ASSERT_TRUE(store->save_index(path_.string()));
+    size_t intact_size = std::filesystem::file_size(path_);
+    add(*store, "second-", 5);
+    ASSERT_TRUE(store->save_index(path_.string()));
+    const std::string file = read_file(path_);
+    ASSERT_GT(file.size(), intact_size);
+
+    // A crash part-way through the second append
+    for (size_t size = intact_size + 1; size < file.size(); size += 23) {
+        write_file(path_, file.substr(0, size));
+        auto loaded = make_store("Flat");
+        ASSERT_TRUE(loaded->load_index(path_.string())) << size;
+        auto ids = ids_in(*loaded);
+        EXPECT_EQ(ids.size(), 55u) << size;
+        EXPECT_EQ(ids.count("first-4"), 1u);
+        EXPECT_EQ(ids.count("second-0"), 0u);
+    }
+
+    // The damaged tail is not appended to; the next save rewrites the file
+    write_file(path_, file.substr(0, file.size() - 1));
+    auto loaded = make_store("Flat");
+    ASSERT_TRUE(loaded->load_index(path_.string()));
+    add(*loaded, "third-", 2);
+    ASSERT_TRUE(loaded->save_index(path_.string()));
+
+    auto reloaded = make_store("Flat");
+    ASSERT_TRUE(reloaded->load_index(path_.string()));
+    EXPECT_EQ(ids_in(*reloaded), ids_in(*loaded));
+    EXPECT_EQ(ids_in(*reloaded).size(), 57u);
+}
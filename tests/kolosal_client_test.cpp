@@ -0,0 +1,289 @@
+#include <gtest/gtest.h>
+#include "client.hpp"
+#include "loopback_server.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// The model catalogue cache against a stub server that counts /models hits.
+// Each /models response carries the catalogue "version", bumped by the test,
+// so a refreshed catalogue can be told from the cached one.
+class ModelCatalogueTest : public ::testing::Test {
+protected:
+    std::atomic<int> version_{1};
+    std::atomic<int> models_delay_ms_{0};
+    std::unique_ptr<LoopbackServer> server_;
+
+    void SetUp() override {
+        server_ = std::make_unique<LoopbackServer>([this](const LoopbackServer::Request& request) {
+            LoopbackServer::Response response;
+            if (request.path == "/models") {
+                response.body = catalogue(version_.load()).dump();
+                response.delay_ms = models_delay_ms_.load();
+            } else {
+                response.status = 404;
+                response.body = "{\"error\":\"model not loaded\"}";
+            }
+            return response;
+        });
+    }
+
+    static json catalogue(int version) {
+        return json::array({
+            {{"id", "model-a"}, {"name", "Model A"}, {"aliases", {"a", "alpha"}}, {"version", version}},
+            {{"model_id", "model-b"}, {"version", version}}
+        });
+    }
+
+    std::unique_ptr<KolosalClient> make_client(int ttl_seconds) {
+        KolosalClient::Config config;
+        config.server_url = server_->url();
+        config.max_retries = 0;
+        config.model_cache_ttl_seconds = ttl_seconds;
+        return std::make_unique<KolosalClient>(config);
+    }
+
+    size_t model_fetches() const { return server_->hits("/models"); }
+
+    static int served_version(KolosalClient& client) {
+        json models = client.get_available_models();
+        return models.empty() ? 0 : models[0].value("version", 0);
+    }
+
+    // Polls until the client serves version or timeout_ms passes
+    static bool wait_for_version(KolosalClient& client, int version, int timeout_ms = 5000) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+        while (std::chrono::steady_clock::now() < deadline) {
+            if (served_version(client) == version) {
+                return true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return false;
+    }
+};
+
+}  // namespace
+
+TEST_F(ModelCatalogueTest, LookupMatchesIdModelIdNameAndAliases) {
+    auto client = make_client(60);
+    for (const char* key : {"model-a", "Model A", "a", "alpha", "model-b"}) {
+        EXPECT_TRUE(client->is_model_available(key)) << key;
+    }
+    EXPECT_FALSE(client->is_model_available("model-c"));
+    EXPECT_FALSE(client->is_model_available("Alpha"));
+    EXPECT_EQ(client->get_available_models().size(), 2u);
+    EXPECT_EQ(model_fetches(), 1u);
+}
+
+TEST_F(ModelCatalogueTest, CatalogueIsServedFromCacheWithinTtl) {
+    auto client = make_client(60);
+    for (int i = 0; i < 20; ++i) {
+        EXPECT_EQ(served_version(*client), 1);
+        EXPECT_TRUE(client->is_model_available("model-a"));
+    }
+    version_ = 2;
+    EXPECT_EQ(served_version(*client), 1);
+    EXPECT_EQ(model_fetches(), 1u);
+}
+
+TEST_F(ModelCatalogueTest, ExpiredCatalogueIsServedWhileOneBackgroundRefreshRuns) {
+    auto client = make_client(1);
+    EXPECT_EQ(served_version(*client), 1);
+
+    version_ = 2;
+    models_delay_ms_ = 500;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+
+    // Every lookup during the slow refresh answers at once with the stale catalogue
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 20; ++i) {
+        EXPECT_EQ(served_version(*client), 1);
+        EXPECT_TRUE(client->is_model_available("alpha"));
+    }
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(400));
+
+    EXPECT_TRUE(wait_for_version(*client, 2));
+    EXPECT_EQ(model_fetches(), 2u);
+}
+
+TEST_F(ModelCatalogueTest, ConcurrentColdLookupsFetchOnce) {
+    auto client = make_client(60);
+    models_delay_ms_ = 200;
+
+    std::vector<std::thread> callers;
+    std::atomic<int> found{0};
+    for (int i = 0; i < 8; ++i) {
+        callers.emplace_back([&] {
+            if (client->is_model_available("model-b")) {
+                found++;
+            }
+        });
+    }
+    for (auto& caller : callers) {
+        caller.join();
+    }
+    EXPECT_EQ(found.load(), 8);
+    EXPECT_EQ(model_fetches(), 1u);
+}
+
+TEST_F(ModelCatalogueTest, ZeroTtlFetchesOnEveryLookup) {
+    auto client = make_client(0);
+    EXPECT_EQ(served_version(*client), 1);
+    version_ = 2;
+    EXPECT_EQ(served_version(*client), 2);
+    EXPECT_TRUE(client->is_model_available("model-a"));
+    EXPECT_EQ(model_fetches(), 3u);
+}
+
+TEST_F(ModelCatalogueTest, ChatNotFoundInvalidatesTheCatalogue) {
+    auto client = make_client(60);
+    EXPECT_TRUE(client->is_model_available("model-a"));
+    EXPECT_EQ(model_fetches(), 1u);
+
+    EXPECT_THROW(client->chat_with_model("model-a", "hello"), std::runtime_error);
+    EXPECT_EQ(server_->hits("/chat/completions"), 1u);
+
+    version_ = 2;
+    EXPECT_EQ(served_version(*client), 2);
+    EXPECT_EQ(model_fetches(), 2u);
+}
+
+TEST_F(ModelCatalogueTest, InvalidateForcesARefetch) {
+    auto client = make_client(60);
+    EXPECT_EQ(served_version(*client), 1);
+    version_ = 2;
+    client->invalidate_model_cache();
+    EXPECT_EQ(served_version(*client), 2);
+    EXPECT_EQ(served_version(*client), 2);
+    EXPECT_EQ(model_fetches(), 2u);
+}
+
+namespace {
+
+// The *_async variants against a stub server. Chat answers with the last
+// message, except for model "broken" (500) and "garbled" (not JSON);
+// /search is not available (404).
+class KolosalClientAsyncTest : public ::testing::Test {
+protected:
+    std::unique_ptr<LoopbackServer> server_;
+    std::unique_ptr<KolosalClient> client_;
+
+    void SetUp() override {
+        server_ = std::make_unique<LoopbackServer>([](const LoopbackServer::Request& request) {
+            LoopbackServer::Response response;
+            json body = json::parse(request.body, nullptr, false);
+            if (request.path == "/chat/completions") {
+                std::string model = body.value("model", "");
+                if (model == "broken") {
+                    response.status = 500;
+                    response.body = "{\"error\":\"model crashed\"}";
+                } else if (model == "garbled") {
+                    response.body = "not json";
+                } else {
+                    std::string content = body["messages"].back().value("content", "");
+                    response.body = json{{"choices", {{{"message", {{"content", "echo: " + content}}}}}}}.dump();
+                }
+            } else if (request.path == "/completions") {
+                response.body = json{{"text", body.value("prompt", "")}, {"max_tokens", body.value("max_tokens", 0)}}.dump();
+            } else if (request.path == "/retrieve") {
+                response.body = json{{"results", json::array({body.value("query", "")})}, {"k", body.value("k", 0)}}.dump();
+            } else {
+                response.status = 404;
+                response.body = "{\"error\":\"not found\"}";
+            }
+            return response;
+        });
+        KolosalClient::Config config;
+        config.server_url = server_->url();
+        config.max_retries = 0;
+        client_ = std::make_unique<KolosalClient>(config);
+    }
+
+    template <typename T>
+    static bool ready(std::future<T>& future) {
+        return future.wait_for(std::chrono::seconds(10)) == std::future_status::ready;
+    }
+};
+
+}  // namespace
+
+TEST_F(KolosalClientAsyncTest, FuturesResolveWithTheParsedResponse) {
+    auto chat = client_->chat_with_model_async("model-a", "hello", "be brief");
+    auto completion = client_->completion_request_async("model-a", "once upon", json{{"max_tokens", 8}});
+    auto search = client_->search_documents_async("needle", 3);
+    ASSERT_TRUE(ready(chat));
+    ASSERT_TRUE(ready(completion));
+    ASSERT_TRUE(ready(search));
+
+    EXPECT_EQ(chat.get(), "echo: hello");
+    json completed = completion.get();
+    EXPECT_EQ(completed["text"], "once upon");
+    EXPECT_EQ(completed["max_tokens"], 8);
+    json found = search.get();
+    EXPECT_EQ(found["results"], json::array({"needle"}));
+    EXPECT_EQ(found["k"], 3);
+}
+
+TEST_F(KolosalClientAsyncTest, ErrorsPropagateThroughTheFuture) {
+    auto failed = client_->chat_with_model_async("broken", "hello");
+    ASSERT_TRUE(ready(failed));
+    try {
+        failed.get();
+        FAIL() << "expected the server error";
+    } catch (const std::runtime_error& e) {
+        EXPECT_EQ(std::string(e.what()).rfind("Failed to communicate with model: ", 0), 0u) << e.what();
+    }
+
+    auto garbled = client_->chat_with_model_async("garbled", "hello");
+    ASSERT_TRUE(ready(garbled));
+    EXPECT_THROW(garbled.get(), std::runtime_error);
+
+    // A missing search endpoint is not an error, as with internet_search()
+    auto search = client_->internet_search_async("weather");
+    ASSERT_TRUE(ready(search));
+    json unavailable = search.get();
+    EXPECT_EQ(unavailable["status"], "search_not_available");
+    EXPECT_EQ(unavailable["query"], "weather");
+}
+
+TEST_F(KolosalClientAsyncTest, CallbackFiresExactlyOnce) {
+    std::atomic<int> successes{0};
+    std::atomic<int> failures{0};
+    std::atomic<int> calls{0};
+    auto count = [&](bool failed) {
+        (failed ? failures : successes)++;
+        calls++;
+    };
+    client_->chat_with_model_async("model-a", "one", "", [&](std::string reply, std::exception_ptr error) {
+        count(error != nullptr || reply != "echo: one");
+    });
+    client_->chat_with_model_async("broken", "two", "", [&](std::string reply, std::exception_ptr error) {
+        count(error == nullptr || !reply.empty());
+    });
+    client_->completion_request_async("model-a", "three", json::object(), [&](json response, std::exception_ptr error) {
+        count(error != nullptr || response.value("text", "") != "three");
+    });
+    client_->internet_search_async("four", 5, [&](json response, std::exception_ptr error) {
+        count(error != nullptr || response.value("status", "") != "search_not_available");
+    });
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (calls.load() < 4 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    // Later requests through the same event loop do not repeat earlier callbacks
+    EXPECT_EQ(client_->chat_with_model_async("model-a", "five").get(), "echo: five");
+    EXPECT_EQ(calls.load(), 4);
+    EXPECT_EQ(successes.load(), 4);
+    EXPECT_EQ(failures.load(), 0);
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+// Raw HTTP/1.1 client on 127.0.0.1 for tests that check what a server puts
+// on the wire: pipelined requests, Connection headers, event streams and
+// when the server closes the socket. Reads give up after a receive timeout
+// instead of hanging the test.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+class LoopbackClient {
+public:
+    struct Response {
+        int status = 0;
+        std::string headers;  // Status line and headers, lower-cased
+        std::string body;
+
+        bool has_header(const std::string& line) const {
+            std::string lowered = line;
+            std::transform(lowered.begin(), lowered.end(), lowered.begin(), ::tolower);
+            return headers.find("\r\n" + lowered + "\r\n") != std::string::npos;
+        }
+    };
+
+    explicit LoopbackClient(int port, int receive_timeout_ms = 10000) {
+        fd_ = socket(AF_INET, SOCK_STREAM, 0);
+        timeval timeout{};
+        timeout.tv_sec = receive_timeout_ms / 1000;
+        timeout.tv_usec = (receive_timeout_ms % 1000) * 1000;
+        setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(static_cast<uint16_t>(port));
+        if (connect(fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+            close(fd_);
+            throw std::runtime_error("loopback client: connect failed");
+        }
+    }
+
+    ~LoopbackClient() { close(fd_); }
+
+    LoopbackClient(const LoopbackClient&) = delete;
+    LoopbackClient& operator=(const LoopbackClient&) = delete;
+
+    // A port that was free a moment ago, for servers that need one up front
+    static int free_port() {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(address);
+        bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+        getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length);
+        close(fd);
+        return ntohs(address.sin_port);
+    }
+
+    static std::string get(const std::string& path, const std::string& extra_headers = "") {
+        return "GET " + path + " HTTP/1.1\r\nHost: 127.0.0.1\r\n" + extra_headers + "\r\n";
+    }
+
+    bool send(const std::string& data) {
+        return ::send(fd_, data.data(), data.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(data.size());
+    }
+
+    // Next response with a Content-Length body; status 0 if the connection
+    // closed or timed out first
+    Response read_response() {
+        Response response;
+        size_t header_end;
+        while ((header_end = buffer_.find("\r\n\r\n")) == std::string::npos) {
+            if (!receive()) {
+                return response;
+            }
+        }
+        response.headers = buffer_.substr(0, header_end + 2);
+        std::transform(response.headers.begin(), response.headers.end(), response.headers.begin(), ::tolower);
+        response.status = std::atoi(response.headers.c_str() + response.headers.find(' ') + 1);
+        size_t length = 0;
+        size_t pos = response.headers.find("\r\ncontent-length:");
+        if (pos != std::string::npos) {
+            length = std::strtoull(response.headers.c_str() + pos + 17, nullptr, 10);
+        }
+        while (buffer_.size() < header_end + 4 + length) {
+            if (!receive()) {
+                response.status = 0;
+                return response;
+            }
+        }
+        response.body = buffer_.substr(header_end + 4, length);
+        buffer_.erase(0, header_end + 4 + length);
+        return response;
+    }
+
+    // Reads until marker has arrived; false if the connection closed or timed out first
+    bool read_until(const std::string& marker) {
+        while (buffer_.find(marker) == std::string::npos) {
+            if (!receive()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Reads until the server closes the connection; false on timeout
+    bool read_until_closed() {
+        while (receive()) {
+        }
+        return closed_;
+    }
+
+    // Everything received and not yet consumed by read_response()
+    const std::string& received() const { return buffer_; }
+
+private:
+    int fd_ = -1;
+    std::string buffer_;
+    bool closed_ = false;
+
+    bool receive() {
+        char chunk[8192];
+        ssize_t received = recv(fd_, chunk, sizeof(chunk), 0);
+        if (received <= 0) {
+            // A reset counts as closed; only a receive timeout does not
+            closed_ = received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK);
+            return false;
+        }
+        buffer_.append(chunk, static_cast<size_t>(received));
+        return true;
+    }
+};
@@ -0,0 +1,185 @@
+#pragma once
+
+// Minimal HTTP/1.1 server on 127.0.0.1 for tests that need a real socket.
+// Each connection is served on its own thread, with keep-alive, and every
+// request is answered by the handler. Responses may be delayed; the delay
+// ends early when the server shuts down.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+class LoopbackServer {
+public:
+    struct Request {
+        std::string method;
+        std::string path;
+        std::string body;
+    };
+
+    struct Response {
+        int status = 200;
+        std::string body = "{}";
+        std::string content_type = "application/json";
+        int delay_ms = 0;  // Wait this long before answering
+    };
+
+    using Handler = std::function<Response(const Request&)>;
+
+    explicit LoopbackServer(Handler handler) : handler_(std::move(handler)) {
+        listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = 0;
+        if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+            listen(listen_fd_, 64) < 0) {
+            close(listen_fd_);
+            throw std::runtime_error("loopback server: bind/listen failed");
+        }
+        socklen_t length = sizeof(address);
+        getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&address), &length);
+        port_ = ntohs(address.sin_port);
+        accept_thread_ = std::thread([this] { accept_loop(); });
+    }
+
+    ~LoopbackServer() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+            for (int fd : open_fds_) {
+                shutdown(fd, SHUT_RDWR);
+            }
+        }
+        stopped_.notify_all();
+        shutdown(listen_fd_, SHUT_RDWR);
+        close(listen_fd_);
+        accept_thread_.join();
+        for (auto& thread : connection_threads_) {
+            thread.join();
+        }
+    }
+
+    LoopbackServer(const LoopbackServer&) = delete;
+    LoopbackServer& operator=(const LoopbackServer&) = delete;
+
+    int port() const { return port_; }
+    std::string url() const { return "http://127.0.0.1:" + std::to_string(port_); }
+
+    // Requests received for path so far
+    size_t hits(const std::string& path) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = hits_.find(path);
+        return it == hits_.end() ? 0 : it->second;
+    }
+
+    // Connections accepted so far
+    size_t connections() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return connections_;
+    }
+
+private:
+    Handler handler_;
+    int listen_fd_ = -1;
+    int port_ = 0;
+    std::thread accept_thread_;
+    std::vector<std::thread> connection_threads_;  // Touched by the accept thread only
+    mutable std::mutex mutex_;
+    std::condition_variable stopped_;
+    bool stopping_ = false;
+    std::set<int> open_fds_;
+    std::map<std::string, size_t> hits_;
+    size_t connections_ = 0;
+
+    void accept_loop() {
+        while (true) {
+            int fd = accept(listen_fd_, nullptr, nullptr);
+            if (fd < 0) {
+                return;
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_) {
+                close(fd);
+                return;
+            }
+            open_fds_.insert(fd);
+            connections_++;
+            connection_threads_.emplace_back([this, fd] { serve(fd); });
+        }
+    }
+
+    // Waits up to delay_ms; false if the server is stopping
+    bool delay(int delay_ms) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return !stopped_.wait_for(lock, std::chrono::milliseconds(delay_ms), [this] { return stopping_; });
+    }
+
+    void serve(int fd) {
+        std::string buffer;
+        char chunk[8192];
+        while (true) {
+            size_t header_end = buffer.find("\r\n\r\n");
+            size_t content_length = 0;
+            if (header_end != std::string::npos) {
+                std::string headers = buffer.substr(0, header_end);
+                std::transform(headers.begin(), headers.end(), headers.begin(), ::tolower);
+                size_t pos = headers.find("content-length:");
+                if (pos != std::string::npos) {
+                    content_length = std::strtoull(headers.c_str() + pos + 15, nullptr, 10);
+                }
+            }
+            if (header_end == std::string::npos || buffer.size() < header_end + 4 + content_length) {
+                ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+                if (received <= 0) {
+                    break;
+                }
+                buffer.append(chunk, static_cast<size_t>(received));
+                continue;
+            }
+
+            Request request;
+            size_t method_end = buffer.find(' ');
+            size_t path_end = buffer.find(' ', method_end + 1);
+            request.method = buffer.substr(0, method_end);
+            request.path = buffer.substr(method_end + 1, path_end - method_end - 1);
+            request.body = buffer.substr(header_end + 4, content_length);
+            buffer.erase(0, header_end + 4 + content_length);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                hits_[request.path]++;
+            }
+
+            Response response = handler_(request);
+            if (response.delay_ms > 0 && !delay(response.delay_ms)) {
+                break;
+            }
+            std::string reply = "HTTP/1.1 " + std::to_string(response.status) + " Status\r\n" +
+                                "Content-Type: " + response.content_type + "\r\n" +
+                                "Content-Length: " + std::to_string(response.body.size()) + "\r\n\r\n" +
+                                response.body;
+            if (send(fd, reply.data(), reply.size(), MSG_NOSIGNAL) < 0) {
+                break;
+            }
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        open_fds_.erase(fd);
+        close(fd);
+    }
+};
@@ -0,0 +1,214 @@
+#include <gtest/gtest.h>
+#include "agent_config.hpp"
+#include "agent_manager.hpp"
+#include "loopback_client.hpp"
+#include "server_http.hpp"
+#include "task_scheduler.hpp"
+#include "workflow_manager.hpp"
+#include "workflow_types.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using Event = std::pair<std::string, json>;  // Event type, data
+
+// Splits an event-stream body into its events; heartbeat comments are skipped
+std::vector<Event> parse_events(const std::string& stream) {
+    std::vector<Event> events;
+    size_t start = 0;
+    while (start < stream.size()) {
+        size_t end = stream.find("\n\n", start);
+        if (end == std::string::npos) {
+            break;
+        }
+        std::string frame = stream.substr(start, end - start);
+        start = end + 2;
+        if (frame.rfind("event: ", 0) != 0) {
+            continue;
+        }
+        size_t data = frame.find("\ndata: ");
+        events.emplace_back(frame.substr(7, data - 7), json::parse(frame.substr(data + 7)));
+    }
+    return events;
+}
+
+// Index of the first event of type, for the step if one is given
+size_t find_event(const std::vector<Event>& events, const std::string& type, const std::string& step_id = "") {
+    for (size_t i = 0; i < events.size(); ++i) {
+        if (events[i].first == type && (step_id.empty() || events[i].second.value("step_id", "") == step_id)) {
+            return i;
+        }
+    }
+    return events.size();
+}
+
+// The HTTP API on the epoll reactor, in front of an in-process agent whose
+// "gate" function blocks until the test opens the gate. The agent is shared
+// by the suite: creating one probes the retrieval server.
+class ExecutionEventStreamTest : public ::testing::Test {
+protected:
+    static std::shared_ptr<AgentManager> agent_manager_;
+    static std::shared_ptr<WorkflowManager> workflow_manager_;
+    static std::mutex gate_mutex_;
+    static std::condition_variable gate_opened_;
+    static bool gate_open_;
+
+    std::shared_ptr<WorkflowOrchestrator> orchestrator_;
+    std::unique_ptr<HTTPServer> server_;
+    int port_ = 0;
+
+    static void SetUpTestSuite() {
+        agent_manager_ = std::make_shared<AgentManager>(std::make_shared<AgentConfigManager>());
+        std::string agent_id = agent_manager_->create_agent("Worker", {"test"});
+        agent_manager_->get_agent(agent_id)->register_function("gate", [](const json& params) -> json {
+            TaskScheduler::BlockingScope blocking;
+            std::unique_lock<std::mutex> lock(gate_mutex_);
+            gate_opened_.wait_for(lock, std::chrono::seconds(10), [] { return gate_open_; });
+            return json{{"value", params.value("name", "") + "-result"}};
+        });
+        agent_manager_->start_agent(agent_id);
+
+        workflow_manager_ = std::make_shared<WorkflowManager>(agent_manager_);
+        workflow_manager_->start();
+    }
+
+    static void TearDownTestSuite() {
+        workflow_manager_->stop();
+        agent_manager_->stop_all_agents();
+        workflow_manager_.reset();
+        agent_manager_.reset();
+    }
+
+    void SetUp() override {
+        set_gate(false);
+        orchestrator_ = std::make_shared<WorkflowOrchestrator>(workflow_manager_);
+        orchestrator_->register_workflow(gated_workflow());
+        ASSERT_TRUE(orchestrator_->start());
+
+        HTTPServer::Config config;
+        config.io_model = HTTPServer::IoModel::EPOLL;
+        port_ = LoopbackClient::free_port();
+        server_ = std::make_unique<HTTPServer>(agent_manager_, workflow_manager_, orchestrator_,
+                                               "127.0.0.1", port_, config);
+        ASSERT_TRUE(server_->start());
+    }
+
+    void TearDown() override {
+        set_gate(true);
+        server_->stop();
+        orchestrator_->stop();
+    }
+
+    static void set_gate(bool open) {
+        {
+            std::lock_guard<std::mutex> lock(gate_mutex_);
+            gate_open_ = open;
+        }
+        gate_opened_.notify_all();
+    }
+
+    // first (waits at the gate) -> second
+    static WorkflowDefinition gated_workflow() {
+        WorkflowDefinition workflow("gated", "Gated", WorkflowType::SEQUENTIAL);
+        workflow.steps.emplace_back("first", "Worker", "gate", json{{"name", "first"}});
+        WorkflowStep second("second", "Worker", "gate", json{{"name", "second"}});
+        second.dependencies = {"first"};
+        workflow.steps.push_back(second);
+        return workflow;
+    }
+
+    static std::string events_request(const std::string& execution_id) {
+        return LoopbackClient::get("/workflow_executions/" + execution_id + "/events",
+                                   "Accept: text/event-stream\r\n");
+    }
+
+    std::shared_ptr<WorkflowExecution> wait_for_state(const std::string& execution_id,
+                                                      WorkflowExecutionState state) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (std::chrono::steady_clock::now() < deadline) {
+            auto execution = orchestrator_->get_execution_status(execution_id);
+            if (execution && execution->state == state) {
+                return execution;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return nullptr;
+    }
+};
+
+std::shared_ptr<AgentManager> ExecutionEventStreamTest::agent_manager_;
+std::shared_ptr<WorkflowManager> ExecutionEventStreamTest::workflow_manager_;
+std::mutex ExecutionEventStreamTest::gate_mutex_;
+std::condition_variable ExecutionEventStreamTest::gate_opened_;
+bool ExecutionEventStreamTest::gate_open_ = false;
+
+}  // namespace
+
+TEST_F(ExecutionEventStreamTest, StreamsEventsInOrderAndClosesAfterTheTerminalEvent) {
+    std::string execution_id = orchestrator_->execute_workflow_async("gated", json::object());
+    ASSERT_NE(wait_for_state(execution_id, WorkflowExecutionState::RUNNING), nullptr);
+
+    LoopbackClient client(port_);
+    ASSERT_TRUE(client.send(events_request(execution_id)));
+    // The body has no length; read_response() returns once the headers are in
+    LoopbackClient::Response response = client.read_response();
+    EXPECT_EQ(response.status, 200);
+    EXPECT_TRUE(response.has_header("Content-Type: text/event-stream"));
+    EXPECT_TRUE(response.has_header("Connection: close"));
+    // The snapshot goes out once the stream is subscribed
+    ASSERT_TRUE(client.read_until("event: snapshot"));
+    ASSERT_TRUE(client.read_until("\n\n"));
+    set_gate(true);
+
+    ASSERT_TRUE(client.read_until_closed());
+    std::vector<Event> events = parse_events(client.received());
+    ASSERT_FALSE(events.empty());
+    EXPECT_EQ(events.front().first, "snapshot");
+    EXPECT_EQ(events.front().second.value("execution_id", ""), execution_id);
+
+    size_t first_completed = find_event(events, "step_completed", "first");
+    size_t second_started = find_event(events, "step_started", "second");
+    size_t second_completed = find_event(events, "step_completed", "second");
+    size_t finished = find_event(events, "execution_finished");
+    ASSERT_LT(finished, events.size());
+    EXPECT_LT(first_completed, second_started);
+    EXPECT_LT(second_started, second_completed);
+    EXPECT_LT(second_completed, finished);
+    // Nothing follows the terminal event: the server closed the stream
+    EXPECT_EQ(finished, events.size() - 1);
+    EXPECT_EQ(events.back().second.value("state", -1), static_cast<int>(WorkflowExecutionState::COMPLETED));
+    for (const auto& [type, data] : events) {
+        EXPECT_EQ(data.value("execution_id", ""), execution_id) << type;
+    }
+}
+
+TEST_F(ExecutionEventStreamTest, FinishedExecutionGetsASnapshotAndAClosedStream) {
+    set_gate(true);
+    std::string execution_id = orchestrator_->execute_workflow_async("gated", json::object());
+    ASSERT_NE(wait_for_state(execution_id, WorkflowExecutionState::COMPLETED), nullptr);
+
+    LoopbackClient client(port_);
+    ASSERT_TRUE(client.send(events_request(execution_id)));
+    EXPECT_EQ(client.read_response().status, 200);
+    ASSERT_TRUE(client.read_until_closed());
+
+    std::vector<Event> events = parse_events(client.received());
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_EQ(events[0].first, "snapshot");
+    EXPECT_EQ(events[0].second.value("state", -1), static_cast<int>(WorkflowExecutionState::COMPLETED));
+}
+
+TEST_F(ExecutionEventStreamTest, UnknownExecutionIsNotFound) {
+    LoopbackClient client(port_);
+    ASSERT_TRUE(client.send(events_request("no-such-execution")));
+    LoopbackClient::Response response = client.read_response();
+    EXPECT_EQ(response.status, 404);
+}
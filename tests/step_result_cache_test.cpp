@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+#include "step_result_cache.hpp"
+
+#include <memory>
+#include <string>
+
+namespace {
+
+StepResultCache::Config enabled_config() {
+    StepResultCache::Config config;
+    config.enabled = true;
+    return config;
+}
+
+SharedJson value(const json& j) {
+    return std::make_shared<const json>(j);
+}
+
+}  // namespace
+
+TEST(StepResultCacheKeyTest, IgnoresObjectKeyOrder) {
+    json first = json::parse(R"({"query": "q", "limit": 5, "filter": {"lang": "en", "year": 2024}})");
+    json second = json::parse(R"({"filter": {"year": 2024, "lang": "en"}, "limit": 5, "query": "q"})");
+
+    EXPECT_EQ(StepResultCache::make_key("Agent", "search", "model", first),
+              StepResultCache::make_key("Agent", "search", "model", second));
+}
+
+TEST(StepResultCacheKeyTest, DistinguishesEveryPartOfTheCall) {
+    json params = {{"query", "q"}};
+    std::string key = StepResultCache::make_key("Agent", "search", "model", params);
+
+    EXPECT_NE(key, StepResultCache::make_key("Other", "search", "model", params));
+    EXPECT_NE(key, StepResultCache::make_key("Agent", "lookup", "model", params));
+    EXPECT_NE(key, StepResultCache::make_key("Agent", "search", "", params));
+    EXPECT_NE(key, StepResultCache::make_key("Agent", "search", "model", json{{"query", "r"}}));
+    // Array order is meaningful, unlike object key order
+    EXPECT_NE(StepResultCache::make_key("Agent", "search", "model", json{{"ids", {1, 2}}}),
+              StepResultCache::make_key("Agent", "search", "model", json{{"ids", {2, 1}}}));
+    // Fields never run into one another
+    EXPECT_NE(StepResultCache::make_key("ab", "c", "", params), StepResultCache::make_key("a", "bc", "", params));
+}
+
+TEST(StepResultCacheTest, DisabledCacheStoresNothing) {
+    StepResultCache cache;
+    EXPECT_FALSE(cache.enabled());
+
+    cache.insert("k", value(1));
+    SharedJson result;
+    EXPECT_FALSE(cache.lookup("k", result));
+
+    auto stats = cache.get_stats();
+    EXPECT_EQ(stats.entries, 0u);
+    EXPECT_EQ(stats.insertions, 0u);
+    EXPECT_EQ(stats.misses, 0u);
+}
+
+TEST(StepResultCacheTest, HitReturnsTheSharedValue) {
+    StepResultCache cache(enabled_config());
+    SharedJson stored = value({{"answer", 42}});
+    cache.insert("k", stored);
+
+    SharedJson result;
+    ASSERT_TRUE(cache.lookup("k", result));
+    EXPECT_EQ(result, stored);  // The same immutable value, not a copy
+    EXPECT_FALSE(cache.lookup("absent", result));
+
+    auto stats = cache.get_stats();
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.insertions, 1u);
+    EXPECT_EQ(stats.entries, 1u);
+    EXPECT_GT(stats.bytes, 0u);
+}
+
+TEST(StepResultCacheTest, ReinsertingAKeyReplacesTheEntry) {
+    StepResultCache cache(enabled_config());
+    cache.insert("k", value("old"));
+    size_t bytes_before = cache.get_stats().bytes;
+    cache.insert("k", value("newer"));
+
+    SharedJson result;
+    ASSERT_TRUE(cache.lookup("k", result));
+    EXPECT_EQ(*result, "newer");
+    auto stats = cache.get_stats();
+    EXPECT_EQ(stats.entries, 1u);
+    EXPECT_EQ(stats.bytes, bytes_before + 2);
+    EXPECT_EQ(stats.evictions, 0u);
+}
+
+TEST(StepResultCacheTest, ExpiredEntriesAreMisses) {
+    auto config = enabled_config();
+    config.ttl_seconds = 0;
+    StepResultCache cache(config);
+    cache.insert("k", value(1));
+
+    SharedJson result;
+    EXPECT_FALSE(cache.lookup("k", result));
+    auto stats = cache.get_stats();
+    EXPECT_EQ(stats.expirations, 1u);
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.entries, 0u);
+    EXPECT_EQ(stats.bytes, 0u);
+}
+
+TEST(StepResultCacheTest, EvictsTheLeastRecentlyUsedEntry) {
+    auto config = enabled_config();
+    config.max_entries = 2;
+    StepResultCache cache(config);
+    cache.insert("a", value(1));
+    cache.insert("b", value(2));
+
+    SharedJson result;
+    ASSERT_TRUE(cache.lookup("a", result));  // b is now the least recently used
+    cache.insert("c", value(3));
+
+    EXPECT_TRUE(cache.lookup("a", result));
+    EXPECT_FALSE(cache.lookup("b", result));
+    EXPECT_TRUE(cache.lookup("c", result));
+    auto stats = cache.get_stats();
+    EXPECT_EQ(stats.evictions, 1u);
+    EXPECT_EQ(stats.entries, 2u);
+}
+
+TEST(StepResultCacheTest, EvictsToStayWithinMaxBytes) {
+    std::string payload(100, 'x');
+    size_t entry_bytes = 1 + json(payload).dump().size();
+
+    auto config = enabled_config();
+    config.max_bytes = 2 * entry_bytes;
+    StepResultCache cache(config);
+    cache.insert("a", value(payload));
+    cache.insert("b", value(payload));
+    cache.insert("c", value(payload));
+
+    SharedJson result;
+    EXPECT_FALSE(cache.lookup("a", result));
+    EXPECT_TRUE(cache.lookup("b", result));
+    EXPECT_TRUE(cache.lookup("c", result));
+    EXPECT_EQ(cache.get_stats().bytes, 2 * entry_bytes);
+    EXPECT_EQ(cache.get_stats().evictions, 1u);
+
+    // A result larger than the whole cache is not stored and evicts nothing
+    cache.insert("huge", value(std::string(3 * entry_bytes, 'y')));
+    EXPECT_FALSE(cache.lookup("huge", result));
+    EXPECT_EQ(cache.get_stats().entries, 2u);
+}
+
+TEST(StepResultCacheTest, ShrinkingTheLimitsEvictsAndDisablingEmpties) {
+    StepResultCache cache(enabled_config());
+    for (int i = 0; i < 5; ++i) {
+        cache.insert("k" + std::to_string(i), value(i));
+    }
+
+    auto config = enabled_config();
+    config.max_entries = 3;
+    cache.set_config(config);
+    EXPECT_EQ(cache.get_stats().entries, 3u);
+    EXPECT_EQ(cache.get_stats().evictions, 2u);
+
+    SharedJson result;
+    EXPECT_FALSE(cache.lookup("k0", result));
+    EXPECT_TRUE(cache.lookup("k4", result));
+
+    config.enabled = false;
+    cache.set_config(config);
+    auto stats = cache.get_stats();
+    EXPECT_EQ(stats.entries, 0u);
+    EXPECT_EQ(stats.bytes, 0u);
+}
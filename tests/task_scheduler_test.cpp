@@ -0,0 +1,370 @@
+#include <gtest/gtest.h>
+#include "task_scheduler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Priority = TaskScheduler::Priority;
+
+// Holds tasks until the test opens it
+class Gate {
+public:
+    void open() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            open_ = true;
+        }
+        condition_.notify_all();
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        condition_.wait(lock, [this] { return open_; });
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    bool open_ = false;
+};
+
+// Execution order shared by the tasks of a test
+class Trace {
+public:
+    void add(const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        names_.push_back(name);
+    }
+
+    std::vector<std::string> names() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return names_;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<std::string> names_;
+};
+
+// For state that settles asynchronously, such as a spare thread retiring
+bool eventually(const std::function<bool()>& condition,
+                std::chrono::milliseconds timeout = std::chrono::milliseconds(5000)) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return true;
+}
+
+TaskScheduler::Config single_worker(size_t max_blocking_threads = 0) {
+    TaskScheduler::Config config;
+    config.worker_threads = 1;
+    config.max_blocking_threads = max_blocking_threads;
+    config.spare_idle_timeout_ms = 50;
+    return config;
+}
+
+// Occupies the scheduler's only worker until the gate opens
+void occupy_worker(TaskScheduler& scheduler, Gate& gate) {
+    std::promise<void> started;
+    scheduler.submit([&gate, &started] {
+        started.set_value();
+        gate.wait();
+    }, Priority::INTERACTIVE);
+    started.get_future().wait();
+}
+
+}  // namespace
+
+TEST(TaskSchedulerTest, HigherPriorityLanesRunFirst) {
+    TaskScheduler scheduler(single_worker());
+    Gate gate;
+    Trace trace;
+    occupy_worker(scheduler, gate);
+
+    scheduler.submit([&trace] { trace.add("batch-1"); }, Priority::BATCH);
+    scheduler.submit([&trace] { trace.add("normal-1"); }, Priority::NORMAL);
+    scheduler.submit([&trace] { trace.add("interactive-1"); }, Priority::INTERACTIVE);
+    scheduler.submit([&trace] { trace.add("batch-2"); }, Priority::BATCH);
+    scheduler.submit([&trace] { trace.add("interactive-2"); }, Priority::INTERACTIVE);
+    EXPECT_EQ(scheduler.get_stats().injection_depth, 5u);
+
+    gate.open();
+    scheduler.shutdown();
+
+    // Lane by lane, FIFO within a lane for tasks submitted from outside
+    std::vector<std::string> expected = {"interactive-1", "interactive-2", "normal-1", "batch-1", "batch-2"};
+    EXPECT_EQ(trace.names(), expected);
+
+    auto stats = scheduler.get_stats();
+    EXPECT_EQ(stats.executed[0], 3u);
+    EXPECT_EQ(stats.executed[1], 1u);
+    EXPECT_EQ(stats.executed[2], 2u);
+}
+
+TEST(TaskSchedulerTest, WorkerRunsItsOwnSubmissionsNewestFirst) {
+    TaskScheduler scheduler(single_worker());
+    Trace trace;
+
+    auto parent = scheduler.submit_future([&scheduler, &trace] {
+        for (const char* name : {"a", "b", "c"}) {
+            scheduler.submit([&trace, name] { trace.add(name); }, Priority::NORMAL);
+        }
+        return scheduler.get_stats().worker_depths.front();
+    }, Priority::NORMAL);
+    EXPECT_EQ(parent.get(), 3u);
+    scheduler.shutdown();
+
+    std::vector<std::string> expected = {"c", "b", "a"};
+    EXPECT_EQ(trace.names(), expected);
+    EXPECT_EQ(scheduler.get_stats().steals, 0u);
+}
+
+TEST(TaskSchedulerTest, IdleWorkerStealsFromABusyWorker) {
+    TaskScheduler::Config config;
+    config.worker_threads = 2;
+    config.max_blocking_threads = 0;
+    TaskScheduler scheduler(config);
+
+    constexpr int CHILDREN = 8;
+    std::atomic<int> children_run{0};
+    std::promise<void> all_run;
+
+    // The parent keeps its worker busy until the children have run, so every
+    // one of them must be taken from its deque by the other worker
+    auto parent = scheduler.submit_future([&] {
+        for (int i = 0; i < CHILDREN; ++i) {
+            scheduler.submit([&] {
+                if (++children_run == CHILDREN) {
+                    all_run.set_value();
+                }
+            }, Priority::BATCH);
+        }
+        return all_run.get_future().wait_for(std::chrono::seconds(5)) == std::future_status::ready;
+    }, Priority::BATCH);
+
+    EXPECT_TRUE(parent.get());
+    EXPECT_EQ(children_run.load(), CHILDREN);
+    EXPECT_EQ(scheduler.get_stats().steals, static_cast<uint64_t>(CHILDREN));
+}
+
+TEST(TaskSchedulerTest, SubmitFutureDeliversResultsAndExceptions) {
+    TaskScheduler scheduler(single_worker());
+
+    auto value = scheduler.submit_future([] { return 42; });
+    auto failure = scheduler.submit_future([]() -> int { throw std::runtime_error("task failed"); });
+
+    EXPECT_EQ(value.get(), 42);
+    EXPECT_THROW(failure.get(), std::runtime_error);
+}
+
+TEST(TaskSchedulerTest, ExceptionsEscapingATaskDoNotStopTheWorker) {
+    TaskScheduler scheduler(single_worker());
+    scheduler.submit([] { throw std::runtime_error("ignored"); });
+    EXPECT_EQ(scheduler.submit_future([] { return 7; }).get(), 7);
+}
+
+TEST(TaskSchedulerTest, BlockedWorkerIsCoveredByASpareThatLaterRetires) {
+    TaskScheduler scheduler(single_worker(4));
+    Gate gate;
+
+    std::promise<void> blocked;
+    scheduler.submit([&] {
+        TaskScheduler::BlockingScope blocking;
+        blocked.set_value();
+        gate.wait();
+    });
+    blocked.get_future().wait();
+
+    // Runs on the spare while the only core worker is blocked
+    auto covered = scheduler.submit_future([] { return true; });
+    ASSERT_EQ(covered.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+
+    auto stats = scheduler.get_stats();
+    EXPECT_EQ(stats.spares_started, 1u);
+    EXPECT_EQ(stats.spare_workers, 1u);
+    EXPECT_EQ(stats.blocked_workers, 1u);
+
+    gate.open();
+    EXPECT_TRUE(eventually([&] { return scheduler.get_stats().blocked_workers == 0; }));
+
+    // Idle longer than spare_idle_timeout_ms: the spare exits, the core worker stays
+    EXPECT_TRUE(eventually([&] { return scheduler.get_stats().spare_workers == 0; }));
+    stats = scheduler.get_stats();
+    EXPECT_EQ(stats.workers, 1u);
+    EXPECT_EQ(stats.worker_depths.size(), 1u);
+    EXPECT_EQ(scheduler.submit_future([] { return 1; }).get(), 1);
+}
+
+TEST(TaskSchedulerTest, SpareThreadsAreCappedAtMaxBlockingThreads) {
+    TaskScheduler scheduler(single_worker(1));
+    Gate gate;
+    std::atomic<int> blocked{0};
+
+    // The first blocks the core worker, the second the only spare
+    for (int i = 0; i < 2; ++i) {
+        scheduler.submit([&] {
+            TaskScheduler::BlockingScope blocking;
+            blocked++;
+            gate.wait();
+        });
+    }
+    ASSERT_TRUE(eventually([&] { return blocked.load() == 2; }));
+
+    std::atomic<bool> third_ran{false};
+    scheduler.submit([&] { third_ran = true; });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(third_ran.load());
+
+    auto stats = scheduler.get_stats();
+    EXPECT_EQ(stats.spares_started, 1u);
+    EXPECT_EQ(stats.blocked_workers, 2u);
+    EXPECT_EQ(stats.queued[static_cast<size_t>(Priority::NORMAL)], 1u);
+
+    gate.open();
+    EXPECT_TRUE(eventually([&] { return third_ran.load(); }));
+}
+
+TEST(TaskSchedulerTest, NestedBlockingScopesCountOnce) {
+    TaskScheduler scheduler(single_worker(4));
+    auto blocked = scheduler.submit_future([&scheduler] {
+        TaskScheduler::BlockingScope outer;
+        TaskScheduler::BlockingScope inner;
+        return scheduler.get_stats().blocked_workers;
+    });
+    EXPECT_EQ(blocked.get(), 1u);
+    EXPECT_TRUE(eventually([&] { return scheduler.get_stats().blocked_workers == 0; }));
+
+    // Outside a worker the scope does nothing
+    TaskScheduler::BlockingScope outside;
+    EXPECT_EQ(scheduler.get_stats().blocked_workers, 0u);
+}
+
+TEST(TaskSchedulerTest, TasksSubmittedAfterShutdownRunInline) {
+    TaskScheduler scheduler(single_worker());
+    scheduler.shutdown();
+
+    const auto caller = std::this_thread::get_id();
+    std::thread::id ran_on;
+    scheduler.submit([&ran_on] { ran_on = std::this_thread::get_id(); });
+    EXPECT_EQ(ran_on, caller);
+}
+
+TEST(TaskGroupTest, NeverRunsMoreThanMaxConcurrencyTasks) {
+    TaskScheduler::Config config;
+    config.worker_threads = 4;
+    config.max_blocking_threads = 0;
+    TaskScheduler scheduler(config);
+    TaskGroup group(scheduler, Priority::BATCH, 2);
+
+    Gate gate;
+    std::atomic<int> running{0};
+    std::atomic<int> peak{0};
+    std::atomic<int> completed{0};
+    for (int i = 0; i < 6; ++i) {
+        group.submit([&] {
+            int now = ++running;
+            int previous = peak.load();
+            while (now > previous && !peak.compare_exchange_weak(previous, now)) {
+            }
+            gate.wait();
+            running--;
+            completed++;
+        });
+    }
+
+    // Two of the four workers pick tasks up; the others stay idle
+    ASSERT_TRUE(eventually([&] { return running.load() == 2; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(running.load(), 2);
+    EXPECT_EQ(group.running(), 2u);
+    EXPECT_EQ(group.queued(), 4u);
+
+    gate.open();
+    group.wait();
+    EXPECT_EQ(completed.load(), 6);
+    EXPECT_EQ(peak.load(), 2);
+    EXPECT_EQ(group.running(), 0u);
+    EXPECT_EQ(group.queued(), 0u);
+}
+
+TEST(TaskGroupTest, RunsTasksInSubmissionOrder) {
+    TaskScheduler::Config config;
+    config.worker_threads = 4;
+    TaskScheduler scheduler(config);
+    TaskGroup group(scheduler, Priority::NORMAL, 1);
+
+    Trace trace;
+    for (int i = 0; i < 10; ++i) {
+        group.submit([&trace, i] { trace.add(std::to_string(i)); });
+    }
+    group.wait();
+
+    std::vector<std::string> expected;
+    for (int i = 0; i < 10; ++i) {
+        expected.push_back(std::to_string(i));
+    }
+    EXPECT_EQ(trace.names(), expected);
+}
+
+TEST(TaskGroupTest, RaisingMaxConcurrencyStartsQueuedTasks) {
+    TaskScheduler::Config config;
+    config.worker_threads = 4;
+    config.max_blocking_threads = 0;
+    TaskScheduler scheduler(config);
+    TaskGroup group(scheduler, Priority::NORMAL, 1);
+
+    Gate gate;
+    std::atomic<int> running{0};
+    for (int i = 0; i < 3; ++i) {
+        group.submit([&] {
+            running++;
+            gate.wait();
+        });
+    }
+    ASSERT_TRUE(eventually([&] { return running.load() == 1; }));
+    EXPECT_EQ(group.queued(), 2u);
+
+    group.set_max_concurrency(3);
+    EXPECT_EQ(group.max_concurrency(), 3u);
+    EXPECT_TRUE(eventually([&] { return running.load() == 3; }));
+
+    gate.open();
+    group.wait();
+}
+
+TEST(TaskGroupTest, WaitReturnsOnlyOnceEveryTaskHasFinished) {
+    TaskScheduler::Config config;
+    config.worker_threads = 2;
+    TaskScheduler scheduler(config);
+    std::atomic<int> completed{0};
+    {
+        TaskGroup group(scheduler, Priority::BATCH);  // Unbounded
+        for (int i = 0; i < 20; ++i) {
+            group.submit([&completed] {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                completed++;
+            });
+        }
+        group.wait();
+        EXPECT_EQ(completed.load(), 20);
+
+        group.submit([&completed] { completed++; });
+        // The destructor drains the rest
+    }
+    EXPECT_EQ(completed.load(), 21);
+}
@@ -0,0 +1,223 @@
+#include <gtest/gtest.h>
+#include "vector_index.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace kolosal;
+
+namespace {
+
+std::vector<float> random_vector(std::mt19937& random, size_t dimension) {
+    std::normal_distribution<float> distribution(0.0f, 1.0f);
+    std::vector<float> vector(dimension);
+    for (auto& value : vector) {
+        value = distribution(random);
+    }
+    return vector;
+}
+
+// Zero-padded, aligned copy in the layout the kernels expect
+vector_kernels::AlignedFloats padded(const std::vector<float>& vector) {
+    vector_kernels::AlignedFloats out(vector_kernels::padded_dimension(vector.size()), 0.0f);
+    std::copy(vector.begin(), vector.end(), out.begin());
+    return out;
+}
+
+double reference_dot(const float* a, const float* b, size_t n) {
+    double sum = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        sum += static_cast<double>(a[i]) * b[i];
+    }
+    return sum;
+}
+
+double reference_magnitude(const float* a, size_t n) {
+    return std::sqrt(reference_dot(a, a, n));
+}
+
+// Single precision accumulates in a different order per kernel; allow for
+// rounding relative to the size of the terms rather than of the result
+double tolerance(const float* a, const float* b, size_t n) {
+    double terms = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        terms += std::abs(static_cast<double>(a[i]) * b[i]);
+    }
+    return 1e-5 * terms + 1e-6;
+}
+
+std::vector<IVectorIndex::Hit> brute_force(const std::vector<std::string>& ids,
+                                           const std::vector<std::vector<float>>& vectors,
+                                           const std::vector<float>& query, size_t k) {
+    std::vector<IVectorIndex::Hit> hits;
+    double query_magnitude = reference_magnitude(query.data(), query.size());
+    for (size_t i = 0; i < vectors.size(); ++i) {
+        double score = reference_dot(vectors[i].data(), query.data(), query.size()) /
+                       (reference_magnitude(vectors[i].data(), vectors[i].size()) * query_magnitude);
+        hits.push_back({ids[i], static_cast<float>(score)});
+    }
+    std::sort(hits.begin(), hits.end(), [](const auto& a, const auto& b) { return a.score > b.score; });
+    hits.resize(std::min(k, hits.size()));
+    return hits;
+}
+
+}  // namespace
+
+TEST(VectorKernelsTest, ListsScalarLastAndActiveFirst) {
+    auto kernels = vector_kernels::supported_kernels();
+    ASSERT_FALSE(kernels.empty());
+    EXPECT_STREQ(kernels.back().name, "scalar");
+    EXPECT_STREQ(kernels.front().name, vector_kernels::active_kernel());
+    EXPECT_EQ(kernels.front().dot, vector_kernels::dot_product());
+    EXPECT_EQ(kernels.front().code_dot, vector_kernels::code_dot_product());
+}
+
+TEST(VectorKernelsTest, DotProductMatchesTheReference) {
+    std::mt19937 random(7);
+    for (size_t dimension : {1, 3, 15, 16, 17, 100, 384, 768, 1000, 1536}) {
+        auto a = padded(random_vector(random, dimension));
+        auto b = padded(random_vector(random, dimension));
+        double expected = reference_dot(a.data(), b.data(), a.size());
+        double allowed = tolerance(a.data(), b.data(), a.size());
+        for (const auto& kernel : vector_kernels::supported_kernels()) {
+            EXPECT_NEAR(kernel.dot(a.data(), b.data(), a.size()), expected, allowed)
+                << kernel.name << ", dimension " << dimension;
+        }
+    }
+}
+
+TEST(VectorKernelsTest, CodeDotProductMatchesTheReference) {
+    std::mt19937 random(11);
+    std::uniform_int_distribution<int> byte(0, 255);
+    for (size_t dimension : {1, 16, 31, 128, 384, 1000}) {
+        auto weights = padded(random_vector(random, dimension));
+        std::vector<uint8_t> codes(weights.size(), 0);
+        std::vector<float> widened(weights.size(), 0.0f);
+        for (size_t i = 0; i < dimension; ++i) {
+            codes[i] = static_cast<uint8_t>(byte(random));
+            widened[i] = codes[i];
+        }
+        double expected = reference_dot(weights.data(), widened.data(), weights.size());
+        double allowed = tolerance(weights.data(), widened.data(), weights.size());
+        for (const auto& kernel : vector_kernels::supported_kernels()) {
+            EXPECT_NEAR(kernel.code_dot(weights.data(), codes.data(), weights.size()), expected, allowed)
+                << kernel.name << ", dimension " << dimension;
+        }
+    }
+}
+
+TEST(VectorKernelsTest, ExtremeCodesWidenWithoutSignExtension) {
+    vector_kernels::AlignedFloats weights(32, 1.0f);
+    std::vector<uint8_t> codes(32, 255);
+    for (const auto& kernel : vector_kernels::supported_kernels()) {
+        EXPECT_FLOAT_EQ(kernel.code_dot(weights.data(), codes.data(), codes.size()), 32 * 255.0f) << kernel.name;
+    }
+}
+
+TEST(VectorKernelsTest, NormalizeIntoScalesToUnitLengthAndZeroesThePadding) {
+    std::vector<float> vector = {3.0f, 4.0f, 0.0f};
+    std::vector<float> out(vector_kernels::padded_dimension(vector.size()), 99.0f);
+    vector_kernels::normalize_into(vector.data(), vector.size(), out.data());
+
+    EXPECT_EQ(out.size(), vector_kernels::LANES);
+    EXPECT_FLOAT_EQ(out[0], 0.6f);
+    EXPECT_FLOAT_EQ(out[1], 0.8f);
+    for (size_t i = 2; i < out.size(); ++i) {
+        EXPECT_EQ(out[i], 0.0f);
+    }
+
+    std::vector<float> zero(5, 0.0f);
+    vector_kernels::normalize_into(zero.data(), zero.size(), out.data());
+    for (float value : out) {
+        EXPECT_EQ(value, 0.0f);
+    }
+}
+
+TEST(VectorKernelsTest, AlignedStorageIsAligned) {
+    for (size_t count : {1, 7, 16, 1000}) {
+        vector_kernels::AlignedFloats floats(count);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(floats.data()) % vector_kernels::ALIGNMENT, 0u);
+    }
+}
+
+TEST(FlatVectorIndexTest, SearchMatchesBruteForce) {
+    const size_t dimension = 100, count = 500, k = 10;
+    std::mt19937 random(42);
+    std::vector<std::string> ids;
+    std::vector<std::vector<float>> vectors;
+    FlatVectorIndex index;
+    for (size_t i = 0; i < count; ++i) {
+        ids.push_back("doc-" + std::to_string(i));
+        vectors.push_back(random_vector(random, dimension));
+        ASSERT_TRUE(index.add(ids.back(), vectors.back()));
+    }
+    EXPECT_EQ(index.size(), count);
+    EXPECT_EQ(index.dimension(), dimension);
+
+    for (int q = 0; q < 20; ++q) {
+        auto query = random_vector(random, dimension);
+        auto expected = brute_force(ids, vectors, query, k);
+        auto hits = index.search(query, k, -1.0f);
+        ASSERT_EQ(hits.size(), k);
+        for (size_t i = 0; i < k; ++i) {
+            EXPECT_EQ(hits[i].id, expected[i].id) << "query " << q << ", rank " << i;
+            EXPECT_NEAR(hits[i].score, expected[i].score, 1e-5);
+        }
+    }
+}
+
+TEST(FlatVectorIndexTest, ThresholdAndKBoundTheHits) {
+    FlatVectorIndex index(2);
+    index.add("east", {1.0f, 0.0f});
+    index.add("north_east", {1.0f, 1.0f});
+    index.add("north", {0.0f, 1.0f});
+    index.add("west", {-1.0f, 0.0f});
+
+    auto hits = index.search({2.0f, 0.0f}, 10, 0.5f);
+    ASSERT_EQ(hits.size(), 2u);
+    EXPECT_EQ(hits[0].id, "east");
+    EXPECT_NEAR(hits[0].score, 1.0f, 1e-6);
+    EXPECT_EQ(hits[1].id, "north_east");
+    EXPECT_NEAR(hits[1].score, std::sqrt(0.5f), 1e-6);
+
+    EXPECT_EQ(index.search({2.0f, 0.0f}, 1, -1.0f).size(), 1u);
+    EXPECT_TRUE(index.search({2.0f, 0.0f}, 0, -1.0f).empty());
+    EXPECT_TRUE(index.search({1.0f, 0.0f, 0.0f}, 10, -1.0f).empty());  // Wrong dimension
+}
+
+TEST(FlatVectorIndexTest, AddReplacesAndRemoveKeepsTheRestSearchable) {
+    FlatVectorIndex index;
+    EXPECT_FALSE(index.add("empty", {}));
+    ASSERT_TRUE(index.add("a", {1.0f, 0.0f, 0.0f}));
+    EXPECT_EQ(index.dimension(), 3u);
+    EXPECT_FALSE(index.add("short", {1.0f, 0.0f}));
+    index.add("b", {0.0f, 1.0f, 0.0f});
+    index.add("c", {0.0f, 0.0f, 1.0f});
+
+    // Replacing a vector keeps one entry under the id
+    index.add("a", {0.0f, 0.0f, 1.0f});
+    EXPECT_EQ(index.size(), 3u);
+    EXPECT_NEAR(index.search({0.0f, 0.0f, 1.0f}, 1, 0.0f).front().score, 1.0f, 1e-6);
+
+    // Removing a row moves the last one into its place
+    EXPECT_TRUE(index.remove("a"));
+    EXPECT_FALSE(index.remove("a"));
+    EXPECT_FALSE(index.contains("a"));
+    EXPECT_EQ(index.size(), 2u);
+    auto hits = index.search({0.0f, 0.0f, 1.0f}, 1, 0.5f);
+    ASSERT_EQ(hits.size(), 1u);
+    EXPECT_EQ(hits[0].id, "c");
+    EXPECT_EQ(index.search({0.0f, 1.0f, 0.0f}, 1, 0.5f).front().id, "b");
+}
+
+TEST(FlatVectorIndexTest, ZeroVectorScoresZero) {
+    FlatVectorIndex index(4);
+    index.add("zero", {0.0f, 0.0f, 0.0f, 0.0f});
+    auto hits = index.search({1.0f, 2.0f, 3.0f, 4.0f}, 1, -1.0f);
+    ASSERT_EQ(hits.size(), 1u);
+    EXPECT_EQ(hits[0].score, 0.0f);
+}
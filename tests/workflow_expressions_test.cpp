@@ -0,0 +1,334 @@
+#include <gtest/gtest.h>
+#include "workflow_expressions.hpp"
+
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+json make_context() {
+    return json{
+        {"input", {{"query", "quantum computing"}, {"depth", 2}}},
+        {"query", "quantum computing"},
+        {"language", "en"},
+        {"dotted.key", "flat value"},
+        {"search_output", {
+            {"result", {{"text", "Findings"}, {"confidence", 0.75}, {"tags", {"physics", "computing"}}}},
+            {"sources", json::array({{{"url", "https://a.example"}}, {{"url", "https://b.example"}}})}
+        }}
+    };
+}
+
+// The former WorkflowOrchestrator::resolve_parameters, which re-interpreted
+// the parameters on every call and only knew top-level context keys
+json uncompiled_resolve(const json& parameters, const json& context) {
+    json resolved = parameters;
+    std::function<void(json&)> resolve_recursive = [&](json& obj) {
+        if (obj.is_string()) {
+            std::string str = obj;
+            size_t start = str.find("{{");
+            while (start != std::string::npos) {
+                size_t end = str.find("}}", start);
+                if (end != std::string::npos) {
+                    std::string field = str.substr(start + 2, end - start - 2);
+                    if (context.contains(field)) {
+                        std::string replacement = context[field].is_string() ?
+                                                context[field].get<std::string>() :
+                                                context[field].dump();
+                        str.replace(start, end - start + 2, replacement);
+                    }
+                }
+                start = str.find("{{", start + 1);
+            }
+            obj = str;
+        } else if (obj.is_object()) {
+            for (auto& [key, value] : obj.items()) {
+                resolve_recursive(value);
+            }
+        } else if (obj.is_array()) {
+            for (auto& item : obj) {
+                resolve_recursive(item);
+            }
+        }
+    };
+    resolve_recursive(resolved);
+    return resolved;
+}
+
+// The former WorkflowOrchestrator::evaluate_condition
+bool uncompiled_evaluate(const json& condition, const json& context) {
+    if (condition.is_null() || condition.empty()) {
+        return true;
+    }
+    if (condition.contains("and") || condition.contains("or")) {
+        if (condition.contains("and") && condition["and"].is_array()) {
+            for (const auto& sub_condition : condition["and"]) {
+                if (!uncompiled_evaluate(sub_condition, context)) return false;
+            }
+            return true;
+        }
+        if (condition.contains("or") && condition["or"].is_array()) {
+            for (const auto& sub_condition : condition["or"]) {
+                if (uncompiled_evaluate(sub_condition, context)) return true;
+            }
+            return false;
+        }
+        return true;
+    }
+    if (condition.contains("field") && condition.contains("operator") && condition.contains("value")) {
+        std::string field = condition["field"];
+        std::string op = condition["operator"];
+        json expected_value = condition["value"];
+
+        std::istringstream field_stream(field);
+        std::string field_part;
+        json current_context = context;
+        while (std::getline(field_stream, field_part, '.')) {
+            if (current_context.is_object() && current_context.contains(field_part)) {
+                current_context = current_context[field_part];
+            } else {
+                return false;
+            }
+        }
+        json actual_value = current_context;
+
+        if (op == "equals") return actual_value == expected_value;
+        if (op == "not_equals") return actual_value != expected_value;
+        if (op == "exists") return true;
+        if (op == "contains" && actual_value.is_string() && expected_value.is_string()) {
+            return actual_value.get<std::string>().find(expected_value.get<std::string>()) != std::string::npos;
+        }
+        if (op == "greater_than" && actual_value.is_number() && expected_value.is_number()) {
+            return actual_value.get<double>() > expected_value.get<double>();
+        }
+        if (op == "less_than" && actual_value.is_number() && expected_value.is_number()) {
+            return actual_value.get<double>() < expected_value.get<double>();
+        }
+    }
+    return true;
+}
+
+json field(const std::string& path, const std::string& op, const json& value) {
+    return json{{"field", path}, {"operator", op}, {"value", value}};
+}
+
+}  // namespace
+
+TEST(ContextPathTest, WalksNestedObjects) {
+    json context = make_context();
+    const json* value = ContextPath("search_output.result.text").find(context);
+    ASSERT_NE(value, nullptr);
+    EXPECT_EQ(*value, "Findings");
+    EXPECT_EQ(*ContextPath("input.depth").find(context), 2);
+    EXPECT_EQ(*ContextPath("input").find(context), context["input"]);
+}
+
+TEST(ContextPathTest, IndexesArrays) {
+    json context = make_context();
+    EXPECT_EQ(*ContextPath("search_output.sources.1.url").find(context), "https://b.example");
+    EXPECT_EQ(*ContextPath("search_output.result.tags.0").find(context), "physics");
+    EXPECT_EQ(ContextPath("search_output.sources.2.url").find(context), nullptr);
+    EXPECT_EQ(ContextPath("search_output.sources.first").find(context), nullptr);
+    // A numeric part is an object key when the value is an object
+    json numbered = {{"by_year", {{"2024", "yes"}}}};
+    EXPECT_EQ(*ContextPath("by_year.2024").find(numbered), "yes");
+}
+
+TEST(ContextPathTest, MissingKeysResolveToNothing) {
+    json context = make_context();
+    EXPECT_EQ(ContextPath("absent").find(context), nullptr);
+    EXPECT_EQ(ContextPath("absent.deeper").find(context), nullptr);
+    EXPECT_EQ(ContextPath("search_output.result.missing").find(context), nullptr);
+    EXPECT_EQ(ContextPath("query.length").find(context), nullptr);  // Into a string
+    EXPECT_EQ(ContextPath("").find(context), nullptr);
+    EXPECT_EQ(ContextPath("query").find(json("not an object")), nullptr);
+}
+
+TEST(ContextPathTest, PrefersATopLevelKeyContainingDots) {
+    json context = make_context();
+    EXPECT_EQ(*ContextPath("dotted.key").find(context), "flat value");
+}
+
+TEST(ContextViewTest, StepOutputsShadowContextEntries) {
+    json context = {{"fetch_output", "stale"}, {"query", "q"}};
+    StepOutputMap outputs = {{"fetch", std::make_shared<const json>(json{{"items", {1, 2, 3}}})}};
+    ContextView view(context, &outputs);
+
+    EXPECT_EQ(*ContextPath("fetch_output.items.2").find(view), 3);
+    EXPECT_EQ(*ContextPath("query").find(view), "q");
+    EXPECT_EQ(ContextPath("other_output").find(view), nullptr);
+
+    json merged = view.to_json();
+    EXPECT_EQ(merged["fetch_output"], (json{{"items", {1, 2, 3}}}));
+    EXPECT_EQ(merged["query"], "q");
+}
+
+TEST(ContextViewTest, BindingsLayerOverTheParent) {
+    json context = {{"item", "outer"}, {"query", "q"}};
+    ContextView parent(context);
+    json bindings = {{"item", {{"id", 7}}}};
+    ContextView view(bindings, parent);
+
+    EXPECT_EQ(*ContextPath("item.id").find(view), 7);
+    EXPECT_EQ(*ContextPath("query").find(view), "q");
+    EXPECT_EQ(view.to_json(), (json{{"item", {{"id", 7}}}, {"query", "q"}}));
+}
+
+TEST(ParameterTemplateTest, SubstitutesReferencesInNestedValues) {
+    ParameterTemplate parameters(json{
+        {"prompt", "Summarise {{search_output.result.text}} in {{ language }}"},
+        {"options", {{"depth", "{{input.depth}}"}, {"urls", {"{{search_output.sources.0.url}}", "fixed"}}}},
+        {"limit", 5}
+    });
+    EXPECT_TRUE(parameters.has_references());
+
+    json resolved = parameters.resolve(make_context());
+    EXPECT_EQ(resolved["prompt"], "Summarise Findings in en");
+    EXPECT_EQ(resolved["options"]["depth"], "2");  // Non-string values as JSON text
+    EXPECT_EQ(resolved["options"]["urls"], (json{"https://a.example", "fixed"}));
+    EXPECT_EQ(resolved["limit"], 5);
+}
+
+TEST(ParameterTemplateTest, LeavesUnresolvedReferencesAsWritten) {
+    ParameterTemplate parameters(json{
+        {"missing", "before {{absent.path}} after"},
+        {"out_of_range", "{{search_output.sources.9.url}}"},
+        {"unterminated", "{{query"}
+    });
+    json resolved = parameters.resolve(make_context());
+    EXPECT_EQ(resolved["missing"], "before {{absent.path}} after");
+    EXPECT_EQ(resolved["out_of_range"], "{{search_output.sources.9.url}}");
+    EXPECT_EQ(resolved["unterminated"], "{{query");
+}
+
+TEST(ParameterTemplateTest, ParametersWithoutReferencesAreLiteral) {
+    json literal = {{"a", {1, 2}}, {"b", "plain"}, {"c", {{"d", nullptr}}}};
+    ParameterTemplate parameters(literal);
+    EXPECT_FALSE(parameters.has_references());
+    EXPECT_EQ(parameters.resolve(json::object()), literal);
+}
+
+TEST(ParameterTemplateTest, OneTemplateResolvesAgainstManyContexts) {
+    ParameterTemplate parameters(json{{"text", "{{item.name}}: {{item.score}}"}});
+    for (int i = 0; i < 3; ++i) {
+        json context = {{"item", {{"name", "n" + std::to_string(i)}, {"score", i}}}};
+        EXPECT_EQ(parameters.resolve(context)["text"], "n" + std::to_string(i) + ": " + std::to_string(i));
+    }
+}
+
+TEST(ParameterTemplateTest, MatchesUncompiledResolutionOfTopLevelReferences) {
+    json context = make_context();
+    std::vector<json> cases = {
+        json{{"q", "{{query}}"}},
+        json{{"q", "Query: {{query}} ({{language}})"}, {"n", 3}},
+        json{{"nested", {{"list", {"{{query}}", "{{input}}", 1.5}}}}},
+        json{{"missing", "{{absent}} and {{query}}"}},
+        json{{"flat", "{{dotted.key}}"}},
+        json{{"none", "no references"}, {"empty", ""}, {"null", nullptr}},
+    };
+    for (const auto& parameters : cases) {
+        EXPECT_EQ(ParameterTemplate(parameters).resolve(context), uncompiled_resolve(parameters, context))
+            << parameters.dump();
+    }
+}
+
+TEST(ConditionExpressionTest, ComparesFieldsByOperator) {
+    json context = make_context();
+    EXPECT_TRUE(ConditionExpression(field("language", "equals", "en")).evaluate(context));
+    EXPECT_FALSE(ConditionExpression(field("language", "not_equals", "en")).evaluate(context));
+    EXPECT_TRUE(ConditionExpression(field("search_output.result.text", "contains", "Find")).evaluate(context));
+    EXPECT_TRUE(ConditionExpression(field("search_output.result.confidence", "greater_than", 0.5)).evaluate(context));
+    EXPECT_FALSE(ConditionExpression(field("search_output.result.confidence", "less_than", 0.5)).evaluate(context));
+    EXPECT_TRUE(ConditionExpression(field("input.depth", "greater_equal", 2)).evaluate(context));
+    EXPECT_TRUE(ConditionExpression(field("input.depth", "less_equal", 2)).evaluate(context));
+    EXPECT_TRUE(ConditionExpression(field("search_output.sources.1.url", "equals", "https://b.example")).evaluate(context));
+    EXPECT_TRUE(ConditionExpression(json{{"field", "query"}, {"operator", "exists"}}).evaluate(context));
+}
+
+TEST(ConditionExpressionTest, MissingFieldsAreFalse) {
+    json context = make_context();
+    EXPECT_FALSE(ConditionExpression(field("absent", "not_equals", "x")).evaluate(context));
+    EXPECT_FALSE(ConditionExpression(json{{"field", "input.absent"}, {"operator", "exists"}}).evaluate(context));
+    EXPECT_FALSE(ConditionExpression(field("search_output.sources.5.url", "exists", true)).evaluate(context));
+}
+
+TEST(ConditionExpressionTest, CombinesConditions) {
+    json context = make_context();
+    json english = field("language", "equals", "en");
+    json french = field("language", "equals", "fr");
+
+    EXPECT_TRUE(ConditionExpression(json{{"and", {english, field("input.depth", "equals", 2)}}}).evaluate(context));
+    EXPECT_FALSE(ConditionExpression(json{{"and", {english, french}}}).evaluate(context));
+    EXPECT_TRUE(ConditionExpression(json{{"or", {french, english}}}).evaluate(context));
+    EXPECT_FALSE(ConditionExpression(json{{"or", json::array()}}).evaluate(context));
+    EXPECT_TRUE(ConditionExpression(json{{"not", french}}).evaluate(context));
+    EXPECT_FALSE(ConditionExpression(json{{"not", {{"or", {english}}}}}).evaluate(context));
+}
+
+TEST(ConditionExpressionTest, PermissiveCasesAreTrue) {
+    json context = make_context();
+    EXPECT_TRUE(ConditionExpression(json()).evaluate(context));
+    EXPECT_TRUE(ConditionExpression(json::object()).evaluate(context));
+    EXPECT_TRUE(ConditionExpression(field("language", "matches", "e.*")).evaluate(context));
+    EXPECT_TRUE(ConditionExpression(field("language", "greater_than", 3)).evaluate(context));
+    EXPECT_TRUE(ConditionExpression(field("input.depth", "contains", "2")).evaluate(context));
+}
+
+TEST(ConditionExpressionTest, MatchesUncompiledEvaluation) {
+    json context = make_context();
+    std::vector<json> conditions = {
+        field("language", "equals", "en"),
+        field("language", "equals", "de"),
+        field("input.query", "not_equals", "other"),
+        field("input.depth", "greater_than", 1),
+        field("input.depth", "less_than", 1),
+        field("search_output.result.text", "contains", "ings"),
+        field("search_output.result.text", "contains", "nothing"),
+        field("search_output.result.confidence", "greater_than", "text"),
+        field("absent.path", "equals", 1),
+        field("query", "exists", true),
+        field("query", "unknown_operator", 1),
+        json{{"and", {field("language", "equals", "en"), field("input.depth", "less_than", 3)}}},
+        json{{"or", {field("language", "equals", "de"), field("absent", "equals", 1)}}},
+        json{{"and", {json{{"or", {field("language", "equals", "de"), field("query", "exists", 1)}}},
+                      field("input.depth", "equals", 2)}}},
+        json::object(),
+    };
+    for (const auto& condition : conditions) {
+        EXPECT_EQ(ConditionExpression(condition).evaluate(context), uncompiled_evaluate(condition, context))
+            << condition.dump();
+    }
+}
+
+TEST(ConditionExpressionTest, NotIsEvaluatedWhereTheUncompiledEvaluatorPassed) {
+    json context = make_context();
+    std::vector<json> conditions = {
+        json{{"not", field("language", "equals", "en")}},
+        json{{"and", {field("input.depth", "equals", 2), json{{"not", field("query", "exists", true)}}}}},
+    };
+    for (const auto& condition : conditions) {
+        EXPECT_FALSE(ConditionExpression(condition).evaluate(context)) << condition.dump();
+        EXPECT_TRUE(uncompiled_evaluate(condition, context)) << condition.dump();
+    }
+}
+
+TEST(ConditionExpressionTest, StepOutputViewMatchesTheMergedContext) {
+    json context = {{"query", "q"}};
+    StepOutputMap outputs = {{"score", std::make_shared<const json>(json{{"value", 0.9}, {"label", "good"}})}};
+    ContextView view(context, &outputs);
+    json merged = view.to_json();
+
+    std::vector<json> conditions = {
+        field("score_output.value", "greater_than", 0.5),
+        field("score_output.label", "equals", "bad"),
+        json{{"and", {field("query", "equals", "q"), field("score_output.label", "contains", "oo")}}},
+    };
+    for (const auto& condition : conditions) {
+        ConditionExpression expression(condition);
+        EXPECT_EQ(expression.evaluate(view), expression.evaluate(merged)) << condition.dump();
+        EXPECT_EQ(expression.evaluate(view), uncompiled_evaluate(condition, merged)) << condition.dump();
+    }
+}
@@ -0,0 +1,211 @@
+#include <gtest/gtest.h>
+#include "agent_config.hpp"
+#include "agent_manager.hpp"
+#include "cancellation_token.hpp"
+#include "http_client.hpp"
+#include "loopback_server.hpp"
+#include "workflow_manager.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+long elapsed_ms(Clock::time_point since) {
+    return static_cast<long>(std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - since).count());
+}
+
+// Requests against an in-process agent. The agent is shared by the suite:
+// creating one probes the retrieval server.
+class WorkflowManagerTest : public ::testing::Test {
+protected:
+    static std::shared_ptr<AgentManager> agent_manager_;
+    static std::shared_ptr<WorkflowManager> workflow_manager_;
+    static std::unique_ptr<LoopbackServer> slow_server_;
+
+    static void SetUpTestSuite() {
+        // Answers after ten seconds, far beyond any deadline used below
+        slow_server_ = std::make_unique<LoopbackServer>([](const LoopbackServer::Request&) {
+            LoopbackServer::Response response;
+            response.delay_ms = 10000;
+            return response;
+        });
+
+        agent_manager_ = std::make_shared<AgentManager>(std::make_shared<AgentConfigManager>());
+        std::string agent_id = agent_manager_->create_agent("Worker", {"test"});
+        // Waits on the request's token for "wait_ms", as a call into a slow server would
+        agent_manager_->get_agent(agent_id)->register_function("wait", [](const json& params) -> json {
+            auto token = CancellationToken::current();
+            if (token && !token->sleep_for(std::chrono::milliseconds(params.value("wait_ms", 10000)))) {
+                token->throw_if_cancelled();
+            }
+            return json{{"waited", true}};
+        });
+        // Calls the slow server over HTTP and fails if the call does
+        agent_manager_->get_agent(agent_id)->register_function("fetch", [](const json&) -> json {
+            HttpClient::Config config;
+            config.base_url = slow_server_->url();
+            config.timeout_seconds = 30;
+            config.max_retries = 0;
+            HttpClient client(config);
+            HttpClient::Result result = client.request("GET", "/slow");
+            if (!result.is_success()) {
+                throw std::runtime_error(result.error_message);
+            }
+            return json::parse(result.body);
+        });
+        agent_manager_->start_agent(agent_id);
+
+        workflow_manager_ = std::make_shared<WorkflowManager>(agent_manager_);
+        workflow_manager_->start();
+    }
+
+    static void TearDownTestSuite() {
+        workflow_manager_->stop();
+        agent_manager_->stop_all_agents();
+        workflow_manager_.reset();
+        agent_manager_.reset();
+        slow_server_.reset();
+    }
+};
+
+std::shared_ptr<AgentManager> WorkflowManagerTest::agent_manager_;
+std::shared_ptr<WorkflowManager> WorkflowManagerTest::workflow_manager_;
+std::unique_ptr<LoopbackServer> WorkflowManagerTest::slow_server_;
+
+}  // namespace
+
+TEST(WorkflowRequestTest, ContinuationRegisteredBeforeCompletionRunsOnce) {
+    WorkflowRequest request("r1", "Worker", "wait", json::object());
+    int runs = 0;
+    request.on_completion([&](const WorkflowRequest& finished) {
+        EXPECT_EQ(finished.id, "r1");
+        runs++;
+    });
+    EXPECT_FALSE(request.is_finished());
+    EXPECT_EQ(runs, 0);
+
+    request.notify_completion();
+    request.notify_completion();
+    EXPECT_TRUE(request.is_finished());
+    EXPECT_EQ(runs, 1);
+}
+
+TEST(WorkflowRequestTest, ContinuationRegisteredAfterCompletionRunsImmediately) {
+    WorkflowRequest request("r2", "Worker", "wait", json::object());
+    request.notify_completion();
+
+    int runs = 0;
+    std::thread::id ran_on;
+    request.on_completion([&](const WorkflowRequest&) {
+        runs++;
+        ran_on = std::this_thread::get_id();
+    });
+    EXPECT_EQ(runs, 1);
+    EXPECT_EQ(ran_on, std::this_thread::get_id());
+
+    request.notify_completion();
+    EXPECT_EQ(runs, 1);
+}
+
+TEST(WorkflowRequestTest, EveryContinuationRunsOnceWhenRacingCompletion) {
+    for (int round = 0; round < 50; ++round) {
+        WorkflowRequest request("r3", "Worker", "wait", json::object());
+        std::atomic<int> runs{0};
+        std::thread registrar([&] {
+            for (int i = 0; i < 100; ++i) {
+                request.on_completion([&](const WorkflowRequest&) { runs++; });
+            }
+        });
+        std::thread finisher([&] { request.notify_completion(); });
+        registrar.join();
+        finisher.join();
+        EXPECT_EQ(runs.load(), 100);
+    }
+}
+
+TEST(WorkflowRequestTest, WaitTimesOutWhileUnfinishedAndReturnsOnceFinished) {
+    WorkflowRequest request("r4", "Worker", "wait", json::object());
+    auto start = Clock::now();
+    EXPECT_FALSE(request.wait_for_completion(std::chrono::milliseconds(50)));
+    EXPECT_GE(elapsed_ms(start), 45);
+
+    std::thread finisher([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        request.notify_completion();
+    });
+    EXPECT_TRUE(request.wait_for_completion(std::chrono::seconds(10)));
+    finisher.join();
+    EXPECT_TRUE(request.wait_for_completion(std::chrono::milliseconds(0)));
+}
+
+TEST_F(WorkflowManagerTest, WaitForCompletionWakesOnCancel) {
+    std::string request_id = workflow_manager_->submit_request_with_timeout("Worker", "wait", json{{"wait_ms", 10000}}, 20000);
+    auto request = workflow_manager_->get_request_status(request_id);
+    ASSERT_NE(request, nullptr);
+
+    std::atomic<int> continuations{0};
+    request->on_completion([&](const WorkflowRequest&) { continuations++; });
+
+    auto start = Clock::now();
+    std::thread canceller([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        EXPECT_TRUE(workflow_manager_->cancel_request(request_id));
+    });
+    EXPECT_TRUE(request->wait_for_completion(std::chrono::seconds(10)));
+    canceller.join();
+
+    EXPECT_LT(elapsed_ms(start), 2000);
+    EXPECT_EQ(request->state, WorkflowState::CANCELLED);
+    EXPECT_EQ(continuations.load(), 1);
+
+    // The worker's own completion later must not signal it a second time
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_EQ(continuations.load(), 1);
+}
+
+TEST_F(WorkflowManagerTest, SlowHttpCallTimesOutNearTheDeadline) {
+    size_t hits_before = slow_server_->hits("/slow");
+    auto start = Clock::now();
+    std::string request_id = workflow_manager_->submit_request_with_timeout("Worker", "fetch", json::object(), 300);
+    auto request = workflow_manager_->get_request_status(request_id);
+    ASSERT_NE(request, nullptr);
+
+    EXPECT_TRUE(request->wait_for_completion(std::chrono::seconds(10)));
+    long elapsed = elapsed_ms(start);
+    EXPECT_GE(elapsed, 250);
+    EXPECT_LT(elapsed, 1500);
+    EXPECT_EQ(request->state, WorkflowState::TIMEOUT);
+    EXPECT_EQ(slow_server_->hits("/slow"), hits_before + 1);
+}
+
+TEST_F(WorkflowManagerTest, SlowHttpCallIsCancelled) {
+    size_t hits_before = slow_server_->hits("/slow");
+    std::string request_id = workflow_manager_->submit_request_with_timeout("Worker", "fetch", json::object(), 20000);
+    auto request = workflow_manager_->get_request_status(request_id);
+    ASSERT_NE(request, nullptr);
+
+    // Let the call reach the server before cancelling it
+    for (int i = 0; i < 200 && slow_server_->hits("/slow") == hits_before; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    auto start = Clock::now();
+    EXPECT_TRUE(workflow_manager_->cancel_request(request_id));
+    EXPECT_TRUE(request->wait_for_completion(std::chrono::seconds(10)));
+    EXPECT_EQ(request->state, WorkflowState::CANCELLED);
+
+    // The worker's HTTP call is aborted too, freeing it well before the server answers
+    auto stats_start = Clock::now();
+    while (workflow_manager_->get_statistics().active_requests.load() > 0 && elapsed_ms(stats_start) < 5000) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(workflow_manager_->get_statistics().active_requests.load(), 0u);
+    EXPECT_LT(elapsed_ms(start), 2500);
+}
@@ -0,0 +1,925 @@
+#include <gtest/gtest.h>
+#include "agent_config.hpp"
+#include "agent_manager.hpp"
+#include "task_scheduler.hpp"
+#include "workflow_manager.hpp"
+#include "workflow_types.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+bool is_finished(WorkflowExecutionState state) {
+    return state == WorkflowExecutionState::COMPLETED || state == WorkflowExecutionState::FAILED ||
+           state == WorkflowExecutionState::CANCELLED || state == WorkflowExecutionState::TIMEOUT;
+}
+
+// Runs workflows against an in-process agent whose "record" function logs
+// every call, so tests can tell which steps actually reached the agent. The
+// agent is shared by the suite: creating one probes the retrieval server.
+class WorkflowOrchestratorTest : public ::testing::Test {
+protected:
+    static std::shared_ptr<AgentManager> agent_manager_;
+    static std::shared_ptr<WorkflowManager> workflow_manager_;
+    static std::mutex calls_mutex_;
+    static std::vector<std::string> calls_;
+    static int running_;       // "timed" calls in progress
+    static int most_running_;  // Most "timed" calls that overlapped
+
+    std::filesystem::path directory_;
+
+    static void SetUpTestSuite() {
+        agent_manager_ = std::make_shared<AgentManager>(std::make_shared<AgentConfigManager>());
+        std::string agent_id = agent_manager_->create_agent("Worker", {"test"});
+        agent_manager_->get_agent(agent_id)->register_function("record", [](const json& params) -> json {
+            std::string name = params.value("name", "");
+            {
+                std::lock_guard<std::mutex> lock(calls_mutex_);
+                calls_.push_back(name);
+            }
+            return json{{"value", name + "-result"}, {"source", params.value("source", "")}};
+        });
+        // The first call of each name is slow; the ones after it are not
+        agent_manager_->get_agent(agent_id)->register_function("slow_first", [](const json& params) -> json {
+            std::string name = params.value("name", "");
+            size_t attempt;
+            {
+                std::lock_guard<std::mutex> lock(calls_mutex_);
+                calls_.push_back(name);
+                attempt = std::count(calls_.begin(), calls_.end(), name);
+            }
+            if (attempt == 1) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(500));
+            }
+            return json{{"value", name + "-result"}, {"attempt", attempt}};
+        });
+        agent_manager_->get_agent(agent_id)->register_function("slow_failure", [](const json& params) -> json {
+            {
+                std::lock_guard<std::mutex> lock(calls_mutex_);
+                calls_.push_back(params.value("name", ""));
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            throw std::runtime_error("slow failure");
+        });
+        // The first call of each name fails at once; the ones after it are slow
+        agent_manager_->get_agent(agent_id)->register_function("fail_first", [](const json& params) -> json {
+            std::string name = params.value("name", "");
+            size_t attempt;
+            {
+                std::lock_guard<std::mutex> lock(calls_mutex_);
+                attempt = std::count(calls_.begin(), calls_.end(), name);
+            }
+            if (attempt == 0) {
+                std::lock_guard<std::mutex> lock(calls_mutex_);
+                calls_.push_back(name);
+                throw std::runtime_error("first call fails");
+            }
+            timed_call(name, params.value("delay_ms", 50));
+            return json{{"value", name + "-result"}};
+        });
+        agent_manager_->get_agent(agent_id)->register_function("timed", [](const json& params) -> json {
+            std::string name = params.value("name", "");
+            timed_call(name, params.value("delay_ms", 50));
+            return json{{"value", name + "-result"}};
+        });
+        // Map calls: "item" is an element, or a batch of them as JSON text;
+        // the item "fail" fails at once
+        agent_manager_->get_agent(agent_id)->register_function("map_item", [](const json& params) -> json {
+            std::string item = params.value("item", "");
+            if (item == "fail") {
+                throw std::runtime_error("item failed");
+            }
+            std::string delay = params.value("delay_ms", "");
+            timed_call(item, delay.empty() ? 20 : std::stoi(delay));
+            json batch = json::parse(item, nullptr, false);
+            if (!batch.is_array()) {
+                return item + "-result";
+            }
+            json results = json::array();
+            for (const auto& element : batch) {
+                results.push_back(element.dump() + "-result");
+            }
+            return results;
+        });
+        // Pipeline stages: multiplies each number of pipeline_input (or of
+        // its "items") by "factor"
+        agent_manager_->get_agent(agent_id)->register_function("scale", [](const json& params) -> json {
+            json input = params.value("pipeline_input", json::array());
+            json items = input.is_object() ? input.value("items", json::array()) : input;
+            timed_call(params.value("name", "") + " " + items.dump(), params.value("delay_ms", 0));
+            json results = json::array();
+            for (const auto& item : items) {
+                results.push_back(item.get<int>() * params.value("factor", 1));
+            }
+            return results;
+        });
+        agent_manager_->start_agent(agent_id);
+
+        workflow_manager_ = std::make_shared<WorkflowManager>(agent_manager_);
+        workflow_manager_->start();
+    }
+
+    static void TearDownTestSuite() {
+        workflow_manager_->stop();
+        agent_manager_->stop_all_agents();
+        workflow_manager_.reset();
+        agent_manager_.reset();
+    }
+
+    void SetUp() override {
+        directory_ = std::filesystem::temp_directory_path() /
+                     ("workflow_orchestrator_test_" + std::to_string(std::random_device{}()));
+        std::filesystem::create_directories(directory_);
+        std::lock_guard<std::mutex> lock(calls_mutex_);
+        calls_.clear();
+        running_ = 0;
+        most_running_ = 0;
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(directory_);
+    }
+
+    static std::vector<std::string> calls() {
+        std::lock_guard<std::mutex> lock(calls_mutex_);
+        return calls_;
+    }
+
+    ExecutionJournal::Config journal_config() const {
+        ExecutionJournal::Config config;
+        config.path = (directory_ / "executions.jsonl").string();
+        config.flush_interval_ms = 5;
+        return config;
+    }
+
+    // fetch -> summarize, where summarize reads fetch's output
+    static WorkflowDefinition two_step_workflow() {
+        WorkflowDefinition workflow("two_step", "Two step", WorkflowType::SEQUENTIAL);
+        workflow.steps.emplace_back("fetch", "Worker", "record", json{{"name", "fetch"}});
+        WorkflowStep summarize("summarize", "Worker", "record",
+                               json{{"name", "summarize"}, {"source", "{{fetch_output.value}}"}});
+        summarize.dependencies = {"fetch"};
+        workflow.steps.push_back(summarize);
+        return workflow;
+    }
+
+    // Logs its start and end and tracks how many calls overlap
+    static void timed_call(const std::string& name, int delay_ms) {
+        {
+            std::lock_guard<std::mutex> lock(calls_mutex_);
+            calls_.push_back(name);
+            most_running_ = std::max(most_running_, ++running_);
+        }
+        {
+            // Stands in for I/O, which does not hold a scheduler worker
+            TaskScheduler::BlockingScope blocking;
+            std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+        }
+        std::lock_guard<std::mutex> lock(calls_mutex_);
+        calls_.push_back(name + " done");
+        running_--;
+    }
+
+    static WorkflowStep map_step(const std::string& id, int parallelism, int batch_size,
+                                 const std::string& delay_ms = "") {
+        WorkflowStep step(id, "Worker", "map_item", json{{"item", "{{item}}"}});
+        if (!delay_ms.empty()) {
+            step.parameters["delay_ms"] = delay_ms;
+        }
+        step.map = WorkflowStep::MapConfiguration{};
+        step.map->items = "input.items";
+        step.map->parallelism = parallelism;
+        step.map->batch_size = batch_size;
+        return step;
+    }
+
+    // split -> work -> collect over input.items, streaming
+    static WorkflowDefinition streaming_pipeline(const std::string& id, size_t channel_capacity, size_t batch_size,
+                                                 const std::string& work_function = "scale") {
+        WorkflowDefinition workflow(id, id, WorkflowType::PIPELINE);
+        workflow.pipeline_config.streaming = true;
+        workflow.pipeline_config.channel_capacity = channel_capacity;
+        workflow.pipeline_config.batch_size = batch_size;
+        workflow.steps.emplace_back("split", "Worker", "scale", json{{"name", "split"}});
+        workflow.steps.emplace_back("work", "Worker", work_function,
+                                    json{{"name", "work"}, {"factor", 10}, {"delay_ms", 40}});
+        workflow.steps.emplace_back("collect", "Worker", "scale", json{{"name", "collect"}});
+        return workflow;
+    }
+
+    // The numbers a stage produced over all of its calls, in order
+    static std::vector<int> stage_items(const WorkflowExecution& execution, const std::string& step_id) {
+        json output = step_output(execution, step_id);
+        std::vector<int> items;
+        for (const auto& entry : output) {
+            if (entry.is_array()) {
+                for (const auto& item : entry) {
+                    items.push_back(item.get<int>());
+                }
+            } else {
+                items.push_back(entry.get<int>());
+            }
+        }
+        return items;
+    }
+
+    // Index of the first (or, with last set, the last) entry starting with prefix
+    static size_t find_prefixed(const std::vector<std::string>& log, const std::string& prefix, bool last = false) {
+        size_t found = log.size();
+        for (size_t i = 0; i < log.size(); ++i) {
+            if (log[i].rfind(prefix, 0) == 0) {
+                found = i;
+                if (!last) {
+                    break;
+                }
+            }
+        }
+        return found;
+    }
+
+    static size_t position(const std::vector<std::string>& log, const std::string& entry) {
+        return static_cast<size_t>(std::find(log.begin(), log.end(), entry) - log.begin());
+    }
+
+    static WorkflowStep timed_step(const std::string& id, std::vector<std::string> dependencies = {}) {
+        WorkflowStep step(id, "Worker", "timed", json{{"name", id}});
+        step.dependencies = std::move(dependencies);
+        return step;
+    }
+
+    static std::shared_ptr<WorkflowExecution> wait_for(WorkflowOrchestrator& orchestrator,
+                                                       const std::string& execution_id) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+        while (std::chrono::steady_clock::now() < deadline) {
+            auto execution = orchestrator.get_execution_status(execution_id);
+            if (execution && is_finished(execution->state)) {
+                return execution;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return nullptr;
+    }
+
+    static json step_output(const WorkflowExecution& execution, const std::string& step_id) {
+        std::lock_guard<std::mutex> lock(execution.mutex);
+        auto it = execution.step_outputs.find(step_id);
+        return it != execution.step_outputs.end() && it->second ? *it->second : json();
+    }
+};
+
+std::shared_ptr<AgentManager> WorkflowOrchestratorTest::agent_manager_;
+std::shared_ptr<WorkflowManager> WorkflowOrchestratorTest::workflow_manager_;
+std::mutex WorkflowOrchestratorTest::calls_mutex_;
+std::vector<std::string> WorkflowOrchestratorTest::calls_;
+int WorkflowOrchestratorTest::running_ = 0;
+int WorkflowOrchestratorTest::most_running_ = 0;
+
+}  // namespace
+
+TEST_F(WorkflowOrchestratorTest, ResumesAJournaledExecutionWithoutRerunningFinishedSteps) {
+    // What a previous process left behind: fetch finished, summarize never ran
+    {
+        ExecutionJournal journal(journal_config());
+        journal.open();
+        journal.record_execution_started("wf-interrupted", "two_step", json{{"topic", "t"}}, "tenant-a", 0, 0);
+        journal.record_step_completed("wf-interrupted", "fetch", json{{"value", "fetch-from-journal"}});
+    }
+
+    {
+        WorkflowOrchestrator orchestrator(workflow_manager_);
+        orchestrator.enable_execution_journal(journal_config());
+        orchestrator.register_workflow(two_step_workflow());
+        ASSERT_TRUE(orchestrator.start());
+
+        auto execution = wait_for(orchestrator, "wf-interrupted");
+        ASSERT_NE(execution, nullptr);
+        EXPECT_EQ(execution->state, WorkflowExecutionState::COMPLETED);
+        EXPECT_EQ(execution->input_data, (json{{"topic", "t"}}));
+        EXPECT_EQ(execution->tenant_id, "tenant-a");
+
+        // Only the unfinished step reached the agent, and it saw the journaled output
+        EXPECT_EQ(calls(), (std::vector<std::string>{"summarize"}));
+        EXPECT_EQ(step_output(*execution, "fetch"), (json{{"value", "fetch-from-journal"}}));
+        EXPECT_NE(step_output(*execution, "summarize").dump().find("fetch-from-journal"), std::string::npos);
+        {
+            std::lock_guard<std::mutex> lock(execution->mutex);
+            EXPECT_TRUE(execution->step_stats.at("fetch").completed_successfully);
+            EXPECT_TRUE(execution->step_stats.at("summarize").completed_successfully);
+        }
+        orchestrator.stop();
+    }
+
+    // The execution finished, so a second restart has nothing to resume
+    ExecutionJournal journal(journal_config());
+    EXPECT_TRUE(journal.open().empty());
+}
+
+TEST_F(WorkflowOrchestratorTest, ResumesAJournaledLoopInTheIterationItWasIn) {
+    WorkflowDefinition workflow("looped", "Looped", WorkflowType::LOOP);
+    workflow.global_context = json{{"max_iterations", 3}};
+    workflow.steps.emplace_back("a", "Worker", "record", json{{"name", "a"}});
+    workflow.steps.emplace_back("b", "Worker", "record", json{{"name", "b"}});
+
+    // Interrupted in the second iteration, after a
+    {
+        ExecutionJournal journal(journal_config());
+        journal.open();
+        journal.record_execution_started("wf-loop", "looped", json::object(), "", 0, 0);
+        journal.record_loop_iteration("wf-loop", 0);
+        journal.record_step_completed("wf-loop", "a", json{{"value", "a-0"}});
+        journal.record_step_completed("wf-loop", "b", json{{"value", "b-0"}});
+        journal.record_loop_iteration("wf-loop", 1);
+        journal.record_step_completed("wf-loop", "a", json{{"value", "a-1"}});
+    }
+
+    {
+        WorkflowOrchestrator orchestrator(workflow_manager_);
+        orchestrator.enable_execution_journal(journal_config());
+        orchestrator.register_workflow(workflow);
+        ASSERT_TRUE(orchestrator.start());
+
+        auto execution = wait_for(orchestrator, "wf-loop");
+        ASSERT_NE(execution, nullptr);
+        EXPECT_EQ(execution->state, WorkflowExecutionState::COMPLETED);
+        // The rest of iteration 1, then iteration 2; nothing runs twice
+        EXPECT_EQ(calls(), (std::vector<std::string>{"b", "a", "b"}));
+        orchestrator.stop();
+    }
+
+    ExecutionJournal journal(journal_config());
+    EXPECT_TRUE(journal.open().empty());
+}
+
+TEST_F(WorkflowOrchestratorTest, JournalRecordsStepsOfALiveExecution) {
+    {
+        WorkflowOrchestrator orchestrator(workflow_manager_);
+        orchestrator.enable_execution_journal(journal_config());
+        orchestrator.register_workflow(two_step_workflow());
+        ASSERT_TRUE(orchestrator.start());
+
+        std::string execution_id = orchestrator.execute_workflow("two_step", json{{"topic", "t"}});
+        auto execution = wait_for(orchestrator, execution_id);
+        ASSERT_NE(execution, nullptr);
+        EXPECT_EQ(execution->state, WorkflowExecutionState::COMPLETED);
+        orchestrator.stop();
+    }
+    EXPECT_EQ(calls(), (std::vector<std::string>{"fetch", "summarize"}));
+
+    ExecutionJournal journal(journal_config());
+    EXPECT_TRUE(journal.open().empty());
+}
+
+TEST_F(WorkflowOrchestratorTest, DropsJournaledExecutionsOfUnknownWorkflows) {
+    {
+        ExecutionJournal journal(journal_config());
+        journal.open();
+        journal.record_execution_started("wf-orphan", "not_registered", json::object(), "", 0, 0);
+    }
+
+    {
+        WorkflowOrchestrator orchestrator(workflow_manager_);
+        orchestrator.enable_execution_journal(journal_config());
+        ASSERT_TRUE(orchestrator.start());
+        EXPECT_EQ(orchestrator.get_execution_status("wf-orphan"), nullptr);
+        orchestrator.stop();
+    }
+    EXPECT_TRUE(calls().empty());
+
+    ExecutionJournal journal(journal_config());
+    EXPECT_TRUE(journal.open().empty());
+}
+
+TEST_F(WorkflowOrchestratorTest, CacheHitSkipsTheAgentCall) {
+    WorkflowOrchestrator orchestrator(workflow_manager_);
+    StepResultCache::Config cache_config;
+    cache_config.enabled = true;
+    orchestrator.set_step_cache_config(cache_config);
+
+    WorkflowDefinition workflow("cached", "Cached", WorkflowType::SEQUENTIAL);
+    WorkflowStep lookup("lookup", "Worker", "record", json{{"name", "lookup"}, {"source", "{{input.topic}}"}});
+    lookup.cacheable = true;
+    workflow.steps.push_back(lookup);
+    orchestrator.register_workflow(workflow);
+    ASSERT_TRUE(orchestrator.start());
+
+    auto first = wait_for(orchestrator, orchestrator.execute_workflow("cached", json{{"topic", "t"}}));
+    auto second = wait_for(orchestrator, orchestrator.execute_workflow("cached", json{{"topic", "t"}}));
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+    EXPECT_EQ(first->state, WorkflowExecutionState::COMPLETED);
+    EXPECT_EQ(second->state, WorkflowExecutionState::COMPLETED);
+
+    // The second execution resolved the same call and was answered from the cache
+    EXPECT_EQ(calls(), (std::vector<std::string>{"lookup"}));
+    EXPECT_EQ(step_output(*second, "lookup"), step_output(*first, "lookup"));
+    json stats = orchestrator.get_step_cache_stats();
+    EXPECT_EQ(stats["hits"], 1);
+    EXPECT_EQ(stats["misses"], 1);
+
+    // Different resolved parameters are a different call
+    auto third = wait_for(orchestrator, orchestrator.execute_workflow("cached", json{{"topic", "other"}}));
+    ASSERT_NE(third, nullptr);
+    EXPECT_EQ(calls(), (std::vector<std::string>{"lookup", "lookup"}));
+    orchestrator.stop();
+}
+
+TEST_F(WorkflowOrchestratorTest, SlowStepIsHedgedAndTheDuplicateWins) {
+    WorkflowOrchestrator orchestrator(workflow_manager_);
+    WorkflowDefinition workflow("hedged", "Hedged", WorkflowType::SEQUENTIAL);
+    WorkflowStep step("answer", "Worker", "slow_first", json{{"name", "hedge-win"}});
+    step.hedge = WorkflowStep::HedgeConfiguration{};
+    step.hedge->min_samples = 1000;  // No history: hedge after min_delay_ms
+    step.hedge->min_delay_ms = 50;
+    workflow.steps.push_back(step);
+    orchestrator.register_workflow(workflow);
+    ASSERT_TRUE(orchestrator.start());
+
+    auto execution = wait_for(orchestrator, orchestrator.execute_workflow("hedged"));
+    ASSERT_NE(execution, nullptr);
+    EXPECT_EQ(execution->state, WorkflowExecutionState::COMPLETED);
+    EXPECT_EQ(step_output(*execution, "answer")["attempt"], 2);
+
+    json stats = orchestrator.get_hedging_stats();
+    EXPECT_EQ(stats["hedges_launched"], 1);
+    EXPECT_EQ(stats["hedge_wins"], 1);
+    EXPECT_EQ(stats["primary_wins"], 0);
+    EXPECT_EQ(stats["losers_cancelled"], 1);
+    EXPECT_EQ(stats["both_failed"], 0);
+    // The step took at least the hedge delay, although the duplicate alone was fast
+    ASSERT_TRUE(stats["steps"].contains("hedged/answer"));
+    EXPECT_EQ(stats["steps"]["hedged/answer"]["samples"], 1);
+    EXPECT_GE(stats["steps"]["hedged/answer"]["p50_ms"].get<double>(), 50.0);
+    orchestrator.stop();
+}
+
+TEST_F(WorkflowOrchestratorTest, HedgedStepFailsWhenBothRequestsFail) {
+    WorkflowOrchestrator orchestrator(workflow_manager_);
+    WorkflowDefinition workflow("hedged_failure", "Hedged failure", WorkflowType::SEQUENTIAL);
+    WorkflowStep step("answer", "Worker", "slow_failure", json{{"name", "hedge-fail"}});
+    step.hedge = WorkflowStep::HedgeConfiguration{};
+    step.hedge->min_samples = 1000;
+    step.hedge->min_delay_ms = 20;
+    workflow.steps.push_back(step);
+    orchestrator.register_workflow(workflow);
+    ASSERT_TRUE(orchestrator.start());
+
+    auto execution = wait_for(orchestrator, orchestrator.execute_workflow("hedged_failure"));
+    ASSERT_NE(execution, nullptr);
+    EXPECT_EQ(execution->state, WorkflowExecutionState::FAILED);
+    EXPECT_EQ(calls(), (std::vector<std::string>{"hedge-fail", "hedge-fail"}));
+
+    json stats = orchestrator.get_hedging_stats();
+    EXPECT_EQ(stats["hedges_launched"], 1);
+    EXPECT_EQ(stats["both_failed"], 1);
+    EXPECT_EQ(stats["hedge_wins"], 0);
+    EXPECT_EQ(stats["primary_wins"], 0);
+    orchestrator.stop();
+}
+
+TEST_F(WorkflowOrchestratorTest, ParallelStepsStartOnceTheirDependenciesFinish) {
+    WorkflowOrchestrator orchestrator(workflow_manager_);
+    // fetch -> (left, right) -> merge, declared out of order
+    WorkflowDefinition workflow("diamond", "Diamond", WorkflowType::PARALLEL);
+    workflow.steps.push_back(timed_step("merge", {"left", "right"}));
+    workflow.steps.push_back(timed_step("left", {"fetch"}));
+    workflow.steps.push_back(timed_step("fetch"));
+    workflow.steps.push_back(timed_step("right", {"fetch"}));
+    orchestrator.register_workflow(workflow);
+    ASSERT_TRUE(orchestrator.start());
+
+    auto execution = wait_for(orchestrator, orchestrator.execute_workflow("diamond"));
+    ASSERT_NE(execution, nullptr);
+    EXPECT_EQ(execution->state, WorkflowExecutionState::COMPLETED);
+
+    auto log = calls();
+    ASSERT_EQ(log.size(), 8u);
+    EXPECT_EQ(log.front(), "fetch");
+    EXPECT_LT(position(log, "fetch done"), position(log, "left"));
+    EXPECT_LT(position(log, "fetch done"), position(log, "right"));
+    EXPECT_LT(position(log, "left done"), position(log, "merge"));
+    EXPECT_LT(position(log, "right done"), position(log, "merge"));
+    EXPECT_EQ(log.back(), "merge done");
+    // The two branches overlapped
+    EXPECT_EQ(most_running_, 2);
+    orchestrator.stop();
+}
+
+TEST_F(WorkflowOrchestratorTest, ParallelStepsStayWithinMaxParallelSteps) {
+    WorkflowOrchestrator orchestrator(workflow_manager_);
+    WorkflowDefinition workflow("wide", "Wide", WorkflowType::PARALLEL);
+    workflow.max_parallel_steps = 2;
+    for (int i = 0; i < 6; ++i) {
+        workflow.steps.push_back(timed_step("branch-" + std::to_string(i)));
+    }
+    orchestrator.register_workflow(workflow);
+    ASSERT_TRUE(orchestrator.start());
+
+    auto execution = wait_for(orchestrator, orchestrator.execute_workflow("wide"));
+    ASSERT_NE(execution, nullptr);
+    EXPECT_EQ(execution->state, WorkflowExecutionState::COMPLETED);
+    EXPECT_EQ(calls().size(), 12u);
+    EXPECT_EQ(most_running_, 2);
+    orchestrator.stop();
+}
+
+TEST_F(WorkflowOrchestratorTest, DependentsOfAFailedStepAreSkipped) {
+    WorkflowOrchestrator orchestrator(workflow_manager_);
+    WorkflowDefinition workflow("partial", "Partial", WorkflowType::PARALLEL);
+    workflow.allow_partial_failure = true;
+    workflow.steps.emplace_back("broken", "Worker", "slow_failure", json{{"name", "broken"}});
+    workflow.steps.push_back(timed_step("child", {"broken"}));
+    workflow.steps.push_back(timed_step("grandchild", {"child"}));
+    workflow.steps.push_back(timed_step("independent"));
+    orchestrator.register_workflow(workflow);
+    ASSERT_TRUE(orchestrator.start());
+
+    auto execution = wait_for(orchestrator, orchestrator.execute_workflow("partial"));
+    ASSERT_NE(execution, nullptr);
+    EXPECT_EQ(execution->state, WorkflowExecutionState::COMPLETED);
+    EXPECT_EQ(execution->progress_percentage, 100.0);
+
+    auto log = calls();
+    EXPECT_EQ(position(log, "child"), log.size());
+    EXPECT_EQ(position(log, "grandchild"), log.size());
+    EXPECT_LT(position(log, "independent done"), log.size());
+    EXPECT_TRUE(step_output(*execution, "child").is_null());
+
+    // Without partial failure the execution fails, and still skips them
+    workflow.id = "strict";
+    workflow.allow_partial_failure = false;
+    orchestrator.register_workflow(workflow);
+    execution = wait_for(orchestrator, orchestrator.execute_workflow("strict"));
+    ASSERT_NE(execution, nullptr);
+    EXPECT_EQ(execution->state, WorkflowExecutionState::FAILED);
+    EXPECT_NE(execution->error_message.find("broken"), std::string::npos);
+    log = calls();
+    EXPECT_EQ(std::count(log.begin(), log.end(), "child"), 0);
+    orchestrator.stop();
+}
+
+TEST_F(WorkflowOrchestratorTest, ParallelStepsKeepTheRetryPolicyOfARemovedWorkflow) {
+    WorkflowOrchestrator orchestrator(workflow_manager_);
+    WorkflowDefinition workflow("removed", "Removed", WorkflowType::PARALLEL);
+    workflow.default_retry_policy = RetryPolicy(1, 1.0f, 10, 10);
+    workflow.steps.push_back(timed_step("fetch"));
+    WorkflowStep failing("failing", "Worker", "slow_failure", json{{"name", "failing"}});
+    failing.dependencies = {"fetch"};
+    workflow.steps.push_back(failing);
+    orchestrator.register_workflow(workflow);
+    ASSERT_TRUE(orchestrator.start());
+
+    std::string execution_id = orchestrator.execute_workflow_async("removed", json::object());
+    while (calls().empty()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_TRUE(orchestrator.remove_workflow("removed"));
+
+    // failing starts after the removal and still retries once
+    auto execution = wait_for(orchestrator, execution_id);
+    ASSERT_NE(execution, nullptr);
+    EXPECT_EQ(execution->state, WorkflowExecutionState::FAILED);
+    auto log = calls();
+    EXPECT_EQ(std::count(log.begin(), log.end(), "failing"), 2);
+    orchestrator.stop();
+}
+
+TEST_F(WorkflowOrchestratorTest, CancelledParallelExecutionStopsWaitingForItsSteps) {
+    WorkflowOrchestrator orchestrator(workflow_manager_);
+    WorkflowDefinition workflow("cancelled", "Cancelled", WorkflowType::PARALLEL);
+    // The retry submits its request after the cancel has been handled
+    WorkflowStep retried("retried", "Worker", "fail_first", json{{"name", "retried"}, {"delay_ms", 3000}});
+    retried.retry_policy = RetryPolicy(1, 1.0f, 300, 300);
+    workflow.steps.push_back(retried);
+    orchestrator.register_workflow(workflow);
+    ASSERT_TRUE(orchestrator.start());
+
+    std::string execution_id = orchestrator.execute_workflow_async("cancelled", json::object());
+    while (calls().empty()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    auto start = std::chrono::steady_clock::now();
+    ASSERT_TRUE(orchestrator.cancel_execution(execution_id));
+
+    // The retry's request is cancelled too instead of running to its end
+    auto deadline = start + std::chrono::seconds(10);
+    while (!orchestrator.list_active_executions().empty() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_TRUE(orchestrator.list_active_executions().empty());
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(2000));
+    EXPECT_EQ(orchestrator.get_execution_status(execution_id)->state, WorkflowExecutionState::CANCELLED);
+    orchestrator.stop();
+}
+
+TEST_F(WorkflowOrchestratorTest, RegistrationRejectsCyclesAndUnknownDependencies) {
+    WorkflowOrchestrator orchestrator(workflow_manager_);
+
+    WorkflowDefinition cyclic("cyclic", "Cyclic", WorkflowType::PARALLEL);
+    cyclic.steps.push_back(timed_step("start"));
+    cyclic.steps.push_back(timed_step("a", {"start", "c"}));
+    cyclic.steps.push_back(timed_step("b", {"a"}));
+    cyclic.steps.push_back(timed_step("c", {"b"}));
+    EXPECT_THROW(orchestrator.register_workflow(cyclic), std::invalid_argument);
+
+    WorkflowDefinition dangling("dangling", "Dangling", WorkflowType::PARALLEL);
+    dangling.steps.push_back(timed_step("a", {"missing"}));
+    EXPECT_THROW(orchestrator.register_workflow(dangling), std::invalid_argument);
+
+    WorkflowDefinition duplicate("duplicate", "Duplicate", WorkflowType::PARALLEL);
+    duplicate.steps.push_back(timed_step("a"));
+    duplicate.steps.push_back(timed_step("a"));
+    EXPECT_THROW(orchestrator.register_workflow(duplicate), std::invalid_argument);
+
+    EXPECT_EQ(orchestrator.get_workflow("cyclic"), nullptr);
+    EXPECT_EQ(orchestrator.get_workflow("dangling"), nullptr);
+    EXPECT_EQ(orchestrator.get_workflow("duplicate"), nullptr);
+}
+
+TEST_F(WorkflowOrchestratorTest, MapStepGathersResultsInInputOrder) {
+    WorkflowOrchestrator orchestrator(workflow_manager_);
+    WorkflowDefinition workflow("mapped", "Mapped", WorkflowType::SEQUENTIAL);
+    // Later items finish first
+    WorkflowStep step("each", "Worker", "map_item", json{{"item", "{{item.name}}"}, {"delay_ms", "{{item.delay}}"}});
+    step.map = WorkflowStep::MapConfiguration{};
+    step.map->items = "{{input.items}}";
+    step.map->parallelism = 4;
+    workflow.steps.push_back(step);
+    orchestrator.register_workflow(workflow);
+    ASSERT_TRUE(orchestrator.start());
+
+    json items = json::array();
+    for (int i = 0; i < 4; ++i) {
+        items.push_back(json{{"name", "item-" + std::to_string(i)}, {"delay", (3 - i) * 40}});
+    }
+    auto execution = wait_for(orchestrator, orchestrator.execute_workflow("mapped", json{{"items", items}}));
+    ASSERT_NE(execution, nullptr);
+    EXPECT_EQ(execution->state, WorkflowExecutionState::COMPLETED);
+
+    auto log = calls();
+    EXPECT_LT(position(log, "item-3 done"), position(log, "item-0 done"));
+    EXPECT_EQ(step_output(*execution, "each"),
+              (json{"item-0-result", "item-1-result", "item-2-result", "item-3-result"}));
+    orchestrator.stop();
+}
+
+TEST_F(WorkflowOrchestratorTest, MapStepHandsBatchesToEachCall) {
+    WorkflowOrchestrator orchestrator(workflow_manager_);
+    WorkflowDefinition workflow("batched", "Batched", WorkflowType::SEQUENTIAL);
+    workflow.steps.push_back(map_step("each", 4, 3));
+    orchestrator.register_workflow(workflow);
+    ASSERT_TRUE(orchestrator.start());
+
+    auto execution = wait_for(orchestrator,
+                              orchestrator.execute_workflow("batched", json{{"items", {0, 1, 2, 3, 4, 5, 6}}}));
+    ASSERT_NE(execution, nullptr);
+    EXPECT_EQ(execution->state, WorkflowExecutionState::COMPLETED);
+
+    // Three calls of at most three items; one result per item, in order
+    auto log = calls();
+    EXPECT_EQ(std::count(log.begin(), log.end(), "[0,1,2]"), 1);
+    EXPECT_EQ(std::count(log.begin(), log.end(), "[3,4,5]"), 1);
+    EXPECT_EQ(std::count(log.begin(), log.end(), "[6]"), 1);
+    EXPECT_EQ(log.size(), 6u);
+    json expected = json::array();
+    for (int i = 0; i < 7; ++i) {
+        expected.push_back(std::to_string(i) + "-result");
+    }
+    EXPECT_EQ(step_output(*execution, "each"), expected);
+    orchestrator.stop();
+}
+
+TEST_F(WorkflowOrchestratorTest, MapStepStaysWithinItsParallelism) {
+    WorkflowOrchestrator orchestrator(workflow_manager_);
+    WorkflowDefinition workflow("narrow_map", "Narrow map", WorkflowType::SEQUENTIAL);
+    workflow.steps.push_back(map_step("each", 2, 1, "30"));
+    orchestrator.register_workflow(workflow);
+    ASSERT_TRUE(orchestrator.start());
+
+    auto execution = wait_for(orchestrator,
+                              orchestrator.execute_workflow("narrow_map", json{{"items", {0, 1, 2, 3, 4, 5, 6, 7}}}));
+    ASSERT_NE(execution, nullptr);
+    EXPECT_EQ(execution->state, WorkflowExecutionState::COMPLETED);
+    EXPECT_EQ(calls().size(), 16u);
+    EXPECT_EQ(most_running_, 2);
+    EXPECT_EQ(step_output(*execution, "each").size(), 8u);
+    orchestrator.stop();
+}
+
+TEST_F(WorkflowOrchestratorTest, FailedMapCallCancelsItsSiblings) {
+    WorkflowOrchestrator orchestrator(workflow_manager_);
+    WorkflowDefinition workflow("failed_map", "Failed map", WorkflowType::SEQUENTIAL);
+    WorkflowStep step("each", "Worker", "map_item", json{{"item", "{{item.name}}"}, {"delay_ms", "{{item.delay}}"}});
+    step.map = WorkflowStep::MapConfiguration{};
+    step.map->items = "input.items";
+    step.map->parallelism = 4;
+    workflow.steps.push_back(step);
+    orchestrator.register_workflow(workflow);
+    ASSERT_TRUE(orchestrator.start());
+
+    json items = json::array({json{{"name", "fail"}, {"delay", 0}}});
+    for (int i = 0; i < 3; ++i) {
+        items.push_back(json{{"name", "slow-" + std::to_string(i)}, {"delay", 1500}});
+    }
+    auto start = std::chrono::steady_clock::now();
+    auto execution = wait_for(orchestrator, orchestrator.execute_workflow("failed_map", json{{"items", items}}));
+    ASSERT_NE(execution, nullptr);
+    EXPECT_EQ(execution->state, WorkflowExecutionState::FAILED);
+    EXPECT_NE(execution->error_message.find("item failed"), std::string::npos) << execution->error_message;
+
+    // The step fails as soon as the first call does, not after the slow ones
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(1000));
+    auto log = calls();
+    EXPECT_EQ(position(log, "slow-0 done"), log.size());
+    orchestrator.stop();
+}
+
+TEST_F(WorkflowOrchestratorTest, PausingDuringAMapStepPausesAfterIt) {
+    WorkflowOrchestrator orchestrator(workflow_manager_);
+    WorkflowDefinition workflow("paused_map", "Paused map", WorkflowType::SEQUENTIAL);
+    workflow.steps.push_back(map_step("each", 1, 1, "30"));
+    workflow.steps.push_back(timed_step("after", {"each"}));
+    orchestrator.register_workflow(workflow);
+    ASSERT_TRUE(orchestrator.start());
+
+    std::string execution_id = orchestrator.execute_workflow_async("paused_map", json{{"items", {0, 1, 2, 3, 4, 5}}});
+    while (calls().empty()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_TRUE(orchestrator.pause_execution(execution_id));
+
+    // The map finishes every item instead of failing, and nothing after it starts
+    auto execution = orchestrator.get_execution_status(execution_id);
+    ASSERT_NE(execution, nullptr);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (step_output(*execution, "each").is_null() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_EQ(step_output(*execution, "each").size(), 6u);
+    EXPECT_EQ(execution->state, WorkflowExecutionState::PAUSED);
+    EXPECT_TRUE(execution->error_message.empty());
+    auto log = calls();
+    EXPECT_EQ(position(log, "after"), log.size());
+    orchestrator.stop();
+}
+
+TEST_F(WorkflowOrchestratorTest, StreamingPipelineOverlapsStagesAndKeepsOrder) {
+    WorkflowOrchestrator orchestrator(workflow_manager_);
+    orchestrator.register_workflow(streaming_pipeline("streamed", 16, 2));
+    ASSERT_TRUE(orchestrator.start());
+
+    auto execution = wait_for(orchestrator,
+                              orchestrator.execute_workflow("streamed", json{{"items", {1, 2, 3, 4, 5, 6}}}));
+    ASSERT_NE(execution, nullptr);
+    EXPECT_EQ(execution->state, WorkflowExecutionState::COMPLETED);
+
+    // work is called per batch of at most two chunks, and collect starts on
+    // the first of them while work is still going
+    auto log = calls();
+    size_t work_calls = std::count_if(log.begin(), log.end(), [](const std::string& entry) {
+        return entry.rfind("work ", 0) == 0 && entry.find(" done") == std::string::npos;
+    });
+    EXPECT_GE(work_calls, 3u);
+    EXPECT_LT(find_prefixed(log, "collect "), find_prefixed(log, "work ", true));
+
+    EXPECT_EQ(stage_items(*execution, "work"), (std::vector<int>{10, 20, 30, 40, 50, 60}));
+    EXPECT_EQ(stage_items(*execution, "collect"), (std::vector<int>{10, 20, 30, 40, 50, 60}));
+    orchestrator.stop();
+}
+
+TEST_F(WorkflowOrchestratorTest, StreamingPipelineHoldsProducersToTheConsumersPace) {
+    WorkflowOrchestrator orchestrator(workflow_manager_);
+    orchestrator.register_workflow(streaming_pipeline("backpressured", 1, 1));
+    ASSERT_TRUE(orchestrator.start());
+
+    auto execution = wait_for(orchestrator,
+                              orchestrator.execute_workflow("backpressured", json{{"items", {1, 2, 3, 4, 5}}}));
+    ASSERT_NE(execution, nullptr);
+    EXPECT_EQ(execution->state, WorkflowExecutionState::COMPLETED);
+    EXPECT_EQ(stage_items(*execution, "collect"), (std::vector<int>{10, 20, 30, 40, 50}));
+
+    // split outruns work, so its pushes wait for room in a one-chunk channel
+    auto log = std::find_if(execution->execution_log.begin(), execution->execution_log.end(),
+                            [](const std::string& entry) { return entry.rfind("Stream split -> work:", 0) == 0; });
+    ASSERT_NE(log, execution->execution_log.end());
+    EXPECT_NE(log->find("5 chunks"), std::string::npos) << *log;
+    EXPECT_EQ(log->find(" 0 backpressure waits"), std::string::npos) << *log;
+    EXPECT_NE(log->find("max depth 1"), std::string::npos) << *log;
+    orchestrator.stop();
+}
+
+TEST_F(WorkflowOrchestratorTest, FailingStreamingStageStopsThePipeline) {
+    WorkflowOrchestrator orchestrator(workflow_manager_);
+    orchestrator.register_workflow(streaming_pipeline("broken_stream", 1, 1, "slow_failure"));
+    ASSERT_TRUE(orchestrator.start());
+
+    auto execution = wait_for(orchestrator,
+                              orchestrator.execute_workflow("broken_stream", json{{"items", {1, 2, 3, 4, 5}}}));
+    ASSERT_NE(execution, nullptr);
+    EXPECT_EQ(execution->state, WorkflowExecutionState::FAILED);
+    EXPECT_NE(execution->error_message.find("Step work failed"), std::string::npos) << execution->error_message;
+    // split was stopped by the abandoned stream; that is not a failure of its own
+    EXPECT_EQ(execution->error_message.find("Step split failed"), std::string::npos) << execution->error_message;
+    EXPECT_TRUE(execution->step_stats["split"].error_message.empty());
+    EXPECT_FALSE(execution->step_stats["split"].completed_successfully);
+
+    // work gave up after its first call and collect never ran
+    auto log = calls();
+    EXPECT_EQ(std::count(log.begin(), log.end(), "work"), 1);
+    EXPECT_EQ(find_prefixed(log, "collect "), log.size());
+    orchestrator.stop();
+}
+
+TEST_F(WorkflowOrchestratorTest, StreamingPipelineStatusCanBeReadWhileItRuns) {
+    WorkflowOrchestrator orchestrator(workflow_manager_);
+    orchestrator.register_workflow(streaming_pipeline("polled_stream", 1, 1));
+    ASSERT_TRUE(orchestrator.start());
+
+    std::string execution_id =
+        orchestrator.execute_workflow_async("polled_stream", json{{"items", {1, 2, 3, 4, 5, 6}}});
+    auto execution = orchestrator.get_execution_status(execution_id);
+    ASSERT_NE(execution, nullptr);
+
+    // Reads what the HTTP status endpoints read, under the execution's lock,
+    // until the execution has finished and published everything
+    size_t polls = 0;
+    size_t log_size = 0;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (std::chrono::steady_clock::now() < deadline) {
+        json progress = orchestrator.get_execution_progress(execution_id);
+        ASSERT_FALSE(progress.contains("error"));
+        {
+            std::lock_guard<std::mutex> lock(execution->mutex);
+            json outputs = execution->step_outputs_json();
+            EXPECT_TRUE(outputs.is_object());
+            for (const auto& [step_id, stats] : execution->step_stats) {
+                EXPECT_FALSE(step_id.empty());
+                EXPECT_TRUE(stats.error_message.empty());
+            }
+            log_size = execution->execution_log.size();
+        }
+        polls++;
+        if (is_finished(execution->state)) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    EXPECT_GT(polls, 1u);
+    EXPECT_EQ(execution->state, WorkflowExecutionState::COMPLETED);
+    EXPECT_GE(log_size, 2u);
+    EXPECT_EQ(stage_items(*execution, "collect"), (std::vector<int>{10, 20, 30, 40, 50, 60}));
+    orchestrator.stop();
+}
+
+TEST_F(WorkflowOrchestratorTest, ContextAndStepOutputPayloadsKeepTheirShape) {
+    WorkflowOrchestrator orchestrator(workflow_manager_);
+    WorkflowDefinition sequential = two_step_workflow();
+    sequential.global_context = json{{"region", "eu"}};
+    orchestrator.register_workflow(sequential);
+    // Array-format steps take "name" from the input
+    WorkflowDefinition pipeline("array_pipeline", "Array pipeline", WorkflowType::PIPELINE);
+    pipeline.steps.emplace_back("first", "Worker", "record", json::array({"name"}));
+    pipeline.steps.emplace_back("second", "Worker", "record", json::array({"name"}));
+    orchestrator.register_workflow(pipeline);
+    ASSERT_TRUE(orchestrator.start());
+
+    // What the API reported when outputs were copied into the context as
+    // "<step>_output" and step_outputs held plain json values
+    json fetch = {{"value", "fetch-result"}, {"source", ""}};
+    json summarize = {{"value", "summarize-result"}, {"source", "fetch-result"}};
+    auto execution = wait_for(orchestrator, orchestrator.execute_workflow("two_step", json{{"topic", "t"}}));
+    ASSERT_NE(execution, nullptr);
+    ASSERT_EQ(execution->state, WorkflowExecutionState::COMPLETED);
+    {
+        std::lock_guard<std::mutex> lock(execution->mutex);
+        EXPECT_EQ(execution->context_json(), (json{{"region", "eu"},
+                                                   {"input", {{"topic", "t"}}},
+                                                   {"fetch_output", fetch},
+                                                   {"summarize_output", summarize}}));
+        EXPECT_EQ(execution->step_outputs_json(), (json{{"fetch", fetch}, {"summarize", summarize}}));
+    }
+
+    json first = {{"value", "n-result"}, {"source", ""}};
+    execution = wait_for(orchestrator, orchestrator.execute_workflow("array_pipeline", json{{"name", "n"}}));
+    ASSERT_NE(execution, nullptr);
+    ASSERT_EQ(execution->state, WorkflowExecutionState::COMPLETED);
+    {
+        std::lock_guard<std::mutex> lock(execution->mutex);
+        EXPECT_EQ(execution->context_json(), (json{{"input", {{"name", "n"}}},
+                                                   {"pipeline_input", first},
+                                                   {"first_output", first},
+                                                   {"second_output", first}}));
+        EXPECT_EQ(execution->step_outputs_json(), (json{{"first", first}, {"second", first}}));
+    }
+    orchestrator.stop();
+}